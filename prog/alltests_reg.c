@@ -47,25 +47,40 @@
 static const char *tests[] = {
                               "alphaops_reg",
                               "alphaxform_reg",
+                              "bgnorm_reg",
+                              "bilateral_reg",
                               "binarize_reg",
+                              "binmorph6_reg",
+                              "binmorph7_reg",
+                              "ccthin3_reg",
                               "coloring_reg",
                               "colormask_reg",
                               "colorquant_reg",
+                              "colorspace_reg",
                               "compare_reg",
                               "convolve_reg",
                               "dewarp_reg",
                          /*   "distance_reg", */
+                              "dither_reg",
                               "dna_reg",
                               "dwamorph1_reg",
                               "enhance_reg",
+                              "fft_reg",
                               "findpattern_reg",
                               "fpix_reg",
                               "gifio_reg",
                               "graymorph2_reg",
+                              "graymorph3_reg",
+                              "graymorph4_reg",
                               "hardlight_reg",
+                              "hmtmultiple_reg",
                               "ioformats_reg",
                               "kernel_reg",
                               "maze_reg",
+                              "morphband_reg",
+                              "morphsela_reg",
+                              "morphseqplan_reg",
+                              "numcolors_reg",
                               "overlap_reg",
                               "pdfseg_reg",
                               "pixa2_reg",
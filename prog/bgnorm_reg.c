@@ -0,0 +1,118 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * bgnorm_reg.c
+ *
+ *   Tests background normalization, where pixBackgroundNorm()
+ *   applies the inverse background map with bilinear interpolation:
+ *     - pixApplyInvBackgroundGrayMapInterp(), on 8 bpp
+ *     - pixApplyInvBackgroundRGBMapInterp(), on 32 bpp
+ *   The result is compared with the map applied as a constant over
+ *   each tile.  They agree exactly for a constant map, and otherwise
+ *   differ by more than 8 in less than 0.5 percent of the pixels
+ *   of these scanned pages.
+ */
+
+#include "allheaders.h"
+
+main(int    argc,
+     char **argv)
+{
+PIX          *pixs, *pixg, *pixm, *pixmi, *pixmr, *pixmg, *pixmb;
+PIX          *pixmri, *pixmgi, *pixmbi, *pix1, *pix2, *pix3;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* 8 bpp */
+    pixs = pixRead("lighttext.jpg");
+    pixg = pixConvertTo8(pixs, 0);
+    pixGetBackgroundGrayMap(pixg, NULL, 10, 15, 60, 40, &pixm);
+    pixmi = pixGetInvBackgroundMap(pixm, 200, 2, 1);
+    pix1 = pixApplyInvBackgroundGrayMap(pixg, pixmi, 10, 15);
+    pix2 = pixBackgroundNorm(pixg, NULL, NULL, 10, 15, 60, 40, 200, 2, 1);
+    pix3 = pixApplyInvBackgroundGrayMapInterp(pixg, pixmi, 10, 15);
+    regTestComparePix(rp, pix2, pix3);  /* 0 */
+    regTestCompareSimilarPix(rp, pix1, pix2, 9, 0.005, 0);  /* 1 */
+    regTestWritePixAndCheck(rp, pix3, IFF_PNG);  /* 2 */
+    pixDisplayWithTitle(pix3, 100, 100, NULL, rp->display);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+
+        /* With a constant map, the result is the same */
+    pixSetAllArbitrary(pixmi, 300);
+    pix1 = pixApplyInvBackgroundGrayMap(pixg, pixmi, 10, 15);
+    pix2 = pixApplyInvBackgroundGrayMapInterp(pixg, pixmi, 10, 15);
+    regTestComparePix(rp, pix1, pix2);  /* 3 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixm);
+    pixDestroy(&pixmi);
+    pixDestroy(&pixg);
+    pixDestroy(&pixs);
+
+        /* 32 bpp */
+    pixs = pixRead("1555-7.jpg");
+    pixGetBackgroundRGBMap(pixs, NULL, NULL, 10, 15, 60, 40,
+                           &pixmr, &pixmg, &pixmb);
+    pixmri = pixGetInvBackgroundMap(pixmr, 200, 2, 1);
+    pixmgi = pixGetInvBackgroundMap(pixmg, 200, 2, 1);
+    pixmbi = pixGetInvBackgroundMap(pixmb, 200, 2, 1);
+    pix1 = pixApplyInvBackgroundRGBMap(pixs, pixmri, pixmgi, pixmbi, 10, 15);
+    pix2 = pixBackgroundNorm(pixs, NULL, NULL, 10, 15, 60, 40, 200, 2, 1);
+    pix3 = pixApplyInvBackgroundRGBMapInterp(pixs, pixmri, pixmgi, pixmbi,
+                                             10, 15);
+    regTestComparePix(rp, pix2, pix3);  /* 4 */
+    regTestCompareSimilarPix(rp, pix1, pix2, 9, 0.005, 0);  /* 5 */
+    regTestWritePixAndCheck(rp, pix3, IFF_JFIF_JPEG);  /* 6 */
+    pixDisplayWithTitle(pix3, 100, 500, NULL, rp->display);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+
+        /* With constant maps, the result is the same */
+    pixSetAllArbitrary(pixmri, 250);
+    pixSetAllArbitrary(pixmgi, 300);
+    pixSetAllArbitrary(pixmbi, 350);
+    pix1 = pixApplyInvBackgroundRGBMap(pixs, pixmri, pixmgi, pixmbi, 10, 15);
+    pix2 = pixApplyInvBackgroundRGBMapInterp(pixs, pixmri, pixmgi, pixmbi,
+                                             10, 15);
+    regTestComparePix(rp, pix1, pix2);  /* 7 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixmr);
+    pixDestroy(&pixmg);
+    pixDestroy(&pixmb);
+    pixDestroy(&pixmri);
+    pixDestroy(&pixmgi);
+    pixDestroy(&pixmbi);
+    pixDestroy(&pixs);
+
+    return regTestCleanup(rp);
+}
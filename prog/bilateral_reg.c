@@ -0,0 +1,93 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  bilateral_reg.c
+ *
+ *    Regression test for the approximate bilateral filter:
+ *      (1) gray and color results
+ *      (2) comparison with the exact filter, for a small spatial kernel
+ *      (3) a sharp step edge and a constant image are unchanged
+ */
+
+#include "allheaders.h"
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       w, h;
+PIX          *pixs, *pixc, *pixg, *pix1, *pix2;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixs = pixRead("test24.jpg");
+    pixc = pixScale(pixs, 0.5, 0.5);
+    pixg = pixConvertRGBToLuminance(pixc);
+
+        /* Gray and color results */
+    pix1 = pixBilateral(pixg, 5.0, 20.0, 10);
+    regTestWritePixAndCheck(rp, pix1, IFF_PNG);  /* 0 */
+    pixDisplayWithTitle(pix1, 0, 0, "gray", rp->display);
+    pixDestroy(&pix1);
+    pix1 = pixBilateral(pixc, 5.0, 30.0, 8);
+    regTestWritePixAndCheck(rp, pix1, IFF_JFIF_JPEG);  /* 1 */
+    pixDisplayWithTitle(pix1, 600, 0, "color", rp->display);
+    pixDestroy(&pix1);
+
+        /* With enough levels, the approximation is within a few
+         * levels of the exact filter */
+    pix1 = pixBilateralGray(pixg, 2.0, 20.0, 16);
+    pix2 = pixBilateralGrayExact(pixg, 2.0, 20.0);
+    regTestCompareSimilarPix(rp, pix1, pix2, 6, 0.0, 0);  /* 2 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+
+        /* A step much larger than the range stdev is not smoothed */
+    pixGetDimensions(pixg, &w, &h, NULL);
+    pix1 = pixCreate(w, h, 8);
+    pixSetAllArbitrary(pix1, 50);
+    pixRasterop(pix1, w / 3, 0, w, h, PIX_SET, NULL, 0, 0);
+    pixRasterop(pix1, 2 * w / 3, h / 2, w, h, PIX_CLR, NULL, 0, 0);
+    pix2 = pixBilateralGray(pix1, 8.0, 20.0, 6);
+    regTestComparePix(rp, pix1, pix2);  /* 3 */
+    pixDestroy(&pix2);
+
+        /* A constant image is unchanged */
+    pixSetAllArbitrary(pix1, 137);
+    pix2 = pixBilateralGray(pix1, 8.0, 20.0, 6);
+    regTestComparePix(rp, pix1, pix2);  /* 4 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+
+    pixDestroy(&pixs);
+    pixDestroy(&pixc);
+    pixDestroy(&pixg);
+    return regTestCleanup(rp);
+}
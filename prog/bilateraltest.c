@@ -0,0 +1,95 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  bilateraltest.c
+ *
+ *    Timing of the bilateral filter:
+ *      (1) pixBilateralGray(), whose time is independent of the
+ *          spatial stdev, vs. pixBilateralGrayExact(), whose time
+ *          goes as the square of the spatial stdev
+ *      (2) pixBilateralGray() for different numbers of range levels
+ *
+ *    Syntax:  bilateraltest filein
+ *    The input image is converted to 8 bpp.
+ */
+
+#include "allheaders.h"
+
+static const l_float32  SpatialStdevs[] = {1.0, 2.0, 4.0, 8.0, 16.0, 32.0};
+static const l_int32    NComps[] = {4, 6, 10, 16, 30};
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32      i, w, h;
+l_float32    tfast, texact;
+PIX         *pixs, *pixg, *pix1, *pix2;
+static char  mainName[] = "bilateraltest";
+
+    if (argc != 2)
+        exit(ERROR_INT(" Syntax:  bilateraltest filein", mainName, 1));
+
+    if ((pixs = pixRead(argv[1])) == NULL)
+        exit(ERROR_INT("pixs not made", mainName, 1));
+    pixg = pixConvertTo8(pixs, 0);
+    pixGetDimensions(pixg, &w, &h, NULL);
+    fprintf(stderr, "Image size: %d x %d\n", w, h);
+
+        /* The exact filter is skipped when it gets too slow */
+    for (i = 0; i < sizeof(SpatialStdevs) / sizeof(l_float32); i++) {
+        startTimer();
+        pix1 = pixBilateralGray(pixg, SpatialStdevs[i], 20.0, 10);
+        tfast = stopTimer();
+        if (SpatialStdevs[i] <= 8.0) {
+            startTimer();
+            pix2 = pixBilateralGrayExact(pixg, SpatialStdevs[i], 20.0);
+            texact = stopTimer();
+            fprintf(stderr, "Spatial stdev %4.1f: fast = %7.3f sec, "
+                    "exact = %7.3f sec\n", SpatialStdevs[i], tfast, texact);
+            pixDestroy(&pix2);
+        }
+        else {
+            fprintf(stderr, "Spatial stdev %4.1f: fast = %7.3f sec\n",
+                    SpatialStdevs[i], tfast);
+        }
+        pixDestroy(&pix1);
+    }
+
+    for (i = 0; i < sizeof(NComps) / sizeof(l_int32); i++) {
+        startTimer();
+        pix1 = pixBilateralGray(pixg, 4.0, 20.0, NComps[i]);
+        fprintf(stderr, "%2d range levels: %7.3f sec\n", NComps[i],
+                stopTimer());
+        pixDestroy(&pix1);
+    }
+
+    pixDestroy(&pixs);
+    pixDestroy(&pixg);
+    return 0;
+}
@@ -37,6 +37,7 @@ PIX *PixTest2(PIX *pixs, l_int32 size, l_float32 factor, l_int32 nx,
               l_int32 ny, L_REGPARAMS *rp);
 void PixTest3(PIX *pixs, l_int32 size, l_float32 factor,
               l_int32 nx, l_int32 ny, l_int32 paircount, L_REGPARAMS *rp);
+PIX *PixTest4(PIX *pixs, l_int32 size, l_float32 factor, l_int32 bandh);
 
 main(int    argc,
      char **argv)
@@ -69,6 +70,16 @@ L_REGPARAMS  *rp;
     pixDisplayWithTitle(pixt1, 100, 500, NULL, rp->display);
     pixDisplayWithTitle(pixt2, 700, 500, NULL, rp->display);
     pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+
+        /* Compare streaming Sauvola with the full image version */
+    pixSauvolaBinarize(pixs, 7, 0.34, 1, NULL, NULL, NULL, &pixt1);
+    pixt2 = PixTest4(pixs, 7, 0.34, 1);
+    regTestComparePix(rp, pixt1, pixt2);
+    pixDestroy(&pixt2);
+    pixt2 = PixTest4(pixs, 7, 0.34, 37);
+    regTestComparePix(rp, pixt1, pixt2);
+    pixDestroy(&pixt1);
     pixDestroy(&pixt2);
 
     pixDestroy(&pixs);
@@ -177,3 +188,43 @@ PIX  *pixt1, *pixt2;
     pixDestroy(&pixt2);
     return;
 }
+
+
+PIX *
+PixTest4(PIX       *pixs,
+         l_int32    size,
+         l_float32  factor,
+         l_int32    bandh)
+{
+l_int32            w, h, y, yd, hb, hd;
+BOX               *box;
+PIX               *pixb, *pixt, *pixd;
+L_SAUVOLA_STREAM  *ss;
+
+        /* Feed the image in bands of height bandh */
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixd = pixCreate(w, h, 1);
+    ss = sauvolaStreamCreate(w, size, factor);
+    yd = 0;
+    for (y = 0; y < h + bandh; y += bandh) {
+        if (y < h) {
+            hb = L_MIN(bandh, h - y);
+            box = boxCreate(0, y, w, hb);
+            pixb = pixClipRectangle(pixs, box, NULL);
+            sauvolaStreamAddLines(ss, pixb, &pixt);
+            boxDestroy(&box);
+            pixDestroy(&pixb);
+        }
+        else {  /* all lines have been added */
+            sauvolaStreamFinish(ss, &pixt);
+        }
+        if (pixt) {
+            hd = pixGetHeight(pixt);
+            pixRasterop(pixd, 0, yd, w, hd, PIX_SRC, pixt, 0, 0);
+            yd += hd;
+            pixDestroy(&pixt);
+        }
+    }
+    sauvolaStreamDestroy(&ss);
+    return pixd;
+}
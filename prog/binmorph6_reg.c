@@ -0,0 +1,181 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * binmorph6_reg.c
+ *
+ *   Tests dilation and erosion by large Sels, which are factored
+ *   into sequences of smaller Sels (see selMakeMorphPlan()).
+ *     - Each Sel used here must actually be decomposed.
+ *     - The result must agree, for both boundary conditions, with
+ *       a reference that does one rasterop for each hit.
+ *     - Changing the Sel after it has been used must change the result.
+ *   Also tests that a safe closing, which adds and removes its border
+ *   within the first and last passes, agrees with a closing done on
+ *   an explicitly bordered copy.
+ *   Require exact equality.
+ */
+
+#include "allheaders.h"
+
+static SEL *makeTestSel(l_int32 type, l_int32 size);
+static PIX *refMorph(PIX *pixs, SEL *sel, l_int32 dilate);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, bc, nplan;
+BOX          *box;
+PIX          *pixs, *pixt, *pixt1, *pixt2;
+SEL          *sel;
+SELA         *plan;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixt = pixRead("rabi.png");
+    box = boxCreate(300, 400, 400, 300);
+    pixs = pixClipRectangle(pixt, box, NULL);
+    pixDestroy(&pixt);
+    boxDestroy(&box);
+
+    for (bc = 0; bc < 2; bc++) {
+        resetMorphBoundaryCondition((bc == 0) ? ASYMMETRIC_MORPH_BC :
+                                                SYMMETRIC_MORPH_BC);
+        for (i = 0; i < 4; i++) {
+            sel = makeTestSel(i, 12);
+            plan = selMakeMorphPlan(sel);
+            nplan = (plan) ? selaGetCount(plan) : 0;
+            regTestCompareValues(rp, 1, (nplan > 1), 0.0);
+            selaDestroy(&plan);
+            pixt1 = pixDilate(NULL, pixs, sel);
+            pixt2 = refMorph(pixs, sel, 1);
+            regTestComparePix(rp, pixt1, pixt2);
+            pixDestroy(&pixt1);
+            pixDestroy(&pixt2);
+            pixt1 = pixErode(NULL, pixs, sel);
+            pixt2 = refMorph(pixs, sel, 0);
+            regTestComparePix(rp, pixt1, pixt2);
+            pixDestroy(&pixt1);
+            pixDestroy(&pixt2);
+            selDestroy(&sel);
+        }
+    }
+    resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+
+        /* Change the data of a Sel directly, after using it */
+    sel = makeTestSel(0, 12);
+    pixt1 = pixDilate(NULL, pixs, sel);
+    sel->data[0][0] = SEL_DONT_CARE;
+    pixt1 = pixDilate(pixt1, pixs, sel);
+    pixt2 = refMorph(pixs, sel, 1);
+    regTestComparePix(rp, pixt1, pixt2);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    selDestroy(&sel);
+
+        /* Safe closing, with the border carried through the passes */
+    for (i = 0; i < 4; i++) {
+        sel = makeTestSel(i, 12);
+        pixt1 = pixCloseSafe(NULL, pixs, sel);
+        pixt = pixAddBorder(pixs, 64, 0);
+        pixt2 = pixClose(NULL, pixt, sel);
+        pixDestroy(&pixt);
+        pixt = pixRemoveBorder(pixt2, 64);
+        regTestComparePix(rp, pixt1, pixt);
+        pixDestroy(&pixt);
+        pixDestroy(&pixt1);
+        pixDestroy(&pixt2);
+        selDestroy(&sel);
+    }
+
+    pixDestroy(&pixs);
+    return regTestCleanup(rp);
+}
+
+
+    /* Makes a brick, a diamond, a diagonal line or a lattice with
+     * half-width @size and the origin off center. */
+static SEL *
+makeTestSel(l_int32  type,
+            l_int32  size)
+{
+l_int32  i, j, n;
+SEL     *sel;
+
+    n = 2 * size + 1;
+    sel = selCreate(n, n, NULL);
+    selSetOrigin(sel, size - 3, size + 2);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            if ((type == 0) ||
+                (type == 1 && L_ABS(i - size) + L_ABS(j - size) <= size) ||
+                (type == 2 && i == j) ||
+                (type == 3 && i % 3 == 0 && j % 4 == 0))
+                selSetElement(sel, i, j, SEL_HIT);
+        }
+    }
+    return sel;
+}
+
+
+    /* One rasterop for each hit, with the boundary condition
+     * supplied by an added border. */
+static PIX *
+refMorph(PIX     *pixs,
+         SEL     *sel,
+         l_int32  dilate)
+{
+l_int32  i, j, sx, sy, cx, cy, w, h, bordval;
+PIX     *pixb, *pixt, *pixd;
+
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    bordval = (!dilate && getMorphBorderPixelColor(L_MORPH_ERODE, 1)) ? 1 : 0;
+    pixb = pixAddBorderGeneral(pixs, sx, sx, sy, sy, bordval);
+    w = pixGetWidth(pixb);
+    h = pixGetHeight(pixb);
+    pixt = pixCreateTemplate(pixb);
+    if (!dilate)
+        pixSetAll(pixt);
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] != SEL_HIT)
+                continue;
+            if (dilate)
+                pixRasterop(pixt, j - cx, i - cy, w, h, PIX_SRC | PIX_DST,
+                            pixb, 0, 0);
+            else
+                pixRasterop(pixt, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
+                            pixb, 0, 0);
+        }
+    }
+    pixd = pixRemoveBorderGeneral(pixt, sx, sx, sy, sy);
+    pixDestroy(&pixb);
+    pixDestroy(&pixt);
+    return pixd;
+}
@@ -0,0 +1,245 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * binmorph7_reg.c
+ *
+ *   Tests dilation, erosion and hmt by Sels that are not bricks and
+ *   are too small to be factored, so that each is done directly in
+ *   one pass (see morphWordAccum() in morph.c).
+ *     - Dilation and erosion must agree, for both boundary
+ *       conditions, with a reference that does one rasterop for
+ *       each hit.
+ *     - Hmt must agree with a reference that does one rasterop for
+ *       each hit and each miss, and then clears the edges.
+ *     - The results must be the same in-place and into an
+ *       existing pixd.
+ *   Require exact equality.
+ */
+
+#include "allheaders.h"
+
+static SEL *makeTestSel(l_int32 type);
+static PIX *refMorph(PIX *pixs, SEL *sel, l_int32 dilate);
+static PIX *refHMT(PIX *pixs, SEL *sel);
+
+static const l_int32  NTYPES = 6;
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, bc, nplan;
+PIX          *pixs, *pixt1, *pixt2;
+SEL          *sel;
+SELA         *plan;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixs = pixRead("test1.png");  /* width is not a multiple of 32 */
+
+        /* Dilation and erosion, with both boundary conditions */
+    for (bc = 0; bc < 2; bc++) {
+        resetMorphBoundaryCondition((bc == 0) ? ASYMMETRIC_MORPH_BC :
+                                                SYMMETRIC_MORPH_BC);
+        for (i = 0; i < NTYPES; i++) {
+            sel = makeTestSel(i);
+            plan = selMakeMorphPlan(sel);
+            nplan = (plan) ? selaGetCount(plan) : 0;
+            regTestCompareValues(rp, 1, (nplan <= 1), 0.0);
+            selaDestroy(&plan);
+            pixt1 = pixDilate(NULL, pixs, sel);
+            pixt2 = refMorph(pixs, sel, 1);
+            regTestComparePix(rp, pixt1, pixt2);
+            pixDestroy(&pixt1);
+            pixDestroy(&pixt2);
+            pixt1 = pixErode(NULL, pixs, sel);
+            pixt2 = refMorph(pixs, sel, 0);
+            regTestComparePix(rp, pixt1, pixt2);
+            pixDestroy(&pixt1);
+            pixDestroy(&pixt2);
+            selDestroy(&sel);
+        }
+    }
+    resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+
+        /* Hmt */
+    for (i = 0; i < NTYPES; i++) {
+        sel = makeTestSel(i);
+        pixt1 = pixHMT(NULL, pixs, sel);
+        pixt2 = refHMT(pixs, sel);
+        regTestComparePix(rp, pixt1, pixt2);
+        pixDestroy(&pixt1);
+        pixDestroy(&pixt2);
+        selDestroy(&sel);
+    }
+
+        /* In-place, and into an existing pixd of another size */
+    sel = makeTestSel(4);
+    pixt2 = refHMT(pixs, sel);
+    pixt1 = pixCopy(NULL, pixs);
+    pixHMT(pixt1, pixt1, sel);
+    regTestComparePix(rp, pixt1, pixt2);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixt2 = refMorph(pixs, sel, 0);
+    pixt1 = pixCreate(10, 10, 1);
+    pixErode(pixt1, pixs, sel);
+    regTestComparePix(rp, pixt1, pixt2);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixt2 = refMorph(pixs, sel, 1);
+    pixt1 = pixCopy(NULL, pixs);
+    pixDilate(pixt1, pixt1, sel);
+    regTestComparePix(rp, pixt1, pixt2);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    selDestroy(&sel);
+
+    pixDestroy(&pixs);
+    return regTestCleanup(rp);
+}
+
+
+    /* Makes small Sels that are not bricks:
+     *   0: diamond; 1: diagonal line; 2: sparse lattice;
+     *   3: ring with the origin outside the hits;
+     *   4: hits and misses, from a string;
+     *   5: pseudo-random hits and misses, with the origin off center.
+     * Types 0-3 have only hits; for hmt, types 4 and 5 have misses. */
+static SEL *
+makeTestSel(l_int32  type)
+{
+l_int32    i, j, size, n;
+l_uint32   seed;
+SEL       *sel;
+static const char  *text = "oo x  "
+                           "o xxx "
+                           "  xCx "
+                           " xxx o"
+                           "  x oo";
+
+    if (type == 4)
+        return selCreateFromString(text, 5, 6, "hitmiss");
+
+    size = 3;
+    n = 2 * size + 1;
+    sel = selCreate(n, n, NULL);
+    selSetOrigin(sel, size - 1, size + 2);
+    seed = 12345;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            seed = 1664525 * seed + 1013904223;
+            if ((type == 0 && L_ABS(i - size) + L_ABS(j - size) <= size) ||
+                (type == 1 && i == j) ||
+                (type == 2 && i % 2 == 0 && j % 3 == 0) ||
+                (type == 3 && L_MAX(L_ABS(i - size), L_ABS(j - size)) == 2))
+                selSetElement(sel, i, j, SEL_HIT);
+            else if (type == 5 && (seed >> 28) < 2)
+                selSetElement(sel, i, j, SEL_HIT);
+            else if (type == 5 && (seed >> 28) == 2)
+                selSetElement(sel, i, j, SEL_MISS);
+        }
+    }
+    if (type == 3)
+        selSetOrigin(sel, size, size);
+    return sel;
+}
+
+
+    /* One rasterop for each hit, with the boundary condition
+     * supplied by an added border. */
+static PIX *
+refMorph(PIX     *pixs,
+         SEL     *sel,
+         l_int32  dilate)
+{
+l_int32  i, j, sx, sy, cx, cy, w, h, bordval;
+PIX     *pixb, *pixt, *pixd;
+
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    bordval = (!dilate && getMorphBorderPixelColor(L_MORPH_ERODE, 1)) ? 1 : 0;
+    pixb = pixAddBorderGeneral(pixs, sx, sx, sy, sy, bordval);
+    w = pixGetWidth(pixb);
+    h = pixGetHeight(pixb);
+    pixt = pixCreateTemplate(pixb);
+    if (!dilate)
+        pixSetAll(pixt);
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] != SEL_HIT)
+                continue;
+            if (dilate)
+                pixRasterop(pixt, j - cx, i - cy, w, h, PIX_SRC | PIX_DST,
+                            pixb, 0, 0);
+            else
+                pixRasterop(pixt, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
+                            pixb, 0, 0);
+        }
+    }
+    pixd = pixRemoveBorderGeneral(pixt, sx, sx, sy, sy);
+    pixDestroy(&pixb);
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
+    /* One rasterop for each hit and miss, followed by clearing the
+     * edges by the maximum translations of the hits. */
+static PIX *
+refHMT(PIX  *pixs,
+       SEL  *sel)
+{
+l_int32  i, j, sx, sy, cx, cy, w, h, xp, yp, xn, yn;
+PIX     *pixd;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    pixd = pixCreateTemplate(pixs);
+    pixSetAll(pixd);
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT)
+                pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
+                            pixs, 0, 0);
+            else if (sel->data[i][j] == SEL_MISS)
+                pixRasterop(pixd, cx - j, cy - i, w, h,
+                            PIX_NOT(PIX_SRC) & PIX_DST, pixs, 0, 0);
+        }
+    }
+    selFindMaxTranslations(sel, &xp, &yp, &xn, &yn);
+    if (xp > 0)
+        pixRasterop(pixd, 0, 0, xp, h, PIX_CLR, NULL, 0, 0);
+    if (xn > 0)
+        pixRasterop(pixd, w - xn, 0, xn, h, PIX_CLR, NULL, 0, 0);
+    if (yp > 0)
+        pixRasterop(pixd, 0, 0, w, yp, PIX_CLR, NULL, 0, 0);
+    if (yn > 0)
+        pixRasterop(pixd, 0, h - yn, w, yn, PIX_CLR, NULL, 0, 0);
+    return pixd;
+}
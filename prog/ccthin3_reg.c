@@ -0,0 +1,157 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ *  ccthin3_reg.c
+ *
+ *    Regression test for table-driven thinning.
+ *    pixThinLUT() must give the same result as pixThinGeneral(),
+ *    which uses HMTs, for 4 and 8 connectivity, for thinning and
+ *    thickening, when run to completion and when stopped early.
+ *    The thinned foreground must also have the same number of
+ *    connected components as the input.
+ */
+
+#include "allheaders.h"
+
+    /* The Sels used by pixThin() */
+static const char *sel_4_1 = "  x"
+                             "oCx"
+                             "  x";
+static const char *sel_4_2 = "  x"
+                             "oCx"
+                             " o ";
+static const char *sel_4_3 = " o "
+                             "oCx"
+                             "  x";
+static const char *sel_8_2 = " x "
+                             "oCx"
+                             "o  ";
+static const char *sel_8_3 = "o  "
+                             "oCx"
+                             " x ";
+static const char *sel_8_5 = "o x"
+                             "oCx"
+                             "o  ";
+static const char *sel_8_6 = "o  "
+                             "oCx"
+                             "o x";
+
+static SELA *makeThinSela(l_int32 connectivity);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, j, conn, type, maxiters, n1, n2;
+BOX          *box;
+PIX          *pixs, *pixt, *pix1, *pix2;
+SELA         *sela;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* Clip so that the foreground touches the image boundary */
+    pixt = pixRead("rabi.png");
+    box = boxCreate(500, 500, 701, 603);
+    pixs = pixClipRectangle(pixt, box, NULL);
+    pixDestroy(&pixt);
+    boxDestroy(&box);
+
+    for (i = 0; i < 2; i++) {
+        conn = (i == 0) ? 4 : 8;
+        sela = makeThinSela(conn);
+        for (j = 0; j < 3; j++) {
+            type = (j < 2) ? L_THIN_FG : L_THIN_BG;
+            maxiters = (j == 0) ? 0 : 3;
+            pix1 = pixThinGeneral(pixs, type, sela, maxiters);
+            pix2 = pixThinLUT(pixs, type, sela, maxiters);
+            regTestComparePix(rp, pix1, pix2);  /* 0, 1, 2, 7, 8, 9 */
+            if (j == 0) {
+                pixCountConnComp(pixs, conn, &n1);
+                pixCountConnComp(pix2, conn, &n2);
+                regTestCompareValues(rp, n1, n2, 0.0);  /* 3, 10 */
+                pixDisplayWithTitle(pix2, 100 + 500 * i, 100, NULL,
+                                    rp->display);
+            }
+            pixDestroy(&pix1);
+            pixDestroy(&pix2);
+        }
+
+            /* pixThin() uses the same Sels */
+        pix1 = pixThinGeneral(pixs, L_THIN_FG, sela, 0);
+        pix2 = pixThin(pixs, L_THIN_FG, conn, 0);
+        regTestComparePix(rp, pix1, pix2);  /* 4, 11 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+
+            /* Thickening, with the opposite connectivity preserved */
+        pix1 = pixThinGeneral(pixs, L_THIN_BG, sela, 0);
+        pix2 = pixThin(pixs, L_THIN_BG, conn, 0);
+        regTestComparePix(rp, pix1, pix2);  /* 5, 12 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+
+            /* Thinning a skeleton leaves it unchanged */
+        pix1 = pixThin(pixs, L_THIN_FG, conn, 0);
+        pix2 = pixThinLUT(pix1, L_THIN_FG, sela, 0);
+        regTestComparePix(rp, pix1, pix2);  /* 6, 13 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        selaDestroy(&sela);
+    }
+
+    pixDestroy(&pixs);
+    return regTestCleanup(rp);
+}
+
+
+static SELA *
+makeThinSela(l_int32  connectivity)
+{
+SEL   *sel;
+SELA  *sela;
+
+    sela = selaCreate(4);
+    if (connectivity == 4) {
+        sel = selCreateFromString(sel_4_1, 3, 3, "sel_4_1");
+        selaAddSel(sela, sel, NULL, 0);
+        sel = selCreateFromString(sel_4_2, 3, 3, "sel_4_2");
+        selaAddSel(sela, sel, NULL, 0);
+        sel = selCreateFromString(sel_4_3, 3, 3, "sel_4_3");
+        selaAddSel(sela, sel, NULL, 0);
+    } else {
+        sel = selCreateFromString(sel_8_2, 3, 3, "sel_8_2");
+        selaAddSel(sela, sel, NULL, 0);
+        sel = selCreateFromString(sel_8_3, 3, 3, "sel_8_3");
+        selaAddSel(sela, sel, NULL, 0);
+        sel = selCreateFromString(sel_8_5, 3, 3, "sel_8_5");
+        selaAddSel(sela, sel, NULL, 0);
+        sel = selCreateFromString(sel_8_6, 3, 3, "sel_8_6");
+        selaAddSel(sela, sel, NULL, 0);
+    }
+    return sela;
+}
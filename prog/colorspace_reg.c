@@ -0,0 +1,273 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * colorspace_reg.c
+ *
+ *   Tests the image colorspace conversions against the functions
+ *   that convert a single pixel:
+ *     - rgb to HSV, YUV and YCbCr, for all 2^24 colors
+ *     - HSV to rgb for all valid HSV values, and YUV and YCbCr
+ *       to rgb for all 2^24 values
+ *     - rgb to LAB on a subsample of the colors
+ *   Require exact equality.  Also checks the round trip error of
+ *   YCbCr and LAB, and the HSV range masks against masks made
+ *   from a converted HSV image.  Prints timings for the image
+ *   and pixel-by-pixel conversions to HSV.
+ */
+
+#include "allheaders.h"
+
+typedef l_int32 (*CONVERT_FUNC)(l_int32, l_int32, l_int32,
+                                l_int32 *, l_int32 *, l_int32 *);
+
+static PIX *makeAllColors(l_int32 ncolors);
+static PIX *refConvert(PIX *pixs, CONVERT_FUNC func);
+static l_int32 maxCompDiff(PIX *pix1, PIX *pix2);
+static PIX *refRangeMask(PIX *pixs, l_int32 type, l_int32 center1,
+                         l_int32 hw1, l_int32 center2, l_int32 hw2,
+                         l_int32 regionflag);
+
+    /* For refRangeMask() */
+enum {
+    RANGE_HS = 0,
+    RANGE_HV = 1,
+    RANGE_SV = 2
+};
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, flag;
+l_float32     t1, t2;
+PIX          *pixs, *pixh, *pixc, *pixr, *pix1, *pix2;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixs = makeAllColors(1 << 24);
+
+        /* rgb to HSV, YUV and YCbCr */
+    startTimer();
+    pix1 = pixConvertRGBToHSV(NULL, pixs);
+    t1 = stopTimer();
+    startTimer();
+    pix2 = refConvert(pixs, convertRGBToHSV);
+    t2 = stopTimer();
+    regTestComparePix(rp, pix1, pix2);  /* 0 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    fprintf(stderr, "HSV of 2^24 colors: image = %6.3f sec, "
+            "pixel by pixel = %6.3f sec\n", t1, t2);
+    pix1 = pixConvertRGBToYUV(NULL, pixs);
+    pix2 = refConvert(pixs, convertRGBToYUV);
+    regTestComparePix(rp, pix1, pix2);  /* 1 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pix1 = pixConvertRGBToYCbCr(NULL, pixs);
+    pix2 = refConvert(pixs, convertRGBToYCbCr);
+    regTestComparePix(rp, pix1, pix2);  /* 2 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+
+        /* HSV, YUV and YCbCr to rgb.  The valid hue is in [0 ... 240]. */
+    pixh = makeAllColors(241 << 16);
+    pix1 = pixConvertHSVToRGB(NULL, pixh);
+    pix2 = refConvert(pixh, convertHSVToRGB);
+    regTestComparePix(rp, pix1, pix2);  /* 3 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixh);
+    pix1 = pixConvertYUVToRGB(NULL, pixs);
+    pix2 = refConvert(pixs, convertYUVToRGB);
+    regTestComparePix(rp, pix1, pix2);  /* 4 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pix1 = pixConvertYCbCrToRGB(NULL, pixs);
+    pix2 = refConvert(pixs, convertYCbCrToRGB);
+    regTestComparePix(rp, pix1, pix2);  /* 5 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+
+        /* Round trip through YCbCr */
+    pix1 = pixConvertRGBToYCbCr(NULL, pixs);
+    pixConvertYCbCrToRGB(pix1, pix1);
+    regTestCompareValues(rp, 1, maxCompDiff(pixs, pix1), 0);  /* 6 */
+    pixDestroy(&pix1);
+
+        /* LAB, and its round trip */
+    pixr = pixScaleBySampling(pixs, 0.125, 0.125);
+    pix1 = pixConvertRGBToLAB(NULL, pixr);
+    pix2 = refConvert(pixr, convertRGBToLAB);
+    regTestComparePix(rp, pix1, pix2);  /* 7 */
+    pixConvertLABToRGB(pix1, pix1);
+    regTestCompareSimilarPix(rp, pixr, pix1, 7, 0.02, 0);  /* 8 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixr);
+    pixDestroy(&pixs);
+
+        /* Range masks, which convert each pixel as it is tested */
+    pixc = pixRead("fish24.jpg");
+    for (i = 0; i < 2; i++) {
+        flag = (i == 0) ? L_INCLUDE_REGION : L_EXCLUDE_REGION;
+        pix1 = pixMakeRangeMaskHS(pixc, 20, 30, 120, 60, flag);
+        pix2 = refRangeMask(pixc, RANGE_HS, 20, 30, 120, 60, flag);
+        regTestComparePix(rp, pix1, pix2);  /* 9, 12 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pix1 = pixMakeRangeMaskHV(pixc, 230, 25, 100, 80, flag);
+        pix2 = refRangeMask(pixc, RANGE_HV, 230, 25, 100, 80, flag);
+        regTestComparePix(rp, pix1, pix2);  /* 10, 13 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pix1 = pixMakeRangeMaskSV(pixc, 50, 40, 180, 70, flag);
+        pix2 = refRangeMask(pixc, RANGE_SV, 50, 40, 180, 70, flag);
+        regTestComparePix(rp, pix1, pix2);  /* 11, 14 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+    pixDestroy(&pixc);
+
+    return regTestCleanup(rp);
+}
+
+
+    /* Pixel k has the three components of k in its 3 MS bytes */
+static PIX *
+makeAllColors(l_int32  ncolors)
+{
+l_int32    i, h;
+l_uint32  *data;
+PIX       *pixd;
+
+    h = ncolors / 4096;
+    pixd = pixCreate(4096, h, 32);
+    data = pixGetData(pixd);
+    for (i = 0; i < 4096 * h; i++)
+        data[i] = i << 8;
+    return pixd;
+}
+
+
+static PIX *
+refConvert(PIX          *pixs,
+           CONVERT_FUNC  func)
+{
+l_int32    i, j, w, h, val1, val2, val3;
+l_uint32   pixel;
+l_uint32  *data, *line;
+PIX       *pixd;
+
+    pixd = pixCopy(NULL, pixs);
+    pixGetDimensions(pixd, &w, &h, NULL);
+    data = pixGetData(pixd);
+    for (i = 0; i < h; i++) {
+        line = data + i * pixGetWpl(pixd);
+        for (j = 0; j < w; j++) {
+            pixel = line[j];
+            (*func)(pixel >> 24, (pixel >> 16) & 0xff, (pixel >> 8) & 0xff,
+                    &val1, &val2, &val3);
+            composeRGBPixel(val1, val2, val3, line + j);
+        }
+    }
+    return pixd;
+}
+
+
+static l_int32
+maxCompDiff(PIX  *pix1,
+            PIX  *pix2)
+{
+l_int32  i, j, w, h, r1, g1, b1, r2, g2, b2, maxdiff;
+
+    pixGetDimensions(pix1, &w, &h, NULL);
+    maxdiff = 0;
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            pixGetRGBPixel(pix1, j, i, &r1, &g1, &b1);
+            pixGetRGBPixel(pix2, j, i, &r2, &g2, &b2);
+            maxdiff = L_MAX(maxdiff, L_ABS(r1 - r2));
+            maxdiff = L_MAX(maxdiff, L_ABS(g1 - g2));
+            maxdiff = L_MAX(maxdiff, L_ABS(b1 - b2));
+        }
+    }
+    return maxdiff;
+}
+
+
+    /* Tests each pixel of an HSV image for being in the range of the
+     * two selected components, with wrap-around of the hue. */
+static l_int32
+inRange(l_int32  val,
+        l_int32  center,
+        l_int32  hw,
+        l_int32  ishue)
+{
+l_int32  start, end;
+
+    if (!ishue)
+        return (val >= center - hw && val <= center + hw);
+    start = (center - hw + 240) % 240;
+    end = (center + hw + 240) % 240;
+    if (start < end)
+        return (val >= start && val <= end);
+    return (val >= start || val <= end);
+}
+
+
+static PIX *
+refRangeMask(PIX     *pixs,
+             l_int32  type,
+             l_int32  center1,
+             l_int32  hw1,
+             l_int32  center2,
+             l_int32  hw2,
+             l_int32  regionflag)
+{
+l_int32   i, j, w, h, hval, sval, vval, val1, val2, inside;
+PIX      *pixhsv, *pixd;
+
+    pixhsv = pixConvertRGBToHSV(NULL, pixs);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixd = pixCreate(w, h, 1);
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            pixGetRGBPixel(pixhsv, j, i, &hval, &sval, &vval);
+            val1 = (type == RANGE_SV) ? sval : hval;
+            val2 = (type == RANGE_HS) ? sval : vval;
+            inside = inRange(val1, center1, hw1, type != RANGE_SV) &&
+                     inRange(val2, center2, hw2, 0);
+            if ((regionflag == L_INCLUDE_REGION && inside) ||
+                (regionflag == L_EXCLUDE_REGION && !inside))
+                pixSetPixel(pixd, j, i, 1);
+        }
+    }
+    pixDestroy(&pixhsv);
+    return pixd;
+}
@@ -42,8 +42,13 @@ static const char  *kdatastr = " 20    50   80  50   20 "
 main(int    argc,
      char **argv)
 {
-l_int32       i, j, sizex, sizey;
+l_int32       i, j, w, h, sizex, sizey, count;
+l_float32     sigma, val1, val2;
+l_float64     sum;
+BOX          *box;
+DPIX         *dpix;
 FPIX         *fpixv, *fpixrv;
+L_INTEGRAL   *intg;
 L_KERNEL     *kel1, *kel2;
 PIX          *pixs, *pixacc, *pixg, *pixt, *pixd;
 PIX          *pixb, *pixm, *pixms, *pixrv, *pix1, *pix2, *pix3, *pix4;
@@ -70,20 +75,20 @@ L_REGPARAMS  *rp;
 
         /* Test pixBlockrank() on 1 bpp */
     pixs = pixRead("test1.png");
-    pixacc = pixBlockconvAccum(pixs);
+    intg = integralCreate(pixs, 0);
     for (i = 0; i < 3; i++) {
-        pixd = pixBlockrank(pixs, pixacc, 4, 4, 0.25 + 0.25 * i);
+        pixd = pixBlockrankIntegral(pixs, intg, 4, 4, 0.25 + 0.25 * i);
         regTestWritePixAndCheck(rp, pixd, IFF_PNG);  /* 2 - 4 */
         pixDisplayWithTitle(pixd, 300 + 100 * i, 0, NULL, rp->display);
         pixDestroy(&pixd);
     }
 
         /* Test pixBlocksum() on 1 bpp */
-    pixd = pixBlocksum(pixs, pixacc, 16, 16);
+    pixd = pixBlocksumIntegral(pixs, intg, 16, 16);
     regTestWritePixAndCheck(rp, pixd, IFF_JFIF_JPEG);  /* 5 */
     pixDisplayWithTitle(pixd, 700, 0, NULL, rp->display);
     pixDestroy(&pixd);
-    pixDestroy(&pixacc);
+    integralDestroy(&intg);
     pixDestroy(&pixs);
 
         /* Test pixCensusTransform() */
@@ -172,5 +177,107 @@ L_REGPARAMS  *rp;
     fpixDestroy(&fpixrv);
 #endif
 
+        /* Test pixRecursiveGaussian() against gaussian kernel convolution,
+         * on 8 bpp and 32 bpp */
+    pixs = pixRead("test24.jpg");
+    pixg = pixConvertRGBToLuminance(pixs);
+    for (i = 0; i < 2; i++) {
+        sigma = (i == 0) ? 2.0 : 8.0;
+        makeGaussianKernelSep(3 * sigma, 3 * sigma, sigma, 1.0, &kel1, &kel2);
+        pix1 = pixConvolveSep(pixg, kel1, kel2, 8, 1);
+        pix2 = pixRecursiveGaussian(pixg, sigma, sigma);
+        regTestCompareSimilarPix(rp, pix1, pix2, 2, 0.0, 0);  /* 16, 18 */
+        pixDisplayWithTitle(pix2, 100 + 300 * i, 0, NULL, rp->display);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pix1 = pixConvolveRGBSep(pixs, kel1, kel2);
+        pix2 = pixRecursiveGaussian(pixs, sigma, sigma);
+        regTestCompareSimilarPix(rp, pix1, pix2, 2, 0.0, 0);  /* 17, 19 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        kernelDestroy(&kel1);
+        kernelDestroy(&kel2);
+    }
+    pixDestroy(&pixg);
+    pixDestroy(&pixs);
+
+        /* Test the integral image sums on 1 bpp */
+    pixs = pixRead("test1.png");
+    pixGetDimensions(pixs, &w, &h, NULL);
+    intg = integralCreate(pixs, 0);
+    integralGetRectSum(intg, 0, 0, w, h, &sum, NULL);
+    pixCountPixels(pixs, &count, NULL);
+    regTestCompareValues(rp, count, sum, 0.0);  /* 20 */
+    integralDestroy(&intg);
+    pixDestroy(&pixs);
+
+        /* Test the choice of method in pixConvolve().  A separable
+         * kernel is compared with the same kernel after making it
+         * non-separable by changing one element by a tiny amount,
+         * and an integer kernel is compared with its normalized
+         * (non-integer) version.  */
+    pixs = pixRead("test24.jpg");
+    pixg = pixConvertRGBToLuminance(pixs);
+    kel1 = makeGaussianKernel(5, 5, 2.0, 1.0);
+    kel2 = kernelCopy(kel1);
+    kernelSetElement(kel2, 0, 0, kel1->data[0][0] + 0.001);
+    kernelGetConvolveType(kel1, &i);
+    kernelGetConvolveType(kel2, &j);
+    regTestCompareValues(rp, L_KERNEL_SEPARABLE, i, 0.0);  /* 21 */
+    regTestCompareValues(rp, L_KERNEL_GENERAL, j, 0.0);  /* 22 */
+    pix1 = pixConvolve(pixg, kel1, 8, 1);
+    pix2 = pixConvolve(pixg, kel2, 8, 1);
+    regTestCompareSimilarPix(rp, pix1, pix2, 2, 0.0, 0);  /* 23 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    kernelDestroy(&kel1);
+    kernelDestroy(&kel2);
+    kel1 = kernelCreateFromString(5, 5, 2, 2, kdatastr);
+    kel2 = kernelNormalize(kel1, 1.0);
+    kernelGetConvolveType(kel1, &i);
+    kernelGetConvolveType(kel2, &j);
+    regTestCompareValues(rp, L_KERNEL_INTEGER, i, 0.0);  /* 24 */
+    regTestCompareValues(rp, L_KERNEL_GENERAL, j, 0.0);  /* 25 */
+    pix1 = pixConvolve(pixg, kel1, 8, 1);
+    pix2 = pixConvolve(pixg, kel2, 8, 0);
+    regTestCompareSimilarPix(rp, pix1, pix2, 2, 0.0, 0);  /* 26 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    kernelDestroy(&kel1);
+    kernelDestroy(&kel2);
+
+        /* Test the accumulator entry points against the integral
+         * image versions */
+    box = boxCreate(37, 51, 150, 90);
+    pixacc = pixBlockconvAccum(pixg);
+    dpix = pixMeanSquareAccum(pixg);
+    intg = integralCreate(pixg, 1);
+    pixMeanInRectangle(pixg, box, pixacc, &val1);
+    pixMeanInRectangleIntegral(pixg, box, intg, &val2);
+    regTestCompareValues(rp, val1, val2, 0.001);  /* 27 */
+    pixVarianceInRectangle(pixg, box, pixacc, dpix, &val1, NULL);
+    pixVarianceInRectangleIntegral(pixg, box, intg, &val2, NULL);
+    regTestCompareValues(rp, val1, val2, 0.01);  /* 28 */
+    boxDestroy(&box);
+    pixDestroy(&pixacc);
+    dpixDestroy(&dpix);
+    integralDestroy(&intg);
+    pixDestroy(&pixg);
+    pixDestroy(&pixs);
+    pixs = pixRead("test1.png");
+    pixacc = pixBlockconvAccum(pixs);
+    pix1 = pixBlocksum(pixs, pixacc, 16, 16);
+    pix2 = pixBlocksumIntegral(pixs, NULL, 16, 16);
+    regTestComparePix(rp, pix1, pix2);  /* 29 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pix1 = pixBlockrank(pixs, pixacc, 4, 4, 0.5);
+    pix2 = pixBlockrankIntegral(pixs, NULL, 4, 4, 0.5);
+    regTestComparePix(rp, pix1, pix2);  /* 30 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixacc);
+    pixDestroy(&pixs);
+
     return regTestCleanup(rp);
 }
@@ -42,8 +42,9 @@ static const char  *kdatastr = " 20    50   80  50   20 "
 main(int    argc,
      char **argv)
 {
-l_int32      i, j, wc, hc, d;
-L_KERNEL    *kel1, *kel2;
+l_int32      i, j, k, wc, hc, d, size;
+L_INTEGRAL  *intg;
+L_KERNEL    *kel, *kel1, *kel2, *kel3;
 PIX         *pixs, *pixg, *pixacc, *pixd, *pixt;
 char        *filein, *fileout;
 static char  mainName[] = "convolvetest";
@@ -85,18 +86,18 @@ static char  mainName[] = "convolvetest";
 #endif
 
 #if 0  /* Test pixBlockrank() */
-    pixacc = pixBlockconvAccum(pixs);
-    pixd = pixBlockrank(pixs, pixacc, wc, hc, 0.5);
+    intg = integralCreate(pixs, 0);
+    pixd = pixBlockrankIntegral(pixs, intg, wc, hc, 0.5);
     pixWrite(fileout, pixd, IFF_TIFF_G4);
-    pixDestroy(&pixacc);
+    integralDestroy(&intg);
 #endif
 
 #if 0  /* Test pixBlocksum() */
-    pixacc = pixBlockconvAccum(pixs);
-    pixd = pixBlocksum(pixs, pixacc, wc, hc);
+    intg = integralCreate(pixs, 0);
+    pixd = pixBlocksumIntegral(pixs, intg, wc, hc);
     pixInvert(pixd, pixd);
     pixWrite(fileout, pixd, IFF_JFIF_JPEG);
-    pixDestroy(&pixacc);
+    integralDestroy(&intg);
 #endif
 
 #if 0  /* Test pixCensusTransform() */
@@ -149,6 +150,45 @@ static char  mainName[] = "convolvetest";
     kernelDestroy(&kel2);
 #endif
 
+#if 1   /* Measure speed of pixConvolve() for the three kernel types */
+    pixDestroy(&pixd);
+    if (pixGetDepth(pixs) == 32)
+        pixg = pixConvertRGBToLuminance(pixs);
+    else
+        pixg = pixClone(pixs);
+    for (size = 3; size <= 31; size = 2 * size + 1) {
+            /* Separable (flat) */
+        kel1 = makeFlatKernel(size, size, size / 2, size / 2);
+            /* Non-separable, with small integers (a pyramid) */
+        kel2 = kernelCreate(size, size);
+        kernelSetOrigin(kel2, size / 2, size / 2);
+        for (i = 0; i < size; i++) {
+            for (j = 0; j < size; j++)
+                kernelSetElement(kel2, i, j,
+                    size / 2 + 1 - L_MAX(L_ABS(i - size / 2),
+                                         L_ABS(j - size / 2)));
+        }
+            /* Non-separable, with real values */
+        kel3 = kernelNormalize(kel2, 1.0);
+        for (k = 0; k < 3; k++) {
+            kel = (k == 0) ? kel1 : ((k == 1) ? kel2 : kel3);
+            startTimer();
+            for (i = 0; i < NTIMES / 10; i++) {
+                pixd = pixConvolve(pixg, kel, 8, 1);
+                pixDestroy(&pixd);
+            }
+            fprintf(stderr, "%2d x %2d, %s: %7.4f sec\n", size, size,
+                    (k == 0) ? "separable" : ((k == 1) ? "integer  " :
+                                                         "general  "),
+                    stopTimer() / (NTIMES / 10));
+        }
+        kernelDestroy(&kel1);
+        kernelDestroy(&kel2);
+        kernelDestroy(&kel3);
+    }
+    pixDestroy(&pixg);
+#endif
+
     pixDestroy(&pixs);
     pixDestroy(&pixd);
     return 0;
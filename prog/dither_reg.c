@@ -0,0 +1,220 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * dither_reg.c
+ *
+ *   Tests Floyd-Steinberg-like error diffusion dithering against
+ *   simple pixel-by-pixel references:
+ *     - gray to 2 bpp, with default and other clipping values
+ *     - rgb to the fixed 256 color octcube colormap, which uses
+ *       the dither kernel that is shared by the color quantizers
+ *   Odd widths are included, to test the ends of the words.  The
+ *   color images are tall enough that dithering is not turned off.
+ *   Require exact equality.  Also prints timings for the 1 bpp,
+ *   2 bpp and color dithers.
+ */
+
+#include "allheaders.h"
+
+static PIX *refDitherTo2bpp(PIX *pixs, l_int32 lowerclip, l_int32 upperclip);
+static PIX *refDitherToFixed256(PIX *pixs, PIXCMAP *cmap);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, w;
+l_float32     t1, t2, t3;
+BOX          *box;
+PIX          *pixg, *pixc, *pixs, *pix1, *pix2;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixg = pixRead("test8.jpg");
+    pixc = pixRead("fish24.jpg");
+
+        /* Gray to 2 bpp */
+    for (i = 0; i < 3; i++) {
+        w = (i == 0) ? pixGetWidth(pixg) : 37 + 16 * i;
+        box = boxCreate(13, 7, w, 151);
+        pixs = pixClipRectangle(pixg, box, NULL);
+        boxDestroy(&box);
+        pix1 = pixDitherTo2bpp(pixs, 0);
+        pix2 = refDitherTo2bpp(pixs, DEFAULT_CLIP_LOWER_2,
+                               DEFAULT_CLIP_UPPER_2);
+        regTestComparePix(rp, pix1, pix2);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pix1 = pixDitherTo2bppSpec(pixs, 0, 40, 0);
+        pix2 = refDitherTo2bpp(pixs, 0, 40);
+        regTestComparePix(rp, pix1, pix2);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pixDestroy(&pixs);
+    }
+
+        /* Rgb to the fixed octcube colormap */
+    for (i = 0; i < 3; i++) {
+        w = (i == 0) ? pixGetWidth(pixc) : 37 + 16 * i;
+        box = boxCreate(5, 11, w, 261);
+        pixs = pixClipRectangle(pixc, box, NULL);
+        boxDestroy(&box);
+        pix1 = pixFixedOctcubeQuant256(pixs, 1);
+        pix2 = refDitherToFixed256(pixs, pixGetColormap(pix1));
+        regTestComparePix(rp, pix1, pix2);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pixDestroy(&pixs);
+    }
+
+        /* Timings */
+    pixs = pixScale(pixg, 4.0, 4.0);
+    startTimer();
+    pix1 = pixDitherToBinary(pixs);
+    t1 = stopTimer();
+    pixDestroy(&pix1);
+    startTimer();
+    pix1 = pixDitherTo2bpp(pixs, 0);
+    t2 = stopTimer();
+    pixDestroy(&pix1);
+    pixDestroy(&pixs);
+    startTimer();
+    pix1 = pixOctreeColorQuant(pixc, 240, 1);
+    t3 = stopTimer();
+    pixDestroy(&pix1);
+    fprintf(stderr, "Dither: 1 bpp = %6.3f sec, 2 bpp = %6.3f sec, "
+            "color = %6.3f sec\n", t1, t2, t3);
+
+    pixDestroy(&pixg);
+    pixDestroy(&pixc);
+    return regTestCleanup(rp);
+}
+
+
+    /* Propagates the excess of each pixel separately, with the values
+     * clipped to [0 ... 255] in a full-image integer array. */
+static PIX *
+refDitherTo2bpp(PIX     *pixs,
+                l_int32  lowerclip,
+                l_int32  upperclip)
+{
+l_int32   i, j, w, h, oval, val;
+l_int32  *tabval, *tab38, *tab14, *buf;
+PIX      *pixd;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixd = pixCreate(w, h, 2);
+    buf = (l_int32 *)CALLOC(w * h, sizeof(l_int32));
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            pixGetPixel(pixs, j, i, (l_uint32 *)&val);
+            buf[i * w + j] = val;
+        }
+    }
+    make8To2DitherTables(&tabval, &tab38, &tab14, lowerclip, upperclip);
+
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            oval = buf[i * w + j];
+            pixSetPixel(pixd, j, i, tabval[oval]);
+            if (j < w - 1) {
+                val = buf[i * w + j + 1] + tab38[oval];
+                buf[i * w + j + 1] = L_MIN(255, L_MAX(0, val));
+            }
+            if (i < h - 1) {
+                val = buf[(i + 1) * w + j] + tab38[oval];
+                buf[(i + 1) * w + j] = L_MIN(255, L_MAX(0, val));
+            }
+            if (i < h - 1 && j < w - 1) {
+                val = buf[(i + 1) * w + j + 1] + tab14[oval];
+                buf[(i + 1) * w + j + 1] = L_MIN(255, L_MAX(0, val));
+            }
+        }
+    }
+
+    FREE(buf);
+    FREE(tabval);
+    FREE(tab38);
+    FREE(tab14);
+    return pixd;
+}
+
+
+    /* The components are held as (64 * value), and the cell index of
+     * the fixed octcube quantizer is also its colormap index.  As in
+     * the library, there is no propagation from the last pixel of
+     * each row, or along the last row. */
+static PIX *
+refDitherToFixed256(PIX      *pixs,
+                    PIXCMAP  *cmap)
+{
+l_int32   i, j, k, w, h, index, dif, val, rval, gval, bval;
+l_int32   c[3];
+l_int32  *buf, *p;
+PIX      *pixd;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixd = pixCreate(w, h, 8);
+    pixSetColormap(pixd, pixcmapCopy(cmap));
+    buf = (l_int32 *)CALLOC(3 * w * h, sizeof(l_int32));
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            pixGetRGBPixel(pixs, j, i, &rval, &gval, &bval);
+            buf[3 * (i * w + j)] = 64 * rval;
+            buf[3 * (i * w + j) + 1] = 64 * gval;
+            buf[3 * (i * w + j) + 2] = 64 * bval;
+        }
+    }
+
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            rval = buf[3 * (i * w + j)] / 64;
+            gval = buf[3 * (i * w + j) + 1] / 64;
+            bval = buf[3 * (i * w + j) + 2] / 64;
+            index = (rval & 0xe0) | ((gval >> 3) & 0x1c) | (bval >> 6);
+            pixSetPixel(pixd, j, i, index);
+            if (i == h - 1 || j == w - 1)
+                continue;
+            pixcmapGetColor(cmap, index, &c[0], &c[1], &c[2]);
+            for (k = 0; k < 3; k++) {
+                p = buf + 3 * (i * w + j) + k;
+                dif = p[0] / 8 - 8 * c[k];
+                val = p[3] + 3 * dif;  /* right */
+                p[3] = L_MIN(16383, L_MAX(0, val));
+                val = p[3 * w] + 3 * dif;  /* below */
+                p[3 * w] = L_MIN(16383, L_MAX(0, val));
+                val = p[3 * w + 3] + 2 * dif;  /* diagonally below */
+                p[3 * w + 3] = L_MIN(16383, L_MAX(0, val));
+            }
+        }
+    }
+
+    FREE(buf);
+    return pixd;
+}
@@ -34,6 +34,7 @@
  *     * Sharpening
  *     * Color mapping to lighten background with constant hue
  *     * Linear color transform without mixing (diagonal)
+ *     * Per-component and masked TRC mapping
  */
 
 #include "allheaders.h"
@@ -49,8 +50,9 @@ l_int32       w, h, d, i, same;
 l_uint32      srcval, dstval;
 l_float32     scalefact, sat, fract;
 L_BMF        *bmf8;
+BOX          *box;
 L_KERNEL     *kel;
-NUMA         *na;
+NUMA         *na, *nar, *nag, *nab;
 PIX          *pix, *pixs, *pixs1, *pixs2, *pixd;
 PIX          *pixt0, *pixt1, *pixt2, *pixt3, *pixt4;
 PIXA         *pixa, *pixaf;
@@ -224,5 +226,78 @@ L_REGPARAMS  *rp;
     pixDestroy(&pixt2);
     pixDestroy(&pixt3);
     pixDestroy(&pixt4);
+
+    /* -----------------------------------------------*
+     *         Test per-component and masked TRC       *
+     * -----------------------------------------------*/
+        /* Separate maps for r, g, b in one pass, versus mapping
+         * each component separately */
+    pixs = pixRead(filein);
+    nar = numaGammaTRC(0.6, 0, 255);
+    nag = numaGammaTRC(1.0, 40, 200);
+    nab = numaContrastTRC(0.7);
+    pixt1 = pixCopy(NULL, pixs);
+    pixTRCMapGeneral(pixt1, NULL, nar, nag, nab);
+    pixt2 = pixCopy(NULL, pixs);
+    pix = pixGetRGBComponent(pixs, COLOR_RED);
+    pixTRCMap(pix, NULL, nar);
+    pixSetRGBComponent(pixt2, pix, COLOR_RED);
+    pixDestroy(&pix);
+    pix = pixGetRGBComponent(pixs, COLOR_GREEN);
+    pixTRCMap(pix, NULL, nag);
+    pixSetRGBComponent(pixt2, pix, COLOR_GREEN);
+    pixDestroy(&pix);
+    pix = pixGetRGBComponent(pixs, COLOR_BLUE);
+    pixTRCMap(pix, NULL, nab);
+    pixSetRGBComponent(pixt2, pix, COLOR_BLUE);
+    pixDestroy(&pix);
+    regTestComparePix(rp, pixt1, pixt2);  /* 14 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+
+        /* Masked mapping of an 8 bpp image with odd width, versus
+         * combining the unmasked result through the mask */
+    pix = pixConvertRGBToLuminance(pixs);
+    pixs1 = pixClipRectangle(pix, box = boxCreate(0, 0, 301, 213), NULL);
+    boxDestroy(&box);
+    pixt3 = pixCreate(280, 200, 1);
+    pixRasterop(pixt3, 17, 0, 200, 200, PIX_SET, NULL, 0, 0);
+    pixRasterop(pixt3, 0, 30, 280, 50, PIX_NOT(PIX_DST), NULL, 0, 0);
+    pixt1 = pixCopy(NULL, pixs1);
+    pixTRCMap(pixt1, pixt3, nar);
+    pixt2 = pixCopy(NULL, pixs1);
+    pixTRCMap(pixt2, NULL, nar);
+    pixt4 = pixCopy(NULL, pixs1);
+    pixCombineMasked(pixt4, pixt2, pixt3);
+    regTestComparePix(rp, pixt1, pixt4);  /* 15 */
+    numaDestroy(&nar);
+    numaDestroy(&nag);
+    numaDestroy(&nab);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+    pixDestroy(&pixt4);
+
+        /* The fixed-point unsharp masking is exact in integer
+         * arithmetic, so it commutes with a 90 degree rotation */
+    pixs2 = pixRotate90(pixs1, 1);
+    pixt1 = pixUnsharpMaskingGray1D(pixs1, 2, 0.6, L_HORIZ);
+    pixt2 = pixUnsharpMaskingGray1D(pixs2, 2, 0.6, L_VERT);
+    pixt3 = pixRotate90(pixt2, -1);
+    regTestComparePix(rp, pixt1, pixt3);  /* 16 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+    pixt1 = pixUnsharpMaskingGray2D(pixs1, 2, 0.6);
+    pixt2 = pixUnsharpMaskingGray2D(pixs2, 2, 0.6);
+    pixt3 = pixRotate90(pixt2, -1);
+    regTestComparePix(rp, pixt1, pixt3);  /* 17 */
+    pixDestroy(&pix);
+    pixDestroy(&pixs);
+    pixDestroy(&pixs1);
+    pixDestroy(&pixs2);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
     return regTestCleanup(rp);
 }
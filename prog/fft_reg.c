@@ -0,0 +1,207 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  fft_reg.c
+ *
+ *    Regression test for convolution and correlation using the FFT.
+ *    The results are compared with direct convolution and with
+ *    correlation by rasterop.
+ */
+
+#include "allheaders.h"
+
+static l_float32 FPixMaxAbsDiff(FPIX *fpix1, FPIX *fpix2);
+
+static const char  *kdatastr = " 20    50   80  50   20 "
+                               " 50   100  140  100  50 "
+                               " 90   160  200  160  90 "
+                               " 50   100  140  100  50 "
+                               " 20    50   80   50  20 ";
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       delx, dely, count, countf, area1, area2, etransx, etransy;
+l_int32       w1, h1, w2, h2, fail;
+l_int32      *tab;
+l_float32     diff, score, scored, bestscore, cx1, cy1, cx2, cy2;
+l_float64     val;
+BOX          *box1, *box2;
+DPIX         *dpix;
+FPIX         *fpixs, *fpix1, *fpix2;
+L_KERNEL     *kel;
+PIX          *pixs, *pixg, *pix1, *pix2, *pixt;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixs = pixRead("test8.jpg");
+    pixg = pixScale(pixs, 0.5, 0.5);
+    fpixs = pixConvertToFPix(pixg, 1);
+
+        /* FFT convolution with a large gaussian kernel */
+    kel = makeGaussianKernel(15, 15, 5.0, 1.0);
+    l_setConvolveFFT(0);
+    fpix1 = fpixConvolve(fpixs, kel, 1);
+    l_setConvolveFFT(1);
+    fpix2 = fpixConvolveFFT(fpixs, kel, 1);
+    diff = FPixMaxAbsDiff(fpix1, fpix2);
+    if (rp->display) fprintf(stderr, "Gaussian: max diff = %7.5f\n", diff);
+    regTestCompareValues(rp, 0.0, diff, 0.01);  /* 0 */
+    fpixDestroy(&fpix1);
+    fpixDestroy(&fpix2);
+    kernelDestroy(&kel);
+
+        /* Non-normalized, off-center, non-symmetric kernel */
+    kel = kernelCreateFromString(5, 5, 1, 3, kdatastr);
+    kernelSetElement(kel, 0, 4, -300.0);
+    l_setConvolveFFT(0);
+    fpix1 = fpixConvolve(fpixs, kel, 0);
+    l_setConvolveFFT(1);
+    fpix2 = fpixConvolveFFT(fpixs, kel, 0);
+    diff = FPixMaxAbsDiff(fpix1, fpix2);
+    if (rp->display) fprintf(stderr, "Unnormalized: max diff = %7.5f\n", diff);
+    regTestCompareValues(rp, 0.0, diff, 0.1);  /* 1 */
+    fpixDestroy(&fpix1);
+    fpixDestroy(&fpix2);
+
+        /* Subsampled output */
+    l_setConvolveSampling(3, 2);
+    l_setConvolveFFT(0);
+    fpix1 = fpixConvolve(fpixs, kel, 1);
+    l_setConvolveFFT(1);
+    fpix2 = fpixConvolveFFT(fpixs, kel, 1);
+    l_setConvolveSampling(1, 1);
+    diff = FPixMaxAbsDiff(fpix1, fpix2);
+    if (rp->display) fprintf(stderr, "Subsampled: max diff = %7.5f\n", diff);
+    regTestCompareValues(rp, 0.0, diff, 0.01);  /* 2 */
+    fpixDestroy(&fpix1);
+    fpixDestroy(&fpix2);
+    kernelDestroy(&kel);
+
+        /* Automatic selection of the FFT in fpixConvolve() */
+    kel = makeFlatKernel(41, 41, 20, 20);
+    fpix1 = fpixConvolve(fpixs, kel, 1);
+    pixt = fpixConvertToPix(fpix1, 8, L_CLIP_TO_ZERO, 0);
+    regTestWritePixAndCheck(rp, pixt, IFF_JFIF_JPEG);  /* 3 */
+    pixDisplayWithTitle(pixt, 100, 100, NULL, rp->display);
+    fpixDestroy(&fpix1);
+    pixDestroy(&pixt);
+    kernelDestroy(&kel);
+    fpixDestroy(&fpixs);
+    pixDestroy(&pixg);
+    pixDestroy(&pixs);
+
+        /* Correlation surface for 1 bpp, compared with rasterop */
+    pixs = pixRead("test1.png");
+    box1 = boxCreate(100, 50, 180, 140);
+    box2 = boxCreate(90, 60, 170, 120);
+    pix1 = pixClipRectangle(pixs, box1, NULL);
+    pix2 = pixClipRectangle(pixs, box2, NULL);
+    boxDestroy(&box1);
+    boxDestroy(&box2);
+    pixGetDimensions(pix1, &w1, &h1, NULL);
+    pixGetDimensions(pix2, &w2, &h2, NULL);
+    tab = makePixelSumTab8();
+    pixCountPixels(pix1, &area1, tab);
+    pixCountPixels(pix2, &area2, tab);
+    dpix = pixCorrelationSurfaceFFT(pix1, pix2);
+    fail = FALSE;
+    for (dely = -h2 + 1; dely < h1; dely += 7) {
+        for (delx = -w2 + 1; delx < w1; delx += 5) {
+            pixt = pixCreateTemplate(pix1);
+            pixRasterop(pixt, delx, dely, w2, h2, PIX_SRC, pix2, 0, 0);
+            pixRasterop(pixt, 0, 0, w1, h1, PIX_SRC & PIX_DST, pix1, 0, 0);
+            pixCountPixels(pixt, &count, tab);
+            pixDestroy(&pixt);
+            dpixGetPixel(dpix, delx + w2 - 1, dely + h2 - 1, &val);
+            countf = (l_int32)(val + 0.5);
+            if (count != countf || L_ABS(val - countf) > 0.01) {
+                fail = TRUE;
+                if (rp->display)
+                    fprintf(stderr, "(%d, %d): count = %d, fft = %f\n",
+                            delx, dely, count, val);
+            }
+        }
+    }
+    regTestCompareValues(rp, FALSE, fail, 0);  /* 4 */
+    dpixDestroy(&dpix);
+
+        /* Best correlation over a large search range, compared with
+         * an exhaustive search by rasterop */
+    pixCentroid(pix1, NULL, tab, &cx1, &cy1);
+    pixCentroid(pix2, NULL, tab, &cx2, &cy2);
+    etransx = lept_roundftoi(cx1 - cx2);
+    etransy = lept_roundftoi(cy1 - cy2);
+    bestscore = 0.0;
+    for (dely = etransy - 50; dely <= etransy + 50; dely++) {
+        for (delx = etransx - 50; delx <= etransx + 50; delx++) {
+            scored = pixCorrelationScoreShifted(pix1, pix2, area1, area2,
+                                                delx, dely, tab);
+            if (scored > bestscore)
+                bestscore = scored;
+        }
+    }
+    pixBestCorrelation(pix1, pix2, area1, area2, etransx, etransy, 50,
+                       tab, &delx, &dely, &score, 0);
+    if (rp->display)
+        fprintf(stderr, "Best shift: (%d, %d), score = %7.5f, direct = %7.5f\n",
+                delx, dely, score, bestscore);
+    regTestCompareValues(rp, bestscore, score, 0.0);  /* 5 */
+    scored = pixCorrelationScoreShifted(pix1, pix2, area1, area2,
+                                        delx, dely, tab);
+    regTestCompareValues(rp, scored, score, 0.0);  /* 6 */
+
+    FREE(tab);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixs);
+    fftClearPlanCache();
+    return regTestCleanup(rp);
+}
+
+
+static l_float32
+FPixMaxAbsDiff(FPIX  *fpix1,
+               FPIX  *fpix2)
+{
+l_int32    i, j, w, h;
+l_float32  val1, val2, maxdiff;
+
+    fpixGetDimensions(fpix1, &w, &h);
+    maxdiff = 0.0;
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            fpixGetPixel(fpix1, j, i, &val1);
+            fpixGetPixel(fpix2, j, i, &val2);
+            maxdiff = L_MAX(maxdiff, L_ABS(val1 - val2));
+        }
+    }
+    return maxdiff;
+}
@@ -0,0 +1,135 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  ffttest.c
+ *
+ *    Timing comparison of convolution and correlation using the FFT
+ *    with the direct methods:
+ *      (1) fpixConvolve() with direct convolution vs. fpixConvolveFFT(),
+ *          for a range of kernel sizes
+ *      (2) pixCorrelationScoreShifted() at every shift vs. a single
+ *          pixCorrelationSurfaceFFT(), for a range of search sizes
+ *
+ *    Syntax:  ffttest filein
+ *    The input image is converted to 8 bpp for convolution, and
+ *    binarized for correlation.
+ */
+
+#include "allheaders.h"
+
+static const l_int32  KernelSizes[] = {3, 7, 11, 15, 21, 31, 51};
+static const l_int32  MaxShifts[] = {2, 5, 10, 20};
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32      i, k, size, maxshift, delx, dely, w, h, area1, area2;
+l_int32     *tab;
+l_float32    tdirect, tfft, score, maxdiff;
+l_float32    val1, val2;
+BOX         *box1, *box2;
+DPIX        *dpix;
+FPIX        *fpixs, *fpix1, *fpix2;
+L_KERNEL    *kel;
+PIX         *pixs, *pixg, *pixb, *pix1, *pix2;
+static char  mainName[] = "ffttest";
+
+    if (argc != 2)
+        exit(ERROR_INT(" Syntax:  ffttest filein", mainName, 1));
+
+    if ((pixs = pixRead(argv[1])) == NULL)
+        exit(ERROR_INT("pixs not made", mainName, 1));
+    pixg = pixConvertTo8(pixs, 0);
+    pixGetDimensions(pixg, &w, &h, NULL);
+    fprintf(stderr, "Image size: %d x %d\n", w, h);
+
+        /* Convolution */
+    fpixs = pixConvertToFPix(pixg, 1);
+    for (k = 0; k < sizeof(KernelSizes) / sizeof(l_int32); k++) {
+        size = KernelSizes[k];
+        kel = makeGaussianKernel(size / 2, size / 2, size / 4.0, 1.0);
+        l_setConvolveFFT(0);
+        startTimer();
+        fpix1 = fpixConvolve(fpixs, kel, 1);
+        tdirect = stopTimer();
+        l_setConvolveFFT(1);
+        startTimer();
+        fpix2 = fpixConvolveFFT(fpixs, kel, 1);
+        tfft = stopTimer();
+        maxdiff = 0.0;
+        for (i = 0; i < w * h; i += 7) {
+            fpixGetPixel(fpix1, i % w, i / w, &val1);
+            fpixGetPixel(fpix2, i % w, i / w, &val2);
+            maxdiff = L_MAX(maxdiff, L_ABS(val1 - val2));
+        }
+        fprintf(stderr, "Kernel %2d x %2d: direct = %7.3f sec, "
+                "fft = %7.3f sec, max diff = %8.5f\n",
+                size, size, tdirect, tfft, maxdiff);
+        fpixDestroy(&fpix1);
+        fpixDestroy(&fpix2);
+        kernelDestroy(&kel);
+    }
+    fpixDestroy(&fpixs);
+
+        /* Correlation */
+    pixb = pixConvertTo1(pixg, 128);
+    box1 = boxCreate(0, 0, w / 2, h / 2);
+    box2 = boxCreate(10, 10, w / 2, h / 2);
+    pix1 = pixClipRectangle(pixb, box1, NULL);
+    pix2 = pixClipRectangle(pixb, box2, NULL);
+    boxDestroy(&box1);
+    boxDestroy(&box2);
+    tab = makePixelSumTab8();
+    pixCountPixels(pix1, &area1, tab);
+    pixCountPixels(pix2, &area2, tab);
+    for (k = 0; k < sizeof(MaxShifts) / sizeof(l_int32); k++) {
+        maxshift = MaxShifts[k];
+        startTimer();
+        for (dely = -maxshift; dely <= maxshift; dely++) {
+            for (delx = -maxshift; delx <= maxshift; delx++)
+                score = pixCorrelationScoreShifted(pix1, pix2, area1, area2,
+                                                   delx, dely, tab);
+        }
+        tdirect = stopTimer();
+        startTimer();
+        dpix = pixCorrelationSurfaceFFT(pix1, pix2);
+        tfft = stopTimer();
+        fprintf(stderr, "Correlation +-%2d: direct = %7.3f sec, "
+                "fft = %7.3f sec\n", maxshift, tdirect, tfft);
+        dpixDestroy(&dpix);
+    }
+
+    FREE(tab);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixb);
+    pixDestroy(&pixg);
+    pixDestroy(&pixs);
+    fftClearPlanCache();
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * graymorph3_reg.c
+ *
+ *   Tests gray and color erosion and dilation with arbitrary flat Sels.
+ *     - A brick with don't-cares around it, which is broken into
+ *       lines, must agree with the van Herk/Gil-Werman brick.
+ *     - Dilation by a disc with off-center origin must be dual to
+ *       erosion by its reflection.
+ *     - Each component of a color result must agree with the result
+ *       on that component alone.
+ *     - Erosion by an octagon must equal erosion by a plus sign
+ *       followed by a 3x3 brick, away from the image boundary.
+ *   Require exact equality.
+ */
+
+#include "allheaders.h"
+
+static SEL *makeDiscSel(l_int32 radius, l_int32 cy, l_int32 cx);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, j, empty;
+BOX          *box;
+PIX          *pixs, *pixc, *pixt, *pixt1, *pixt2, *pixt3, *pixt4;
+SEL          *sel, *selr, *sel1, *sel2;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixs = pixRead("test8.jpg");
+    pixc = pixRead("marge.jpg");
+
+        /* 5 x 7 brick inside a 7 x 7 Sel */
+    sel = selCreateBrick(7, 7, 3, 3, SEL_DONT_CARE);
+    for (i = 1; i < 6; i++)
+        for (j = 0; j < 7; j++)
+            selSetElement(sel, i, j, SEL_HIT);
+    pixt1 = pixErodeGraySel(pixs, sel);
+    pixt2 = pixErodeGray(pixs, 7, 5);
+    regTestComparePix(rp, pixt1, pixt2);  /* 0 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixt1 = pixDilateGraySel(pixs, sel);
+    pixt2 = pixDilateGray(pixs, 7, 5);
+    regTestComparePix(rp, pixt1, pixt2);  /* 1 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    selDestroy(&sel);
+
+        /* Duality, for a disc with origin off center */
+    sel = makeDiscSel(6, 4, 9);
+    selr = selRotateOrth(sel, 2);
+    pixt1 = pixDilateGraySel(pixs, sel);
+    pixt = pixInvert(NULL, pixs);
+    pixt2 = pixErodeGraySel(pixt, selr);
+    pixInvert(pixt2, pixt2);
+    regTestComparePix(rp, pixt1, pixt2);  /* 2 */
+    pixDisplayWithTitle(pixt1, 0, 100, "Disc dilation", rp->display);
+    pixDestroy(&pixt);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    selDestroy(&selr);
+
+        /* Color, one component at a time */
+    pixt1 = pixColorMorphSel(pixc, L_MORPH_ERODE, sel);
+    pixDisplayWithTitle(pixt1, 400, 100, "Color disc erosion", rp->display);
+    for (i = COLOR_RED; i <= COLOR_BLUE; i++) {
+        pixt = pixGetRGBComponent(pixc, i);
+        pixt2 = pixErodeGraySel(pixt, sel);
+        pixt3 = pixGetRGBComponent(pixt1, i);
+        regTestComparePix(rp, pixt2, pixt3);  /* 3, 4, 5 */
+        pixDestroy(&pixt);
+        pixDestroy(&pixt2);
+        pixDestroy(&pixt3);
+    }
+    pixDestroy(&pixt1);
+    selDestroy(&sel);
+
+    pixt1 = pixColorMorph(pixc, L_MORPH_OPEN, 5, 7);
+    for (i = COLOR_RED; i <= COLOR_BLUE; i++) {
+        pixt = pixGetRGBComponent(pixc, i);
+        pixt2 = pixOpenGray(pixt, 5, 7);
+        pixt3 = pixGetRGBComponent(pixt1, i);
+        regTestComparePix(rp, pixt2, pixt3);  /* 6, 7, 8 */
+        pixDestroy(&pixt);
+        pixDestroy(&pixt2);
+        pixDestroy(&pixt3);
+    }
+    pixDestroy(&pixt1);
+
+        /* Octagon as a plus sign followed by a 3x3 brick */
+    sel = selCreateBrick(5, 5, 2, 2, SEL_HIT);
+    selSetElement(sel, 0, 0, SEL_DONT_CARE);
+    selSetElement(sel, 0, 4, SEL_DONT_CARE);
+    selSetElement(sel, 4, 0, SEL_DONT_CARE);
+    selSetElement(sel, 4, 4, SEL_DONT_CARE);
+    sel1 = selCreateBrick(3, 3, 1, 1, SEL_DONT_CARE);
+    selSetElement(sel1, 0, 1, SEL_HIT);
+    selSetElement(sel1, 1, 0, SEL_HIT);
+    selSetElement(sel1, 1, 1, SEL_HIT);
+    selSetElement(sel1, 1, 2, SEL_HIT);
+    selSetElement(sel1, 2, 1, SEL_HIT);
+    sel2 = selCreateBrick(3, 3, 1, 1, SEL_HIT);
+    pixt1 = pixErodeGraySel(pixs, sel);
+    pixt = pixErodeGraySel(pixs, sel1);
+    pixt2 = pixErodeGraySel(pixt, sel2);
+    box = boxCreate(2, 2, pixGetWidth(pixs) - 4, pixGetHeight(pixs) - 4);
+    pixt3 = pixClipRectangle(pixt1, box, NULL);
+    pixt4 = pixClipRectangle(pixt2, box, NULL);
+    regTestComparePix(rp, pixt3, pixt4);  /* 9 */
+    boxDestroy(&box);
+    pixDestroy(&pixt);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+    pixDestroy(&pixt4);
+    selDestroy(&sel);
+    selDestroy(&sel1);
+    selDestroy(&sel2);
+
+        /* The alpha byte of a color result is 0, whatever the input */
+    pixt = pixCreate(pixGetWidth(pixc), pixGetHeight(pixc), 8);
+    pixSetAll(pixt);
+    pixt1 = pixCopy(NULL, pixc);
+    pixSetRGBComponent(pixt1, pixt, L_ALPHA_CHANNEL);
+    pixt2 = pixColorMorph(pixt1, L_MORPH_CLOSE, 3, 5);
+    pixt3 = pixGetRGBComponent(pixt2, L_ALPHA_CHANNEL);
+    pixZero(pixt3, &empty);
+    regTestCompareValues(rp, 1, empty, 0.0);  /* 10 */
+    pixDestroy(&pixt);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+
+    pixDestroy(&pixs);
+    pixDestroy(&pixc);
+    return regTestCleanup(rp);
+}
+
+
+    /* Disc of hits, of size 2 * radius + 1, with origin at (cy, cx) */
+static SEL *
+makeDiscSel(l_int32  radius,
+            l_int32  cy,
+            l_int32  cx)
+{
+l_int32  i, j, size;
+SEL     *sel;
+
+    size = 2 * radius + 1;
+    sel = selCreateBrick(size, size, cy, cx, SEL_DONT_CARE);
+    for (i = 0; i < size; i++) {
+        for (j = 0; j < size; j++) {
+            if ((i - radius) * (i - radius) + (j - radius) * (j - radius) <=
+                radius * radius)
+                selSetElement(sel, i, j, SEL_HIT);
+        }
+    }
+    return sel;
+}
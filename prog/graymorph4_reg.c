@@ -0,0 +1,198 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * graymorph4_reg.c
+ *
+ *   Tests the composite grayscale operations in morphapp.c, which
+ *   fuse the morphology with the subtraction and make no full-size
+ *   intermediate images.  Each must agree with the same operation
+ *   built from the basic functions:
+ *     - white and black tophat, with opening or closing followed
+ *       by a subtraction
+ *     - morphological gradient, with dilation followed by a subtraction
+ *     - hdome, with the seed made by a copy and a constant offset
+ *     - fast tophat, with the background expanded by sampling
+ *   Sizes include 1 in either direction and Sels larger than the image.
+ *   Require exact equality.
+ */
+
+#include "allheaders.h"
+
+static PIX *refTophat(PIX *pixs, l_int32 hsize, l_int32 vsize, l_int32 type);
+static PIX *refGradient(PIX *pixs, l_int32 hsize, l_int32 vsize,
+                        l_int32 smoothing);
+static PIX *refHDome(PIX *pixs, l_int32 height, l_int32 connectivity);
+static PIX *refFastTophat(PIX *pixs, l_int32 xsize, l_int32 ysize,
+                          l_int32 type);
+
+static const l_int32  hsizes[] = {1, 3, 1, 7, 21, 45, 301};
+static const l_int32  vsizes[] = {5, 1, 3, 9, 15, 1, 41};
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, k, type;
+BOX          *box;
+PIX          *pixt, *pixs, *pixt1, *pixt2;
+PIX          *pixa[2];
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixt = pixRead("test8.jpg");
+    pixa[0] = pixClone(pixt);
+    box = boxCreate(37, 23, 211, 157);  /* odd size */
+    pixa[1] = pixClipRectangle(pixt, box, NULL);
+    boxDestroy(&box);
+    pixDestroy(&pixt);
+
+    for (k = 0; k < 2; k++) {
+        pixs = pixa[k];
+
+            /* Tophat and gradient */
+        for (i = 0; i < 7; i++) {
+            for (type = L_TOPHAT_WHITE; type <= L_TOPHAT_BLACK; type++) {
+                pixt1 = pixTophat(pixs, hsizes[i], vsizes[i], type);
+                pixt2 = refTophat(pixs, hsizes[i], vsizes[i], type);
+                regTestComparePix(rp, pixt1, pixt2);
+                pixDestroy(&pixt1);
+                pixDestroy(&pixt2);
+            }
+            pixt1 = pixMorphGradient(pixs, hsizes[i], vsizes[i], i % 3);
+            pixt2 = refGradient(pixs, hsizes[i], vsizes[i], i % 3);
+            regTestComparePix(rp, pixt1, pixt2);
+            pixDestroy(&pixt1);
+            pixDestroy(&pixt2);
+        }
+
+            /* Fast tophat, including sizes that don't divide the image */
+        for (i = 0; i < 6; i++) {
+            for (type = L_TOPHAT_WHITE; type <= L_TOPHAT_BLACK; type++) {
+                pixt1 = pixFastTophat(pixs, hsizes[i] + 1, vsizes[i], type);
+                pixt2 = refFastTophat(pixs, hsizes[i] + 1, vsizes[i], type);
+                regTestComparePix(rp, pixt1, pixt2);
+                pixDestroy(&pixt1);
+                pixDestroy(&pixt2);
+            }
+        }
+
+            /* HDome */
+        for (i = 0; i < 3; i++) {
+            pixt1 = pixHDome(pixs, 20 + 50 * i, (i & 1) ? 8 : 4);
+            pixt2 = refHDome(pixs, 20 + 50 * i, (i & 1) ? 8 : 4);
+            regTestComparePix(rp, pixt1, pixt2);
+            pixDestroy(&pixt1);
+            pixDestroy(&pixt2);
+        }
+    }
+
+    pixDestroy(&pixa[0]);
+    pixDestroy(&pixa[1]);
+    return regTestCleanup(rp);
+}
+
+
+static PIX *
+refTophat(PIX     *pixs,
+          l_int32  hsize,
+          l_int32  vsize,
+          l_int32  type)
+{
+PIX  *pixt, *pixd;
+
+    if (type == L_TOPHAT_WHITE) {
+        pixt = pixOpenGray(pixs, hsize, vsize);
+        pixd = pixSubtractGray(NULL, pixs, pixt);
+        pixDestroy(&pixt);
+    }
+    else {
+        pixd = pixCloseGray(pixs, hsize, vsize);
+        pixSubtractGray(pixd, pixd, pixs);
+    }
+    return pixd;
+}
+
+
+static PIX *
+refGradient(PIX     *pixs,
+            l_int32  hsize,
+            l_int32  vsize,
+            l_int32  smoothing)
+{
+PIX  *pixg, *pixd;
+
+    pixg = pixBlockconvGray(pixs, NULL, smoothing, smoothing);
+    pixd = pixDilateGray(pixg, hsize, vsize);
+    pixSubtractGray(pixd, pixd, pixg);
+    pixDestroy(&pixg);
+    return pixd;
+}
+
+
+static PIX *
+refHDome(PIX     *pixs,
+         l_int32  height,
+         l_int32  connectivity)
+{
+PIX  *pixsd, *pixd;
+
+    pixsd = pixCopy(NULL, pixs);
+    pixAddConstantGray(pixsd, -height);
+    pixSeedfillGray(pixsd, pixs, connectivity);
+    pixd = pixSubtractGray(NULL, pixs, pixsd);
+    pixDestroy(&pixsd);
+    return pixd;
+}
+
+
+static PIX *
+refFastTophat(PIX     *pixs,
+              l_int32  xsize,
+              l_int32  ysize,
+              l_int32  type)
+{
+PIX  *pixt1, *pixt2, *pixt3, *pixd;
+
+    if (type == L_TOPHAT_WHITE) {
+        pixt1 = pixScaleGrayMinMax(pixs, xsize, ysize, L_CHOOSE_MIN);
+        pixt2 = pixBlockconv(pixt1, 1, 1);
+        pixt3 = pixScaleBySampling(pixt2, xsize, ysize);
+        pixd = pixSubtractGray(NULL, pixs, pixt3);
+        pixDestroy(&pixt3);
+    }
+    else {
+        pixt1 = pixScaleGrayMinMax(pixs, xsize, ysize, L_CHOOSE_MAX);
+        pixt2 = pixBlockconv(pixt1, 1, 1);
+        pixd = pixScaleBySampling(pixt2, xsize, ysize);
+        pixSubtractGray(pixd, pixd, pixs);
+    }
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    return pixd;
+}
@@ -0,0 +1,200 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * hmtmultiple_reg.c
+ *
+ *   Tests pixHMTMultiple(), which matches many hit-miss Sels in a
+ *   single pass.  Each result must be identical to pixHMT() for
+ *   that Sel.  The Sels are:
+ *     - boundary Sels made from characters on the page, as used
+ *       for finding patterns
+ *     - Sels with elements at large offsets, with the origin outside
+ *       the Sel, with only misses and with no elements at all
+ *   These are applied to the page, to an odd-sized piece of it
+ *   (so that the last 2x2 blocks of the coarse test are partial),
+ *   and to the inverted page, for which misses are tested first.
+ *   Finally, a single Sel with only odd offsets, which has no
+ *   elements for the coarse test, is applied to a small piece.
+ */
+
+#include "allheaders.h"
+
+static SELA *makeTestSels(PIX *pixs, l_int32 nchars);
+static void addSel(SELA *sela, SEL *sel);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, j, n, same;
+l_float32     t1, t2;
+BOX          *box;
+PIX          *pixt, *pixs, *pix1, *pix2;
+PIXA         *pixa;
+SEL          *sel;
+SELA         *sela;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixt = pixRead("tribune-page-4x.png");
+    sela = makeTestSels(pixt, 40);
+    n = selaGetCount(sela);
+
+    for (i = 0; i < 3; i++) {
+        if (i == 0) {
+            pixs = pixClone(pixt);
+        }
+        else if (i == 1) {
+            box = boxCreate(101, 203, 417, 333);
+            pixs = pixClipRectangle(pixt, box, NULL);
+            boxDestroy(&box);
+        }
+        else {
+            pixs = pixInvert(NULL, pixt);
+        }
+
+        startTimer();
+        pixa = pixHMTMultiple(pixs, sela);
+        t1 = stopTimer();
+        regTestCompareValues(rp, n, pixaGetCount(pixa), 0.0);
+        t2 = 0.0;
+        for (j = 0; j < n; j++) {
+            startTimer();
+            pix1 = pixHMT(NULL, pixs, selaGetSel(sela, j));
+            t2 += stopTimer();
+            pix2 = pixaGetPix(pixa, j, L_CLONE);
+            pixEqual(pix1, pix2, &same);
+            if (!same) {
+                fprintf(stderr, "Failure for sel %d\n", j);
+                regTestComparePix(rp, pix1, pix2);
+            }
+            pixDestroy(&pix1);
+            pixDestroy(&pix2);
+        }
+        regTestCompareValues(rp, 1, 1, 0.0);  /* all sels agree */
+        fprintf(stderr, "%d sels: multiple = %7.3f sec, "
+                "separate = %7.3f sec\n", n, t1, t2);
+        pixaDestroy(&pixa);
+        pixDestroy(&pixs);
+    }
+
+    selaDestroy(&sela);
+
+        /* No coarse test: the elements are at x = -1 and x = 1 */
+    sela = selaCreate(1);
+    sel = selCreateFromString("x x", 1, 3, "oddsel");
+    selSetOrigin(sel, 0, 1);
+    selaAddSel(sela, sel, NULL, 0);
+    box = boxCreate(300, 400, 200, 100);
+    pixs = pixClipRectangle(pixt, box, NULL);
+    boxDestroy(&box);
+    pixa = pixHMTMultiple(pixs, sela);
+    regTestCompareValues(rp, 1, (pixa) ? pixaGetCount(pixa) : 0, 0.0);
+    if (pixa) {
+        pix1 = pixHMT(NULL, pixs, sel);
+        pix2 = pixaGetPix(pixa, 0, L_CLONE);
+        regTestComparePix(rp, pix1, pix2);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+    pixaDestroy(&pixa);
+    pixDestroy(&pixs);
+    selaDestroy(&sela);
+    pixDestroy(&pixt);
+    return regTestCleanup(rp);
+}
+
+
+    /* Makes boundary Sels from up to @nchars characters on the page,
+     * and adds some Sels that exercise the border and the ordering */
+static SELA *
+makeTestSels(PIX     *pixs,
+             l_int32  nchars)
+{
+l_int32  i, n, w, h;
+BOXA    *boxa;
+PIX     *pixc;
+PIXA    *pixa;
+SEL     *sel;
+SELA    *sela;
+
+    sela = selaCreate(0);
+    boxa = pixConnComp(pixs, &pixa, 8);
+    n = pixaGetCount(pixa);
+    for (i = 0; i < n && selaGetCount(sela) < nchars; i += 7) {
+        pixaGetPixDimensions(pixa, i, &w, &h, NULL);
+        if (w < 6 || h < 8 || w > 40 || h > 40)
+            continue;
+        pixc = pixaGetPix(pixa, i, L_CLONE);
+        sel = pixGenerateSelBoundary(pixc, 1, 1, 0, 0, 1, 1, 1, 1, NULL);
+        addSel(sela, sel);
+        pixDestroy(&pixc);
+    }
+    boxaDestroy(&boxa);
+    pixaDestroy(&pixa);
+
+        /* Elements 40 pixels or more from the origin */
+    sel = selCreate(3, 81, NULL);
+    selSetOrigin(sel, 1, 40);
+    selSetElement(sel, 1, 0, SEL_HIT);
+    selSetElement(sel, 1, 80, SEL_HIT);
+    selSetElement(sel, 0, 40, SEL_MISS);
+    addSel(sela, sel);
+    sel = selCreate(71, 5, NULL);
+    selSetOrigin(sel, 0, 2);
+    selSetElement(sel, 0, 2, SEL_HIT);
+    selSetElement(sel, 70, 4, SEL_HIT);
+    addSel(sela, sel);
+
+        /* Origin outside the Sel */
+    sel = selCreateBrick(3, 5, -4, 9, SEL_HIT);
+    selSetElement(sel, 1, 2, SEL_MISS);
+    addSel(sela, sel);
+
+        /* Only misses */
+    sel = selCreateBrick(9, 9, 4, 4, SEL_MISS);
+    addSel(sela, sel);
+
+        /* No elements */
+    sel = selCreateBrick(3, 3, 1, 1, SEL_DONT_CARE);
+    addSel(sela, sel);
+    return sela;
+}
+
+
+static void
+addSel(SELA  *sela,
+       SEL   *sel)
+{
+char  buf[32];
+
+    sprintf(buf, "sel%d", selaGetCount(sela));
+    selaAddSel(sela, sel, buf, 0);
+    return;
+}
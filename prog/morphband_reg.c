@@ -0,0 +1,151 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+/*
+ *  morphband_reg.c
+ *
+ *    Regression test for binary morphology done in horizontal bands.
+ *    Each band is computed independently, and the assembled result
+ *    must be identical to the operation on the whole image:
+ *      - generic ops with a brick, a large decomposed Sel and a
+ *        hit-miss Sel, with pixMorphByBand()
+ *      - compiled sequences with dwa, composite and rasterop steps,
+ *        an added border, and grayscale, with pixMorphSeqApplyByBand()
+ *    Both boundary conditions are tested, with the foreground touching
+ *    the image boundary and with bands that are smaller than the Sel.
+ */
+
+#include "allheaders.h"
+
+static const char  *binseq[] = {
+    "d3.3 + e1.7 + o5.1",
+    "o21.21 + c15.1",
+    "c51.51",
+    "b32 + e70.3 + d3.70",
+    "r2 + c5.5 + x2"};
+
+static const char  *grayseq[] = {
+    "c5.3 + o7.5",
+    "d5.5 + tw9.9"};
+
+static const l_int32  nbands[] = {2, 7, 40};
+
+static const char  *selhmt = "oooo"
+                             "oxxo"
+                             "oCxo"
+                             "o  o";
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, j, k, type, nbin, ngray;
+BOX          *box;
+PIX          *pixs, *pixt, *pixg, *pix1, *pix2;
+SEL          *sel[3];
+L_MORPHSEQ   *mseq;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* Clip so that the foreground touches the image boundary */
+    pixt = pixRead("rabi.png");
+    box = boxCreate(500, 500, 701, 603);
+    pixs = pixClipRectangle(pixt, box, NULL);
+    pixDestroy(&pixt);
+    boxDestroy(&box);
+
+    sel[0] = selCreateBrick(7, 9, 2, 6, SEL_HIT);
+    sel[1] = selCreateBrick(41, 35, 10, 30, SEL_HIT);
+    sel[2] = selCreateFromString(selhmt, 4, 4, "hmt");
+
+    nbin = sizeof(binseq) / sizeof(char *);
+    for (j = 0; j < 2; j++) {
+        if (j == 0)
+            resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+        else
+            resetMorphBoundaryCondition(SYMMETRIC_MORPH_BC);
+
+            /* Generic ops */
+        for (i = 0; i < 3; i++) {
+            for (type = L_MORPH_DILATE; type <= L_MORPH_HMT; type++) {
+                if ((i == 2) != (type == L_MORPH_HMT))
+                    continue;
+                if (type == L_MORPH_DILATE)
+                    pix1 = pixDilate(NULL, pixs, sel[i]);
+                else if (type == L_MORPH_ERODE)
+                    pix1 = pixErode(NULL, pixs, sel[i]);
+                else if (type == L_MORPH_OPEN)
+                    pix1 = pixOpen(NULL, pixs, sel[i]);
+                else if (type == L_MORPH_CLOSE)
+                    pix1 = pixClose(NULL, pixs, sel[i]);
+                else
+                    pix1 = pixHMT(NULL, pixs, sel[i]);
+                for (k = 0; k < 3; k++) {
+                    pix2 = pixMorphByBand(pixs, sel[i], type, nbands[k]);
+                    regTestComparePix(rp, pix1, pix2);
+                    pixDestroy(&pix2);
+                }
+                pixDestroy(&pix1);
+            }
+        }
+
+            /* Compiled sequences */
+        for (i = 0; i < nbin; i++) {
+            mseq = morphSeqCreate(binseq[i], 1);
+            pix1 = pixMorphSeqApply(pixs, mseq);
+            for (k = 0; k < 3; k++) {
+                pix2 = pixMorphSeqApplyByBand(pixs, mseq, nbands[k]);
+                regTestComparePix(rp, pix1, pix2);
+                pixDestroy(&pix2);
+            }
+            pixDestroy(&pix1);
+            morphSeqDestroy(&mseq);
+        }
+    }
+    resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+
+    pixg = pixScaleToGray2(pixs);
+    ngray = sizeof(grayseq) / sizeof(char *);
+    for (i = 0; i < ngray; i++) {
+        mseq = morphSeqCreate(grayseq[i], 8);
+        pix1 = pixMorphSeqApply(pixg, mseq);
+        for (k = 0; k < 3; k++) {
+            pix2 = pixMorphSeqApplyByBand(pixg, mseq, nbands[k]);
+            regTestComparePix(rp, pix1, pix2);
+            pixDestroy(&pix2);
+        }
+        pixDestroy(&pix1);
+        morphSeqDestroy(&mseq);
+    }
+
+    for (i = 0; i < 3; i++)
+        selDestroy(&sel[i]);
+    pixDestroy(&pixs);
+    pixDestroy(&pixg);
+    return regTestCleanup(rp);
+}
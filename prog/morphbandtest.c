@@ -0,0 +1,188 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  morphbandtest.c
+ *
+ *    Scaling of binary morphology done in horizontal bands.
+ *    For each number of bands, every band is timed separately.
+ *    The bands are independent, so with one thread per band the
+ *    elapsed time would be that of the slowest band; the reported
+ *    speedup is the whole-image time divided by that.  The sum over
+ *    bands, relative to the whole image, shows the cost of the halos.
+ *    The assembled result is checked against the whole-image result.
+ *
+ *    Syntax:  morphbandtest filein [factor]
+ *    The input image is converted to 1 bpp and expanded by factor
+ *    (default 2; a 300 ppi page becomes a 600 ppi page).
+ */
+
+#include "allheaders.h"
+
+static const char    *Sequences[] = {"c51.51",      /* composite */
+                                     "o25.25",      /* dwa */
+                                     "d5.5 + e5.5"};
+static const l_int32  NBands[] = {1, 2, 4, 8, 16};
+
+static void TimeSequence(PIX *pixs, const char *sequence);
+static void TimeSel(PIX *pixs, SEL *sel, l_int32 type, const char *name);
+static void Report(l_int32 nbands, l_float32 tall, l_float32 tsum,
+                   l_float32 tmax, l_int32 same);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32      i, w, h, factor;
+PIX         *pixt, *pixs;
+SEL         *sel;
+static char  mainName[] = "morphbandtest";
+
+    if (argc != 2 && argc != 3)
+        exit(ERROR_INT(" Syntax:  morphbandtest filein [factor]",
+                       mainName, 1));
+
+    if ((pixt = pixRead(argv[1])) == NULL)
+        exit(ERROR_INT("pixt not made", mainName, 1));
+    factor = (argc == 3) ? atoi(argv[2]) : 2;
+    pixs = pixConvertTo1(pixt, 128);
+    pixDestroy(&pixt);
+    if (factor > 1) {
+        pixt = pixExpandReplicate(pixs, factor);
+        pixDestroy(&pixs);
+        pixs = pixt;
+    }
+    pixGetDimensions(pixs, &w, &h, NULL);
+    fprintf(stderr, "Image size: %d x %d\n", w, h);
+
+    for (i = 0; i < sizeof(Sequences) / sizeof(char *); i++)
+        TimeSequence(pixs, Sequences[i]);
+
+    sel = selCreateBrick(9, 9, 4, 4, SEL_HIT);
+    TimeSel(pixs, sel, L_MORPH_DILATE, "dilate 9x9 (generic)");
+    selDestroy(&sel);
+    sel = selCreateBrick(3, 3, 1, 1, SEL_HIT);
+    selSetElement(sel, 1, 1, SEL_MISS);
+    TimeSel(pixs, sel, L_MORPH_HMT, "hmt 3x3 (generic)");
+    selDestroy(&sel);
+
+    pixDestroy(&pixs);
+    return 0;
+}
+
+
+static void
+TimeSequence(PIX         *pixs,
+             const char  *sequence)
+{
+l_int32      i, k, n, h, bh, y, same;
+l_float32    tall, tsum, tmax, t;
+L_MORPHSEQ  *mseq;
+PIX         *pix1, *pix2;
+
+    fprintf(stderr, "Sequence \"%s\":\n", sequence);
+    mseq = morphSeqCreate(sequence, 1);
+    startTimer();
+    pix1 = pixMorphSeqApply(pixs, mseq);
+    tall = stopTimer();
+    h = pixGetHeight(pixs);
+    for (k = 0; k < sizeof(NBands) / sizeof(l_int32); k++) {
+        n = NBands[k];
+        bh = (h + n - 1) / n;
+        pix2 = pixCreateTemplate(pixs);
+        tsum = tmax = 0.0;
+        for (y = 0; y < h; y += bh) {
+            startTimer();
+            pixMorphSeqApplyBand(pix2, pixs, mseq, y, L_MIN(bh, h - y));
+            t = stopTimer();
+            tsum += t;
+            tmax = L_MAX(tmax, t);
+        }
+        pixEqual(pix1, pix2, &same);
+        Report(n, tall, tsum, tmax, same);
+        pixDestroy(&pix2);
+    }
+    pixDestroy(&pix1);
+    morphSeqDestroy(&mseq);
+    return;
+}
+
+
+static void
+TimeSel(PIX         *pixs,
+        SEL         *sel,
+        l_int32      type,
+        const char  *name)
+{
+l_int32    k, n, h, bh, y, same;
+l_float32  tall, tsum, tmax, t;
+PIX       *pix1, *pix2;
+SELA      *plan;
+
+    fprintf(stderr, "Operation %s:\n", name);
+    startTimer();
+    if (type == L_MORPH_DILATE)
+        pix1 = pixDilate(NULL, pixs, sel);
+    else
+        pix1 = pixHMT(NULL, pixs, sel);
+    tall = stopTimer();
+    h = pixGetHeight(pixs);
+    plan = (type == L_MORPH_HMT) ? NULL : selMakeMorphPlan(sel);
+    for (k = 0; k < sizeof(NBands) / sizeof(l_int32); k++) {
+        n = NBands[k];
+        bh = (h + n - 1) / n;
+        pix2 = pixCreateTemplate(pixs);
+        tsum = tmax = 0.0;
+        for (y = 0; y < h; y += bh) {
+            startTimer();
+            pixMorphBand(pix2, pixs, sel, plan, type, y, L_MIN(bh, h - y));
+            t = stopTimer();
+            tsum += t;
+            tmax = L_MAX(tmax, t);
+        }
+        pixEqual(pix1, pix2, &same);
+        Report(n, tall, tsum, tmax, same);
+        pixDestroy(&pix2);
+    }
+    pixDestroy(&pix1);
+    selaDestroy(&plan);
+    return;
+}
+
+
+static void
+Report(l_int32    nbands,
+       l_float32  tall,
+       l_float32  tsum,
+       l_float32  tmax,
+       l_int32    same)
+{
+    fprintf(stderr, "  %2d bands: sum = %6.3f sec (%5.1f%%), "
+            "slowest = %6.3f sec, speedup = %5.2f  %s\n",
+            nbands, tsum, 100.0 * tsum / L_MAX(tall, 0.001), tmax,
+            tall / L_MAX(tmax, 0.001), (same) ? "" : "*** DIFFERENT ***");
+    return;
+}
@@ -0,0 +1,175 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * morphsela_reg.c
+ *
+ *   Tests pixUnionOfMorphOps() and pixIntersectionOfMorphOps(),
+ *   which apply all the Sels in a single pass, against the union
+ *   and intersection of the separate operations.
+ *     - The Sels are hit-miss Sels for T-junctions, and a mixture
+ *       of small Sels with one large brick, which is done separately.
+ *     - All five operations are tested, with both boundary conditions.
+ *     - The result computed in bands with pixMorphSelaBand() must
+ *       agree with the result on the whole image.
+ *   Require exact equality.
+ */
+
+#include "allheaders.h"
+
+static SELA *makeMixedSels(void);
+static PIX *refCombine(PIX *pixs, SELA *sela, l_int32 type, l_int32 op);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, j, bc, type, op, h, y;
+l_float32     t1, t2;
+BOX          *box;
+PIX          *pixt, *pixs, *pix1, *pix2, *pix3;
+SELA         *sela, *selam, *selat;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixt = pixRead("tribune-page-4x.png");
+    box = boxCreate(101, 203, 1001, 703);
+    pixs = pixClipRectangle(pixt, box, NULL);
+    boxDestroy(&box);
+    pixDestroy(&pixt);
+    h = pixGetHeight(pixs);
+    selat = selaAddTJunctions(NULL, 6, 5, 4, 0);
+    selam = makeMixedSels();
+
+    for (bc = 0; bc < 2; bc++) {
+        resetMorphBoundaryCondition((bc == 0) ? ASYMMETRIC_MORPH_BC :
+                                                SYMMETRIC_MORPH_BC);
+        for (i = 0; i < 2; i++) {
+            sela = (i == 0) ? selat : selam;
+            for (type = L_MORPH_DILATE; type <= L_MORPH_HMT; type++) {
+                for (j = 0; j < 2; j++) {
+                    op = (j == 0) ? L_UNION : L_INTERSECTION;
+                    startTimer();
+                    if (op == L_UNION)
+                        pix1 = pixUnionOfMorphOps(pixs, sela, type);
+                    else
+                        pix1 = pixIntersectionOfMorphOps(pixs, sela, type);
+                    t1 = stopTimer();
+                    startTimer();
+                    pix2 = refCombine(pixs, sela, type, op);
+                    t2 = stopTimer();
+                    regTestComparePix(rp, pix1, pix2);
+                    if (bc == 0 && i == 0 && type == L_MORPH_HMT)
+                        fprintf(stderr, "%s of hmt: single pass = %7.3f sec, "
+                                "separate = %7.3f sec\n",
+                                (op == L_UNION) ? "union" : "intersection",
+                                t1, t2);
+
+                        /* Uneven bands */
+                    pix3 = pixCreateTemplate(pixs);
+                    for (y = 0; y < h; y += 97)
+                        pixMorphSelaBand(pix3, pixs, sela, type, op, y,
+                                         L_MIN(97, h - y));
+                    regTestComparePix(rp, pix1, pix3);
+                    pixDestroy(&pix1);
+                    pixDestroy(&pix2);
+                    pixDestroy(&pix3);
+                }
+            }
+        }
+    }
+    resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+
+    selaDestroy(&selat);
+    selaDestroy(&selam);
+    pixDestroy(&pixs);
+    return regTestCleanup(rp);
+}
+
+
+    /* Small bricks and lines, a Sel with hits and misses and the
+     * origin outside, and a brick with too many elements to be
+     * combined with the others */
+static SELA *
+makeMixedSels(void)
+{
+SEL   *sel;
+SELA  *sela;
+
+    sela = selaCreate(0);
+    sel = selCreateBrick(1, 7, 0, 3, SEL_HIT);
+    selaAddSel(sela, sel, "hline", 0);
+    sel = selCreateBrick(5, 1, 1, 0, SEL_HIT);
+    selaAddSel(sela, sel, "vline", 0);
+    sel = selCreateBrick(3, 3, 1, 1, SEL_HIT);
+    selaAddSel(sela, sel, "brick3", 0);
+    sel = selCreateBrick(3, 5, -2, 7, SEL_HIT);
+    selSetElement(sel, 1, 2, SEL_MISS);
+    selSetElement(sel, 0, 0, SEL_DONT_CARE);
+    selaAddSel(sela, sel, "offset", 0);
+    sel = selCreateBrick(11, 9, 5, 4, SEL_HIT);
+    selaAddSel(sela, sel, "brick11", 0);
+    return sela;
+}
+
+
+    /* The union or intersection of the separate operations */
+static PIX *
+refCombine(PIX     *pixs,
+           SELA    *sela,
+           l_int32  type,
+           l_int32  op)
+{
+l_int32  i, n;
+PIX     *pixt, *pixd;
+SEL     *sel;
+
+    pixd = pixCreateTemplate(pixs);
+    if (op == L_INTERSECTION)
+        pixSetAll(pixd);
+    n = selaGetCount(sela);
+    for (i = 0; i < n; i++) {
+        sel = selaGetSel(sela, i);
+        if (type == L_MORPH_DILATE)
+            pixt = pixDilate(NULL, pixs, sel);
+        else if (type == L_MORPH_ERODE)
+            pixt = pixErode(NULL, pixs, sel);
+        else if (type == L_MORPH_OPEN)
+            pixt = pixOpen(NULL, pixs, sel);
+        else if (type == L_MORPH_CLOSE)
+            pixt = pixClose(NULL, pixs, sel);
+        else
+            pixt = pixHMT(NULL, pixs, sel);
+        if (op == L_UNION)
+            pixOr(pixd, pixd, pixt);
+        else
+            pixAnd(pixd, pixd, pixt);
+        pixDestroy(&pixt);
+    }
+    return pixd;
+}
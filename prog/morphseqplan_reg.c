@@ -0,0 +1,145 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ *  morphseqplan_reg.c
+ *
+ *    Regression test for compiled morphological sequences.
+ *    The result of running a compiled sequence must be identical to
+ *    that from the interpreters pixMorphSequence() and
+ *    pixGrayMorphSequence(), for both boundary conditions and with
+ *    foreground touching the image boundary.  The sequences exercise
+ *    dwa, composite and rasterop steps, fused reductions and
+ *    expansions, and an added border.  Dwa steps are also run after
+ *    an expansion, where the reused intermediate images change size.
+ */
+
+#include "allheaders.h"
+
+static const char  *binseq[] = {
+    "d3.3 + e1.7 + o5.1",
+    "c9.1 + c1.9",
+    "O1.3 + C3.1 + R22 + D2.2 + X4",
+    "b32 + o1.3 + C3.1 + r2 + r3 + e2.2 + D3.2 + X2 + X2",
+    "d17.1 + e1.23 + o53.3",
+    "b40 + c48.1 + o18.18 + c64.5",
+    "d1.1 + c1.1 + o10.12 + r1111 + x16"};
+
+static const char  *expseq[] = {
+    "d3.3 + x2 + d3.3",
+    "e3.3 + x2 + o5.5",
+    "d3.1 + x2 + d3.1"};
+
+static const char  *grayseq[] = {
+    "c5.3 + o7.5",
+    "c9.9 + tw9.9",
+    "e3.3 + d3.3 + tw5.5",
+    "d5.5 + e5.5 + tb3.3"};
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, j, nbin, nexp, ngray;
+BOX          *box;
+PIX          *pixs, *pixt, *pixg, *pix1, *pix2;
+L_MORPHSEQ   *mseq;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* Clip so that the foreground touches the image boundary */
+    pixt = pixRead("rabi.png");
+    box = boxCreate(500, 500, 701, 603);
+    pixs = pixClipRectangle(pixt, box, NULL);
+    pixDestroy(&pixt);
+    boxDestroy(&box);
+
+    nbin = sizeof(binseq) / sizeof(char *);
+    for (j = 0; j < 2; j++) {
+        if (j == 0)
+            resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+        else
+            resetMorphBoundaryCondition(SYMMETRIC_MORPH_BC);
+        for (i = 0; i < nbin; i++) {
+            mseq = morphSeqCreate(binseq[i], 1);
+            pix1 = pixMorphSequence(pixs, binseq[i], 0);
+            pix2 = pixMorphSeqApply(pixs, mseq);
+            regTestComparePix(rp, pix1, pix2);  /* 0, 2, ... 26 */
+            pixDestroy(&pix1);
+            pixDestroy(&pix2);
+
+                /* The same plan works on other images */
+            pixInvert(pixs, pixs);
+            pix1 = pixMorphSequence(pixs, binseq[i], 0);
+            pix2 = pixMorphSeqApply(pixs, mseq);
+            regTestComparePix(rp, pix1, pix2);  /* 1, 3, ... 27 */
+            pixDestroy(&pix1);
+            pixDestroy(&pix2);
+            pixInvert(pixs, pixs);
+            morphSeqDestroy(&mseq);
+        }
+    }
+    resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+
+    pixg = pixScaleToGray2(pixs);
+    ngray = sizeof(grayseq) / sizeof(char *);
+    for (i = 0; i < ngray; i++) {
+        mseq = morphSeqCreate(grayseq[i], 8);
+        pix1 = pixGrayMorphSequence(pixg, grayseq[i], 0, 0);
+        pix2 = pixMorphSeqApply(pixg, mseq);
+        regTestComparePix(rp, pix1, pix2);  /* 28 - 31 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        morphSeqDestroy(&mseq);
+    }
+
+        /* Invalid sequences are rejected at compile time */
+    mseq = morphSeqCreate("e3.3 + b2", 1);
+    regTestCompareValues(rp, 1, (mseq == NULL), 0);  /* 32 */
+    mseq = morphSeqCreate("d4.3", 8);
+    regTestCompareValues(rp, 1, (mseq == NULL), 0);  /* 33 */
+
+        /* Dwa steps after an expansion */
+    box = boxCreate(100, 100, 128, 128);
+    pixt = pixClipRectangle(pixs, box, NULL);
+    boxDestroy(&box);
+    nexp = sizeof(expseq) / sizeof(char *);
+    for (i = 0; i < nexp; i++) {
+        mseq = morphSeqCreate(expseq[i], 1);
+        pix1 = pixMorphSequence(pixt, expseq[i], 0);
+        pix2 = pixMorphSeqApply(pixt, mseq);
+        regTestComparePix(rp, pix1, pix2);  /* 34 - 36 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        morphSeqDestroy(&mseq);
+    }
+    pixDestroy(&pixt);
+
+    pixDestroy(&pixs);
+    pixDestroy(&pixg);
+    return regTestCleanup(rp);
+}
@@ -0,0 +1,228 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * numcolors_reg.c
+ *
+ *   Tests the counting of distinct colors against a count made by
+ *   sorting the pixel values:
+ *     - pixCountRGBColors(), with and without a limit, and with
+ *       subsampling
+ *     - pixNumColors() on rgb and on 2, 4 and 8 bpp images
+ *   The rgb images include a page with flat regions and an image
+ *   with 2^20 colors.  Also tests pixNumberOccupiedOctcubes()
+ *   against the octcube histogram.
+ */
+
+#include "allheaders.h"
+
+static const char *rgbimage[3] = {"fish24.jpg",
+                                  "weasel8.240c.png",
+                                  "weasel-113c.png"};
+static const char *grayimage[3] = {"weasel2.4g.png",
+                                   "weasel4.16g.png",
+                                   "weasel8.149g.png"};
+
+static PIX *makeFlatPage(void);
+static PIX *makeManyColors(void);
+static l_int32 refCount(PIX *pixs, l_int32 factor);
+static l_int32 refOctcubeCount(PIX *pixs, l_int32 level, l_int32 mincount);
+static int cmpValues(const void *p1, const void *p2);
+static void testRGB(L_REGPARAMS *rp, PIX *pixs);
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32       i, count, ncolors;
+PIX          *pixs, *pix1;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* rgb images, with few and many colors */
+    for (i = 0; i < 3; i++) {
+        pixs = pixRead(rgbimage[i]);
+        pix1 = pixConvertTo32(pixs);
+        testRGB(rp, pix1);  /* 0 - 32 */
+        pixDestroy(&pixs);
+        pixDestroy(&pix1);
+    }
+    pix1 = makeFlatPage();
+    testRGB(rp, pix1);  /* 33 - 43 */
+    pixDestroy(&pix1);
+    pix1 = makeManyColors();
+    testRGB(rp, pix1);  /* 44 - 54 */
+    pixDestroy(&pix1);
+
+        /* 2, 4 and 8 bpp, with colormaps */
+    for (i = 0; i < 3; i++) {
+        pixs = pixRead(grayimage[i]);
+        count = refCount(pixs, 1);
+        pixNumColors(pixs, 1, &ncolors);
+        regTestCompareValues(rp, count, ncolors, 0);  /* 55, 57, 59 */
+        count = refCount(pixs, 3);
+        pixNumColors(pixs, 3, &ncolors);
+        regTestCompareValues(rp, count, ncolors, 0);  /* 56, 58, 60 */
+        pixDestroy(&pixs);
+    }
+
+    return regTestCleanup(rp);
+}
+
+
+    /* Makes 11 tests */
+static void
+testRGB(L_REGPARAMS  *rp,
+        PIX          *pixs)
+{
+l_int32  factor, count, ncolors;
+
+    for (factor = 1; factor <= 3; factor += 2) {
+        count = refCount(pixs, factor);
+        pixCountRGBColors(pixs, factor, 0, &ncolors);
+        regTestCompareValues(rp, count, ncolors, 0);
+        pixCountRGBColors(pixs, factor, 256, &ncolors);
+        regTestCompareValues(rp, L_MIN(count, 257), ncolors, 0);
+        pixCountRGBColors(pixs, factor, 100, &ncolors);
+        regTestCompareValues(rp, L_MIN(count, 101), ncolors, 0);
+        pixNumColors(pixs, factor, &ncolors);
+        regTestCompareValues(rp, (count > 256) ? 0 : count, ncolors, 0);
+    }
+    pixNumberOccupiedOctcubes(pixs, 4, 20, -1, &ncolors);
+    regTestCompareValues(rp, refOctcubeCount(pixs, 4, 20), ncolors, 0);
+    pixNumberOccupiedOctcubes(pixs, 3, 1, -1, &ncolors);
+    regTestCompareValues(rp, refOctcubeCount(pixs, 3, 1), ncolors, 0);
+    pixNumberOccupiedOctcubes(pixs, 5, 5, -1, &ncolors);
+    regTestCompareValues(rp, refOctcubeCount(pixs, 5, 5), ncolors, 0);
+    return;
+}
+
+
+    /* White page, with repeated lines, a few flat boxes and a
+     * gradient at the bottom */
+static PIX *
+makeFlatPage(void)
+{
+l_int32  i, j;
+BOX     *box;
+PIX     *pixd;
+
+    pixd = pixCreate(800, 1000, 32);
+    pixSetAll(pixd);
+    box = boxCreate(100, 100, 300, 200);
+    pixSetInRectArbitrary(pixd, box, 0xff000000);
+    boxDestroy(&box);
+    box = boxCreate(300, 400, 400, 100);
+    pixSetInRectArbitrary(pixd, box, 0x2040a000);
+    boxDestroy(&box);
+    for (i = 900; i < 1000; i++) {
+        for (j = 0; j < 800; j++)
+            pixSetRGBPixel(pixd, j, i, j / 4, (i - 900) / 2, 128);
+    }
+    return pixd;
+}
+
+
+    /* 2^20 colors, spread over the rgb space; the alpha byte varies */
+static PIX *
+makeManyColors(void)
+{
+l_int32    i, w, h;
+l_uint32  *data;
+PIX       *pixd;
+
+    w = 1024;
+    h = 1024;
+    pixd = pixCreate(w, h, 32);
+    data = pixGetData(pixd);
+    for (i = 0; i < w * h; i++)
+        data[i] = ((l_uint32)i * 2654435761u & 0xffffff00) | (i & 0xff);
+    return pixd;
+}
+
+
+    /* Counts distinct values by sorting the rgb values of the sampled
+     * pixels, or the values of a colormapped or gray image */
+static l_int32
+refCount(PIX     *pixs,
+         l_int32  factor)
+{
+l_int32    i, j, n, w, h, d, count;
+l_uint32   val;
+l_uint32  *array;
+
+    pixGetDimensions(pixs, &w, &h, &d);
+    array = (l_uint32 *)CALLOC(w * h, sizeof(l_uint32));
+    n = 0;
+    for (i = 0; i < h; i += factor) {
+        for (j = 0; j < w; j += factor) {
+            pixGetPixel(pixs, j, i, &val);
+            array[n++] = (d == 32) ? val >> 8 : val;
+        }
+    }
+    qsort(array, n, sizeof(l_uint32), cmpValues);
+    for (i = 0, count = 0; i < n; i++) {
+        if (i == 0 || array[i] != array[i - 1])
+            count++;
+    }
+    FREE(array);
+    return count;
+}
+
+
+static l_int32
+refOctcubeCount(PIX     *pixs,
+                l_int32  level,
+                l_int32  mincount)
+{
+l_int32   i, n, val, count;
+NUMA     *na;
+
+    na = pixOctcubeHistogram(pixs, level, NULL);
+    n = numaGetCount(na);
+    for (i = 0, count = 0; i < n; i++) {
+        numaGetIValue(na, i, &val);
+        if (val >= mincount)
+            count++;
+    }
+    numaDestroy(&na);
+    return count;
+}
+
+
+static int
+cmpValues(const void  *p1,
+          const void  *p2)
+{
+l_uint32  val1, val2;
+
+    val1 = *(const l_uint32 *)p1;
+    val2 = *(const l_uint32 *)p2;
+    if (val1 < val2) return -1;
+    return (val1 > val2);
+}
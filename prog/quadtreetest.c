@@ -62,11 +62,11 @@ static char  mainName[] = "quadtreetest";
     pixs = pixRead("test24.jpg");
     pixg = pixConvertTo8(pixs, 0);
 #endif
-    pixQuadtreeMean(pixg, 8, NULL, &fpixam);
+    pixQuadtreeMeanIntegral(pixg, 8, NULL, &fpixam);
     pixt1 = fpixaDisplayQuadtree(fpixam, 4);
     pixDisplay(pixt1, 100, 0);
     pixWrite("/tmp/quadtree1.png", pixt1, IFF_PNG);
-    pixQuadtreeVariance(pixg, 8, NULL, NULL, &fpixav, &fpixarv);
+    pixQuadtreeVarianceIntegral(pixg, 8, NULL, &fpixav, &fpixarv);
     pixt2 = fpixaDisplayQuadtree(fpixav, 4);
     pixDisplay(pixt2, 100, 200);
     pixWrite("/tmp/quadtree2.png", pixt2, IFF_PNG);
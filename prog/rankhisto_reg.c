@@ -30,6 +30,7 @@
  *   Tests grayscale rank functions:
  *      (1) pixGetRankColorArray()
  *      (2) numaDiscretizeRankAndIntensity()
+ *      (3) accumulation of histograms over bands and under a mask
  */
 
 #include <math.h>
@@ -47,11 +48,13 @@ main(int    argc,
      char **argv)
 {
 char          fname[256];
-l_int32       i, w, h, nbins, factor;
-l_int32       spike;
+l_int32       i, w, h, y, nbins, factor, bandh;
+l_int32       spike, val1, val2, diff1, diff2;
+l_int32      *histo;
 l_uint32     *array, *marray;
-NUMA         *na, *nan, *nai, *narbin;
-PIX          *pixs, *pixt, *pixd;
+BOX          *box;
+NUMA         *na, *nan, *nai, *narbin, *na1, *na2;
+PIX          *pixs, *pixt, *pixd, *pixg, *pixm;
 PIXA         *pixa;
 L_REGPARAMS  *rp;
 
@@ -148,6 +151,39 @@ L_REGPARAMS  *rp;
     pixaDestroy(&pixa);
     pixDestroy(&pixd);
 
+        /* The histogram of the full image is the sum of histograms of
+         * horizontal bands; a mask covering the image gives the same
+         * result as no mask.  This holds with subsampling, as long
+         * as each band starts on a sampled line. */
+    pixg = pixConvertRGBToLuminance(pixs);
+    pixGetDimensions(pixg, &w, &h, NULL);
+    for (factor = 1; factor <= 3; factor++) {
+        na1 = pixGetGrayHistogram(pixg, factor);
+        histo = (l_int32 *)lept_calloc(256, sizeof(l_int32));
+        bandh = 17 * factor;
+        for (y = 0; y < h; y += bandh) {
+            box = boxCreate(0, y, w, bandh);
+            pixGrayHistoAccumulate(pixg, NULL, 0, 0, box, factor, histo);
+            boxDestroy(&box);
+        }
+        pixm = pixCreate(w + 10, h + 10, 1);
+        pixSetAll(pixm);
+        na2 = pixGetGrayHistogramMasked(pixg, pixm, 0, 0, factor);
+        for (i = 0, diff1 = diff2 = 0; i < 256; i++) {
+            numaGetIValue(na1, i, &val1);
+            numaGetIValue(na2, i, &val2);
+            diff1 += L_ABS(val1 - histo[i]);
+            diff2 += L_ABS(val1 - val2);
+        }
+        regTestCompareValues(rp, 0, diff1, 0);  /* 5, 7, 9 */
+        regTestCompareValues(rp, 0, diff2, 0);  /* 6, 8, 10 */
+        numaDestroy(&na1);
+        numaDestroy(&na2);
+        pixDestroy(&pixm);
+        lept_free(histo);
+    }
+    pixDestroy(&pixg);
+
     pixDestroy(&pixs);
     lept_free(array);
     return regTestCleanup(rp);
@@ -0,0 +1,173 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  tophattest.c
+ *
+ *    Timing of the composite grayscale operations in morphapp.c,
+ *    which fuse the morphology with the subtraction, against the
+ *    same operations built from the basic functions.  Each result
+ *    is checked against the composition.
+ *
+ *    Syntax:  tophattest filein [factor]
+ *    The input image is converted to 8 bpp and expanded by factor
+ *    (default 2).
+ */
+
+#include "allheaders.h"
+
+static const l_int32  Sizes[] = {3, 15, 51};
+
+static PIX *composeOp(PIX *pixs, l_int32 op, l_int32 size);
+static PIX *fusedOp(PIX *pixs, l_int32 op, l_int32 size);
+static void Report(const char *name, l_int32 size, l_float32 tcomp,
+                   l_float32 tfused, l_int32 same);
+
+static const char  *OpNames[] = {"white tophat", "black tophat", "gradient",
+                                 "hdome", "fast tophat"};
+
+
+main(int    argc,
+     char **argv)
+{
+l_int32      i, k, w, h, factor, same;
+l_float32    tcomp, tfused;
+PIX         *pixt, *pixs, *pix1, *pix2;
+static char  mainName[] = "tophattest";
+
+    if (argc != 2 && argc != 3)
+        exit(ERROR_INT(" Syntax:  tophattest filein [factor]",
+                       mainName, 1));
+
+    if ((pixt = pixRead(argv[1])) == NULL)
+        exit(ERROR_INT("pixt not made", mainName, 1));
+    factor = (argc == 3) ? atoi(argv[2]) : 2;
+    pixs = pixConvertTo8(pixt, FALSE);
+    pixDestroy(&pixt);
+    if (factor > 1) {
+        pixt = pixExpandReplicate(pixs, factor);
+        pixDestroy(&pixs);
+        pixs = pixt;
+    }
+    pixGetDimensions(pixs, &w, &h, NULL);
+    fprintf(stderr, "Image size: %d x %d\n", w, h);
+
+    for (i = 0; i < 5; i++) {
+        for (k = 0; k < sizeof(Sizes) / sizeof(l_int32); k++) {
+            startTimer();
+            pix1 = composeOp(pixs, i, Sizes[k]);
+            tcomp = stopTimer();
+            startTimer();
+            pix2 = fusedOp(pixs, i, Sizes[k]);
+            tfused = stopTimer();
+            pixEqual(pix1, pix2, &same);
+            Report(OpNames[i], Sizes[k], tcomp, tfused, same);
+            pixDestroy(&pix1);
+            pixDestroy(&pix2);
+        }
+    }
+
+    pixDestroy(&pixs);
+    return 0;
+}
+
+
+    /* The operations as they were composed from the basic functions;
+     * for hdome, @size is the height */
+static PIX *
+composeOp(PIX     *pixs,
+          l_int32  op,
+          l_int32  size)
+{
+PIX  *pixt1, *pixt2, *pixt3, *pixd;
+
+    pixd = NULL;
+    if (op == 0) {
+        pixt1 = pixOpenGray(pixs, size, size);
+        pixd = pixSubtractGray(NULL, pixs, pixt1);
+        pixDestroy(&pixt1);
+    }
+    else if (op == 1) {
+        pixd = pixCloseGray(pixs, size, size);
+        pixSubtractGray(pixd, pixd, pixs);
+    }
+    else if (op == 2) {
+        pixt1 = pixBlockconvGray(pixs, NULL, 0, 0);
+        pixd = pixDilateGray(pixt1, size, size);
+        pixSubtractGray(pixd, pixd, pixt1);
+        pixDestroy(&pixt1);
+    }
+    else if (op == 3) {
+        pixt1 = pixCopy(NULL, pixs);
+        pixAddConstantGray(pixt1, -size);
+        pixSeedfillGray(pixt1, pixs, 4);
+        pixd = pixSubtractGray(NULL, pixs, pixt1);
+        pixDestroy(&pixt1);
+    }
+    else {
+        pixt1 = pixScaleGrayMinMax(pixs, size, size, L_CHOOSE_MIN);
+        pixt2 = pixBlockconv(pixt1, 1, 1);
+        pixt3 = pixScaleBySampling(pixt2, size, size);
+        pixd = pixSubtractGray(NULL, pixs, pixt3);
+        pixDestroy(&pixt1);
+        pixDestroy(&pixt2);
+        pixDestroy(&pixt3);
+    }
+    return pixd;
+}
+
+
+static PIX *
+fusedOp(PIX     *pixs,
+        l_int32  op,
+        l_int32  size)
+{
+    if (op == 0)
+        return pixTophat(pixs, size, size, L_TOPHAT_WHITE);
+    else if (op == 1)
+        return pixTophat(pixs, size, size, L_TOPHAT_BLACK);
+    else if (op == 2)
+        return pixMorphGradient(pixs, size, size, 0);
+    else if (op == 3)
+        return pixHDome(pixs, size, 4);
+    else
+        return pixFastTophat(pixs, size, size, L_TOPHAT_WHITE);
+}
+
+
+static void
+Report(const char  *name,
+       l_int32      size,
+       l_float32    tcomp,
+       l_float32    tfused,
+       l_int32      same)
+{
+    fprintf(stderr, "  %-12s %2d: composed = %6.3f sec, fused = %6.3f sec, "
+            "speedup = %5.2f  %s\n", name, size, tcomp, tfused,
+            tcomp / L_MAX(tfused, 0.001),
+            (same) ? "" : "*** DIFFERENT ***");
+    return;
+}
@@ -58,6 +58,8 @@ LEPT_DLL extern l_int32 pixSmoothConnectedRegions ( PIX *pixs, PIX *pixm, l_int3
 LEPT_DLL extern PIX * pixGetInvBackgroundMap ( PIX *pixs, l_int32 bgval, l_int32 smoothx, l_int32 smoothy );
 LEPT_DLL extern PIX * pixApplyInvBackgroundGrayMap ( PIX *pixs, PIX *pixm, l_int32 sx, l_int32 sy );
 LEPT_DLL extern PIX * pixApplyInvBackgroundRGBMap ( PIX *pixs, PIX *pixmr, PIX *pixmg, PIX *pixmb, l_int32 sx, l_int32 sy );
+LEPT_DLL extern PIX * pixApplyInvBackgroundGrayMapInterp ( PIX *pixs, PIX *pixm, l_int32 sx, l_int32 sy );
+LEPT_DLL extern PIX * pixApplyInvBackgroundRGBMapInterp ( PIX *pixs, PIX *pixmr, PIX *pixmg, PIX *pixmb, l_int32 sx, l_int32 sy );
 LEPT_DLL extern PIX * pixApplyVariableGrayMap ( PIX *pixs, PIX *pixg, l_int32 target );
 LEPT_DLL extern PIX * pixGlobalNormRGB ( PIX *pixd, PIX *pixs, l_int32 rval, l_int32 gval, l_int32 bval, l_int32 mapval );
 LEPT_DLL extern PIX * pixGlobalNormNoSatRGB ( PIX *pixd, PIX *pixs, l_int32 rval, l_int32 gval, l_int32 bval, l_int32 factor, l_float32 rank );
@@ -141,6 +143,9 @@ LEPT_DLL extern l_int32 bbufferExtendArray ( BBUFFER *bb, l_int32 nbytes );
 LEPT_DLL extern l_int32 bbufferWrite ( BBUFFER *bb, l_uint8 *dest, size_t nbytes, size_t *pnout );
 LEPT_DLL extern l_int32 bbufferWriteStream ( BBUFFER *bb, FILE *fp, size_t nbytes, size_t *pnout );
 LEPT_DLL extern l_int32 bbufferBytesToWrite ( BBUFFER *bb, size_t *pnbytes );
+LEPT_DLL extern PIX * pixBilateral ( PIX *pixs, l_float32 spatial_stdev, l_float32 range_stdev, l_int32 ncomps );
+LEPT_DLL extern PIX * pixBilateralGray ( PIX *pixs, l_float32 spatial_stdev, l_float32 range_stdev, l_int32 ncomps );
+LEPT_DLL extern PIX * pixBilateralGrayExact ( PIX *pixs, l_float32 spatial_stdev, l_float32 range_stdev );
 LEPT_DLL extern PIX * pixBilinearSampledPta ( PIX *pixs, PTA *ptad, PTA *ptas, l_int32 incolor );
 LEPT_DLL extern PIX * pixBilinearSampled ( PIX *pixs, l_float32 *vc, l_int32 incolor );
 LEPT_DLL extern PIX * pixBilinearPta ( PIX *pixs, PTA *ptad, PTA *ptas, l_int32 incolor );
@@ -161,6 +166,10 @@ LEPT_DLL extern l_int32 pixSauvolaBinarizeTiled ( PIX *pixs, l_int32 whsize, l_f
 LEPT_DLL extern l_int32 pixSauvolaBinarize ( PIX *pixs, l_int32 whsize, l_float32 factor, l_int32 addborder, PIX **ppixm, PIX **ppixsd, PIX **ppixth, PIX **ppixd );
 LEPT_DLL extern PIX * pixSauvolaGetThreshold ( PIX *pixm, PIX *pixms, l_float32 factor, PIX **ppixsd );
 LEPT_DLL extern PIX * pixApplyLocalThreshold ( PIX *pixs, PIX *pixth, l_int32 redfactor );
+LEPT_DLL extern L_SAUVOLA_STREAM * sauvolaStreamCreate ( l_int32 w, l_int32 whsize, l_float32 factor );
+LEPT_DLL extern void sauvolaStreamDestroy ( L_SAUVOLA_STREAM **pss );
+LEPT_DLL extern l_int32 sauvolaStreamAddLines ( L_SAUVOLA_STREAM *ss, PIX *pixs, PIX **ppixd );
+LEPT_DLL extern l_int32 sauvolaStreamFinish ( L_SAUVOLA_STREAM *ss, PIX **ppixd );
 LEPT_DLL extern PIX * pixExpandBinaryReplicate ( PIX *pixs, l_int32 factor );
 LEPT_DLL extern PIX * pixExpandBinaryPower2 ( PIX *pixs, l_int32 factor );
 LEPT_DLL extern l_int32 expandBinaryPower2Low ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls, l_int32 factor );
@@ -370,6 +379,7 @@ LEPT_DLL extern l_int32 ccbaWriteSVG ( const char *filename, CCBORDA *ccba );
 LEPT_DLL extern char * ccbaWriteSVGString ( const char *filename, CCBORDA *ccba );
 LEPT_DLL extern PIX * pixThin ( PIX *pixs, l_int32 type, l_int32 connectivity, l_int32 maxiters );
 LEPT_DLL extern PIX * pixThinGeneral ( PIX *pixs, l_int32 type, SELA *sela, l_int32 maxiters );
+LEPT_DLL extern PIX * pixThinLUT ( PIX *pixs, l_int32 type, SELA *sela, l_int32 maxiters );
 LEPT_DLL extern PIX * pixThinExamples ( PIX *pixs, l_int32 type, l_int32 index, l_int32 maxiters, const char *selfile );
 LEPT_DLL extern l_int32 jbCorrelation ( const char *dirin, l_float32 thresh, l_float32 weight, l_int32 components, const char *rootname, l_int32 firstpage, l_int32 npages, l_int32 renderflag );
 LEPT_DLL extern l_int32 jbRankHaus ( const char *dirin, l_int32 size, l_float32 rank, l_int32 components, const char *rootname, l_int32 firstpage, l_int32 npages, l_int32 renderflag );
@@ -385,6 +395,7 @@ LEPT_DLL extern l_int32 pixColorFraction ( PIX *pixs, l_int32 darkthresh, l_int3
 LEPT_DLL extern l_int32 pixNumSignificantGrayColors ( PIX *pixs, l_int32 darkthresh, l_int32 lightthresh, l_float32 minfract, l_int32 factor, l_int32 *pncolors );
 LEPT_DLL extern l_int32 pixColorsForQuantization ( PIX *pixs, l_int32 thresh, l_int32 *pncolors, l_int32 *piscolor, l_int32 debug );
 LEPT_DLL extern l_int32 pixNumColors ( PIX *pixs, l_int32 factor, l_int32 *pncolors );
+LEPT_DLL extern l_int32 pixCountRGBColors ( PIX *pixs, l_int32 factor, l_int32 maxcolors, l_int32 *pncolors );
 LEPT_DLL extern l_int32 pixColorGray ( PIX *pixs, BOX *box, l_int32 type, l_int32 thresh, l_int32 rval, l_int32 gval, l_int32 bval );
 LEPT_DLL extern PIX * pixSnapColor ( PIX *pixd, PIX *pixs, l_uint32 srcval, l_uint32 dstval, l_int32 diff );
 LEPT_DLL extern PIX * pixSnapColorCmap ( PIX *pixd, PIX *pixs, l_uint32 srcval, l_uint32 dstval, l_int32 diff );
@@ -434,6 +445,7 @@ LEPT_DLL extern l_int32 pixcmapContrastTRC ( PIXCMAP *cmap, l_float32 factor );
 LEPT_DLL extern l_int32 pixcmapShiftIntensity ( PIXCMAP *cmap, l_float32 fraction );
 LEPT_DLL extern l_int32 pixcmapShiftByComponent ( PIXCMAP *cmap, l_uint32 srcval, l_uint32 dstval );
 LEPT_DLL extern PIX * pixColorMorph ( PIX *pixs, l_int32 type, l_int32 hsize, l_int32 vsize );
+LEPT_DLL extern PIX * pixColorMorphSel ( PIX *pixs, l_int32 type, SEL *sel );
 LEPT_DLL extern PIX * pixOctreeColorQuant ( PIX *pixs, l_int32 colors, l_int32 ditherflag );
 LEPT_DLL extern PIX * pixOctreeColorQuantGeneral ( PIX *pixs, l_int32 colors, l_int32 ditherflag, l_float32 validthresh, l_float32 colorthresh );
 LEPT_DLL extern l_int32 makeRGBToIndexTables ( l_uint32 **prtab, l_uint32 **pgtab, l_uint32 **pbtab, l_int32 cqlevels );
@@ -486,6 +498,18 @@ LEPT_DLL extern l_int32 convertRGBToYUV ( l_int32 rval, l_int32 gval, l_int32 bv
 LEPT_DLL extern l_int32 convertYUVToRGB ( l_int32 yval, l_int32 uval, l_int32 vval, l_int32 *prval, l_int32 *pgval, l_int32 *pbval );
 LEPT_DLL extern l_int32 pixcmapConvertRGBToYUV ( PIXCMAP *cmap );
 LEPT_DLL extern l_int32 pixcmapConvertYUVToRGB ( PIXCMAP *cmap );
+LEPT_DLL extern PIX * pixConvertRGBToYCbCr ( PIX *pixd, PIX *pixs );
+LEPT_DLL extern PIX * pixConvertYCbCrToRGB ( PIX *pixd, PIX *pixs );
+LEPT_DLL extern l_int32 convertRGBToYCbCr ( l_int32 rval, l_int32 gval, l_int32 bval, l_int32 *pyval, l_int32 *pcbval, l_int32 *pcrval );
+LEPT_DLL extern l_int32 convertYCbCrToRGB ( l_int32 yval, l_int32 cbval, l_int32 crval, l_int32 *prval, l_int32 *pgval, l_int32 *pbval );
+LEPT_DLL extern l_int32 pixcmapConvertRGBToYCbCr ( PIXCMAP *cmap );
+LEPT_DLL extern l_int32 pixcmapConvertYCbCrToRGB ( PIXCMAP *cmap );
+LEPT_DLL extern PIX * pixConvertRGBToLAB ( PIX *pixd, PIX *pixs );
+LEPT_DLL extern PIX * pixConvertLABToRGB ( PIX *pixd, PIX *pixs );
+LEPT_DLL extern l_int32 convertRGBToLAB ( l_int32 rval, l_int32 gval, l_int32 bval, l_int32 *plval, l_int32 *paval, l_int32 *pbval );
+LEPT_DLL extern l_int32 convertLABToRGB ( l_int32 lval, l_int32 aval, l_int32 bval, l_int32 *prval, l_int32 *pgval, l_int32 *pbval );
+LEPT_DLL extern l_int32 pixcmapConvertRGBToLAB ( PIXCMAP *cmap );
+LEPT_DLL extern l_int32 pixcmapConvertLABToRGB ( PIXCMAP *cmap );
 LEPT_DLL extern l_int32 pixEqual ( PIX *pix1, PIX *pix2, l_int32 *psame );
 LEPT_DLL extern l_int32 pixEqualWithCmap ( PIX *pix1, PIX *pix2, l_int32 *psame );
 LEPT_DLL extern l_int32 pixUsesCmapColor ( PIX *pixs, l_int32 *pcolor );
@@ -528,6 +552,8 @@ LEPT_DLL extern l_int32 pixWindowedVariance ( PIX *pixm, PIX *pixms, FPIX **pfpi
 LEPT_DLL extern DPIX * pixMeanSquareAccum ( PIX *pixs );
 LEPT_DLL extern PIX * pixBlockrank ( PIX *pixs, PIX *pixacc, l_int32 wc, l_int32 hc, l_float32 rank );
 LEPT_DLL extern PIX * pixBlocksum ( PIX *pixs, PIX *pixacc, l_int32 wc, l_int32 hc );
+LEPT_DLL extern PIX * pixBlockrankIntegral ( PIX *pixs, L_INTEGRAL *intg, l_int32 wc, l_int32 hc, l_float32 rank );
+LEPT_DLL extern PIX * pixBlocksumIntegral ( PIX *pixs, L_INTEGRAL *intg, l_int32 wc, l_int32 hc );
 LEPT_DLL extern PIX * pixCensusTransform ( PIX *pixs, l_int32 halfsize, PIX *pixacc );
 LEPT_DLL extern PIX * pixConvolve ( PIX *pixs, L_KERNEL *kel, l_int32 outdepth, l_int32 normflag );
 LEPT_DLL extern PIX * pixConvolveSep ( PIX *pixs, L_KERNEL *kelx, L_KERNEL *kely, l_int32 outdepth, l_int32 normflag );
@@ -535,10 +561,15 @@ LEPT_DLL extern PIX * pixConvolveRGB ( PIX *pixs, L_KERNEL *kel );
 LEPT_DLL extern PIX * pixConvolveRGBSep ( PIX *pixs, L_KERNEL *kelx, L_KERNEL *kely );
 LEPT_DLL extern FPIX * fpixConvolve ( FPIX *fpixs, L_KERNEL *kel, l_int32 normflag );
 LEPT_DLL extern FPIX * fpixConvolveSep ( FPIX *fpixs, L_KERNEL *kelx, L_KERNEL *kely, l_int32 normflag );
+LEPT_DLL extern PIX * pixRecursiveGaussian ( PIX *pixs, l_float32 sigmax, l_float32 sigmay );
+LEPT_DLL extern FPIX * fpixRecursiveGaussian ( FPIX *fpixs, l_float32 sigmax, l_float32 sigmay );
 LEPT_DLL extern void l_setConvolveSampling ( l_int32 xfact, l_int32 yfact );
+LEPT_DLL extern void l_setConvolveFFT ( l_int32 useflag );
 LEPT_DLL extern void blockconvLow ( l_uint32 *data, l_int32 w, l_int32 h, l_int32 wpl, l_uint32 *dataa, l_int32 wpla, l_int32 wc, l_int32 hc );
 LEPT_DLL extern void blockconvAccumLow ( l_uint32 *datad, l_int32 w, l_int32 h, l_int32 wpld, l_uint32 *datas, l_int32 d, l_int32 wpls );
 LEPT_DLL extern void blocksumLow ( l_uint32 *datad, l_int32 w, l_int32 h, l_int32 wpl, l_uint32 *dataa, l_int32 wpla, l_int32 wc, l_int32 hc );
+LEPT_DLL extern void blocksumIntegralLow ( l_uint32 *datad, l_int32 w, l_int32 h, l_int32 wpl, l_uint64 *dataa, l_int32 wpla, l_int32 wc, l_int32 hc );
+LEPT_DLL extern l_int32 recursiveGaussianLow ( l_float32 *data, l_int32 w, l_int32 h, l_int32 wpl, l_float32 sigmax, l_float32 sigmay );
 LEPT_DLL extern l_float32 pixCorrelationScore ( PIX *pix1, PIX *pix2, l_int32 area1, l_int32 area2, l_float32 delx, l_float32 dely, l_int32 maxdiffw, l_int32 maxdiffh, l_int32 *tab );
 LEPT_DLL extern l_int32 pixCorrelationScoreThresholded ( PIX *pix1, PIX *pix2, l_int32 area1, l_int32 area2, l_float32 delx, l_float32 dely, l_int32 maxdiffw, l_int32 maxdiffh, l_int32 *tab, l_int32 *downcount, l_float32 score_threshold );
 LEPT_DLL extern l_float32 pixCorrelationScoreSimple ( PIX *pix1, PIX *pix2, l_int32 area1, l_int32 area2, l_float32 delx, l_float32 dely, l_int32 maxdiffw, l_int32 maxdiffh, l_int32 *tab );
@@ -634,6 +665,7 @@ LEPT_DLL extern NUMA * l_dnaConvertToNuma ( L_DNA *da );
 LEPT_DLL extern L_DNA * numaConvertToDna ( NUMA *na );
 LEPT_DLL extern PIX * pixMorphDwa_2 ( PIX *pixd, PIX *pixs, l_int32 operation, char *selname );
 LEPT_DLL extern PIX * pixFMorphopGen_2 ( PIX *pixd, PIX *pixs, l_int32 operation, char *selname );
+LEPT_DLL extern PIX * pixFMorphopGenInterior_2 ( PIX *pixd, PIX *pixs, l_int32 operation, char *selname );
 LEPT_DLL extern l_int32 fmorphopgen_low_2 ( l_uint32 *datad, l_int32 w, l_int32 h, l_int32 wpld, l_uint32 *datas, l_int32 wpls, l_int32 index );
 LEPT_DLL extern PIX * pixSobelEdgeFilter ( PIX *pixs, l_int32 orientflag );
 LEPT_DLL extern PIX * pixTwoSidedEdgeFilter ( PIX *pixs, l_int32 orientflag );
@@ -651,6 +683,7 @@ LEPT_DLL extern NUMA * numaContrastTRC ( l_float32 factor );
 LEPT_DLL extern PIX * pixEqualizeTRC ( PIX *pixd, PIX *pixs, l_float32 fract, l_int32 factor );
 LEPT_DLL extern NUMA * numaEqualizeTRC ( PIX *pix, l_float32 fract, l_int32 factor );
 LEPT_DLL extern l_int32 pixTRCMap ( PIX *pixs, PIX *pixm, NUMA *na );
+LEPT_DLL extern l_int32 pixTRCMapGeneral ( PIX *pixs, PIX *pixm, NUMA *nar, NUMA *nag, NUMA *nab );
 LEPT_DLL extern PIX * pixUnsharpMasking ( PIX *pixs, l_int32 halfwidth, l_float32 fract );
 LEPT_DLL extern PIX * pixUnsharpMaskingGray ( PIX *pixs, l_int32 halfwidth, l_float32 fract );
 LEPT_DLL extern PIX * pixUnsharpMaskingFast ( PIX *pixs, l_int32 halfwidth, l_float32 fract, l_int32 direction );
@@ -663,6 +696,13 @@ LEPT_DLL extern l_int32 pixMeasureSaturation ( PIX *pixs, l_int32 factor, l_floa
 LEPT_DLL extern PIX * pixMultConstantColor ( PIX *pixs, l_float32 rfact, l_float32 gfact, l_float32 bfact );
 LEPT_DLL extern PIX * pixMultMatrixColor ( PIX *pixs, L_KERNEL *kel );
 LEPT_DLL extern PIX * pixHalfEdgeByBandpass ( PIX *pixs, l_int32 sm1h, l_int32 sm1v, l_int32 sm2h, l_int32 sm2v );
+LEPT_DLL extern void lutApplyLineLow ( l_uint32 *lined, l_uint32 *lines, l_int32 d, l_int32 x, l_int32 n, l_uint8 *rtab, l_uint8 *gtab, l_uint8 *btab, l_uint32 alphamask );
+LEPT_DLL extern void lutApplyLineMaskedLow ( l_uint32 *lined, l_uint32 *lines, l_uint32 *linem, l_int32 d, l_int32 n, l_uint8 *rtab, l_uint8 *gtab, l_uint8 *btab, l_uint32 alphamask );
+LEPT_DLL extern void sumLineBytesLow ( l_int32 *sums, l_uint32 *line, l_int32 w, l_int32 op );
+LEPT_DLL extern void unsharpMaskLineLow ( l_uint32 *lined, l_uint32 *lines, l_int32 *sums, l_int32 w, l_int32 halfwidth, l_int32 size, l_int32 factor, l_int32 shift, l_int32 roundflag );
+LEPT_DLL extern void fftClearPlanCache ( void );
+LEPT_DLL extern FPIX * fpixConvolveFFT ( FPIX *fpixs, L_KERNEL *kel, l_int32 normflag );
+LEPT_DLL extern DPIX * pixCorrelationSurfaceFFT ( PIX *pix1, PIX *pix2 );
 LEPT_DLL extern l_int32 fhmtautogen ( SELA *sela, l_int32 fileindex, const char *filename );
 LEPT_DLL extern l_int32 fhmtautogen1 ( SELA *sela, l_int32 fileindex, const char *filename );
 LEPT_DLL extern l_int32 fhmtautogen2 ( SELA *sela, l_int32 fileindex, const char *filename );
@@ -685,6 +725,7 @@ LEPT_DLL extern l_int32 fmorphautogen1 ( SELA *sela, l_int32 fileindex, const ch
 LEPT_DLL extern l_int32 fmorphautogen2 ( SELA *sela, l_int32 fileindex, const char *filename );
 LEPT_DLL extern PIX * pixMorphDwa_1 ( PIX *pixd, PIX *pixs, l_int32 operation, char *selname );
 LEPT_DLL extern PIX * pixFMorphopGen_1 ( PIX *pixd, PIX *pixs, l_int32 operation, char *selname );
+LEPT_DLL extern PIX * pixFMorphopGenInterior_1 ( PIX *pixd, PIX *pixs, l_int32 operation, char *selname );
 LEPT_DLL extern l_int32 fmorphopgen_low_1 ( l_uint32 *datad, l_int32 w, l_int32 h, l_int32 wpld, l_uint32 *datas, l_int32 wpls, l_int32 index );
 LEPT_DLL extern FPIX * fpixCreate ( l_int32 width, l_int32 height );
 LEPT_DLL extern FPIX * fpixCreateTemplate ( FPIX *fpixs );
@@ -830,6 +871,8 @@ LEPT_DLL extern PIX * pixErodeGray ( PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern PIX * pixDilateGray ( PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern PIX * pixOpenGray ( PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern PIX * pixCloseGray ( PIX *pixs, l_int32 hsize, l_int32 vsize );
+LEPT_DLL extern PIX * pixErodeGraySel ( PIX *pixs, SEL *sel );
+LEPT_DLL extern PIX * pixDilateGraySel ( PIX *pixs, SEL *sel );
 LEPT_DLL extern PIX * pixErodeGray3 ( PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern PIX * pixDilateGray3 ( PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern PIX * pixOpenGray3 ( PIX *pixs, l_int32 hsize, l_int32 vsize );
@@ -869,6 +912,8 @@ LEPT_DLL extern void ditherTo2bppLineLow ( l_uint32 *lined, l_int32 w, l_uint32
 LEPT_DLL extern l_int32 make8To2DitherTables ( l_int32 **ptabval, l_int32 **ptab38, l_int32 **ptab14, l_int32 cliptoblack, l_int32 cliptowhite );
 LEPT_DLL extern void thresholdTo2bppLow ( l_uint32 *datad, l_int32 h, l_int32 wpld, l_uint32 *datas, l_int32 wpls, l_int32 *tab );
 LEPT_DLL extern void thresholdTo4bppLow ( l_uint32 *datad, l_int32 h, l_int32 wpld, l_uint32 *datas, l_int32 wpls, l_int32 *tab );
+LEPT_DLL extern void ditherToCmapLow ( l_uint32 *datad, l_int32 w, l_int32 h, l_int32 wpld, l_uint32 *datas, l_int32 wpls, l_int32 *bufs1, l_int32 *bufs2, l_uint32 *rtab, l_uint32 *gtab, l_uint32 *btab, l_uint32 *celltab, l_int32 difcap );
+LEPT_DLL extern void ditherToCmapLineLow ( l_uint32 *lined, l_int32 w, l_int32 *bufs1, l_int32 *bufs2, l_uint32 *rtab, l_uint32 *gtab, l_uint32 *btab, l_uint32 *celltab, l_int32 difcap, l_int32 lastlineflag );
 LEPT_DLL extern L_HEAP * lheapCreate ( l_int32 nalloc, l_int32 direction );
 LEPT_DLL extern void lheapDestroy ( L_HEAP **plh, l_int32 freeflag );
 LEPT_DLL extern l_int32 lheapAdd ( L_HEAP *lh, void *item );
@@ -880,6 +925,14 @@ LEPT_DLL extern l_int32 lheapSwapDown ( L_HEAP *lh );
 LEPT_DLL extern l_int32 lheapSort ( L_HEAP *lh );
 LEPT_DLL extern l_int32 lheapSortStrictOrder ( L_HEAP *lh );
 LEPT_DLL extern l_int32 lheapPrint ( FILE *fp, L_HEAP *lh );
+LEPT_DLL extern L_INTEGRAL * integralCreate ( PIX *pixs, l_int32 sqflag );
+LEPT_DLL extern L_INTEGRAL * integralClone ( L_INTEGRAL *intg );
+LEPT_DLL extern void integralDestroy ( L_INTEGRAL **pintg );
+LEPT_DLL extern l_int32 integralGetDimensions ( L_INTEGRAL *intg, l_int32 *pw, l_int32 *ph, l_int32 *pd );
+LEPT_DLL extern l_int32 integralGetWpl ( L_INTEGRAL *intg );
+LEPT_DLL extern l_uint64 * integralGetSumData ( L_INTEGRAL *intg );
+LEPT_DLL extern l_uint64 * integralGetSumSqData ( L_INTEGRAL *intg );
+LEPT_DLL extern l_int32 integralGetRectSum ( L_INTEGRAL *intg, l_int32 x, l_int32 y, l_int32 w, l_int32 h, l_float64 *psum, l_float64 *psumsq );
 LEPT_DLL extern JBCLASSER * jbRankHausInit ( l_int32 components, l_int32 maxwidth, l_int32 maxheight, l_int32 size, l_float32 rank );
 LEPT_DLL extern JBCLASSER * jbCorrelationInit ( l_int32 components, l_int32 maxwidth, l_int32 maxheight, l_float32 thresh, l_float32 weightfactor );
 LEPT_DLL extern JBCLASSER * jbCorrelationInitWithoutComponents ( l_int32 components, l_int32 maxwidth, l_int32 maxheight, l_float32 thresh, l_float32 weightfactor );
@@ -927,6 +980,7 @@ LEPT_DLL extern l_int32 kernelGetSum ( L_KERNEL *kel, l_float32 *psum );
 LEPT_DLL extern l_int32 kernelGetMinMax ( L_KERNEL *kel, l_float32 *pmin, l_float32 *pmax );
 LEPT_DLL extern L_KERNEL * kernelNormalize ( L_KERNEL *kels, l_float32 normsum );
 LEPT_DLL extern L_KERNEL * kernelInvert ( L_KERNEL *kels );
+LEPT_DLL extern l_int32 kernelGetConvolveType ( L_KERNEL *kel, l_int32 *ptype );
 LEPT_DLL extern l_float32 ** create2dFloatArray ( l_int32 sy, l_int32 sx );
 LEPT_DLL extern L_KERNEL * kernelRead ( const char *fname );
 LEPT_DLL extern L_KERNEL * kernelReadStream ( FILE *fp );
@@ -967,6 +1021,12 @@ LEPT_DLL extern PIX * pixClose ( PIX *pixd, PIX *pixs, SEL *sel );
 LEPT_DLL extern PIX * pixCloseSafe ( PIX *pixd, PIX *pixs, SEL *sel );
 LEPT_DLL extern PIX * pixOpenGeneralized ( PIX *pixd, PIX *pixs, SEL *sel );
 LEPT_DLL extern PIX * pixCloseGeneralized ( PIX *pixd, PIX *pixs, SEL *sel );
+LEPT_DLL extern PIX * pixMorphAddBorder ( PIX *pixs, SEL *sel, l_int32 type, l_int32 left, l_int32 right, l_int32 top, l_int32 bot );
+LEPT_DLL extern PIX * pixMorphRemoveBorder ( PIX *pixd, PIX *pixs, SEL *sel, l_int32 type, l_int32 left, l_int32 right, l_int32 top, l_int32 bot );
+LEPT_DLL extern l_int32 pixMorphBand ( PIX *pixd, PIX *pixs, SEL *sel, SELA *plan, l_int32 type, l_int32 y, l_int32 h );
+LEPT_DLL extern PIX * pixMorphByBand ( PIX *pixs, SEL *sel, l_int32 type, l_int32 nbands );
+LEPT_DLL extern PIXA * pixHMTMultiple ( PIX *pixs, SELA *sela );
+LEPT_DLL extern l_int32 pixMorphSelaBand ( PIX *pixd, PIX *pixs, SELA *sela, l_int32 type, l_int32 op, l_int32 y, l_int32 h );
 LEPT_DLL extern PIX * pixDilateBrick ( PIX *pixd, PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern PIX * pixErodeBrick ( PIX *pixd, PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern PIX * pixOpenBrick ( PIX *pixd, PIX *pixs, l_int32 hsize, l_int32 vsize );
@@ -981,6 +1041,7 @@ LEPT_DLL extern PIX * pixCloseCompBrick ( PIX *pixd, PIX *pixs, l_int32 hsize, l
 LEPT_DLL extern PIX * pixCloseSafeCompBrick ( PIX *pixd, PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern void resetMorphBoundaryCondition ( l_int32 bc );
 LEPT_DLL extern l_uint32 getMorphBorderPixelColor ( l_int32 type, l_int32 depth );
+LEPT_DLL extern SELA * selMakeMorphPlan ( SEL *sel );
 LEPT_DLL extern PIX * pixExtractBoundary ( PIX *pixs, l_int32 type );
 LEPT_DLL extern PIX * pixMorphSequenceMasked ( PIX *pixs, PIX *pixm, const char *sequence, l_int32 dispsep );
 LEPT_DLL extern PIX * pixMorphSequenceByComponent ( PIX *pixs, const char *sequence, l_int32 connectivity, l_int32 minw, l_int32 minh, BOXA **pboxa );
@@ -1020,6 +1081,12 @@ LEPT_DLL extern PIX * pixMorphCompSequenceDwa ( PIX *pixs, const char *sequence,
 LEPT_DLL extern l_int32 morphSequenceVerify ( SARRAY *sa );
 LEPT_DLL extern PIX * pixGrayMorphSequence ( PIX *pixs, const char *sequence, l_int32 dispsep, l_int32 dispy );
 LEPT_DLL extern PIX * pixColorMorphSequence ( PIX *pixs, const char *sequence, l_int32 dispsep, l_int32 dispy );
+LEPT_DLL extern L_MORPHSEQ * morphSeqCreate ( const char *sequence, l_int32 depth );
+LEPT_DLL extern void morphSeqDestroy ( L_MORPHSEQ **pmseq );
+LEPT_DLL extern PIX * pixMorphSeqApply ( PIX *pixs, L_MORPHSEQ *mseq );
+LEPT_DLL extern l_int32 morphSeqGetHalo ( L_MORPHSEQ *mseq, l_int32 *phalo );
+LEPT_DLL extern l_int32 pixMorphSeqApplyBand ( PIX *pixd, PIX *pixs, L_MORPHSEQ *mseq, l_int32 y, l_int32 h );
+LEPT_DLL extern PIX * pixMorphSeqApplyByBand ( PIX *pixs, L_MORPHSEQ *mseq, l_int32 nbands );
 LEPT_DLL extern NUMA * numaCreate ( l_int32 n );
 LEPT_DLL extern NUMA * numaCreateFromIArray ( l_int32 *iarray, l_int32 size );
 LEPT_DLL extern NUMA * numaCreateFromFArray ( l_float32 *farray, l_int32 size, l_int32 copyflag );
@@ -1355,6 +1422,9 @@ LEPT_DLL extern l_int32 pixGetColumnStats ( PIX *pixs, l_int32 type, l_int32 nbi
 LEPT_DLL extern l_int32 pixSetPixelColumn ( PIX *pix, l_int32 col, l_float32 *colvect );
 LEPT_DLL extern l_int32 pixThresholdForFgBg ( PIX *pixs, l_int32 factor, l_int32 thresh, l_int32 *pfgval, l_int32 *pbgval );
 LEPT_DLL extern l_int32 pixSplitDistributionFgBg ( PIX *pixs, l_float32 scorefract, l_int32 factor, l_int32 *pthresh, l_int32 *pfgval, l_int32 *pbgval, l_int32 debugflag );
+LEPT_DLL extern l_int32 pixGrayHistoAccumulate ( PIX *pixs, PIX *pixm, l_int32 x, l_int32 y, BOX *box, l_int32 factor, l_int32 *histo );
+LEPT_DLL extern l_int32 pixColorHistoAccumulate ( PIX *pixs, PIX *pixm, l_int32 x, l_int32 y, l_int32 factor, l_int32 *rhisto, l_int32 *ghisto, l_int32 *bhisto );
+LEPT_DLL extern l_int32 pixRGBIndexHistoAccumulate ( PIX *pixs, l_int32 factor, l_uint32 *rtab, l_uint32 *gtab, l_uint32 *btab, l_int32 size, l_int32 *histo );
 LEPT_DLL extern l_int32 pixaFindDimensions ( PIXA *pixa, NUMA **pnaw, NUMA **pnah );
 LEPT_DLL extern NUMA * pixaFindAreaPerimRatio ( PIXA *pixa );
 LEPT_DLL extern l_int32 pixFindAreaPerimRatio ( PIX *pixs, l_int32 *tab, l_float32 *pfract );
@@ -1749,8 +1819,12 @@ LEPT_DLL extern L_PTRA * ptraaGetPtra ( L_PTRAA *paa, l_int32 index, l_int32 acc
 LEPT_DLL extern L_PTRA * ptraaFlattenToPtra ( L_PTRAA *paa );
 LEPT_DLL extern l_int32 pixQuadtreeMean ( PIX *pixs, l_int32 nlevels, PIX *pix_ma, FPIXA **pfpixa );
 LEPT_DLL extern l_int32 pixQuadtreeVariance ( PIX *pixs, l_int32 nlevels, PIX *pix_ma, DPIX *dpix_msa, FPIXA **pfpixa_v, FPIXA **pfpixa_rv );
+LEPT_DLL extern l_int32 pixQuadtreeMeanIntegral ( PIX *pixs, l_int32 nlevels, L_INTEGRAL *intg, FPIXA **pfpixa );
+LEPT_DLL extern l_int32 pixQuadtreeVarianceIntegral ( PIX *pixs, l_int32 nlevels, L_INTEGRAL *intg, FPIXA **pfpixa_v, FPIXA **pfpixa_rv );
 LEPT_DLL extern l_int32 pixMeanInRectangle ( PIX *pixs, BOX *box, PIX *pixma, l_float32 *pval );
 LEPT_DLL extern l_int32 pixVarianceInRectangle ( PIX *pixs, BOX *box, PIX *pix_ma, DPIX *dpix_msa, l_float32 *pvar, l_float32 *prvar );
+LEPT_DLL extern l_int32 pixMeanInRectangleIntegral ( PIX *pixs, BOX *box, L_INTEGRAL *intg, l_float32 *pval );
+LEPT_DLL extern l_int32 pixVarianceInRectangleIntegral ( PIX *pixs, BOX *box, L_INTEGRAL *intg, l_float32 *pvar, l_float32 *prvar );
 LEPT_DLL extern BOXAA * boxaaQuadtreeRegions ( l_int32 w, l_int32 h, l_int32 nlevels );
 LEPT_DLL extern l_int32 quadtreeGetParent ( FPIXA *fpixa, l_int32 level, l_int32 x, l_int32 y, l_float32 *pval );
 LEPT_DLL extern l_int32 quadtreeGetChildren ( FPIXA *fpixa, l_int32 level, l_int32 x, l_int32 y, l_float32 *pval00, l_float32 *pval10, l_float32 *pval01, l_float32 *pval11 );
@@ -0,0 +1,455 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  bilateral.c
+ *
+ *     Top level approximate bilateral filter
+ *         PIX       *pixBilateral()
+ *         PIX       *pixBilateralGray()
+ *
+ *     Exact bilateral filter (slow; for reference)
+ *         PIX       *pixBilateralGrayExact()
+ *
+ *     Helper
+ *         static l_float32  *makeRangeTable()
+ *
+ *  The bilateral filter is an edge-preserving smoother.  At each
+ *  pixel x with value I(x), it takes a weighted average of the
+ *  pixels y in the neighborhood, where the weight is the product of
+ *  a spatial gaussian in |x - y| and a "range" gaussian in
+ *  |I(x) - I(y)|.  Pixels across an edge have very different values,
+ *  so they get little weight, and the edge is not blurred.
+ *
+ *  Computed directly, the cost is proportional to the area of the
+ *  spatial kernel, which is prohibitive for large spatial sigma.
+ *  pixBilateralGray() uses the piecewise-linear approximation of
+ *  Durand and Dorsey ("Fast bilateral filtering for the display
+ *  of high-dynamic-range images", SIGGRAPH 2002) and Yang et al.
+ *  ("Real-time O(1) bilateral filtering", CVPR 2009): the range of
+ *  pixel values is sampled at @ncomps levels k, and for each level,
+ *  with range weight W_k(y) = g_r(I(y) - k),
+ *        J_k(x) = [G_s * (W_k I)](x) / [G_s * W_k](x)
+ *  is the bilateral filter for a pixel whose value is exactly k.
+ *  The result at x is found by linear interpolation between the
+ *  two levels that bracket I(x).  Each spatial convolution G_s is
+ *  a recursive gaussian (see recursiveGaussianLow()), whose cost
+ *  does not depend on the spatial sigma, so the total cost is
+ *  proportional to @ncomps and independent of the spatial sigma.
+ *
+ *  The levels are processed in order, and only the last two J_k
+ *  are kept, so the memory is three float images, independent
+ *  of @ncomps.  All the per-pixel work, apart from the gaussian
+ *  smoothing, is done line by line, so it can be split into bands.
+ */
+
+#include <math.h>
+#include "allheaders.h"
+
+static l_float32 *makeRangeTable(l_float32 range_stdev, l_float32 level);
+
+
+/*--------------------------------------------------------------------*
+ *                Top level approximate bilateral filter              *
+ *--------------------------------------------------------------------*/
+/*!
+ *  pixBilateral()
+ *
+ *      Input:  pixs (8 bpp gray or 32 bpp rgb; colormap is removed)
+ *              spatial_stdev (of gaussian kernel; in pixels, >= 0.5)
+ *              range_stdev (of gaussian range kernel; >= 5.0; typ. 20 - 50)
+ *              ncomps (number of range levels; in [4 ... 30])
+ *      Return: pixd (bilateral filtered image), or null on error
+ *
+ *  Notes:
+ *      (1) This performs an approximate edge-preserving smoothing.
+ *          See pixBilateralGray() for the method.  For 32 bpp,
+ *          each component is filtered independently.
+ *      (2) The time is independent of @spatial_stdev, and is
+ *          proportional to @ncomps.  The result gets closer to that
+ *          of the exact filter as @ncomps is increased; roughly,
+ *          the level spacing should not be larger than @range_stdev.
+ */
+PIX *
+pixBilateral(PIX       *pixs,
+             l_float32  spatial_stdev,
+             l_float32  range_stdev,
+             l_int32    ncomps)
+{
+l_int32  d;
+PIX     *pixt, *pixr, *pixg, *pixb, *pixrs, *pixgs, *pixbs, *pixd;
+
+    PROCNAME("pixBilateral");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (spatial_stdev < 0.5)
+        return (PIX *)ERROR_PTR("spatial_stdev < 0.5", procName, NULL);
+    if (range_stdev < 5.0)
+        return (PIX *)ERROR_PTR("range_stdev < 5.0", procName, NULL);
+    if (ncomps < 4 || ncomps > 30)
+        return (PIX *)ERROR_PTR("ncomps not in [4 ... 30]", procName, NULL);
+
+    pixt = pixRemoveColormap(pixs, REMOVE_CMAP_BASED_ON_SRC);
+    d = pixGetDepth(pixt);
+    if (d != 8 && d != 32) {
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("pixs not 8 or 32 bpp", procName, NULL);
+    }
+
+    if (d == 8) {
+        pixd = pixBilateralGray(pixt, spatial_stdev, range_stdev, ncomps);
+    }
+    else {  /* d == 32 */
+        pixr = pixGetRGBComponent(pixt, COLOR_RED);
+        pixrs = pixBilateralGray(pixr, spatial_stdev, range_stdev, ncomps);
+        pixDestroy(&pixr);
+        pixg = pixGetRGBComponent(pixt, COLOR_GREEN);
+        pixgs = pixBilateralGray(pixg, spatial_stdev, range_stdev, ncomps);
+        pixDestroy(&pixg);
+        pixb = pixGetRGBComponent(pixt, COLOR_BLUE);
+        pixbs = pixBilateralGray(pixb, spatial_stdev, range_stdev, ncomps);
+        pixDestroy(&pixb);
+        if (pixrs && pixgs && pixbs)
+            pixd = pixCreateRGBImage(pixrs, pixgs, pixbs);
+        else
+            pixd = NULL;
+        pixDestroy(&pixrs);
+        pixDestroy(&pixgs);
+        pixDestroy(&pixbs);
+        if (!pixd) {
+            pixDestroy(&pixt);
+            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+        }
+    }
+
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
+/*!
+ *  pixBilateralGray()
+ *
+ *      Input:  pixs (8 bpp gray)
+ *              spatial_stdev (of gaussian kernel; in pixels, >= 0.5)
+ *              range_stdev (of gaussian range kernel; >= 5.0; typ. 20 - 50)
+ *              ncomps (number of range levels; in [4 ... 30])
+ *      Return: pixd (8 bpp bilateral filtered image), or null on error
+ *
+ *  Notes:
+ *      (1) See the notes at the top of this file for the method.
+ *      (2) The levels are spread uniformly over the range of pixel
+ *          values actually present in pixs, so no effort is wasted
+ *          on levels that no pixel uses.  The level spacing is
+ *          (maxval - minval) / (ncomps - 1).
+ *      (3) The range weights for each level are taken from a table
+ *          indexed by pixel value, and pixel values are mapped to
+ *          their bracketing levels and interpolation fractions with
+ *          two more tables, so no exponentials are evaluated in the
+ *          per-pixel loops.
+ */
+PIX *
+pixBilateralGray(PIX       *pixs,
+                 l_float32  spatial_stdev,
+                 l_float32  range_stdev,
+                 l_int32    ncomps)
+{
+l_int32     i, j, k, w, h, wpls, wpld, wplf, val, minval, maxval;
+l_int32     bracket[256];
+l_uint32   *datas, *datad, *lines, *lined;
+l_float32   sum, fract[256], level[30];
+l_float32  *datawt, *datawi, *datajp, *linewt, *linewi, *linejp;
+l_float32  *range;
+FPIX       *fpixwt, *fpixwi, *fpixjp, *fpixt;
+PIX        *pixd;
+
+    PROCNAME("pixBilateralGray");
+
+    if (!pixs || pixGetDepth(pixs) != 8 || pixGetColormap(pixs))
+        return (PIX *)ERROR_PTR("pixs undefined or not 8 bpp gray",
+                                procName, NULL);
+    if (spatial_stdev < 0.5)
+        return (PIX *)ERROR_PTR("spatial_stdev < 0.5", procName, NULL);
+    if (range_stdev < 5.0)
+        return (PIX *)ERROR_PTR("range_stdev < 5.0", procName, NULL);
+    if (ncomps < 4 || ncomps > 30)
+        return (PIX *)ERROR_PTR("ncomps not in [4 ... 30]", procName, NULL);
+
+        /* Find the range of pixel values, and set up the levels */
+    pixGetDimensions(pixs, &w, &h, NULL);
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
+    minval = 255;
+    maxval = 0;
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        for (j = 0; j < w; j++) {
+            val = GET_DATA_BYTE(lines, j);
+            minval = L_MIN(minval, val);
+            maxval = L_MAX(maxval, val);
+        }
+    }
+    if (minval == maxval)  /* nothing to smooth */
+        return pixCopy(NULL, pixs);
+    for (k = 0; k < ncomps; k++)
+        level[k] = minval + (l_float32)k * (maxval - minval) / (ncomps - 1);
+
+        /* For each value, the upper level of the bracket that holds it,
+         * and its fractional distance from the lower level */
+    for (val = 0, k = 1; val < 256; val++) {
+        while (k < ncomps - 1 && val > level[k])
+            k++;
+        bracket[val] = k;
+        fract[val] = (val - level[k - 1]) / (level[k] - level[k - 1]);
+        fract[val] = L_MAX(0.0, L_MIN(1.0, fract[val]));
+    }
+
+    fpixwt = fpixCreate(w, h);
+    fpixwi = fpixCreate(w, h);
+    fpixjp = fpixCreate(w, h);
+    pixd = pixCreateTemplate(pixs);
+    if (!fpixwt || !fpixwi || !fpixjp || !pixd) {
+        fpixDestroy(&fpixwt);
+        fpixDestroy(&fpixwi);
+        fpixDestroy(&fpixjp);
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("fpix or pixd not made", procName, NULL);
+    }
+    wplf = fpixGetWpl(fpixwt);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+
+    for (k = 0; k < ncomps; k++) {
+            /* Make the range weights W and the weighted image W * I
+             * for this level, and smooth both spatially */
+        if ((range = makeRangeTable(range_stdev, level[k])) == NULL) {
+            fpixDestroy(&fpixwt);
+            fpixDestroy(&fpixwi);
+            fpixDestroy(&fpixjp);
+            pixDestroy(&pixd);
+            return (PIX *)ERROR_PTR("range table not made", procName, NULL);
+        }
+        datawt = fpixGetData(fpixwt);
+        datawi = fpixGetData(fpixwi);
+        for (i = 0; i < h; i++) {
+            lines = datas + i * wpls;
+            linewt = datawt + i * wplf;
+            linewi = datawi + i * wplf;
+            for (j = 0; j < w; j++) {
+                val = GET_DATA_BYTE(lines, j);
+                linewt[j] = range[val];
+                linewi[j] = range[val] * val;
+            }
+        }
+        FREE(range);
+        if (recursiveGaussianLow(datawt, w, h, wplf, spatial_stdev,
+                                 spatial_stdev) ||
+            recursiveGaussianLow(datawi, w, h, wplf, spatial_stdev,
+                                 spatial_stdev)) {
+            fpixDestroy(&fpixwt);
+            fpixDestroy(&fpixwi);
+            fpixDestroy(&fpixjp);
+            pixDestroy(&pixd);
+            return (PIX *)ERROR_PTR("not smoothed", procName, NULL);
+        }
+
+            /* J = G * (W * I) / (G * W), in place in fpixwi.  Where the
+             * smoothed weight is negligible, no pixel near x is close
+             * to this level, and J is never used there. */
+        for (i = 0; i < h; i++) {
+            linewt = datawt + i * wplf;
+            linewi = datawi + i * wplf;
+            lines = datas + i * wpls;
+            for (j = 0; j < w; j++) {
+                if (linewt[j] > 1.0e-10)
+                    linewi[j] /= linewt[j];
+                else
+                    linewi[j] = GET_DATA_BYTE(lines, j);
+            }
+        }
+
+            /* Interpolate for the pixels whose values are in the
+             * bracket between the previous level and this one */
+        if (k > 0) {
+            datajp = fpixGetData(fpixjp);
+            for (i = 0; i < h; i++) {
+                lines = datas + i * wpls;
+                lined = datad + i * wpld;
+                linejp = datajp + i * wplf;
+                linewi = datawi + i * wplf;
+                for (j = 0; j < w; j++) {
+                    val = GET_DATA_BYTE(lines, j);
+                    if (bracket[val] != k)
+                        continue;
+                    sum = (1.0 - fract[val]) * linejp[j] +
+                          fract[val] * linewi[j];
+                    val = (l_int32)(sum + 0.5);
+                    val = L_MAX(0, L_MIN(255, val));
+                    SET_DATA_BYTE(lined, j, val);
+                }
+            }
+        }
+
+            /* This level becomes the previous one */
+        fpixt = fpixjp;
+        fpixjp = fpixwi;
+        fpixwi = fpixt;
+    }
+
+    fpixDestroy(&fpixwt);
+    fpixDestroy(&fpixwi);
+    fpixDestroy(&fpixjp);
+    return pixd;
+}
+
+
+/*--------------------------------------------------------------------*
+ *               Exact bilateral filter (slow; for reference)         *
+ *--------------------------------------------------------------------*/
+/*!
+ *  pixBilateralGrayExact()
+ *
+ *      Input:  pixs (8 bpp gray)
+ *              spatial_stdev (of gaussian kernel; in pixels, >= 0.5)
+ *              range_stdev (of gaussian range kernel; >= 5.0)
+ *      Return: pixd (8 bpp bilateral filtered image), or null on error
+ *
+ *  Notes:
+ *      (1) This computes the bilateral filter directly, with the
+ *          spatial gaussian truncated at 2 * @spatial_stdev and a
+ *          mirrored border.  The cost is proportional to the area of
+ *          the spatial kernel, so it is only practical for small
+ *          @spatial_stdev.  It is useful for evaluating the accuracy
+ *          of pixBilateralGray().
+ */
+PIX *
+pixBilateralGrayExact(PIX       *pixs,
+                      l_float32  spatial_stdev,
+                      l_float32  range_stdev)
+{
+l_int32     i, j, k, m, w, h, wplt, wpld, half, size, cval, val, diff;
+l_uint32   *datat, *datad, *linet, *lined;
+l_float32   sum, norm, wt;
+l_float32  *range;
+L_KERNEL   *kel;
+PIX        *pixt, *pixd;
+
+    PROCNAME("pixBilateralGrayExact");
+
+    if (!pixs || pixGetDepth(pixs) != 8 || pixGetColormap(pixs))
+        return (PIX *)ERROR_PTR("pixs undefined or not 8 bpp gray",
+                                procName, NULL);
+    if (spatial_stdev < 0.5)
+        return (PIX *)ERROR_PTR("spatial_stdev < 0.5", procName, NULL);
+    if (range_stdev < 5.0)
+        return (PIX *)ERROR_PTR("range_stdev < 5.0", procName, NULL);
+
+        /* The range table is indexed by the absolute difference */
+    if ((range = makeRangeTable(range_stdev, 0.0)) == NULL)
+        return (PIX *)ERROR_PTR("range table not made", procName, NULL);
+    half = (l_int32)(2.0 * spatial_stdev + 0.5);
+    size = 2 * half + 1;
+    if ((kel = makeGaussianKernel(half, half, spatial_stdev, 1.0)) == NULL) {
+        FREE(range);
+        return (PIX *)ERROR_PTR("kel not made", procName, NULL);
+    }
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if ((pixt = pixAddMirroredBorder(pixs, half, half, half, half)) == NULL) {
+        FREE(range);
+        kernelDestroy(&kel);
+        return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+    }
+    if ((pixd = pixCreateTemplate(pixs)) == NULL) {
+        FREE(range);
+        kernelDestroy(&kel);
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
+    datat = pixGetData(pixt);
+    wplt = pixGetWpl(pixt);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    for (i = 0; i < h; i++) {
+        lined = datad + i * wpld;
+        for (j = 0; j < w; j++) {
+            cval = GET_DATA_BYTE(datat + (i + half) * wplt, j + half);
+            sum = norm = 0.0;
+            for (k = 0; k < size; k++) {
+                linet = datat + (i + k) * wplt;
+                for (m = 0; m < size; m++) {
+                    val = GET_DATA_BYTE(linet, j + m);
+                    diff = L_ABS(val - cval);
+                    wt = kel->data[k][m] * range[diff];
+                    sum += wt * val;
+                    norm += wt;
+                }
+            }
+            val = (l_int32)(sum / norm + 0.5);
+            SET_DATA_BYTE(lined, j, val);
+        }
+    }
+
+    FREE(range);
+    kernelDestroy(&kel);
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
+/*--------------------------------------------------------------------*
+ *                                Helper                              *
+ *--------------------------------------------------------------------*/
+/*!
+ *  makeRangeTable()
+ *
+ *      Input:  range_stdev (of gaussian range kernel)
+ *              level (pixel value at the center of the gaussian)
+ *      Return: table of 256 range weights, or null on error
+ *
+ *  Notes:
+ *      (1) Entry v is exp(-(v - level)^2 / (2 * range_stdev^2)).
+ */
+static l_float32 *
+makeRangeTable(l_float32  range_stdev,
+               l_float32  level)
+{
+l_int32     v;
+l_float32   x, denom;
+l_float32  *tab;
+
+    PROCNAME("makeRangeTable");
+
+    if ((tab = (l_float32 *)CALLOC(256, sizeof(l_float32))) == NULL)
+        return (l_float32 *)ERROR_PTR("tab not made", procName, NULL);
+    denom = 2.0 * range_stdev * range_stdev;
+    for (v = 0; v < 256; v++) {
+        x = v - level;
+        tab[v] = exp(-x * x / denom);
+    }
+    return tab;
+}
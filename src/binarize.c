@@ -50,6 +50,17 @@
  *          PIX       *pixSauvolaGetThreshold()
  *          PIX       *pixApplyLocalThreshold();
  *
+ *      Streaming Sauvola binarization
+ *          L_SAUVOLA_STREAM  *sauvolaStreamCreate()
+ *          void               sauvolaStreamDestroy()
+ *          l_int32            sauvolaStreamAddLines()
+ *          l_int32            sauvolaStreamFinish()
+ *          static l_uint8    *sauvolaStreamGetSrcLine()
+ *          static void        sauvolaStreamInitSums()
+ *          static void        sauvolaStreamUpdateSums()
+ *          static void        sauvolaStreamMirrorSums()
+ *          static void        sauvolaStreamGetLine()
+ *
  *  Notes:
  *      (1) pixOtsuAdaptiveThreshold() computes a global threshold over each
  *          tile and performs the threshold operation, resulting in a
@@ -63,11 +74,23 @@
  *          the window size for the measurment at each pixel and a
  *          parameter that determines the amount of normalized local
  *          standard deviation to subtract from the local average value.
+ *      (4) The Sauvola stream gives the same result as
+ *          pixSauvolaBinarize(), but reads the image in bands and keeps
+ *          only (2 * whsize + 2) lines, so that the image need not be
+ *          held in memory.
  */
 
+#include <string.h>
 #include <math.h>
 #include "allheaders.h"
 
+static l_uint8 *sauvolaStreamGetSrcLine(L_SAUVOLA_STREAM *ss, l_int32 index,
+                                        l_int32 last);
+static void sauvolaStreamInitSums(L_SAUVOLA_STREAM *ss);
+static void sauvolaStreamUpdateSums(L_SAUVOLA_STREAM *ss, l_int32 last);
+static void sauvolaStreamMirrorSums(L_SAUVOLA_STREAM *ss);
+static void sauvolaStreamGetLine(L_SAUVOLA_STREAM *ss, l_uint32 *lined);
+
 /*------------------------------------------------------------------*
  *                 Adaptive Otsu-based thresholding                 *
  *------------------------------------------------------------------*/
@@ -120,6 +143,10 @@
  *          the Otsu score is within a defined fraction, @scorefract,
  *          of the max score.  To get the original Otsu algorithm, set
  *          @scorefract == 0.
+ *      (8) The tiles are not copied out.  The histograms for each row
+ *          of tiles are found in one pass over the lines of pixs, and
+ *          the thresholds are applied in a second pass that writes
+ *          the 1 bpp result directly.
  */
 l_int32
 pixOtsuAdaptiveThreshold(PIX       *pixs,
@@ -131,10 +158,12 @@ pixOtsuAdaptiveThreshold(PIX       *pixs,
                          PIX      **ppixth,
                          PIX      **ppixd)
 {
-l_int32     w, h, nx, ny, i, j, thresh;
-l_uint32    val;
-PIX        *pixt, *pixb, *pixthresh, *pixth, *pixd;
-PIXTILING  *pt;
+l_int32     w, h, nx, ny, wt, ht, i, j, x, y, x0, x1, y0, y1;
+l_int32     wpls, wplt, wpld, thresh;
+l_uint32   *datas, *datat, *datad, *lines, *linet, *lined;
+l_float32  *array;
+NUMA      **nahist;
+PIX        *pixg, *pixthresh, *pixth, *pixd;
 
     PROCNAME("pixOtsuAdaptiveThreshold");
 
@@ -147,23 +176,57 @@ PIXTILING  *pt;
     if (sx < 16 || sy < 16)
         return ERROR_INT("sx and sy must be >= 16", procName, 1);
 
-        /* Compute the threshold array for the tiles */
+        /* The tiles are the same as those of pixTilingCreate(): all
+         * have size wt x ht, except that the tiles in the last column
+         * and row take the remaining pixels. */
     pixGetDimensions(pixs, &w, &h, NULL);
     nx = L_MAX(1, w / sx);
     ny = L_MAX(1, h / sy);
+    wt = w / nx;
+    ht = h / ny;
     smoothx = L_MIN(smoothx, (nx - 1) / 2);
     smoothy = L_MIN(smoothy, (ny - 1) / 2);
-    pt = pixTilingCreate(pixs, nx, ny, 0, 0, 0, 0);
+    if (pixGetColormap(pixs))
+        pixg = pixRemoveColormap(pixs, REMOVE_CMAP_TO_GRAYSCALE);
+    else
+        pixg = pixClone(pixs);
+    datas = pixGetData(pixg);
+    wpls = pixGetWpl(pixg);
+
+        /* Compute the threshold array for the tiles.  The histograms
+         * for a row of tiles are accumulated in a single pass over
+         * their lines, without making a copy of each tile. */
     pixthresh = pixCreate(nx, ny, 8);
+    if ((nahist = (NUMA **)CALLOC(nx, sizeof(NUMA *))) == NULL) {
+        pixDestroy(&pixg);
+        pixDestroy(&pixthresh);
+        return ERROR_INT("nahist not made", procName, 1);
+    }
     for (i = 0; i < ny; i++) {
+        y0 = i * ht;
+        y1 = (i == ny - 1) ? h : y0 + ht;
         for (j = 0; j < nx; j++) {
-            pixt = pixTilingGetTile(pt, i, j);
-            pixSplitDistributionFgBg(pixt, scorefract, 1, &thresh,
-                                     NULL, NULL, 0);
+            nahist[j] = numaCreate(256);
+            numaSetCount(nahist[j], 256);  /* all initialized to 0.0 */
+        }
+        for (y = y0; y < y1; y++) {
+            lines = datas + y * wpls;
+            for (j = 0; j < nx; j++) {
+                x0 = j * wt;
+                x1 = (j == nx - 1) ? w : x0 + wt;
+                array = numaGetFArray(nahist[j], L_NOCOPY);
+                for (x = x0; x < x1; x++)
+                    array[GET_DATA_BYTE(lines, x)] += 1.0;
+            }
+        }
+        for (j = 0; j < nx; j++) {
+            numaSplitDistribution(nahist[j], scorefract, &thresh,
+                                  NULL, NULL, NULL, NULL, NULL);
             pixSetPixel(pixthresh, j, i, thresh);  /* see note (4) */
-            pixDestroy(&pixt);
+            numaDestroy(&nahist[j]);
         }
     }
+    FREE(nahist);
 
         /* Optionally smooth the threshold array */
     if (smoothx > 0 || smoothy > 0)
@@ -172,17 +235,27 @@ PIXTILING  *pt;
         pixth = pixClone(pixthresh);
     pixDestroy(&pixthresh);
 
-        /* Optionally apply the threshold array to binarize pixs */
+        /* Optionally apply the threshold array to binarize pixs.
+         * As with pixThresholdToBinary(), the dest pixel is ON if
+         * the src pixel is less than the threshold for its tile. */
     if (ppixd) {
         pixd = pixCreate(w, h, 1);
-        for (i = 0; i < ny; i++) {
+        datad = pixGetData(pixd);
+        wpld = pixGetWpl(pixd);
+        datat = pixGetData(pixth);
+        wplt = pixGetWpl(pixth);
+        for (y = 0; y < h; y++) {
+            lines = datas + y * wpls;
+            lined = datad + y * wpld;
+            linet = datat + L_MIN(y / ht, ny - 1) * wplt;
             for (j = 0; j < nx; j++) {
-                pixt = pixTilingGetTile(pt, i, j);
-                pixGetPixel(pixth, j, i, &val);
-                pixb = pixThresholdToBinary(pixt, val);
-                pixTilingPaintTile(pixd, i, j, pixb, pt);
-                pixDestroy(&pixt);
-                pixDestroy(&pixb);
+                x0 = j * wt;
+                x1 = (j == nx - 1) ? w : x0 + wt;
+                thresh = GET_DATA_BYTE(linet, j);
+                for (x = x0; x < x1; x++) {
+                    if (GET_DATA_BYTE(lines, x) < thresh)
+                        SET_DATA_BIT(lined, x);
+                }
             }
         }
         *ppixd = pixd;
@@ -193,7 +266,7 @@ PIXTILING  *pt;
     else
         pixDestroy(&pixth);
 
-    pixTilingDestroy(&pt);
+    pixDestroy(&pixg);
     return 0;
 }
 
@@ -441,6 +514,10 @@ PIX      *pixn, *pixm, *pixd, *pixt1, *pixt2, *pixt3, *pixt4;
  *      (4) The Sauvola threshold is determined from the formula:
  *              t = m * (1 - k * (1 - s / 128))
  *          See pixSauvolaBinarize() for details.
+ *      (5) If only the binarized image is needed, the Sauvola stream
+ *          (sauvolaStreamCreate(), etc.) uses much less memory than
+ *          either the tiled or untiled version, does not require the
+ *          full image to be present, and gives the same result.
  */
 l_int32
 pixSauvolaBinarizeTiled(PIX       *pixs,
@@ -613,11 +690,13 @@ PIX     *pixg, *pixsc, *pixm, *pixms, *pixth, *pixd;
     if (!pixg || !pixsc)
         return ERROR_INT("pixg and pixsc not made", procName, 1);
 
-        /* All these functions strip off the border pixels. */
-    if (ppixm || ppixth || ppixd)
-        pixm = pixWindowedMean(pixg, whsize, whsize, 1, 1);
-    if (ppixsd || ppixth || ppixd)
-        pixms = pixWindowedMeanSquare(pixg, whsize, whsize, 1);
+        /* Get the mean and mean square from a single integral image.
+         * All these functions strip off the border pixels. */
+    pixm = pixms = NULL;
+    pixWindowedStats(pixg, whsize, whsize, 1,
+                     (ppixm || ppixth || ppixd) ? &pixm : NULL,
+                     (ppixsd || ppixth || ppixd) ? &pixms : NULL,
+                     NULL, NULL);
     if (ppixth || ppixd)
         pixth = pixSauvolaGetThreshold(pixm, pixms, factor, ppixsd);
     if (ppixd)
@@ -800,3 +879,421 @@ PIX       *pixd;
 
     return pixd;
 }
+
+
+/*------------------------------------------------------------------*
+ *                  Streaming Sauvola binarization                  *
+ *------------------------------------------------------------------*/
+/*!
+ *  sauvolaStreamCreate()
+ *
+ *      Input:  w (width of the image to be binarized)
+ *              whsize (window half-width for measuring local statistics)
+ *              factor (factor for reducing threshold due to variance; >= 0)
+ *      Return: ss, or null on error
+ *
+ *  Notes:
+ *      (1) This binarizes an 8 bpp image that is presented in bands
+ *          of lines, from top to bottom, with the same results as
+ *          pixSauvolaBinarize() with @addborder = 1.  Only the last
+ *          (2 * @whsize + 2) lines of the src are held, so an image of
+ *          any height can be binarized without holding it in memory.
+ *      (2) Usage:
+ *              ss = sauvolaStreamCreate(w, whsize, factor);
+ *              for (each band pixb of the image, in order) {
+ *                  sauvolaStreamAddLines(ss, pixb, &pixd);
+ *                  if (pixd)  ... use the next pixGetHeight(pixd) lines
+ *              }
+ *              sauvolaStreamFinish(ss, &pixd);  ... use the last lines
+ *              sauvolaStreamDestroy(&ss);
+ *          The bands can have any height.  Each output line is
+ *          returned as soon as the src lines within @whsize of it
+ *          have been read.
+ *      (3) The column sums over the window are updated by adding the
+ *          new line and subtracting the line that leaves the window,
+ *          and the window sums are found by a running sum along each
+ *          output line.  The work per pixel is independent of @whsize.
+ *      (4) Because the stream holds its own state, different parts of
+ *          a page can be binarized independently: each can be fed to
+ *          its own stream, starting 2 * @whsize lines above the first
+ *          output line needed and discarding the extra output lines.
+ */
+L_SAUVOLA_STREAM *
+sauvolaStreamCreate(l_int32    w,
+                    l_int32    whsize,
+                    l_float32  factor)
+{
+L_SAUVOLA_STREAM  *ss;
+
+    PROCNAME("sauvolaStreamCreate");
+
+    if (whsize < 2)
+        return (L_SAUVOLA_STREAM *)ERROR_PTR("whsize must be >= 2",
+                                             procName, NULL);
+    if (w < 2 * whsize + 3)
+        return (L_SAUVOLA_STREAM *)ERROR_PTR("whsize too large for image",
+                                             procName, NULL);
+    if (factor < 0.0)
+        return (L_SAUVOLA_STREAM *)ERROR_PTR("factor must be >= 0",
+                                             procName, NULL);
+
+    if ((ss = (L_SAUVOLA_STREAM *)CALLOC(1, sizeof(L_SAUVOLA_STREAM)))
+        == NULL)
+        return (L_SAUVOLA_STREAM *)ERROR_PTR("ss not made", procName, NULL);
+    ss->w = w;
+    ss->whsize = whsize;
+    ss->factor = factor;
+    ss->nlines = 2 * whsize + 2;
+    ss->lines = (l_uint8 *)CALLOC(ss->nlines * w, sizeof(l_uint8));
+    ss->colsum = (l_uint32 *)CALLOC(w + 2 * whsize, sizeof(l_uint32));
+    ss->colsumsq = (l_uint32 *)CALLOC(w + 2 * whsize, sizeof(l_uint32));
+    if (!ss->lines || !ss->colsum || !ss->colsumsq) {
+        sauvolaStreamDestroy(&ss);
+        return (L_SAUVOLA_STREAM *)ERROR_PTR("arrays not made",
+                                             procName, NULL);
+    }
+    return ss;
+}
+
+
+/*!
+ *  sauvolaStreamDestroy()
+ *
+ *      Input:  &ss (<will be nulled>)
+ *      Return: void
+ */
+void
+sauvolaStreamDestroy(L_SAUVOLA_STREAM  **pss)
+{
+L_SAUVOLA_STREAM  *ss;
+
+    PROCNAME("sauvolaStreamDestroy");
+
+    if (!pss) {
+        L_WARNING("ptr address is null!", procName);
+        return;
+    }
+    if ((ss = *pss) == NULL)
+        return;
+
+    if (ss->lines) FREE(ss->lines);
+    if (ss->colsum) FREE(ss->colsum);
+    if (ss->colsumsq) FREE(ss->colsumsq);
+    FREE(ss);
+    *pss = NULL;
+    return;
+}
+
+
+/*!
+ *  sauvolaStreamAddLines()
+ *
+ *      Input:  ss
+ *              pixs (8 bpp band of lines, with the width of the image;
+ *                    not colormapped)
+ *              &pixd (<return> 1 bpp binarized lines that are complete,
+ *                     or null if there are none yet)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The lines of pixs follow those of the previous band.
+ *      (2) The first line of pixd follows the last line returned by
+ *          the previous call.  Until the stream is finished, the output
+ *          lags the input by @whsize lines.
+ */
+l_int32
+sauvolaStreamAddLines(L_SAUVOLA_STREAM  *ss,
+                      PIX               *pixs,
+                      PIX              **ppixd)
+{
+l_int32    i, j, w, h, wpls, wpld, whsize, nready, k;
+l_uint8   *line;
+l_uint32  *datas, *datad, *lines;
+PIX       *pixd;
+
+    PROCNAME("sauvolaStreamAddLines");
+
+    if (!ppixd)
+        return ERROR_INT("&pixd not defined", procName, 1);
+    *ppixd = NULL;
+    if (!ss)
+        return ERROR_INT("ss not defined", procName, 1);
+    if (!pixs || pixGetDepth(pixs) != 8)
+        return ERROR_INT("pixs undefined or not 8 bpp", procName, 1);
+    if (pixGetColormap(pixs))
+        return ERROR_INT("pixs is cmapped", procName, 1);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if (w != ss->w)
+        return ERROR_INT("pixs width differs from stream", procName, 1);
+
+        /* Output line i is complete when src line (i + whsize) is read */
+    whsize = ss->whsize;
+    nready = L_MAX(0, ss->nin + h - whsize) - ss->nout;
+    pixd = NULL;
+    datad = NULL;
+    wpld = 0;
+    if (nready > 0) {
+        if ((pixd = pixCreate(w, nready, 1)) == NULL)
+            return ERROR_INT("pixd not made", procName, 1);
+        datad = pixGetData(pixd);
+        wpld = pixGetWpl(pixd);
+    }
+
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
+    k = 0;  /* index of next line in pixd */
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        line = ss->lines + (ss->nin % ss->nlines) * w;
+        for (j = 0; j < w; j++)
+            line[j] = GET_DATA_BYTE(lines, j);
+        ss->nin++;
+        if (ss->nin == whsize + 1)  /* first window is available */
+            sauvolaStreamInitSums(ss);
+        if (ss->nin > whsize) {
+            if (ss->nout > 0)
+                sauvolaStreamUpdateSums(ss, -1);
+            sauvolaStreamGetLine(ss, datad + k * wpld);
+            ss->nout++;
+            k++;
+        }
+    }
+
+    *ppixd = pixd;
+    return 0;
+}
+
+
+/*!
+ *  sauvolaStreamFinish()
+ *
+ *      Input:  ss
+ *              &pixd (<return> 1 bpp binarized lines that remain)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Call this after the last band of the image has been added.
+ *          It returns the last @whsize lines of the image, using a
+ *          mirrored border below the last src line.
+ *      (2) The image must have at least (2 * @whsize + 3) lines.
+ */
+l_int32
+sauvolaStreamFinish(L_SAUVOLA_STREAM  *ss,
+                    PIX              **ppixd)
+{
+l_int32    i, h, nready, wpld;
+l_uint32  *datad;
+PIX       *pixd;
+
+    PROCNAME("sauvolaStreamFinish");
+
+    if (!ppixd)
+        return ERROR_INT("&pixd not defined", procName, 1);
+    *ppixd = NULL;
+    if (!ss)
+        return ERROR_INT("ss not defined", procName, 1);
+    h = ss->nin;
+    if (h < 2 * ss->whsize + 3)
+        return ERROR_INT("whsize too large for image", procName, 1);
+
+    nready = h - ss->nout;
+    if ((pixd = pixCreate(ss->w, nready, 1)) == NULL)
+        return ERROR_INT("pixd not made", procName, 1);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    for (i = 0; i < nready; i++) {
+        sauvolaStreamUpdateSums(ss, h - 1);
+        sauvolaStreamGetLine(ss, datad + i * wpld);
+        ss->nout++;
+    }
+
+    *ppixd = pixd;
+    return 0;
+}
+
+
+/*!
+ *  sauvolaStreamGetSrcLine()
+ *
+ *      Input:  ss
+ *              index (of src line; can be outside the image)
+ *              last (index of the last src line; -1 if not yet known)
+ *      Return: ptr to the src line in the ring buffer
+ *
+ *  Notes:
+ *      (1) Lines above the image are mirrored about the top, and lines
+ *          below the last one are mirrored about the bottom, as with
+ *          pixAddMirroredBorder().  The caller must ensure that the
+ *          requested line is in the ring buffer.
+ */
+static l_uint8 *
+sauvolaStreamGetSrcLine(L_SAUVOLA_STREAM  *ss,
+                        l_int32            index,
+                        l_int32            last)
+{
+    if (index < 0)
+        index = -index - 1;
+    else if (last >= 0 && index > last)
+        index = 2 * last + 1 - index;
+    return ss->lines + (index % ss->nlines) * ss->w;
+}
+
+
+/*!
+ *  sauvolaStreamInitSums()
+ *
+ *      Input:  ss
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Sets the column sums for the window of output line 0,
+ *          covering src lines -whsize ... whsize.
+ */
+static void
+sauvolaStreamInitSums(L_SAUVOLA_STREAM  *ss)
+{
+l_int32    i, j, w, whsize;
+l_uint32   val;
+l_uint8   *line;
+l_uint32  *colsum, *colsumsq;
+
+    w = ss->w;
+    whsize = ss->whsize;
+    colsum = ss->colsum + whsize;
+    colsumsq = ss->colsumsq + whsize;
+    memset(ss->colsum, 0, (w + 2 * whsize) * sizeof(l_uint32));
+    memset(ss->colsumsq, 0, (w + 2 * whsize) * sizeof(l_uint32));
+    for (i = -whsize; i <= whsize; i++) {
+        line = sauvolaStreamGetSrcLine(ss, i, -1);
+        for (j = 0; j < w; j++) {
+            val = line[j];
+            colsum[j] += val;
+            colsumsq[j] += val * val;
+        }
+    }
+    sauvolaStreamMirrorSums(ss);
+    return;
+}
+
+
+/*!
+ *  sauvolaStreamUpdateSums()
+ *
+ *      Input:  ss
+ *              last (index of the last src line; -1 if not yet known)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Moves the column sums from the window of output line
+ *          (nout - 1) to that of output line nout.
+ */
+static void
+sauvolaStreamUpdateSums(L_SAUVOLA_STREAM  *ss,
+                        l_int32            last)
+{
+l_int32    j, w, whsize, valin, valout;
+l_uint8   *linein, *lineout;
+l_uint32  *colsum, *colsumsq;
+
+    w = ss->w;
+    whsize = ss->whsize;
+    colsum = ss->colsum + whsize;
+    colsumsq = ss->colsumsq + whsize;
+    linein = sauvolaStreamGetSrcLine(ss, ss->nout + whsize, last);
+    lineout = sauvolaStreamGetSrcLine(ss, ss->nout - whsize - 1, last);
+    for (j = 0; j < w; j++) {
+        valin = linein[j];
+        valout = lineout[j];
+        colsum[j] += valin - valout;
+        colsumsq[j] += valin * valin - valout * valout;
+    }
+    sauvolaStreamMirrorSums(ss);
+    return;
+}
+
+
+/*!
+ *  sauvolaStreamMirrorSums()
+ *
+ *      Input:  ss
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Fills the border of @whsize column sums on each side by
+ *          mirroring, as with pixAddMirroredBorder().
+ */
+static void
+sauvolaStreamMirrorSums(L_SAUVOLA_STREAM  *ss)
+{
+l_int32    k, w, whsize;
+l_uint32  *colsum, *colsumsq;
+
+    w = ss->w;
+    whsize = ss->whsize;
+    colsum = ss->colsum + whsize;
+    colsumsq = ss->colsumsq + whsize;
+    for (k = 1; k <= whsize; k++) {
+        colsum[-k] = colsum[k - 1];
+        colsumsq[-k] = colsumsq[k - 1];
+        colsum[w - 1 + k] = colsum[w - k];
+        colsumsq[w - 1 + k] = colsumsq[w - k];
+    }
+    return;
+}
+
+
+/*!
+ *  sauvolaStreamGetLine()
+ *
+ *      Input:  ss
+ *              lined (1 bpp dest line for output line nout)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The mean, mean square and threshold are computed exactly as
+ *          in pixWindowedMean(), pixWindowedMeanSquare() and
+ *          pixSauvolaGetThreshold(), and the src pixel is set in the
+ *          dest if it is less than the threshold.
+ */
+static void
+sauvolaStreamGetLine(L_SAUVOLA_STREAM  *ss,
+                     l_uint32          *lined)
+{
+l_int32    j, w, wsize, mv, ms, var, thresh;
+l_uint32   sum;
+l_uint64   sumsq;
+l_uint8   *lines;
+l_uint32  *colsum, *colsumsq;
+l_float32  norm, sd;
+l_float64  dnorm;
+
+    w = ss->w;
+    wsize = 2 * ss->whsize + 1;
+    norm = 1.0 / (wsize * wsize);
+    dnorm = 1.0 / (wsize * wsize);
+    colsum = ss->colsum;
+    colsumsq = ss->colsumsq;
+    lines = sauvolaStreamGetSrcLine(ss, ss->nout, -1);
+
+        /* Running sums over the window along the line */
+    sum = 0;
+    sumsq = 0;
+    for (j = 0; j < wsize - 1; j++) {
+        sum += colsum[j];
+        sumsq += colsumsq[j];
+    }
+    for (j = 0; j < w; j++) {
+        sum += colsum[j + wsize - 1];
+        sumsq += colsumsq[j + wsize - 1];
+        mv = (l_uint8)(norm * sum);
+        ms = (l_uint32)(dnorm * (l_float64)sumsq);
+        var = ms - mv * mv;
+        sd = (l_float32)sqrt((l_float64)var);
+        thresh = (l_int32)(mv * (1.0 - ss->factor * (1.0 - sd / 128.)));
+        if (lines[j] < thresh)
+            SET_DATA_BIT(lined, j);
+        sum -= colsum[j];
+        sumsq -= colsumsq[j];
+    }
+    return;
+}
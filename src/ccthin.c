@@ -29,11 +29,20 @@
  *
  *     PIX    *pixThin()
  *     PIX    *pixThinGeneral()
+ *     PIX    *pixThinLUT()
  *     PIX    *pixThinExamples()
+ *
+ *     Static helpers for table-driven thinning
+ *         static l_int32   makeThinLUTs()
+ *         static l_int32   thinNeighbors()
  */
 
 #include "allheaders.h"
 
+static l_int32 makeThinLUTs(SELA *sela, l_uint8 **pluts);
+static l_int32 thinNeighbors(l_uint32 *data, l_int32 wpl, l_int32 x,
+                             l_int32 y);
+
 
     /* ------------------------------------------------------------
      * These sels (and their rotated counterparts) are the useful
@@ -211,7 +220,7 @@ SELA  *sela;
         selaAddSel(sela, sel, NULL, 0);
     }
 
-    pixd = pixThinGeneral(pixs, type, sela, maxiters);
+    pixd = pixThinLUT(pixs, type, sela, maxiters);
 
     selaDestroy(&sela);
     return pixd;
@@ -235,6 +244,8 @@ SELA  *sela;
  *          that are used in parallel for thinning from each
  *          of four directions.  One iteration consists of four
  *          such parallel thins.
+ *      (3) For 3x3 Sels, pixThinLUT() gives the same result and
+ *          is much faster.
  */
 PIX *
 pixThinGeneral(PIX     *pixs,
@@ -313,6 +324,189 @@ SEL     *sel, *selr;
 }
 
 
+/*!
+ *  pixThinLUT()
+ *
+ *      Input:  pixs (1 bpp)
+ *              type (L_THIN_FG, L_THIN_BG)
+ *              sela (of 3x3 Sels, with origin at the center, for
+ *                    parallel composite HMTs)
+ *              maxiters (max number of iters allowed; use 0 to iterate
+ *                        until completion)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This gives the same result as pixThinGeneral(), but
+ *          works from lookup tables, and only visits pixels whose
+ *          3x3 neighborhood can still match.
+ *      (2) For each of the four rotations, the union of the HMTs
+ *          at an ON pixel depends only on its 8 neighbors, so it is
+ *          put in a table indexed by the neighbor bits.  Each of the
+ *          four parallel thins in an iteration then finds all the
+ *          matching pixels with table lookups, before removing any
+ *          of them.  As with pixHMT(), pixels outside the image are
+ *          taken to be OFF.
+ *      (3) A pixel needs to be tested in a thin only if its
+ *          neighborhood has changed since it was last tested with the
+ *          Sels at that rotation.  We keep a list of these pixels
+ *          (the frontier), with a count of the rotations for which
+ *          each remains to be tested.  The count is reset to 4 when a
+ *          neighbor is removed.  Initially all ON pixels are tested,
+ *          except interior pixels whose neighbors are all ON, if
+ *          no Sel matches that neighborhood.  Regions that have
+ *          converged are therefore never rescanned.
+ */
+PIX *
+pixThinLUT(PIX     *pixs,
+           l_int32  type,
+           SELA    *sela,
+           l_int32  maxiters)
+{
+l_int32    i, j, k, r, w, h, wb, hb, wpl, nsels, n, ncand, ndel, nchanged;
+l_int32    x, y, p, q, dx, dy, skipfull;
+l_int32   *cand, *del;
+l_uint8   *count, *luts;
+l_uint32  *data, *line;
+PIX       *pixb, *pixd, *pixt;
+SEL       *sel;
+
+    PROCNAME("pixThinLUT");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, NULL);
+    if (type != L_THIN_FG && type != L_THIN_BG)
+        return (PIX *)ERROR_PTR("invalid fg/bg type", procName, NULL);
+    if (!sela)
+        return (PIX *)ERROR_PTR("sela not defined", procName, NULL);
+    nsels = selaGetCount(sela);
+    for (j = 0; j < nsels; j++) {
+        sel = selaGetSel(sela, j);
+        if (sel->sy != 3 || sel->sx != 3 || sel->cy != 1 || sel->cx != 1)
+            return (PIX *)ERROR_PTR("sels not all 3x3 and centered",
+                                    procName, NULL);
+    }
+    if (maxiters == 0) maxiters = 10000;
+
+    if (makeThinLUTs(sela, &luts))
+        return (PIX *)ERROR_PTR("luts not made", procName, NULL);
+
+        /* Work on a copy with a 1 pixel border of OFF pixels, so
+         * the neighbors of every image pixel are in the data */
+    if (type == L_THIN_FG)
+        pixt = pixClone(pixs);
+    else  /* bg thinning */
+        pixt = pixInvert(NULL, pixs);
+    pixb = pixAddBorder(pixt, 1, 0);
+    pixDestroy(&pixt);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    wb = w + 2;
+    hb = h + 2;
+    data = pixGetData(pixb);
+    wpl = pixGetWpl(pixb);
+    pixCountPixels(pixb, &n, NULL);
+    cand = (l_int32 *)CALLOC(L_MAX(n, 1), sizeof(l_int32));
+    del = (l_int32 *)CALLOC(L_MAX(n, 1), sizeof(l_int32));
+    count = (l_uint8 *)CALLOC(wb * hb, sizeof(l_uint8));
+    if (!cand || !del || !count) {
+        pixd = (PIX *)ERROR_PTR("arrays not made", procName, NULL);
+        goto cleanup;
+    }
+
+        /* Set up the initial frontier */
+    skipfull = TRUE;
+    for (r = 0; r < 4; r++) {
+        if (luts[256 * r + 255])
+            skipfull = FALSE;
+    }
+    ncand = 0;
+    for (y = 1; y <= h; y++) {
+        line = data + y * wpl;
+        for (x = 1; x <= w; x++) {
+            if ((x & 31) == 0 && line[x >> 5] == 0) {
+                x += 31;
+                continue;
+            }
+            if (!GET_DATA_BIT(line, x))
+                continue;
+            if (skipfull && thinNeighbors(data, wpl, x, y) == 255)
+                continue;
+            p = y * wb + x;
+            cand[ncand++] = p;
+            count[p] = 4;
+        }
+    }
+
+        /* Thin, with up to maxiters iterations */
+    for (i = 0; i < maxiters; i++) {
+        nchanged = 0;
+        for (r = 0; r < 4; r++) {  /* over 90 degree rotations of Sels */
+                /* Find all matches in parallel */
+            ndel = 0;
+            for (k = 0; k < ncand; k++) {
+                p = cand[k];
+                x = p % wb;
+                y = p / wb;
+                if (luts[256 * r + thinNeighbors(data, wpl, x, y)])
+                    del[ndel++] = p;
+                count[p]--;
+            }
+
+                /* Remove them */
+            for (k = 0; k < ndel; k++) {
+                p = del[k];
+                CLEAR_DATA_BIT(data + (p / wb) * wpl, p % wb);
+                count[p] = 0;
+            }
+
+                /* Drop pixels that have been tested in all rotations
+                 * since their neighborhood last changed */
+            for (k = 0, j = 0; k < ncand; k++) {
+                if (count[cand[k]] > 0)
+                    cand[j++] = cand[k];
+            }
+            ncand = j;
+
+                /* Add the remaining neighbors of removed pixels */
+            for (k = 0; k < ndel; k++) {
+                p = del[k];
+                x = p % wb;
+                y = p / wb;
+                for (dy = -1; dy <= 1; dy++) {
+                    line = data + (y + dy) * wpl;
+                    for (dx = -1; dx <= 1; dx++) {
+                        if (!GET_DATA_BIT(line, x + dx))
+                            continue;
+                        q = p + dy * wb + dx;
+                        if (count[q] == 0)
+                            cand[ncand++] = q;
+                        count[q] = 4;
+                    }
+                }
+            }
+            nchanged += ndel;
+        }
+        if (nchanged == 0) {
+            L_INFO_INT("%d iterations to completion", procName, i);
+            break;
+        }
+    }
+
+    pixd = pixRemoveBorder(pixb, 1);
+    if (type == L_THIN_BG)
+        pixInvert(pixd, pixd);
+
+cleanup:
+    pixDestroy(&pixb);
+    FREE(luts);
+    if (cand) FREE(cand);
+    if (del) FREE(del);
+    if (count) FREE(count);
+    return pixd;
+}
+
+
 /*!
  *  pixThinExamples()
  *
@@ -441,7 +635,7 @@ SELA  *sela;
         selaAddSel(sela, sel, NULL, 0);
         sel = selCreateFromString(sel_4_3, 3, 3, "sel_4_3");
         selaAddSel(sela, sel, NULL, 0);
-        pixt = pixThinGeneral(pixs, type, sela, maxiters);
+        pixt = pixThinLUT(pixs, type, sela, maxiters);
         pixd = pixRemoveBorderConnComps(pixt, 4);
         pixDestroy(&pixt);
         break;
@@ -449,7 +643,7 @@ SELA  *sela;
         sela = selaCreate(1);
         sel = selCreateFromString(sel_8_4, 3, 3, "sel_8_4");
         selaAddSel(sela, sel, NULL, 0);
-        pixt = pixThinGeneral(pixs, type, sela, maxiters);
+        pixt = pixThinLUT(pixs, type, sela, maxiters);
         pixd = pixRemoveBorderConnComps(pixt, 4);
         pixDestroy(&pixt);
         break;
@@ -458,7 +652,7 @@ SELA  *sela;
     }
 
     if (index <= 7)
-        pixd = pixThinGeneral(pixs, type, sela, maxiters);
+        pixd = pixThinLUT(pixs, type, sela, maxiters);
 
         /* Optionally display the sels */
     if (selfile) {
@@ -470,3 +664,96 @@ SELA  *sela;
     selaDestroy(&sela);
     return pixd;
 }
+
+
+/*----------------------------------------------------------------*
+ *             Static helpers for table-driven thinning           *
+ *----------------------------------------------------------------*/
+/*!
+ *  makeThinLUTs()
+ *
+ *      Input:  sela (of 3x3 Sels with origin at the center)
+ *              &luts (<return> 4 tables of 256 entries, one for each
+ *                     rotation of the Sels)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Entry (256 * r + index) is 1 if any Sel, rotated by
+ *          r * 90 degrees as in selRotateOrth(), is matched at an ON
+ *          pixel with neighbors given by index.  See thinNeighbors()
+ *          for the bit order.
+ */
+static l_int32
+makeThinLUTs(SELA      *sela,
+             l_uint8  **pluts)
+{
+l_int32   i, j, r, index, bit, nsels, val, match;
+l_uint8  *luts;
+SEL      *sel, *selr;
+
+    PROCNAME("makeThinLUTs");
+
+    *pluts = NULL;
+    if ((luts = (l_uint8 *)CALLOC(4 * 256, sizeof(l_uint8))) == NULL)
+        return ERROR_INT("luts not made", procName, 1);
+    nsels = selaGetCount(sela);
+    for (r = 0; r < 4; r++) {
+        for (j = 0; j < nsels; j++) {
+            sel = selaGetSel(sela, j);
+            selr = selRotateOrth(sel, r);
+            for (index = 0; index < 256; index++) {
+                match = TRUE;
+                for (i = 0, bit = 0; i < 9 && match; i++) {
+                    if (i == 4) {  /* the pixel itself is ON */
+                        val = 1;
+                    }
+                    else {
+                        val = (index >> (7 - bit)) & 1;
+                        bit++;
+                    }
+                    if (selr->data[i / 3][i % 3] == SEL_HIT && !val)
+                        match = FALSE;
+                    else if (selr->data[i / 3][i % 3] == SEL_MISS && val)
+                        match = FALSE;
+                }
+                if (match)
+                    luts[256 * r + index] = 1;
+            }
+            selDestroy(&selr);
+        }
+    }
+
+    *pluts = luts;
+    return 0;
+}
+
+
+/*!
+ *  thinNeighbors()
+ *
+ *      Input:  data, wpl (of 1 bpp image)
+ *              x, y (pixel location; not on the image boundary)
+ *      Return: 8 bit index of the neighbors
+ *
+ *  Notes:
+ *      (1) The neighbors are taken in raster order, with the
+ *          NW neighbor in the MSB and the SE neighbor in the LSB.
+ */
+static l_int32
+thinNeighbors(l_uint32  *data,
+              l_int32    wpl,
+              l_int32    x,
+              l_int32    y)
+{
+l_uint32  *line;
+
+    line = data + (y - 1) * wpl;
+    return (GET_DATA_BIT(line, x - 1) << 7) |
+           (GET_DATA_BIT(line, x) << 6) |
+           (GET_DATA_BIT(line, x + 1) << 5) |
+           (GET_DATA_BIT(line + wpl, x - 1) << 4) |
+           (GET_DATA_BIT(line + wpl, x + 1) << 3) |
+           (GET_DATA_BIT(line + 2 * wpl, x - 1) << 2) |
+           (GET_DATA_BIT(line + 2 * wpl, x) << 1) |
+           GET_DATA_BIT(line + 2 * wpl, x + 1);
+}
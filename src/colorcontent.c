@@ -53,6 +53,7 @@
  *
  *      Finds the number of unique colors in an image
  *         l_int32    pixNumColors()
+ *         l_int32    pixCountRGBColors()
  *
  *  Color is tricky.  If we consider gray (r = g = b) to have no color
  *  content, how should we define the color content in each component
@@ -115,8 +116,18 @@
  *        this value is in /../.
  */
 
+#include <string.h>
 #include "allheaders.h"
 
+    /* Distinct colors are counted in an open-addressed hash table
+     * while it is small.  Beyond this size (2^19 words, the size of a
+     * bit per rgb color) a presence bitmap takes over.  */
+static const l_int32  MAX_COLOR_HASH_BITS = 19;
+
+static l_uint32 *colorHashToBitmap(l_uint32 *hashtab, l_int32 size);
+static l_uint32 *colorHashGrow(l_uint32 *hashtab, l_int32 nbits);
+static l_uint32 colorKeyToIndex(l_uint32 key);
+
 
 /*!
  *  pixColorContent()
@@ -907,19 +918,25 @@ PIXCMAP   *cmap;
  *      (2) Use @factor == 1 to find the actual number of colors.
  *          Use @factor > 1 to quickly find the approximate number of colors.
  *      (3) For d = 2, 4 or 8 bpp grayscale, this returns the number
- *          of colors found in the image in 'ncolors'.
+ *          of colors found in the image in 'ncolors'.  The scan stops
+ *          when every possible value has been found.
  *      (4) For d = 32 bpp (rgb), if the number of colors is
- *          greater than 256, this returns 0 in 'ncolors'.
+ *          greater than 256, this returns 0 in 'ncolors'.  The colors
+ *          are counted exactly by pixCountRGBColors(), which stops as
+ *          soon as the 257th color is found.
+ *      (5) For a large rgb image with @factor == 1, the image is first
+ *          sampled with factor 4.  The colors in the sampled pixels
+ *          are a subset of those in the image, so if there are more
+ *          than 256 of them the answer is certain and the full scan
+ *          is skipped.  Otherwise the full scan gives the count.
  */
 l_int32
 pixNumColors(PIX      *pixs,
              l_int32   factor,
              l_int32  *pncolors)
 {
-l_int32    w, h, d, i, j, wpl, hashsize, sum, count;
-l_int32    rval, gval, bval, val;
+l_int32    w, h, d, i, j, wpl, sum, count, maxval, val;
 l_int32   *inta;
-l_uint32   pixel;
 l_uint32  *data, *line;
 PIXCMAP   *cmap;
 
@@ -935,58 +952,257 @@ PIXCMAP   *cmap;
         return ERROR_INT("d not in {2, 4, 8, 32}", procName, 1);
     if (factor < 1) factor = 1;
 
+    if (d == 32) {  /* rgb; quit if we get above 256 colors */
+        if (factor == 1 && w * h >= 65536) {
+            if (pixCountRGBColors(pixs, 4, 256, &count))
+                return ERROR_INT("sampled colors not counted", procName, 1);
+            if (count > 256)
+                return 0;
+        }
+        if (pixCountRGBColors(pixs, factor, 256, &count))
+            return ERROR_INT("colors not counted", procName, 1);
+        if (count <= 256)
+            *pncolors = count;
+        return 0;
+    }
+
+        /* Grayscale; quit when all values have been found */
     data = pixGetData(pixs);
     wpl = pixGetWpl(pixs);
+    maxval = (1 << d) - 1;
+    inta = (l_int32 *)CALLOC(256, sizeof(l_int32));
     sum = 0;
-    if (d != 32) {  /* grayscale */
-        inta = (l_int32 *)CALLOC(256, sizeof(l_int32));
-        for (i = 0; i < h; i += factor) {
-            line = data + i * wpl;
-            for (j = 0; j < w; j += factor) {
-                if (d == 8)
-                    val = GET_DATA_BYTE(line, j);
-                else if (d == 4)
-                    val = GET_DATA_QBIT(line, j);
-                else  /* d == 2 */
-                    val = GET_DATA_DIBIT(line, j);
+    for (i = 0; i < h && sum <= maxval; i += factor) {
+        line = data + i * wpl;
+        for (j = 0; j < w; j += factor) {
+            if (d == 8)
+                val = GET_DATA_BYTE(line, j);
+            else if (d == 4)
+                val = GET_DATA_QBIT(line, j);
+            else  /* d == 2 */
+                val = GET_DATA_DIBIT(line, j);
+            if (inta[val] == 0) {
                 inta[val] = 1;
+                sum++;
             }
         }
-        for (i = 0; i < 256; i++)
-            if (inta[i]) sum++;
-        *pncolors = sum;
-        FREE(inta);
-
-        if (factor == 1 && ((cmap = pixGetColormap(pixs)) != NULL)) {
-            count = pixcmapGetCount(cmap);
-            if (sum != count)
-                L_WARNING_INT("colormap size %d differs from actual colors",
-                              procName, count);
-        }
-        return 0;
     }
+    *pncolors = sum;
+    FREE(inta);
+
+    if (factor == 1 && ((cmap = pixGetColormap(pixs)) != NULL)) {
+        count = pixcmapGetCount(cmap);
+        if (sum != count)
+            L_WARNING_INT("colormap size %d differs from actual colors",
+                          procName, count);
+    }
+    return 0;
+}
+
+
+/*!
+ *  pixCountRGBColors()
+ *      Input:  pixs (32 bpp rgb)
+ *              factor (subsampling factor; integer)
+ *              maxcolors (stop counting when more than this number of
+ *                         colors is found; 0 to count all colors)
+ *              &ncolors (<return> the number of distinct colors found,
+ *                        or @maxcolors + 1 if there are more)
+ *      Return: 0 if OK, 1 on error.
+ *
+ *  Notes:
+ *      (1) This counts the distinct (r,g,b) values exactly; the alpha
+ *          byte is ignored.  Colors go in a hash table, which becomes
+ *          a bitmap over all 2^24 colors if it gets large.
+ *      (2) Use @maxcolors > 0 when only the question "are there more
+ *          than @maxcolors colors?" is to be answered.  The scan stops
+ *          at the first color past the limit.  If there are no more
+ *          than @maxcolors colors, the count is the same as with
+ *          @maxcolors == 0.
+ *      (3) Flat regions are skipped cheaply: a pixel equal to the
+ *          previous one on the line is not looked up, and with
+ *          @factor == 1, a line equal to the previous line is skipped.
+ *      (4) The colors found with @factor > 1 are a subset of those
+ *          found with @factor == 1, so the subsampled count is a lower
+ *          bound on the full count.  If it exceeds a threshold, the
+ *          full count does too.
+ */
+l_int32
+pixCountRGBColors(PIX      *pixs,
+                  l_int32   factor,
+                  l_int32   maxcolors,
+                  l_int32  *pncolors)
+{
+l_int32    i, j, w, h, wpl, nbits, size, shift, ncolors;
+l_uint32   key, lastkey, index, mask;
+l_uint32  *data, *line, *lastline, *hashtab, *newtab, *bitmap;
+
+    PROCNAME("pixCountRGBColors");
+
+    if (!pncolors)
+        return ERROR_INT("&ncolors not defined", procName, 1);
+    *pncolors = 0;
+    if (!pixs || pixGetDepth(pixs) != 32)
+        return ERROR_INT("pixs not defined or not 32 bpp", procName, 1);
+    if (factor < 1) factor = 1;
+    if (maxcolors < 0) maxcolors = 0;
+
+        /* Size the table for a load factor of at most 1/2 at the limit */
+    nbits = 10;
+    if (maxcolors > 0) {
+        while (nbits < MAX_COLOR_HASH_BITS && (1 << nbits) < 2 * maxcolors + 2)
+            nbits++;
+    }
+    size = 1 << nbits;
+    if ((hashtab = (l_uint32 *)CALLOC(size, sizeof(l_uint32))) == NULL)
+        return ERROR_INT("hashtab not made", procName, 1);
+    shift = 32 - nbits;
+    mask = size - 1;
+    bitmap = NULL;
 
-        /* 32 bpp rgb; quit if we get above 256 colors */
-    hashsize = 5507;  /* big and prime; collisions are not likely */
-    inta = (l_int32 *)CALLOC(hashsize, sizeof(l_int32));
+        /* The key is the pixel with the alpha byte set to 0xff, so
+         * that 0 marks an empty slot.  Its rgb color is the bitmap
+         * index; see colorKeyToIndex(). */
+    pixGetDimensions(pixs, &w, &h, NULL);
+    data = pixGetData(pixs);
+    wpl = pixGetWpl(pixs);
+    ncolors = 0;
+    lastline = NULL;
     for (i = 0; i < h; i += factor) {
         line = data + i * wpl;
+        if (factor == 1 && lastline && !memcmp(line, lastline, 4 * w))
+            continue;
+        lastline = line;
+        lastkey = 0;
         for (j = 0; j < w; j += factor) {
-            pixel = line[j];
-            extractRGBValues(pixel, &rval, &gval, &bval);
-            val = (137 * rval + 269 * gval + 353 * bval) % hashsize;
-            if (inta[val] == 0) {
-                inta[val] = 1;
-                sum++;
-                if (sum > 256) {
-                    FREE(inta);
-                    return 0;
+            key = line[j] | (0xff << L_ALPHA_SHIFT);
+            if (key == lastkey)
+                continue;
+            lastkey = key;
+            if (bitmap) {
+                index = colorKeyToIndex(key);
+                if (bitmap[index >> 5] & (0x80000000 >> (index & 31)))
+                    continue;
+                bitmap[index >> 5] |= 0x80000000 >> (index & 31);
+            } else {
+                index = (key * 0x9e3779b1) >> shift;
+                while (hashtab[index] != 0 && hashtab[index] != key)
+                    index = (index + 1) & mask;
+                if (hashtab[index] == key)
+                    continue;
+                hashtab[index] = key;
+                if (2 * (ncolors + 1) > size) {  /* grow the table */
+                    if (nbits == MAX_COLOR_HASH_BITS) {
+                        bitmap = colorHashToBitmap(hashtab, size);
+                        if (!bitmap) {
+                            FREE(hashtab);
+                            return ERROR_INT("bitmap not made", procName, 1);
+                        }
+                        hashtab = NULL;
+                    } else {
+                        if ((newtab = colorHashGrow(hashtab, nbits)) == NULL) {
+                            FREE(hashtab);
+                            return ERROR_INT("hashtab not grown", procName, 1);
+                        }
+                        hashtab = newtab;
+                        nbits++;
+                        size = 1 << nbits;
+                        shift = 32 - nbits;
+                        mask = size - 1;
+                    }
                 }
             }
+            ncolors++;
+            if (maxcolors > 0 && ncolors > maxcolors) {
+                i = h;  /* done */
+                break;
+            }
         }
     }
 
-    *pncolors = sum;
-    FREE(inta);
+    *pncolors = ncolors;
+    if (hashtab) FREE(hashtab);
+    if (bitmap) FREE(bitmap);
     return 0;
 }
+
+
+/*!
+ *  colorHashGrow()
+ *
+ *      Input:  hashtab (of size 2^nbits; freed unless on error)
+ *              nbits
+ *      Return: hash table of size 2^(nbits + 1) with the same keys,
+ *              or null on error
+ */
+static l_uint32 *
+colorHashGrow(l_uint32  *hashtab,
+              l_int32    nbits)
+{
+l_int32    i, size;
+l_uint32   key, index, mask;
+l_uint32  *newtab;
+
+    PROCNAME("colorHashGrow");
+
+    size = 1 << nbits;
+    if ((newtab = (l_uint32 *)CALLOC(2 * size, sizeof(l_uint32))) == NULL)
+        return (l_uint32 *)ERROR_PTR("newtab not made", procName, NULL);
+    mask = 2 * size - 1;
+    for (i = 0; i < size; i++) {
+        if ((key = hashtab[i]) == 0)
+            continue;
+        index = (key * 0x9e3779b1) >> (31 - nbits);
+        while (newtab[index] != 0)
+            index = (index + 1) & mask;
+        newtab[index] = key;
+    }
+    FREE(hashtab);
+    return newtab;
+}
+
+
+/*!
+ *  colorHashToBitmap()
+ *
+ *      Input:  hashtab (freed unless on error)
+ *              size (of hashtab)
+ *      Return: bitmap over all rgb colors, with the keys set,
+ *              or null on error
+ */
+static l_uint32 *
+colorHashToBitmap(l_uint32  *hashtab,
+                  l_int32    size)
+{
+l_int32    i;
+l_uint32   index;
+l_uint32  *bitmap;
+
+    PROCNAME("colorHashToBitmap");
+
+    if ((bitmap = (l_uint32 *)CALLOC(1 << 19, sizeof(l_uint32))) == NULL)
+        return (l_uint32 *)ERROR_PTR("bitmap not made", procName, NULL);
+    for (i = 0; i < size; i++) {
+        if (hashtab[i] == 0)
+            continue;
+        index = colorKeyToIndex(hashtab[i]);
+        bitmap[index >> 5] |= 0x80000000 >> (index & 31);
+    }
+    FREE(hashtab);
+    return bitmap;
+}
+
+
+/*!
+ *  colorKeyToIndex()
+ *
+ *      Input:  key (rgb pixel, with any alpha)
+ *      Return: index of the rgb color, in [0 ... 2^24 - 1]
+ */
+static l_uint32
+colorKeyToIndex(l_uint32  key)
+{
+    return (((key >> L_RED_SHIFT) & 0xff) << 16) |
+           (((key >> L_GREEN_SHIFT) & 0xff) << 8) |
+           ((key >> L_BLUE_SHIFT) & 0xff);
+}
@@ -30,10 +30,11 @@
  *      Top-level color morphological operations
  *
  *            PIX     *pixColorMorph()
+ *            PIX     *pixColorMorphSel()
  *
- *      Method: Algorithm by van Herk and Gil and Werman, 1992
- *              Apply grayscale morphological operations separately
- *              to each component.
+ *      Method: Flat Sels are decomposed into line segments, and all
+ *              components are processed together in one pass over
+ *              the interleaved data.  See pixErodeGraySel().
  */
 
 #include "allheaders.h"
@@ -53,8 +54,8 @@
  *      Return: pixd
  *
  *  Notes:
- *      (1) This does the morph operation on each component separately,
- *          and recombines the result.
+ *      (1) This does the morph operation on each component, using
+ *          pixColorMorphSel() with a brick Sel.
  *      (2) Sel is a brick with all elements being hits.
  *      (3) If hsize = vsize = 1, just returns a copy.
  */
@@ -64,7 +65,8 @@ pixColorMorph(PIX     *pixs,
               l_int32  hsize,
               l_int32  vsize)
 {
-PIX  *pixr, *pixg, *pixb, *pixrm, *pixgm, *pixbm, *pixd;
+PIX  *pixd;
+SEL  *sel;
 
     PROCNAME("pixColorMorph");
 
@@ -89,36 +91,77 @@ PIX  *pixr, *pixg, *pixb, *pixrm, *pixgm, *pixbm, *pixd;
     if (hsize == 1 && vsize == 1)
         return pixCopy(NULL, pixs);
 
-    pixr = pixGetRGBComponent(pixs, COLOR_RED);
-    pixg = pixGetRGBComponent(pixs, COLOR_GREEN);
-    pixb = pixGetRGBComponent(pixs, COLOR_BLUE);
-    if (type == L_MORPH_DILATE) {
-        pixrm = pixDilateGray(pixr, hsize, vsize);
-        pixgm = pixDilateGray(pixg, hsize, vsize);
-        pixbm = pixDilateGray(pixb, hsize, vsize);
-    }
-    else if (type == L_MORPH_ERODE) {
-        pixrm = pixErodeGray(pixr, hsize, vsize);
-        pixgm = pixErodeGray(pixg, hsize, vsize);
-        pixbm = pixErodeGray(pixb, hsize, vsize);
-    }
-    else if (type == L_MORPH_OPEN) {
-        pixrm = pixOpenGray(pixr, hsize, vsize);
-        pixgm = pixOpenGray(pixg, hsize, vsize);
-        pixbm = pixOpenGray(pixb, hsize, vsize);
-    }
-    else {   /* type == L_MORPH_CLOSE */
-        pixrm = pixCloseGray(pixr, hsize, vsize);
-        pixgm = pixCloseGray(pixg, hsize, vsize);
-        pixbm = pixCloseGray(pixb, hsize, vsize);
+    sel = selCreateBrick(vsize, hsize, vsize / 2, hsize / 2, SEL_HIT);
+    pixd = pixColorMorphSel(pixs, type, sel);
+    selDestroy(&sel);
+    return pixd;
+}
+
+
+/*!
+ *  pixColorMorphSel()
+ *
+ *      Input:  pixs (32 bpp rgb)
+ *              type  (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_OPEN,
+ *                     or L_MORPH_CLOSE)
+ *              sel (flat, of any shape; only the hits are used)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This does the morph operation on each component, in a
+ *          single pass over the image for each erosion or dilation.
+ *      (2) As when the components were processed separately, the
+ *          alpha byte of the result is 0.
+ *      (3) Opening is erosion followed by dilation with the same
+ *          Sel, and closing is the reverse.
+ */
+PIX *
+pixColorMorphSel(PIX     *pixs,
+                 l_int32  type,
+                 SEL     *sel)
+{
+l_int32    i, n;
+l_uint32   mask;
+l_uint32  *data;
+PIX       *pixt, *pixd;
+
+    PROCNAME("pixColorMorphSel");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (pixGetDepth(pixs) != 32)
+        return (PIX *)ERROR_PTR("pixs not 32 bpp", procName, NULL);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, NULL);
+    if (type != L_MORPH_DILATE && type != L_MORPH_ERODE &&
+        type != L_MORPH_OPEN && type != L_MORPH_CLOSE)
+        return (PIX *)ERROR_PTR("invalid morph type", procName, NULL);
+
+    if (type == L_MORPH_DILATE)
+        pixd = pixDilateGraySel(pixs, sel);
+    else if (type == L_MORPH_ERODE)
+        pixd = pixErodeGraySel(pixs, sel);
+    else {
+        if (type == L_MORPH_OPEN)
+            pixt = pixErodeGraySel(pixs, sel);
+        else   /* type == L_MORPH_CLOSE */
+            pixt = pixDilateGraySel(pixs, sel);
+        if (!pixt)
+            return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+        if (type == L_MORPH_OPEN)
+            pixd = pixDilateGraySel(pixt, sel);
+        else
+            pixd = pixErodeGraySel(pixt, sel);
+        pixDestroy(&pixt);
     }
-    pixd = pixCreateRGBImage(pixrm, pixgm, pixbm);
-    pixDestroy(&pixr);
-    pixDestroy(&pixrm);
-    pixDestroy(&pixg);
-    pixDestroy(&pixgm);
-    pixDestroy(&pixb);
-    pixDestroy(&pixbm);
+    if (!pixd)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
 
+        /* Clear the alpha byte */
+    mask = ~(0xff << L_ALPHA_SHIFT);
+    data = pixGetData(pixd);
+    n = pixGetWpl(pixd) * pixGetHeight(pixd);
+    for (i = 0; i < n; i++)
+        data[i] &= mask;
     return pixd;
 }
@@ -54,6 +54,7 @@
  *          static PIX       *pixOctreeQuantizePixels()
  *
  *        which calls
+ *          static l_uint32  *octreeMakeCellTable()
  *          static l_int32    octreeFindColorCell()
  *
  *      Helper cqcell functions
@@ -208,7 +209,8 @@ static const l_int32  FIXED_DIF_CAP = 0;
 static const l_int32  POP_DIF_CAP = 40;
 
 
-    /* Static octree helper function */
+    /* Static octree helper functions */
+static l_uint32 *octreeMakeCellTable(CQCELL ***cqcaa);
 static l_int32 octreeFindColorCell(l_int32 octindex, CQCELL ***cqcaa,
                                    l_int32 *pindex, l_int32 *prval,
                                    l_int32 *pgval, l_int32 *pbval);
@@ -936,20 +938,23 @@ l_int32    nt, nr, ival;
  *          integer buffers.  Because the dif is truncated to an
  *          integer, the dither is accurate to 1/8 of a sample increment,
  *          or 1/2048 of the color range.
+ *      (3) The tree is first flattened into a table from octindex to
+ *          colortable index and color, so that each pixel takes one
+ *          lookup.  Without dithering, each row is then independent
+ *          of the others.  With dithering, the table is used by
+ *          ditherToCmapLow(), which is shared with the other
+ *          color quantizers.
  */
 static PIX *
 pixOctreeQuantizePixels(PIX       *pixs,
                         CQCELL  ***cqcaa,
                         l_int32    ditherflag)
 {
-l_uint8   *bufu8r, *bufu8g, *bufu8b;
 l_int32    rval, gval, bval;
-l_int32    octindex, index;
-l_int32    val1, val2, val3, dif;
+l_int32    octindex;
 l_int32    w, h, wpls, wpld, i, j;
-l_int32    rc, gc, bc;
-l_int32   *buf1r, *buf1g, *buf1b, *buf2r, *buf2g, *buf2b;
-l_uint32  *rtab, *gtab, *btab;
+l_int32   *bufs1, *bufs2;
+l_uint32  *rtab, *gtab, *btab, *celltab;
 l_uint32  *datas, *datad, *lines, *lined;
 PIX       *pixd;
 
@@ -962,16 +967,27 @@ PIX       *pixd;
     if (!cqcaa)
         return (PIX *)ERROR_PTR("cqcaa not defined", procName, NULL);
 
-        /* Make the canonical index tables */
+        /* Make the canonical index tables and the table of cells */
     if (makeRGBToIndexTables(&rtab, &gtab, &btab, CQ_NLEVELS))
         return (PIX *)ERROR_PTR("tables not made", procName, NULL);
+    if ((celltab = octreeMakeCellTable(cqcaa)) == NULL) {
+        FREE(rtab);
+        FREE(gtab);
+        FREE(btab);
+        return (PIX *)ERROR_PTR("celltab not made", procName, NULL);
+    }
 
         /* Make output 8 bpp palette image */
     pixGetDimensions(pixs, &w, &h, NULL);
     datas = pixGetData(pixs);
     wpls = pixGetWpl(pixs);
-    if ((pixd = pixCreate(w, h, 8)) == NULL)
+    if ((pixd = pixCreate(w, h, 8)) == NULL) {
+        FREE(rtab);
+        FREE(gtab);
+        FREE(btab);
+        FREE(celltab);
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
     pixCopyResolution(pixd, pixs);
     pixCopyInputFormat(pixd, pixs);
     datad = pixGetData(pixd);
@@ -989,147 +1005,66 @@ PIX       *pixd;
             for (j = 0; j < w; j++) {
                 extractRGBValues(lines[j], &rval, &gval, &bval);
                 octindex = rtab[rval] | gtab[gval] | btab[bval];
-                octreeFindColorCell(octindex, cqcaa, &index, &rc, &gc, &bc);
-                SET_DATA_BYTE(lined, j, index);
+                SET_DATA_BYTE(lined, j, celltab[octindex] & 0xff);
             }
         }
     }
     else {  /* Dither */
-        bufu8r = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-        bufu8g = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-        bufu8b = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-        buf1r = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf1g = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf1b = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf2r = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf2g = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf2b = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        if (!bufu8r || !bufu8g || !bufu8b)
-            return (PIX *)ERROR_PTR("uint8 mono line buf not made",
-                procName, NULL);
-        if (!buf1r || !buf1g || !buf1b || !buf2r || !buf2g || !buf2b)
-            return (PIX *)ERROR_PTR("mono line buf not made", procName, NULL);
-
-            /* Start by priming buf2; line 1 is above line 2 */
-        pixGetRGBLine(pixs, 0, bufu8r, bufu8g, bufu8b);
-        for (j = 0; j < w; j++) {
-            buf2r[j] = 64 * bufu8r[j];
-            buf2g[j] = 64 * bufu8g[j];
-            buf2b[j] = 64 * bufu8b[j];
+        bufs1 = (l_int32 *)CALLOC(3 * w, sizeof(l_int32));
+        bufs2 = (l_int32 *)CALLOC(3 * w, sizeof(l_int32));
+        if (!bufs1 || !bufs2) {
+            L_ERROR("line bufs not made", procName);
+            pixDestroy(&pixd);
         }
-
-        for (i = 0; i < h - 1; i++) {
-                /* Swap data 2 --> 1, and read in new line 2 */
-            memcpy(buf1r, buf2r, 4 * w);
-            memcpy(buf1g, buf2g, 4 * w);
-            memcpy(buf1b, buf2b, 4 * w);
-            pixGetRGBLine(pixs, i + 1, bufu8r, bufu8g, bufu8b);
-            for (j = 0; j < w; j++) {
-                buf2r[j] = 64 * bufu8r[j];
-                buf2g[j] = 64 * bufu8g[j];
-                buf2b[j] = 64 * bufu8b[j];
-            }
-
-                /* Dither */
-            lined = datad + i * wpld;
-            for (j = 0; j < w - 1; j++) {
-                rval = buf1r[j] / 64;
-                gval = buf1g[j] / 64;
-                bval = buf1b[j] / 64;
-                octindex = rtab[rval] | gtab[gval] | btab[bval];
-                octreeFindColorCell(octindex, cqcaa, &index, &rc, &gc, &bc);
-                SET_DATA_BYTE(lined, j, index);
-
-                dif = buf1r[j] / 8 - 8 * rc;
-                if (dif != 0) {
-                    val1 = buf1r[j + 1] + 3 * dif;
-                    val2 = buf2r[j] + 3 * dif;
-                    val3 = buf2r[j + 1] + 2 * dif;
-                    if (dif > 0) {
-                        buf1r[j + 1] = L_MIN(16383, val1);
-                        buf2r[j] = L_MIN(16383, val2);
-                        buf2r[j + 1] = L_MIN(16383, val3);
-                    }
-                    else if (dif < 0) {
-                        buf1r[j + 1] = L_MAX(0, val1);
-                        buf2r[j] = L_MAX(0, val2);
-                        buf2r[j + 1] = L_MAX(0, val3);
-                    }
-                }
-
-                dif = buf1g[j] / 8 - 8 * gc;
-                if (dif != 0) {
-                    val1 = buf1g[j + 1] + 3 * dif;
-                    val2 = buf2g[j] + 3 * dif;
-                    val3 = buf2g[j + 1] + 2 * dif;
-                    if (dif > 0) {
-                        buf1g[j + 1] = L_MIN(16383, val1);
-                        buf2g[j] = L_MIN(16383, val2);
-                        buf2g[j + 1] = L_MIN(16383, val3);
-                    }
-                    else if (dif < 0) {
-                        buf1g[j + 1] = L_MAX(0, val1);
-                        buf2g[j] = L_MAX(0, val2);
-                        buf2g[j + 1] = L_MAX(0, val3);
-                    }
-                }
-
-                dif = buf1b[j] / 8 - 8 * bc;
-                if (dif != 0) {
-                    val1 = buf1b[j + 1] + 3 * dif;
-                    val2 = buf2b[j] + 3 * dif;
-                    val3 = buf2b[j + 1] + 2 * dif;
-                    if (dif > 0) {
-                        buf1b[j + 1] = L_MIN(16383, val1);
-                        buf2b[j] = L_MIN(16383, val2);
-                        buf2b[j + 1] = L_MIN(16383, val3);
-                    }
-                    else if (dif < 0) {
-                        buf1b[j + 1] = L_MAX(0, val1);
-                        buf2b[j] = L_MAX(0, val2);
-                        buf2b[j + 1] = L_MAX(0, val3);
-                    }
-                }
-            }
-
-                /* Get last pixel in row; no downward propagation */
-            rval = buf1r[w - 1] / 64;
-            gval = buf1g[w - 1] / 64;
-            bval = buf1b[w - 1] / 64;
-            octindex = rtab[rval] | gtab[gval] | btab[bval];
-            octreeFindColorCell(octindex, cqcaa, &index, &rc, &gc, &bc);
-            SET_DATA_BYTE(lined, w - 1, index);
-        }
-
-            /* Get last row of pixels; no leftward propagation */
-        lined = datad + (h - 1) * wpld;
-        for (j = 0; j < w; j++) {
-            rval = buf2r[j] / 64;
-            gval = buf2g[j] / 64;
-            bval = buf2b[j] / 64;
-            octindex = rtab[rval] | gtab[gval] | btab[bval];
-            octreeFindColorCell(octindex, cqcaa, &index, &rc, &gc, &bc);
-            SET_DATA_BYTE(lined, j, index);
+        else {
+            ditherToCmapLow(datad, w, h, wpld, datas, wpls, bufs1, bufs2,
+                            rtab, gtab, btab, celltab, 0);
         }
-
-        FREE(bufu8r);
-        FREE(bufu8g);
-        FREE(bufu8b);
-        FREE(buf1r);
-        FREE(buf1g);
-        FREE(buf1b);
-        FREE(buf2r);
-        FREE(buf2g);
-        FREE(buf2b);
+        FREE(bufs1);
+        FREE(bufs2);
     }
 
     FREE(rtab);
     FREE(gtab);
     FREE(btab);
+    FREE(celltab);
     return pixd;
 }
 
 
+/*!
+ *  octreeMakeCellTable()
+ *
+ *      Input:  octree in array format
+ *      Return: celltab, or null on error
+ *
+ *  Notes:
+ *      (1) This gives, for each octindex at level CQ_NLEVELS, the result
+ *          of octreeFindColorCell().  The color of the cell is in the
+ *          rgb bytes of each entry, and the colortable index is in
+ *          the low-order byte.
+ */
+static l_uint32 *
+octreeMakeCellTable(CQCELL  ***cqcaa)
+{
+l_int32    i, ncells, index, rval, gval, bval;
+l_uint32   pixel;
+l_uint32  *celltab;
+
+    PROCNAME("octreeMakeCellTable");
+
+    ncells = 1 << (3 * CQ_NLEVELS);
+    if ((celltab = (l_uint32 *)CALLOC(ncells, sizeof(l_uint32))) == NULL)
+        return (l_uint32 *)ERROR_PTR("celltab not made", procName, NULL);
+    for (i = 0; i < ncells; i++) {
+        octreeFindColorCell(i, cqcaa, &index, &rval, &gval, &bval);
+        composeRGBPixel(rval, gval, bval, &pixel);
+        celltab[i] = pixel | (index & 0xff);
+    }
+    return celltab;
+}
+
+
 /*!
  *  octreeFindColorCell()
  *
@@ -1880,9 +1815,13 @@ PIXCMAP        *cmap;
             }
         }
     }
-    else   /* dither */
-        pixDitherOctindexWithCmap(pixs, pixd, rtab, gtab, btab,
-                                  iarray, POP_DIF_CAP);
+    else {  /* dither */
+        if (pixDitherOctindexWithCmap(pixs, pixd, rtab, gtab, btab,
+                                      iarray, POP_DIF_CAP)) {
+            L_ERROR("dithering failed", procName);
+            pixDestroy(&pixd);
+        }
+    }
 
 #if DEBUG_POP
     for (i = 0; i < size / 16; i++) {
@@ -1937,6 +1876,8 @@ array_cleanup:
  *          standard octcube indexing, the rtab (etc) LUTs map directly
  *          to the colormap index, and @indexmap just compensates for
  *          the 1-off indexing assumed to be in that table.
+ *      (4) The colormap and @indexmap are combined into a table of
+ *          cells for ditherToCmapLow(), which does the dithering.
  */
 static l_int32
 pixDitherOctindexWithCmap(PIX       *pixs,
@@ -1947,12 +1888,10 @@ pixDitherOctindexWithCmap(PIX       *pixs,
                           l_int32   *indexmap,
                           l_int32    difcap)
 {
-l_uint8   *bufu8r, *bufu8g, *bufu8b;
-l_int32    i, j, w, h, wpld, octindex, cmapindex;
-l_int32    rval, gval, bval, rc, gc, bc;
-l_int32    dif, val1, val2, val3;
-l_int32   *buf1r, *buf1g, *buf1b, *buf2r, *buf2g, *buf2b;
-l_uint32  *datad, *lined;
+l_int32    i, w, h, wpls, wpld, size, cmapindex;
+l_int32   *rmap, *gmap, *bmap, *bufs1, *bufs2;
+l_uint32   pixel;
+l_uint32  *datas, *datad, *celltab;
 PIXCMAP   *cmap;
 
     PROCNAME("pixDitherOctindexWithCmap");
@@ -1969,147 +1908,41 @@ PIXCMAP   *cmap;
     if (pixGetWidth(pixd) != w || pixGetHeight(pixd) != h)
         return ERROR_INT("pixs and pixd not same size", procName, 1);
 
-    bufu8r = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-    bufu8g = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-    bufu8b = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-    buf1r = (l_int32 *)CALLOC(w, sizeof(l_int32));
-    buf1g = (l_int32 *)CALLOC(w, sizeof(l_int32));
-    buf1b = (l_int32 *)CALLOC(w, sizeof(l_int32));
-    buf2r = (l_int32 *)CALLOC(w, sizeof(l_int32));
-    buf2g = (l_int32 *)CALLOC(w, sizeof(l_int32));
-    buf2b = (l_int32 *)CALLOC(w, sizeof(l_int32));
-    if (!bufu8r || !bufu8g || !bufu8b)
-        return ERROR_INT("uint8 line buf not made", procName, 1);
-    if (!buf1r || !buf1g || !buf1b || !buf2r || !buf2g || !buf2b)
-        return ERROR_INT("mono line buf not made", procName, 1);
-
-        /* Start by priming buf2; line 1 is above line 2 */
-    pixGetRGBLine(pixs, 0, bufu8r, bufu8g, bufu8b);
-    for (j = 0; j < w; j++) {
-        buf2r[j] = 64 * bufu8r[j];
-        buf2g[j] = 64 * bufu8g[j];
-        buf2b[j] = 64 * bufu8b[j];
+        /* Make the table of cells from the colormap.  The largest
+         * octindex has all bits set in each of the three tables. */
+    size = (rtab[255] | gtab[255] | btab[255]) + 1;
+    if ((celltab = (l_uint32 *)CALLOC(size, sizeof(l_uint32))) == NULL)
+        return ERROR_INT("celltab not made", procName, 1);
+    if (pixcmapToArrays(cmap, &rmap, &gmap, &bmap)) {
+        FREE(celltab);
+        return ERROR_INT("colormap arrays not made", procName, 1);
+    }
+    for (i = 0; i < size; i++) {
+        cmapindex = L_MAX(0, indexmap[i] - 1);
+        composeRGBPixel(rmap[cmapindex], gmap[cmapindex], bmap[cmapindex],
+                        &pixel);
+        celltab[i] = pixel | cmapindex;
     }
 
-    datad = pixGetData(pixd);
-    wpld = pixGetWpl(pixd);
-    for (i = 0; i < h - 1; i++) {
-            /* Swap data 2 --> 1, and read in new line 2 */
-        memcpy(buf1r, buf2r, 4 * w);
-        memcpy(buf1g, buf2g, 4 * w);
-        memcpy(buf1b, buf2b, 4 * w);
-        pixGetRGBLine(pixs, i + 1, bufu8r, bufu8g, bufu8b);
-        for (j = 0; j < w; j++) {
-            buf2r[j] = 64 * bufu8r[j];
-            buf2g[j] = 64 * bufu8g[j];
-            buf2b[j] = 64 * bufu8b[j];
-        }
-
-            /* Dither */
-        lined = datad + i * wpld;
-        for (j = 0; j < w - 1; j++) {
-            rval = buf1r[j] / 64;
-            gval = buf1g[j] / 64;
-            bval = buf1b[j] / 64;
-            octindex = rtab[rval] | gtab[gval] | btab[bval];
-            cmapindex = indexmap[octindex] - 1;
-            SET_DATA_BYTE(lined, j, cmapindex);
-            pixcmapGetColor(cmap, cmapindex, &rc, &gc, &bc);
-
-            dif = buf1r[j] / 8 - 8 * rc;
-            if (difcap > 0) {
-                if (dif > difcap) dif = difcap;
-                if (dif < -difcap) dif = -difcap;
-            }
-            if (dif != 0) {
-                val1 = buf1r[j + 1] + 3 * dif;
-                val2 = buf2r[j] + 3 * dif;
-                val3 = buf2r[j + 1] + 2 * dif;
-                if (dif > 0) {
-                    buf1r[j + 1] = L_MIN(16383, val1);
-                    buf2r[j] = L_MIN(16383, val2);
-                    buf2r[j + 1] = L_MIN(16383, val3);
-                }
-                else if (dif < 0) {
-                    buf1r[j + 1] = L_MAX(0, val1);
-                    buf2r[j] = L_MAX(0, val2);
-                    buf2r[j + 1] = L_MAX(0, val3);
-                }
-            }
-
-            dif = buf1g[j] / 8 - 8 * gc;
-            if (difcap > 0) {
-                if (dif > difcap) dif = difcap;
-                if (dif < -difcap) dif = -difcap;
-            }
-            if (dif != 0) {
-                val1 = buf1g[j + 1] + 3 * dif;
-                val2 = buf2g[j] + 3 * dif;
-                val3 = buf2g[j + 1] + 2 * dif;
-                if (dif > 0) {
-                    buf1g[j + 1] = L_MIN(16383, val1);
-                    buf2g[j] = L_MIN(16383, val2);
-                    buf2g[j + 1] = L_MIN(16383, val3);
-                }
-                else if (dif < 0) {
-                    buf1g[j + 1] = L_MAX(0, val1);
-                    buf2g[j] = L_MAX(0, val2);
-                    buf2g[j + 1] = L_MAX(0, val3);
-                }
-            }
-
-            dif = buf1b[j] / 8 - 8 * bc;
-            if (difcap > 0) {
-                if (dif > difcap) dif = difcap;
-                if (dif < -difcap) dif = -difcap;
-            }
-            if (dif != 0) {
-                val1 = buf1b[j + 1] + 3 * dif;
-                val2 = buf2b[j] + 3 * dif;
-                val3 = buf2b[j + 1] + 2 * dif;
-                if (dif > 0) {
-                    buf1b[j + 1] = L_MIN(16383, val1);
-                    buf2b[j] = L_MIN(16383, val2);
-                    buf2b[j + 1] = L_MIN(16383, val3);
-                }
-                else if (dif < 0) {
-                    buf1b[j + 1] = L_MAX(0, val1);
-                    buf2b[j] = L_MAX(0, val2);
-                    buf2b[j + 1] = L_MAX(0, val3);
-                }
-            }
-        }
-
-            /* Get last pixel in row; no downward propagation */
-        rval = buf1r[w - 1] / 64;
-        gval = buf1g[w - 1] / 64;
-        bval = buf1b[w - 1] / 64;
-        octindex = rtab[rval] | gtab[gval] | btab[bval];
-        cmapindex = indexmap[octindex] - 1;
-        SET_DATA_BYTE(lined, w - 1, cmapindex);
-    }
-
-        /* Get last row of pixels; no leftward propagation */
-    lined = datad + (h - 1) * wpld;
-    for (j = 0; j < w; j++) {
-        rval = buf2r[j] / 64;
-        gval = buf2g[j] / 64;
-        bval = buf2b[j] / 64;
-        octindex = rtab[rval] | gtab[gval] | btab[bval];
-        cmapindex = indexmap[octindex] - 1;
-        SET_DATA_BYTE(lined, j, cmapindex);
-    }
-
-    FREE(bufu8r);
-    FREE(bufu8g);
-    FREE(bufu8b);
-    FREE(buf1r);
-    FREE(buf1g);
-    FREE(buf1b);
-    FREE(buf2r);
-    FREE(buf2g);
-    FREE(buf2b);
+    bufs1 = (l_int32 *)CALLOC(3 * w, sizeof(l_int32));
+    bufs2 = (l_int32 *)CALLOC(3 * w, sizeof(l_int32));
+    if (bufs1 && bufs2) {
+        datas = pixGetData(pixs);
+        wpls = pixGetWpl(pixs);
+        datad = pixGetData(pixd);
+        wpld = pixGetWpl(pixd);
+        ditherToCmapLow(datad, w, h, wpld, datas, wpls, bufs1, bufs2,
+                        rtab, gtab, btab, celltab, difcap);
+    }
 
+    FREE(bufs1);
+    FREE(bufs2);
+    FREE(celltab);
+    FREE(rmap);
+    FREE(gmap);
+    FREE(bmap);
+    if (!bufs1 || !bufs2)
+        return ERROR_INT("line bufs not made", procName, 1);
     return 0;
 }
 
@@ -2832,8 +2665,11 @@ PIXCMAP   *cmap;
             btab[i] = i >> 6;
             itab[i] = i + 1;
         }
-        pixDitherOctindexWithCmap(pixs, pixd, rtab, gtab, btab, itab,
-                                  FIXED_DIF_CAP);
+        if (pixDitherOctindexWithCmap(pixs, pixd, rtab, gtab, btab, itab,
+                                      FIXED_DIF_CAP)) {
+            L_ERROR("dithering failed", procName);
+            pixDestroy(&pixd);
+        }
         FREE(rtab);
         FREE(gtab);
         FREE(btab);
@@ -3650,11 +3486,9 @@ pixOctcubeHistogram(PIX      *pixs,
                     l_int32   level,
                     l_int32  *pncolors)
 {
-l_int32     size, i, j, w, h, wpl, ncolors, val;
-l_int32     rval, gval, bval;
-l_uint32    octindex;
+l_int32     size, i, ncolors;
+l_int32    *histo;
 l_uint32   *rtab, *gtab, *btab;
-l_uint32   *data, *line;
 l_float32  *array;
 NUMA       *na;
 
@@ -3666,50 +3500,37 @@ NUMA       *na;
     if (pixGetDepth(pixs) != 32)
         return (NUMA *)ERROR_PTR("pixs not 32 bpp", procName, NULL);
 
-    pixGetDimensions(pixs, &w, &h, NULL);
-    wpl = pixGetWpl(pixs);
-    data = pixGetData(pixs);
-
     if (octcubeGetCount(level, &size))  /* array size = 2 ** (3 * level) */
         return (NUMA *)ERROR_PTR("size not returned", procName, NULL);
     if (makeRGBToIndexTables(&rtab, &gtab, &btab, level))
         return (NUMA *)ERROR_PTR("tables not made", procName, NULL);
 
-    if ((na = numaCreate(size)) == NULL)
+    if ((histo = (l_int32 *)CALLOC(size, sizeof(l_int32))) == NULL) {
+        FREE(rtab);
+        FREE(gtab);
+        FREE(btab);
+        return (NUMA *)ERROR_PTR("histo not made", procName, NULL);
+    }
+    pixRGBIndexHistoAccumulate(pixs, 1, rtab, gtab, btab, size, histo);
+
+    if ((na = numaCreate(size)) == NULL) {
+        FREE(histo);
+        FREE(rtab);
+        FREE(gtab);
+        FREE(btab);
         return (NUMA *)ERROR_PTR("na not made", procName, NULL);
+    }
     numaSetCount(na, size);
     array = numaGetFArray(na, L_NOCOPY);
-
-    for (i = 0; i < h; i++) {
-        line = data + i * wpl;
-        for (j = 0; j < w; j++) {
-            extractRGBValues(line[j], &rval, &gval, &bval);
-            octindex = rtab[rval] | gtab[gval] | btab[bval];
-#if DEBUG_OCTINDEX
-            if ((level == 1 && octindex > 7) ||
-                (level == 2 && octindex > 63) ||
-                (level == 3 && octindex > 511) ||
-                (level == 4 && octindex > 4097) ||
-                (level == 5 && octindex > 32783) ||
-                (level == 6 && octindex > 262271)) {
-                fprintf(stderr, "level = %d, octindex = %d, index error!\n",
-                        level, octindex);
-                continue;
-            }
-#endif  /* DEBUG_OCTINDEX */
-              array[octindex] += 1.0;
-        }
+    for (i = 0, ncolors = 0; i < size; i++) {
+        array[i] = (l_float32)histo[i];
+        if (histo[i] > 0)
+            ncolors++;
     }
-
-    if (pncolors) {
-        for (i = 0, ncolors = 0; i < size; i++) {
-            numaGetIValue(na, i, &val);
-            if (val > 0)
-                ncolors++;
-        }
+    if (pncolors)
         *pncolors = ncolors;
-    }
 
+    FREE(histo);
     FREE(rtab);
     FREE(gtab);
     FREE(btab);
@@ -3998,8 +3819,8 @@ pixNumberOccupiedOctcubes(PIX       *pix,
                           l_int32   *pncolors)
 {
 l_int32    i, j, w, h, d, wpl, ncolors, size, octindex;
-l_int32    rval, gval, bval;
 l_int32   *carray;
+l_uint32   pixel;
 l_uint32  *data, *line, *rtab, *gtab, *btab;
 
     PROCNAME("pixNumberOccupiedOctcubes");
@@ -4034,8 +3855,10 @@ l_uint32  *data, *line, *rtab, *gtab, *btab;
     for (i = 0; i < h; i++) {
         line = data + i * wpl;
         for (j = 0; j < w; j++) {
-            extractRGBValues(line[j], &rval, &gval, &bval);
-            octindex = rtab[rval] | gtab[gval] | btab[bval];
+            pixel = line[j];
+            octindex = rtab[(pixel >> L_RED_SHIFT) & 0xff] |
+                       gtab[(pixel >> L_GREEN_SHIFT) & 0xff] |
+                       btab[(pixel >> L_BLUE_SHIFT) & 0xff];
             carray[octindex]++;
         }
     }
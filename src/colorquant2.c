@@ -46,6 +46,7 @@
  *          static l_int32    medianCutApply()
  *          static PIXCMAP   *pixcmapGenerateFromMedianCuts()
  *          static l_int32    vboxGetAverageColor()
+ *          static l_int32   *histoMakeSumTable()
  *          static l_int32    vboxGetCount()
  *          static l_int32    vboxGetVolume()
  *          static L_BOX3D   *box3dCreate();
@@ -200,7 +201,7 @@ static void getColorIndexMedianCut(l_uint32 pixel, l_int32 rshift,
                                    l_int32 *pindex);
 static L_BOX3D *pixGetColorRegion(PIX *pixs, l_int32 sigbits,
                                   l_int32 subsample);
-static l_int32 medianCutApply(l_int32 *histo, l_int32 sigbits,
+static l_int32 medianCutApply(l_int32 *sumtab, l_int32 sigbits,
                               L_BOX3D *vbox, L_BOX3D **pvbox1,
                               L_BOX3D **pvbox2);
 static PIXCMAP *pixcmapGenerateFromMedianCuts(L_HEAP *lh, l_int32 *histo,
@@ -209,7 +210,8 @@ static l_int32 vboxGetAverageColor(L_BOX3D *vbox, l_int32 *histo,
                                    l_int32 sigbits, l_int32 index,
                                    l_int32  *prval, l_int32 *pgval,
                                    l_int32  *pbval);
-static l_int32 vboxGetCount(L_BOX3D *vbox, l_int32 *histo, l_int32 sigbits);
+static l_int32 *histoMakeSumTable(l_int32 *histo, l_int32 sigbits);
+static l_int32 vboxGetCount(L_BOX3D *vbox, l_int32 *sumtab, l_int32 sigbits);
 static l_int32 vboxGetVolume(L_BOX3D *vbox);
 static L_BOX3D *box3dCreate(l_int32 r1, l_int32 r2, l_int32 g1,
                             l_int32 g2, l_int32 b1, l_int32 b2);
@@ -309,7 +311,7 @@ pixMedianCutQuantGeneral(PIX     *pixs,
 {
 l_int32    i, subsample, histosize, smalln, ncolors, niters, popcolors;
 l_int32    w, h, minside, factor, index, rval, gval, bval;
-l_int32   *histo;
+l_int32   *histo, *sumtab;
 l_float32  pixfract, colorfract;
 L_BOX3D   *vbox, *vbox1, *vbox2;
 L_HEAP    *lh, *lhs;
@@ -394,6 +396,13 @@ PIXCMAP   *cmap;
         return pixd;
     }
 
+        /* The pixel count in any vbox is found from the 3D table of
+         * partial sums of the histo, in constant time. */
+    if ((sumtab = histoMakeSumTable(histo, sigbits)) == NULL) {
+        FREE(histo);
+        return (PIX *)ERROR_PTR("sumtab not made", procName, NULL);
+    }
+
         /* Initial vbox: minimum region in colorspace occupied by pixels */
     if (ditherflag || subsample > 1)  /* use full color space */
         vbox = box3dCreate(0, (1 << sigbits) - 1,
@@ -401,7 +410,7 @@ PIXCMAP   *cmap;
                            0, (1 << sigbits) - 1);
     else
         vbox = pixGetColorRegion(pixs, sigbits, subsample);
-    vbox->npix = vboxGetCount(vbox, histo, sigbits);
+    vbox->npix = vboxGetCount(vbox, sumtab, sigbits);
     vbox->vol = vboxGetVolume(vbox);
 
         /* For a fraction 'popcolors' of the desired 'maxcolors',
@@ -414,11 +423,11 @@ PIXCMAP   *cmap;
     popcolors = (l_int32)(FRACT_BY_POPULATION * maxcolors);
     while (1) {
         vbox = (L_BOX3D *)lheapRemove(lh);
-        if (vboxGetCount(vbox, histo, sigbits) == 0)  { /* just put it back */
+        if (vboxGetCount(vbox, sumtab, sigbits) == 0)  { /* just put it back */
             lheapAdd(lh, vbox);
             continue;
         }
-        medianCutApply(histo, sigbits, vbox, &vbox1, &vbox2);
+        medianCutApply(sumtab, sigbits, vbox, &vbox1, &vbox2);
         if (!vbox1) {
             L_WARNING("vbox1 not defined; shouldn't happen!", procName);
             break;
@@ -454,11 +463,11 @@ PIXCMAP   *cmap;
          * median cuts using the (npix * vol) sorting. */
     while (1) {
         vbox = (L_BOX3D *)lheapRemove(lhs);
-        if (vboxGetCount(vbox, histo, sigbits) == 0)  { /* just put it back */
+        if (vboxGetCount(vbox, sumtab, sigbits) == 0)  { /* just put it back */
             lheapAdd(lhs, vbox);
             continue;
         }
-        medianCutApply(histo, sigbits, vbox, &vbox1, &vbox2);
+        medianCutApply(sumtab, sigbits, vbox, &vbox1, &vbox2);
         if (!vbox1) {
             L_WARNING("vbox1 not defined; shouldn't happen!", procName);
             break;
@@ -490,6 +499,7 @@ PIXCMAP   *cmap;
         lheapAdd(lh, vbox);
     }
     lheapDestroy(&lhs, TRUE);
+    FREE(sumtab);
 
         /* Generate colormap from median cuts and quantize pixd */
     cmap = pixcmapGenerateFromMedianCuts(lh, histo, sigbits);
@@ -506,6 +516,11 @@ PIXCMAP   *cmap;
     }
     pixd = pixQuantizeWithColormap(pixs, ditherflag, outdepth, cmap,
                                    histo, histosize, sigbits);
+    if (!pixd) {  /* cmap was destroyed with it */
+        lheapDestroy(&lh, TRUE);
+        FREE(histo);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
 
         /* Force darkest color to black if each component <= 4 */
     pixcmapGetRankIntensity(cmap, 0.0, &index);
@@ -816,10 +831,9 @@ pixMedianCutHisto(PIX     *pixs,
                   l_int32  sigbits,
                   l_int32  subsample)
 {
-l_int32    i, j, w, h, wpl, rshift, index, histosize;
+l_int32    i, rshift, histosize;
 l_int32   *histo;
-l_uint32   mask, pixel;
-l_uint32  *data, *line;
+l_uint32   rtab[256], gtab[256], btab[256];
 
     PROCNAME("pixMedianCutHisto");
 
@@ -836,19 +850,16 @@ l_uint32  *data, *line;
     if ((histo = (l_int32 *)CALLOC(histosize, sizeof(l_int32))) == NULL)
         return (l_int32 *)ERROR_PTR("histo not made", procName, NULL);
 
+        /* Tables that place the significant bits of each component
+         * as in getColorIndexMedianCut() */
     rshift = 8 - sigbits;
-    mask = 0xff >> rshift;
-    pixGetDimensions(pixs, &w, &h, NULL);
-    data = pixGetData(pixs);
-    wpl = pixGetWpl(pixs);
-    for (i = 0; i < h; i += subsample) {
-        line = data + i * wpl;
-        for (j = 0; j < w; j += subsample) {
-            pixel = line[j];
-	    getColorIndexMedianCut(pixel, rshift, mask, sigbits, &index);
-            histo[index]++;
-        }
+    for (i = 0; i < 256; i++) {
+        rtab[i] = (i >> rshift) << (2 * sigbits);
+        gtab[i] = (i >> rshift) << sigbits;
+        btab[i] = i >> rshift;
     }
+    pixRGBIndexHistoAccumulate(pixs, subsample, rtab, gtab, btab,
+                               histosize, histo);
 
     return histo;
 }
@@ -928,7 +939,9 @@ PIXCMAP  *cmap;
  *      (1) The indexmap is a LUT that takes the rgb indices of the
  *          pixel and returns the index into the colormap.
  *      (2) If ditherflag is 1, @outdepth is ignored and the output
- *          depth is set to 8.
+ *          depth is set to 8.  The dithering is done by ditherToCmapLow(),
+ *          which is shared with the octree quantizers.
+ *      (3) @cmap is given to pixd, and it is destroyed on error.
  */
 static PIX *
 pixQuantizeWithColormap(PIX      *pixs,
@@ -939,12 +952,10 @@ pixQuantizeWithColormap(PIX      *pixs,
                         l_int32   mapsize,
                         l_int32   sigbits)
 {
-l_uint8   *bufu8r, *bufu8g, *bufu8b;
 l_int32    i, j, w, h, wpls, wpld, rshift, index, cmapindex;
-l_int32    rval, gval, bval, rc, gc, bc;
-l_int32    dif, val1, val2, val3;
-l_int32   *buf1r, *buf1g, *buf1b, *buf2r, *buf2g, *buf2b;
-l_uint32  *datas, *datad, *lines, *lined;
+l_int32   *bufs1, *bufs2, *rmap, *gmap, *bmap;
+l_uint32   rtab[256], gtab[256], btab[256];
+l_uint32  *datas, *datad, *lines, *lined, *celltab;
 l_uint32   mask, pixel;
 PIX       *pixd;
 
@@ -960,7 +971,10 @@ PIX       *pixd;
         outdepth = 8;
 
     pixGetDimensions(pixs, &w, &h, NULL);
-    pixd = pixCreate(w, h, outdepth);
+    if ((pixd = pixCreate(w, h, outdepth)) == NULL) {
+        pixcmapDestroy(&cmap);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
     pixSetColormap(pixd, cmap);
     pixCopyResolution(pixd, pixs);
     pixCopyInputFormat(pixd, pixs);
@@ -1011,139 +1025,48 @@ PIX       *pixd;
 	}
     }
     else {  /* ditherflag == 1 */
-        bufu8r = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-        bufu8g = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-        bufu8b = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
-        buf1r = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf1g = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf1b = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf2r = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf2g = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        buf2b = (l_int32 *)CALLOC(w, sizeof(l_int32));
-        if (!bufu8r || !bufu8g || !bufu8b)
-            return (PIX *)ERROR_PTR("uint8 line buf not made", procName, NULL);
-        if (!buf1r || !buf1g || !buf1b || !buf2r || !buf2g || !buf2b)
-            return (PIX *)ERROR_PTR("mono line buf not made", procName, NULL);
-
-            /* Start by priming buf2; line 1 is above line 2 */
-        pixGetRGBLine(pixs, 0, bufu8r, bufu8g, bufu8b);
-        for (j = 0; j < w; j++) {
-            buf2r[j] = 64 * bufu8r[j];
-            buf2g[j] = 64 * bufu8g[j];
-            buf2b[j] = 64 * bufu8b[j];
+            /* Each cell of the dither table holds the colormap color,
+             * followed by its index in the low-order byte */
+        if ((celltab = (l_uint32 *)CALLOC(mapsize, sizeof(l_uint32))) ==
+            NULL) {
+            pixDestroy(&pixd);
+            return (PIX *)ERROR_PTR("celltab not made", procName, NULL);
         }
-
-        for (i = 0; i < h - 1; i++) {
-                /* Swap data 2 --> 1, and read in new line 2 */
-            memcpy(buf1r, buf2r, 4 * w);
-            memcpy(buf1g, buf2g, 4 * w);
-            memcpy(buf1b, buf2b, 4 * w);
-            pixGetRGBLine(pixs, i + 1, bufu8r, bufu8g, bufu8b);
-            for (j = 0; j < w; j++) {
-                buf2r[j] = 64 * bufu8r[j];
-                buf2g[j] = 64 * bufu8g[j];
-                buf2b[j] = 64 * bufu8b[j];
-            }
-
-                /* Dither */
-            lined = datad + i * wpld;
-            for (j = 0; j < w - 1; j++) {
-                rval = buf1r[j] / 64;
-                gval = buf1g[j] / 64;
-                bval = buf1b[j] / 64;
-                index = ((rval >> rshift) << (2 * sigbits)) +
-                        ((gval >> rshift) << sigbits) + (bval >> rshift);
-                cmapindex = indexmap[index];
-                SET_DATA_BYTE(lined, j, cmapindex);
-                pixcmapGetColor(cmap, cmapindex, &rc, &gc, &bc);
-
-                dif = buf1r[j] / 8 - 8 * rc;
-                if (dif > DIF_CAP) dif = DIF_CAP;
-                if (dif < -DIF_CAP) dif = -DIF_CAP;
-                if (dif != 0) {
-                    val1 = buf1r[j + 1] + 3 * dif;
-                    val2 = buf2r[j] + 3 * dif;
-                    val3 = buf2r[j + 1] + 2 * dif;
-                    if (dif > 0) {
-                        buf1r[j + 1] = L_MIN(16383, val1);
-                        buf2r[j] = L_MIN(16383, val2);
-                        buf2r[j + 1] = L_MIN(16383, val3);
-                    }
-                    else if (dif < 0) {
-                        buf1r[j + 1] = L_MAX(0, val1);
-                        buf2r[j] = L_MAX(0, val2);
-                        buf2r[j + 1] = L_MAX(0, val3);
-                    }
-                }
-
-                dif = buf1g[j] / 8 - 8 * gc;
-                if (dif > DIF_CAP) dif = DIF_CAP;
-                if (dif < -DIF_CAP) dif = -DIF_CAP;
-                if (dif != 0) {
-                    val1 = buf1g[j + 1] + 3 * dif;
-                    val2 = buf2g[j] + 3 * dif;
-                    val3 = buf2g[j + 1] + 2 * dif;
-                    if (dif > 0) {
-                        buf1g[j + 1] = L_MIN(16383, val1);
-                        buf2g[j] = L_MIN(16383, val2);
-                        buf2g[j + 1] = L_MIN(16383, val3);
-                    }
-                    else if (dif < 0) {
-                        buf1g[j + 1] = L_MAX(0, val1);
-                        buf2g[j] = L_MAX(0, val2);
-                        buf2g[j + 1] = L_MAX(0, val3);
-                    }
-                }
-
-                dif = buf1b[j] / 8 - 8 * bc;
-                if (dif > DIF_CAP) dif = DIF_CAP;
-                if (dif < -DIF_CAP) dif = -DIF_CAP;
-                if (dif != 0) {
-                    val1 = buf1b[j + 1] + 3 * dif;
-                    val2 = buf2b[j] + 3 * dif;
-                    val3 = buf2b[j + 1] + 2 * dif;
-                    if (dif > 0) {
-                        buf1b[j + 1] = L_MIN(16383, val1);
-                        buf2b[j] = L_MIN(16383, val2);
-                        buf2b[j + 1] = L_MIN(16383, val3);
-                    }
-                    else if (dif < 0) {
-                        buf1b[j + 1] = L_MAX(0, val1);
-                        buf2b[j] = L_MAX(0, val2);
-                        buf2b[j + 1] = L_MAX(0, val3);
-                    }
-                }
-            }
-
-                /* Get last pixel in row; no downward propagation */
-            rval = buf1r[w - 1] / 64;
-            gval = buf1g[w - 1] / 64;
-            bval = buf1b[w - 1] / 64;
-            index = ((rval >> rshift) << (2 * sigbits)) +
-                    ((gval >> rshift) << sigbits) + (bval >> rshift);
-            SET_DATA_BYTE(lined, w - 1, indexmap[index]);
+        if (pixcmapToArrays(cmap, &rmap, &gmap, &bmap)) {
+            FREE(celltab);
+            pixDestroy(&pixd);
+            return (PIX *)ERROR_PTR("colormap arrays not made",
+                                    procName, NULL);
+        }
+        for (i = 0; i < mapsize; i++) {
+            cmapindex = indexmap[i];
+            composeRGBPixel(rmap[cmapindex], gmap[cmapindex], bmap[cmapindex],
+                            &pixel);
+            celltab[i] = pixel | cmapindex;
+        }
+        for (i = 0; i < 256; i++) {
+            rtab[i] = (i >> rshift) << (2 * sigbits);
+            gtab[i] = (i >> rshift) << sigbits;
+            btab[i] = i >> rshift;
         }
 
-            /* Get last row of pixels; no leftward propagation */
-        lined = datad + (h - 1) * wpld;
-        for (j = 0; j < w; j++) {
-            rval = buf2r[j] / 64;
-            gval = buf2g[j] / 64;
-            bval = buf2b[j] / 64;
-            index = ((rval >> rshift) << (2 * sigbits)) +
-                    ((gval >> rshift) << sigbits) + (bval >> rshift);
-            SET_DATA_BYTE(lined, j, indexmap[index]);
+        bufs1 = (l_int32 *)CALLOC(3 * w, sizeof(l_int32));
+        bufs2 = (l_int32 *)CALLOC(3 * w, sizeof(l_int32));
+        if (!bufs1 || !bufs2) {
+            L_ERROR("line bufs not made", procName);
+            pixDestroy(&pixd);
+        }
+        else {
+            ditherToCmapLow(datad, w, h, wpld, datas, wpls, bufs1, bufs2,
+                            rtab, gtab, btab, celltab, DIF_CAP);
         }
 
-        FREE(bufu8r);
-        FREE(bufu8g);
-        FREE(bufu8b);
-        FREE(buf1r);
-        FREE(buf1g);
-        FREE(buf1b);
-        FREE(buf2r);
-        FREE(buf2g);
-        FREE(buf2b);
+        FREE(bufs1);
+        FREE(bufs2);
+        FREE(celltab);
+        FREE(rmap);
+        FREE(gmap);
+        FREE(bmap);
     }
 
     return pixd;
@@ -1245,35 +1168,41 @@ l_uint32  *data, *line;
 /*!
  *  medianCutApply()
  *
- *      Input:  histo  (array; in rgb colorspace)
+ *      Input:  sumtab  (table of partial sums of the rgb histo)
  *              sigbits
  *              vbox (input 3D box)
  *              &vbox1, vbox2 (<return> vbox split in two parts)
  *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) @sumtab is made from the histo by histoMakeSumTable().
+ *          Each partial sum along the splitting axis is the count
+ *          in a slab of the vbox, which takes constant time.
  */
 static l_int32
-medianCutApply(l_int32   *histo,
+medianCutApply(l_int32   *sumtab,
                l_int32    sigbits,
                L_BOX3D   *vbox,
                L_BOX3D  **pvbox1,
                L_BOX3D  **pvbox2)
 {
-l_int32   i, j, k, sum, rw, gw, bw, maxw, index;
+l_int32   i, rw, gw, bw, maxw;
 l_int32   total, left, right;
 l_int32   partialsum[128];
+L_BOX3D   vboxt;
 L_BOX3D  *vbox1, *vbox2;
 
     PROCNAME("medianCutApply");
 
-    if (!histo)
-        return ERROR_INT("histo not defined", procName, 1);
+    if (!sumtab)
+        return ERROR_INT("sumtab not defined", procName, 1);
     if (!vbox)
         return ERROR_INT("vbox not defined", procName, 1);
     if (!pvbox1 || !pvbox2)
         return ERROR_INT("&vbox1 and &vbox2 not both defined", procName, 1);
 
     *pvbox1 = *pvbox2 = NULL;
-    if (vboxGetCount(vbox, histo, sigbits) == 0)
+    if (vboxGetCount(vbox, sumtab, sigbits) == 0)
         return ERROR_INT("no pixels in vbox", procName, 1);
 
         /* If the vbox occupies just one element in color space, it can't
@@ -1301,46 +1230,30 @@ L_BOX3D  *vbox1, *vbox2;
         fprintf(stderr, "blue split\n");
 #endif  /* DEBUG_SPLIT_AXES */
 
-        /* Find the partial sum arrays along the selected axis. */
-    total = 0;
+        /* Find the partial sum arrays along the selected axis.
+         * Each is the count in the part of the vbox up to and
+         * including plane i. */
+    vboxt = *vbox;
     if (maxw == rw) {
         for (i = vbox->r1; i <= vbox->r2; i++) {
-            sum = 0;
-            for (j = vbox->g1; j <= vbox->g2; j++) {
-                for (k = vbox->b1; k <= vbox->b2; k++) {
-                    index = (i << (2 * sigbits)) + (j << sigbits) + k;
-                    sum += histo[index];
-                }
-            }
-            total += sum;
-            partialsum[i] = total;
+            vboxt.r2 = i;
+            partialsum[i] = vboxGetCount(&vboxt, sumtab, sigbits);
         }
+        total = partialsum[vbox->r2];
     }
     else if (maxw == gw) {
         for (i = vbox->g1; i <= vbox->g2; i++) {
-            sum = 0;
-            for (j = vbox->r1; j <= vbox->r2; j++) {
-                for (k = vbox->b1; k <= vbox->b2; k++) {
-                    index = (i << sigbits) + (j << (2 * sigbits)) + k;
-                    sum += histo[index];
-                }
-            }
-            total += sum;
-            partialsum[i] = total;
+            vboxt.g2 = i;
+            partialsum[i] = vboxGetCount(&vboxt, sumtab, sigbits);
         }
+        total = partialsum[vbox->g2];
     }
     else {  /* maxw == bw */
         for (i = vbox->b1; i <= vbox->b2; i++) {
-            sum = 0;
-            for (j = vbox->r1; j <= vbox->r2; j++) {
-                for (k = vbox->g1; k <= vbox->g2; k++) {
-                    index = i + (j << (2 * sigbits)) + (k << sigbits);
-                    sum += histo[index];
-                }
-            }
-            total += sum;
-            partialsum[i] = total;
+            vboxt.b2 = i;
+            partialsum[i] = vboxGetCount(&vboxt, sumtab, sigbits);
         }
+        total = partialsum[vbox->b2];
     }
 
         /* Determine the cut planes, making sure that two vboxes
@@ -1400,8 +1313,8 @@ L_BOX3D  *vbox1, *vbox2;
             }
         }
     }
-    vbox1->npix = vboxGetCount(vbox1, histo, sigbits);
-    vbox2->npix = vboxGetCount(vbox2, histo, sigbits);
+    vbox1->npix = vboxGetCount(vbox1, sumtab, sigbits);
+    vbox2->npix = vboxGetCount(vbox2, sumtab, sigbits);
     vbox1->vol = vboxGetVolume(vbox1);
     vbox2->vol = vboxGetVolume(vbox2);
     *pvbox1 = vbox1;
@@ -1484,7 +1397,8 @@ vboxGetAverageColor(L_BOX3D  *vbox,
                     l_int32  *pgval,
                     l_int32  *pbval)
 {
-l_int32  i, j, k, ntot, mult, histoindex, rsum, gsum, bsum;
+l_int32  i, j, k, ntot, mult, halfmult, histoindex, count;
+l_int32  rsum, gsum, bsum;
 
     PROCNAME("vboxGetAverageColor");
 
@@ -1498,15 +1412,19 @@ l_int32  i, j, k, ntot, mult, histoindex, rsum, gsum, bsum;
     *prval = *pgval = *pbval = 0;
     ntot = 0;
     mult = 1 << (8 - sigbits);
+    halfmult = mult / 2;
     rsum = gsum = bsum = 0;
     for (i = vbox->r1; i <= vbox->r2; i++) {
         for (j = vbox->g1; j <= vbox->g2; j++) {
-            for (k = vbox->b1; k <= vbox->b2; k++) {
-                 histoindex = (i << (2 * sigbits)) + (j << sigbits) + k;
-                 ntot += histo[histoindex];
-                 rsum += (l_int32)(histo[histoindex] * (i + 0.5) * mult);
-                 gsum += (l_int32)(histo[histoindex] * (j + 0.5) * mult);
-                 bsum += (l_int32)(histo[histoindex] * (k + 0.5) * mult);
+            histoindex = (i << (2 * sigbits)) + (j << sigbits) + vbox->b1;
+            for (k = vbox->b1; k <= vbox->b2; k++, histoindex++) {
+                 if ((count = histo[histoindex]) != 0) {
+                         /* count * (i + 0.5) * mult, exactly */
+                     ntot += count;
+                     rsum += count * (2 * i + 1) * halfmult;
+                     gsum += count * (2 * j + 1) * halfmult;
+                     bsum += count * (2 * k + 1) * halfmult;
+                 }
                  if (index >= 0)
                      histo[histoindex] = index;
             }
@@ -1535,39 +1453,93 @@ l_int32  i, j, k, ntot, mult, histoindex, rsum, gsum, bsum;
 }
 
 
+/*!
+ *  histoMakeSumTable()
+ *
+ *      Input:  histo (rgb histo, from pixMedianCutHisto())
+ *              sigbits (valid: 5 or 6)
+ *      Return: sumtab, or null on error
+ *
+ *  Notes:
+ *      (1) With n = 2^sigbits, this is an (n+1) x (n+1) x (n+1) array,
+ *          indexed in the same r, g, b order as the histo.  The element
+ *          at (r, g, b) is the number of pixels in the histo cells with
+ *          red < r, green < g and blue < b.  The planes at r = 0,
+ *          g = 0 and b = 0 are all 0.
+ *      (2) Each element is made from three of its neighbors and the
+ *          running sum of the histo along the blue axis.
+ */
+static l_int32 *
+histoMakeSumTable(l_int32  *histo,
+                  l_int32   sigbits)
+{
+l_int32   i, j, k, n, n1, rowsum, index;
+l_int32  *sumtab, *hline, *st, *stp;
+
+    PROCNAME("histoMakeSumTable");
+
+    if (!histo)
+        return (l_int32 *)ERROR_PTR("histo not defined", procName, NULL);
+
+    n = 1 << sigbits;
+    n1 = n + 1;
+    if ((sumtab = (l_int32 *)CALLOC(n1 * n1 * n1, sizeof(l_int32))) == NULL)
+        return (l_int32 *)ERROR_PTR("sumtab not made", procName, NULL);
+    for (i = 1; i <= n; i++) {
+        for (j = 1; j <= n; j++) {
+            hline = histo + ((i - 1) << (2 * sigbits)) + ((j - 1) << sigbits);
+            index = (i * n1 + j) * n1;
+            st = sumtab + index;  /* at (i, j, 0) */
+            stp = sumtab + index - n1 * n1;  /* at (i - 1, j, 0) */
+            rowsum = 0;
+            for (k = 1; k <= n; k++) {
+                rowsum += hline[k - 1];
+                st[k] = stp[k] + st[k - n1] - stp[k - n1] + rowsum;
+            }
+        }
+    }
+
+    return sumtab;
+}
+
+
 /*!
  *  vboxGetCount()
  *
  *      Input:  vbox (3d region of color space for one quantized color)
- *              histo
+ *              sumtab (from histoMakeSumTable())
  *              sigbits (valid: 5 or 6)
  *      Return: number of image pixels in this region, or 0 on error
+ *
+ *  Notes:
+ *      (1) The count is found by inclusion and exclusion at the
+ *          eight corners of the vbox in the table of partial sums.
  */
 static l_int32
 vboxGetCount(L_BOX3D  *vbox,
-             l_int32  *histo,
+             l_int32  *sumtab,
              l_int32   sigbits)
 {
-l_int32  i, j, k, npix, index;
+l_int32  n1, r1, r2, g1, g2, b1, b2;
 
     PROCNAME("vboxGetCount");
 
     if (!vbox)
         return ERROR_INT("vbox not defined", procName, 0);
-    if (!histo)
-        return ERROR_INT("histo not defined", procName, 0);
-
-    npix = 0;
-    for (i = vbox->r1; i <= vbox->r2; i++) {
-        for (j = vbox->g1; j <= vbox->g2; j++) {
-            for (k = vbox->b1; k <= vbox->b2; k++) {
-                 index = (i << (2 * sigbits)) + (j << sigbits) + k;
-                 npix += histo[index];
-            }
-        }
-    }
-
-    return npix;
+    if (!sumtab)
+        return ERROR_INT("sumtab not defined", procName, 0);
+
+    n1 = (1 << sigbits) + 1;
+    r1 = vbox->r1 * n1 * n1;
+    r2 = (vbox->r2 + 1) * n1 * n1;
+    g1 = vbox->g1 * n1;
+    g2 = (vbox->g2 + 1) * n1;
+    b1 = vbox->b1;
+    b2 = vbox->b2 + 1;
+    return sumtab[r2 + g2 + b2] - sumtab[r1 + g2 + b2] -
+           sumtab[r2 + g1 + b2] - sumtab[r2 + g2 + b1] +
+           sumtab[r1 + g1 + b2] + sumtab[r1 + g2 + b1] +
+           sumtab[r2 + g1 + b1] - sumtab[r1 + g1 + b1];
 }
 
 
@@ -55,12 +55,62 @@
  *           l_int32     convertYUVToRGB()
  *           l_int32     pixcmapConvertRGBToYUV()
  *           l_int32     pixcmapConvertYUVToRGB()
+ *
+ *      Colorspace conversion between RGB and YCbCr
+ *           PIX        *pixConvertRGBToYCbCr()
+ *           PIX        *pixConvertYCbCrToRGB()
+ *           l_int32     convertRGBToYCbCr()
+ *           l_int32     convertYCbCrToRGB()
+ *           l_int32     pixcmapConvertRGBToYCbCr()
+ *           l_int32     pixcmapConvertYCbCrToRGB()
+ *
+ *      Colorspace conversion between RGB and LAB
+ *           PIX        *pixConvertRGBToLAB()
+ *           PIX        *pixConvertLABToRGB()
+ *           l_int32     convertRGBToLAB()
+ *           l_int32     convertLABToRGB()
+ *           l_int32     pixcmapConvertRGBToLAB()
+ *           l_int32     pixcmapConvertLABToRGB()
+ *
+ *      Static integer conversion helpers
+ *           static l_uint32   *makeReciprocalTab()
+ *           static void        convertLineRGBToHSV()
+ *           static void        hsvToRGBFixed()
+ *           static void        rgbToYUVFixed()
+ *           static void        yuvToRGBFixed()
+ *           static l_float32   srgbToLinear()
+ *           static void        linearRGBToLAB()
+ *
+ *  The pix conversions to and from HSV and YUV are done in integer
+ *  arithmetic, and give exactly the same result as the float
+ *  functions convertRGBToHSV(), etc., that are applied to single
+ *  pixels.  The rare pixels whose exact value lies on a rounding
+ *  tie are sent to the float function, so that they are rounded
+ *  the same way.  The HSV range masks convert each pixel as it is
+ *  tested, without making an HSV image.
  */
 
 #include <string.h>
 #include <math.h>
 #include "allheaders.h"
 
+    /* Static integer conversion helpers */
+static l_uint32 *makeReciprocalTab(void);
+static void convertLineRGBToHSV(l_uint32 *lined, l_uint32 *lines,
+                                l_int32 w, l_uint32 *rectab);
+static void hsvToRGBFixed(l_int32 hval, l_int32 sval, l_int32 vval,
+                          l_int32 *prval, l_int32 *pgval, l_int32 *pbval);
+static void rgbToYUVFixed(l_int32 rval, l_int32 gval, l_int32 bval,
+                          l_int32 *pyval, l_int32 *puval, l_int32 *pvval);
+static void yuvToRGBFixed(l_int32 yval, l_int32 uval, l_int32 vval,
+                          l_int32 *prval, l_int32 *pgval, l_int32 *pbval);
+static l_float32 srgbToLinear(l_int32 val);
+static void linearRGBToLAB(l_float32 fr, l_float32 fg, l_float32 fb,
+                           l_int32 *plval, l_int32 *paval, l_int32 *pbval);
+
+    /* Size of the table of reciprocals for the HSV divisions */
+static const l_int32  RECIP_TAB_SIZE = 511;
+
 #ifndef  NO_CONSOLE_IO
 #define  DEBUG_HISTO       1
 #endif  /* ~NO_CONSOLE_IO */
@@ -100,13 +150,16 @@
  *                v = 1
  *                s = 1
  *                h = 1/2 (if r = 0), 5/6 (if g = 0), 1/6 (if b = 0)
+ *      (6) The image is converted in integer arithmetic, using a table
+ *          of reciprocals for the divisions.  The result is identical
+ *          to that of convertRGBToHSV() on each pixel.
  */
 PIX *
 pixConvertRGBToHSV(PIX  *pixd,
                    PIX  *pixs)
 {
-l_int32    w, h, d, wpl, i, j, rval, gval, bval, hval, sval, vval;
-l_uint32  *line, *data;
+l_int32    w, h, d, wpl, i;
+l_uint32  *line, *data, *rectab;
 PIXCMAP   *cmap;
 
     PROCNAME("pixConvertRGBToHSV");
@@ -134,15 +187,17 @@ PIXCMAP   *cmap;
     pixGetDimensions(pixd, &w, &h, NULL);
     wpl = pixGetWpl(pixd);
     data = pixGetData(pixd);
+    if ((rectab = makeReciprocalTab()) == NULL) {
+        if (pixd != pixs)  /* made here */
+            pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("rectab not made", procName, pixd);
+    }
     for (i = 0; i < h; i++) {
         line = data + i * wpl;
-        for (j = 0; j < w; j++) {
-            extractRGBValues(line[j], &rval, &gval, &bval);
-            convertRGBToHSV(rval, gval, bval, &hval, &sval, &vval);
-            line[j] = (hval << 24) | (sval << 16) | (vval << 8);
-        }
+        convertLineRGBToHSV(line, line, w, rectab);
     }
 
+    FREE(rectab);
     return pixd;
 }
 
@@ -162,6 +217,8 @@ PIXCMAP   *cmap;
  *      (3) The h, s and v values are stored in the same places as
  *          the r, g and b values, respectively.  Here, they are explicitly
  *          placed in the 3 MS bytes in the pixel.
+ *      (4) The image is converted in integer arithmetic.  The result
+ *          is identical to that of convertHSVToRGB() on each pixel.
  */
 PIX *
 pixConvertHSVToRGB(PIX  *pixd,
@@ -204,7 +261,7 @@ PIXCMAP   *cmap;
             hval = pixel >> 24;
             sval = (pixel >> 16) & 0xff;
             vval = (pixel >> 8) & 0xff;
-            convertHSVToRGB(hval, sval, vval, &rval, &gval, &bval);
+            hsvToRGBFixed(hval, sval, vval, &rval, &gval, &bval);
             composeRGBPixel(rval, gval, bval, line + j);
         }
     }
@@ -646,6 +703,8 @@ PIX       *pixt, *pixd;
  *          pixels within the rectangular region specified in HS space.
  *          Use @regionflag == L_EXCLUDE_REGION to take all pixels except
  *          those within the rectangular region specified in HS space.
+ *      (3) Each line is converted to HSV as it is tested; no HSV
+ *          image is made.
  */
 PIX *
 pixMakeRangeMaskHS(PIX     *pixs,
@@ -655,11 +714,11 @@ pixMakeRangeMaskHS(PIX     *pixs,
                    l_int32  sathw,
                    l_int32  regionflag)
 {
-l_int32    i, j, w, h, wplt, wpld, hstart, hend, sstart, send, hval, sval;
+l_int32    i, j, w, h, wpls, wpld, hstart, hend, sstart, send, hval, sval;
 l_int32   *hlut, *slut;
 l_uint32   pixel;
-l_uint32  *datat, *datad, *linet, *lined;
-PIX       *pixt, *pixd;
+l_uint32  *datas, *datad, *lines, *lined, *linet, *rectab;
+PIX       *pixd;
 
     PROCNAME("pixMakeRangeMaskHS");
 
@@ -689,21 +748,31 @@ PIX       *pixt, *pixd;
             hlut[i] = 1;
     }
 
-        /* Generate the mask */
-    pixt = pixConvertRGBToHSV(NULL, pixs);
+        /* Generate the mask, converting each line to HSV */
     pixGetDimensions(pixs, &w, &h, NULL);
     pixd = pixCreateNoInit(w, h, 1);
     if (regionflag == L_INCLUDE_REGION)
         pixClearAll(pixd);
     else  /* L_EXCLUDE_REGION */
         pixSetAll(pixd);
-    datat = pixGetData(pixt);
+    datas = pixGetData(pixs);
     datad = pixGetData(pixd);
-    wplt = pixGetWpl(pixt);
+    wpls = pixGetWpl(pixs);
     wpld = pixGetWpl(pixd);
+    rectab = makeReciprocalTab();
+    linet = (l_uint32 *)CALLOC(w, sizeof(l_uint32));
+    if (!rectab || !linet) {
+        FREE(hlut);
+        FREE(slut);
+        FREE(rectab);
+        FREE(linet);
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("rectab or linet not made", procName, NULL);
+    }
     for (i = 0; i < h; i++) {
-        linet = datat + i * wplt;
+        lines = datas + i * wpls;
         lined = datad + i * wpld;
+        convertLineRGBToHSV(linet, lines, w, rectab);
         for (j = 0; j < w; j++) {
             pixel = linet[j];
             hval = (pixel >> L_RED_SHIFT) & 0xff;
@@ -719,7 +788,8 @@ PIX       *pixt, *pixd;
 
     FREE(hlut);
     FREE(slut);
-    pixDestroy(&pixt);
+    FREE(rectab);
+    FREE(linet);
     return pixd;
 }
 
@@ -744,6 +814,8 @@ PIX       *pixt, *pixd;
  *          pixels within the rectangular region specified in HV space.
  *          Use @regionflag == L_EXCLUDE_REGION to take all pixels except
  *          those within the rectangular region specified in HV space.
+ *      (3) Each line is converted to HSV as it is tested; no HSV
+ *          image is made.
  */
 PIX *
 pixMakeRangeMaskHV(PIX     *pixs,
@@ -753,11 +825,11 @@ pixMakeRangeMaskHV(PIX     *pixs,
                    l_int32  valhw,
                    l_int32  regionflag)
 {
-l_int32    i, j, w, h, wplt, wpld, hstart, hend, vstart, vend, hval, vval;
+l_int32    i, j, w, h, wpls, wpld, hstart, hend, vstart, vend, hval, vval;
 l_int32   *hlut, *vlut;
 l_uint32   pixel;
-l_uint32  *datat, *datad, *linet, *lined;
-PIX       *pixt, *pixd;
+l_uint32  *datas, *datad, *lines, *lined, *linet, *rectab;
+PIX       *pixd;
 
     PROCNAME("pixMakeRangeMaskHV");
 
@@ -787,21 +859,31 @@ PIX       *pixt, *pixd;
             hlut[i] = 1;
     }
 
-        /* Generate the mask */
-    pixt = pixConvertRGBToHSV(NULL, pixs);
+        /* Generate the mask, converting each line to HSV */
     pixGetDimensions(pixs, &w, &h, NULL);
     pixd = pixCreateNoInit(w, h, 1);
     if (regionflag == L_INCLUDE_REGION)
         pixClearAll(pixd);
     else  /* L_EXCLUDE_REGION */
         pixSetAll(pixd);
-    datat = pixGetData(pixt);
+    datas = pixGetData(pixs);
     datad = pixGetData(pixd);
-    wplt = pixGetWpl(pixt);
+    wpls = pixGetWpl(pixs);
     wpld = pixGetWpl(pixd);
+    rectab = makeReciprocalTab();
+    linet = (l_uint32 *)CALLOC(w, sizeof(l_uint32));
+    if (!rectab || !linet) {
+        FREE(hlut);
+        FREE(vlut);
+        FREE(rectab);
+        FREE(linet);
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("rectab or linet not made", procName, NULL);
+    }
     for (i = 0; i < h; i++) {
-        linet = datat + i * wplt;
+        lines = datas + i * wpls;
         lined = datad + i * wpld;
+        convertLineRGBToHSV(linet, lines, w, rectab);
         for (j = 0; j < w; j++) {
             pixel = linet[j];
             hval = (pixel >> L_RED_SHIFT) & 0xff;
@@ -817,7 +899,8 @@ PIX       *pixt, *pixd;
 
     FREE(hlut);
     FREE(vlut);
-    pixDestroy(&pixt);
+    FREE(rectab);
+    FREE(linet);
     return pixd;
 }
 
@@ -841,6 +924,8 @@ PIX       *pixt, *pixd;
  *          pixels within the rectangular region specified in SV space.
  *          Use @regionflag == L_EXCLUDE_REGION to take all pixels except
  *          those within the rectangular region specified in SV space.
+ *      (3) The HSV values of each pixel are found as it is tested;
+ *          no HSV image is made.
  */
 PIX *
 pixMakeRangeMaskSV(PIX     *pixs,
@@ -850,11 +935,12 @@ pixMakeRangeMaskSV(PIX     *pixs,
                    l_int32  valhw,
                    l_int32  regionflag)
 {
-l_int32    i, j, w, h, wplt, wpld, sval, vval, sstart, send, vstart, vend;
+l_int32    i, j, w, h, wpls, wpld, sval, vval, sstart, send, vstart, vend;
+l_int32    rval, gval, bval, minrg, maxrg, min, delta;
 l_int32   *slut, *vlut;
 l_uint32   pixel;
-l_uint32  *datat, *datad, *linet, *lined;
-PIX       *pixt, *pixd;
+l_uint32  *datas, *datad, *lines, *lined, *rectab;
+PIX       *pixd;
 
     PROCNAME("pixMakeRangeMaskSV");
 
@@ -877,25 +963,43 @@ PIX       *pixt, *pixd;
     for (i = vstart; i <= vend; i++)
         vlut[i] = 1;
 
-        /* Generate the mask */
-    pixt = pixConvertRGBToHSV(NULL, pixs);
+        /* Generate the mask.  The hue is not needed, and the
+         * saturation in integer arithmetic is exact (see
+         * convertLineRGBToHSV()), so it is found here directly. */
     pixGetDimensions(pixs, &w, &h, NULL);
     pixd = pixCreateNoInit(w, h, 1);
     if (regionflag == L_INCLUDE_REGION)
         pixClearAll(pixd);
     else  /* L_EXCLUDE_REGION */
         pixSetAll(pixd);
-    datat = pixGetData(pixt);
+    datas = pixGetData(pixs);
     datad = pixGetData(pixd);
-    wplt = pixGetWpl(pixt);
+    wpls = pixGetWpl(pixs);
     wpld = pixGetWpl(pixd);
+    if ((rectab = makeReciprocalTab()) == NULL) {
+        FREE(slut);
+        FREE(vlut);
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("rectab not made", procName, NULL);
+    }
     for (i = 0; i < h; i++) {
-        linet = datat + i * wplt;
+        lines = datas + i * wpls;
         lined = datad + i * wpld;
         for (j = 0; j < w; j++) {
-            pixel = linet[j];
-            sval = (pixel >> L_GREEN_SHIFT) & 0xff;
-            vval = (pixel >> L_BLUE_SHIFT) & 0xff;
+            pixel = lines[j];
+            rval = (pixel >> L_RED_SHIFT) & 0xff;
+            gval = (pixel >> L_GREEN_SHIFT) & 0xff;
+            bval = (pixel >> L_BLUE_SHIFT) & 0xff;
+            minrg = L_MIN(rval, gval);
+            min = L_MIN(minrg, bval);
+            maxrg = L_MAX(rval, gval);
+            vval = L_MAX(maxrg, bval);
+            delta = vval - min;
+            if (delta == 0)
+                sval = 0;
+            else
+                sval = (l_int32)(((l_uint64)(510 * delta + vval) *
+                                  rectab[2 * vval]) >> 32);
             if (slut[sval] == 1 && vlut[vval] == 1) {
                 if (regionflag == L_INCLUDE_REGION)
                     SET_DATA_BIT(lined, j);
@@ -907,7 +1011,7 @@ PIX       *pixt, *pixd;
 
     FREE(slut);
     FREE(vlut);
-    pixDestroy(&pixt);
+    FREE(rectab);
     return pixd;
 }
 
@@ -1382,12 +1486,15 @@ PIX     *pixt, *pixd;
  *      (5) For the coefficients in the transform matrices, see eq. 4 in
  *          "Frequently Asked Questions about Color" by Charles Poynton,
  *          http://www.poynton.com/notes/colour_and_gamma/ColorFAQ.html
+ *      (6) The image is converted in integer arithmetic.  The result
+ *          is identical to that of convertRGBToYUV() on each pixel.
  */
 PIX *
 pixConvertRGBToYUV(PIX  *pixd,
                    PIX  *pixs)
 {
 l_int32    w, h, d, wpl, i, j, rval, gval, bval, yval, uval, vval;
+l_uint32   pixel;
 l_uint32  *line, *data;
 PIXCMAP   *cmap;
 
@@ -1419,8 +1526,11 @@ PIXCMAP   *cmap;
     for (i = 0; i < h; i++) {
         line = data + i * wpl;
         for (j = 0; j < w; j++) {
-            extractRGBValues(line[j], &rval, &gval, &bval);
-            convertRGBToYUV(rval, gval, bval, &yval, &uval, &vval);
+            pixel = line[j];
+            rval = (pixel >> L_RED_SHIFT) & 0xff;
+            gval = (pixel >> L_GREEN_SHIFT) & 0xff;
+            bval = (pixel >> L_BLUE_SHIFT) & 0xff;
+            rgbToYUVFixed(rval, gval, bval, &yval, &uval, &vval);
             line[j] = (yval << 24) | (uval << 16) | (vval << 8);
         }
     }
@@ -1443,6 +1553,8 @@ PIXCMAP   *cmap;
  *      (3) The Y, U and V values are stored in the same places as
  *          the r, g and b values, respectively.  Here, they are explicitly
  *          placed in the 3 MS bytes in the pixel.
+ *      (4) The image is converted in integer arithmetic.  The result
+ *          is identical to that of convertYUVToRGB() on each pixel.
  */
 PIX *
 pixConvertYUVToRGB(PIX  *pixd,
@@ -1485,7 +1597,7 @@ PIXCMAP   *cmap;
             yval = pixel >> 24;
             uval = (pixel >> 16) & 0xff;
             vval = (pixel >> 8) & 0xff;
-            convertYUVToRGB(yval, uval, vval, &rval, &gval, &bval);
+            yuvToRGBFixed(yval, uval, vval, &rval, &gval, &bval);
             composeRGBPixel(rval, gval, bval, line + j);
         }
     }
@@ -1642,3 +1754,921 @@ l_int32   i, ncolors, rval, gval, bval, yval, uval, vval;
     }
     return 0;
 }
+
+
+/*---------------------------------------------------------------------------*
+ *               Colorspace conversion between RGB and YCbCr                 *
+ *---------------------------------------------------------------------------*/
+/*!
+ *  pixConvertRGBToYCbCr()
+ *
+ *      Input:  pixd (can be NULL; if not NULL, must == pixs)
+ *              pixs
+ *      Return: pixd always
+ *
+ *  Notes:
+ *      (1) For pixs = pixd, this is in-place; otherwise pixd must be NULL.
+ *      (2) The Y, Cb and Cr values are stored in the same places as
+ *          the r, g and b values, respectively.  Here, they are explicitly
+ *          placed in the 3 MS bytes in the pixel.
+ *      (3) This is the full range YCbCr of JFIF (jpeg), where all
+ *          three components are in [0 ... 255].  It differs from YUV,
+ *          which uses the reduced range of video.
+ *      (4) The definition of our YCbCr space, in 16 bit fixed point,
+ *          is given in convertRGBToYCbCr().
+ */
+PIX *
+pixConvertRGBToYCbCr(PIX  *pixd,
+                     PIX  *pixs)
+{
+l_int32    w, h, d, wpl, i, j, rval, gval, bval, yval, cbval, crval;
+l_uint32  *line, *data;
+PIXCMAP   *cmap;
+
+    PROCNAME("pixConvertRGBToYCbCr");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (pixd && pixd != pixs)
+        return (PIX *)ERROR_PTR("pixd defined and not inplace", procName, pixd);
+
+    d = pixGetDepth(pixs);
+    cmap = pixGetColormap(pixs);
+    if (!cmap && d != 32)
+        return (PIX *)ERROR_PTR("not cmapped or rgb", procName, pixd);
+
+    if (!pixd)
+        pixd = pixCopy(NULL, pixs);
+
+    cmap = pixGetColormap(pixd);
+    if (cmap) {   /* just convert the colormap */
+        pixcmapConvertRGBToYCbCr(cmap);
+        return pixd;
+    }
+
+        /* Convert RGB image */
+    pixGetDimensions(pixd, &w, &h, NULL);
+    wpl = pixGetWpl(pixd);
+    data = pixGetData(pixd);
+    for (i = 0; i < h; i++) {
+        line = data + i * wpl;
+        for (j = 0; j < w; j++) {
+            extractRGBValues(line[j], &rval, &gval, &bval);
+            convertRGBToYCbCr(rval, gval, bval, &yval, &cbval, &crval);
+            line[j] = (yval << 24) | (cbval << 16) | (crval << 8);
+        }
+    }
+
+    return pixd;
+}
+
+
+/*!
+ *  pixConvertYCbCrToRGB()
+ *
+ *      Input:  pixd (can be NULL; if not NULL, must == pixs)
+ *              pixs
+ *      Return: pixd always
+ *
+ *  Notes:
+ *      (1) For pixs = pixd, this is in-place; otherwise pixd must be NULL.
+ *      (2) The user takes responsibility for making sure that pixs is
+ *          in YCbCr space.
+ *      (3) The Y, Cb and Cr values are stored in the same places as
+ *          the r, g and b values, respectively.  Here, they are explicitly
+ *          placed in the 3 MS bytes in the pixel.
+ */
+PIX *
+pixConvertYCbCrToRGB(PIX  *pixd,
+                     PIX  *pixs)
+{
+l_int32    w, h, d, wpl, i, j, rval, gval, bval, yval, cbval, crval;
+l_uint32   pixel;
+l_uint32  *line, *data;
+PIXCMAP   *cmap;
+
+    PROCNAME("pixConvertYCbCrToRGB");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (pixd && pixd != pixs)
+        return (PIX *)ERROR_PTR("pixd defined and not inplace", procName, pixd);
+
+    d = pixGetDepth(pixs);
+    cmap = pixGetColormap(pixs);
+    if (!cmap && d != 32)
+        return (PIX *)ERROR_PTR("not cmapped or ycbcr", procName, pixd);
+
+    if (!pixd)
+        pixd = pixCopy(NULL, pixs);
+
+    cmap = pixGetColormap(pixd);
+    if (cmap) {   /* just convert the colormap */
+        pixcmapConvertYCbCrToRGB(cmap);
+        return pixd;
+    }
+
+        /* Convert YCbCr image */
+    pixGetDimensions(pixd, &w, &h, NULL);
+    wpl = pixGetWpl(pixd);
+    data = pixGetData(pixd);
+    for (i = 0; i < h; i++) {
+        line = data + i * wpl;
+        for (j = 0; j < w; j++) {
+            pixel = line[j];
+            yval = pixel >> 24;
+            cbval = (pixel >> 16) & 0xff;
+            crval = (pixel >> 8) & 0xff;
+            convertYCbCrToRGB(yval, cbval, crval, &rval, &gval, &bval);
+            composeRGBPixel(rval, gval, bval, line + j);
+        }
+    }
+
+    return pixd;
+}
+
+
+/*!
+ *  convertRGBToYCbCr()
+ *
+ *      Input:  rval, gval, bval (RGB input)
+ *              &yval, &cbval, &crval (<return> YCbCr values)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The range of returned values is [0 ... 255] for all three.
+ *      (2) This uses the ITU-R BT.601 coefficients of JFIF:
+ *            Y  =  0.29900 * R + 0.58700 * G + 0.11400 * B
+ *            Cb = -0.16874 * R - 0.33126 * G + 0.50000 * B + 128
+ *            Cr =  0.50000 * R - 0.41869 * G - 0.08131 * B + 128
+ *          in 16 bit fixed point, as in the ijg jpeg library.  The
+ *          chroma components are rounded with one less than 1/2,
+ *          so that they cannot exceed 255.
+ */
+l_int32
+convertRGBToYCbCr(l_int32   rval,
+                  l_int32   gval,
+                  l_int32   bval,
+                  l_int32  *pyval,
+                  l_int32  *pcbval,
+                  l_int32  *pcrval)
+{
+    PROCNAME("convertRGBToYCbCr");
+
+    if (!pyval || !pcbval || !pcrval)
+        return ERROR_INT("&yval, &cbval, &crval not all defined", procName, 1);
+
+    *pyval = (19595 * rval + 38470 * gval + 7471 * bval + 32768) >> 16;
+    *pcbval = (-11059 * rval - 21709 * gval + 32768 * bval +
+               (128 << 16) + 32767) >> 16;
+    *pcrval = (32768 * rval - 27439 * gval - 5329 * bval +
+               (128 << 16) + 32767) >> 16;
+    return 0;
+}
+
+
+/*!
+ *  convertYCbCrToRGB()
+ *
+ *      Input:  yval, cbval, crval
+ *              &rval, &gval, &bval (<return> RGB values)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This is the inverse of convertRGBToYCbCr(), in 16 bit fixed
+ *          point.  Conversion of RGB --> YCbCr --> RGB changes each
+ *          component by at most 1.
+ *      (2) Some YCbCr values are outside the RGB gamut.  We clip
+ *          individual r,g,b components to the range [0, 255].
+ *      (3) The chroma terms are offset by 256 before the shift, so that
+ *          the shift is always of a non-negative number.
+ */
+l_int32
+convertYCbCrToRGB(l_int32   yval,
+                  l_int32   cbval,
+                  l_int32   crval,
+                  l_int32  *prval,
+                  l_int32  *pgval,
+                  l_int32  *pbval)
+{
+l_int32  rval, gval, bval, cbm, crm;
+
+    PROCNAME("convertYCbCrToRGB");
+
+    if (!prval || !pgval || !pbval)
+        return ERROR_INT("&rval, &gval, &bval not all defined", procName, 1);
+
+    cbm = cbval - 128;
+    crm = crval - 128;
+    rval = yval - 256 + ((91881 * crm + 32768 + (256 << 16)) >> 16);
+    gval = yval - 256 +
+           ((-22554 * cbm - 46802 * crm + 32768 + (256 << 16)) >> 16);
+    bval = yval - 256 + ((116130 * cbm + 32768 + (256 << 16)) >> 16);
+    *prval = L_MIN(255, L_MAX(0, rval));
+    *pgval = L_MIN(255, L_MAX(0, gval));
+    *pbval = L_MIN(255, L_MAX(0, bval));
+    return 0;
+}
+
+
+/*!
+ *  pixcmapConvertRGBToYCbCr()
+ *
+ *      Input:  colormap
+ *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      - in-place transform
+ *      - See convertRGBToYCbCr() for def'n of YCbCr space.
+ *      - replaces: r --> y, g --> cb, b --> cr
+ */
+l_int32
+pixcmapConvertRGBToYCbCr(PIXCMAP  *cmap)
+{
+l_int32   i, ncolors, rval, gval, bval, yval, cbval, crval;
+
+    PROCNAME("pixcmapConvertRGBToYCbCr");
+
+    if (!cmap)
+        return ERROR_INT("cmap not defined", procName, 1);
+
+    ncolors = pixcmapGetCount(cmap);
+    for (i = 0; i < ncolors; i++) {
+        pixcmapGetColor(cmap, i, &rval, &gval, &bval);
+        convertRGBToYCbCr(rval, gval, bval, &yval, &cbval, &crval);
+        pixcmapResetColor(cmap, i, yval, cbval, crval);
+    }
+    return 0;
+}
+
+
+/*!
+ *  pixcmapConvertYCbCrToRGB()
+ *
+ *      Input:  colormap
+ *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      - in-place transform
+ *      - See convertRGBToYCbCr() for def'n of YCbCr space.
+ *      - replaces: y --> r, cb --> g, cr --> b
+ */
+l_int32
+pixcmapConvertYCbCrToRGB(PIXCMAP  *cmap)
+{
+l_int32   i, ncolors, rval, gval, bval, yval, cbval, crval;
+
+    PROCNAME("pixcmapConvertYCbCrToRGB");
+
+    if (!cmap)
+        return ERROR_INT("cmap not defined", procName, 1);
+
+    ncolors = pixcmapGetCount(cmap);
+    for (i = 0; i < ncolors; i++) {
+        pixcmapGetColor(cmap, i, &yval, &cbval, &crval);
+        convertYCbCrToRGB(yval, cbval, crval, &rval, &gval, &bval);
+        pixcmapResetColor(cmap, i, rval, gval, bval);
+    }
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------------*
+ *                Colorspace conversion between RGB and LAB                  *
+ *---------------------------------------------------------------------------*/
+/*!
+ *  pixConvertRGBToLAB()
+ *
+ *      Input:  pixd (can be NULL; if not NULL, must == pixs)
+ *              pixs
+ *      Return: pixd always
+ *
+ *  Notes:
+ *      (1) For pixs = pixd, this is in-place; otherwise pixd must be NULL.
+ *      (2) The L, a and b values are stored in the same places as
+ *          the r, g and b values, respectively.  Here, they are explicitly
+ *          placed in the 3 MS bytes in the pixel.
+ *      (3) The definition of our 8 bit LAB space is given in
+ *          convertRGBToLAB().
+ *      (4) The linear rgb value of each component is taken from a
+ *          table that is made once.  The result is identical to that
+ *          of convertRGBToLAB() on each pixel.
+ */
+PIX *
+pixConvertRGBToLAB(PIX  *pixd,
+                   PIX  *pixs)
+{
+l_int32     w, h, d, wpl, i, j, rval, gval, bval, lval, aval, bbval;
+l_uint32   *line, *data;
+l_float32  *lintab;
+PIXCMAP    *cmap;
+
+    PROCNAME("pixConvertRGBToLAB");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (pixd && pixd != pixs)
+        return (PIX *)ERROR_PTR("pixd defined and not inplace", procName, pixd);
+
+    d = pixGetDepth(pixs);
+    cmap = pixGetColormap(pixs);
+    if (!cmap && d != 32)
+        return (PIX *)ERROR_PTR("not cmapped or rgb", procName, pixd);
+
+    if (!pixd)
+        pixd = pixCopy(NULL, pixs);
+
+    cmap = pixGetColormap(pixd);
+    if (cmap) {   /* just convert the colormap */
+        pixcmapConvertRGBToLAB(cmap);
+        return pixd;
+    }
+
+        /* Convert RGB image */
+    if ((lintab = (l_float32 *)CALLOC(256, sizeof(l_float32))) == NULL)
+        return (PIX *)ERROR_PTR("lintab not made", procName, pixd);
+    for (i = 0; i < 256; i++)
+        lintab[i] = srgbToLinear(i);
+    pixGetDimensions(pixd, &w, &h, NULL);
+    wpl = pixGetWpl(pixd);
+    data = pixGetData(pixd);
+    for (i = 0; i < h; i++) {
+        line = data + i * wpl;
+        for (j = 0; j < w; j++) {
+            extractRGBValues(line[j], &rval, &gval, &bval);
+            linearRGBToLAB(lintab[rval], lintab[gval], lintab[bval],
+                           &lval, &aval, &bbval);
+            line[j] = (lval << 24) | (aval << 16) | (bbval << 8);
+        }
+    }
+
+    FREE(lintab);
+    return pixd;
+}
+
+
+/*!
+ *  pixConvertLABToRGB()
+ *
+ *      Input:  pixd (can be NULL; if not NULL, must == pixs)
+ *              pixs
+ *      Return: pixd always
+ *
+ *  Notes:
+ *      (1) For pixs = pixd, this is in-place; otherwise pixd must be NULL.
+ *      (2) The user takes responsibility for making sure that pixs is
+ *          in our 8 bit LAB space.
+ *      (3) The L, a and b values are stored in the same places as
+ *          the r, g and b values, respectively.  Here, they are explicitly
+ *          placed in the 3 MS bytes in the pixel.
+ */
+PIX *
+pixConvertLABToRGB(PIX  *pixd,
+                   PIX  *pixs)
+{
+l_int32    w, h, d, wpl, i, j, rval, gval, bval, lval, aval, bbval;
+l_uint32   pixel;
+l_uint32  *line, *data;
+PIXCMAP   *cmap;
+
+    PROCNAME("pixConvertLABToRGB");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (pixd && pixd != pixs)
+        return (PIX *)ERROR_PTR("pixd defined and not inplace", procName, pixd);
+
+    d = pixGetDepth(pixs);
+    cmap = pixGetColormap(pixs);
+    if (!cmap && d != 32)
+        return (PIX *)ERROR_PTR("not cmapped or lab", procName, pixd);
+
+    if (!pixd)
+        pixd = pixCopy(NULL, pixs);
+
+    cmap = pixGetColormap(pixd);
+    if (cmap) {   /* just convert the colormap */
+        pixcmapConvertLABToRGB(cmap);
+        return pixd;
+    }
+
+        /* Convert LAB image */
+    pixGetDimensions(pixd, &w, &h, NULL);
+    wpl = pixGetWpl(pixd);
+    data = pixGetData(pixd);
+    for (i = 0; i < h; i++) {
+        line = data + i * wpl;
+        for (j = 0; j < w; j++) {
+            pixel = line[j];
+            lval = pixel >> 24;
+            aval = (pixel >> 16) & 0xff;
+            bbval = (pixel >> 8) & 0xff;
+            convertLABToRGB(lval, aval, bbval, &rval, &gval, &bval);
+            composeRGBPixel(rval, gval, bval, line + j);
+        }
+    }
+
+    return pixd;
+}
+
+
+/*!
+ *  convertRGBToLAB()
+ *
+ *      Input:  rval, gval, bval (RGB input)
+ *              &lval, &aval, &bval (<return> LAB values)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The input is taken to be sRGB, and is referred to the D65
+ *          white point.  The CIE L*a*b* values are stored in 8 bits as:
+ *            L:  L* * 255 / 100, in [0 ... 255]
+ *            a:  a* + 128, clipped to [0 ... 255]
+ *            b:  b* + 128, clipped to [0 ... 255]
+ *      (2) Neutral colors have a = b = 128.
+ */
+l_int32
+convertRGBToLAB(l_int32   rval,
+                l_int32   gval,
+                l_int32   bval,
+                l_int32  *plval,
+                l_int32  *paval,
+                l_int32  *pbval)
+{
+    PROCNAME("convertRGBToLAB");
+
+    if (!plval || !paval || !pbval)
+        return ERROR_INT("&lval, &aval, &bval not all defined", procName, 1);
+
+    linearRGBToLAB(srgbToLinear(rval), srgbToLinear(gval),
+                   srgbToLinear(bval), plval, paval, pbval);
+    return 0;
+}
+
+
+/*!
+ *  convertLABToRGB()
+ *
+ *      Input:  lval, aval, bval (in our 8 bit LAB space)
+ *              &rval, &gval, &bval (<return> RGB values)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) See convertRGBToLAB() for the definition of the 8 bit LAB
+ *          space.  Because of the quantization of L, a and b, the
+ *          round trip RGB --> LAB --> RGB is not exact.
+ *      (2) The LAB gamut is larger than the RGB gamut.  We clip
+ *          individual r,g,b components to the range [0, 255].
+ */
+l_int32
+convertLABToRGB(l_int32   lval,
+                l_int32   aval,
+                l_int32   bval,
+                l_int32  *prval,
+                l_int32  *pgval,
+                l_int32  *pbval)
+{
+l_int32    i;
+l_int32    val[3];
+l_float32  fl, fx, fy, fz, xval, yval, zval;
+l_float32  lin[3];
+
+    PROCNAME("convertLABToRGB");
+
+    if (!prval || !pgval || !pbval)
+        return ERROR_INT("&rval, &gval, &bval not all defined", procName, 1);
+
+        /* Invert the cube root nonlinearity, to get XYZ */
+    fl = (l_float32)lval * 100.0 / 255.0;
+    fy = (fl + 16.0) / 116.0;
+    fx = fy + (l_float32)(aval - 128) / 500.0;
+    fz = fy - (l_float32)(bval - 128) / 200.0;
+    xval = (fx > 0.206893) ? fx * fx * fx : (fx - 16.0 / 116.0) / 7.787;
+    yval = (fy > 0.206893) ? fy * fy * fy : (fy - 16.0 / 116.0) / 7.787;
+    zval = (fz > 0.206893) ? fz * fz * fz : (fz - 16.0 / 116.0) / 7.787;
+    xval *= 0.95047;
+    zval *= 1.08883;
+
+        /* Linear sRGB, and then the sRGB gamma */
+    lin[0] = 3.2406 * xval - 1.5372 * yval - 0.4986 * zval;
+    lin[1] = -0.9689 * xval + 1.8758 * yval + 0.0415 * zval;
+    lin[2] = 0.0557 * xval - 0.2040 * yval + 1.0570 * zval;
+    for (i = 0; i < 3; i++) {
+        lin[i] = L_MIN(1.0, L_MAX(0.0, lin[i]));
+        if (lin[i] <= 0.0031308)
+            lin[i] *= 12.92;
+        else
+            lin[i] = 1.055 * pow(lin[i], 1.0 / 2.4) - 0.055;
+        val[i] = (l_int32)(255.0 * lin[i] + 0.5);
+    }
+    *prval = L_MIN(255, val[0]);
+    *pgval = L_MIN(255, val[1]);
+    *pbval = L_MIN(255, val[2]);
+    return 0;
+}
+
+
+/*!
+ *  pixcmapConvertRGBToLAB()
+ *
+ *      Input:  colormap
+ *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      - in-place transform
+ *      - See convertRGBToLAB() for def'n of LAB space.
+ *      - replaces: r --> l, g --> a, b --> b
+ */
+l_int32
+pixcmapConvertRGBToLAB(PIXCMAP  *cmap)
+{
+l_int32   i, ncolors, rval, gval, bval, lval, aval, bbval;
+
+    PROCNAME("pixcmapConvertRGBToLAB");
+
+    if (!cmap)
+        return ERROR_INT("cmap not defined", procName, 1);
+
+    ncolors = pixcmapGetCount(cmap);
+    for (i = 0; i < ncolors; i++) {
+        pixcmapGetColor(cmap, i, &rval, &gval, &bval);
+        convertRGBToLAB(rval, gval, bval, &lval, &aval, &bbval);
+        pixcmapResetColor(cmap, i, lval, aval, bbval);
+    }
+    return 0;
+}
+
+
+/*!
+ *  pixcmapConvertLABToRGB()
+ *
+ *      Input:  colormap
+ *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      - in-place transform
+ *      - See convertRGBToLAB() for def'n of LAB space.
+ *      - replaces: l --> r, a --> g, b --> b
+ */
+l_int32
+pixcmapConvertLABToRGB(PIXCMAP  *cmap)
+{
+l_int32   i, ncolors, rval, gval, bval, lval, aval, bbval;
+
+    PROCNAME("pixcmapConvertLABToRGB");
+
+    if (!cmap)
+        return ERROR_INT("cmap not defined", procName, 1);
+
+    ncolors = pixcmapGetCount(cmap);
+    for (i = 0; i < ncolors; i++) {
+        pixcmapGetColor(cmap, i, &lval, &aval, &bbval);
+        convertLABToRGB(lval, aval, bbval, &rval, &gval, &bval);
+        pixcmapResetColor(cmap, i, rval, gval, bval);
+    }
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------------*
+ *                    Static integer conversion helpers                      *
+ *---------------------------------------------------------------------------*/
+/*!
+ *  makeReciprocalTab()
+ *
+ *      Return: table of RECIP_TAB_SIZE reciprocals, or null on error
+ *
+ *  Notes:
+ *      (1) For 2 <= d < RECIP_TAB_SIZE, tab[d] = 2^32 / d + 1, so that
+ *            x / d = (x * tab[d]) >> 32
+ *          exactly, for all 0 <= x < 2^17.
+ *      (2) Entries 0 and 1 are 0.  Entry 0 is used for gray pixels
+ *          in convertLineRGBToHSV(), and gives 0.
+ */
+static l_uint32 *
+makeReciprocalTab(void)
+{
+l_int32    d;
+l_uint32  *tab;
+
+    PROCNAME("makeReciprocalTab");
+
+    if ((tab = (l_uint32 *)CALLOC(RECIP_TAB_SIZE, sizeof(l_uint32))) == NULL)
+        return (l_uint32 *)ERROR_PTR("tab not made", procName, NULL);
+    for (d = 2; d < RECIP_TAB_SIZE; d++)
+        tab[d] = (l_uint32)(((l_uint64)1 << 32) / d + 1);
+    return tab;
+}
+
+
+/*!
+ *  convertLineRGBToHSV()
+ *
+ *      Input:  lined (line of HSV pixels; can be the same as lines)
+ *              lines (line of rgb pixels)
+ *              w (number of pixels)
+ *              rectab (from makeReciprocalTab())
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This is convertRGBToHSV() in integer arithmetic, with the
+ *          divisions done by multiplying by a reciprocal.  With
+ *          delta = max - min, the hue is (num / delta) and the
+ *          saturation is (255 * delta / max), each rounded.
+ *      (2) Unless it is exactly on a rounding tie, each rational value
+ *          is at least 1/510 from the nearest rounding boundary.  That
+ *          is far more than the error of the float computation, so the
+ *          rounded results are the same.  At a hue tie, the float
+ *          function is called to round it the same way.  There are no
+ *          ties in the saturation, which is computed in double.
+ *      (3) Gray pixels are not treated separately, to avoid a poorly
+ *          predicted branch.  With delta = 0, entry 0 of the table
+ *          gives h = s = 0 for them.
+ *      (4) The h, s and v values are placed in the 3 MS bytes, as
+ *          in pixConvertRGBToHSV().
+ */
+static void
+convertLineRGBToHSV(l_uint32  *lined,
+                    l_uint32  *lines,
+                    l_int32    w,
+                    l_uint32  *rectab)
+{
+l_int32   j, rval, gval, bval, minrg, maxrg, min, max, delta, num, x, q;
+l_int32   hval, sval, vval;
+l_uint32  pixel;
+
+    for (j = 0; j < w; j++) {
+        pixel = lines[j];
+        rval = (pixel >> L_RED_SHIFT) & 0xff;
+        gval = (pixel >> L_GREEN_SHIFT) & 0xff;
+        bval = (pixel >> L_BLUE_SHIFT) & 0xff;
+        minrg = L_MIN(rval, gval);
+        min = L_MIN(minrg, bval);
+        maxrg = L_MAX(rval, gval);
+        max = L_MAX(maxrg, bval);
+        delta = max - min;
+
+        if (rval == max)  /* between magenta and yellow */
+            num = 40 * (gval - bval);
+        else if (gval == max)  /* between yellow and cyan */
+            num = 80 * delta + 40 * (bval - rval);
+        else  /* between cyan and magenta */
+            num = 160 * delta + 40 * (rval - gval);
+        if (num < 0)
+            num += 240 * delta;
+
+            /* Round (num / delta) */
+        x = 2 * num + delta;
+        q = (l_int32)(((l_uint64)x * rectab[2 * delta]) >> 32);
+        if (q * 2 * delta == x && delta > 0) {  /* tie */
+            convertRGBToHSV(rval, gval, bval, &hval, &sval, &vval);
+        }
+        else {
+            hval = (q >= 240) ? 0 : q;
+            sval = (l_int32)(((l_uint64)(510 * delta + max) *
+                              rectab[2 * max]) >> 32);
+            vval = max;
+        }
+        lined[j] = (hval << 24) | (sval << 16) | (vval << 8);
+    }
+    return;
+}
+
+
+/*!
+ *  hsvToRGBFixed()
+ *
+ *      Input:  hval, sval, vval
+ *              &rval, &gval, &bval (<return> RGB values)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This is convertHSVToRGB() in integer arithmetic.  With
+ *          f = hval mod 40, the three values that are not vval are the
+ *          rounded values of
+ *              vval * (255 - sval) / 255
+ *              vval * (10200 - sval * f) / 10200
+ *              vval * (10200 - sval * (40 - f)) / 10200
+ *      (2) As in convertLineRGBToHSV(), the float function is called for
+ *          rounding ties, and for invalid hval, where it reports
+ *          the error.  sval and vval must be in [0 ... 255].
+ */
+static void
+hsvToRGBFixed(l_int32   hval,
+              l_int32   sval,
+              l_int32   vval,
+              l_int32  *prval,
+              l_int32  *pgval,
+              l_int32  *pbval)
+{
+l_int32  i, f, n1, n2, n3, x, y, z;
+
+    if (sval == 0) {  /* gray */
+        *prval = vval;
+        *pgval = vval;
+        *pbval = vval;
+        return;
+    }
+    if (hval < 0 || hval > 240) {
+        convertHSVToRGB(hval, sval, vval, prval, pgval, pbval);
+        return;
+    }
+    if (hval == 240)
+        hval = 0;
+
+    i = hval / 40;
+    f = hval - 40 * i;
+    n1 = 2 * vval * (255 - sval) + 255;
+    n2 = 2 * vval * (10200 - sval * f) + 10200;
+    n3 = 2 * vval * (10200 - sval * (40 - f)) + 10200;
+    x = n1 / 510;
+    y = n2 / 20400;
+    z = n3 / 20400;
+    if (x * 510 == n1 || y * 20400 == n2 || z * 20400 == n3) {  /* tie */
+        convertHSVToRGB(hval, sval, vval, prval, pgval, pbval);
+        return;
+    }
+
+    switch (i)
+    {
+    case 0:
+        *prval = vval;
+        *pgval = z;
+        *pbval = x;
+        break;
+    case 1:
+        *prval = y;
+        *pgval = vval;
+        *pbval = x;
+        break;
+    case 2:
+        *prval = x;
+        *pgval = vval;
+        *pbval = z;
+        break;
+    case 3:
+        *prval = x;
+        *pgval = y;
+        *pbval = vval;
+        break;
+    case 4:
+        *prval = z;
+        *pgval = x;
+        *pbval = vval;
+        break;
+    default:  /* 5 */
+        *prval = vval;
+        *pgval = x;
+        *pbval = y;
+        break;
+    }
+    return;
+}
+
+
+/*!
+ *  rgbToYUVFixed()
+ *
+ *      Input:  rval, gval, bval (RGB input)
+ *              &yval, &uval, &vval (<return> YUV values)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This is convertRGBToYUV() in integer arithmetic.  The
+ *          coefficients there have three decimals, so each sum below
+ *          is 256000 times the float value, plus 1/2 for rounding.
+ *      (2) A sum that is not on a rounding tie is at least 1/256000
+ *          from a rounding boundary, which is far more than the
+ *          float error.  For ties, the float function is called.
+ */
+static void
+rgbToYUVFixed(l_int32   rval,
+              l_int32   gval,
+              l_int32   bval,
+              l_int32  *pyval,
+              l_int32  *puval,
+              l_int32  *pvval)
+{
+l_int32  ny, nu, nv, yval, uval, vval;
+
+    ny = 65738 * rval + 129057 * gval + 25064 * bval + 16 * 256000 + 128000;
+    nu = -37945 * rval - 74494 * gval + 112439 * bval + 128 * 256000 + 128000;
+    nv = 112439 * rval - 94154 * gval - 18285 * bval + 128 * 256000 + 128000;
+    yval = ny / 256000;
+    uval = nu / 256000;
+    vval = nv / 256000;
+    if (yval * 256000 == ny || uval * 256000 == nu || vval * 256000 == nv) {
+        convertRGBToYUV(rval, gval, bval, pyval, puval, pvval);
+        return;
+    }
+    *pyval = yval;
+    *puval = uval;
+    *pvval = vval;
+    return;
+}
+
+
+/*!
+ *  yuvToRGBFixed()
+ *
+ *      Input:  yval, uval, vval
+ *              &rval, &gval, &bval (<return> RGB values)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This is convertYUVToRGB() in integer arithmetic; see
+ *          rgbToYUVFixed().  Negative sums clip to 0, whichever way
+ *          they are rounded, so only non-negative ties go to the
+ *          float function.
+ */
+static void
+yuvToRGBFixed(l_int32   yval,
+              l_int32   uval,
+              l_int32   vval,
+              l_int32  *prval,
+              l_int32  *pgval,
+              l_int32  *pbval)
+{
+l_int32  ym, um, vm, nr, ng, nb, rval, gval, bval;
+
+    ym = yval - 16;
+    um = uval - 128;
+    vm = vval - 128;
+    nr = 298082 * ym + 408583 * vm + 128000;
+    ng = 298082 * ym - 100291 * um - 208120 * vm + 128000;
+    nb = 298082 * ym + 516411 * um + 128000;
+    rval = (nr < 0) ? -1 : nr / 256000;
+    gval = (ng < 0) ? -1 : ng / 256000;
+    bval = (nb < 0) ? -1 : nb / 256000;
+    if ((rval >= 0 && rval * 256000 == nr) ||
+        (gval >= 0 && gval * 256000 == ng) ||
+        (bval >= 0 && bval * 256000 == nb)) {
+        convertYUVToRGB(yval, uval, vval, prval, pgval, pbval);
+        return;
+    }
+    *prval = L_MIN(255, L_MAX(0, rval));
+    *pgval = L_MIN(255, L_MAX(0, gval));
+    *pbval = L_MIN(255, L_MAX(0, bval));
+    return;
+}
+
+
+/*!
+ *  srgbToLinear()
+ *
+ *      Input:  val (sRGB component, in [0 ... 255])
+ *      Return: linear value, in [0.0 ... 1.0]
+ */
+static l_float32
+srgbToLinear(l_int32  val)
+{
+l_float32  fval;
+
+    fval = (l_float32)val / 255.0;
+    if (fval <= 0.04045)
+        return fval / 12.92;
+    return (l_float32)pow((fval + 0.055) / 1.055, 2.4);
+}
+
+
+/*!
+ *  linearRGBToLAB()
+ *
+ *      Input:  fr, fg, fb (linear rgb, in [0.0 ... 1.0])
+ *              &lval, &aval, &bval (<return> 8 bit LAB values)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) See convertRGBToLAB() for the 8 bit LAB space.
+ */
+static void
+linearRGBToLAB(l_float32  fr,
+               l_float32  fg,
+               l_float32  fb,
+               l_int32   *plval,
+               l_int32   *paval,
+               l_int32   *pbval)
+{
+l_int32    i;
+l_float32  fl, fa, fbb;
+l_float32  t[3];
+
+        /* XYZ, normalized to the D65 white point */
+    t[0] = (0.4124 * fr + 0.3576 * fg + 0.1805 * fb) / 0.95047;
+    t[1] = 0.2126 * fr + 0.7152 * fg + 0.0722 * fb;
+    t[2] = (0.0193 * fr + 0.1192 * fg + 0.9505 * fb) / 1.08883;
+    for (i = 0; i < 3; i++) {
+        if (t[i] > 0.008856)
+            t[i] = (l_float32)pow(t[i], 1.0 / 3.0);
+        else
+            t[i] = 7.787 * t[i] + 16.0 / 116.0;
+    }
+
+    fl = 2.55 * (116.0 * t[1] - 16.0) + 0.5;
+    fa = 500.0 * (t[0] - t[1]) + 128.5;
+    fbb = 200.0 * (t[1] - t[2]) + 128.5;
+    *plval = (l_int32)L_MIN(255.0, L_MAX(0.0, fl));
+    *paval = (l_int32)L_MIN(255.0, L_MAX(0.0, fa));
+    *pbval = (l_int32)L_MIN(255.0, L_MAX(0.0, fbb));
+    return;
+}
@@ -50,10 +50,14 @@
  *          PIX      *pixWindowedMeanSquare()
  *          l_int32   pixWindowedVariance()
  *          DPIX     *pixMeanSquareAccum()
+ *          static PIX   *windowedMeanFromIntegral()
+ *          static PIX   *windowedMeanSquareFromIntegral()
  *
  *      Binary block sum and rank filter
  *          PIX      *pixBlockrank()
  *          PIX      *pixBlocksum()
+ *          PIX      *pixBlockrankIntegral()
+ *          PIX      *pixBlocksumIntegral()
  *
  *      Census transform
  *          PIX      *pixCensusTransform()
@@ -68,8 +72,21 @@
  *          FPIX     *fpixConvolve()
  *          FPIX     *fpixConvolveSep()
  *
+ *      Recursive gaussian convolution (time independent of sigma)
+ *          PIX      *pixRecursiveGaussian()
+ *          FPIX     *fpixRecursiveGaussian()
+ *
  *      Set parameter for convolution subsampling
  *          void      l_setConvolveSampling()
+ *
+ *      Set parameter for convolution with the FFT
+ *          void      l_setConvolveFFT()
+ *
+ *      Static helpers
+ *          static l_int32  convolveFFTIsFaster()
+ *          static l_int32  pixConvolveSepLines()
+ *          static l_int32  pixConvolveIntLines()
+ *          static l_int32 *convolveGetLine()
  */
 
 #include <math.h>
@@ -81,6 +98,30 @@
 LEPT_DLL l_int32  ConvolveSamplingFactX = 1;
 LEPT_DLL l_int32  ConvolveSamplingFactY = 1;
 
+    /* This global determines if fpixConvolve() can use the FFT when
+     * it is faster than direct convolution.  To change the value,
+     * use l_setConvolveFFT(). */
+LEPT_DLL l_int32  ConvolveUseFFT = 1;
+
+    /* Relative cost, per pixel and per factor of 2 in image size, of
+     * FFT convolution compared to one multiply-add of direct convolution */
+static const l_float32  FFT_COST_FACTOR = 5.0;
+
+static PIX *windowedMeanFromIntegral(L_INTEGRAL *intg, l_int32 wc,
+                                     l_int32 hc, l_int32 normflag);
+static PIX *windowedMeanSquareFromIntegral(L_INTEGRAL *intg, l_int32 wc,
+                                           l_int32 hc);
+static l_int32 convolveFFTIsFaster(l_int32 w, l_int32 h, l_int32 sx,
+                                   l_int32 sy);
+static l_int32 pixConvolveSepLines(PIX *pixt, PIX *pixd, L_KERNEL *kel,
+                                   l_float32 normfact, l_int32 **lines,
+                                   l_int32 *tags);
+static l_int32 pixConvolveIntLines(PIX *pixt, PIX *pixd, L_KERNEL *keli,
+                                   l_int32 normsum, l_int32 **lines,
+                                   l_int32 *tags);
+static l_int32 *convolveGetLine(PIX *pixt, l_int32 i, l_int32 **lines,
+                                l_int32 *tags, l_int32 nlines);
+
 /*----------------------------------------------------------------------*
  *             Top-level grayscale or color block convolution           *
  *----------------------------------------------------------------------*/
@@ -657,6 +698,8 @@ PIX       *pixt, *pixd;
  *          allows computation without special treatment of pixels near
  *          the image boundary, and runs in a time that is independent
  *          of the size of the convolution kernel.
+ *      (6) The sums and sums of squares for all outputs are taken from
+ *          a single integral image; see integral.c.
  */
 l_int32
 pixWindowedStats(PIX     *pixs,
@@ -668,7 +711,9 @@ pixWindowedStats(PIX     *pixs,
                  FPIX   **pfpixv,
                  FPIX   **pfpixrv)
 {
-PIX  *pixb, *pixm, *pixms;
+l_int32      sqflag;
+L_INTEGRAL  *intg;
+PIX         *pixb, *pixm, *pixms;
 
     PROCNAME("pixWindowedStats");
 
@@ -689,16 +734,20 @@ PIX  *pixb, *pixm, *pixms;
     else
         pixb = pixClone(pixs);
 
-    if (!pfpixv && !pfpixrv) {
-        if (ppixm) *ppixm = pixWindowedMean(pixb, wc, hc, 1, 1);
-        if (ppixms) *ppixms = pixWindowedMeanSquare(pixb, wc, hc, 1);
+        /* A single integral image is used for all outputs */
+    sqflag = (ppixms || pfpixv || pfpixrv) ? 1 : 0;
+    if ((intg = integralCreate(pixb, sqflag)) == NULL) {
         pixDestroy(&pixb);
-        return 0;
+        return ERROR_INT("intg not made", procName, 1);
     }
-
-    pixm = pixWindowedMean(pixb, wc, hc, 1, 1);
-    pixms = pixWindowedMeanSquare(pixb, wc, hc, 1);
-    pixWindowedVariance(pixm, pixms, pfpixv, pfpixrv);
+    pixm = pixms = NULL;
+    if (ppixm || pfpixv || pfpixrv)
+        pixm = windowedMeanFromIntegral(intg, wc, hc, 1);
+    if (sqflag)
+        pixms = windowedMeanSquareFromIntegral(intg, wc, hc);
+    integralDestroy(&intg);
+    if (pfpixv || pfpixrv)
+        pixWindowedVariance(pixm, pixms, pfpixv, pfpixrv);
     if (ppixm)
         *ppixm = pixm;
     else
@@ -734,8 +783,7 @@ PIX  *pixb, *pixm, *pixms;
  *      (3) Typically, @normflag == 1.  However, if you want the sum
  *          within the window, rather than a normalized convolution,
  *          use @normflag == 0.
- *      (4) This builds a block accumulator pix, uses it here, and
- *          destroys it.
+ *      (4) This builds an integral image, uses it here, and destroys it.
  *      (5) The added border, along with the use of an accumulator array,
  *          allows computation without special treatment of pixels near
  *          the image boundary, and runs in a time that is independent
@@ -748,11 +796,9 @@ pixWindowedMean(PIX     *pixs,
                 l_int32  hasborder,
                 l_int32  normflag)
 {
-l_int32    i, j, w, h, d, wd, hd, wplc, wpld, wincr, hincr;
-l_uint32   val;
-l_uint32  *datac, *datad, *linec1, *linec2, *lined;
-l_float32  norm;
-PIX       *pixb, *pixc, *pixd;
+l_int32      d;
+L_INTEGRAL  *intg;
+PIX         *pixb, *pixd;
 
     PROCNAME("pixWindowedMean");
 
@@ -770,49 +816,12 @@ PIX       *pixb, *pixc, *pixd;
     else
         pixb = pixClone(pixs);
 
-        /* The output has wc + 1 border pixels stripped from each side
-         * of pixb, and hc + 1 border pixels stripped from top and bottom. */
-    pixGetDimensions(pixb, &w, &h, NULL);
-    wd = w - 2 * (wc + 1);
-    hd = h - 2 * (hc + 1);
-    if (wd < 2 || hd < 2)
-        return (PIX *)ERROR_PTR("w or h too small for kernel", procName, NULL);
-    if ((pixd = pixCreate(wd, hd, d)) == NULL)
-        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
-
-        /* Make the accumulator pix from pixb */
-    if ((pixc = pixBlockconvAccum(pixb)) == NULL) {
+    if ((intg = integralCreate(pixb, 0)) == NULL) {
         pixDestroy(&pixb);
-        pixDestroy(&pixd);
-        return (PIX *)ERROR_PTR("pixc not made", procName, NULL);
-    }
-    wplc = pixGetWpl(pixc);
-    wpld = pixGetWpl(pixd);
-    datad = pixGetData(pixd);
-    datac = pixGetData(pixc);
-
-    wincr = 2 * wc + 1;
-    hincr = 2 * hc + 1;
-    norm = 1.0;  /* use this for sum-in-window */
-    if (normflag)
-        norm = 1.0 / (wincr * hincr);
-    for (i = 0; i < hd; i++) {
-        linec1 = datac + i * wplc;
-        linec2 = datac + (i + hincr) * wplc;
-        lined = datad + i * wpld;
-        for (j = 0; j < wd; j++) {
-            val = linec2[j + wincr] - linec2[j] - linec1[j + wincr] + linec1[j];
-            if (d == 8) {
-                val = (l_uint8)(norm * val);
-                SET_DATA_BYTE(lined, j, val);
-            } else {  /* d == 32 */
-                val = (l_uint32)(norm * val);
-                lined[j] = val;
-            }
-        }
+        return (PIX *)ERROR_PTR("intg not made", procName, NULL);
     }
-
-    pixDestroy(&pixc);
+    pixd = windowedMeanFromIntegral(intg, wc, hc, normflag);
+    integralDestroy(&intg);
     pixDestroy(&pixb);
     return pixd;
 }
@@ -842,9 +851,11 @@ PIX       *pixb, *pixc, *pixd;
  *          kernel is entirely contained in pixs.
  *      (3) Why do we have an added border of width (@wc + 1) and
  *          height (@hc + 1), when we only need @wc and @hc pixels
- *          to satisfy this condition?  Answer: the accumulators
- *          are asymmetric, requiring an extra row and column of
- *          pixels at top and left to work accurately.
+ *          to satisfy this condition?  Answer: the original 32 bpp
+ *          accumulators were asymmetric, requiring an extra row and
+ *          column of pixels at top and left to work accurately.
+ *          The integral image does not need them, but the border
+ *          size is kept for compatibility.
  *      (4) The added border, along with the use of an accumulator array,
  *          allows computation without special treatment of pixels near
  *          the image boundary, and runs in a time that is independent
@@ -856,14 +867,8 @@ pixWindowedMeanSquare(PIX     *pixs,
                       l_int32  hc,
                       l_int32  hasborder)
 {
-l_int32     i, j, w, h, wd, hd, wpl, wpld, wincr, hincr;
-l_uint32    ival;
-l_uint32   *datad, *lined;
-l_float64   norm;
-l_float64   val;
-l_float64  *data, *line1, *line2;
-DPIX       *dpix;
-PIX        *pixb, *pixd;
+L_INTEGRAL  *intg;
+PIX         *pixb, *pixd;
 
     PROCNAME("pixWindowedMeanSquare");
 
@@ -878,41 +883,12 @@ PIX        *pixb, *pixd;
     else
         pixb = pixClone(pixs);
 
-    if ((dpix = pixMeanSquareAccum(pixb)) == NULL)
-        return (PIX *)ERROR_PTR("dpix not made", procName, NULL);
-    wpl = dpixGetWpl(dpix);
-    data = dpixGetData(dpix);
-
-        /* The output has wc + 1 border pixels stripped from each side
-         * of pixb, and hc + 1 border pixels stripped from top and bottom. */
-    pixGetDimensions(pixb, &w, &h, NULL);
-    wd = w - 2 * (wc + 1);
-    hd = h - 2 * (hc + 1);
-    if (wd < 2 || hd < 2)
-        return (PIX *)ERROR_PTR("w or h too small for kernel", procName, NULL);
-    if ((pixd = pixCreate(wd, hd, 32)) == NULL) {
-        dpixDestroy(&dpix);
+    if ((intg = integralCreate(pixb, 1)) == NULL) {
         pixDestroy(&pixb);
-        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
-    }
-    wpld = pixGetWpl(pixd);
-    datad = pixGetData(pixd);
-
-    wincr = 2 * wc + 1;
-    hincr = 2 * hc + 1;
-    norm = 1.0 / (wincr * hincr);
-    for (i = 0; i < hd; i++) {
-        line1 = data + i * wpl;
-        line2 = data + (i + hincr) * wpl;
-        lined = datad + i * wpld;
-        for (j = 0; j < wd; j++) {
-            val = line2[j + wincr] - line2[j] - line1[j + wincr] + line1[j];
-            ival = (l_uint32)(norm * val);
-            lined[j] = ival;
-        }
+        return (PIX *)ERROR_PTR("intg not made", procName, NULL);
     }
-
-    dpixDestroy(&dpix);
+    pixd = windowedMeanSquareFromIntegral(intg, wc, hc);
+    integralDestroy(&intg);
     pixDestroy(&pixb);
     return pixd;
 }
@@ -1026,6 +1002,8 @@ FPIX       *fpixv, *fpixrv;  /* variance and square root of variance */
  *            a(i,j) = v(i,j) + a(i, j-1)
  *          For the first column, the special case is
  *            a(i,j) = v(i,j) + a(i-1, j)
+ *      (3) integralCreate() makes both this and the mean accumulator
+ *          in a single pass, with exact 64-bit integer sums.
  */
 DPIX *
 pixMeanSquareAccum(PIX  *pixs)
@@ -1077,6 +1055,138 @@ DPIX       *dpix;
 }
 
 
+/*!
+ *  windowedMeanFromIntegral()
+ *
+ *      Input:  intg (integral image of a pix that has a border of
+ *                    (wc + 1) pixels on left and right, and (hc + 1)
+ *                    pixels on top and bottom)
+ *              wc, hc   (half width/height of convolution kernel)
+ *              normflag (1 for average in window; 0 for the sum)
+ *      Return: pixd (8 or 32 bpp, with the border removed), or null
+ *              on error
+ *
+ *  Notes:
+ *      (1) Helper for pixWindowedStats() and pixWindowedMean().
+ *          The window for pixd(j, i) covers src columns
+ *          (j + 1 ... j + 2 * wc + 1) and lines (i + 1 ... i + 2 * hc + 1).
+ */
+static PIX *
+windowedMeanFromIntegral(L_INTEGRAL  *intg,
+                         l_int32      wc,
+                         l_int32      hc,
+                         l_int32      normflag)
+{
+l_int32    i, j, w, h, d, wd, hd, wpl, wpld, wincr, hincr;
+l_uint32   val;
+l_uint32  *datad, *lined;
+l_uint64  *data, *line1, *line2;
+l_float32  norm;
+l_float64  dnorm;
+PIX       *pixd;
+
+    PROCNAME("windowedMeanFromIntegral");
+
+        /* The output has wc + 1 border pixels stripped from each side
+         * of the src, and hc + 1 border pixels stripped from top and
+         * bottom. */
+    integralGetDimensions(intg, &w, &h, &d);
+    wd = w - 2 * (wc + 1);
+    hd = h - 2 * (hc + 1);
+    if (wd < 2 || hd < 2)
+        return (PIX *)ERROR_PTR("w or h too small for kernel", procName, NULL);
+    if ((pixd = pixCreate(wd, hd, d)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    wpld = pixGetWpl(pixd);
+    datad = pixGetData(pixd);
+    wpl = integralGetWpl(intg);
+    data = integralGetSumData(intg);
+
+    wincr = 2 * wc + 1;
+    hincr = 2 * hc + 1;
+    norm = 1.0;  /* use this for sum-in-window */
+    if (normflag)
+        norm = 1.0 / (wincr * hincr);
+    dnorm = norm;
+    for (i = 0; i < hd; i++) {
+        line1 = data + (i + 1) * wpl + 1;
+        line2 = line1 + hincr * wpl;
+        lined = datad + i * wpld;
+        if (d == 8) {
+            for (j = 0; j < wd; j++) {
+                val = (l_uint32)(line2[j + wincr] - line2[j] -
+                                 line1[j + wincr] + line1[j]);
+                val = (l_uint8)(norm * val);
+                SET_DATA_BYTE(lined, j, val);
+            }
+        }
+        else {  /* d == 32 */
+            for (j = 0; j < wd; j++)
+                lined[j] = (l_uint32)(dnorm * (l_float64)(line2[j + wincr] -
+                                 line2[j] - line1[j + wincr] + line1[j]));
+        }
+    }
+
+    return pixd;
+}
+
+
+/*!
+ *  windowedMeanSquareFromIntegral()
+ *
+ *      Input:  intg (integral image, with sums of squares, of an 8 bpp
+ *                    pix that has a border of (wc + 1) pixels on left
+ *                    and right, and (hc + 1) pixels on top and bottom)
+ *              wc, hc   (half width/height of convolution kernel)
+ *      Return: pixd (32 bpp, with the border removed), or null on error
+ *
+ *  Notes:
+ *      (1) Helper for pixWindowedStats() and pixWindowedMeanSquare().
+ */
+static PIX *
+windowedMeanSquareFromIntegral(L_INTEGRAL  *intg,
+                               l_int32      wc,
+                               l_int32      hc)
+{
+l_int32    i, j, w, h, wd, hd, wpl, wpld, wincr, hincr;
+l_uint32  *datad, *lined;
+l_uint64  *data, *line1, *line2;
+l_float64  norm, val;
+PIX       *pixd;
+
+    PROCNAME("windowedMeanSquareFromIntegral");
+
+    integralGetDimensions(intg, &w, &h, NULL);
+    wd = w - 2 * (wc + 1);
+    hd = h - 2 * (hc + 1);
+    if (wd < 2 || hd < 2)
+        return (PIX *)ERROR_PTR("w or h too small for kernel", procName, NULL);
+    if ((data = integralGetSumSqData(intg)) == NULL)
+        return (PIX *)ERROR_PTR("no sums of squares", procName, NULL);
+    if ((pixd = pixCreate(wd, hd, 32)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    wpld = pixGetWpl(pixd);
+    datad = pixGetData(pixd);
+    wpl = integralGetWpl(intg);
+
+    wincr = 2 * wc + 1;
+    hincr = 2 * hc + 1;
+    norm = 1.0 / (wincr * hincr);
+    for (i = 0; i < hd; i++) {
+        line1 = data + (i + 1) * wpl + 1;
+        line2 = line1 + hincr * wpl;
+        lined = datad + i * wpld;
+        for (j = 0; j < wd; j++) {
+            val = (l_float64)(line2[j + wincr] - line2[j] -
+                              line1[j + wincr] + line1[j]);
+            lined[j] = (l_uint32)(norm * val);
+        }
+    }
+
+    return pixd;
+}
+
+
 /*----------------------------------------------------------------------*
  *                        Binary block sum/rank                         *
  *----------------------------------------------------------------------*/
@@ -1084,7 +1194,147 @@ DPIX       *dpix;
  *  pixBlockrank()
  *
  *      Input:  pixs (1 bpp)
- *              accum pix (<optional> 32 bpp)
+ *              pixacc (<optional> 32 bpp accumulator of pixs; can be null)
+ *              wc, hc   (half width/height of block sum/rank kernel)
+ *              rank   (between 0.0 and 1.0; 0.5 is median filter)
+ *      Return: pixd (1 bpp)
+ *
+ *  Notes:
+ *      (1) If pixacc is null, this calls pixBlockrankIntegral() with an
+ *          integral image made from pixs.  To share one integral image
+ *          among several calls, use pixBlockrankIntegral() directly.
+ *      (2) Otherwise, pixacc, made by pixBlockconvAccum() from pixs,
+ *          is used for the block sums; see pixBlocksum().
+ *      (3) See pixBlockrankIntegral() for the other parameters.
+ */
+PIX *
+pixBlockrank(PIX       *pixs,
+             PIX       *pixacc,
+             l_int32    wc,
+             l_int32    hc,
+             l_float32  rank)
+{
+l_int32  w, h, d, thresh;
+PIX     *pixt, *pixd;
+
+    PROCNAME("pixBlockrank");
+
+    if (!pixacc)
+        return pixBlockrankIntegral(pixs, NULL, wc, hc, rank);
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    pixGetDimensions(pixs, &w, &h, &d);
+    if (d != 1)
+        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, NULL);
+    if (rank < 0.0 || rank > 1.0)
+        return (PIX *)ERROR_PTR("rank must be in [0.0, 1.0]", procName, NULL);
+
+    if (rank == 0.0) {
+        pixd = pixCreateTemplate(pixs);
+        pixSetAll(pixd);
+	return pixd;
+    }
+
+    if (wc < 0) wc = 0;
+    if (hc < 0) hc = 0;
+    if (w < 2 * wc + 1 || h < 2 * hc + 1) {
+        wc = L_MIN(wc, (w - 1) / 2);
+        hc = L_MIN(hc, (h - 1) / 2);
+        L_WARNING("kernel too large; reducing!", procName);
+        L_INFO_INT2("wc = %d, hc = %d", procName, wc, hc);
+    }
+    if (wc == 0 && hc == 0)
+        return pixCopy(NULL, pixs);
+
+    if ((pixt = pixBlocksum(pixs, pixacc, wc, hc)) == NULL)
+        return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+
+        /* 1 bpp block rank filter output.
+         * Must invert because threshold gives 1 for values < thresh,
+         * but we need a 1 if the value is >= thresh. */
+    thresh = (l_int32)(255. * rank);
+    pixd = pixThresholdToBinary(pixt, thresh);
+    pixInvert(pixd, pixd);
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
+/*!
+ *  pixBlocksum()
+ *
+ *      Input:  pixs (1 bpp)
+ *              pixacc (<optional> 32 bpp accumulator of pixs; can be null)
+ *              wc, hc   (half width/height of block sum/rank kernel)
+ *      Return: pixd (8 bpp)
+ *
+ *  Notes:
+ *      (1) If pixacc is null, this calls pixBlocksumIntegral() with an
+ *          integral image made from pixs.  To share one integral image
+ *          among several calls, use pixBlocksumIntegral() directly.
+ *      (2) Otherwise, pixacc, made by pixBlockconvAccum() from pixs,
+ *          is used for the block sums.  The result is the same.
+ *      (3) See pixBlocksumIntegral() for the other parameters.
+ */
+PIX *
+pixBlocksum(PIX     *pixs,
+            PIX     *pixacc,
+            l_int32  wc,
+            l_int32  hc)
+{
+l_int32    w, h, d, wplt, wpld;
+l_uint32  *datat, *datad;
+PIX       *pixt, *pixd;
+
+    PROCNAME("pixBlocksum");
+
+    if (!pixacc)
+        return pixBlocksumIntegral(pixs, NULL, wc, hc);
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    pixGetDimensions(pixs, &w, &h, &d);
+    if (d != 1)
+        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, NULL);
+    if (wc < 0) wc = 0;
+    if (hc < 0) hc = 0;
+    if (w < 2 * wc + 1 || h < 2 * hc + 1) {
+        wc = L_MIN(wc, (w - 1) / 2);
+        hc = L_MIN(hc, (h - 1) / 2);
+        L_WARNING("kernel too large; reducing!", procName);
+        L_INFO_INT2("wc = %d, hc = %d", procName, wc, hc);
+    }
+    if (wc == 0 && hc == 0)
+        return pixCopy(NULL, pixs);
+
+    if (pixGetDepth(pixacc) != 32)
+        return (PIX *)ERROR_PTR("pixacc not 32 bpp", procName, NULL);
+    pixt = pixClone(pixacc);
+
+        /* 8 bpp block sum output */
+    if ((pixd = pixCreate(w, h, 8)) == NULL) {
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
+    pixCopyResolution(pixd, pixs);
+
+    wpld = pixGetWpl(pixd);
+    wplt = pixGetWpl(pixt);
+    datad = pixGetData(pixd);
+    datat = pixGetData(pixt);
+    blocksumLow(datad, w, h, wpld, datat, wplt, wc, hc);
+
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
+/*!
+ *  pixBlockrankIntegral()
+ *
+ *      Input:  pixs (1 bpp)
+ *              intg (<optional> integral image of pixs; can be null)
  *              wc, hc   (half width/height of block sum/rank kernel)
  *              rank   (between 0.0 and 1.0; 0.5 is median filter)
  *      Return: pixd (1 bpp)
@@ -1098,24 +1348,24 @@ DPIX       *dpix;
  *          the returned pixel is 0.  Note that the special case
  *          of rank = 0.0 is always satisfied, so the returned
  *          pixd has all pixels with value 1.
- *      (3) If accum pix is null, make one, use it, and destroy it
- *          before returning; otherwise, just use the input accum pix
+ *      (3) If intg is null, make one, use it, and destroy it
+ *          before returning; otherwise, just use the input intg
  *      (4) If both wc and hc are 0, returns a copy unless rank == 0.0,
  *          in which case this returns an all-ones image.
  *      (5) Require that w >= 2 * wc + 1 and h >= 2 * hc + 1,
  *          where (w,h) are the dimensions of pixs.
  */
 PIX *
-pixBlockrank(PIX       *pixs,
-             PIX       *pixacc,
-             l_int32    wc,
-             l_int32    hc,
-             l_float32  rank)
+pixBlockrankIntegral(PIX         *pixs,
+                     L_INTEGRAL  *intg,
+                     l_int32      wc,
+                     l_int32      hc,
+                     l_float32    rank)
 {
 l_int32  w, h, d, thresh;
 PIX     *pixt, *pixd;
 
-    PROCNAME("pixBlockrank");
+    PROCNAME("pixBlockrankIntegral");
 
     if (!pixs)
         return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
@@ -1142,7 +1392,7 @@ PIX     *pixt, *pixd;
     if (wc == 0 && hc == 0)
         return pixCopy(NULL, pixs);
 
-    if ((pixt = pixBlocksum(pixs, pixacc, wc, hc)) == NULL)
+    if ((pixt = pixBlocksumIntegral(pixs, intg, wc, hc)) == NULL)
         return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
 
         /* 1 bpp block rank filter output.
@@ -1157,16 +1407,18 @@ PIX     *pixt, *pixd;
 
 
 /*!
- *  pixBlocksum()
+ *  pixBlocksumIntegral()
  *
  *      Input:  pixs (1 bpp)
- *              accum pix (<optional> 32 bpp)
+ *              intg (<optional> integral image of pixs; can be null)
  *              wc, hc   (half width/height of block sum/rank kernel)
  *      Return: pixd (8 bpp)
  *
  *  Notes:
- *      (1) If accum pix is null, make one and destroy it before
- *          returning; otherwise, just use the input accum pix
+ *      (1) If intg is null, make one and destroy it before
+ *          returning; otherwise, just use the input intg.  The
+ *          integral image can be shared with other operations on pixs;
+ *          see integral.c.
  *      (2) The full width and height of the convolution kernel
  *          are (2 * wc + 1) and (2 * hc + 1)
  *      (3) Use of wc = hc = 1, followed by pixInvert() on the
@@ -1186,16 +1438,18 @@ PIX     *pixt, *pixd;
  *          within the block.
  */
 PIX *
-pixBlocksum(PIX     *pixs,
-            PIX     *pixacc,
-            l_int32  wc,
-            l_int32  hc)
+pixBlocksumIntegral(PIX         *pixs,
+                    L_INTEGRAL  *intg,
+                    l_int32      wc,
+                    l_int32      hc)
 {
-l_int32    w, h, d, wplt, wpld;
-l_uint32  *datat, *datad;
-PIX       *pixt, *pixd;
+l_int32      w, h, d, wi, hi, di, wpla, wpld;
+l_uint32    *datad;
+l_uint64    *dataa;
+L_INTEGRAL  *intgc;
+PIX         *pixd;
 
-    PROCNAME("pixBlocksum");
+    PROCNAME("pixBlocksumIntegral");
 
     if (!pixs)
         return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
@@ -1213,30 +1467,34 @@ PIX       *pixt, *pixd;
     if (wc == 0 && hc == 0)
         return pixCopy(NULL, pixs);
 
-    if (pixacc) {
-        if (pixGetDepth(pixacc) != 32)
-            return (PIX *)ERROR_PTR("pixacc not 32 bpp", procName, NULL);
-        pixt = pixClone(pixacc);
+    if (intg) {
+        integralGetDimensions(intg, &wi, &hi, &di);
+        if (wi != w || hi != h || di != 1)
+            return (PIX *)ERROR_PTR("intg not made from pixs", procName, NULL);
+        intgc = integralClone(intg);
     }
     else {
-        if ((pixt = pixBlockconvAccum(pixs)) == NULL)
-            return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+        if ((intgc = integralCreate(pixs, 0)) == NULL)
+            return (PIX *)ERROR_PTR("intgc not made", procName, NULL);
     }
 
         /* 8 bpp block sum output */
     if ((pixd = pixCreate(w, h, 8)) == NULL) {
-        pixDestroy(&pixt);
+        integralDestroy(&intgc);
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
     }
     pixCopyResolution(pixd, pixs);
 
+        /* The accumulator value at (j, i) in blocksumIntegralLow() is the sum
+         * over src pixels up to and including (j, i), which is the
+         * integral image entry at (j + 1, i + 1). */
     wpld = pixGetWpl(pixd);
-    wplt = pixGetWpl(pixt);
     datad = pixGetData(pixd);
-    datat = pixGetData(pixt);
-    blocksumLow(datad, w, h, wpld, datat, wplt, wc, hc);
+    wpla = integralGetWpl(intgc);
+    dataa = integralGetSumData(intgc) + wpla + 1;
+    blocksumIntegralLow(datad, w, h, wpld, dataa, wpla, wc, hc);
 
-    pixDestroy(&pixt);
+    integralDestroy(&intgc);
     return pixd;
 }
 
@@ -1359,10 +1617,27 @@ PIX       *pixav, *pixd;
  *      (7) To get a subsampled output, call l_setConvolveSampling().
  *          The time to make a subsampled output is reduced by the
  *          product of the sampling factors.
- *      (8) The function is slow, running at about 12 machine cycles for
- *          each pixel-op in the convolution.  For example, with a 3 GHz
- *          cpu, a 1 Mpixel grayscale image, and a kernel with
- *          (sx * sy) = 25 elements, the convolution takes about 100 msec.
+ *      (8) The kernel is analyzed by kernelGetConvolveType(), and the
+ *          result is cached in @kel, so repeated use of a kernel
+ *          costs nothing extra.  There are three methods:
+ *           * If the kernel is separable (rank 1), the convolution is
+ *             done as a horizontal followed by a vertical 1D filter,
+ *             on floats, with (sx + sy) rather than (sx * sy)
+ *             multiply-adds per output pixel.  No intermediate
+ *             rounding is done, so this is not the same as
+ *             pixConvolveSep(), which rounds (and takes the absolute
+ *             value of) the result of the first 1D convolution.
+ *           * Otherwise, if the kernel has small integer values and
+ *             pixs is 8 or 16 bpp, the sums are accumulated exactly
+ *             in integer arithmetic.
+ *           * Otherwise, the general method with float arithmetic
+ *             is used.
+ *          The first two give the same result as the general method,
+ *          except for an occasional difference of 1 where the exact
+ *          result is very close to a half-integer.
+ *      (9) In all cases, each source line is unpacked just once into
+ *          an integer array, and a ring buffer holds the sy lines
+ *          needed for the current output line.
  */
 PIX *
 pixConvolve(PIX       *pixs,
@@ -1370,10 +1645,13 @@ pixConvolve(PIX       *pixs,
 	    l_int32    outdepth,
 	    l_int32    normflag)
 {
-l_int32    i, j, id, jd, k, m, w, h, d, wd, hd, sx, sy, cx, cy, wplt, wpld;
-l_int32    val;
-l_uint32  *datat, *datad, *linet, *lined;
-l_float32  sum;
+l_int32    i, j, id, jd, k, m, w, h, d, wd, hd, sx, sy, cx, cy, wpld;
+l_int32    type, isum, ret;
+l_int32   *tags, *linet;
+l_int32  **lines, **rows;
+l_uint32  *datad, *lined;
+l_float32  sum, normfact;
+l_float32 *kdata;
 L_KERNEL  *keli, *keln;
 PIX       *pixt, *pixd;
 
@@ -1395,57 +1673,89 @@ PIX       *pixt, *pixd;
         keln = kernelNormalize(keli, 1.0);
     else
         keln = kernelCopy(keli);
+    kernelGetConvolveType(kel, &type);
 
-    if ((pixt = pixAddMirroredBorder(pixs, cx, sx - cx, cy, sy - cy)) == NULL)
+    if ((pixt = pixAddMirroredBorder(pixs, cx, sx - cx, cy, sy - cy)) == NULL) {
+        kernelDestroy(&keli);
+        kernelDestroy(&keln);
         return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+    }
 
     wd = (w + ConvolveSamplingFactX - 1) / ConvolveSamplingFactX;
     hd = (h + ConvolveSamplingFactY - 1) / ConvolveSamplingFactY;
-    pixd = pixCreate(wd, hd, outdepth);
-    datat = pixGetData(pixt);
+    if ((pixd = pixCreate(wd, hd, outdepth)) == NULL) {
+        kernelDestroy(&keli);
+        kernelDestroy(&keln);
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
     datad = pixGetData(pixd);
-    wplt = pixGetWpl(pixt);
     wpld = pixGetWpl(pixd);
-    for (i = 0, id = 0; id < hd; i += ConvolveSamplingFactY, id++) {
-        lined = datad + id * wpld;
-        for (j = 0, jd = 0; jd < wd; j += ConvolveSamplingFactX, jd++) {
-            sum = 0.0;
-            for (k = 0; k < sy; k++) {
-                linet = datat + (i + k) * wplt;
-                if (d == 8) {
-                    for (m = 0; m < sx; m++) {
-                        val = GET_DATA_BYTE(linet, j + m);
-                        sum += val * keln->data[k][m];
-                    }
-                }
-                else if (d == 16) {
-                    for (m = 0; m < sx; m++) {
-                        val = GET_DATA_TWO_BYTES(linet, j + m);
-                        sum += val * keln->data[k][m];
-                    }
-                }
-                else {  /* d == 32 */
-                    for (m = 0; m < sx; m++) {
-                        val = *(linet + j + m);
-                        sum += val * keln->data[k][m];
-                    }
+
+        /* Ring buffer for the unpacked lines of pixt */
+    ret = 0;
+    lines = (l_int32 **)CALLOC(sy, sizeof(l_int32 *));
+    rows = (l_int32 **)CALLOC(sy, sizeof(l_int32 *));
+    tags = (l_int32 *)CALLOC(sy, sizeof(l_int32));
+    if (!lines || !rows || !tags)
+        ret = 1;
+    for (k = 0; !ret && k < sy; k++) {
+        lines[k] = (l_int32 *)CALLOC(pixGetWidth(pixt), sizeof(l_int32));
+        if (!lines[k])
+            ret = 1;
+        tags[k] = -1;
+    }
+
+    if (ret)
+        L_ERROR("line buffers not made", procName);
+    else if (type == L_KERNEL_SEPARABLE) {
+        kernelGetSum(kel, &sum);
+        normfact = (normflag && L_ABS(sum) >= 0.01) ? 1.0 / sum : 1.0;
+        ret = pixConvolveSepLines(pixt, pixd, kel, normfact, lines, tags);
+    }
+    else if (type == L_KERNEL_INTEGER && d != 32) {
+        kernelGetSum(kel, &sum);
+        isum = (normflag) ? L_ABS((l_int32)sum) : 0;
+        ret = pixConvolveIntLines(pixt, pixd, keli, isum, lines, tags);
+    }
+    else {  /* general float kernel */
+        for (i = 0, id = 0; id < hd; i += ConvolveSamplingFactY, id++) {
+            lined = datad + id * wpld;
+            for (k = 0; k < sy; k++)
+                rows[k] = convolveGetLine(pixt, i + k, lines, tags, sy);
+            for (j = 0, jd = 0; jd < wd; j += ConvolveSamplingFactX, jd++) {
+                sum = 0.0;
+                for (k = 0; k < sy; k++) {
+                    linet = rows[k] + j;
+                    kdata = keln->data[k];
+                    for (m = 0; m < sx; m++)
+                        sum += linet[m] * kdata[m];
                 }
+                if (sum < 0.0) sum = -sum;  /* make it non-negative */
+                if (outdepth == 8)
+                    SET_DATA_BYTE(lined, jd, (l_int32)(sum + 0.5));
+                else if (outdepth == 16)
+                    SET_DATA_TWO_BYTES(lined, jd, (l_int32)(sum + 0.5));
+                else  /* outdepth == 32 */
+                    *(lined + jd) = (l_uint32)(sum + 0.5);
             }
-#if 1
-	    if (sum < 0.0) sum = -sum;  /* make it non-negative */
-#endif
-            if (outdepth == 8)
-                SET_DATA_BYTE(lined, jd, (l_int32)(sum + 0.5));
-            else if (outdepth == 16)
-                SET_DATA_TWO_BYTES(lined, jd, (l_int32)(sum + 0.5));
-            else  /* outdepth == 32 */
-                *(lined + jd) = (l_uint32)(sum + 0.5);
         }
     }
 
+    if (lines) {
+        for (k = 0; k < sy; k++)
+            FREE(lines[k]);
+    }
+    FREE(lines);
+    FREE(rows);
+    FREE(tags);
     kernelDestroy(&keli);
     kernelDestroy(&keln);
     pixDestroy(&pixt);
+    if (ret) {
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("convolution failed", procName, NULL);
+    }
     return pixd;
 }
 
@@ -1677,6 +1987,10 @@ PIX  *pixt, *pixr, *pixg, *pixb, *pixd;
  *          product of the sampling factors.
  *      (5) This uses a mirrored border to avoid special casing on
  *          the boundaries.
+ *      (6) For large kernels, the convolution is done with the FFT
+ *          (see fpixConvolveFFT()), which gives the same result to
+ *          within rounding error.  To always use direct convolution,
+ *          call l_setConvolveFFT(0).
  */
 FPIX *
 fpixConvolve(FPIX      *fpixs,
@@ -1697,6 +2011,11 @@ FPIX       *fpixt, *fpixd;
     if (!kel)
         return (FPIX *)ERROR_PTR("kel not defined", procName, NULL);
 
+    fpixGetDimensions(fpixs, &w, &h);
+    kernelGetParameters(kel, &sy, &sx, NULL, NULL);
+    if (ConvolveUseFFT && convolveFFTIsFaster(w, h, sx, sy))
+        return fpixConvolveFFT(fpixs, kel, normflag);
+
     keli = kernelInvert(kel);
     kernelGetParameters(keli, &sy, &sx, &cy, &cx);
     if (normflag)
@@ -1704,7 +2023,6 @@ FPIX       *fpixt, *fpixd;
     else
         keln = kernelCopy(keli);
 
-    fpixGetDimensions(fpixs, &w, &h);
     fpixt = fpixAddMirroredBorder(fpixs, cx, sx - cx, cy, sy - cy);
     if (!fpixt)
         return (FPIX *)ERROR_PTR("fpixt not made", procName, NULL);
@@ -1810,6 +2128,163 @@ FPIX      *fpixt, *fpixd;
 }
 
 
+/*------------------------------------------------------------------------*
+ *                    Recursive gaussian convolution                      *
+ *------------------------------------------------------------------------*/
+/*!
+ *  pixRecursiveGaussian()
+ *
+ *      Input:  pixs (8 or 32 bpp; or 2, 4 or 8 bpp with colormap)
+ *              sigmax, sigmay (standard deviation of the gaussian in
+ *                              each direction; use 0.0 to skip a
+ *                              direction; otherwise >= 0.5)
+ *      Return: pixd (8 or 32 bpp), or null on error
+ *
+ *  Notes:
+ *      (1) This is a gaussian blur implemented with the 4th order
+ *          recursive filter of Deriche, run forward and backward in
+ *          each direction.  The number of operations per pixel is
+ *          independent of sigma, so it is much faster than
+ *          pixConvolveSep() with a gaussian kernel when sigma is large.
+ *      (2) It approximates convolution with the gaussian kernels
+ *          from makeGaussianKernelSep(), with mirrored borders, to
+ *          within 1 level for sigma >= 1.  See recursiveGaussianLow().
+ *      (3) For a box filter, whose cost is also independent of the
+ *          size, use pixBlockconv().
+ *      (4) For 32 bpp, each color component is filtered separately.
+ *          Colormapped images are converted to 8 or 32 bpp.
+ */
+PIX *
+pixRecursiveGaussian(PIX       *pixs,
+                     l_float32  sigmax,
+                     l_float32  sigmay)
+{
+l_int32     i, j, k, w, h, d, wpls, wpld, wplf, val;
+l_int32     shift[3];
+l_uint32   *datas, *datad, *lines, *lined;
+l_float32  *dataf, *linef;
+FPIX       *fpix;
+PIX        *pixt, *pixd;
+
+    PROCNAME("pixRecursiveGaussian");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if ((sigmax != 0.0 && sigmax < 0.5) || (sigmay != 0.0 && sigmay < 0.5))
+        return (PIX *)ERROR_PTR("sigma must be 0 or >= 0.5", procName, NULL);
+
+    if (pixGetColormap(pixs))
+        pixt = pixRemoveColormap(pixs, REMOVE_CMAP_BASED_ON_SRC);
+    else
+        pixt = pixClone(pixs);
+    pixGetDimensions(pixt, &w, &h, &d);
+    if (d != 8 && d != 32) {
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("pixs not 8 or 32 bpp", procName, NULL);
+    }
+
+    if ((fpix = fpixCreate(w, h)) == NULL) {
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("fpix not made", procName, NULL);
+    }
+    if ((pixd = pixCreateTemplate(pixt)) == NULL) {
+        fpixDestroy(&fpix);
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
+    datas = pixGetData(pixt);
+    wpls = pixGetWpl(pixt);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    dataf = fpixGetData(fpix);
+    wplf = fpixGetWpl(fpix);
+    shift[0] = L_RED_SHIFT;
+    shift[1] = L_GREEN_SHIFT;
+    shift[2] = L_BLUE_SHIFT;
+
+        /* Filter the single component, or each of the 3 color
+         * components in turn, through the float array */
+    for (k = 0; k < ((d == 8) ? 1 : 3); k++) {
+        for (i = 0; i < h; i++) {
+            lines = datas + i * wpls;
+            linef = dataf + i * wplf;
+            if (d == 8) {
+                for (j = 0; j < w; j++)
+                    linef[j] = (l_float32)GET_DATA_BYTE(lines, j);
+            }
+            else {
+                for (j = 0; j < w; j++)
+                    linef[j] = (l_float32)((lines[j] >> shift[k]) & 0xff);
+            }
+        }
+
+        if (recursiveGaussianLow(dataf, w, h, wplf, sigmax, sigmay)) {
+            fpixDestroy(&fpix);
+            pixDestroy(&pixt);
+            pixDestroy(&pixd);
+            return (PIX *)ERROR_PTR("fpix not filtered", procName, NULL);
+        }
+
+        for (i = 0; i < h; i++) {
+            lined = datad + i * wpld;
+            linef = dataf + i * wplf;
+            for (j = 0; j < w; j++) {
+                val = (l_int32)(linef[j] + 0.5);
+                val = L_MIN(255, L_MAX(0, val));
+                if (d == 8)
+                    SET_DATA_BYTE(lined, j, val);
+                else
+                    lined[j] |= (l_uint32)val << shift[k];
+            }
+        }
+    }
+
+    fpixDestroy(&fpix);
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
+/*!
+ *  fpixRecursiveGaussian()
+ *
+ *      Input:  fpixs
+ *              sigmax, sigmay (standard deviation of the gaussian in
+ *                              each direction; use 0.0 to skip a
+ *                              direction; otherwise >= 0.5)
+ *      Return: fpixd, or null on error
+ *
+ *  Notes:
+ *      (1) This is the FPix version of pixRecursiveGaussian().
+ *          The time is independent of sigma.
+ */
+FPIX *
+fpixRecursiveGaussian(FPIX      *fpixs,
+                      l_float32  sigmax,
+                      l_float32  sigmay)
+{
+l_int32  w, h;
+FPIX    *fpixd;
+
+    PROCNAME("fpixRecursiveGaussian");
+
+    if (!fpixs)
+        return (FPIX *)ERROR_PTR("fpixs not defined", procName, NULL);
+    if ((sigmax != 0.0 && sigmax < 0.5) || (sigmay != 0.0 && sigmay < 0.5))
+        return (FPIX *)ERROR_PTR("sigma must be 0 or >= 0.5", procName, NULL);
+
+    if ((fpixd = fpixCopy(NULL, fpixs)) == NULL)
+        return (FPIX *)ERROR_PTR("fpixd not made", procName, NULL);
+    fpixGetDimensions(fpixd, &w, &h);
+    if (recursiveGaussianLow(fpixGetData(fpixd), w, h, fpixGetWpl(fpixd),
+                             sigmax, sigmay)) {
+        fpixDestroy(&fpixd);
+        return (FPIX *)ERROR_PTR("fpixd not filtered", procName, NULL);
+    }
+    return fpixd;
+}
+
+
 /*------------------------------------------------------------------------*
  *                Set parameter for convolution subsampling               *
  *------------------------------------------------------------------------*/
@@ -1832,3 +2307,317 @@ l_setConvolveSampling(l_int32  xfact,
     ConvolveSamplingFactX = xfact;
     ConvolveSamplingFactY = yfact;
 }
+
+
+/*!
+ *  l_setConvolveFFT()
+ *
+ *      Input:  useflag (1 to allow the FFT; 0 to always convolve directly)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This determines if fpixConvolve() can use the FFT for
+ *          large kernels.  The default is 1: the FFT is used when
+ *          it is estimated to be faster than direct convolution.
+ */
+void
+l_setConvolveFFT(l_int32  useflag)
+{
+    ConvolveUseFFT = (useflag) ? 1 : 0;
+}
+
+
+/*----------------------------------------------------------------------*
+ *                            Static helpers                            *
+ *----------------------------------------------------------------------*/
+/*!
+ *  convolveFFTIsFaster()
+ *
+ *      Input:  w, h (size of image to be convolved)
+ *              sx, sy (size of kernel)
+ *      Return: 1 if convolution with the FFT is expected to be faster;
+ *              0 otherwise
+ *
+ *  Notes:
+ *      (1) Direct convolution takes one multiply-add for each kernel
+ *          element at each output pixel, so the cost is reduced by
+ *          subsampling the output.  Convolution with the FFT does three
+ *          transforms of the full-resolution image with border, padded
+ *          up to a power of 2 in each direction.
+ */
+static l_int32
+convolveFFTIsFaster(l_int32  w,
+                    l_int32  h,
+                    l_int32  sx,
+                    l_int32  sy)
+{
+l_int32    nx, ny, wd, hd;
+l_float64  directcost, fftcost;
+
+    wd = (w + ConvolveSamplingFactX - 1) / ConvolveSamplingFactX;
+    hd = (h + ConvolveSamplingFactY - 1) / ConvolveSamplingFactY;
+    directcost = (l_float64)wd * hd * sx * sy;
+    for (nx = 2; nx < w + sx; nx <<= 1)
+        ;
+    for (ny = 1; ny < h + sy; ny <<= 1)
+        ;
+    fftcost = FFT_COST_FACTOR * (l_float64)nx * ny *
+              log((l_float64)nx * ny) / log(2.0);
+    return (fftcost < directcost) ? 1 : 0;
+}
+
+
+/*!
+ *  pixConvolveSepLines()
+ *
+ *      Input:  pixt (source with border added for the kernel)
+ *              pixd (dest; 8, 16 or 32 bpp)
+ *              kel (separable kernel, not inverted)
+ *              normfact (multiplies the kernel; 1.0 for no normalization)
+ *              lines (ring buffer of sy lines of pixt; see pixConvolve())
+ *              tags (line of pixt held in each ring buffer entry)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Convolution with the rank 1 kernel kel->colfact[i] *
+ *          kel->rowfact[j], done as a horizontal 1D convolution into
+ *          a second ring buffer, followed by a vertical 1D convolution.
+ *          The kernel factors are inverted here.
+ *      (2) Each line of pixt is unpacked and filtered horizontally
+ *          at most once, for any vertical subsampling factor.
+ */
+static l_int32
+pixConvolveSepLines(PIX       *pixt,
+                    PIX       *pixd,
+                    L_KERNEL  *kel,
+                    l_float32  normfact,
+                    l_int32  **lines,
+                    l_int32   *tags)
+{
+l_int32     i, j, id, jd, k, m, sx, sy, wd, hd, dd, wpld, xfact, yfact, slot;
+l_int32    *linet, *htags;
+l_uint32   *datad, *lined;
+l_float32   sum;
+l_float32  *colf, *rowf, *lineh;
+l_float32 **hlines, **hrows;
+
+    PROCNAME("pixConvolveSepLines");
+
+    kernelGetParameters(kel, &sy, &sx, NULL, NULL);
+    pixGetDimensions(pixd, &wd, &hd, &dd);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    xfact = ConvolveSamplingFactX;
+    yfact = ConvolveSamplingFactY;
+
+        /* Inverted factors, with the normalization in the row factor */
+    colf = (l_float32 *)CALLOC(sy, sizeof(l_float32));
+    rowf = (l_float32 *)CALLOC(sx, sizeof(l_float32));
+    if (!colf || !rowf) {
+        FREE(colf);
+        FREE(rowf);
+        return ERROR_INT("kernel factors not made", procName, 1);
+    }
+    for (k = 0; k < sy; k++)
+        colf[k] = kel->colfact[sy - 1 - k];
+    for (m = 0; m < sx; m++)
+        rowf[m] = normfact * kel->rowfact[sx - 1 - m];
+
+        /* Ring buffer of horizontally filtered lines */
+    hlines = (l_float32 **)CALLOC(sy, sizeof(l_float32 *));
+    hrows = (l_float32 **)CALLOC(sy, sizeof(l_float32 *));
+    htags = (l_int32 *)CALLOC(sy, sizeof(l_int32));
+    if (!hlines || !hrows || !htags) {
+        FREE(hlines);
+        FREE(hrows);
+        FREE(htags);
+        FREE(colf);
+        FREE(rowf);
+        return ERROR_INT("line buffers not made", procName, 1);
+    }
+    for (k = 0; k < sy; k++) {
+        if ((hlines[k] = (l_float32 *)CALLOC(wd, sizeof(l_float32))) == NULL) {
+            while (--k >= 0)
+                FREE(hlines[k]);
+            FREE(hlines);
+            FREE(hrows);
+            FREE(htags);
+            FREE(colf);
+            FREE(rowf);
+            return ERROR_INT("line buffer not made", procName, 1);
+        }
+        htags[k] = -1;
+    }
+
+    for (i = 0, id = 0; id < hd; i += yfact, id++) {
+        for (k = 0; k < sy; k++) {
+            slot = (i + k) % sy;
+            if (htags[slot] == i + k)
+                continue;
+            linet = convolveGetLine(pixt, i + k, lines, tags, sy);
+            lineh = hlines[slot];
+            for (j = 0, jd = 0; jd < wd; j += xfact, jd++) {
+                sum = 0.0;
+                for (m = 0; m < sx; m++)
+                    sum += linet[j + m] * rowf[m];
+                lineh[jd] = sum;
+            }
+            htags[slot] = i + k;
+        }
+
+        lined = datad + id * wpld;
+        for (k = 0; k < sy; k++)
+            hrows[k] = hlines[(i + k) % sy];
+        for (jd = 0; jd < wd; jd++) {
+            sum = 0.0;
+            for (k = 0; k < sy; k++)
+                sum += colf[k] * hrows[k][jd];
+            if (sum < 0.0) sum = -sum;  /* make it non-negative */
+            if (dd == 8)
+                SET_DATA_BYTE(lined, jd, (l_int32)(sum + 0.5));
+            else if (dd == 16)
+                SET_DATA_TWO_BYTES(lined, jd, (l_int32)(sum + 0.5));
+            else  /* dd == 32 */
+                *(lined + jd) = (l_uint32)(sum + 0.5);
+        }
+    }
+
+    for (k = 0; k < sy; k++)
+        FREE(hlines[k]);
+    FREE(hlines);
+    FREE(hrows);
+    FREE(htags);
+    FREE(colf);
+    FREE(rowf);
+    return 0;
+}
+
+
+/*!
+ *  pixConvolveIntLines()
+ *
+ *      Input:  pixt (8 or 16 bpp source with border added for the kernel)
+ *              pixd (dest; 8, 16 or 32 bpp)
+ *              keli (inverted kernel with small integer values)
+ *              normsum (absolute value of the kernel sum for normalization;
+ *                       0 for no normalization)
+ *              lines (ring buffer of sy lines of pixt; see pixConvolve())
+ *              tags (line of pixt held in each ring buffer entry)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The sums are exact in 32 bit arithmetic; see
+ *          kernelGetConvolveType().  The normalized result
+ *          |sum| / normsum is rounded in unsigned integer arithmetic.
+ */
+static l_int32
+pixConvolveIntLines(PIX       *pixt,
+                    PIX       *pixd,
+                    L_KERNEL  *keli,
+                    l_int32    normsum,
+                    l_int32  **lines,
+                    l_int32   *tags)
+{
+l_int32    i, j, id, jd, k, m, sx, sy, wd, hd, wpld, xfact, yfact, dd, isum;
+l_int32   *linet, *kdata, *kline;
+l_int32  **rows;
+l_uint32   val;
+l_uint32  *datad, *lined;
+
+    PROCNAME("pixConvolveIntLines");
+
+    kernelGetParameters(keli, &sy, &sx, NULL, NULL);
+    pixGetDimensions(pixd, &wd, &hd, &dd);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    xfact = ConvolveSamplingFactX;
+    yfact = ConvolveSamplingFactY;
+
+    rows = (l_int32 **)CALLOC(sy, sizeof(l_int32 *));
+    kdata = (l_int32 *)CALLOC(sx * sy, sizeof(l_int32));
+    if (!rows || !kdata) {
+        FREE(rows);
+        FREE(kdata);
+        return ERROR_INT("buffers not made", procName, 1);
+    }
+    for (k = 0; k < sy; k++)
+        for (m = 0; m < sx; m++)
+            kdata[k * sx + m] = (l_int32)keli->data[k][m];
+
+    for (i = 0, id = 0; id < hd; i += yfact, id++) {
+        lined = datad + id * wpld;
+        for (k = 0; k < sy; k++)
+            rows[k] = convolveGetLine(pixt, i + k, lines, tags, sy);
+        for (j = 0, jd = 0; jd < wd; j += xfact, jd++) {
+            isum = 0;
+            for (k = 0, kline = kdata; k < sy; k++, kline += sx) {
+                linet = rows[k] + j;
+                for (m = 0; m < sx; m++)
+                    isum += linet[m] * kline[m];
+            }
+            val = (isum < 0) ? -isum : isum;
+            if (normsum > 0)
+                val = (2 * val + normsum) / (2 * normsum);
+            if (dd == 8)
+                SET_DATA_BYTE(lined, jd, val);
+            else if (dd == 16)
+                SET_DATA_TWO_BYTES(lined, jd, val);
+            else  /* dd == 32 */
+                *(lined + jd) = val;
+        }
+    }
+
+    FREE(rows);
+    FREE(kdata);
+    return 0;
+}
+
+
+/*!
+ *  convolveGetLine()
+ *
+ *      Input:  pixt (8, 16 or 32 bpp)
+ *              i (line of pixt)
+ *              lines (ring buffer of nlines unpacked lines)
+ *              tags (line of pixt held in each ring buffer entry,
+ *                    or -1 if empty)
+ *              nlines (size of ring buffer)
+ *      Return: unpacked line i
+ *
+ *  Notes:
+ *      (1) Line i is held in entry (i % nlines), and is unpacked
+ *          only if it is not already there.
+ */
+static l_int32 *
+convolveGetLine(PIX       *pixt,
+                l_int32    i,
+                l_int32  **lines,
+                l_int32   *tags,
+                l_int32    nlines)
+{
+l_int32    j, w, d, slot;
+l_int32   *line;
+l_uint32  *lines32;
+
+    slot = i % nlines;
+    line = lines[slot];
+    if (tags[slot] == i)
+        return line;
+
+    pixGetDimensions(pixt, &w, NULL, &d);
+    lines32 = pixGetData(pixt) + i * pixGetWpl(pixt);
+    if (d == 8) {
+        for (j = 0; j < w; j++)
+            line[j] = GET_DATA_BYTE(lines32, j);
+    }
+    else if (d == 16) {
+        for (j = 0; j < w; j++)
+            line[j] = GET_DATA_TWO_BYTES(lines32, j);
+    }
+    else {  /* d == 32 */
+        for (j = 0; j < w; j++)
+            line[j] = lines32[j];
+    }
+    tags[slot] = i;
+    return line;
+}
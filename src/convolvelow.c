@@ -34,10 +34,26 @@
  *
  *      Binary block sum and rank filter
  *          void      blocksumLow()
+ *          void      blocksumIntegralLow()
+ *          static void     blocksumNormalizeBoundary()
+ *
+ *      Recursive gaussian convolution
+ *          l_int32   recursiveGaussianLow()
+ *          static void     recursiveGaussianCoeffs()
+ *          static l_int32  mirrorIndex()
  */
 
+#include <string.h>
+#include <math.h>
 #include "allheaders.h"
 
+static void recursiveGaussianCoeffs(l_float32 sigma, l_float32 *cn,
+                                    l_float32 *cm, l_float32 *cd,
+                                    l_float32 *pstartc, l_float32 *pstarta);
+static l_int32 mirrorIndex(l_int32 index, l_int32 n);
+static void blocksumNormalizeBoundary(l_uint32 *datad, l_int32 w, l_int32 h,
+                                      l_int32 wpl, l_int32 wc, l_int32 hc);
+
 
 /*----------------------------------------------------------------------*
  *                     Grayscale Block Convolution                      *
@@ -371,8 +387,8 @@ blocksumLow(l_uint32  *datad,
             l_int32    hc)
 {
 l_int32    i, j, imax, imin, jmax, jmin;
-l_int32    wn, hn, fwc, fhc, wmwc, hmhc;
-l_float32  norm, normh, normw;
+l_int32    fwc, fhc, wmwc, hmhc;
+l_float32  norm;
 l_uint32   val;
 l_uint32  *linemina, *linemaxa, *lined;
 
@@ -407,9 +423,110 @@ l_uint32  *linemina, *linemaxa, *lined;
         }
     }
 
+    blocksumNormalizeBoundary(datad, w, h, wpl, wc, hc);
+    return;
+}
+
+
+/*!
+ *  blocksumIntegralLow()
+ *
+ *      Input:  datad  (of 8 bpp dest)
+ *              w, h, wpl  (of 8 bpp dest)
+ *              dataa (of 64-bit accum)
+ *              wpla  (of 64-bit accum)
+ *              wc, hc  (convolution "half-width" and "half-height")
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This is blocksumLow() for a 64-bit accumulator, such as
+ *          the sum table of an integral image offset to (1, 1).
+ *          Use it for images whose pixel sums may exceed 2^32.
+ */
+void
+blocksumIntegralLow(l_uint32  *datad,
+                    l_int32    w,
+                    l_int32    h,
+                    l_int32    wpl,
+                    l_uint64  *dataa,
+                    l_int32    wpla,
+                    l_int32    wc,
+                    l_int32    hc)
+{
+l_int32    i, j, imax, imin, jmax, jmin;
+l_int32    fwc, fhc, wmwc, hmhc;
+l_float32  norm;
+l_uint32   val;
+l_uint32  *lined;
+l_uint64  *linemina, *linemaxa;
+
+    PROCNAME("blocksumIntegralLow");
+
+    wmwc = w - wc;
+    hmhc = h - hc;
+    if (wmwc <= 0 || hmhc <= 0) {
+        L_ERROR("wc >= w || hc >=h", procName);
+        return;
+    }
+    fwc = 2 * wc + 1;
+    fhc = 2 * hc + 1;
+    norm = 255. / (fwc * fhc);
+
         /*------------------------------------------------------------*
-         *          now fix normalization for boundary pixels         *
+         *  compute, using b.c. only to set limits on the accum image *
          *------------------------------------------------------------*/
+    for (i = 0; i < h; i++) {
+        imin = L_MAX(i - 1 - hc, 0);
+        imax = L_MIN(i + hc, h - 1);
+        lined = datad + wpl * i;
+        linemina = dataa + wpla * imin;
+        linemaxa = dataa + wpla * imax;
+        for (j = 0; j < w; j++) {
+            jmin = L_MAX(j - 1 - wc, 0);
+            jmax = L_MIN(j + wc, w - 1);
+            val = (l_uint32)(linemaxa[jmax] - linemaxa[jmin]
+                             - linemina[jmax] + linemina[jmin]);
+            val = (l_uint8)(norm * val);
+            SET_DATA_BYTE(lined, j, val);
+        }
+    }
+
+    blocksumNormalizeBoundary(datad, w, h, wpl, wc, hc);
+    return;
+}
+
+
+/*!
+ *  blocksumNormalizeBoundary()
+ *
+ *      Input:  datad  (of 8 bpp dest)
+ *              w, h, wpl  (of 8 bpp dest)
+ *              wc, hc  (convolution "half-width" and "half-height")
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Boundary pixels of a block sum cover less than the full
+ *          block, so they are scaled up by the ratio of the full block
+ *          area to the participating area; see blocksumLow().
+ */
+static void
+blocksumNormalizeBoundary(l_uint32  *datad,
+                          l_int32    w,
+                          l_int32    h,
+                          l_int32    wpl,
+                          l_int32    wc,
+                          l_int32    hc)
+{
+l_int32    i, j, wn, hn, fwc, fhc, wmwc, hmhc;
+l_float32  normh, normw;
+l_uint32   val;
+l_uint32  *lined;
+
+    wmwc = w - wc;
+    hmhc = h - hc;
+    fwc = 2 * wc + 1;
+    fhc = 2 * hc + 1;
+
     for (i = 0; i <= hc; i++) {    /* first hc + 1 lines */
         hn = hc + i;
         normh = (l_float32)fhc / (l_float32)hn;   /* > 1 */
@@ -480,3 +597,291 @@ l_uint32  *linemina, *linemaxa, *lined;
 
     return;
 }
+
+
+/*----------------------------------------------------------------------*
+ *                    Recursive gaussian convolution                    *
+ *----------------------------------------------------------------------*/
+/*!
+ *  recursiveGaussianLow()
+ *
+ *      Input:  data (float array, filtered in place)
+ *              w, h, wpl
+ *              sigmax, sigmay (standard deviations; 0.0 to skip a
+ *                              direction; otherwise >= 0.5)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This uses the 4th order recursive approximation to the
+ *          gaussian of R. Deriche, "Recursively implementing the
+ *          Gaussian and its derivatives", INRIA report 1893 (1993).
+ *          Each line is filtered by a causal and an anti-causal
+ *          recursion, whose outputs are summed.  Each recursion takes
+ *          8 multiply-adds per pixel, for any value of sigma.
+ *      (2) Each line is extended at both ends with a mirrored border,
+ *          to match the boundary handling of the kernel convolutions.
+ *          The recursions start in the steady state for the end value,
+ *          and the border is 4 * sigma wide, so the start-up transient
+ *          is negligible within the image.
+ *      (3) The vertical pass updates a full row of accumulators at
+ *          each step, so that memory is accessed sequentially and
+ *          the inner loop over columns can be vectorized.
+ */
+l_int32
+recursiveGaussianLow(l_float32  *data,
+                     l_int32     w,
+                     l_int32     h,
+                     l_int32     wpl,
+                     l_float32   sigmax,
+                     l_float32   sigmay)
+{
+l_int32     i, j, n, npad;
+l_float32   startc, starta, ya, ya1, ya2, ya3, ya4;
+l_float32   cn[4], cm[4], cd[4];
+l_float32  *bufx, *bufy, *bufa, *line, *linex, *liney;
+l_float32  *x0, *x1, *x2, *x3, *x4, *y1, *y2, *y3, *y4;
+l_float32  *a0, *a1, *a2, *a3, *a4;
+
+    PROCNAME("recursiveGaussianLow");
+
+    if (!data)
+        return ERROR_INT("data not defined", procName, 1);
+
+        /* Horizontal pass, on each row in turn.  Both arrays have
+         * 4 extra values at each end for the steady state, so that
+         * x[j] is at bufx[j + 4]. */
+    if (sigmax > 0.0) {
+        recursiveGaussianCoeffs(sigmax, cn, cm, cd, &startc, &starta);
+        npad = (l_int32)(4.0 * sigmax + 0.5) + 4;
+        n = w + 2 * npad;
+        bufx = (l_float32 *)CALLOC(n + 8, sizeof(l_float32));
+        bufy = (l_float32 *)CALLOC(n + 8, sizeof(l_float32));
+        if (!bufx || !bufy) {
+            FREE(bufx);
+            FREE(bufy);
+            return ERROR_INT("bufx and bufy not both made", procName, 1);
+        }
+        for (i = 0; i < h; i++) {
+            line = data + i * wpl;
+            for (j = 0; j < n; j++)
+                bufx[j + 4] = line[mirrorIndex(j - npad, w)];
+            for (j = 0; j < 4; j++) {
+                bufx[j] = bufx[4];
+                bufy[j] = startc * bufx[4];
+                bufx[n + 4 + j] = bufx[n + 3];
+            }
+
+                /* Causal recursion */
+            for (j = 4; j < n + 4; j++)
+                bufy[j] = cn[0] * bufx[j] + cn[1] * bufx[j - 1] +
+                          cn[2] * bufx[j - 2] + cn[3] * bufx[j - 3] -
+                          cd[0] * bufy[j - 1] - cd[1] * bufy[j - 2] -
+                          cd[2] * bufy[j - 3] - cd[3] * bufy[j - 4];
+
+                /* Anti-causal recursion, summed with the causal result */
+            ya1 = ya2 = ya3 = ya4 = starta * bufx[n + 3];
+            for (j = n + 3; j >= 4; j--) {
+                ya = cm[0] * bufx[j + 1] + cm[1] * bufx[j + 2] +
+                     cm[2] * bufx[j + 3] + cm[3] * bufx[j + 4] -
+                     cd[0] * ya1 - cd[1] * ya2 - cd[2] * ya3 - cd[3] * ya4;
+                if (j - 4 >= npad && j - 4 < npad + w)
+                    line[j - 4 - npad] = bufy[j] + ya;
+                ya4 = ya3;
+                ya3 = ya2;
+                ya2 = ya1;
+                ya1 = ya;
+            }
+        }
+        FREE(bufx);
+        FREE(bufy);
+    }
+
+        /* Vertical pass, on all columns together.  Row r of the input
+         * with border is at bufx + (r + 4) * w, and likewise for the
+         * causal result in bufy.  The anti-causal result is held in
+         * a ring of 5 rows in bufa. */
+    if (sigmay > 0.0) {
+        recursiveGaussianCoeffs(sigmay, cn, cm, cd, &startc, &starta);
+        npad = (l_int32)(4.0 * sigmay + 0.5) + 4;
+        n = h + 2 * npad;
+        bufx = (l_float32 *)CALLOC((n + 8) * w, sizeof(l_float32));
+        bufy = (l_float32 *)CALLOC((n + 4) * w, sizeof(l_float32));
+        bufa = (l_float32 *)CALLOC(5 * w, sizeof(l_float32));
+        if (!bufx || !bufy || !bufa) {
+            FREE(bufx);
+            FREE(bufy);
+            FREE(bufa);
+            return ERROR_INT("bufs not all made", procName, 1);
+        }
+        for (i = 0; i < n; i++)
+            memcpy(bufx + (i + 4) * w, data + mirrorIndex(i - npad, h) * wpl,
+                   w * sizeof(l_float32));
+        for (i = 0; i < 4; i++) {
+            memcpy(bufx + i * w, bufx + 4 * w, w * sizeof(l_float32));
+            memcpy(bufx + (n + 4 + i) * w, bufx + (n + 3) * w,
+                   w * sizeof(l_float32));
+            liney = bufy + i * w;
+            linex = bufx + 4 * w;
+            for (j = 0; j < w; j++)
+                liney[j] = startc * linex[j];
+        }
+
+            /* Causal recursion */
+        for (i = 4; i < n + 4; i++) {
+            x0 = bufx + i * w;
+            x1 = x0 - w;
+            x2 = x1 - w;
+            x3 = x2 - w;
+            liney = bufy + i * w;
+            y1 = liney - w;
+            y2 = y1 - w;
+            y3 = y2 - w;
+            y4 = y3 - w;
+            for (j = 0; j < w; j++)
+                liney[j] = cn[0] * x0[j] + cn[1] * x1[j] + cn[2] * x2[j] +
+                           cn[3] * x3[j] - cd[0] * y1[j] - cd[1] * y2[j] -
+                           cd[2] * y3[j] - cd[3] * y4[j];
+        }
+
+            /* Anti-causal recursion, summed with the causal result.
+             * Row r of the anti-causal result is in ring row (r % 5). */
+        linex = bufx + (n + 3) * w;
+        for (i = n; i < n + 4; i++) {
+            a0 = bufa + (i % 5) * w;
+            for (j = 0; j < w; j++)
+                a0[j] = starta * linex[j];
+        }
+        for (i = n - 1; i >= 0; i--) {
+            a0 = bufa + (i % 5) * w;
+            a1 = bufa + ((i + 1) % 5) * w;
+            a2 = bufa + ((i + 2) % 5) * w;
+            a3 = bufa + ((i + 3) % 5) * w;
+            a4 = bufa + ((i + 4) % 5) * w;
+            x1 = bufx + (i + 5) * w;
+            x2 = x1 + w;
+            x3 = x2 + w;
+            x4 = x3 + w;
+            for (j = 0; j < w; j++)
+                a0[j] = cm[0] * x1[j] + cm[1] * x2[j] + cm[2] * x3[j] +
+                        cm[3] * x4[j] - cd[0] * a1[j] - cd[1] * a2[j] -
+                        cd[2] * a3[j] - cd[3] * a4[j];
+            if (i >= npad && i < npad + h) {
+                line = data + (i - npad) * wpl;
+                liney = bufy + (i + 4) * w;
+                for (j = 0; j < w; j++)
+                    line[j] = liney[j] + a0[j];
+            }
+        }
+        FREE(bufx);
+        FREE(bufy);
+        FREE(bufa);
+    }
+
+    return 0;
+}
+
+
+/*!
+ *  recursiveGaussianCoeffs()
+ *
+ *      Input:  sigma (>= 0.5)
+ *              cn (<return> 4 causal input coefficients, n0 ... n3)
+ *              cm (<return> 4 anti-causal input coefficients, m1 ... m4)
+ *              cd (<return> 4 feedback coefficients, d1 ... d4)
+ *              &startc, &starta (<return> steady state output of the
+ *                                causal and anti-causal recursions,
+ *                                for unit input)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The gaussian is approximated for t >= 0 by
+ *            (a0 cos(w0 t) + a1 sin(w0 t)) exp(-b0 t) +
+ *            (c0 cos(w1 t) + c1 sin(w1 t)) exp(-b1 t)
+ *          with t in units of sigma.  The causal filter is the
+ *          z-transform of this, sampled at t = n / sigma for n >= 0,
+ *          and the anti-causal filter is its mirror image for n >= 1.
+ *      (2) The coefficients are scaled so that the sum of the
+ *          two responses has unit gain.
+ */
+static void
+recursiveGaussianCoeffs(l_float32   sigma,
+                        l_float32  *cn,
+                        l_float32  *cm,
+                        l_float32  *cd,
+                        l_float32  *pstartc,
+                        l_float32  *pstarta)
+{
+l_int32    i;
+l_float64  a0, a1, b0, b1, c0, c1, w0, w1, e0, e1;
+l_float64  p0, p1, q1, q2, r0, r1, s1, s2, gain, sumd;
+l_float64  n[4], m[4], d[4];
+
+    a0 = 1.680;
+    a1 = 3.735;
+    b0 = 1.783;
+    b1 = 1.723;
+    w0 = 0.6318;
+    w1 = 1.997;
+    c0 = -0.6803;
+    c1 = -0.2598;
+
+        /* Numerator and denominator of each of the two terms */
+    e0 = exp(-b0 / sigma);
+    e1 = exp(-b1 / sigma);
+    p0 = a0;
+    p1 = e0 * (a1 * sin(w0 / sigma) - a0 * cos(w0 / sigma));
+    q1 = -2.0 * e0 * cos(w0 / sigma);
+    q2 = e0 * e0;
+    r0 = c0;
+    r1 = e1 * (c1 * sin(w1 / sigma) - c0 * cos(w1 / sigma));
+    s1 = -2.0 * e1 * cos(w1 / sigma);
+    s2 = e1 * e1;
+
+        /* Sum of the two terms, over a common denominator */
+    n[0] = p0 + r0;
+    n[1] = p1 + p0 * s1 + r1 + r0 * q1;
+    n[2] = p1 * s1 + p0 * s2 + r1 * q1 + r0 * q2;
+    n[3] = p1 * s2 + r1 * q2;
+    d[0] = q1 + s1;
+    d[1] = q2 + q1 * s1 + s2;
+    d[2] = q1 * s2 + q2 * s1;
+    d[3] = q2 * s2;
+    for (i = 0; i < 3; i++)
+        m[i] = n[i + 1] - d[i] * n[0];
+    m[3] = -d[3] * n[0];
+
+        /* Normalize to unit gain */
+    sumd = 1.0 + d[0] + d[1] + d[2] + d[3];
+    gain = (n[0] + n[1] + n[2] + n[3] + m[0] + m[1] + m[2] + m[3]) / sumd;
+    for (i = 0; i < 4; i++) {
+        cn[i] = (l_float32)(n[i] / gain);
+        cm[i] = (l_float32)(m[i] / gain);
+        cd[i] = (l_float32)d[i];
+    }
+    *pstartc = (l_float32)((n[0] + n[1] + n[2] + n[3]) / (gain * sumd));
+    *pstarta = (l_float32)((m[0] + m[1] + m[2] + m[3]) / (gain * sumd));
+    return;
+}
+
+
+/*!
+ *  mirrorIndex()
+ *
+ *      Input:  index (may be outside [0 ... n - 1])
+ *              n (size of line)
+ *      Return: index reflected into [0 ... n - 1]
+ *
+ *  Notes:
+ *      (1) The reflection repeats the end pixel, as in
+ *          fpixAddMirroredBorder(), and is repeated as often as
+ *          necessary for borders that are larger than the line.
+ */
+static l_int32
+mirrorIndex(l_int32  index,
+            l_int32  n)
+{
+    index %= 2 * n;
+    if (index < 0)
+        index += 2 * n;
+    return (index < n) ? index : 2 * n - 1 - index;
+}
@@ -45,6 +45,12 @@
 #include <math.h>
 #include "allheaders.h"
 
+    /* Relative costs, used by pixBestCorrelation() to choose between
+     * correlation with rasterops (per word and shift) and with the
+     * FFT (per pixel and factor of 2 in array size). */
+static const l_float64  CORREL_DIRECT_COST = 3.0;
+static const l_float64  CORREL_FFT_COST = 2.0;
+
 
 /* -------------------------------------------------------------------- *
  *           Optimized 2 pix correlators (for jbig2 clustering)         *
@@ -884,6 +890,10 @@ PIX       *pixt;
  *               (2 * maxshiftx + 1) * (2 * maxshifty + 1)
  *          Consequently, if pix1 and pix2 are large, you should do this
  *          in a coarse-to-fine sequence.
+ *      (4) For a large search range, it is faster to compute the
+ *          correlations for all shifts at once, using the FFT
+ *          (see pixCorrelationSurfaceFFT()).  This is done automatically
+ *          when it is estimated to be faster, and gives identical results.
  */
 l_int32
 pixBestCorrelation(PIX        *pix1,
@@ -899,9 +909,12 @@ pixBestCorrelation(PIX        *pix1,
                    l_float32  *pscore,
                    l_int32     debugflag)
 {
-l_int32    shiftx, shifty, delx, dely;
+l_int32    shiftx, shifty, delx, dely, w1, h1, w2, h2, wd, hd, nx, ny;
+l_int32    x, y, count;
 l_int32   *tab;
 l_float32  maxscore, score;
+l_float64  val, nshifts, directcost, fftcost;
+DPIX      *dpix;
 FPIX      *fpix;
 PIX       *pixt1, *pixt2;
 
@@ -926,15 +939,49 @@ PIX       *pixt1, *pixt2;
     else
         tab = tab8;
 
+        /* Rasterop correlation takes a few operations per 32-bit word
+         * for each shift; the FFT takes three transforms of an array
+         * padded to a power of 2 that is at least twice the size in
+         * each direction.  If the FFT is faster, get the pixel counts
+         * for every shift at once. */
+    pixGetDimensions(pix1, &w1, &h1, NULL);
+    pixGetDimensions(pix2, &w2, &h2, NULL);
+    wd = w1 + w2 - 1;
+    hd = h1 + h2 - 1;
+    for (nx = 2; nx < wd; nx <<= 1)
+        ;
+    for (ny = 1; ny < hd; ny <<= 1)
+        ;
+    nshifts = (2.0 * maxshift + 1.0) * (2.0 * maxshift + 1.0);
+    directcost = CORREL_DIRECT_COST * nshifts * (l_float64)w1 * h1 / 32.;
+    fftcost = CORREL_FFT_COST * (l_float64)nx * ny *
+              log((l_float64)nx * ny) / log(2.0);
+    dpix = NULL;
+    if (fftcost < directcost)
+        dpix = pixCorrelationSurfaceFFT(pix1, pix2);
+
         /* Search over a set of {shiftx, shifty} for the max */
     maxscore = 0;
     delx = etransx;
     dely = etransy;
     for (shifty = -maxshift; shifty <= maxshift; shifty++) {
         for (shiftx = -maxshift; shiftx <= maxshift; shiftx++) {
-            score = pixCorrelationScoreShifted(pix1, pix2, area1, area2,
-                                               etransx + shiftx,
-                                               etransy + shifty, tab);
+            if (dpix) {
+                x = etransx + shiftx + w2 - 1;
+                y = etransy + shifty + h2 - 1;
+                count = 0;
+                if (x >= 0 && x < wd && y >= 0 && y < hd) {
+                    dpixGetPixel(dpix, x, y, &val);
+                    count = (l_int32)(val + 0.5);
+                }
+                score = (l_float32)count * (l_float32)count /
+                         ((l_float32)area1 * (l_float32)area2);
+            }
+            else {
+                score = pixCorrelationScoreShifted(pix1, pix2, area1, area2,
+                                                   etransx + shiftx,
+                                                   etransy + shifty, tab);
+            }
             if (debugflag > 0) {
                 fpixSetPixel(fpix, maxshift + shiftx, maxshift + shifty,
                              1000.0 * score);
@@ -964,5 +1011,6 @@ PIX       *pixt1, *pixt2;
     *pdely = dely;
     if (pscore) *pscore = maxscore;
     if (!tab8) FREE(tab);
+    dpixDestroy(&dpix);
     return 0;
 }
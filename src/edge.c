@@ -29,6 +29,7 @@
  *
  *      Sobel edge detecting filter
  *          PIX      *pixSobelEdgeFilter()
+ *          static void  sobelUnpackLine()
  *
  *      Two-sided edge gradient filter
  *          PIX      *pixTwoSidedEdgeFilter()
@@ -56,8 +57,11 @@
  *  the edges dark, both for 8 bpp and 1 bpp.
  */
 
+#include <string.h>
 #include "allheaders.h"
 
+static void sobelUnpackLine(l_int32 *buf, l_uint32 *line, l_int32 w);
+
 
 /*----------------------------------------------------------------------*
  *                    Sobel edge detecting filter                       *
@@ -75,22 +79,27 @@
  *          the result using pixThresholdToBinary().  If the high
  *          edge values are to be fg (1), invert after running
  *          pixThresholdToBinary().
- *      (3) Label the pixels as follows:
- *              1    4    7
- *              2    5    8
- *              3    6    9
- *          Read the data incrementally across the image and unroll
- *          the loop.
- *      (4) This runs at about 45 Mpix/sec on a 3 GHz processor.
+ *      (3) Both filters are separable.  For horizontal edges, the
+ *          vertical difference of the lines above and below is
+ *          smoothed horizontally with (1, 2, 1); for vertical edges,
+ *          the (1, 2, 1) vertical smoothing of the three lines is
+ *          differenced horizontally.  The three lines are unpacked
+ *          once each into integer arrays, with a replicated pixel at
+ *          each end, and the lines above and below the image are
+ *          replicated from the first and last lines.  This gives the
+ *          same result as filtering the image with a 1 pixel mirrored
+ *          border, without making the bordered image.
+ *      (4) Each output line depends only on three input lines, so
+ *          any band of lines can be computed independently.
  */
 PIX *
 pixSobelEdgeFilter(PIX     *pixs,
                    l_int32  orientflag)
 {
-l_int32    w, h, d, i, j, wplt, wpld, gx, gy, vald;
-l_int32    val1, val2, val3, val4, val5, val6, val7, val8, val9;
-l_uint32  *datat, *linet, *datad, *lined;
-PIX       *pixt, *pixd;
+l_int32    w, h, d, i, j, wpls, wpld, gx, gy, vald;
+l_int32   *buf0, *buf1, *buf2, *bufa, *bufb, *bufc, *bufd;
+l_uint32  *datas, *datad, *lined;
+PIX       *pixd;
 
     PROCNAME("pixSobelEdgeFilter");
 
@@ -103,63 +112,118 @@ PIX       *pixt, *pixd;
         orientflag != L_ALL_EDGES)
         return (PIX *)ERROR_PTR("invalid orientflag", procName, NULL);
 
-        /* Add 1 pixel (mirrored) to each side of the image. */
-    if ((pixt = pixAddMirroredBorder(pixs, 1, 1, 1, 1)) == NULL)
-        return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+        /* Each buffer holds w + 2 values; buffer index j + 1
+         * corresponds to pixel j in the line. */
+    buf0 = (l_int32 *)CALLOC(w + 2, sizeof(l_int32));
+    buf1 = (l_int32 *)CALLOC(w + 2, sizeof(l_int32));
+    buf2 = (l_int32 *)CALLOC(w + 2, sizeof(l_int32));
+    bufd = (l_int32 *)CALLOC(w + 2, sizeof(l_int32));
+    if (!buf0 || !buf1 || !buf2 || !bufd) {
+        FREE(buf0);
+        FREE(buf1);
+        FREE(buf2);
+        FREE(bufd);
+        return (PIX *)ERROR_PTR("buffers not made", procName, NULL);
+    }
 
-        /* Compute filter output at each location. */
+        /* Compute filter output at each location.  bufa, bufb and
+         * bufc rotate through the three lines i - 1, i and i + 1. */
     pixd = pixCreateTemplate(pixs);
-    datat = pixGetData(pixt);
-    wplt = pixGetWpl(pixt);
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
     datad = pixGetData(pixd);
     wpld = pixGetWpl(pixd);
+    bufa = buf0;
+    bufb = buf1;
+    bufc = buf2;
+    sobelUnpackLine(bufb, datas, w);
+    memcpy(bufa, bufb, (w + 2) * sizeof(l_int32));
     for (i = 0; i < h; i++) {
-        linet = datat + i * wplt;
         lined = datad + i * wpld;
-        for (j = 0; j < w; j++) {
-            if (j == 0) {  /* start a new row */
-                val1 = GET_DATA_BYTE(linet, j);
-                val2 = GET_DATA_BYTE(linet + wplt, j);
-                val3 = GET_DATA_BYTE(linet + 2 * wplt, j);
-                val4 = GET_DATA_BYTE(linet, j + 1);
-                val5 = GET_DATA_BYTE(linet + wplt, j + 1);
-                val6 = GET_DATA_BYTE(linet + 2 * wplt, j + 1);
-                val7 = GET_DATA_BYTE(linet, j + 2);
-                val8 = GET_DATA_BYTE(linet + wplt, j + 2);
-                val9 = GET_DATA_BYTE(linet + 2 * wplt, j + 2);
-            } else {  /* shift right by 1 pixel; update incrementally */
-                val1 = val4;
-                val2 = val5;
-                val3 = val6;
-                val4 = val7;
-                val5 = val8;
-                val6 = val9;
-                val7 = GET_DATA_BYTE(linet, j + 2);
-                val8 = GET_DATA_BYTE(linet + wplt, j + 2);
-                val9 = GET_DATA_BYTE(linet + 2 * wplt, j + 2);
+        if (i < h - 1)
+            sobelUnpackLine(bufc, datas + (i + 1) * wpls, w);
+        else
+            memcpy(bufc, bufb, (w + 2) * sizeof(l_int32));
+
+        if (orientflag == L_HORIZONTAL_EDGES) {
+            for (j = 0; j < w + 2; j++)
+                bufd[j] = bufa[j] - bufc[j];
+            for (j = 0; j < w; j++) {
+                vald = L_ABS(bufd[j] + 2 * bufd[j + 1] + bufd[j + 2]) >> 3;
+                SET_DATA_BYTE(lined, j, vald);
             }
-            if (orientflag == L_HORIZONTAL_EDGES)
-                vald = L_ABS(val1 + 2 * val4 + val7
-                             - val3 - 2 * val6 - val9) >> 3;
-            else if (orientflag == L_VERTICAL_EDGES)
-                vald = L_ABS(val1 + 2 * val2 + val3 - val7
-                             - 2 * val8 - val9) >> 3;
-            else {  /* L_ALL_EDGES */
-                gx = L_ABS(val1 + 2 * val2 + val3 - val7
-                           - 2 * val8 - val9) >> 3;
-                gy = L_ABS(val1 + 2 * val4 + val7
-                             - val3 - 2 * val6 - val9) >> 3;
+        }
+        else if (orientflag == L_VERTICAL_EDGES) {
+            for (j = 0; j < w + 2; j++)
+                bufd[j] = bufa[j] + 2 * bufb[j] + bufc[j];
+            for (j = 0; j < w; j++) {
+                vald = L_ABS(bufd[j] - bufd[j + 2]) >> 3;
+                SET_DATA_BYTE(lined, j, vald);
+            }
+        }
+        else {  /* L_ALL_EDGES */
+            for (j = 0; j < w + 2; j++)
+                bufd[j] = bufa[j] + 2 * bufb[j] + bufc[j];
+            for (j = 0; j < w; j++) {
+                gx = L_ABS(bufd[j] - bufd[j + 2]) >> 3;
+                gy = L_ABS(bufa[j] - bufc[j] + 2 * (bufa[j + 1] - bufc[j + 1])
+                           + bufa[j + 2] - bufc[j + 2]) >> 3;
                 vald = L_MIN(255, gx + gy);
+                SET_DATA_BYTE(lined, j, vald);
             }
-            SET_DATA_BYTE(lined, j, vald);
         }
+
+            /* Rotate the line buffers */
+        buf0 = bufa;
+        bufa = bufb;
+        bufb = bufc;
+        bufc = buf0;
     }
 
-    pixDestroy(&pixt);
+    FREE(bufa);
+    FREE(bufb);
+    FREE(bufc);
+    FREE(bufd);
     return pixd;
 }
 
 
+/*!
+ *  sobelUnpackLine()
+ *
+ *      Input:  buf (array of w + 2 values)
+ *              line (8 bpp raster line)
+ *              w (number of pixels)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Pixel j goes to buf[j + 1], and the first and last
+ *          pixels are replicated in buf[0] and buf[w + 1].
+ */
+static void
+sobelUnpackLine(l_int32   *buf,
+                l_uint32  *line,
+                l_int32    w)
+{
+l_int32   j, nw;
+l_uint32  word;
+
+    nw = w >> 2;
+    for (j = 0; j < nw; j++) {
+        word = line[j];
+        buf[4 * j + 1] = word >> 24;
+        buf[4 * j + 2] = (word >> 16) & 0xff;
+        buf[4 * j + 3] = (word >> 8) & 0xff;
+        buf[4 * j + 4] = word & 0xff;
+    }
+    for (j = 4 * nw; j < w; j++)
+        buf[j + 1] = GET_DATA_BYTE(line, j);
+    buf[0] = buf[1];
+    buf[w + 1] = buf[w];
+    return;
+}
+
+
 /*----------------------------------------------------------------------*
  *                   Two-sided edge gradient filter                     *
  *----------------------------------------------------------------------*/
@@ -185,17 +249,17 @@ PIX       *pixt, *pixd;
  *          the result using pixThresholdToBinary().  If the high
  *          edge values are to be fg (1), invert after running
  *          pixThresholdToBinary().
- *      (3) This runs at about 60 Mpix/sec on a 3 GHz processor.
- *          It is about 30% faster than Sobel, and the results are
- *          similar.
+ *      (3) Both orientations scan the image in raster order, so
+ *          each output line depends only on the source line and
+ *          its two neighbors.  The results are similar to Sobel.
  */
 PIX *
 pixTwoSidedEdgeFilter(PIX     *pixs,
                       l_int32  orientflag)
 {
 l_int32    w, h, d, i, j, wpls, wpld;
-l_int32    cval, rval, bval, val, lgrad, rgrad, tgrad, bgrad;
-l_uint32  *datas, *lines, *datad, *lined;
+l_int32    cval, rval, val, lgrad, rgrad, tgrad, bgrad;
+l_uint32  *datas, *lines, *linet, *lineb, *datad, *lined;
 PIX       *pixd;
 
     PROCNAME("pixTwoSidedEdgeFilter");
@@ -235,15 +299,16 @@ PIX       *pixd;
         }
     }
     else {  /* L_HORIZONTAL_EDGES) */
-        for (j = 0; j < w; j++) {
-            lines = datas + wpls;
-            cval = GET_DATA_BYTE(lines, j);  /* for line 1 */
-            tgrad = cval - GET_DATA_BYTE(datas, j);
-            for (i = 1; i < h - 1; i++) {
-                lines += wpls;  /* for line i + 1 */
-                lined = datad + i * wpld;
-                bval = GET_DATA_BYTE(lines, j);
-                bgrad = bval - cval;
+            /* Scan in raster order, with the lines above and below. */
+        for (i = 1; i < h - 1; i++) {
+            linet = datas + (i - 1) * wpls;
+            lines = linet + wpls;
+            lineb = lines + wpls;
+            lined = datad + i * wpld;
+            for (j = 0; j < w; j++) {
+                cval = GET_DATA_BYTE(lines, j);
+                tgrad = cval - GET_DATA_BYTE(linet, j);
+                bgrad = GET_DATA_BYTE(lineb, j) - cval;
                 if (tgrad * bgrad > 0) {
                     if (tgrad < 0)
                         val = -L_MAX(tgrad, bgrad);
@@ -251,8 +316,6 @@ PIX       *pixd;
                         val = L_MIN(tgrad, bgrad);
                     SET_DATA_BYTE(lined, j, val);
                 }
-                tgrad = bgrad;
-                cval = bval;
             }
         }
     }
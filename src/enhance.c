@@ -41,9 +41,12 @@
  *      Histogram equalization
  *           PIX     *pixEqualizeTRC()
  *           NUMA    *numaEqualizeTRC()
+ *           static NUMA  *numaEqualizeTRCFromHisto()
  *
  *      Generic TRC mapper
- *           PIX     *pixTRCMap()
+ *           l_int32  pixTRCMap()
+ *           l_int32  pixTRCMapGeneral()
+ *           static l_int32  pixApplyTRCTables()
  *
  *      Unsharp-masking
  *           PIX     *pixUnsharpMasking()
@@ -52,6 +55,7 @@
  *           PIX     *pixUnsharpMaskingGrayFast()
  *           PIX     *pixUnsharpMaskingGray1D()
  *           PIX     *pixUnsharpMaskingGray2D()
+ *           static l_int32  unsharpGetFactor()
  *
  *      Hue and saturation modification
  *           PIX     *pixModifyHue()
@@ -105,6 +109,7 @@
  */
 
 
+#include <string.h>
 #include <math.h>
 #include "allheaders.h"
 
@@ -115,6 +120,12 @@ static const l_float32  ENHANCE_SCALE_FACTOR = 5.;
     /* Default number of pixels sampled to determine histogram */
 static const l_int32  DEFAULT_HISTO_SAMPLES = 100000;
 
+static l_int32 pixApplyTRCTables(PIX *pixs, PIX *pixm, NUMA *nar, NUMA *nag,
+                                 NUMA *nab, l_uint32 alphamask);
+static NUMA *numaEqualizeTRCFromHisto(NUMA *nah, l_float32 fract);
+static l_int32 unsharpGetFactor(l_float32 fract, l_int32 size,
+                                l_int32 *pshift);
+
 
 /*-------------------------------------------------------------*
  *         Gamma TRC (tone reproduction curve) mapping         *
@@ -284,7 +295,7 @@ NUMA    *nag;
  *  Notes:
  *      (1) See usage notes in pixGammaTRC().
  *      (2) This version saves the alpha channel.  It is only valid
- *          for 32 bpp (no colormap), and is a bit slower.
+ *          for 32 bpp (no colormap).
  */
 PIX *
 pixGammaTRCWithAlpha(PIX       *pixd,
@@ -294,7 +305,6 @@ pixGammaTRCWithAlpha(PIX       *pixd,
                      l_int32    maxval)
 {
 NUMA  *nag;
-PIX   *pixalpha;
 
     PROCNAME("pixGammaTRCWithAlpha");
 
@@ -312,17 +322,14 @@ PIX   *pixalpha;
     if (gamma == 1.0 && minval == 0 && maxval == 255)
         return pixCopy(pixd, pixs);
 
-    pixalpha = pixGetRGBComponent(pixs, L_ALPHA_CHANNEL);  /* save */
     if (!pixd)  /* start with a copy if not in-place */
         pixd = pixCopy(NULL, pixs);
 
     if ((nag = numaGammaTRC(gamma, minval, maxval)) == NULL)
         return (PIX *)ERROR_PTR("nag not made", procName, pixd);
-    pixTRCMap(pixd, NULL, nag);
-    pixSetRGBComponent(pixd, pixalpha, L_ALPHA_CHANNEL);  /* restore */
+    pixTRCMapGeneral(pixd, NULL, nag, nag, nag);  /* saves alpha */
 
     numaDestroy(&nag);
-    pixDestroy(&pixalpha);
     return pixd;
 }
 
@@ -603,8 +610,8 @@ pixEqualizeTRC(PIX       *pixd,
 	       l_int32    factor)
 {
 l_int32   d;
-NUMA     *na;
-PIX      *pixt, *pix8;
+NUMA     *na, *nar, *nag, *nab, *nahr, *nahg, *nahb;
+PIX      *pixt;
 PIXCMAP  *cmap;
 
     PROCNAME("pixEqualizeTRC");
@@ -641,25 +648,21 @@ PIXCMAP  *cmap;
         pixTRCMap(pixd, NULL, na);
         numaDestroy(&na);
     }
-    else {  /* 32 bpp */
-        pix8 = pixGetRGBComponent(pixd, COLOR_RED);
-        na = numaEqualizeTRC(pix8, fract, factor);
-        pixTRCMap(pix8, NULL, na);
-        pixSetRGBComponent(pixd, pix8, COLOR_RED);
-        numaDestroy(&na);
-        pixDestroy(&pix8);
-        pix8 = pixGetRGBComponent(pixd, COLOR_GREEN);
-        na = numaEqualizeTRC(pix8, fract, factor);
-        pixTRCMap(pix8, NULL, na);
-        pixSetRGBComponent(pixd, pix8, COLOR_GREEN);
-        numaDestroy(&na);
-        pixDestroy(&pix8);
-        pix8 = pixGetRGBComponent(pixd, COLOR_BLUE);
-        na = numaEqualizeTRC(pix8, fract, factor);
-        pixTRCMap(pix8, NULL, na);
-        pixSetRGBComponent(pixd, pix8, COLOR_BLUE);
-        numaDestroy(&na);
-        pixDestroy(&pix8);
+    else {  /* 32 bpp; map all three components in one pass */
+        pixGetColorHistogram(pixd, factor, &nahr, &nahg, &nahb);
+        nar = numaEqualizeTRCFromHisto(nahr, fract);
+        nag = numaEqualizeTRCFromHisto(nahg, fract);
+        nab = numaEqualizeTRCFromHisto(nahb, fract);
+        if (nar && nag && nab)
+            pixTRCMapGeneral(pixd, NULL, nar, nag, nab);
+        else
+            L_ERROR("equalization maps not made", procName);
+        numaDestroy(&nahr);
+        numaDestroy(&nahg);
+        numaDestroy(&nahb);
+        numaDestroy(&nar);
+        numaDestroy(&nag);
+        numaDestroy(&nab);
     }
 
     return pixd;
@@ -687,9 +690,7 @@ numaEqualizeTRC(PIX       *pix,
 		l_float32  fract,
 		l_int32    factor)
 {
-l_int32    iin, iout, itarg;
-l_float32  val, sum;
-NUMA      *nah, *nasum, *nad;
+NUMA  *nah, *nad;
 
     PROCNAME("numaEqualizeTRC");
 
@@ -707,9 +708,34 @@ NUMA      *nah, *nasum, *nad;
 
     if ((nah = pixGetGrayHistogram(pix, factor)) == NULL)
         return (NUMA *)ERROR_PTR("histogram not made", procName, NULL);
+    nad = numaEqualizeTRCFromHisto(nah, fract);
+    numaDestroy(&nah);
+    return nad;
+}
+
+
+/*!
+ *  numaEqualizeTRCFromHisto()
+ *
+ *      Input:  nah (256 entry histogram)
+ *              fract (fraction of equalization movement of pixel values)
+ *      Return: nad, or null on error
+ */
+static NUMA *
+numaEqualizeTRCFromHisto(NUMA      *nah,
+                         l_float32  fract)
+{
+l_int32    iin, iout, itarg;
+l_float32  val, sum;
+NUMA      *nasum, *nad;
+
+    PROCNAME("numaEqualizeTRCFromHisto");
+
+    if (!nah)
+        return (NUMA *)ERROR_PTR("nah not defined", procName, NULL);
+
     numaGetSum(nah, &sum);
     nasum = numaGetPartialSums(nah);
-
     nad = numaCreate(256);
     for (iin = 0; iin < 256; iin++) {
         numaGetFValue(nasum, iin, &val);
@@ -719,7 +745,6 @@ NUMA      *nah, *nasum, *nad;
         numaAddNumber(nad, iout);
     }
 
-    numaDestroy(&nah);
     numaDestroy(&nasum);
     return nad;
 }
@@ -734,7 +759,7 @@ NUMA      *nah, *nasum, *nad;
  *      Input:  pixs (8 grayscale or 32 bpp rgb; not colormapped)
  *              pixm (<optional> 1 bpp mask)
  *              na (mapping array)
- *      Return: pixd, or null on error
+ *      Return: 0 if OK, 1 on error
  *
  *  Notes:
  *      (1) This operation is in-place on pixs.
@@ -752,101 +777,120 @@ pixTRCMap(PIX   *pixs,
           PIX   *pixm,
           NUMA  *na)
 {
-l_int32    w, h, d, wm, hm, wpl, wplm, i, j, sval8, dval8;
-l_int32   *tab;
-l_uint32   sval32, dval32;
-l_uint32  *data, *datam, *line, *linem;
-
     PROCNAME("pixTRCMap");
 
     if (!pixs)
         return ERROR_INT("pixs not defined", procName, 1);
-    if (pixGetColormap(pixs))
-        return ERROR_INT("pixs is colormapped", procName, 1);
     if (!na)
         return ERROR_INT("na not defined", procName, 1);
-    if (numaGetCount(na) != 256)
-        return ERROR_INT("na not of size 256", procName, 1);
+    return pixApplyTRCTables(pixs, pixm, na, na, na, 0);
+}
+
+
+/*!
+ *  pixTRCMapGeneral()
+ *
+ *      Input:  pixs (8 grayscale or 32 bpp rgb; not colormapped)
+ *              pixm (<optional> 1 bpp mask)
+ *              nar, nag, nab (mapping arrays for r, g and b; for 8 bpp,
+ *                             only nar is used and the others can be null)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This operation is in-place on pixs.
+ *      (2) For 32 bpp, this applies a separate map to each of the r,g,b
+ *          components.  Unlike pixTRCMap(), the alpha channel is saved.
+ *      (3) Each mapping array is of size 256, and it maps the input
+ *          index into values in the range [0, 255].
+ *      (4) The optional mask is used as in pixTRCMap().
+ */
+l_int32
+pixTRCMapGeneral(PIX   *pixs,
+                 PIX   *pixm,
+                 NUMA  *nar,
+                 NUMA  *nag,
+                 NUMA  *nab)
+{
+    PROCNAME("pixTRCMapGeneral");
+
+    if (!pixs)
+        return ERROR_INT("pixs not defined", procName, 1);
+    if (!nar)
+        return ERROR_INT("nar not defined", procName, 1);
+    if (pixGetDepth(pixs) == 32 && (!nag || !nab))
+        return ERROR_INT("nag and nab not both defined", procName, 1);
+    return pixApplyTRCTables(pixs, pixm, nar, nag, nab, 0xff);
+}
+
+
+/*!
+ *  pixApplyTRCTables()
+ *
+ *      Input:  pixs (8 grayscale or 32 bpp rgb; not colormapped)
+ *              pixm (<optional> 1 bpp mask)
+ *              nar, nag, nab (mapping arrays; nag and nab are not used
+ *                             for 8 bpp)
+ *              alphamask (0xff to save the alpha channel; 0 to clear it)
+ *      Return: 0 if OK, 1 on error
+ */
+static l_int32
+pixApplyTRCTables(PIX      *pixs,
+                  PIX      *pixm,
+                  NUMA     *nar,
+                  NUMA     *nag,
+                  NUMA     *nab,
+                  l_uint32  alphamask)
+{
+l_int32    w, h, d, wm, hm, wpl, wplm, i, n, val;
+l_uint8    rtab[256], gtab[256], btab[256];
+l_uint32  *data, *datam, *line;
+
+    PROCNAME("pixApplyTRCTables");
+
+    if (pixGetColormap(pixs))
+        return ERROR_INT("pixs is colormapped", procName, 1);
     pixGetDimensions(pixs, &w, &h, &d);
     if (d != 8 && d != 32)
         return ERROR_INT("pixs not 8 or 32 bpp", procName, 1);
+    if (numaGetCount(nar) != 256 ||
+        (d == 32 && (numaGetCount(nag) != 256 || numaGetCount(nab) != 256)))
+        return ERROR_INT("na not of size 256", procName, 1);
     if (pixm) {
         if (pixGetDepth(pixm) != 1)
             return ERROR_INT("pixm not 1 bpp", procName, 1);
     }
 
-    tab = numaGetIArray(na);  /* get the array for efficiency */
+    for (i = 0; i < 256; i++) {
+        numaGetIValue(nar, i, &val);
+        rtab[i] = (l_uint8)val;
+        if (d == 32) {
+            numaGetIValue(nag, i, &val);
+            gtab[i] = (l_uint8)val;
+            numaGetIValue(nab, i, &val);
+            btab[i] = (l_uint8)val;
+        }
+    }
+
     wpl = pixGetWpl(pixs);
     data = pixGetData(pixs);
     if (!pixm) {
-        if (d == 8) {
-            for (i = 0; i < h; i++) {
-                line = data + i * wpl;
-                for (j = 0; j < w; j++) {
-                    sval8 = GET_DATA_BYTE(line, j);
-                    dval8 = tab[sval8];
-                    SET_DATA_BYTE(line, j, dval8);
-                }
-            }
-        }
-        else {  /* d == 32 */
-            for (i = 0; i < h; i++) {
-                line = data + i * wpl;
-                for (j = 0; j < w; j++) {
-                    sval32 = *(line + j);
-                    dval32 =
-                        tab[(sval32 >> L_RED_SHIFT) & 0xff] << L_RED_SHIFT |
-                        tab[(sval32 >> L_GREEN_SHIFT) & 0xff] << L_GREEN_SHIFT |
-                        tab[(sval32 >> L_BLUE_SHIFT) & 0xff] << L_BLUE_SHIFT;
-                    *(line + j) = dval32;
-                }
-            }
+        for (i = 0; i < h; i++) {
+            line = data + i * wpl;
+            lutApplyLineLow(line, line, d, 0, w, rtab, gtab, btab, alphamask);
         }
     }
     else {
         datam = pixGetData(pixm);
         wplm = pixGetWpl(pixm);
         pixGetDimensions(pixm, &wm, &hm, NULL);
-        if (d == 8) {
-            for (i = 0; i < h; i++) {
-                if (i >= hm)
-                    break;
-                line = data + i * wpl;
-                linem = datam + i * wplm;
-                for (j = 0; j < w; j++) {
-                    if (j >= wm)
-                        break;
-                    if (GET_DATA_BIT(linem, j) == 0)
-                        continue;
-                    sval8 = GET_DATA_BYTE(line, j);
-                    dval8 = tab[sval8];
-                    SET_DATA_BYTE(line, j, dval8);
-                }
-            }
-        }
-        else {  /* d == 32 */
-            for (i = 0; i < h; i++) {
-                if (i >= hm)
-                    break;
-                line = data + i * wpl;
-                linem = datam + i * wplm;
-                for (j = 0; j < w; j++) {
-                    if (j >= wm)
-                        break;
-                    if (GET_DATA_BIT(linem, j) == 0)
-                        continue;
-                    sval32 = *(line + j);
-                    dval32 =
-                        tab[(sval32 >> L_RED_SHIFT) & 0xff] << L_RED_SHIFT |
-                        tab[(sval32 >> L_GREEN_SHIFT) & 0xff] << L_GREEN_SHIFT |
-                        tab[(sval32 >> L_BLUE_SHIFT) & 0xff] << L_BLUE_SHIFT;
-                    *(line + j) = dval32;
-                }
-            }
+        n = L_MIN(w, wm);
+        for (i = 0; i < h && i < hm; i++) {
+            line = data + i * wpl;
+            lutApplyLineMaskedLow(line, line, datam + i * wplm, d, n,
+                                  rtab, gtab, btab, alphamask);
         }
     }
 
-    FREE(tab);
     return 0;
 }
 
@@ -1026,10 +1070,14 @@ PIXACC  *pixacc;
  *              N = I + fract * H
  *      (5) For 2D, the sharpening filter is not separable, because the
  *          vertical filter depends on the horizontal location relative
- *          to the filter origin, and v.v.   So we either do the full
- *          2D filter (for @halfwidth == 1) or do the low-pass
+ *          to the filter origin, and v.v.   So we do the low-pass
  *          convolution separably and then compose with the original pix.
  *      (6) Returns a clone if no sharpening is requested.
+ *      (7) All the arithmetic is in fixed point, with a single line
+ *          of column sums for the low-pass filter; see enhancelow.c.
+ *          The result can differ by 1 from that of a floating point
+ *          computation where the exact value is very close to an
+ *          integer.
  */
 PIX *
 pixUnsharpMaskingFast(PIX       *pixs,
@@ -1151,10 +1199,9 @@ pixUnsharpMaskingGray1D(PIX       *pixs,
                         l_float32  fract,
                         l_int32    direction)
 {
-l_int32    w, h, d, wpls, wpld, i, j, ival;
-l_uint32  *datas, *datad;
-l_uint32  *lines, *lines0, *lines1, *lines2, *lines3, *lines4, *lined;
-l_float32  val, a[5];
+l_int32    w, h, d, wpls, wpld, i, size, factor, shift;
+l_int32   *sums;
+l_uint32  *datas, *datad, *lines, *lined;
 PIX       *pixd;
 
     PROCNAME("pixUnsharpMaskingGray1D");
@@ -1179,91 +1226,37 @@ PIX       *pixd;
     datad = pixGetData(pixd);
     wpls = pixGetWpl(pixs);
     wpld = pixGetWpl(pixd);
-
-    if (halfwidth == 1) {
-        a[0] = -fract / 3.0;
-        a[1] = 1.0 + fract * 2.0 / 3.0;
-        a[2] = a[0];
-    }
-    else {  /* halfwidth == 2 */
-        a[0] = -fract / 5.0;
-        a[1] = a[0];
-        a[2] = 1.0 + fract * 4.0 / 5.0;
-        a[3] = a[0];
-        a[4] = a[0];
-    }
+    if ((sums = (l_int32 *)CALLOC(w, sizeof(l_int32))) == NULL)
+        return (PIX *)ERROR_PTR("sums not made", procName, pixd);
+    size = 2 * halfwidth + 1;
+    factor = unsharpGetFactor(fract, size, &shift);
 
     if (direction == L_HORIZ) {
         for (i = 0; i < h; i++) {
             lines = datas + i * wpls;
             lined = datad + i * wpld;
-            if (halfwidth == 1) {
-                for (j = 1; j < w - 1; j++) {
-                    val = a[0] * GET_DATA_BYTE(lines, j - 1) +
-                          a[1] * GET_DATA_BYTE(lines, j) +
-                          a[2] * GET_DATA_BYTE(lines, j + 1);
-                    ival = (l_int32)val;
-                    ival = L_MAX(0, ival);
-                    ival = L_MIN(255, ival);
-                    SET_DATA_BYTE(lined, j, ival);
-                }
-            }
-            else {  /* halfwidth == 2 */
-                for (j = 2; j < w - 2; j++) {
-                    val = a[0] * GET_DATA_BYTE(lines, j - 2) +
-                          a[1] * GET_DATA_BYTE(lines, j - 1) +
-                          a[2] * GET_DATA_BYTE(lines, j) +
-                          a[3] * GET_DATA_BYTE(lines, j + 1) +
-                          a[4] * GET_DATA_BYTE(lines, j + 2);
-                    ival = (l_int32)val;
-                    ival = L_MAX(0, ival);
-                    ival = L_MIN(255, ival);
-                    SET_DATA_BYTE(lined, j, ival);
-                }
-            }
+            memset(sums, 0, w * sizeof(l_int32));
+            sumLineBytesLow(sums, lines, w, L_ARITH_ADD);
+            unsharpMaskLineLow(lined, lines, sums, w, halfwidth, size,
+                               factor, shift, 0);
         }
     }
     else {  /* direction == L_VERT */
-        if (halfwidth == 1) {
-            for (i = 1; i < h - 1; i++) {
-                lines0 = datas + (i - 1) * wpls;
-                lines1 = datas + i * wpls;
-                lines2 = datas + (i + 1) * wpls;
-                lined = datad + i * wpld;
-                for (j = 0; j < w; j++) {
-                    val = a[0] * GET_DATA_BYTE(lines0, j) +
-                          a[1] * GET_DATA_BYTE(lines1, j) +
-                          a[2] * GET_DATA_BYTE(lines2, j);
-                    ival = (l_int32)val;
-                    ival = L_MAX(0, ival);
-                    ival = L_MIN(255, ival);
-                    SET_DATA_BYTE(lined, j, ival);
-                }
-            }
-        }
-        else {  /* halfwidth == 2 */
-            for (i = 2; i < h - 2; i++) {
-                lines0 = datas + (i - 2) * wpls;
-                lines1 = datas + (i - 1) * wpls;
-                lines2 = datas + i * wpls;
-                lines3 = datas + (i + 1) * wpls;
-                lines4 = datas + (i + 2) * wpls;
-                lined = datad + i * wpld;
-                for (j = 0; j < w; j++) {
-                    val = a[0] * GET_DATA_BYTE(lines0, j) +
-                          a[1] * GET_DATA_BYTE(lines1, j) +
-                          a[2] * GET_DATA_BYTE(lines2, j) +
-                          a[3] * GET_DATA_BYTE(lines3, j) +
-                          a[4] * GET_DATA_BYTE(lines4, j);
-                    ival = (l_int32)val;
-                    ival = L_MAX(0, ival);
-                    ival = L_MIN(255, ival);
-                    SET_DATA_BYTE(lined, j, ival);
-                }
-            }
+            /* Column sums over lines i - halfwidth ... i + halfwidth */
+        for (i = 0; i < size - 1 && i < h; i++)
+            sumLineBytesLow(sums, datas + i * wpls, w, L_ARITH_ADD);
+        for (i = halfwidth; i < h - halfwidth; i++) {
+            lines = datas + i * wpls;
+            lined = datad + i * wpld;
+            sumLineBytesLow(sums, lines + halfwidth * wpls, w, L_ARITH_ADD);
+            unsharpMaskLineLow(lined, lines, sums, w, 0, size,
+                               factor, shift, 0);
+            sumLineBytesLow(sums, lines - halfwidth * wpls, w,
+                            L_ARITH_SUBTRACT);
         }
     }
 
+    FREE(sums);
     return pixd;
 }
 
@@ -1277,9 +1270,10 @@ PIX       *pixd;
  *      Return: pixd, or null on error
  *
  *  Notes:
- *      (1) For halfwidth == 1, we implement the full sharpening filter
- *          directly.  For halfwidth == 2, we implement the the lowpass
- *          filter separably and then compute the sharpening result locally.
+ *      (1) For both halfwidths, we implement the lowpass filter
+ *          separably, with incrementally updated column sums, and
+ *          then compute the sharpening result locally in fixed point.
+ *          There is no intermediate image.
  *      (2) Returns a clone if no sharpening is requested.
  */
 PIX *
@@ -1287,12 +1281,10 @@ pixUnsharpMaskingGray2D(PIX       *pixs,
                         l_int32    halfwidth,
                         l_float32  fract)
 {
-l_int32     w, h, d, wpls, wpld, wplf, i, j, ival, sval;
-l_uint32   *datas, *datad, *lines, *lines0, *lines1, *lines2, *lined;
-l_float32   val, a[9];
-l_float32  *dataf, *linef, *linef0, *linef1, *linef2, *linef3, *linef4;
-PIX        *pixd;
-FPIX       *fpix;
+l_int32    w, h, d, wpls, wpld, i, size, factor, shift;
+l_int32   *sums;
+l_uint32  *datas, *datad, *lines, *lined;
+PIX       *pixd;
 
     PROCNAME("pixUnsharpMaskingGray2D");
 
@@ -1314,86 +1306,65 @@ FPIX       *fpix;
     wpld = pixGetWpl(pixd);
     datas = pixGetData(pixs);
     wpls = pixGetWpl(pixs);
+    if ((sums = (l_int32 *)CALLOC(w, sizeof(l_int32))) == NULL)
+        return (PIX *)ERROR_PTR("sums not made", procName, pixd);
+    size = (2 * halfwidth + 1) * (2 * halfwidth + 1);
+    factor = unsharpGetFactor(fract, size, &shift);
 
-    if (halfwidth == 1) {
-        for (i = 0; i < 9; i++)
-            a[i] = -fract / 9.0;
-        a[4] = 1.0 + fract * 8.0 / 9.0;
-        for (i = 1; i < h - 1; i++) {
-            lines0 = datas + (i - 1) * wpls;
-            lines1 = datas + i * wpls;
-            lines2 = datas + (i + 1) * wpls;
-            lined = datad + i * wpld;
-            for (j = 1; j < w - 1; j++) {
-                val = a[0] * GET_DATA_BYTE(lines0, j - 1) +
-                      a[1] * GET_DATA_BYTE(lines0, j) +
-                      a[2] * GET_DATA_BYTE(lines0, j + 1) +
-                      a[3] * GET_DATA_BYTE(lines1, j - 1) +
-                      a[4] * GET_DATA_BYTE(lines1, j) +
-                      a[5] * GET_DATA_BYTE(lines1, j + 1) +
-                      a[6] * GET_DATA_BYTE(lines2, j - 1) +
-                      a[7] * GET_DATA_BYTE(lines2, j) +
-                      a[8] * GET_DATA_BYTE(lines2, j + 1);
-                ival = (l_int32)(val + 0.5);
-                ival = L_MAX(0, ival);
-                ival = L_MIN(255, ival);
-                SET_DATA_BYTE(lined, j, ival);
-            }
-        }
-
-        return pixd;
-    }
-
-        /* For halfwidth == 2, do the low pass separably.  Store
-         * the result of horizontal smoothing in an intermediate fpix. */
-    fpix = fpixCreate(w, h);
-    dataf = fpixGetData(fpix);
-    wplf = fpixGetWpl(fpix);
-    for (i = 2; i < h - 2; i++) {
-        lines = datas + i * wpls;
-        linef = dataf + i * wplf;
-        for (j = 2; j < w - 2; j++) {
-            val = GET_DATA_BYTE(lines, j - 2) +
-                  GET_DATA_BYTE(lines, j - 1) +
-                  GET_DATA_BYTE(lines, j) +
-                  GET_DATA_BYTE(lines, j + 1) +
-                  GET_DATA_BYTE(lines, j + 2);
-            linef[j] = val;
-        }
-    }
-
-        /* Do vertical smoothing to finish the low-pass filter.
-         * At each pixel, if L is the lowpass value, I is the
+        /* At each pixel, if L is the lowpass value, I is the
          * src pixel value and f is the fraction of highpass to
          * be added to I, then the highpass filter value is
          *     H = I - L
          * and the new sharpened value is
          *     N = I + f * H.
-         */
-    for (i = 2; i < h - 2; i++) {
-        linef0 = dataf + (i - 2) * wplf;
-        linef1 = dataf + (i - 1) * wplf;
-        linef2 = dataf + i * wplf;
-        linef3 = dataf + (i + 1) * wplf;
-        linef4 = dataf + (i + 2) * wplf;
-        lined = datad + i * wpld;
+         * The column sums over lines i - halfwidth ... i + halfwidth
+         * are updated incrementally, and summed horizontally
+         * along each line to get the lowpass filter value. */
+    for (i = 0; i < 2 * halfwidth && i < h; i++)
+        sumLineBytesLow(sums, datas + i * wpls, w, L_ARITH_ADD);
+    for (i = halfwidth; i < h - halfwidth; i++) {
         lines = datas + i * wpls;
-        for (j = 2; j < w - 2; j++) {
-            val = 0.04 * (linef0[j] + linef1[j] + linef2[j] +
-                          linef3[j] + linef4[j]);  /* L: lowpass filter value */
-            sval = GET_DATA_BYTE(lines, j);   /* I: source pixel */
-            ival = (l_int32)(sval + fract * (sval - val) + 0.5);
-            ival = L_MAX(0, ival);
-            ival = L_MIN(255, ival);
-            SET_DATA_BYTE(lined, j, ival);
-        }
+        lined = datad + i * wpld;
+        sumLineBytesLow(sums, lines + halfwidth * wpls, w, L_ARITH_ADD);
+        unsharpMaskLineLow(lined, lines, sums, w, halfwidth, size,
+                           factor, shift, 1);
+        sumLineBytesLow(sums, lines - halfwidth * wpls, w, L_ARITH_SUBTRACT);
     }
 
-    fpixDestroy(&fpix);
+    FREE(sums);
     return pixd;
 }
 
 
+/*!
+ *  unsharpGetFactor()
+ *
+ *      Input:  fract  (fraction of high frequency added to image)
+ *              size (number of pixels in the lowpass filter window)
+ *              &shift (<return> number of fractional bits in the factor)
+ *      Return: factor (fixed-point representation of fract / size)
+ *
+ *  Notes:
+ *      (1) Up to 16 fractional bits are used; fewer only if that is
+ *          required to keep the intermediate values in
+ *          unsharpMaskLineLow() from overflowing, which happens
+ *          only for unreasonably large values of @fract.
+ */
+static l_int32
+unsharpGetFactor(l_float32  fract,
+                 l_int32    size,
+                 l_int32   *pshift)
+{
+l_int32  shift;
+
+    shift = 16;
+    while (shift > 1 && 255.0 * (1.0 + fract) * (1 << shift) > 2.0e9)
+        shift--;
+    *pshift = shift;
+    return (l_int32)(fract * (1 << shift) / size + 0.5);
+}
+
+
 
 /*-----------------------------------------------------------------------*
  *                    Hue and saturation modification                    *
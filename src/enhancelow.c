@@ -0,0 +1,314 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  enhancelow.c
+ *
+ *      Lookup table application, for 8 bpp and 32 bpp rgb
+ *              void       lutApplyLineLow()
+ *              void       lutApplyLineMaskedLow()
+ *
+ *      Fixed-point unsharp masking, for 8 bpp
+ *              void       sumLineBytesLow()
+ *              void       unsharpMaskLineLow()
+ *
+ *  These are the inner loops for all the TRC (tone reproduction curve)
+ *  operations: pixTRCMap() and pixTRCMapGeneral() in enhance.c, and
+ *  the callers of these, as well as pixThresholdGrayArb() in
+ *  grayquant.c and pixLinearTRCTiled() in adaptmap.c.
+ *
+ *  For 8 bpp, the pixels are read and written a 32-bit word at a
+ *  time, so that 4 pixels are mapped for each load and store.
+ *  Because every byte in the word goes through the same table, this
+ *  does not depend on the byte order of the machine.  For 32 bpp,
+ *  each component has its own table.
+ *
+ *  The masked version skips 32 pixels at a time under mask words
+ *  that are all 0, and maps 32 pixels with the unmasked kernel under
+ *  mask words that are all 1.
+ *
+ *  The unsharp masking functions in enhance.c compute, at each pixel
+ *  with value I, the sharpened value
+ *       N = I + f * (I - L)
+ *  where L is the average of the pixels in a 1 x n, n x 1 or n x n
+ *  window about the pixel.  With size = number of pixels in the
+ *  window and S = sum of those pixels, this is
+ *       N = I + (f / size) * (size * I - S)
+ *  which is evaluated entirely in integer arithmetic, with f / size
+ *  represented as a fixed-point factor.  The window sums are made
+ *  separably: column sums over the vertical extent of the window are
+ *  kept in an array that is updated incrementally as the window moves
+ *  down by one line (sumLineBytesLow()), and the horizontal sum of
+ *  these column sums is made with a running sum along the line
+ *  (unsharpMaskLineLow()).  Nothing is stored but a single line
+ *  of column sums.
+ *
+ *  Each call handles a single raster line, and lines are independent,
+ *  so a caller is free to process any set of lines (e.g., a band
+ *  of the image) in any order.
+ */
+
+#include "allheaders.h"
+
+
+/*------------------------------------------------------------------*
+ *                    Lookup table application                      *
+ *------------------------------------------------------------------*/
+/*!
+ *  lutApplyLineLow()
+ *
+ *      Input:  lined (dest raster line; can be equal to lines)
+ *              lines (src raster line)
+ *              d (8 or 32)
+ *              x (first pixel to be mapped)
+ *              n (number of pixels to be mapped)
+ *              rtab (table for 8 bpp, or for the red component)
+ *              gtab, btab (tables for green and blue; ignored for 8 bpp)
+ *              alphamask (0xff to keep the alpha byte for 32 bpp; 0 to
+ *                         set it to 0; ignored for 8 bpp)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Pixels x, ... x + n - 1 of lined are set to the mapped
+ *          values of the same pixels in lines.
+ */
+void
+lutApplyLineLow(l_uint32  *lined,
+                l_uint32  *lines,
+                l_int32    d,
+                l_int32    x,
+                l_int32    n,
+                l_uint8   *rtab,
+                l_uint8   *gtab,
+                l_uint8   *btab,
+                l_uint32   alphamask)
+{
+l_int32   j, end;
+l_uint32  word;
+
+    end = x + n;
+    if (d == 8) {
+        for (j = x; j < end && (j & 3); j++)
+            SET_DATA_BYTE(lined, j, rtab[GET_DATA_BYTE(lines, j)]);
+        for (; j + 4 <= end; j += 4) {
+            word = lines[j >> 2];
+            lined[j >> 2] = ((l_uint32)rtab[word >> 24] << 24) |
+                            ((l_uint32)rtab[(word >> 16) & 0xff] << 16) |
+                            ((l_uint32)rtab[(word >> 8) & 0xff] << 8) |
+                            (l_uint32)rtab[word & 0xff];
+        }
+        for (; j < end; j++)
+            SET_DATA_BYTE(lined, j, rtab[GET_DATA_BYTE(lines, j)]);
+    }
+    else {  /* d == 32 */
+        for (j = x; j < end; j++) {
+            word = lines[j];
+            lined[j] = ((l_uint32)rtab[(word >> L_RED_SHIFT) & 0xff]
+                            << L_RED_SHIFT) |
+                       ((l_uint32)gtab[(word >> L_GREEN_SHIFT) & 0xff]
+                            << L_GREEN_SHIFT) |
+                       ((l_uint32)btab[(word >> L_BLUE_SHIFT) & 0xff]
+                            << L_BLUE_SHIFT) |
+                       (word & (alphamask << L_ALPHA_SHIFT));
+        }
+    }
+    return;
+}
+
+
+/*!
+ *  lutApplyLineMaskedLow()
+ *
+ *      Input:  lined (dest raster line; can be equal to lines)
+ *              lines (src raster line)
+ *              linem (1 bpp mask raster line)
+ *              d (8 or 32)
+ *              n (number of pixels, starting at 0, to be considered)
+ *              rtab, gtab, btab, alphamask (see lutApplyLineLow())
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Of pixels 0, ... n - 1, only those under fg pixels of the
+ *          mask are mapped; the others in lined are not changed.
+ */
+void
+lutApplyLineMaskedLow(l_uint32  *lined,
+                      l_uint32  *lines,
+                      l_uint32  *linem,
+                      l_int32    d,
+                      l_int32    n,
+                      l_uint8   *rtab,
+                      l_uint8   *gtab,
+                      l_uint8   *btab,
+                      l_uint32   alphamask)
+{
+l_int32   j, k, jend;
+l_uint32  mword, word;
+
+    for (k = 0; 32 * k < n; k++) {
+        if ((mword = linem[k]) == 0)
+            continue;
+        j = 32 * k;
+        jend = L_MIN(j + 32, n);
+        if (mword == 0xffffffff) {
+            lutApplyLineLow(lined, lines, d, j, jend - j,
+                            rtab, gtab, btab, alphamask);
+            continue;
+        }
+        for (; j < jend; j++) {
+            if (!GET_DATA_BIT(linem, j))
+                continue;
+            if (d == 8) {
+                SET_DATA_BYTE(lined, j, rtab[GET_DATA_BYTE(lines, j)]);
+            }
+            else {
+                word = lines[j];
+                lined[j] = ((l_uint32)rtab[(word >> L_RED_SHIFT) & 0xff]
+                                << L_RED_SHIFT) |
+                           ((l_uint32)gtab[(word >> L_GREEN_SHIFT) & 0xff]
+                                << L_GREEN_SHIFT) |
+                           ((l_uint32)btab[(word >> L_BLUE_SHIFT) & 0xff]
+                                << L_BLUE_SHIFT) |
+                           (word & (alphamask << L_ALPHA_SHIFT));
+            }
+        }
+    }
+    return;
+}
+
+
+/*------------------------------------------------------------------*
+ *                Fixed-point unsharp masking (8 bpp)               *
+ *------------------------------------------------------------------*/
+/*!
+ *  sumLineBytesLow()
+ *
+ *      Input:  sums (array of w column sums)
+ *              line (8 bpp raster line)
+ *              w (number of pixels)
+ *              op (L_ARITH_ADD or L_ARITH_SUBTRACT)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Each pixel value in line is added to (or subtracted from)
+ *          the corresponding entry in sums.
+ *      (2) Full words are read 4 pixels at a time.  The first pixel
+ *          is in the MSB of the word, independent of the byte order
+ *          of the machine.
+ */
+void
+sumLineBytesLow(l_int32   *sums,
+                l_uint32  *line,
+                l_int32    w,
+                l_int32    op)
+{
+l_int32   j, nw;
+l_uint32  word;
+
+    nw = w >> 2;
+    if (op == L_ARITH_ADD) {
+        for (j = 0; j < nw; j++, sums += 4) {
+            word = line[j];
+            sums[0] += word >> 24;
+            sums[1] += (word >> 16) & 0xff;
+            sums[2] += (word >> 8) & 0xff;
+            sums[3] += word & 0xff;
+        }
+        for (j = 4 * nw; j < w; j++, sums++)
+            *sums += GET_DATA_BYTE(line, j);
+    }
+    else {  /* op == L_ARITH_SUBTRACT */
+        for (j = 0; j < nw; j++, sums += 4) {
+            word = line[j];
+            sums[0] -= word >> 24;
+            sums[1] -= (word >> 16) & 0xff;
+            sums[2] -= (word >> 8) & 0xff;
+            sums[3] -= word & 0xff;
+        }
+        for (j = 4 * nw; j < w; j++, sums++)
+            *sums -= GET_DATA_BYTE(line, j);
+    }
+    return;
+}
+
+
+/*!
+ *  unsharpMaskLineLow()
+ *
+ *      Input:  lined (dest raster line)
+ *              lines (src raster line)
+ *              sums (array of w column sums over the vertical extent
+ *                    of the window)
+ *              w (number of pixels)
+ *              halfwidth (horizontal half-width of the window; 0 if
+ *                         the window is a single column)
+ *              size (number of pixels in the window)
+ *              factor (fixed-point value of fract / size)
+ *              shift (number of fractional bits in factor)
+ *              roundflag (1 to round the result; 0 to truncate)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Pixels halfwidth, ... w - halfwidth - 1 of lined are set;
+ *          the others are not changed.
+ *      (2) The caller must choose shift so that
+ *              255 * (2^shift + size * factor)
+ *          fits in 31 bits.
+ *      (3) Negative results are clipped to 0 before the shift, so
+ *          truncation is always toward zero.
+ */
+void
+unsharpMaskLineLow(l_uint32  *lined,
+                   l_uint32  *lines,
+                   l_int32   *sums,
+                   l_int32    w,
+                   l_int32    halfwidth,
+                   l_int32    size,
+                   l_int32    factor,
+                   l_int32    shift,
+                   l_int32    roundflag)
+{
+l_int32  j, sum, sval, val, half;
+
+    if (w < 2 * halfwidth + 1)
+        return;
+    half = (roundflag) ? 1 << (shift - 1) : 0;
+    for (j = 0, sum = 0; j < 2 * halfwidth; j++)
+        sum += sums[j];
+    for (j = halfwidth; j < w - halfwidth; j++) {
+        sum += sums[j + halfwidth];
+        sval = GET_DATA_BYTE(lines, j);
+        val = (sval << shift) + factor * (size * sval - sum) + half;
+        if (val < 0)
+            val = 0;
+        else
+            val = L_MIN(255, val >> shift);
+        SET_DATA_BYTE(lined, j, val);
+        sum -= sums[j - halfwidth];
+    }
+    return;
+}
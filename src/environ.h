@@ -151,6 +151,8 @@ typedef short                   l_int16;
 typedef unsigned short          l_uint16;
 typedef int                     l_int32;
 typedef unsigned int            l_uint32;
+typedef long long               l_int64;
+typedef unsigned long long      l_uint64;
 typedef float                   l_float32;
 typedef double                  l_float64;
 
@@ -0,0 +1,766 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  fft.c
+ *
+ *      Fast Fourier transform of real 2-D arrays
+ *          static l_float64  *fftReal2DForward()
+ *          static l_int32     fftReal2DInverse()
+ *          static l_int32     fftGetSize()
+ *
+ *      FFTPlan cache
+ *          void               fftClearPlanCache()
+ *          static L_FFTPLAN  *fftGetPlan()
+ *          static L_FFTPLAN  *fftPlanCreate()
+ *          static void        fftPlanDestroy()
+ *          static void        fftComplex1D()
+ *
+ *      Convolution using the FFT
+ *          FPIX              *fpixConvolveFFT()
+ *
+ *      Cross-correlation using the FFT
+ *          DPIX              *pixCorrelationSurfaceFFT()
+ *
+ *      Generic convolution (fpixConvolve(), pixConvolve()) and
+ *      the search for the best correlation (pixBestCorrelation())
+ *      take time proportional to the area of the kernel or the
+ *      number of shifts, respectively.  The functions here do the same
+ *      operations in the frequency domain, where the time is
+ *      proportional to N * log(N) for an image of N pixels,
+ *      independent of the kernel size or the search range.
+ *
+ *      The transform is a self-contained radix-2 complex FFT,
+ *      with pairs of real rows packed into the real and imaginary
+ *      parts of a single complex row for the real-to-complex
+ *      transform.  Only the (w/2 + 1) non-redundant columns of the
+ *      spectrum are kept.  All arithmetic is in double precision,
+ *      so that correlations of binary images give exact integer counts.
+ *
+ *      The twiddle factors and bit-reversal table for each transform
+ *      size are computed once and held in a small cache, which can
+ *      be freed with fftClearPlanCache().
+ */
+
+#include <math.h>
+#include "allheaders.h"
+
+#ifndef  M_PI
+#define  M_PI   3.14159265358979323846
+#endif  /* M_PI */
+
+    /* Sampling factors for generic convolution; see convolve.c */
+extern l_int32  ConvolveSamplingFactX;
+extern l_int32  ConvolveSamplingFactY;
+
+    /* Plan for a complex FFT of size n, where n is a power of 2 */
+struct L_FftPlan
+{
+    l_int32     n;          /* size of the transform                      */
+    l_int32    *bitrev;     /* bit-reversal permutation                   */
+    l_float64  *costab;     /* cos(2 * pi * k / n), for k < n/2           */
+    l_float64  *sintab;     /* sin(2 * pi * k / n), for k < n/2           */
+};
+typedef struct L_FftPlan  L_FFTPLAN;
+
+    /* Direction of the transform */
+enum {
+    L_FFT_FORWARD = 1,
+    L_FFT_INVERSE = -1
+};
+
+    /* Plans are retained for the most recently used sizes */
+#define  MAX_CACHED_PLANS    8
+static L_FFTPLAN  *FftPlanCache[MAX_CACHED_PLANS];
+static l_int32     FftPlanNext = 0;
+
+static l_float64 *fftReal2DForward(l_float64 *datas, l_int32 nx, l_int32 ny);
+static l_int32 fftReal2DInverse(l_float64 *spec, l_int32 nx, l_int32 ny,
+                                l_float64 *datad);
+static l_int32 fftGetSize(l_int32 n);
+static L_FFTPLAN *fftGetPlan(l_int32 n, L_FFTPLAN *keep);
+static L_FFTPLAN *fftPlanCreate(l_int32 n);
+static void fftPlanDestroy(L_FFTPLAN **pplan);
+static void fftComplex1D(L_FFTPLAN *plan, l_float64 *z, l_int32 dir);
+
+
+/*------------------------------------------------------------------------*
+ *                 Fast Fourier transform of real 2-D arrays              *
+ *------------------------------------------------------------------------*/
+/*!
+ *  fftReal2DForward()
+ *
+ *      Input:  datas (real array, with nx columns and ny rows)
+ *              nx, ny (dimensions; each a power of 2, and nx >= 2)
+ *      Return: spectrum (complex array, with (nx/2 + 1) columns and
+ *                        ny rows, stored as interleaved re, im pairs),
+ *                        or null on error
+ *
+ *  Notes:
+ *      (1) Rows are transformed two at a time, by putting one row in
+ *          the real part and the next in the imaginary part of a complex
+ *          row.  The two spectra are separated using the symmetry
+ *          X[n - k] = conj(X[k]) of the transform of real data.
+ *      (2) The columns of the half-spectrum are then transformed.
+ *      (3) Both plans are fetched before either is used, and fetching
+ *          the column plan never evicts the row plan.
+ */
+static l_float64 *
+fftReal2DForward(l_float64  *datas,
+                 l_int32     nx,
+                 l_int32     ny)
+{
+l_int32     i, j, k, nxh, wpls;
+l_float64   ar, ai, cr, ci;
+l_float64  *spec, *z, *col, *lines1, *lines2, *linesp;
+L_FFTPLAN  *planx, *plany;
+
+    PROCNAME("fftReal2DForward");
+
+    nxh = nx / 2 + 1;
+    wpls = 2 * nxh;
+    if ((spec = (l_float64 *)CALLOC(wpls * ny, sizeof(l_float64))) == NULL)
+        return (l_float64 *)ERROR_PTR("spec not made", procName, NULL);
+    if ((z = (l_float64 *)CALLOC(2 * L_MAX(nx, ny), sizeof(l_float64)))
+        == NULL) {
+        FREE(spec);
+        return (l_float64 *)ERROR_PTR("z not made", procName, NULL);
+    }
+    planx = fftGetPlan(nx, NULL);
+    plany = (ny > 1) ? fftGetPlan(ny, planx) : NULL;
+    if (!planx || (ny > 1 && !plany)) {
+        FREE(spec);
+        FREE(z);
+        return (l_float64 *)ERROR_PTR("plans not made", procName, NULL);
+    }
+
+        /* Transform the rows in pairs */
+    for (i = 0; i < ny; i += 2) {
+        lines1 = datas + i * nx;
+        lines2 = (i + 1 < ny) ? datas + (i + 1) * nx : NULL;
+        for (j = 0; j < nx; j++) {
+            z[2 * j] = lines1[j];
+            z[2 * j + 1] = (lines2) ? lines2[j] : 0.0;
+        }
+        fftComplex1D(planx, z, L_FFT_FORWARD);
+        for (k = 0; k < nxh; k++) {
+            j = (nx - k) & (nx - 1);
+            ar = z[2 * k];
+            ai = z[2 * k + 1];
+            cr = z[2 * j];
+            ci = -z[2 * j + 1];
+            linesp = spec + i * wpls;
+            linesp[2 * k] = 0.5 * (ar + cr);
+            linesp[2 * k + 1] = 0.5 * (ai + ci);
+            if (lines2) {
+                linesp += wpls;
+                linesp[2 * k] = 0.5 * (ai - ci);
+                linesp[2 * k + 1] = -0.5 * (ar - cr);
+            }
+        }
+    }
+
+        /* Transform the columns */
+    if (ny > 1) {
+        for (k = 0; k < nxh; k++) {
+            col = spec + 2 * k;
+            for (i = 0; i < ny; i++) {
+                z[2 * i] = col[i * wpls];
+                z[2 * i + 1] = col[i * wpls + 1];
+            }
+            fftComplex1D(plany, z, L_FFT_FORWARD);
+            for (i = 0; i < ny; i++) {
+                col[i * wpls] = z[2 * i];
+                col[i * wpls + 1] = z[2 * i + 1];
+            }
+        }
+    }
+
+    FREE(z);
+    return spec;
+}
+
+
+/*!
+ *  fftReal2DInverse()
+ *
+ *      Input:  spec (half-spectrum, as made by fftReal2DForward();
+ *                    this is destroyed)
+ *              nx, ny (dimensions of the real array)
+ *              datad (real array, nx columns by ny rows, for the result)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The spectrum must be that of real data (e.g., a product
+ *          of two such spectra), so that the missing half can be
+ *          filled in by conjugate symmetry.
+ *      (2) The result is scaled by 1 / (nx * ny), so that the inverse
+ *          of the forward transform returns the original data.
+ */
+static l_int32
+fftReal2DInverse(l_float64  *spec,
+                 l_int32     nx,
+                 l_int32     ny,
+                 l_float64  *datad)
+{
+l_int32     i, j, k, nxh, wpls;
+l_float64   norm;
+l_float64  *z, *col, *lines1, *lines2, *lined1, *lined2;
+L_FFTPLAN  *planx, *plany;
+
+    PROCNAME("fftReal2DInverse");
+
+    nxh = nx / 2 + 1;
+    wpls = 2 * nxh;
+    if ((z = (l_float64 *)CALLOC(2 * L_MAX(nx, ny), sizeof(l_float64)))
+        == NULL)
+        return ERROR_INT("z not made", procName, 1);
+    planx = fftGetPlan(nx, NULL);
+    plany = (ny > 1) ? fftGetPlan(ny, planx) : NULL;
+    if (!planx || (ny > 1 && !plany)) {
+        FREE(z);
+        return ERROR_INT("plans not made", procName, 1);
+    }
+
+        /* Inverse transform the columns */
+    if (ny > 1) {
+        for (k = 0; k < nxh; k++) {
+            col = spec + 2 * k;
+            for (i = 0; i < ny; i++) {
+                z[2 * i] = col[i * wpls];
+                z[2 * i + 1] = col[i * wpls + 1];
+            }
+            fftComplex1D(plany, z, L_FFT_INVERSE);
+            for (i = 0; i < ny; i++) {
+                col[i * wpls] = z[2 * i];
+                col[i * wpls + 1] = z[2 * i + 1];
+            }
+        }
+    }
+
+        /* Inverse transform the rows in pairs, putting the spectrum
+         * of the second row into the imaginary part */
+    norm = 1.0 / ((l_float64)nx * (l_float64)ny);
+    for (i = 0; i < ny; i += 2) {
+        lines1 = spec + i * wpls;
+        lines2 = (i + 1 < ny) ? lines1 + wpls : NULL;
+        for (k = 0; k < nxh; k++) {
+            z[2 * k] = lines1[2 * k];
+            z[2 * k + 1] = lines1[2 * k + 1];
+            if (lines2) {
+                z[2 * k] -= lines2[2 * k + 1];
+                z[2 * k + 1] += lines2[2 * k];
+            }
+        }
+        for (k = nxh; k < nx; k++) {
+            j = nx - k;
+            z[2 * k] = lines1[2 * j];
+            z[2 * k + 1] = -lines1[2 * j + 1];
+            if (lines2) {
+                z[2 * k] += lines2[2 * j + 1];
+                z[2 * k + 1] += lines2[2 * j];
+            }
+        }
+        fftComplex1D(planx, z, L_FFT_INVERSE);
+        lined1 = datad + i * nx;
+        lined2 = (lines2) ? lined1 + nx : NULL;
+        for (j = 0; j < nx; j++) {
+            lined1[j] = norm * z[2 * j];
+            if (lined2)
+                lined2[j] = norm * z[2 * j + 1];
+        }
+    }
+
+    FREE(z);
+    return 0;
+}
+
+
+/*!
+ *  fftGetSize()
+ *
+ *      Input:  n (minimum size)
+ *      Return: smallest power of 2 that is >= n
+ */
+static l_int32
+fftGetSize(l_int32  n)
+{
+l_int32  size;
+
+    size = 1;
+    while (size < n)
+        size <<= 1;
+    return size;
+}
+
+
+/*------------------------------------------------------------------------*
+ *                             FFTPlan cache                              *
+ *------------------------------------------------------------------------*/
+/*!
+ *  fftClearPlanCache()
+ *
+ *      Input:  (none)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This frees all cached transform plans.  Call it when
+ *          finished with FFT-based operations, to avoid reports of
+ *          leaked memory.
+ */
+void
+fftClearPlanCache(void)
+{
+l_int32  i;
+
+    for (i = 0; i < MAX_CACHED_PLANS; i++)
+        fftPlanDestroy(&FftPlanCache[i]);
+    FftPlanNext = 0;
+    return;
+}
+
+
+/*!
+ *  fftGetPlan()
+ *
+ *      Input:  n (size of complex transform; power of 2)
+ *              keep (<optional> plan in use, which must not be evicted)
+ *      Return: plan (owned by the cache; do not destroy), or null on error
+ *
+ *  Notes:
+ *      (1) If the cache is full, the oldest plan is replaced, unless
+ *          it is @keep, in which case the next oldest is replaced.
+ */
+static L_FFTPLAN *
+fftGetPlan(l_int32     n,
+           L_FFTPLAN  *keep)
+{
+l_int32     i;
+L_FFTPLAN  *plan;
+
+    PROCNAME("fftGetPlan");
+
+    for (i = 0; i < MAX_CACHED_PLANS; i++) {
+        if (FftPlanCache[i] && FftPlanCache[i]->n == n)
+            return FftPlanCache[i];
+    }
+
+    if ((plan = fftPlanCreate(n)) == NULL)
+        return (L_FFTPLAN *)ERROR_PTR("plan not made", procName, NULL);
+    if (keep && FftPlanCache[FftPlanNext] == keep)
+        FftPlanNext = (FftPlanNext + 1) % MAX_CACHED_PLANS;
+    fftPlanDestroy(&FftPlanCache[FftPlanNext]);
+    FftPlanCache[FftPlanNext] = plan;
+    FftPlanNext = (FftPlanNext + 1) % MAX_CACHED_PLANS;
+    return plan;
+}
+
+
+/*!
+ *  fftPlanCreate()
+ *
+ *      Input:  n (size of complex transform; power of 2)
+ *      Return: plan, or null on error
+ */
+static L_FFTPLAN *
+fftPlanCreate(l_int32  n)
+{
+l_int32     i, j, bit, nbits;
+l_float64   angle;
+L_FFTPLAN  *plan;
+
+    PROCNAME("fftPlanCreate");
+
+    if (n < 1 || (n & (n - 1)))
+        return (L_FFTPLAN *)ERROR_PTR("n not a power of 2", procName, NULL);
+
+    if ((plan = (L_FFTPLAN *)CALLOC(1, sizeof(L_FFTPLAN))) == NULL)
+        return (L_FFTPLAN *)ERROR_PTR("plan not made", procName, NULL);
+    plan->n = n;
+    plan->bitrev = (l_int32 *)CALLOC(n, sizeof(l_int32));
+    plan->costab = (l_float64 *)CALLOC(n / 2 + 1, sizeof(l_float64));
+    plan->sintab = (l_float64 *)CALLOC(n / 2 + 1, sizeof(l_float64));
+    if (!plan->bitrev || !plan->costab || !plan->sintab) {
+        fftPlanDestroy(&plan);
+        return (L_FFTPLAN *)ERROR_PTR("tables not made", procName, NULL);
+    }
+
+    for (nbits = 0; (1 << nbits) < n; nbits++)
+        ;
+    for (i = 0; i < n; i++) {
+        for (bit = 0, j = 0; bit < nbits; bit++)
+            j |= ((i >> bit) & 1) << (nbits - 1 - bit);
+        plan->bitrev[i] = j;
+    }
+    for (i = 0; i < n / 2; i++) {
+        angle = 2.0 * M_PI * i / n;
+        plan->costab[i] = cos(angle);
+        plan->sintab[i] = sin(angle);
+    }
+
+    return plan;
+}
+
+
+/*!
+ *  fftPlanDestroy()
+ *
+ *      Input:  &plan (<will be set to null before returning>)
+ *      Return: void
+ */
+static void
+fftPlanDestroy(L_FFTPLAN  **pplan)
+{
+L_FFTPLAN  *plan;
+
+    if (!pplan || (plan = *pplan) == NULL)
+        return;
+    if (plan->bitrev) FREE(plan->bitrev);
+    if (plan->costab) FREE(plan->costab);
+    if (plan->sintab) FREE(plan->sintab);
+    FREE(plan);
+    *pplan = NULL;
+    return;
+}
+
+
+/*!
+ *  fftComplex1D()
+ *
+ *      Input:  plan
+ *              z (complex array of plan->n interleaved re, im pairs;
+ *                 transformed in-place)
+ *              dir (L_FFT_FORWARD or L_FFT_INVERSE)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This is an iterative radix-2 decimation-in-time transform.
+ *          The inverse transform is not normalized.
+ */
+static void
+fftComplex1D(L_FFTPLAN  *plan,
+             l_float64  *z,
+             l_int32     dir)
+{
+l_int32     i, j, k, n, len, half, step, a, b;
+l_float64   wr, wi, tr, ti;
+l_float64  *costab, *sintab;
+
+    n = plan->n;
+    for (i = 0; i < n; i++) {
+        j = plan->bitrev[i];
+        if (j > i) {
+            tr = z[2 * i];
+            ti = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = tr;
+            z[2 * j + 1] = ti;
+        }
+    }
+
+    costab = plan->costab;
+    sintab = plan->sintab;
+    for (len = 2; len <= n; len <<= 1) {
+        half = len >> 1;
+        step = n / len;
+        for (k = 0; k < half; k++) {
+            wr = costab[k * step];
+            wi = (dir == L_FFT_FORWARD) ? -sintab[k * step] : sintab[k * step];
+            for (i = k; i < n; i += len) {
+                a = 2 * i;
+                b = 2 * (i + half);
+                tr = wr * z[b] - wi * z[b + 1];
+                ti = wr * z[b + 1] + wi * z[b];
+                z[b] = z[a] - tr;
+                z[b + 1] = z[a + 1] - ti;
+                z[a] += tr;
+                z[a + 1] += ti;
+            }
+        }
+    }
+    return;
+}
+
+
+/*------------------------------------------------------------------------*
+ *                       Convolution using the FFT                        *
+ *------------------------------------------------------------------------*/
+/*!
+ *  fpixConvolveFFT()
+ *
+ *      Input:  fpixs (32 bit float array)
+ *              kernel
+ *              normflag (1 to normalize kernel to unit sum; 0 otherwise)
+ *      Return: fpixd (32 bit float array)
+ *
+ *  Notes:
+ *      (1) This gives the same result as fpixConvolve(), to within
+ *          rounding error, by multiplying the transforms of the image
+ *          and the kernel.  The time is independent of the kernel size,
+ *          so it is much faster than fpixConvolve() for large kernels.
+ *          fpixConvolve() calls this automatically when it is faster;
+ *          see l_setConvolveFFT().
+ *      (2) As with fpixConvolve(), a mirrored border is added to
+ *          avoid special casing on the boundaries, and if
+ *          l_setConvolveSampling() has been used to request a subsampled
+ *          output, the result is subsampled.  The transform itself
+ *          is always done at full resolution.
+ *      (3) Both the image with border and the kernel are padded with
+ *          zeroes to the next power of 2 in each direction.  Because
+ *          the padded size is at least that of the bordered image,
+ *          the circular correlation does not wrap for any output pixel.
+ */
+FPIX *
+fpixConvolveFFT(FPIX      *fpixs,
+                L_KERNEL  *kel,
+                l_int32    normflag)
+{
+l_int32     i, j, id, jd, w, h, wt, ht, wd, hd, sx, sy, cx, cy;
+l_int32     nx, ny, nxh, wplt, wpld, xfact, yfact;
+l_float64   ar, ai, br, bi;
+l_float32  *datat, *datad, *linet, *lined;
+l_float64  *dataf, *specs, *speck;
+L_KERNEL   *keli, *keln;
+FPIX       *fpixt, *fpixd;
+
+    PROCNAME("fpixConvolveFFT");
+
+    if (!fpixs)
+        return (FPIX *)ERROR_PTR("fpixs not defined", procName, NULL);
+    if (!kel)
+        return (FPIX *)ERROR_PTR("kel not defined", procName, NULL);
+
+    keli = kernelInvert(kel);
+    kernelGetParameters(keli, &sy, &sx, &cy, &cx);
+    if (normflag)
+        keln = kernelNormalize(keli, 1.0);
+    else
+        keln = kernelCopy(keli);
+    kernelDestroy(&keli);
+
+    fpixGetDimensions(fpixs, &w, &h);
+    fpixt = fpixAddMirroredBorder(fpixs, cx, sx - cx, cy, sy - cy);
+    if (!fpixt) {
+        kernelDestroy(&keln);
+        return (FPIX *)ERROR_PTR("fpixt not made", procName, NULL);
+    }
+    fpixGetDimensions(fpixt, &wt, &ht);
+    wplt = fpixGetWpl(fpixt);
+    datat = fpixGetData(fpixt);
+    nx = fftGetSize(L_MAX(wt, 2));
+    ny = fftGetSize(ht);
+    nxh = nx / 2 + 1;
+
+        /* Transform the bordered image */
+    if ((dataf = (l_float64 *)CALLOC(nx * ny, sizeof(l_float64))) == NULL) {
+        kernelDestroy(&keln);
+        fpixDestroy(&fpixt);
+        return (FPIX *)ERROR_PTR("dataf not made", procName, NULL);
+    }
+    for (i = 0; i < ht; i++) {
+        linet = datat + i * wplt;
+        for (j = 0; j < wt; j++)
+            dataf[i * nx + j] = linet[j];
+    }
+    specs = fftReal2DForward(dataf, nx, ny);
+    fpixDestroy(&fpixt);
+
+        /* Transform the kernel, with its origin at (0, 0) */
+    for (i = 0; i < nx * ny; i++)
+        dataf[i] = 0.0;
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++)
+            dataf[i * nx + j] = keln->data[i][j];
+    }
+    speck = fftReal2DForward(dataf, nx, ny);
+    kernelDestroy(&keln);
+    if (!specs || !speck) {
+        if (specs) FREE(specs);
+        if (speck) FREE(speck);
+        FREE(dataf);
+        return (FPIX *)ERROR_PTR("spectra not made", procName, NULL);
+    }
+
+        /* Correlate: multiply by the complex conjugate of the kernel */
+    for (i = 0; i < nxh * ny; i++) {
+        ar = specs[2 * i];
+        ai = specs[2 * i + 1];
+        br = speck[2 * i];
+        bi = speck[2 * i + 1];
+        specs[2 * i] = ar * br + ai * bi;
+        specs[2 * i + 1] = ai * br - ar * bi;
+    }
+    FREE(speck);
+    fftReal2DInverse(specs, nx, ny, dataf);
+    FREE(specs);
+
+        /* Extract the (possibly subsampled) result */
+    xfact = ConvolveSamplingFactX;
+    yfact = ConvolveSamplingFactY;
+    wd = (w + xfact - 1) / xfact;
+    hd = (h + yfact - 1) / yfact;
+    if ((fpixd = fpixCreate(wd, hd)) == NULL) {
+        FREE(dataf);
+        return (FPIX *)ERROR_PTR("fpixd not made", procName, NULL);
+    }
+    datad = fpixGetData(fpixd);
+    wpld = fpixGetWpl(fpixd);
+    for (i = 0, id = 0; id < hd; i += yfact, id++) {
+        lined = datad + id * wpld;
+        for (j = 0, jd = 0; jd < wd; j += xfact, jd++)
+            lined[jd] = (l_float32)dataf[i * nx + j];
+    }
+
+    FREE(dataf);
+    return fpixd;
+}
+
+
+/*------------------------------------------------------------------------*
+ *                    Cross-correlation using the FFT                     *
+ *------------------------------------------------------------------------*/
+/*!
+ *  pixCorrelationSurfaceFFT()
+ *
+ *      Input:  pix1 (1 or 8 bpp; no colormap)
+ *              pix2 (same depth as pix1)
+ *      Return: dpixd (correlation surface), or null on error
+ *
+ *  Notes:
+ *      (1) For each translation (delx, dely) of pix2 relative to pix1,
+ *          this computes the sum over pix1 of the product of pix1
+ *          and the translated pix2:
+ *              C(delx, dely) = Sum[x,y] pix1(x, y) * pix2(x - delx, y - dely)
+ *          For 1 bpp, this is the number of pixels in the AND of pix1
+ *          and the translated pix2, as used by pixCorrelationScoreShifted().
+ *      (2) The surface contains all translations for which the
+ *          images overlap, and has size
+ *              (w1 + w2 - 1) x (h1 + h2 - 1)
+ *          The value for (delx, dely) is at the location
+ *              (delx + w2 - 1, dely + h2 - 1)
+ *          so zero translation is at (w2 - 1, h2 - 1).
+ *      (3) The time is independent of the number of translations,
+ *          so this is much faster than computing each correlation
+ *          separately with a large search range.  Because the
+ *          arithmetic is done in double precision, the values can
+ *          be rounded to get exact results.
+ */
+DPIX *
+pixCorrelationSurfaceFFT(PIX  *pix1,
+                         PIX  *pix2)
+{
+l_int32     i, j, w1, h1, w2, h2, d, wd, hd, wpl, wpld, nx, ny, nxh;
+l_int32     ix, iy;
+l_uint32   *data, *line;
+l_float64   ar, ai, br, bi;
+l_float64  *dataf, *spec1, *spec2, *datad, *lined;
+DPIX       *dpixd;
+
+    PROCNAME("pixCorrelationSurfaceFFT");
+
+    if (!pix1 || !pix2)
+        return (DPIX *)ERROR_PTR("pix1 and pix2 not both defined",
+                                 procName, NULL);
+    d = pixGetDepth(pix1);
+    if (d != 1 && d != 8)
+        return (DPIX *)ERROR_PTR("pix1 not 1 or 8 bpp", procName, NULL);
+    if (pixGetDepth(pix2) != d)
+        return (DPIX *)ERROR_PTR("depths not equal", procName, NULL);
+    if (pixGetColormap(pix1) || pixGetColormap(pix2))
+        return (DPIX *)ERROR_PTR("pix has colormap", procName, NULL);
+
+    pixGetDimensions(pix1, &w1, &h1, NULL);
+    pixGetDimensions(pix2, &w2, &h2, NULL);
+    wd = w1 + w2 - 1;
+    hd = h1 + h2 - 1;
+    nx = fftGetSize(L_MAX(wd, 2));
+    ny = fftGetSize(hd);
+    nxh = nx / 2 + 1;
+
+    if ((dataf = (l_float64 *)CALLOC(nx * ny, sizeof(l_float64))) == NULL)
+        return (DPIX *)ERROR_PTR("dataf not made", procName, NULL);
+    data = pixGetData(pix1);
+    wpl = pixGetWpl(pix1);
+    for (i = 0; i < h1; i++) {
+        line = data + i * wpl;
+        for (j = 0; j < w1; j++)
+            dataf[i * nx + j] = (d == 1) ? GET_DATA_BIT(line, j)
+                                         : GET_DATA_BYTE(line, j);
+    }
+    spec1 = fftReal2DForward(dataf, nx, ny);
+
+    for (i = 0; i < nx * ny; i++)
+        dataf[i] = 0.0;
+    data = pixGetData(pix2);
+    wpl = pixGetWpl(pix2);
+    for (i = 0; i < h2; i++) {
+        line = data + i * wpl;
+        for (j = 0; j < w2; j++)
+            dataf[i * nx + j] = (d == 1) ? GET_DATA_BIT(line, j)
+                                         : GET_DATA_BYTE(line, j);
+    }
+    spec2 = fftReal2DForward(dataf, nx, ny);
+    if (!spec1 || !spec2) {
+        if (spec1) FREE(spec1);
+        if (spec2) FREE(spec2);
+        FREE(dataf);
+        return (DPIX *)ERROR_PTR("spectra not made", procName, NULL);
+    }
+
+        /* C(s) = Sum[x] pix1(x + s) * pix2(x); multiply spec1 by
+         * the complex conjugate of spec2 */
+    for (i = 0; i < nxh * ny; i++) {
+        ar = spec1[2 * i];
+        ai = spec1[2 * i + 1];
+        br = spec2[2 * i];
+        bi = spec2[2 * i + 1];
+        spec1[2 * i] = ar * br + ai * bi;
+        spec1[2 * i + 1] = ai * br - ar * bi;
+    }
+    FREE(spec2);
+    fftReal2DInverse(spec1, nx, ny, dataf);
+    FREE(spec1);
+
+        /* Unwrap the negative translations */
+    if ((dpixd = dpixCreate(wd, hd)) == NULL) {
+        FREE(dataf);
+        return (DPIX *)ERROR_PTR("dpixd not made", procName, NULL);
+    }
+    datad = dpixGetData(dpixd);
+    wpld = dpixGetWpl(dpixd);
+    for (i = 0; i < hd; i++) {
+        iy = (i - (h2 - 1) + ny) & (ny - 1);
+        lined = datad + i * wpld;
+        for (j = 0; j < wd; j++) {
+            ix = (j - (w2 - 1) + nx) & (nx - 1);
+            lined[j] = dataf[iy * nx + ix];
+        }
+    }
+
+    FREE(dataf);
+    return dpixd;
+}
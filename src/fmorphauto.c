@@ -83,6 +83,13 @@
  *            PIX   *pixFMorphopGen_1(PIX *pixd, PIX *pixs,
  *                                    l_int32 operation, char *selname);
  *
+ *                 or, to write only the region inside the border
+ *                 of pixs to a smaller pixd,
+ *
+ *            PIX   *pixFMorphopGenInterior_1(PIX *pixd, PIX *pixs,
+ *                                            l_int32 operation,
+ *                                            char *selname);
+ *
  *        where the operation is one of {L_MORPH_DILATE, L_MORPH_ERODE.
  *        L_MORPH_OPEN, L_MORPH_CLOSE}, and the selname is one
  *        of the set that were defined as the name field of sels.
@@ -264,7 +271,7 @@ l_int32  ret1, ret2;
  *
  *  Notes:
  *      (1) This function uses morphtemplate1.txt to create a
- *          top-level file that contains two functions.  These
+ *          top-level file that contains three functions.  These
  *          functions will carry out dilation, erosion,
  *          opening or closing for any of the sels in the input sela.
  *      (2) The fileindex parameter is inserted into the output
@@ -279,9 +286,11 @@ fmorphautogen1(SELA        *sela,
                const char  *filename)
 {
 char    *filestr;
-char    *str_proto1, *str_proto2, *str_proto3;
-char    *str_doc1, *str_doc2, *str_doc3, *str_doc4;
-char    *str_def1, *str_def2, *str_proc1, *str_proc2;
+char    *str_proto1, *str_proto2, *str_proto3, *str_proto4, *str_proto5;
+char    *str_doc1, *str_doc2, *str_doc3, *str_doc4, *str_doc5;
+char    *str_doc6, *str_doc7;
+char    *str_def1, *str_def2, *str_def3, *str_def4;
+char    *str_proc1, *str_proc3, *str_proc4, *str_core1, *str_core2;
 char    *str_dwa1, *str_low_dt, *str_low_ds, *str_low_ts;
 char    *str_low_tsp1, *str_low_dtp1;
 char     bigbuf[BUFFER_SIZE];
@@ -321,6 +330,14 @@ SARRAY  *sa1, *sa2, *sa3;
         "                          l_uint32 *datas, l_int32 wpls,\n"
         "                          l_int32 index);", fileindex);
     str_proto3 = stringNew(bigbuf);
+    sprintf(bigbuf, "PIX *pixFMorphopGenInterior_%d(PIX *pixd, PIX *pixs,\n"
+        "                              l_int32 operation, char *selname);",
+        fileindex);
+    str_proto4 = stringNew(bigbuf);
+    sprintf(bigbuf, "static PIX *pixFMorphopGenCore_%d(PIX *pixd, PIX *pixs,\n"
+        "                                 l_int32 operation, char *selname,\n"
+        "                                 l_int32 interior);", fileindex);
+    str_proto5 = stringNew(bigbuf);
     sprintf(bigbuf, " *             PIX     *pixMorphDwa_%d()", fileindex);
     str_doc1 = stringNew(bigbuf);
     sprintf(bigbuf, " *             PIX     *pixFMorphopGen_%d()", fileindex);
@@ -329,18 +346,37 @@ SARRAY  *sa1, *sa2, *sa3;
     str_doc3 = stringNew(bigbuf);
     sprintf(bigbuf, " *  pixFMorphopGen_%d()", fileindex);
     str_doc4 = stringNew(bigbuf);
+    sprintf(bigbuf, " *             PIX     *pixFMorphopGenInterior_%d()",
+            fileindex);
+    str_doc5 = stringNew(bigbuf);
+    sprintf(bigbuf, " *  pixFMorphopGenInterior_%d()", fileindex);
+    str_doc6 = stringNew(bigbuf);
+    sprintf(bigbuf, " *  pixFMorphopGenCore_%d()", fileindex);
+    str_doc7 = stringNew(bigbuf);
     sprintf(bigbuf, "pixMorphDwa_%d(PIX     *pixd,", fileindex);
     str_def1 = stringNew(bigbuf);
     sprintf(bigbuf, "pixFMorphopGen_%d(PIX     *pixd,", fileindex);
     str_def2 = stringNew(bigbuf);
+    sprintf(bigbuf, "pixFMorphopGenInterior_%d(PIX     *pixd,", fileindex);
+    str_def3 = stringNew(bigbuf);
+    sprintf(bigbuf, "pixFMorphopGenCore_%d(PIX     *pixd,", fileindex);
+    str_def4 = stringNew(bigbuf);
     sprintf(bigbuf, "    PROCNAME(\"pixMorphDwa_%d\");", fileindex);
     str_proc1 = stringNew(bigbuf);
-    sprintf(bigbuf, "    PROCNAME(\"pixFMorphopGen_%d\");", fileindex);
-    str_proc2 = stringNew(bigbuf);
+    sprintf(bigbuf, "    PROCNAME(\"pixFMorphopGenInterior_%d\");", fileindex);
+    str_proc3 = stringNew(bigbuf);
+    sprintf(bigbuf, "    PROCNAME(\"pixFMorphopGenCore_%d\");", fileindex);
+    str_proc4 = stringNew(bigbuf);
     sprintf(bigbuf,
-            "    pixt2 = pixFMorphopGen_%d(NULL, pixt1, operation, selname);",
+            "    pixFMorphopGenInterior_%d(pixd, pixt, operation, selname);",
 	    fileindex);
     str_dwa1 = stringNew(bigbuf);
+    sprintf(bigbuf, "    return pixFMorphopGenCore_%d(pixd, pixs, operation, "
+            "selname, FALSE);", fileindex);
+    str_core1 = stringNew(bigbuf);
+    sprintf(bigbuf, "    return pixFMorphopGenCore_%d(pixd, pixs, operation, "
+            "selname, TRUE);", fileindex);
+    str_core2 = stringNew(bigbuf);
     sprintf(bigbuf,
       "            fmorphopgen_low_%d(datad, w, h, wpld, datat, wpls, index);",
       fileindex);
@@ -373,6 +409,7 @@ SARRAY  *sa1, *sa2, *sa3;
         /* Insert function names as documentation */
     sarrayAddString(sa3, str_doc1, L_INSERT);
     sarrayAddString(sa3, str_doc2, L_INSERT);
+    sarrayAddString(sa3, str_doc5, L_INSERT);
 
         /* Add '#include's */
     sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
@@ -381,6 +418,8 @@ SARRAY  *sa1, *sa2, *sa3;
         /* Insert function prototypes */
     sarrayAddString(sa3, str_proto1, L_INSERT);
     sarrayAddString(sa3, str_proto2, L_INSERT);
+    sarrayAddString(sa3, str_proto4, L_INSERT);
+    sarrayAddString(sa3, str_proto5, L_INSERT);
     sarrayAddString(sa3, str_proto3, L_INSERT);
 
         /* Add static globals */
@@ -424,7 +463,32 @@ SARRAY  *sa1, *sa2, *sa3;
     sarrayAddString(sa3, str_def2, L_INSERT);
     sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
     sarrayAppendRange(sa3, sa2, actstart, end);
-    sarrayAddString(sa3, str_proc2, L_INSERT);
+    sarrayAddString(sa3, str_core1, L_INSERT);
+    sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
+    sarrayAppendRange(sa3, sa2, actstart, end);
+
+        /* pixFMorphopGenInterior_*() function */
+    sarrayAddString(sa3, str_doc6, L_INSERT);
+    sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
+    sarrayAppendRange(sa3, sa2, actstart, end);
+    sarrayAddString(sa3, str_def3, L_INSERT);
+    sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
+    sarrayAppendRange(sa3, sa2, actstart, end);
+    sarrayAddString(sa3, str_proc3, L_INSERT);
+    sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
+    sarrayAppendRange(sa3, sa2, actstart, end);
+    sarrayAddString(sa3, str_core2, L_INSERT);
+    sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
+    sarrayAppendRange(sa3, sa2, actstart, end);
+
+        /* Static pixFMorphopGenCore_*() function */
+    sarrayAddString(sa3, str_doc7, L_INSERT);
+    sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
+    sarrayAppendRange(sa3, sa2, actstart, end);
+    sarrayAddString(sa3, str_def4, L_INSERT);
+    sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
+    sarrayAppendRange(sa3, sa2, actstart, end);
+    sarrayAddString(sa3, str_proc4, L_INSERT);
     sarrayParseRange(sa2, newstart, &actstart, &end, &newstart, "--", 0);
     sarrayAppendRange(sa3, sa2, actstart, end);
     sarrayAddString(sa3, str_low_dt, L_COPY);
@@ -29,6 +29,7 @@
  *
  *             PIX     *pixMorphDwa_1()
  *             PIX     *pixFMorphopGen_1()
+ *             PIX     *pixFMorphopGenInterior_1()
  */
 
 #include <string.h>
@@ -36,6 +37,11 @@
 
 PIX *pixMorphDwa_1(PIX *pixd, PIX *pixs, l_int32 operation, char *selname);
 PIX *pixFMorphopGen_1(PIX *pixd, PIX *pixs, l_int32 operation, char *selname);
+PIX *pixFMorphopGenInterior_1(PIX *pixd, PIX *pixs,
+                              l_int32 operation, char *selname);
+static PIX *pixFMorphopGenCore_1(PIX *pixd, PIX *pixs,
+                                 l_int32 operation, char *selname,
+                                 l_int32 interior);
 l_int32 fmorphopgen_low_1(l_uint32 *datad, l_int32 w,
                           l_int32 h, l_int32 wpld,
                           l_uint32 *datas, l_int32 wpls,
@@ -114,10 +120,12 @@ static char  SEL_NAMES[][80] = {
  *
  *  Notes:
  *      (1) This simply adds a border, calls the appropriate
- *          pixFMorphopGen_*(), and removes the border.
+ *          pixFMorphopGenInterior_*(), and removes the border.
  *          See the notes for that function.
  *      (2) The size of the border depends on the operation
  *          and the boundary conditions.
+ *      (3) The border is removed by writing the result directly
+ *          into pixd, which has the size of pixs.
  */
 PIX *
 pixMorphDwa_1(PIX     *pixd,
@@ -126,7 +134,7 @@ pixMorphDwa_1(PIX     *pixd,
               char    *selname)
 {
 l_int32  bordercolor, bordersize;
-PIX     *pixt1, *pixt2, *pixt3;
+PIX     *pixt;
 
     PROCNAME("pixMorphDwa_1");
 
@@ -141,17 +149,19 @@ PIX     *pixt1, *pixt2, *pixt3;
     if (bordercolor == 0 && operation == L_MORPH_CLOSE)
         bordersize += 32;
 
-    pixt1 = pixAddBorder(pixs, bordersize, 0);
-    pixt2 = pixFMorphopGen_1(NULL, pixt1, operation, selname);
-    pixt3 = pixRemoveBorder(pixt2, bordersize);
-    pixDestroy(&pixt1);
-    pixDestroy(&pixt2);
-
-    if (!pixd)
-        return pixt3;
+    if (!pixd) {
+        if ((pixd = pixCreateTemplate(pixs)) == NULL)
+            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
+    else if (pixd != pixs) {
+        pixResizeImageData(pixd, pixs);
+        pixCopyResolution(pixd, pixs);
+    }
 
-    pixCopy(pixd, pixt3);
-    pixDestroy(&pixt3);
+        /* pixs is read here, before pixd is written */
+    pixt = pixAddBorder(pixs, bordersize, 0);
+    pixFMorphopGenInterior_1(pixd, pixt, operation, selname);
+    pixDestroy(&pixt);
     return pixd;
 }
 
@@ -176,18 +186,91 @@ PIX     *pixt1, *pixt2, *pixt3;
  *          before erosion and dilation.
  *      (4) The closing operation is safe; no pixels can be removed
  *          near the boundary.
+ *      (5) pixd has the size of pixs, including the border.  To write
+ *          only the region inside the border, without copying, use
+ *          pixFMorphopGenInterior_*().
  */
 PIX *
 pixFMorphopGen_1(PIX     *pixd,
                  PIX     *pixs,
                  l_int32  operation,
                  char    *selname)
+{
+    return pixFMorphopGenCore_1(pixd, pixs, operation, selname, FALSE);
+}
+
+
+/*!
+ *  pixFMorphopGenInterior_1()
+ *
+ *      Input:  pixd (1 bpp; the size of pixs without its border)
+ *              pixs (1 bpp, with a border)
+ *              operation  (L_MORPH_DILATE, L_MORPH_ERODE,
+ *                          L_MORPH_OPEN, L_MORPH_CLOSE)
+ *              sel name
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) This is pixFMorphopGen_*(), except that only the region
+ *          inside the border of pixs is computed in the last pass,
+ *          and it is written to pixd.  This removes the border without
+ *          copying the image.
+ *      (2) The border must be the same on opposite sides, and at least
+ *          32 pixels.  The left and right borders must be a multiple
+ *          of 32 pixels.
+ */
+PIX *
+pixFMorphopGenInterior_1(PIX     *pixd,
+                         PIX     *pixs,
+                         l_int32  operation,
+                         char    *selname)
+{
+l_int32  bx, by;
+
+    PROCNAME("pixFMorphopGenInterior_1");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (!pixd)
+        return (PIX *)ERROR_PTR("pixd not defined", procName, NULL);
+    if (pixd == pixs || pixGetDepth(pixd) != 1)
+        return (PIX *)ERROR_PTR("pixd == pixs or not 1 bpp", procName, pixd);
+    bx = (pixGetWidth(pixs) - pixGetWidth(pixd)) / 2;
+    by = (pixGetHeight(pixs) - pixGetHeight(pixd)) / 2;
+    if (bx < 32 || bx % 32 != 0 || by < 32 ||
+        pixGetWidth(pixd) + 2 * bx != pixGetWidth(pixs) ||
+        pixGetHeight(pixd) + 2 * by != pixGetHeight(pixs))
+        return (PIX *)ERROR_PTR("pixd not inside border", procName, pixd);
+    return pixFMorphopGenCore_1(pixd, pixs, operation, selname, TRUE);
+}
+
+
+/*!
+ *  pixFMorphopGenCore_1()
+ *
+ *      Input:  pixd (usual 3 choices: null, == pixs, != pixs;
+ *                    or the size of pixs without its border)
+ *              pixs (1 bpp, with a border)
+ *              operation  (L_MORPH_DILATE, L_MORPH_ERODE,
+ *                          L_MORPH_OPEN, L_MORPH_CLOSE)
+ *              sel name
+ *              interior (1 to compute only the region inside the border;
+ *                        0 to resize pixd to pixs)
+ *      Return: pixd
+ */
+static PIX *
+pixFMorphopGenCore_1(PIX     *pixd,
+                     PIX     *pixs,
+                     l_int32  operation,
+                     char    *selname,
+                     l_int32  interior)
 {
 l_int32    i, index, found, w, h, wpls, wpld, bordercolor, erodeop, borderop;
+l_int32    bx, by, wi, hi, offset;
 l_uint32  *datad, *datas, *datat;
 PIX       *pixt;
 
-    PROCNAME("pixFMorphopGen_1");
+    PROCNAME("pixFMorphopGenCore_1");
 
     if (!pixs)
         return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
@@ -216,7 +299,7 @@ PIX       *pixt;
         if ((pixd = pixCreateTemplate(pixs)) == NULL)
             return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
     }
-    else  /* for in-place or pre-allocated */
+    else if (!interior)  /* for in-place or pre-allocated */
         pixResizeImageData(pixd, pixs);
     wpls = pixGetWpl(pixs);
     wpld = pixGetWpl(pixd);
@@ -230,6 +313,19 @@ PIX       *pixt;
     datas = pixGetData(pixs) + 32 * wpls + 1;
     datad = pixGetData(pixd) + 32 * wpld + 1;
 
+        /* Region computed in the last pass, and its offset in pixs */
+    wi = w;
+    hi = h;
+    offset = 32 * wpls + 1;
+    if (interior) {
+        wi = pixGetWidth(pixd);
+        hi = pixGetHeight(pixd);
+        bx = (pixGetWidth(pixs) - wi) / 2;
+        by = (pixGetHeight(pixs) - hi) / 2;
+        offset = by * wpls + bx / 32;
+        datad = pixGetData(pixd);
+    }
+
     if (operation == L_MORPH_DILATE || operation == L_MORPH_ERODE) {
         borderop = PIX_CLR;
         if (operation == L_MORPH_ERODE) {
@@ -246,6 +342,9 @@ PIX       *pixt;
         }
         else { /* not in-place */
             pixSetOrClearBorder(pixs, 32, 32, 32, 32, borderop);
+            w = wi;
+            h = hi;
+            datas = pixGetData(pixs) + offset;
             fmorphopgen_low_1(datad, w, h, wpld, datas, wpls, index);
         }
     }
@@ -257,17 +356,25 @@ PIX       *pixt;
             pixSetOrClearBorder(pixs, 32, 32, 32, 32, erodeop);
             fmorphopgen_low_1(datat, w, h, wpls, datas, wpls, index+1);
             pixSetOrClearBorder(pixt, 32, 32, 32, 32, PIX_CLR);
+            w = wi;
+            h = hi;
+            datat = pixGetData(pixt) + offset;
             fmorphopgen_low_1(datad, w, h, wpld, datat, wpls, index);
         }
         else {  /* closing */
             pixSetOrClearBorder(pixs, 32, 32, 32, 32, PIX_CLR);
             fmorphopgen_low_1(datat, w, h, wpls, datas, wpls, index);
             pixSetOrClearBorder(pixt, 32, 32, 32, 32, erodeop);
+            w = wi;
+            h = hi;
+            datat = pixGetData(pixt) + offset;
             fmorphopgen_low_1(datad, w, h, wpld, datat, wpls, index+1);
         }
         pixDestroy(&pixt);
     }
 
+    if (interior)
+        pixSetPadBits(pixd, 0);
     return pixd;
 }
 
@@ -34,6 +34,14 @@
  *            PIX     *pixOpenGray()
  *            PIX     *pixCloseGray()
  *
+ *      Erosion and dilation with arbitrary flat Sels (8 and 32 bpp)
+ *            PIX     *pixErodeGraySel()
+ *            PIX     *pixDilateGraySel()
+ *            static PIX     *pixGrayMorphSel()
+ *            static PIX     *pixGrayMorphRuns()
+ *            static l_int32  grayFindRuns()
+ *            static void     grayMinMaxLineLow()
+ *
  *      Special operations for 1x3, 3x1 and 3x3 Sels  (direct)
  *            PIX     *pixErodeGray3()
  *            PIX     *pixDilateGray3()
@@ -53,14 +61,27 @@
  *      of maximum size 3.  We unroll the computation for sets of 8 bytes.
  *      It needs to be called explicitly; the general functions do not
  *      default for the size 3 brick Sels.
+ *
+ *      Erosion and dilation by a flat Sel of arbitrary shape, such as
+ *      a disc or octagon, are done by decomposing the Sel into line
+ *      segments, with running min or max images along the segments.
+ *      See pixGrayMorphRuns().
  */
 
+#include <string.h>
 #include "allheaders.h"
 
 static PIX *pixErodeGray3h(PIX *pixs);
 static PIX *pixErodeGray3v(PIX *pixs);
 static PIX *pixDilateGray3h(PIX *pixs);
 static PIX *pixDilateGray3v(PIX *pixs);
+static PIX *pixGrayMorphSel(PIX *pixs, SEL *sel, l_int32 type);
+static PIX *pixGrayMorphRuns(PIX *pixs, SEL *sel, l_int32 type);
+static l_int32 grayFindRuns(l_int32 *grid, l_int32 gw, l_int32 gh,
+                            l_int32 maxox, l_int32 maxoy, l_int32 dir,
+                            l_int32 *tlen, l_int32 *tox, l_int32 *toy);
+static void grayMinMaxLineLow(l_uint8 *lined, l_uint8 *lines, l_int32 n,
+                              l_int32 type);
 
 
 /*-----------------------------------------------------------------*
@@ -536,6 +557,450 @@ PIX       *pixb, *pixt, *pixd;
 }
 
 
+/*-----------------------------------------------------------------*
+ *     Erosion and dilation with arbitrary flat Sels (8, 32 bpp)   *
+ *-----------------------------------------------------------------*/
+/*!
+ *  pixErodeGraySel()
+ *
+ *      Input:  pixs (8 bpp gray or 32 bpp rgb; not cmapped)
+ *              sel (flat; only the hits are used)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) Each pixel of pixd is the minimum of pixs over the hits
+ *          of sel, placed with its origin on the pixel.  Pixels
+ *          outside the image are ignored, as in pixErodeGray().
+ *      (2) The Sel can have any shape and origin.  Brick Sels are
+ *          done separably; at 8 bpp with odd sizes and centered
+ *          origin, this calls pixErodeGray().  Other Sels, such as
+ *          discs and octagons, are broken into line segments; see
+ *          pixGrayMorphRuns().
+ *      (3) For 32 bpp, each of the 4 components is eroded
+ *          independently, all in a single pass over the interleaved
+ *          data.
+ */
+PIX *
+pixErodeGraySel(PIX  *pixs,
+                SEL  *sel)
+{
+    PROCNAME("pixErodeGraySel");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (pixGetDepth(pixs) != 8 && pixGetDepth(pixs) != 32)
+        return (PIX *)ERROR_PTR("pixs not 8 or 32 bpp", procName, NULL);
+    if (pixGetColormap(pixs))
+        return (PIX *)ERROR_PTR("pixs has colormap", procName, NULL);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, NULL);
+
+    return pixGrayMorphSel(pixs, sel, L_MORPH_ERODE);
+}
+
+
+/*!
+ *  pixDilateGraySel()
+ *
+ *      Input:  pixs (8 bpp gray or 32 bpp rgb; not cmapped)
+ *              sel (flat; only the hits are used)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) Each pixel of pixd is the maximum of pixs over the hits
+ *          of sel, reflected about its origin.  Pixels outside the
+ *          image are ignored, as in pixDilateGray().
+ *      (2) See notes in pixErodeGraySel().
+ */
+PIX *
+pixDilateGraySel(PIX  *pixs,
+                 SEL  *sel)
+{
+    PROCNAME("pixDilateGraySel");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (pixGetDepth(pixs) != 8 && pixGetDepth(pixs) != 32)
+        return (PIX *)ERROR_PTR("pixs not 8 or 32 bpp", procName, NULL);
+    if (pixGetColormap(pixs))
+        return (PIX *)ERROR_PTR("pixs has colormap", procName, NULL);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, NULL);
+
+    return pixGrayMorphSel(pixs, sel, L_MORPH_DILATE);
+}
+
+
+/*!
+ *  pixGrayMorphSel()
+ *
+ *      Input:  pixs (8 or 32 bpp)
+ *              sel
+ *              type (L_MORPH_ERODE, L_MORPH_DILATE)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) Bricks are separable, and are done as a horizontal and
+ *          a vertical line.
+ */
+static PIX *
+pixGrayMorphSel(PIX     *pixs,
+                SEL     *sel,
+                l_int32  type)
+{
+l_int32  i, j, sx, sy, cx, cy, isbrick;
+PIX     *pixt, *pixd;
+SEL     *selh, *selv;
+
+    PROCNAME("pixGrayMorphSel");
+
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    isbrick = TRUE;
+    for (i = 0; i < sy && isbrick; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] != SEL_HIT) {
+                isbrick = FALSE;
+                break;
+            }
+        }
+    }
+
+    if (!isbrick)
+        return pixGrayMorphRuns(pixs, sel, type);
+    if (sx == 1 && sy == 1 && cx == 0 && cy == 0)
+        return pixCopy(NULL, pixs);
+    if (pixGetDepth(pixs) == 8 && (sx & 1) && (sy & 1) &&
+        cx == sx / 2 && cy == sy / 2) {
+        if (type == L_MORPH_ERODE)
+            return pixErodeGray(pixs, sx, sy);
+        else
+            return pixDilateGray(pixs, sx, sy);
+    }
+    if (sx == 1 || sy == 1)
+        return pixGrayMorphRuns(pixs, sel, type);
+
+    selh = selCreateBrick(1, sx, 0, cx, SEL_HIT);
+    selv = selCreateBrick(sy, 1, cy, 0, SEL_HIT);
+    pixt = pixGrayMorphRuns(pixs, selh, type);
+    pixd = pixGrayMorphRuns(pixt, selv, type);
+    pixDestroy(&pixt);
+    selDestroy(&selh);
+    selDestroy(&selv);
+    if (!pixd)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    return pixd;
+}
+
+
+/*!
+ *  pixGrayMorphRuns()
+ *
+ *      Input:  pixs (8 or 32 bpp)
+ *              sel
+ *              type (L_MORPH_ERODE, L_MORPH_DILATE)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) The hits of the Sel are grouped into line segments along
+ *          either its rows or its columns, whichever is cheaper.  A
+ *          disc of radius r, for example, is 2r + 1 horizontal lines.
+ *      (2) Running min (or max) images R(p) over p = 1, 2, 4, ...
+ *          pixels along the lines are made by doubling:
+ *          R(2p)[x] = min(R(p)[x], R(p)[x + p]).  A segment of
+ *          length L, with p the largest power of 2 not exceeding L,
+ *          is then min(R(p)[x], R(p)[x + L - p]), so each segment
+ *          costs at most two reads, independent of its length.
+ *      (3) The source is copied into a buffer with a border of
+ *          255 for erosion and 0 for dilation, so that pixels outside
+ *          the image have no effect and the inner loops need no tests.
+ *          At 32 bpp the pixels are taken as 4 bytes in memory order,
+ *          and the offsets are multiples of 4 bytes, so all components
+ *          are processed together.
+ *      (4) The inner loops are simple byte min/max operations that
+ *          the compiler can vectorize.
+ *      (5) Line i of the horizontal min image R(p) is the min of
+ *          line i of R(p/2) with itself shifted by p/2, so each
+ *          level is made in place from the previous one.
+ */
+static PIX *
+pixGrayMorphRuns(PIX     *pixs,
+                 SEL     *sel,
+                 l_int32  type)
+{
+l_int32    i, j, k, w, h, d, bpp, sx, sy, cx, cy, ox, oy, maxox, maxoy;
+l_int32    gw, gh, wb, hb, wbb, wpls, wpld, nw, npow, maxlen, nterms, dir;
+l_int32    costh, costv, len, pow2, step, nbytes;
+l_int32   *grid, *tlen, *tox, *toy, *tpow, *used;
+l_uint8    bordval;
+l_uint8   *lined8, *lineb;
+l_uint8  **bufs;
+l_uint32  *datas, *datad, *lines, *lined;
+PIX       *pixd;
+
+    PROCNAME("pixGrayMorphRuns");
+
+    pixGetDimensions(pixs, &w, &h, &d);
+    bpp = d / 8;
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+
+        /* Put the hits in a grid of source offsets (ox, oy), with the
+         * origin at the center.  Dilation reads the source reflected
+         * through the Sel origin. */
+    maxox = L_MAX(L_ABS(cx), L_ABS(sx - 1 - cx));
+    maxoy = L_MAX(L_ABS(cy), L_ABS(sy - 1 - cy));
+    gw = 2 * maxox + 1;
+    gh = 2 * maxoy + 1;
+    grid = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tlen = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tox = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    toy = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tpow = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    used = (l_int32 *)CALLOC(32, sizeof(l_int32));
+    bufs = (l_uint8 **)CALLOC(32, sizeof(l_uint8 *));
+    lined8 = (l_uint8 *)CALLOC(L_MAX(1, w * bpp), sizeof(l_uint8));
+    pixd = NULL;
+    if (!grid || !tlen || !tox || !toy || !tpow || !used || !bufs ||
+        !lined8) {
+        L_ERROR("arrays not made", procName);
+        goto cleanup;
+    }
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] != SEL_HIT)
+                continue;
+            if (type == L_MORPH_DILATE) {
+                ox = cx - j;
+                oy = cy - i;
+            }
+            else {
+                ox = j - cx;
+                oy = i - cy;
+            }
+            grid[(oy + maxoy) * gw + ox + maxox] = 1;
+        }
+    }
+
+        /* Choose the direction with the fewest passes plus reads */
+    for (k = 0; k < 2; k++) {
+        dir = (k == 0) ? L_HORIZ : L_VERT;
+        nterms = grayFindRuns(grid, gw, gh, maxox, maxoy, dir, tlen, tox, toy);
+        for (j = 0, maxlen = 1, nw = 0; j < nterms; j++) {
+            maxlen = L_MAX(maxlen, tlen[j]);
+            for (pow2 = 1; 2 * pow2 <= tlen[j]; pow2 *= 2)
+                ;
+            nw += (pow2 == tlen[j]) ? 1 : 2;
+        }
+        for (npow = 0; (2 << npow) <= maxlen; npow++)
+            ;
+        if (k == 0)
+            costh = nw + npow;
+        else
+            costv = nw + npow;
+    }
+    if (nterms == 0) {
+        L_ERROR("sel has no hits", procName);
+        goto cleanup;
+    }
+    dir = (costh <= costv) ? L_HORIZ : L_VERT;
+    nterms = grayFindRuns(grid, gw, gh, maxox, maxoy, dir, tlen, tox, toy);
+    for (j = 0, maxlen = 1; j < nterms; j++) {
+        maxlen = L_MAX(maxlen, tlen[j]);
+        for (tpow[j] = 0; (2 << tpow[j]) <= tlen[j]; tpow[j]++)
+            ;
+        used[tpow[j]] = TRUE;
+    }
+    for (npow = 1; (1 << npow) <= maxlen; npow++)
+        ;
+
+        /* Copy pixs into the bordered buffer */
+    wb = w + 2 * maxox;
+    hb = h + 2 * maxoy;
+    wbb = wb * bpp;
+    bordval = (type == L_MORPH_ERODE) ? 255 : 0;
+    if ((bufs[0] = (l_uint8 *)CALLOC(wbb * hb, sizeof(l_uint8))) == NULL) {
+        L_ERROR("buffer not made", procName);
+        goto cleanup;
+    }
+    memset(bufs[0], bordval, wbb * hb);
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        lineb = bufs[0] + (i + maxoy) * wbb + maxox * bpp;
+        if (bpp == 4) {
+            memcpy(lineb, lines, 4 * w);
+        }
+        else {
+            for (j = 0; j < w; j++)
+                lineb[j] = GET_DATA_BYTE(lines, j);
+        }
+    }
+
+        /* Make the running min or max images by doubling.  This is
+         * done in place, in raster order, because each entry depends
+         * only on itself and entries further along the line; a level
+         * is copied only if it is needed for a segment.  Entries
+         * near the far end of each line, which would need data from
+         * beyond the buffer, are never read. */
+    for (k = 1; k < npow; k++) {
+        if (used[k - 1]) {
+            if ((bufs[k] = (l_uint8 *)CALLOC(wbb * hb, sizeof(l_uint8)))
+                == NULL) {
+                L_ERROR("buffer not made", procName);
+                goto cleanup;
+            }
+            memcpy(bufs[k], bufs[k - 1], wbb * hb);
+        }
+        else {
+            bufs[k] = bufs[k - 1];
+            bufs[k - 1] = NULL;
+        }
+        step = 1 << (k - 1);
+        if (dir == L_HORIZ) {
+            nbytes = (wb - step) * bpp;
+            for (i = 0; i < hb; i++) {
+                lineb = bufs[k] + i * wbb;
+                grayMinMaxLineLow(lineb, lineb + step * bpp, nbytes, type);
+            }
+        }
+        else {
+            for (i = 0; i < hb - step; i++) {
+                lineb = bufs[k] + i * wbb;
+                grayMinMaxLineLow(lineb, lineb + step * wbb, wbb, type);
+            }
+        }
+    }
+
+        /* Accumulate the segments for each line of pixd */
+    if ((pixd = pixCreateTemplate(pixs)) == NULL) {
+        L_ERROR("pixd not made", procName);
+        goto cleanup;
+    }
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    nbytes = w * bpp;
+    for (i = 0; i < h; i++) {
+        memset(lined8, (type == L_MORPH_ERODE) ? 255 : 0, nbytes);
+        for (j = 0; j < nterms; j++) {
+            len = tlen[j];
+            pow2 = 1 << tpow[j];
+            lineb = bufs[tpow[j]] + (i + maxoy + toy[j]) * wbb +
+                    (maxox + tox[j]) * bpp;
+            grayMinMaxLineLow(lined8, lineb, nbytes, type);
+            if (len > pow2) {
+                if (dir == L_HORIZ)
+                    lineb += (len - pow2) * bpp;
+                else
+                    lineb += (len - pow2) * wbb;
+                grayMinMaxLineLow(lined8, lineb, nbytes, type);
+            }
+        }
+        lined = datad + i * wpld;
+        if (bpp == 4) {
+            memcpy(lined, lined8, nbytes);
+        }
+        else {
+            for (j = 0; j < w; j++)
+                SET_DATA_BYTE(lined, j, lined8[j]);
+        }
+    }
+
+cleanup:
+    if (bufs) {
+        for (k = 0; k < 32; k++)
+            if (bufs[k]) FREE(bufs[k]);
+        FREE(bufs);
+    }
+    if (grid) FREE(grid);
+    if (tlen) FREE(tlen);
+    if (tox) FREE(tox);
+    if (toy) FREE(toy);
+    if (tpow) FREE(tpow);
+    if (used) FREE(used);
+    if (lined8) FREE(lined8);
+    return pixd;
+}
+
+
+/*!
+ *  grayFindRuns()
+ *
+ *      Input:  grid (of hits at source offsets)
+ *              gw, gh (grid size)
+ *              maxox, maxoy (offset of the grid center)
+ *              dir (L_HORIZ for runs along rows, L_VERT along columns)
+ *              tlen, tox, toy (<return> run length and offset of
+ *                              the first element)
+ *      Return: number of runs
+ */
+static l_int32
+grayFindRuns(l_int32  *grid,
+             l_int32   gw,
+             l_int32   gh,
+             l_int32   maxox,
+             l_int32   maxoy,
+             l_int32   dir,
+             l_int32  *tlen,
+             l_int32  *tox,
+             l_int32  *toy)
+{
+l_int32  i, j, n, len, nouter, ninner, x, y;
+
+    nouter = (dir == L_HORIZ) ? gh : gw;
+    ninner = (dir == L_HORIZ) ? gw : gh;
+    n = 0;
+    for (i = 0; i < nouter; i++) {
+        for (j = 0; j < ninner; j += L_MAX(len, 1)) {
+            x = (dir == L_HORIZ) ? j : i;
+            y = (dir == L_HORIZ) ? i : j;
+            len = 0;
+            if (grid[y * gw + x] == 0)
+                continue;
+            for (len = 1; j + len < ninner; len++) {
+                if (dir == L_HORIZ && !grid[y * gw + x + len])
+                    break;
+                if (dir == L_VERT && !grid[(y + len) * gw + x])
+                    break;
+            }
+            tlen[n] = len;
+            tox[n] = x - maxox;
+            toy[n] = y - maxoy;
+            n++;
+        }
+    }
+    return n;
+}
+
+
+/*!
+ *  grayMinMaxLineLow()
+ *
+ *      Input:  lined (accumulated line)
+ *              lines (source line)
+ *              n (number of bytes)
+ *              type (L_MORPH_ERODE for min, L_MORPH_DILATE for max)
+ *      Return: void
+ */
+static void
+grayMinMaxLineLow(l_uint8  *lined,
+                  l_uint8  *lines,
+                  l_int32   n,
+                  l_int32   type)
+{
+l_int32  k;
+
+    if (type == L_MORPH_ERODE) {
+        for (k = 0; k < n; k++)
+            lined[k] = L_MIN(lined[k], lines[k]);
+    }
+    else {
+        for (k = 0; k < n; k++)
+            lined[k] = L_MAX(lined[k], lines[k]);
+    }
+    return;
+}
+
+
 /*-----------------------------------------------------------------*
  *           Special operations for 1x3, 3x1 and 3x3 Sels          *
  *-----------------------------------------------------------------*/
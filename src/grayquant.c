@@ -1023,7 +1023,8 @@ pixThresholdGrayArb(PIX         *pixs,
                     l_int32      setwhite)
 {
 l_int32   *qtab;
-l_int32    w, h, d, i, j, n, wplt, wpld, val, newval;
+l_int32    w, h, d, i, n, wplt, wpld;
+l_uint8    tab8[256];
 l_uint32  *datat, *datad, *linet, *lined;
 NUMA      *na;
 PIX       *pixt, *pixd;
@@ -1086,14 +1087,12 @@ PIXCMAP   *cmap;
     else if (outdepth == 4)
         thresholdTo4bppLow(datad, h, wpld, datat, wplt, qtab);
     else {
+        for (i = 0; i < 256; i++)
+            tab8[i] = (l_uint8)qtab[i];
         for (i = 0; i < h; i++) {
             lined = datad + i * wpld;
             linet = datat + i * wplt;
-            for (j = 0; j < w; j++) {
-                val = GET_DATA_BYTE(linet, j);
-                newval = qtab[val];
-                SET_DATA_BYTE(lined, j, newval);
-            }
+            lutApplyLineLow(lined, linet, 8, 0, w, tab8, NULL, NULL, 0);
         }
     }
 
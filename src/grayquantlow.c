@@ -56,6 +56,12 @@
  *
  *          Simple thresholding to 4 bpp
  *              void       thresholdTo4bppLow()
+ *
+ *      Dithering from 32 bpp rgb to 8 bpp colormapped
+ *
+ *          Floyd-Steinberg-like dithering to a table of colors
+ *              void       ditherToCmapLow()
+ *              void       ditherToCmapLineLow()
  */
 
 #include <string.h>
@@ -675,6 +681,13 @@ l_uint32    *lined;
  *  scaling and error diffusion dithering, as such a
  *  combination of operations obviates the need to
  *  generate a 2x grayscale image as an intermediary.
+ *
+ *  The values to the right of and diagonally below the current pixel
+ *  are carried from each pixel to the next, and the dest dibits are
+ *  collected in a word before being written to lined.  The sums are
+ *  clipped to [0 ... 255] on both sides, without a branch; this is
+ *  the same as clipping on the side toward which the excess moves,
+ *  because tab38 and tab14 never have opposite signs.
  */
 void
 ditherTo2bppLineLow(l_uint32  *lined,
@@ -686,61 +699,40 @@ ditherTo2bppLineLow(l_uint32  *lined,
                     l_int32   *tab14,
                     l_int32    lastlineflag)
 {
-l_int32  j;
-l_int32  oval, tab38val, tab14val;
-l_uint8  rval, bval, dval;
+l_int32   j, oval, tab38val, rval, bval, dval;
+l_uint32  word, mask;
 
-    if (lastlineflag == 0) {
-        for (j = 0; j < w - 1; j++) {
-            oval = GET_DATA_BYTE(bufs1, j);
-            SET_DATA_DIBIT(lined, j, tabval[oval]);
-            rval = GET_DATA_BYTE(bufs1, j + 1);
-            bval = GET_DATA_BYTE(bufs2, j);
-            dval = GET_DATA_BYTE(bufs2, j + 1);
-            tab38val = tab38[oval];
-            tab14val = tab14[oval];
-            if (tab38val < 0) {
-                rval = L_MAX(0, rval + tab38val);
-                bval = L_MAX(0, bval + tab38val);
-                dval = L_MAX(0, dval + tab14val);
-            }
-            else {
-                rval = L_MIN(255, rval + tab38val);
-                bval = L_MIN(255, bval + tab38val);
-                dval = L_MIN(255, dval + tab14val);
-            }
-            SET_DATA_BYTE(bufs1, j + 1, rval);
-            SET_DATA_BYTE(bufs2, j, bval);
-            SET_DATA_BYTE(bufs2, j + 1, dval);
+    oval = GET_DATA_BYTE(bufs1, 0);
+    bval = (lastlineflag == 0) ? GET_DATA_BYTE(bufs2, 0) : 0;
+    rval = 0;
+    word = 0;
+    for (j = 0; j < w; j++) {
+        word |= tabval[oval] << (30 - 2 * (j & 15));
+        if ((j & 15) == 15) {
+            lined[j >> 4] = word;
+            word = 0;
         }
 
-            /* do last column: j = w - 1 */
-        oval = GET_DATA_BYTE(bufs1, j);
-        SET_DATA_DIBIT(lined, j, tabval[oval]);
-        bval = GET_DATA_BYTE(bufs2, j);
         tab38val = tab38[oval];
-        if (tab38val < 0)
-            bval = L_MAX(0, bval + tab38val);
-        else
-            bval = L_MIN(255, bval + tab38val);
-        SET_DATA_BYTE(bufs2, j, bval);
-    }
-    else {   /* lastlineflag == 1 */
-        for (j = 0; j < w - 1; j++) {
-            oval = GET_DATA_BYTE(bufs1, j);
-            SET_DATA_DIBIT(lined, j, tabval[oval]);
-            rval = GET_DATA_BYTE(bufs1, j + 1);
-            tab38val = tab38[oval];
-            if (tab38val < 0)
-                rval = L_MAX(0, rval + tab38val);
-            else
-                rval = L_MIN(255, rval + tab38val);
+        if (j < w - 1) {
+            rval = GET_DATA_BYTE(bufs1, j + 1) + tab38val;
+            rval = L_MIN(255, L_MAX(0, rval));
             SET_DATA_BYTE(bufs1, j + 1, rval);
         }
-
-            /* do last pixel: (i, j) = (h - 1, w - 1) */
-        oval = GET_DATA_BYTE(bufs1, j);
-        SET_DATA_DIBIT(lined, j, tabval[oval]);
+        if (lastlineflag == 0) {
+            bval += tab38val;
+            bval = L_MIN(255, L_MAX(0, bval));
+            SET_DATA_BYTE(bufs2, j, bval);
+            if (j < w - 1) {
+                dval = GET_DATA_BYTE(bufs2, j + 1) + tab14[oval];
+                bval = L_MIN(255, L_MAX(0, dval));
+            }
+        }
+        oval = rval;
+    }
+    if ((w & 15) != 0) {  /* keep the dibits past the end of the line */
+        mask = 0xffffffff >> (2 * (w & 15));
+        lined[(w - 1) >> 4] = (lined[(w - 1) >> 4] & mask) | word;
     }
 
     return;
@@ -923,3 +915,157 @@ l_uint32  *lines, *lined;
     }
     return;
 }
+
+
+/*------------------------------------------------------------------*
+ *             Dithering from rgb to a table of colors              *
+ *------------------------------------------------------------------*/
+/*
+ *  ditherToCmapLow()
+ *
+ *  Low-level function for doing Floyd-Steinberg-like error diffusion
+ *  dithering from 32 bpp rgb (datas) to 8 bpp colormapped (datad).
+ *  This is shared by the octree and median cut color quantizers.
+ *
+ *  Each component is held in the line buffers in fixed point, with
+ *  6 fractional bits: the 8-bit value is multiplied by 64, so the
+ *  range is [0 ... 16383].  bufs1 and bufs2 each hold 3 * w values,
+ *  with the r, g and b components of each pixel together.
+ *
+ *  The color cell of a pixel is found from its truncated components
+ *  with three tables, as rtab[r] | gtab[g] | btab[b].  Each entry in
+ *  celltab gives the color of the cell in its r, g and b bytes and
+ *  the colormap index in the low-order byte.
+ *
+ *  The excess for each component, in units of 1/8 of the 8-bit
+ *  value, is limited to @difcap if @difcap > 0.  3/8 of it goes to
+ *  the pixels to the right and below, and 1/4 to the pixel
+ *  diagonally below.  There is no transfer from the last pixel
+ *  in each line, or from the last line.
+ */
+void
+ditherToCmapLow(l_uint32  *datad,
+                l_int32    w,
+                l_int32    h,
+                l_int32    wpld,
+                l_uint32  *datas,
+                l_int32    wpls,
+                l_int32   *bufs1,
+                l_int32   *bufs2,
+                l_uint32  *rtab,
+                l_uint32  *gtab,
+                l_uint32  *btab,
+                l_uint32  *celltab,
+                l_int32    difcap)
+{
+l_int32    i, j;
+l_int32   *buft;
+l_uint32   pixel;
+l_uint32  *lines, *lined;
+
+        /* Prime bufs2 with the first line */
+    for (j = 0; j < w; j++) {
+        pixel = datas[j];
+        bufs2[3 * j] = 64 * ((pixel >> L_RED_SHIFT) & 0xff);
+        bufs2[3 * j + 1] = 64 * ((pixel >> L_GREEN_SHIFT) & 0xff);
+        bufs2[3 * j + 2] = 64 * ((pixel >> L_BLUE_SHIFT) & 0xff);
+    }
+
+        /* Do all lines except the last line */
+    for (i = 0; i < h - 1; i++) {
+        buft = bufs1;  /* swap: bufs2 becomes the current line */
+        bufs1 = bufs2;
+        bufs2 = buft;
+        lines = datas + (i + 1) * wpls;
+        for (j = 0; j < w; j++) {
+            pixel = lines[j];
+            bufs2[3 * j] = 64 * ((pixel >> L_RED_SHIFT) & 0xff);
+            bufs2[3 * j + 1] = 64 * ((pixel >> L_GREEN_SHIFT) & 0xff);
+            bufs2[3 * j + 2] = 64 * ((pixel >> L_BLUE_SHIFT) & 0xff);
+        }
+        lined = datad + i * wpld;
+        ditherToCmapLineLow(lined, w, bufs1, bufs2, rtab, gtab, btab,
+                            celltab, difcap, 0);
+    }
+
+        /* Do the last line */
+    lined = datad + (h - 1) * wpld;
+    ditherToCmapLineLow(lined, w, bufs2, NULL, rtab, gtab, btab,
+                        celltab, difcap, 1);
+    return;
+}
+
+
+/*
+ *  ditherToCmapLineLow()
+ *
+ *      Input:  lined  (ptr to beginning of 8 bpp dest line)
+ *              w   (width of image in pixels)
+ *              bufs1 (buffer of current source line)
+ *              bufs2 (buffer of next source line)
+ *              rtab, gtab, btab (tables from component to cell index bits)
+ *              celltab (color and colormap index of each cell)
+ *              difcap (max excess transferred, in 1/8 units; 0 for none)
+ *              lastlineflag  (0 if not last dest line, 1 if last dest line)
+ *      Return: void
+ *
+ *  See ditherToCmapLow().  If lastlineflag == 1, bufs2 is not used,
+ *  and the pixels are mapped to cells without any transfer.
+ *
+ *  The buffers are always within [0 ... 16383], so clipping each
+ *  sum on both sides is the same as clipping on the side toward which
+ *  the excess moves, and it is done without a branch.
+ */
+void
+ditherToCmapLineLow(l_uint32  *lined,
+                    l_int32    w,
+                    l_int32   *bufs1,
+                    l_int32   *bufs2,
+                    l_uint32  *rtab,
+                    l_uint32  *gtab,
+                    l_uint32  *btab,
+                    l_uint32  *celltab,
+                    l_int32    difcap,
+                    l_int32    lastlineflag)
+{
+l_int32    j, k, dif, val;
+l_int32   *p1, *p2;
+l_uint32   cellval;
+
+    if (lastlineflag == 0) {
+        for (j = 0; j < w - 1; j++) {
+            p1 = bufs1 + 3 * j;
+            p2 = bufs2 + 3 * j;
+            cellval = celltab[rtab[p1[0] >> 6] | gtab[p1[1] >> 6] |
+                              btab[p1[2] >> 6]];
+            SET_DATA_BYTE(lined, j, cellval & 0xff);
+            for (k = 0; k < 3; k++) {
+                dif = (p1[k] >> 3) - 8 * ((cellval >> (24 - 8 * k)) & 0xff);
+                if (difcap > 0)
+                    dif = L_MIN(difcap, L_MAX(-difcap, dif));
+                val = p1[k + 3] + 3 * dif;
+                p1[k + 3] = L_MIN(16383, L_MAX(0, val));
+                val = p2[k] + 3 * dif;
+                p2[k] = L_MIN(16383, L_MAX(0, val));
+                val = p2[k + 3] + 2 * dif;
+                p2[k + 3] = L_MIN(16383, L_MAX(0, val));
+            }
+        }
+
+            /* Do the last pixel in the line; no transfer */
+        p1 = bufs1 + 3 * j;
+        cellval = celltab[rtab[p1[0] >> 6] | gtab[p1[1] >> 6] |
+                          btab[p1[2] >> 6]];
+        SET_DATA_BYTE(lined, j, cellval & 0xff);
+    }
+    else {  /* lastlineflag == 1 */
+        for (j = 0; j < w; j++) {
+            p1 = bufs1 + 3 * j;
+            cellval = celltab[rtab[p1[0] >> 6] | gtab[p1[1] >> 6] |
+                              btab[p1[2] >> 6]];
+            SET_DATA_BYTE(lined, j, cellval & 0xff);
+        }
+    }
+
+    return;
+}
@@ -0,0 +1,397 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  integral.c
+ *
+ *      Create/destroy
+ *          L_INTEGRAL  *integralCreate()
+ *          L_INTEGRAL  *integralClone()
+ *          void         integralDestroy()
+ *
+ *      Accessors
+ *          l_int32      integralGetDimensions()
+ *          l_int32      integralGetWpl()
+ *          l_uint64    *integralGetSumData()
+ *          l_uint64    *integralGetSumSqData()
+ *
+ *      Sums in a rectangle
+ *          l_int32      integralGetRectSum()
+ *
+ *  The integral image (or summed-area table) of a pix holds, at
+ *  each location, the sum of all pixel values above and to the left.
+ *  Once it is made, the sum of the pixel values in any rectangle
+ *  is found from 4 table entries, in a time that is independent of
+ *  the size of the rectangle.  If requested, a second table is made
+ *  in the same pass with the sum of the squared pixel values, so
+ *  that the variance in any rectangle can also be found in O(1).
+ *
+ *  The tables use 64-bit unsigned integers, so the sums are exact
+ *  for any image that can be held in memory.  (By comparison,
+ *  the 32 bpp accumulator made by pixBlockconvAccum() overflows
+ *  for large 8 bpp images; differences of accumulator values are
+ *  still correct, because of modular arithmetic, but only if the
+ *  true sum in the rectangle is less than 2^32.)
+ *
+ *  This is used for the windowed statistics and the block sum in
+ *  convolve.c, for Sauvola binarization, and for the statistics
+ *  in quadtree.c.  It can be made once and passed to any of these.
+ */
+
+#include <string.h>
+#include "allheaders.h"
+
+
+/*--------------------------------------------------------------------*
+ *                          Create/destroy                            *
+ *--------------------------------------------------------------------*/
+/*!
+ *  integralCreate()
+ *
+ *      Input:  pixs (1, 8 or 32 bpp; no colormap)
+ *              sqflag (1 to also make the table of sums of squares;
+ *                      0 otherwise)
+ *      Return: intg, or null on error
+ *
+ *  Notes:
+ *      (1) For 32 bpp, the pixel values are taken as 32 bit unsigned
+ *          integers, as in pixBlockconvAccum().  The sum of squares
+ *          is only available for 1 and 8 bpp, where it can not overflow.
+ *      (2) The entry at (x, y) in each table is found in a single pass,
+ *          using the running sum S along line y - 1 of pixs:
+ *             a(x, y) = a(x, y - 1) + S(x - 1)
+ *          The inner loop has no dependence between adjacent lines, and
+ *          it makes one sequential pass over the src and the tables.
+ */
+L_INTEGRAL *
+integralCreate(PIX     *pixs,
+               l_int32  sqflag)
+{
+l_int32      i, j, w, h, d, wpls, wpl;
+l_uint32     val;
+size_t       size;
+l_uint32    *datas, *lines;
+l_uint64     rowsum, rowsumsq;
+l_uint64    *line, *linep, *linesq, *linepsq;
+L_INTEGRAL  *intg;
+
+    PROCNAME("integralCreate");
+
+    if (!pixs)
+        return (L_INTEGRAL *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (pixGetColormap(pixs))
+        return (L_INTEGRAL *)ERROR_PTR("pixs has colormap", procName, NULL);
+    pixGetDimensions(pixs, &w, &h, &d);
+    if (d != 1 && d != 8 && d != 32)
+        return (L_INTEGRAL *)ERROR_PTR("pixs not 1, 8 or 32 bpp",
+                                       procName, NULL);
+    if (sqflag && d == 32)
+        return (L_INTEGRAL *)ERROR_PTR("no sum of squares for 32 bpp",
+                                       procName, NULL);
+
+        /* Each table has (w + 1) * (h + 1) entries of 8 bytes */
+    wpl = w + 1;
+    size = (size_t)wpl * (size_t)(h + 1);
+    if (size / (size_t)(h + 1) != (size_t)wpl ||
+        size > ((size_t)-1) / sizeof(l_uint64))
+        return (L_INTEGRAL *)ERROR_PTR("table too large", procName, NULL);
+
+    if ((intg = (L_INTEGRAL *)CALLOC(1, sizeof(L_INTEGRAL))) == NULL)
+        return (L_INTEGRAL *)ERROR_PTR("intg not made", procName, NULL);
+    intg->w = w;
+    intg->h = h;
+    intg->d = d;
+    intg->wpl = wpl;
+    intg->refcount = 1;
+    intg->sum = (l_uint64 *)CALLOC(size, sizeof(l_uint64));
+    if (sqflag)
+        intg->sumsq = (l_uint64 *)CALLOC(size, sizeof(l_uint64));
+    if (!intg->sum || (sqflag && !intg->sumsq)) {
+        integralDestroy(&intg);
+        return (L_INTEGRAL *)ERROR_PTR("table data not made", procName, NULL);
+    }
+
+        /* The first line and column of each table are left at 0 */
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
+    linesq = linepsq = NULL;
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        linep = intg->sum + (size_t)i * wpl + 1;
+        line = linep + wpl;
+        rowsum = 0;
+        if (d == 1) {
+            for (j = 0; j < w; j++) {
+                rowsum += GET_DATA_BIT(lines, j);
+                line[j] = linep[j] + rowsum;
+            }
+            if (sqflag)  /* the same table */
+                memcpy(intg->sumsq + (size_t)(i + 1) * wpl, line - 1,
+                       wpl * sizeof(l_uint64));
+        }
+        else if (d == 8 && !sqflag) {
+            for (j = 0; j < w; j++) {
+                rowsum += GET_DATA_BYTE(lines, j);
+                line[j] = linep[j] + rowsum;
+            }
+        }
+        else if (d == 8) {  /* sqflag */
+            linepsq = intg->sumsq + (size_t)i * wpl + 1;
+            linesq = linepsq + wpl;
+            rowsumsq = 0;
+            for (j = 0; j < w; j++) {
+                val = GET_DATA_BYTE(lines, j);
+                rowsum += val;
+                rowsumsq += val * val;
+                line[j] = linep[j] + rowsum;
+                linesq[j] = linepsq[j] + rowsumsq;
+            }
+        }
+        else {  /* d == 32 */
+            for (j = 0; j < w; j++) {
+                rowsum += lines[j];
+                line[j] = linep[j] + rowsum;
+            }
+        }
+    }
+
+    return intg;
+}
+
+
+/*!
+ *  integralClone()
+ *
+ *      Input:  intg
+ *      Return: same intg (ptr), or null on error
+ *
+ *  Notes:
+ *      (1) See pixClone() for definition and usage.
+ */
+L_INTEGRAL *
+integralClone(L_INTEGRAL  *intg)
+{
+    PROCNAME("integralClone");
+
+    if (!intg)
+        return (L_INTEGRAL *)ERROR_PTR("intg not defined", procName, NULL);
+    intg->refcount++;
+    return intg;
+}
+
+
+/*!
+ *  integralDestroy()
+ *
+ *      Input:  &intg (<will be nulled>)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Decrements the ref count and, if 0, destroys the intg.
+ *      (2) Always nulls the input ptr.
+ */
+void
+integralDestroy(L_INTEGRAL  **pintg)
+{
+L_INTEGRAL  *intg;
+
+    PROCNAME("integralDestroy");
+
+    if (!pintg) {
+        L_WARNING("ptr address is null!", procName);
+        return;
+    }
+    if ((intg = *pintg) == NULL)
+        return;
+
+    intg->refcount--;
+    if (intg->refcount <= 0) {
+        if (intg->sum) FREE(intg->sum);
+        if (intg->sumsq) FREE(intg->sumsq);
+        FREE(intg);
+    }
+    *pintg = NULL;
+    return;
+}
+
+
+/*--------------------------------------------------------------------*
+ *                             Accessors                              *
+ *--------------------------------------------------------------------*/
+/*!
+ *  integralGetDimensions()
+ *
+ *      Input:  intg
+ *              &w, &h, &d (<optional return> dimensions and depth
+ *                          of the src image)
+ *      Return: 0 if OK, 1 on error
+ */
+l_int32
+integralGetDimensions(L_INTEGRAL  *intg,
+                      l_int32     *pw,
+                      l_int32     *ph,
+                      l_int32     *pd)
+{
+    PROCNAME("integralGetDimensions");
+
+    if (pw) *pw = 0;
+    if (ph) *ph = 0;
+    if (pd) *pd = 0;
+    if (!intg)
+        return ERROR_INT("intg not defined", procName, 1);
+    if (pw) *pw = intg->w;
+    if (ph) *ph = intg->h;
+    if (pd) *pd = intg->d;
+    return 0;
+}
+
+
+/*!
+ *  integralGetWpl()
+ *
+ *      Input:  intg
+ *      Return: number of 64-bit entries on each line of the tables,
+ *              or 0 on error
+ *
+ *  Notes:
+ *      (1) This is w + 1, where w is the width of the src image.
+ */
+l_int32
+integralGetWpl(L_INTEGRAL  *intg)
+{
+    PROCNAME("integralGetWpl");
+
+    if (!intg)
+        return ERROR_INT("intg not defined", procName, 0);
+    return intg->wpl;
+}
+
+
+/*!
+ *  integralGetSumData()
+ *
+ *      Input:  intg
+ *      Return: ptr to the table of sums (not a copy), or null on error
+ *
+ *  Notes:
+ *      (1) The table has (h + 1) lines, each with (w + 1) entries.
+ *          The entry at (x, y) is the sum over src pixels (j, i)
+ *          with j < x and i < y.
+ */
+l_uint64 *
+integralGetSumData(L_INTEGRAL  *intg)
+{
+    PROCNAME("integralGetSumData");
+
+    if (!intg)
+        return (l_uint64 *)ERROR_PTR("intg not defined", procName, NULL);
+    return intg->sum;
+}
+
+
+/*!
+ *  integralGetSumSqData()
+ *
+ *      Input:  intg
+ *      Return: ptr to the table of sums of squares (not a copy),
+ *              or null on error or if it was not made
+ *
+ *  Notes:
+ *      (1) See integralGetSumData() for the layout.
+ */
+l_uint64 *
+integralGetSumSqData(L_INTEGRAL  *intg)
+{
+    PROCNAME("integralGetSumSqData");
+
+    if (!intg)
+        return (l_uint64 *)ERROR_PTR("intg not defined", procName, NULL);
+    return intg->sumsq;
+}
+
+
+/*--------------------------------------------------------------------*
+ *                        Sums in a rectangle                         *
+ *--------------------------------------------------------------------*/
+/*!
+ *  integralGetRectSum()
+ *
+ *      Input:  intg
+ *              x, y, w, h (rectangle; must be within the src image)
+ *              &sum (<optional return> sum of pixel values)
+ *              &sumsq (<optional return> sum of squared pixel values)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This takes O(1) time, independent of the size of the
+ *          rectangle.  Clip the rectangle to the image before calling,
+ *          e.g., with boxClipToRectangle().
+ *      (2) The sums are exact integers; they are returned as doubles,
+ *          which represent integers exactly up to 2^53.
+ *      (3) It is an error to request @sumsq if the table of sums of
+ *          squares was not made.
+ */
+l_int32
+integralGetRectSum(L_INTEGRAL  *intg,
+                   l_int32      x,
+                   l_int32      y,
+                   l_int32      w,
+                   l_int32      h,
+                   l_float64   *psum,
+                   l_float64   *psumsq)
+{
+l_int32    wpl;
+l_uint64  *line1, *line2;
+
+    PROCNAME("integralGetRectSum");
+
+    if (psum) *psum = 0.0;
+    if (psumsq) *psumsq = 0.0;
+    if (!psum && !psumsq)
+        return ERROR_INT("no output requested", procName, 1);
+    if (!intg)
+        return ERROR_INT("intg not defined", procName, 1);
+    if (x < 0 || y < 0 || w < 0 || h < 0 ||
+        x + w > intg->w || y + h > intg->h)
+        return ERROR_INT("rectangle not within image", procName, 1);
+    if (psumsq && !intg->sumsq)
+        return ERROR_INT("sums of squares not made", procName, 1);
+
+    wpl = intg->wpl;
+    if (psum) {
+        line1 = intg->sum + (size_t)y * wpl;
+        line2 = line1 + (size_t)h * wpl;
+        *psum = (l_float64)(line2[x + w] - line2[x] - line1[x + w] + line1[x]);
+    }
+    if (psumsq) {
+        line1 = intg->sumsq + (size_t)y * wpl;
+        line2 = line1 + (size_t)h * wpl;
+        *psumsq =
+            (l_float64)(line2[x + w] - line2[x] - line1[x + w] + line1[x]);
+    }
+    return 0;
+}
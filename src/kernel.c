@@ -47,6 +47,10 @@
  *            L_KERNEL   *kernelNormalize()
  *            L_KERNEL   *kernelInvert()
  *
+ *         Analysis for choosing a convolution method
+ *            l_int32     kernelGetConvolveType()
+ *            static void kernelClearConvolveType()
+ *
  *         Helper function
  *            l_float32 **create2dFloatArray()
  *
@@ -82,6 +86,16 @@
 #include <math.h>
 #include "allheaders.h"
 
+    /* Largest sum of absolute values of an integer kernel for which
+     * the convolution of 8 or 16 bpp pixels is done in integer
+     * arithmetic without overflow (65535 * 32767 < 2^31) */
+static const l_int32  MAX_INTEGER_KERNEL_SUM = 32767;
+
+    /* Relative tolerance for the rank-1 test for separability */
+static const l_float32  SEPARABLE_TOLERANCE = 0.00001;
+
+static void kernelClearConvolveType(L_KERNEL *kel);
+
 
 /*------------------------------------------------------------------------*
  *                           Create / Destroy                             *
@@ -140,6 +154,7 @@ L_KERNEL  *kel;
     for (i = 0; i < kel->sy; i++)
         FREE(kel->data[i]);
     FREE(kel->data);
+    kernelClearConvolveType(kel);
     FREE(kel);
 
     *pkel = NULL;
@@ -237,6 +252,7 @@ kernelSetElement(L_KERNEL  *kel,
         return ERROR_INT("kernel col out of bounds", procName, 1);
 
     kel->data[row][col] = val;
+    kernelClearConvolveType(kel);
     return 0;
 }
 
@@ -455,6 +471,140 @@ L_KERNEL  *keld;
 }
 
 
+/*----------------------------------------------------------------------*
+ *              Analysis for choosing a convolution method              *
+ *----------------------------------------------------------------------*/
+/*!
+ *  kernelGetConvolveType()
+ *
+ *      Input:  kernel
+ *              &type (<return> L_KERNEL_GENERAL, L_KERNEL_INTEGER or
+ *                     L_KERNEL_SEPARABLE)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This is used by pixConvolve() to choose the fastest method.
+ *          A kernel is L_KERNEL_SEPARABLE if it is 2D and has rank 1;
+ *          i.e., if it is the outer product of a column vector and a
+ *          row vector.  The factors are then stored in the kernel,
+ *          in kel->colfact and kel->rowfact.  Otherwise, the kernel
+ *          is L_KERNEL_INTEGER if all values are integers and the sum
+ *          of their absolute values is small enough that an 8 or 16 bpp
+ *          convolution can be done in 32 bit integer arithmetic.
+ *      (2) The rank 1 test takes the element of largest magnitude,
+ *          a[p][q], as pivot, and checks that every element satisfies
+ *              a[i][j] = a[i][q] * a[p][j] / a[p][q]
+ *          to within a small fraction of a[p][q].  This is exact for a
+ *          rank 1 matrix and requires no general matrix decomposition.
+ *      (3) The result is computed on the first call and cached in
+ *          the kernel.  It is cleared by kernelSetElement().  If you
+ *          change kel->data directly, you are responsible for the
+ *          consequences.
+ */
+l_int32
+kernelGetConvolveType(L_KERNEL  *kel,
+                      l_int32   *ptype)
+{
+l_int32     sx, sy, i, j, p, q, isint;
+l_float32   val, maxabs, sumabs, pivot, tol;
+l_float32  *colfact, *rowfact;
+
+    PROCNAME("kernelGetConvolveType");
+
+    if (!ptype)
+        return ERROR_INT("&type not defined", procName, 1);
+    *ptype = L_KERNEL_GENERAL;
+    if (!kel)
+        return ERROR_INT("kernel not defined", procName, 1);
+
+    if (kel->convtype != L_KERNEL_UNKNOWN) {
+        *ptype = kel->convtype;
+        return 0;
+    }
+
+        /* Find the pivot, and test for small integer values */
+    kernelGetParameters(kel, &sy, &sx, NULL, NULL);
+    p = q = 0;
+    maxabs = sumabs = 0.0;
+    isint = TRUE;
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            val = kel->data[i][j];
+            if (val != (l_float32)((l_int32)val))
+                isint = FALSE;
+            val = L_ABS(val);
+            sumabs += val;
+            if (val > maxabs) {
+                maxabs = val;
+                p = i;
+                q = j;
+            }
+        }
+    }
+    if (sumabs > MAX_INTEGER_KERNEL_SUM)
+        isint = FALSE;
+    kel->convtype = (isint) ? L_KERNEL_INTEGER : L_KERNEL_GENERAL;
+
+        /* Test for rank 1.  A 1D kernel gains nothing from this. */
+    if (sx > 1 && sy > 1 && maxabs > 0.0) {
+        colfact = (l_float32 *)CALLOC(sy, sizeof(l_float32));
+        rowfact = (l_float32 *)CALLOC(sx, sizeof(l_float32));
+        if (!colfact || !rowfact) {
+            FREE(colfact);
+            FREE(rowfact);
+            return ERROR_INT("factors not made", procName, 1);
+        }
+        pivot = kel->data[p][q];
+        for (i = 0; i < sy; i++)
+            colfact[i] = kel->data[i][q];
+        for (j = 0; j < sx; j++)
+            rowfact[j] = kel->data[p][j] / pivot;
+        tol = SEPARABLE_TOLERANCE * maxabs;
+        for (i = 0; i < sy; i++) {
+            for (j = 0; j < sx; j++) {
+                val = kel->data[i][j] - colfact[i] * rowfact[j];
+                if (L_ABS(val) > tol)
+                    break;
+            }
+            if (j < sx)
+                break;
+        }
+        if (i == sy) {
+            kel->convtype = L_KERNEL_SEPARABLE;
+            kel->colfact = colfact;
+            kel->rowfact = rowfact;
+        }
+        else {
+            FREE(colfact);
+            FREE(rowfact);
+        }
+    }
+
+    *ptype = kel->convtype;
+    return 0;
+}
+
+
+/*!
+ *  kernelClearConvolveType()
+ *
+ *      Input:  kernel
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Removes the cached result of kernelGetConvolveType().
+ */
+static void
+kernelClearConvolveType(L_KERNEL  *kel)
+{
+    if (kel->colfact) FREE(kel->colfact);
+    if (kel->rowfact) FREE(kel->rowfact);
+    kel->colfact = kel->rowfact = NULL;
+    kel->convtype = L_KERNEL_UNKNOWN;
+    return;
+}
+
+
 /*----------------------------------------------------------------------*
  *                            Helper function                           *
  *----------------------------------------------------------------------*/
@@ -27,7 +27,7 @@
 /*
  *  morph.c
  *
- *     Generic binary morphological ops implemented with rasterop
+ *     Generic binary morphological ops
  *         PIX     *pixDilate()
  *         PIX     *pixErode()
  *         PIX     *pixHMT()
@@ -36,6 +36,18 @@
  *         PIX     *pixCloseSafe()
  *         PIX     *pixOpenGeneralized()
  *         PIX     *pixCloseGeneralized()
+ *         PIX     *pixMorphAddBorder()
+ *         PIX     *pixMorphRemoveBorder()
+ *
+ *     Binary morphology by horizontal bands
+ *         l_int32  pixMorphBand()
+ *         PIX     *pixMorphByBand()
+ *
+ *     Morphology with many Sels
+ *         PIXA    *pixHMTMultiple()
+ *         l_int32  pixMorphSelaBand()
+ *         static l_int32  morphMakeTerms()
+ *         static l_int32  morphMultipleLow()
  *
  *     Binary morphological (raster) ops with brick Sels
  *         PIX     *pixDilateBrick()
@@ -57,8 +69,22 @@
  *         void     resetMorphBoundaryCondition()
  *         l_int32  getMorphBorderPixelColor()
  *
+ *     Decomposition of large Sels
+ *         SELA    *selMakeMorphPlan()
+ *         static l_int32  morphPlanFactor()
+ *         static l_int32  morphGridCost()
+ *         static SEL     *selCreateFromGrid()
+ *         static l_int32  morphApplySel()
+ *         static l_int32  morphApplyPlan()
+ *
+ *     Destination word accumulation for arbitrary Sels
+ *         static l_int32  morphWordAccum()
+ *         static l_int32  morphFindRuns()
+ *         static l_int32  morphRunTransformCost()
+ *         static void     runTransformLow()
+ *         static void     accumulateLineLow()
+ *
  *     Static helpers for arg processing
- *         static PIX     *processMorphArgs1()
  *         static PIX     *processMorphArgs2()
  *
  *  You are provided with many simple ways to do binary morphology.
@@ -120,7 +146,13 @@
  *      You always get the result as a new Pix.  See morphseq.c for details.
  *
  *  If you are using Sels that are not bricks, you have two choices:
- *      (a) simplest: use the basic rasterop implementations (pixDilate(), ...)
+ *      (a) simplest: use the generic implementations (pixDilate(), ...).
+ *          These accumulate shifted source words for all the Sel
+ *          elements in a single pass over the destination, so the
+ *          cost grows slowly with the number of elements.  Large
+ *          Sels are first factored, where possible, into a sequence
+ *          of smaller ones that give exactly the same result; see
+ *          selMakeMorphPlan().
  *      (b) fastest: generate the destination word accumumlation (dwa)
  *          code for your Sels and compile it with the library.
  *
@@ -136,7 +168,7 @@
  *  convention for boundary pixels in dilation and erosion:
  *      All pixels outside the image are assumed to be OFF
  *      for both dilation and erosion.
- *  To use a symmetric definition, see comments in pixErode()
+ *  To use a symmetric definition, see notes in morphWordAccum()
  *  and reset MORPH_BC to SYMMETRIC_MORPH_BC, using
  *  resetMorphBoundaryCondition().
  *
@@ -160,6 +192,7 @@
  *  prog/binmorph2_reg.c, and prog/binmorph3_reg.c.
  */
 
+#include <string.h>
 #include <math.h>
 #include "allheaders.h"
 
@@ -172,13 +205,55 @@ LEPT_DLL l_int32  MORPH_BC = ASYMMETRIC_MORPH_BC;
     /* We accept this cost in extra rasterops for decomposing exactly. */
 static const l_int32  ACCEPTABLE_COST = 5;
 
-    /* Static helpers for arg processing */
-static PIX * processMorphArgs1(PIX *pixd, PIX *pixs, SEL *sel, PIX **ppixt);
+    /* Operations for accumulating shifted source lines */
+enum {
+    L_ACCUM_OR = 1,
+    L_ACCUM_AND = 2,
+    L_ACCUM_AND_NOT = 3
+};
+
+    /* Sels with fewer hits than this are not decomposed */
+static const l_int32  MIN_PLAN_HITS = 16;
+
+    /* Sels with more elements than this are not combined with
+     * the others in pixMorphSelaBand() */
+static const l_int32  MAX_MULTI_TERMS = 64;
+
+    /* Static helpers for Sel decomposition, word accumulation,
+     * many Sels and arg processing */
+static l_int32 morphPlanFactor(l_int32 *grid, l_int32 gw, l_int32 gh,
+                               SELA *sela);
+static l_int32 morphGridCost(l_int32 *grid, l_int32 gw, l_int32 gh);
+static SEL *selCreateFromGrid(l_int32 *grid, l_int32 gw, l_int32 gh);
+static l_int32 morphApplySel(PIX *pixd, PIX *pixs, SEL *sel, SELA *plan,
+                             l_int32 type, l_int32 xoff, l_int32 yoff);
+static l_int32 morphApplyPlan(PIX *pixd, PIX *pixs, SEL *sel, SELA *plan,
+                              l_int32 type, l_int32 xoff, l_int32 yoff);
+static l_int32 morphWordAccum(PIX *pixd, PIX *pixs, SEL *sel, l_int32 type,
+                              l_int32 xoff, l_int32 yoff);
+static l_int32 morphFindRuns(l_int32 *grid, l_int32 gw, l_int32 gh,
+                             l_int32 maxox, l_int32 maxoy, l_int32 dir,
+                             l_int32 *tlen, l_int32 *tox, l_int32 *toy,
+                             l_int32 *tmiss);
+static l_int32 morphRunTransformCost(l_int32 *tlen, l_int32 *tmiss,
+                                     l_int32 n, l_int32 type);
+static void runTransformLow(l_uint32 *data, l_int32 wpl, l_int32 h,
+                            l_int32 size, l_int32 dir, l_int32 op,
+                            l_uint32 bordval);
+static void accumulateLineLow(l_uint32 *lined, l_uint32 *lines, l_int32 wpl,
+                              l_int32 shift, l_int32 op);
+static l_int32 morphMakeTerms(SEL *sel, l_int32 type, l_float32 fract,
+                              l_int32 **ptox, l_int32 **ptoy,
+                              l_int32 **ptmiss, l_int32 *pnterms);
+static l_int32 morphMultipleLow(PIX **pixd, l_int32 n, PIX *pixh, PIX *pixm,
+                                l_int32 **tox, l_int32 **toy,
+                                l_int32 **tmiss, l_int32 *nterms, PIX **pixc,
+                                l_int32 type, l_int32 op, l_int32 y);
 static PIX * processMorphArgs2(PIX *pixd, PIX *pixs, SEL *sel);
 
 
 /*-----------------------------------------------------------------*
- *    Generic binary morphological ops implemented with rasterop   *
+ *               Generic binary morphological ops                  *
  *-----------------------------------------------------------------*/
 /*!
  *  pixDilate()
@@ -200,34 +275,28 @@ static PIX * processMorphArgs2(PIX *pixd, PIX *pixs, SEL *sel);
  *          (b) pixDilate(pixs, pixs, ...);
  *          (c) pixDilate(pixd, pixs, ...);
  *      (4) The size of the result is determined by pixs.
+ *      (5) This is done in one pass; see morphWordAccum().  A large
+ *          Sel may first be factored into a sequence of smaller Sels;
+ *          see selMakeMorphPlan().
  */
 PIX *
 pixDilate(PIX  *pixd,
           PIX  *pixs,
           SEL  *sel)
 {
-l_int32  i, j, w, h, sx, sy, cx, cy, seldata;
-PIX     *pixt;
+l_int32  newpix;
 
     PROCNAME("pixDilate");
 
-    if ((pixd = processMorphArgs1(pixd, pixs, sel, &pixt)) == NULL)
-        return (PIX *)ERROR_PTR("processMorphArgs1 failed", procName, pixd);
+    newpix = (pixd == NULL);
+    if ((pixd = processMorphArgs2(pixd, pixs, sel)) == NULL)
+        return (PIX *)ERROR_PTR("processMorphArgs2 failed", procName, pixd);
 
-    pixGetDimensions(pixs, &w, &h, NULL);
-    selGetParameters(sel, &sy, &sx, &cy, &cx);
-    pixClearAll(pixd);
-    for (i = 0; i < sy; i++) {
-        for (j = 0; j < sx; j++) {
-            seldata = sel->data[i][j];
-            if (seldata == 1) {   /* src | dst */
-                pixRasterop(pixd, j - cx, i - cy, w, h, PIX_SRC | PIX_DST,
-                            pixt, 0, 0);
-            }
-        }
+    if (morphApplySel(pixd, pixs, sel, NULL, L_MORPH_DILATE, 0, 0)) {
+        if (newpix)
+            pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("dilation failed", procName, NULL);
     }
-
-    pixDestroy(&pixt);
     return pixd;
 }
 
@@ -252,53 +321,28 @@ PIX     *pixt;
  *          (b) pixErode(pixs, pixs, ...);
  *          (c) pixErode(pixd, pixs, ...);
  *      (4) The size of the result is determined by pixs.
+ *      (5) This is done in one pass; see morphWordAccum().  A large
+ *          Sel may first be factored into a sequence of smaller Sels;
+ *          see selMakeMorphPlan().
  */
 PIX *
 pixErode(PIX  *pixd,
          PIX  *pixs,
          SEL  *sel)
 {
-l_int32  i, j, w, h, sx, sy, cx, cy, seldata;
-l_int32  xp, yp, xn, yn;
-PIX     *pixt;
+l_int32  newpix;
 
     PROCNAME("pixErode");
 
-    if ((pixd = processMorphArgs1(pixd, pixs, sel, &pixt)) == NULL)
-        return (PIX *)ERROR_PTR("processMorphArgs1 failed", procName, pixd);
-
-    pixGetDimensions(pixs, &w, &h, NULL);
-    selGetParameters(sel, &sy, &sx, &cy, &cx);
-    pixSetAll(pixd);
-    for (i = 0; i < sy; i++) {
-        for (j = 0; j < sx; j++) {
-            seldata = sel->data[i][j];
-            if (seldata == 1) {   /* src & dst */
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
-                                pixt, 0, 0);
-            }
-        }
-    }
+    newpix = (pixd == NULL);
+    if ((pixd = processMorphArgs2(pixd, pixs, sel)) == NULL)
+        return (PIX *)ERROR_PTR("processMorphArgs2 failed", procName, pixd);
 
-        /* Clear near edges.  We do this for the asymmetric boundary
-         * condition convention that implements erosion assuming all
-         * pixels surrounding the image are OFF.  If you use a
-         * use a symmetric b.c. convention, where the erosion is
-         * implemented assuming pixels surrounding the image
-         * are ON, these operations are omitted.  */
-    if (MORPH_BC == ASYMMETRIC_MORPH_BC) {
-        selFindMaxTranslations(sel, &xp, &yp, &xn, &yn);
-        if (xp > 0)
-            pixRasterop(pixd, 0, 0, xp, h, PIX_CLR, NULL, 0, 0);
-        if (xn > 0)
-            pixRasterop(pixd, w - xn, 0, xn, h, PIX_CLR, NULL, 0, 0);
-        if (yp > 0)
-            pixRasterop(pixd, 0, 0, w, yp, PIX_CLR, NULL, 0, 0);
-        if (yn > 0)
-            pixRasterop(pixd, 0, h - yn, w, yn, PIX_CLR, NULL, 0, 0);
+    if (morphApplySel(pixd, pixs, sel, NULL, L_MORPH_ERODE, 0, 0)) {
+        if (newpix)
+            pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("erosion failed", procName, NULL);
     }
-
-    pixDestroy(&pixt);
     return pixd;
 }
 
@@ -325,67 +369,26 @@ PIX     *pixt;
  *          (b) pixHMT(pixs, pixs, ...);
  *          (c) pixHMT(pixd, pixs, ...);
  *      (4) The size of the result is determined by pixs.
+ *      (5) This is done in one pass; see morphWordAccum().
  */
 PIX *
 pixHMT(PIX  *pixd,
        PIX  *pixs,
        SEL  *sel)
 {
-l_int32  i, j, w, h, sx, sy, cx, cy, firstrasterop, seldata;
-l_int32  xp, yp, xn, yn;
-PIX     *pixt;
+l_int32  newpix;
 
     PROCNAME("pixHMT");
 
-    if ((pixd = processMorphArgs1(pixd, pixs, sel, &pixt)) == NULL)
-        return (PIX *)ERROR_PTR("processMorphArgs1 failed", procName, pixd);
+    newpix = (pixd == NULL);
+    if ((pixd = processMorphArgs2(pixd, pixs, sel)) == NULL)
+        return (PIX *)ERROR_PTR("processMorphArgs2 failed", procName, pixd);
 
-    pixGetDimensions(pixs, &w, &h, NULL);
-    selGetParameters(sel, &sy, &sx, &cy, &cx);
-    firstrasterop = TRUE;
-    for (i = 0; i < sy; i++) {
-        for (j = 0; j < sx; j++) {
-            seldata = sel->data[i][j];
-            if (seldata == 1) {  /* hit */
-                if (firstrasterop == TRUE) {  /* src only */
-                    pixClearAll(pixd);
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC,
-                                pixt, 0, 0);
-                    firstrasterop = FALSE;
-                }
-                else {   /* src & dst */
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
-                                pixt, 0, 0);
-                }
-            }
-            else if (seldata == 2) {  /* miss */
-                if (firstrasterop == TRUE) {  /* ~src only */
-                    pixSetAll(pixd);
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_NOT(PIX_SRC),
-                             pixt, 0, 0);
-                    firstrasterop = FALSE;
-                }
-                else  {  /* ~src & dst */
-                    pixRasterop(pixd, cx - j, cy - i, w, h,
-                                PIX_NOT(PIX_SRC) & PIX_DST,
-                                pixt, 0, 0);
-                }
-            }
-        }
+    if (morphWordAccum(pixd, pixs, sel, L_MORPH_HMT, 0, 0)) {
+        if (newpix)
+            pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("hmt failed", procName, NULL);
     }
-
-        /* Clear near edges */
-    selFindMaxTranslations(sel, &xp, &yp, &xn, &yn);
-    if (xp > 0)
-        pixRasterop(pixd, 0, 0, xp, h, PIX_CLR, NULL, 0, 0);
-    if (xn > 0)
-        pixRasterop(pixd, w - xn, 0, xn, h, PIX_CLR, NULL, 0, 0);
-    if (yp > 0)
-        pixRasterop(pixd, 0, 0, w, yp, PIX_CLR, NULL, 0, 0);
-    if (yn > 0)
-        pixRasterop(pixd, 0, h - yn, w, yn, PIX_CLR, NULL, 0, 0);
-
-    pixDestroy(&pixt);
     return pixd;
 }
 
@@ -493,6 +496,8 @@ PIX  *pixt;
  *          sufficient size to avoid losing pixels from the dilation,
  *          and it removes the border after the operation is finished.
  *          It thus enforces a correct extensive result for closing.
+ *          The border is added by the dilation and removed by the
+ *          erosion, so the image is not copied to do this.
  *      (3) If symmetric b.c. are used, it is not necessary to add
  *          and remove this border.
  *      (4) There are three cases:
@@ -511,7 +516,7 @@ pixCloseSafe(PIX  *pixd,
              SEL  *sel)
 {
 l_int32  xp, yp, xn, yn, xmax, xbord;
-PIX     *pixt1, *pixt2;
+PIX     *pixt;
 
     PROCNAME("pixCloseSafe");
 
@@ -530,18 +535,12 @@ PIX     *pixt1, *pixt2;
     xmax = L_MAX(xp, xn);
     xbord = 32 * ((xmax + 31) / 32);  /* full 32 bit words */
 
-    if ((pixt1 = pixAddBorderGeneral(pixs, xbord, xbord, yp, yn, 0)) == NULL)
-        return (PIX *)ERROR_PTR("pixt1 not made", procName, pixd);
-    pixClose(pixt1, pixt1, sel);
-    if ((pixt2 = pixRemoveBorderGeneral(pixt1, xbord, xbord, yp, yn)) == NULL)
-        return (PIX *)ERROR_PTR("pixt2 not made", procName, pixd);
-    pixDestroy(&pixt1);
-
-    if (!pixd)
-        return pixt2;
-
-    pixCopy(pixd, pixt2);
-    pixDestroy(&pixt2);
+    if ((pixt = pixMorphAddBorder(pixs, sel, L_MORPH_DILATE,
+                                  xbord, xbord, yp, yn)) == NULL)
+        return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
+    pixd = pixMorphRemoveBorder(pixd, pixt, sel, L_MORPH_ERODE,
+                                xbord, xbord, yp, yn);
+    pixDestroy(&pixt);
     return pixd;
 }
 
@@ -632,7 +631,977 @@ PIX  *pixt;
     pixHMT(pixd, pixt, sel);
     pixDestroy(&pixt);
 
-    return pixd;
+    return pixd;
+}
+
+
+/*!
+ *  pixMorphAddBorder()
+ *
+ *      Input:  pixs (1 bpp)
+ *              sel
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE)
+ *              left, right, top, bot (border to be added, in pixels)
+ *      Return: pixd (larger than pixs by the border), or null on error
+ *
+ *  Notes:
+ *      (1) This gives the same result as adding a border to pixs,
+ *          with pixels at the b.c. value for the operation, and then
+ *          dilating or eroding.  pixs is not copied: the result is
+ *          computed directly for the enlarged region.
+ *      (2) Use this with pixMorphRemoveBorder() for sequences that
+ *          need intermediate results outside the image, such as
+ *          the safe closing and composite bricks.  The intermediate
+ *          operations are done on the bordered image with the
+ *          usual functions.
+ */
+PIX *
+pixMorphAddBorder(PIX     *pixs,
+                  SEL     *sel,
+                  l_int32  type,
+                  l_int32  left,
+                  l_int32  right,
+                  l_int32  top,
+                  l_int32  bot)
+{
+l_int32  w, h;
+PIX     *pixd;
+
+    PROCNAME("pixMorphAddBorder");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, NULL);
+    if (pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, NULL);
+    if (type != L_MORPH_DILATE && type != L_MORPH_ERODE)
+        return (PIX *)ERROR_PTR("invalid type", procName, NULL);
+    if (left < 0 || right < 0 || top < 0 || bot < 0)
+        return (PIX *)ERROR_PTR("negative border added", procName, NULL);
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if ((pixd = pixCreate(w + left + right, h + top + bot, 1)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    pixCopyResolution(pixd, pixs);
+    pixCopyInputFormat(pixd, pixs);
+    if (morphApplySel(pixd, pixs, sel, NULL, type, -left, -top)) {
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("sel not applied", procName, NULL);
+    }
+    return pixd;
+}
+
+
+/*!
+ *  pixMorphRemoveBorder()
+ *
+ *      Input:  pixd (<optional>; this can be null or different from pixs)
+ *              pixs (1 bpp)
+ *              sel
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE)
+ *              left, right, top, bot (border to be removed, in pixels)
+ *      Return: pixd (smaller than pixs by the border), or null on error
+ *
+ *  Notes:
+ *      (1) This gives the same result as dilating or eroding pixs
+ *          and then removing a border.  Only the pixels that remain
+ *          are computed, and they are written directly to pixd.
+ *      (2) If pixd is given and is not of the size of the result,
+ *          its image data is replaced.
+ */
+PIX *
+pixMorphRemoveBorder(PIX     *pixd,
+                     PIX     *pixs,
+                     SEL     *sel,
+                     l_int32  type,
+                     l_int32  left,
+                     l_int32  right,
+                     l_int32  top,
+                     l_int32  bot)
+{
+l_int32  w, h, wd, hd, newpix;
+PIX     *pixt;
+
+    PROCNAME("pixMorphRemoveBorder");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, pixd);
+    if (pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, pixd);
+    if (type != L_MORPH_DILATE && type != L_MORPH_ERODE)
+        return (PIX *)ERROR_PTR("invalid type", procName, pixd);
+    if (left < 0 || right < 0 || top < 0 || bot < 0)
+        return (PIX *)ERROR_PTR("negative border removed", procName, pixd);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    wd = w - left - right;
+    hd = h - top - bot;
+    if (wd <= 0 || hd <= 0)
+        return (PIX *)ERROR_PTR("width or height <= 0", procName, pixd);
+    if (pixd == pixs && (wd != w || hd != h))
+        return (PIX *)ERROR_PTR("pixd == pixs, but border not 0",
+                                procName, pixd);
+
+    newpix = (pixd == NULL);
+    if (!pixd || pixGetWidth(pixd) != wd || pixGetHeight(pixd) != hd ||
+        pixGetDepth(pixd) != 1) {
+        if ((pixt = pixCreate(wd, hd, 1)) == NULL)
+            return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
+        pixCopyResolution(pixt, pixs);
+        pixCopyInputFormat(pixt, pixs);
+        if (!pixd)
+            pixd = pixt;
+        else
+            pixTransferAllData(pixd, &pixt, 0, 0);
+    }
+    if (morphApplySel(pixd, pixs, sel, NULL, type, left, top)) {
+        if (newpix)
+            pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("sel not applied", procName, pixd);
+    }
+    return pixd;
+}
+
+
+/*-----------------------------------------------------------------*
+ *             Binary morphology by horizontal bands               *
+ *-----------------------------------------------------------------*/
+/*!
+ *  pixMorphBand()
+ *
+ *      Input:  pixd (1 bpp, same size as pixs; not pixs)
+ *              pixs (1 bpp)
+ *              sel
+ *              plan (<optional> from selMakeMorphPlan(sel); can be null)
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_OPEN,
+ *                    L_MORPH_CLOSE, L_MORPH_HMT)
+ *              y (first row of the band)
+ *              h (number of rows in the band)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This computes rows y through y + h - 1 of the result of
+ *          pixDilate(), pixErode(), pixOpen(), pixClose() or pixHMT(),
+ *          and writes them into the same rows of pixd.  The other
+ *          rows of pixd are not touched.  The result is identical
+ *          to that of the function on the whole image.
+ *      (2) For dilation, erosion and HMT, the band is computed
+ *          directly from pixs, which is only read.  For opening and
+ *          closing, the first operation is done on the band extended
+ *          above and below by the farthest row that the Sel reaches
+ *          from its origin (the halo), and the second operation
+ *          uses that.
+ *      (3) Bands that do not overlap can be done in any order, and
+ *          concurrently, with the same pixs, pixd, sel and plan.
+ *          None of them is changed except for the band in pixd.
+ *      (4) If plan is null, the decomposition of sel, if any, is made
+ *          for each band.  To avoid that, make it once with
+ *          selMakeMorphPlan() and pass it to every band.  It is not
+ *          used for the HMT.
+ */
+l_int32
+pixMorphBand(PIX     *pixd,
+             PIX     *pixs,
+             SEL     *sel,
+             SELA    *plan,
+             l_int32  type,
+             l_int32  y,
+             l_int32  h)
+{
+l_int32  w, hs, sy, cy, halo, y0, y1, op1, op2, ret;
+PIX     *pixb, *pixt;
+
+    PROCNAME("pixMorphBand");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return ERROR_INT("pixs undefined or not 1 bpp", procName, 1);
+    if (!pixd || pixd == pixs)
+        return ERROR_INT("pixd undefined or equal to pixs", procName, 1);
+    if (!sel)
+        return ERROR_INT("sel not defined", procName, 1);
+    pixGetDimensions(pixs, &w, &hs, NULL);
+    if (pixGetWidth(pixd) != w || pixGetHeight(pixd) != hs ||
+        pixGetDepth(pixd) != 1)
+        return ERROR_INT("pixd and pixs sizes differ", procName, 1);
+    if (y < 0 || h <= 0 || y + h > hs)
+        return ERROR_INT("band not in image", procName, 1);
+
+    if ((pixb = pixCreate(w, h, 1)) == NULL)
+        return ERROR_INT("pixb not made", procName, 1);
+    switch (type)
+    {
+    case L_MORPH_DILATE:
+    case L_MORPH_ERODE:
+        ret = morphApplySel(pixb, pixs, sel, plan, type, 0, y);
+        break;
+    case L_MORPH_HMT:
+        ret = morphWordAccum(pixb, pixs, sel, L_MORPH_HMT, 0, y);
+        break;
+    case L_MORPH_OPEN:
+    case L_MORPH_CLOSE:
+        op1 = (type == L_MORPH_OPEN) ? L_MORPH_ERODE : L_MORPH_DILATE;
+        op2 = (type == L_MORPH_OPEN) ? L_MORPH_DILATE : L_MORPH_ERODE;
+        selGetParameters(sel, &sy, NULL, &cy, NULL);
+        halo = L_MAX(L_ABS(cy), L_ABS(sy - 1 - cy));
+        y0 = L_MAX(0, y - halo);
+        y1 = L_MIN(hs, y + h + halo);
+        if ((pixt = pixCreate(w, y1 - y0, 1)) == NULL) {
+            pixDestroy(&pixb);
+            return ERROR_INT("pixt not made", procName, 1);
+        }
+        ret = morphApplySel(pixt, pixs, sel, plan, op1, 0, y0);
+        if (!ret)
+            ret = morphApplySel(pixb, pixt, sel, plan, op2, 0, y - y0);
+        pixDestroy(&pixt);
+        break;
+    default:
+        pixDestroy(&pixb);
+        return ERROR_INT("invalid type", procName, 1);
+    }
+    if (ret) {
+        pixDestroy(&pixb);
+        return ERROR_INT("sel not applied", procName, 1);
+    }
+
+    pixRasterop(pixd, 0, y, w, h, PIX_SRC, pixb, 0, 0);
+    pixDestroy(&pixb);
+    return 0;
+}
+
+
+/*!
+ *  pixMorphByBand()
+ *
+ *      Input:  pixs (1 bpp)
+ *              sel
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_OPEN,
+ *                    L_MORPH_CLOSE, L_MORPH_HMT)
+ *              nbands (number of horizontal bands; >= 1)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This splits the image into nbands bands of nearly equal
+ *          height and does each with pixMorphBand().  The result is
+ *          identical to that of the operation on the whole image.
+ *      (2) The bands are independent; this shows how a caller can
+ *          hand them to separate threads.  The Sel decomposition is
+ *          made once, before the first band, and shared by all of them.
+ */
+PIX *
+pixMorphByBand(PIX     *pixs,
+               SEL     *sel,
+               l_int32  type,
+               l_int32  nbands)
+{
+l_int32  h, bh, y;
+PIX     *pixd;
+SELA    *plan;
+
+    PROCNAME("pixMorphByBand");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("pixs undefined or not 1 bpp", procName, NULL);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, NULL);
+    if (type != L_MORPH_DILATE && type != L_MORPH_ERODE &&
+        type != L_MORPH_OPEN && type != L_MORPH_CLOSE && type != L_MORPH_HMT)
+        return (PIX *)ERROR_PTR("invalid type", procName, NULL);
+    if (nbands < 1)
+        return (PIX *)ERROR_PTR("nbands < 1", procName, NULL);
+
+    h = pixGetHeight(pixs);
+    nbands = L_MIN(nbands, h);
+    bh = (h + nbands - 1) / nbands;
+    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    plan = NULL;
+    if (type != L_MORPH_HMT && (plan = selMakeMorphPlan(sel)) == NULL) {
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("plan not made", procName, NULL);
+    }
+    for (y = 0; y < h; y += bh) {
+        if (pixMorphBand(pixd, pixs, sel, plan, type, y,
+                         L_MIN(bh, h - y))) {
+            pixDestroy(&pixd);
+            break;
+        }
+    }
+    selaDestroy(&plan);
+    if (!pixd)
+        return (PIX *)ERROR_PTR("band not made", procName, NULL);
+    return pixd;
+}
+
+
+/*-----------------------------------------------------------------*
+ *                   Morphology with many Sels                     *
+ *-----------------------------------------------------------------*/
+/*!
+ *  pixHMTMultiple()
+ *
+ *      Input:  pixs (1 bpp)
+ *              sela (of hit-miss Sels)
+ *      Return: pixa (of results, one for each Sel), or null on error
+ *
+ *  Notes:
+ *      (1) Result i is identical to pixHMT(NULL, pixs, sel_i).  This
+ *          is much faster when looking for many patterns, as in
+ *          checking a page for a set of marks or logos.
+ *      (2) The Sels are all applied in a single pass over the
+ *          destination words.  The elements of each Sel are tested
+ *          in order of selectivity, and the tests stop as soon as
+ *          the word of results is 0.  On a typical page most words
+ *          are rejected by the first one or two elements.
+ *      (3) The matches are first found at 2x reduction, using the
+ *          Sel elements at even offsets.  The hits are tested on the
+ *          OR reduction and the misses on the AND reduction, so that
+ *          a pixel in this coarse result is ON wherever there might be
+ *          a match in the corresponding 2x2 block.  This is used as
+ *          the initial word of results at full resolution.
+ *      (4) pixs is read with OFF pixels outside it, as in pixHMT().
+ */
+PIXA *
+pixHMTMultiple(PIX   *pixs,
+               SELA  *sela)
+{
+l_int32    i, k, n, w, h, count, nc, ncoarse, sx, sy;
+l_int32   *nterms, *ncterms;
+l_int32  **tox, **toy, **tmiss, **tcox, **tcoy, **tcmiss;
+l_float32  fract;
+PIX       *pixt, *pixr1, *pixr4;
+PIX      **pixc, **pixd;
+PIXA      *pixa;
+SEL       *sel;
+
+    PROCNAME("pixHMTMultiple");
+
+    if (!pixs)
+        return (PIXA *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (pixGetDepth(pixs) != 1)
+        return (PIXA *)ERROR_PTR("pixs not 1 bpp", procName, NULL);
+    if (!sela)
+        return (PIXA *)ERROR_PTR("sela not defined", procName, NULL);
+    if ((n = selaGetCount(sela)) == 0)
+        return (PIXA *)ERROR_PTR("no sels", procName, NULL);
+    for (k = 0; k < n; k++) {
+        selGetParameters(selaGetSel(sela, k), &sy, &sx, NULL, NULL);
+        if (sx == 0 || sy == 0)
+            return (PIXA *)ERROR_PTR("sel of size 0", procName, NULL);
+    }
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixCountPixels(pixs, &count, NULL);
+    fract = (l_float32)count / ((l_float32)w * (l_float32)h);
+    nterms = (l_int32 *)CALLOC(n, sizeof(l_int32));
+    ncterms = (l_int32 *)CALLOC(n, sizeof(l_int32));
+    tox = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    toy = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    tmiss = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    tcox = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    tcoy = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    tcmiss = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    pixc = (PIX **)CALLOC(n, sizeof(PIX *));
+    pixd = (PIX **)CALLOC(n, sizeof(PIX *));
+    pixa = NULL;
+    pixr1 = pixr4 = NULL;
+    if (!nterms || !ncterms || !tox || !toy || !tmiss || !tcox || !tcoy ||
+        !tcmiss || !pixc || !pixd) {
+        L_ERROR("arrays not made", procName);
+        goto cleanup;
+    }
+
+        /* Order the elements of each Sel */
+    for (k = 0; k < n; k++) {
+        sel = selaGetSel(sela, k);
+        if (morphMakeTerms(sel, L_MORPH_HMT, fract, &tox[k], &toy[k],
+                           &tmiss[k], &nterms[k])) {
+            L_ERROR("terms not made", procName);
+            goto cleanup;
+        }
+        tcox[k] = (l_int32 *)CALLOC(nterms[k] + 1, sizeof(l_int32));
+        tcoy[k] = (l_int32 *)CALLOC(nterms[k] + 1, sizeof(l_int32));
+        tcmiss[k] = (l_int32 *)CALLOC(nterms[k] + 1, sizeof(l_int32));
+        pixd[k] = pixCreateTemplate(pixs);
+        if (!tcox[k] || !tcoy[k] || !tcmiss[k] || !pixd[k]) {
+            L_ERROR("coarse terms or pixd not made", procName);
+            goto cleanup;
+        }
+    }
+
+        /* Coarse test at 2x reduction, with the elements at even
+         * offsets, halved.  The image is first made even in size,
+         * so that no pixel is lost in the reduction. */
+    if (w >= 2 && h >= 2) {
+        pixt = pixAddBorderGeneral(pixs, 0, w & 1, 0, h & 1, 0);
+        pixr1 = pixReduceRankBinary2(pixt, 1, NULL);
+        pixr4 = pixReduceRankBinary2(pixt, 4, NULL);
+        pixDestroy(&pixt);
+        if (!pixr1 || !pixr4) {
+            L_ERROR("reduced images not made", procName);
+            goto cleanup;
+        }
+        for (k = 0, ncoarse = 0; k < n; k++) {
+            for (i = 0, nc = 0; i < nterms[k]; i++) {
+                if ((tox[k][i] & 1) || (toy[k][i] & 1))
+                    continue;
+                tcox[k][nc] = tox[k][i] / 2;
+                tcoy[k][nc] = toy[k][i] / 2;
+                tcmiss[k][nc] = tmiss[k][i];
+                nc++;
+            }
+            ncterms[k] = nc;
+            if (nc == 0)
+                continue;
+            if ((pixc[k] = pixCreateTemplate(pixr1)) == NULL) {
+                L_ERROR("pixc not made", procName);
+                goto cleanup;
+            }
+            ncoarse++;
+        }
+        if (ncoarse > 0 &&
+            morphMultipleLow(pixc, n, pixr1, pixr4, tcox, tcoy, tcmiss,
+                             ncterms, NULL, L_MORPH_HMT, 0, 0)) {
+            L_ERROR("coarse test failed", procName);
+            goto cleanup;
+        }
+    }
+
+        /* Full resolution test, starting from the coarse result */
+    if (morphMultipleLow(pixd, n, pixs, pixs, tox, toy, tmiss, nterms,
+                         pixc, L_MORPH_HMT, 0, 0)) {
+        L_ERROR("full res test failed", procName);
+        goto cleanup;
+    }
+    pixa = pixaCreate(n);
+    for (k = 0; k < n; k++)
+        pixaAddPix(pixa, pixd[k], L_INSERT);
+    FREE(pixd);
+    pixd = NULL;
+
+cleanup:
+    for (k = 0; k < n; k++) {
+        if (tox && tox[k]) FREE(tox[k]);
+        if (toy && toy[k]) FREE(toy[k]);
+        if (tmiss && tmiss[k]) FREE(tmiss[k]);
+        if (tcox && tcox[k]) FREE(tcox[k]);
+        if (tcoy && tcoy[k]) FREE(tcoy[k]);
+        if (tcmiss && tcmiss[k]) FREE(tcmiss[k]);
+        if (pixc) pixDestroy(&pixc[k]);
+        if (pixd) pixDestroy(&pixd[k]);
+    }
+    if (nterms) FREE(nterms);
+    if (ncterms) FREE(ncterms);
+    if (tox) FREE(tox);
+    if (toy) FREE(toy);
+    if (tmiss) FREE(tmiss);
+    if (tcox) FREE(tcox);
+    if (tcoy) FREE(tcoy);
+    if (tcmiss) FREE(tcmiss);
+    if (pixc) FREE(pixc);
+    if (pixd) FREE(pixd);
+    pixDestroy(&pixr1);
+    pixDestroy(&pixr4);
+    return pixa;
+}
+
+
+/*!
+ *  pixMorphSelaBand()
+ *
+ *      Input:  pixd (1 bpp, same size as pixs; not pixs)
+ *              pixs (1 bpp)
+ *              sela
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_OPEN,
+ *                    L_MORPH_CLOSE, L_MORPH_HMT)
+ *              op (L_UNION, L_INTERSECTION)
+ *              y (first row of the band)
+ *              h (number of rows in the band)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This computes rows y through y + h - 1 of the union or
+ *          intersection of the operation on pixs with each Sel in
+ *          sela, and writes them into the same rows of pixd.  The
+ *          other rows of pixd are not touched.  The result is
+ *          identical to combining pixDilate(), etc., for each Sel.
+ *      (2) For dilation, erosion and HMT, all the Sels are applied
+ *          in a single pass over the destination words of the band,
+ *          reading the source words through one bordered copy of
+ *          the band.  The word combined so far is used to start
+ *          each Sel, so that its elements are only tested where the
+ *          result can still change, and the Sels that remain are
+ *          skipped when the word is all ON (union) or OFF
+ *          (intersection).  Sels with many elements are done
+ *          separately with their own decomposition.
+ *      (3) For opening and closing, each Sel is applied as in
+ *          pixMorphBand(), with temporary images the size of the
+ *          band and its halo.
+ *      (4) As with pixMorphBand(), bands that do not overlap can be
+ *          done in any order, and concurrently; the Sels are only read.
+ *          The decomposition of each large Sel is made for each band.
+ */
+l_int32
+pixMorphSelaBand(PIX     *pixd,
+                 PIX     *pixs,
+                 SELA    *sela,
+                 l_int32  type,
+                 l_int32  op,
+                 l_int32  y,
+                 l_int32  h)
+{
+l_int32     k, n, nm, w, hs, count, sy, cy, halo, y0, y1, op1, op2, rop, ret;
+l_int32    *nterms;
+l_int32   **tox, **toy, **tmiss;
+l_float32   fract;
+PIX        *pixb, *pixt1, *pixt2;
+SEL        *sel;
+
+    PROCNAME("pixMorphSelaBand");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return ERROR_INT("pixs undefined or not 1 bpp", procName, 1);
+    if (!pixd || pixd == pixs)
+        return ERROR_INT("pixd undefined or equal to pixs", procName, 1);
+    if (!sela)
+        return ERROR_INT("sela not defined", procName, 1);
+    if ((n = selaGetCount(sela)) == 0)
+        return ERROR_INT("no sels in sela", procName, 1);
+    if (type != L_MORPH_DILATE && type != L_MORPH_ERODE &&
+        type != L_MORPH_OPEN && type != L_MORPH_CLOSE && type != L_MORPH_HMT)
+        return ERROR_INT("invalid type", procName, 1);
+    if (op != L_UNION && op != L_INTERSECTION)
+        return ERROR_INT("invalid op", procName, 1);
+    pixGetDimensions(pixs, &w, &hs, NULL);
+    if (pixGetWidth(pixd) != w || pixGetHeight(pixd) != hs ||
+        pixGetDepth(pixd) != 1)
+        return ERROR_INT("pixd and pixs sizes differ", procName, 1);
+    if (y < 0 || h <= 0 || y + h > hs)
+        return ERROR_INT("band not in image", procName, 1);
+
+        /* pixb holds the band combined so far */
+    pixb = pixCreate(w, h, 1);
+    pixt2 = pixCreate(w, h, 1);
+    nterms = (l_int32 *)CALLOC(n, sizeof(l_int32));
+    tox = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    toy = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    tmiss = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    ret = 1;
+    if (!pixb || !pixt2 || !nterms || !tox || !toy || !tmiss) {
+        L_ERROR("pix or arrays not made", procName);
+        goto cleanup;
+    }
+    if (op == L_INTERSECTION)
+        pixSetAll(pixb);
+    rop = (op == L_UNION) ? PIX_SRC | PIX_DST : PIX_SRC & PIX_DST;
+
+    if (type == L_MORPH_OPEN || type == L_MORPH_CLOSE) {
+        op1 = (type == L_MORPH_OPEN) ? L_MORPH_ERODE : L_MORPH_DILATE;
+        op2 = (type == L_MORPH_OPEN) ? L_MORPH_DILATE : L_MORPH_ERODE;
+        for (k = 0; k < n; k++) {
+            sel = selaGetSel(sela, k);
+            selGetParameters(sel, &sy, NULL, &cy, NULL);
+            halo = L_MAX(L_ABS(cy), L_ABS(sy - 1 - cy));
+            y0 = L_MAX(0, y - halo);
+            y1 = L_MIN(hs, y + h + halo);
+            if ((pixt1 = pixCreate(w, y1 - y0, 1)) == NULL) {
+                L_ERROR("pixt1 not made", procName);
+                goto cleanup;
+            }
+            if (morphApplySel(pixt1, pixs, sel, NULL, op1, 0, y0) ||
+                morphApplySel(pixt2, pixt1, sel, NULL, op2, 0, y - y0)) {
+                pixDestroy(&pixt1);
+                L_ERROR("sel not applied", procName);
+                goto cleanup;
+            }
+            pixDestroy(&pixt1);
+            pixRasterop(pixb, 0, 0, w, h, rop, pixt2, 0, 0);
+        }
+    }
+    else {
+        fract = 0.5;
+        if (type == L_MORPH_HMT) {
+            pixCountPixels(pixs, &count, NULL);
+            fract = (l_float32)count / ((l_float32)w * (l_float32)hs);
+        }
+
+            /* Large Sels are done separately and combined first;
+             * the others are collected for the single pass */
+        for (k = 0, nm = 0; k < n; k++) {
+            sel = selaGetSel(sela, k);
+            if (morphMakeTerms(sel, type, fract, &tox[nm], &toy[nm],
+                               &tmiss[nm], &nterms[nm])) {
+                L_ERROR("terms not made", procName);
+                goto cleanup;
+            }
+            if (nterms[nm] <= MAX_MULTI_TERMS) {
+                nm++;
+                continue;
+            }
+            FREE(tox[nm]);
+            FREE(toy[nm]);
+            FREE(tmiss[nm]);
+            tox[nm] = toy[nm] = tmiss[nm] = NULL;
+            if ((type == L_MORPH_HMT &&
+                 morphWordAccum(pixt2, pixs, sel, L_MORPH_HMT, 0, y)) ||
+                (type != L_MORPH_HMT &&
+                 morphApplySel(pixt2, pixs, sel, NULL, type, 0, y))) {
+                L_ERROR("sel not applied", procName);
+                goto cleanup;
+            }
+            pixRasterop(pixb, 0, 0, w, h, rop, pixt2, 0, 0);
+        }
+        if (nm > 0 && morphMultipleLow(&pixb, nm, pixs, pixs, tox, toy,
+                                       tmiss, nterms, NULL, type, op, y)) {
+            L_ERROR("sels not applied", procName);
+            goto cleanup;
+        }
+    }
+
+    pixRasterop(pixd, 0, y, w, h, PIX_SRC, pixb, 0, 0);
+    ret = 0;
+
+cleanup:
+    for (k = 0; k < n; k++) {
+        if (tox && tox[k]) FREE(tox[k]);
+        if (toy && toy[k]) FREE(toy[k]);
+        if (tmiss && tmiss[k]) FREE(tmiss[k]);
+    }
+    if (nterms) FREE(nterms);
+    if (tox) FREE(tox);
+    if (toy) FREE(toy);
+    if (tmiss) FREE(tmiss);
+    pixDestroy(&pixb);
+    pixDestroy(&pixt2);
+    return ret;
+}
+
+
+/*!
+ *  morphMakeTerms()
+ *
+ *      Input:  sel
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_HMT)
+ *              fract (fraction of ON pixels in the image; used for HMT)
+ *              &tox, &toy (<return> source offsets of the elements)
+ *              &tmiss (<return> 1 for a miss, 0 for a hit)
+ *              &nterms (<return> number of elements)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Dilation and erosion use only the hits; for dilation the
+ *          source offsets are reflected through the origin.
+ *      (2) For HMT, an element passes a word of results with about
+ *          the probability @fract for a hit, and (1 - @fract) for a
+ *          miss.  The more selective kind is put first.
+ *      (3) Adjacent elements are strongly correlated, so the first
+ *          few elements of that kind are chosen to be far apart:
+ *          each is the one farthest from those already chosen.
+ */
+static l_int32
+morphMakeTerms(SEL        *sel,
+               l_int32     type,
+               l_float32   fract,
+               l_int32   **ptox,
+               l_int32   **ptoy,
+               l_int32   **ptmiss,
+               l_int32    *pnterms)
+{
+l_int32   i, j, k, n, nfirst, first, sx, sy, cx, cy, dx, dy, d, dmin;
+l_int32   maxd, imax, temp, sign;
+l_int32  *tox, *toy, *tmiss;
+
+    PROCNAME("morphMakeTerms");
+
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    tox = (l_int32 *)CALLOC(sx * sy + 1, sizeof(l_int32));
+    toy = (l_int32 *)CALLOC(sx * sy + 1, sizeof(l_int32));
+    tmiss = (l_int32 *)CALLOC(sx * sy + 1, sizeof(l_int32));
+    *ptox = tox;
+    *ptoy = toy;
+    *ptmiss = tmiss;
+    *pnterms = 0;
+    if (!tox || !toy || !tmiss)
+        return ERROR_INT("arrays not made", procName, 1);
+
+        /* The more selective kind of element goes first */
+    if (type == L_MORPH_HMT)
+        first = (fract <= 0.5) ? SEL_HIT : SEL_MISS;
+    else
+        first = SEL_HIT;
+    sign = (type == L_MORPH_DILATE) ? -1 : 1;
+    n = 0;
+    for (k = 0; k < 2; k++) {
+        if (k == 1 && type != L_MORPH_HMT)
+            break;
+        for (i = 0; i < sy; i++) {
+            for (j = 0; j < sx; j++) {
+                if ((k == 0 && sel->data[i][j] == first) ||
+                    (k == 1 && sel->data[i][j] != first &&
+                     sel->data[i][j] != SEL_DONT_CARE)) {
+                    tox[n] = sign * (j - cx);
+                    toy[n] = sign * (i - cy);
+                    tmiss[n] = (sel->data[i][j] == SEL_MISS);
+                    n++;
+                }
+            }
+        }
+        if (k == 0)
+            nfirst = n;
+    }
+    *pnterms = n;
+
+        /* Spread out the first few elements */
+    for (k = 0; k < L_MIN(8, nfirst); k++) {
+        maxd = -1;
+        imax = k;
+        for (i = k; i < nfirst; i++) {
+            if (k == 0) {  /* farthest from the origin */
+                dmin = tox[i] * tox[i] + toy[i] * toy[i];
+            }
+            else {
+                dmin = 1 << 30;
+                for (j = 0; j < k; j++) {
+                    dx = tox[i] - tox[j];
+                    dy = toy[i] - toy[j];
+                    d = dx * dx + dy * dy;
+                    dmin = L_MIN(dmin, d);
+                }
+            }
+            if (dmin > maxd) {
+                maxd = dmin;
+                imax = i;
+            }
+        }
+        temp = tox[k];
+        tox[k] = tox[imax];
+        tox[imax] = temp;
+        temp = toy[k];
+        toy[k] = toy[imax];
+        toy[imax] = temp;
+    }
+
+    return 0;
+}
+
+
+/*!
+ *  morphMultipleLow()
+ *
+ *      Input:  pixd (array of dest pix, all the same size, with the
+ *                    width of pixh; see note 1)
+ *              n (number of Sels)
+ *              pixh (1 bpp, read for the hits)
+ *              pixm (1 bpp, read for the misses; the size of pixh)
+ *              tox, toy, tmiss (arrays of element offsets and types)
+ *              nterms (array of number of elements for each Sel)
+ *              pixc (<optional> array of coarse results; a null
+ *                    array or entry means no coarse result)
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_HMT)
+ *              op (0 for a result for each Sel; L_UNION or
+ *                  L_INTERSECTION to combine the results in pixd[0])
+ *              y (row in pixh of the first row of the dest)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) With @op == 0, there are n dest pix, which must be cleared;
+ *          only words with matches are written.  Null entries in pixd
+ *          are skipped, and if all are null there is nothing to do.
+ *          Otherwise, the single dest pixd[0] holds the initial value
+ *          for the combined result, and all its words are written.
+ *      (2) The elements are ORed for dilation, and ANDed for erosion
+ *          and HMT.  Outside pixh and pixm, pixels are OFF, except
+ *          for erosion with symmetric boundary conditions.
+ *      (3) Only the rows of pixh and pixm that can be reached from the
+ *          rows of the dest are copied, with a border.
+ *      (4) The destination pad bits are cleared.
+ */
+static l_int32
+morphMultipleLow(PIX      **pixd,
+                 l_int32    n,
+                 PIX       *pixh,
+                 PIX       *pixm,
+                 l_int32  **tox,
+                 l_int32  **toy,
+                 l_int32  **tmiss,
+                 l_int32   *nterms,
+                 PIX      **pixc,
+                 l_int32    type,
+                 l_int32    op,
+                 l_int32    y)
+{
+l_int32      i, j, k, t, w, h, hd, wpl, wplb, wplc, maxox, maxoy, bx, q, r;
+l_int32      ntot, ndest, half, isor, bordval, y0, y1, ret;
+l_int32    **tshift;
+l_uint16    *tab;
+l_uint32     acc, val, total;
+l_uint32    *datah, *datam, *lineb, *linec;
+l_uint32   **datad, **datac, **tinv;
+l_uint32  ***tline;
+PIX         *pixbh, *pixbm;
+
+    PROCNAME("morphMultipleLow");
+
+    ret = 1;
+    pixGetDimensions(pixh, &w, &h, NULL);
+    ndest = (op) ? 1 : n;
+    for (k = 0, hd = 0; k < ndest; k++) {
+        if (pixd[k])
+            hd = pixGetHeight(pixd[k]);
+    }
+    if (hd == 0)  /* no dest */
+        return 0;
+    wpl = pixGetWpl(pixh);
+    isor = (type == L_MORPH_DILATE);
+    bordval = (type == L_MORPH_ERODE) ?
+              getMorphBorderPixelColor(L_MORPH_ERODE, 1) : 0;
+
+        /* Border large enough for all source words read */
+    maxox = maxoy = 0;
+    for (k = 0; k < n; k++) {
+        for (t = 0; t < nterms[k]; t++) {
+            maxox = L_MAX(maxox, L_ABS(tox[k][t]));
+            maxoy = L_MAX(maxoy, L_ABS(toy[k][t]));
+        }
+    }
+    bx = (maxox + 31) / 32 + 1;
+    y0 = L_MAX(0, y - maxoy);
+    y1 = L_MIN(h, y + hd + maxoy);
+    pixbh = pixCreate(w + 64 * bx, hd + 2 * maxoy, 1);
+    pixbm = (pixm == pixh) ? pixClone(pixbh) :
+            pixCreate(w + 64 * bx, hd + 2 * maxoy, 1);
+    tline = (l_uint32 ***)CALLOC(n, sizeof(l_uint32 **));
+    tshift = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    tinv = (l_uint32 **)CALLOC(n, sizeof(l_uint32 *));
+    datad = (l_uint32 **)CALLOC(n, sizeof(l_uint32 *));
+    datac = (l_uint32 **)CALLOC(n, sizeof(l_uint32 *));
+    tab = makeExpandTab2x();
+    if (!pixbh || !pixbm || !tline || !tshift || !tinv || !datad ||
+        !datac || !tab) {
+        L_ERROR("border pix, arrays or tab not made", procName);
+        goto cleanup;
+    }
+    if (bordval)
+        pixSetAll(pixbh);
+    if (y1 > y0) {
+        pixRasterop(pixbh, 32 * bx, y0 - y + maxoy, w, y1 - y0, PIX_SRC,
+                    pixh, 0, y0);
+        if (pixbm != pixbh)
+            pixRasterop(pixbm, 32 * bx, y0 - y + maxoy, w, y1 - y0, PIX_SRC,
+                        pixm, 0, y0);
+    }
+    wplb = pixGetWpl(pixbh);
+    datah = pixGetData(pixbh);
+    datam = pixGetData(pixbm);
+
+        /* For each element: the source word for destination word 0
+         * in the bordered band, the shift within that word, and
+         * a mask to invert the source for a miss */
+    for (k = 0; k < n; k++) {
+        if (k < ndest && pixd[k])
+            datad[k] = pixGetData(pixd[k]);
+        if (!op && !datad[k])
+            continue;
+        ntot = L_MAX(1, nterms[k]);
+        tline[k] = (l_uint32 **)CALLOC(ntot, sizeof(l_uint32 *));
+        tshift[k] = (l_int32 *)CALLOC(ntot, sizeof(l_int32));
+        tinv[k] = (l_uint32 *)CALLOC(ntot, sizeof(l_uint32));
+        if (!tline[k] || !tshift[k] || !tinv[k]) {
+            L_ERROR("element arrays not made", procName);
+            goto cleanup;
+        }
+        for (t = 0; t < nterms[k]; t++) {
+            q = (tox[k][t] >= 0) ? tox[k][t] / 32 : -((31 - tox[k][t]) / 32);
+            tline[k][t] = ((tmiss[k][t]) ? datam : datah) +
+                          (toy[k][t] + maxoy) * wplb + bx + q;
+            tshift[k][t] = tox[k][t] - 32 * q;
+            tinv[k][t] = (tmiss[k][t]) ? 0xffffffff : 0;
+        }
+    }
+
+    wplc = 0;
+    for (k = 0; k < n; k++) {
+        datac[k] = (pixc && pixc[k]) ? pixGetData(pixc[k]) : NULL;
+        if (datac[k])
+            wplc = pixGetWpl(pixc[k]);
+    }
+    for (i = 0; i < hd; i++) {
+        for (j = 0; j < wpl; j++) {
+            total = (op) ? datad[0][i * wpl + j] : 0;
+            for (k = 0; k < n; k++) {
+                if ((op == L_UNION && total == 0xffffffff) ||
+                    (op == L_INTERSECTION && total == 0))
+                    break;
+
+                    /* The bits already decided in total are set
+                     * so that the chain can stop early */
+                if (op == L_UNION)
+                    acc = (isor) ? total : ~total;
+                else if (op == L_INTERSECTION)
+                    acc = (isor) ? ~total : total;
+                else if (!datad[k])
+                    continue;
+                else if (datac[k]) {
+                    linec = datac[k] + ((y + i) / 2) * wplc;
+                    half = (j & 1) ? linec[j / 2] & 0xffff
+                                   : linec[j / 2] >> 16;
+                    acc = (tab[half >> 8] << 16) | tab[half & 0xff];
+                }
+                else
+                    acc = (isor) ? 0 : 0xffffffff;
+
+                if (isor) {
+                    for (t = 0; acc != 0xffffffff && t < nterms[k]; t++) {
+                        lineb = tline[k][t] + i * wplb + j;
+                        r = tshift[k][t];
+                        val = (r) ? (lineb[0] << r) | (lineb[1] >> (32 - r))
+                                  : lineb[0];
+                        acc |= val;
+                    }
+                }
+                else {
+                    for (t = 0; acc && t < nterms[k]; t++) {
+                        lineb = tline[k][t] + i * wplb + j;
+                        r = tshift[k][t];
+                        val = (r) ? (lineb[0] << r) | (lineb[1] >> (32 - r))
+                                  : lineb[0];
+                        acc &= val ^ tinv[k][t];
+                    }
+                }
+
+                if (op == L_UNION)
+                    total = (isor) ? acc : total | acc;
+                else if (op == L_INTERSECTION)
+                    total = (isor) ? total & acc : acc;
+                else if (acc)
+                    datad[k][i * wpl + j] = acc;
+            }
+            if (op)
+                datad[0][i * wpl + j] = total;
+        }
+    }
+    for (k = 0; k < ndest; k++) {
+        if (pixd[k])
+            pixSetPadBits(pixd[k], 0);
+    }
+    ret = 0;
+
+cleanup:
+    for (k = 0; k < n; k++) {
+        if (tline && tline[k]) FREE(tline[k]);
+        if (tshift && tshift[k]) FREE(tshift[k]);
+        if (tinv && tinv[k]) FREE(tinv[k]);
+    }
+    if (tline) FREE(tline);
+    if (tshift) FREE(tshift);
+    if (tinv) FREE(tinv);
+    if (datad) FREE(datad);
+    if (datac) FREE(datac);
+    if (tab) FREE(tab);
+    pixDestroy(&pixbh);
+    pixDestroy(&pixbm);
+    return ret;
 }
 
 
@@ -914,6 +1883,8 @@ SEL  *sel, *selh, *selv;
  *          32-bit words in the expanded image.  As a result, there is
  *          no special processing for pixels near the boundary, and there
  *          are no boundary effects.  The border is removed at the end.
+ *          It is added by the first dilation and removed by the last
+ *          erosion, so pixs is never copied; see pixMorphAddBorder().
  *      (5) There are three cases:
  *          (a) pixd == null   (result into new pixd)
  *          (b) pixd == pixs   (in-place; writes result back to pixs)
@@ -931,7 +1902,7 @@ pixCloseSafeBrick(PIX     *pixd,
                   l_int32  vsize)
 {
 l_int32  maxtrans, bordsize;
-PIX     *pixsb, *pixt, *pixdb;
+PIX     *pixt, *pixdb;
 SEL     *sel, *selh, *selv;
 
     PROCNAME("pixCloseSafeBrick");
@@ -952,36 +1923,38 @@ SEL     *sel, *selh, *selv;
 
     maxtrans = L_MAX(hsize / 2, vsize / 2);
     bordsize = 32 * ((maxtrans + 31) / 32);  /* full 32 bit words */
-    pixsb = pixAddBorder(pixs, bordsize, 0);
 
+        /* The border is added by the first dilation and removed
+         * by the last erosion */
     if (hsize == 1 || vsize == 1) {  /* no intermediate result */
         sel = selCreateBrick(vsize, hsize, vsize / 2, hsize / 2, SEL_HIT);
-        pixdb = pixClose(NULL, pixsb, sel);
+        pixt = pixMorphAddBorder(pixs, sel, L_MORPH_DILATE, bordsize,
+                                 bordsize, bordsize, bordsize);
+        if (pixt)
+            pixd = pixMorphRemoveBorder(pixd, pixt, sel, L_MORPH_ERODE,
+                                        bordsize, bordsize, bordsize,
+                                        bordsize);
         selDestroy(&sel);
     }
     else {  /* do separably */
         selh = selCreateBrick(1, hsize, 0, hsize / 2, SEL_HIT);
         selv = selCreateBrick(vsize, 1, vsize / 2, 0, SEL_HIT);
-        pixt = pixDilate(NULL, pixsb, selh);
-        pixdb = pixDilate(NULL, pixt, selv);
-        pixErode(pixt, pixdb, selh);
-        pixErode(pixdb, pixt, selv);
-        pixDestroy(&pixt);
+        pixt = pixMorphAddBorder(pixs, selh, L_MORPH_DILATE, bordsize,
+                                 bordsize, bordsize, bordsize);
+        if (pixt) {
+            pixdb = pixDilate(NULL, pixt, selv);
+            pixErode(pixt, pixdb, selh);
+            pixd = pixMorphRemoveBorder(pixd, pixt, selv, L_MORPH_ERODE,
+                                        bordsize, bordsize, bordsize,
+                                        bordsize);
+            pixDestroy(&pixdb);
+        }
         selDestroy(&selh);
         selDestroy(&selv);
     }
-
-    pixt = pixRemoveBorder(pixdb, bordsize);
-    pixDestroy(&pixsb);
-    pixDestroy(&pixdb);
-
-    if (!pixd)
-        pixd = pixt;
-    else {
-        pixCopy(pixd, pixt);
-        pixDestroy(&pixt);
-    }
-
+    if (!pixt)
+        return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
+    pixDestroy(&pixt);
     return pixd;
 }
 
@@ -1182,7 +2155,7 @@ pixDilateCompBrick(PIX     *pixd,
                    l_int32  hsize,
                    l_int32  vsize)
 {
-PIX  *pixt1, *pixt2, *pixt3;
+PIX  *pixt1, *pixt2;
 SEL  *selh1, *selh2, *selv1, *selv2;
 
     PROCNAME("pixDilateCompBrick");
@@ -1194,30 +2167,40 @@ SEL  *selh1, *selh2, *selv1, *selv2;
     if (hsize < 1 || vsize < 1)
         return (PIX *)ERROR_PTR("hsize and vsize not >= 1", procName, pixd);
 
-    pixt1 = pixAddBorder(pixs, 32, 0);
-
     if (hsize == 1 && vsize == 1)
         return pixCopy(pixd, pixs);
     if (hsize > 1)
         selectComposableSels(hsize, L_HORIZ, &selh1, &selh2);
     if (vsize > 1)
         selectComposableSels(vsize, L_VERT, &selv1, &selv2);
+
+        /* A border of 32 pixels is added by the first dilation and
+         * removed by the last one */
     if (vsize == 1) {
-        pixt2 = pixDilate(NULL, pixt1, selh1);
-        pixt3 = pixDilate(NULL, pixt2, selh2);
+        pixt1 = pixMorphAddBorder(pixs, selh1, L_MORPH_DILATE,
+                                  32, 32, 32, 32);
+        if (pixt1)
+            pixd = pixMorphRemoveBorder(pixd, pixt1, selh2, L_MORPH_DILATE,
+                                        32, 32, 32, 32);
     }
     else if (hsize == 1) {
-        pixt2 = pixDilate(NULL, pixt1, selv1);
-        pixt3 = pixDilate(NULL, pixt2, selv2);
+        pixt1 = pixMorphAddBorder(pixs, selv1, L_MORPH_DILATE,
+                                  32, 32, 32, 32);
+        if (pixt1)
+            pixd = pixMorphRemoveBorder(pixd, pixt1, selv2, L_MORPH_DILATE,
+                                        32, 32, 32, 32);
     }
     else {
-        pixt2 = pixDilate(NULL, pixt1, selh1);
-        pixt3 = pixDilate(NULL, pixt2, selh2);
-        pixDilate(pixt2, pixt3, selv1);
-        pixDilate(pixt3, pixt2, selv2);
+        pixt1 = pixMorphAddBorder(pixs, selh1, L_MORPH_DILATE,
+                                  32, 32, 32, 32);
+        if (pixt1) {
+            pixt2 = pixDilate(NULL, pixt1, selh2);
+            pixDilate(pixt1, pixt2, selv1);
+            pixd = pixMorphRemoveBorder(pixd, pixt1, selv2, L_MORPH_DILATE,
+                                        32, 32, 32, 32);
+            pixDestroy(&pixt2);
+        }
     }
-    pixDestroy(&pixt1);
-    pixDestroy(&pixt2);
 
     if (hsize > 1) {
         selDestroy(&selh1);
@@ -1228,11 +2211,8 @@ SEL  *selh1, *selh2, *selv1, *selv2;
         selDestroy(&selv2);
     }
 
-    pixt1 = pixRemoveBorder(pixt3, 32);
-    pixDestroy(&pixt3);
-    if (!pixd)
-        return pixt1;
-    pixCopy(pixd, pixt1);
+    if (!pixt1)
+        return (PIX *)ERROR_PTR("pixt1 not made", procName, pixd);
     pixDestroy(&pixt1);
     return pixd;
 }
@@ -1547,6 +2527,8 @@ SEL  *selh1, *selh2, *selv1, *selv2;
  *          32-bit words in the expanded image.  As a result, there is
  *          no special processing for pixels near the boundary, and there
  *          are no boundary effects.  The border is removed at the end.
+ *          It is added by the first dilation and removed by the last
+ *          erosion, so pixs is never copied; see pixMorphAddBorder().
  *      (6) There are three cases:
  *          (a) pixd == null   (result into new pixd)
  *          (b) pixd == pixs   (in-place; writes result back to pixs)
@@ -1576,8 +2558,8 @@ pixCloseSafeCompBrick(PIX     *pixd,
                       l_int32  hsize,
                       l_int32  vsize)
 {
-l_int32  maxtrans, bordsize;
-PIX     *pixsb, *pixt, *pixdb;
+l_int32  maxtrans, bordsize, bs;
+PIX     *pixt, *pixdb;
 SEL     *selh1, *selh2, *selv1, *selv2;
 
     PROCNAME("pixCloseSafeCompBrick");
@@ -1598,47 +2580,46 @@ SEL     *selh1, *selh2, *selv1, *selv2;
 
     maxtrans = L_MAX(hsize / 2, vsize / 2);
     bordsize = 32 * ((maxtrans + 31) / 32);  /* full 32 bit words */
-    pixsb = pixAddBorder(pixs, bordsize, 0);
+    bs = bordsize;
 
     if (hsize > 1)
         selectComposableSels(hsize, L_HORIZ, &selh1, &selh2);
     if (vsize > 1)
         selectComposableSels(vsize, L_VERT, &selv1, &selv2);
+    pixdb = NULL;
     if (vsize == 1) {
-        pixt = pixDilate(NULL, pixsb, selh1);
-        pixdb = pixDilate(NULL, pixt, selh2);
-        pixErode(pixt, pixdb, selh1);
-        pixErode(pixdb, pixt, selh2);
+        pixt = pixMorphAddBorder(pixs, selh1, L_MORPH_DILATE, bs, bs, bs, bs);
+        if (pixt) {
+            pixdb = pixDilate(NULL, pixt, selh2);
+            pixErode(pixt, pixdb, selh1);
+            pixd = pixMorphRemoveBorder(pixd, pixt, selh2, L_MORPH_ERODE,
+                                        bs, bs, bs, bs);
+        }
     }
     else if (hsize == 1) {
-        pixt = pixDilate(NULL, pixsb, selv1);
-        pixdb = pixDilate(NULL, pixt, selv2);
-        pixErode(pixt, pixdb, selv1);
-        pixErode(pixdb, pixt, selv2);
+        pixt = pixMorphAddBorder(pixs, selv1, L_MORPH_DILATE, bs, bs, bs, bs);
+        if (pixt) {
+            pixdb = pixDilate(NULL, pixt, selv2);
+            pixErode(pixt, pixdb, selv1);
+            pixd = pixMorphRemoveBorder(pixd, pixt, selv2, L_MORPH_ERODE,
+                                        bs, bs, bs, bs);
+        }
     }
     else {  /* do separably */
-        pixt = pixDilate(NULL, pixsb, selh1);
-        pixdb = pixDilate(NULL, pixt, selh2);
-        pixDilate(pixt, pixdb, selv1);
-        pixDilate(pixdb, pixt, selv2);
-        pixErode(pixt, pixdb, selh1);
-        pixErode(pixdb, pixt, selh2);
-        pixErode(pixt, pixdb, selv1);
-        pixErode(pixdb, pixt, selv2);
+        pixt = pixMorphAddBorder(pixs, selh1, L_MORPH_DILATE, bs, bs, bs, bs);
+        if (pixt) {
+            pixdb = pixDilate(NULL, pixt, selh2);
+            pixDilate(pixt, pixdb, selv1);
+            pixDilate(pixdb, pixt, selv2);
+            pixErode(pixt, pixdb, selh1);
+            pixErode(pixdb, pixt, selh2);
+            pixErode(pixt, pixdb, selv1);
+            pixd = pixMorphRemoveBorder(pixd, pixt, selv2, L_MORPH_ERODE,
+                                        bs, bs, bs, bs);
+        }
     }
-    pixDestroy(&pixt);
-
-    pixt = pixRemoveBorder(pixdb, bordsize);
-    pixDestroy(&pixsb);
     pixDestroy(&pixdb);
 
-    if (!pixd)
-        pixd = pixt;
-    else {
-        pixCopy(pixd, pixt);
-        pixDestroy(&pixt);
-    }
-
     if (hsize > 1) {
         selDestroy(&selh1);
         selDestroy(&selh2);
@@ -1648,6 +2629,9 @@ SEL     *selh1, *selh2, *selv1, *selv2;
         selDestroy(&selv2);
     }
 
+    if (!pixt)
+        return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
+    pixDestroy(&pixt);
     return pixd;
 }
 
@@ -1706,65 +2690,1025 @@ getMorphBorderPixelColor(l_int32  type,
 
 
 /*-----------------------------------------------------------------*
- *               Static helpers for arg processing                 *
+ *                   Decomposition of large Sels                   *
  *-----------------------------------------------------------------*/
 /*!
- *  processMorphArgs1()
+ *  selMakeMorphPlan()
  *
- *      Input:  pixd (<optional>; this can be null, equal to pixs,
- *                    or different from pixs)
- *              pixs (1 bpp)
- *              sel
- *              &pixt (<returned>)
- *      Return: pixd, or null on error.
+ *      Input:  sel
+ *      Return: plan (sela of Sels to be used in sequence for dilation
+ *                    or erosion), or null on error
  *
  *  Notes:
- *      (1) This is used for generic erosion, dilation and HMT.
+ *      (1) The hits of sel are factored, where this is cheaper, as
+ *          a Minkowski sum A = A0 + B1 + ... + Bn of smaller Sels.
+ *          Then the dilation (or erosion) by A is the sequence of
+ *          dilations (or erosions) by A0, B1, ... Bn.  If sel is not
+ *          decomposed, the plan holds a single Sel.
+ *      (2) The factoring is exact, not approximate.  Two kinds are
+ *          tried:
+ *            - separable: if every nonempty row of the Sel has the same
+ *              hits, A is a horizontal Sel followed by a vertical Sel.
+ *            - two-point factors {0, v}, with v along a row, column or
+ *              diagonal.  The factor is taken out only if
+ *              A0 + {0, v} is exactly A, with A0 the erosion of A by
+ *              {0, v}.  Large bricks, diagonal lines and octagons are
+ *              factored this way.
+ *          Each part is factored greedily while this lowers the
+ *          estimated cost of the generic implementation, and the
+ *          cheapest plan, including doing nothing, is chosen.
+ *      (3) Factoring is exact only if intermediate results are kept
+ *          outside the image.  morphApplyPlan() keeps them in a margin
+ *          that is as large as the Sel extent.
+ *      (4) Misses are ignored, so this is not used for the HMT.
+ *      (5) pixDilate(), pixErode() and the other generic functions
+ *          make the plan for each call and destroy it after use; this
+ *          takes much less time than the operation on a page.  To
+ *          reuse one plan, for example for many bands of an image,
+ *          make it here and pass it to pixMorphBand().  The plan
+ *          depends on the Sel hits and origin at the time it is made,
+ *          and must be remade if the Sel is changed.  It is not
+ *          changed by being used, so it can be shared by
+ *          concurrent operations.
  */
-static PIX *
-processMorphArgs1(PIX   *pixd,
-                  PIX   *pixs,
-                  SEL   *sel,
-                  PIX  **ppixt)
+SELA *
+selMakeMorphPlan(SEL  *sel)
 {
-l_int32  sx, sy;
+l_int32   i, j, k, sx, sy, cx, cy, gw, gh, maxox, maxoy, nhits;
+l_int32   cost, costsep, costfact, costh, costv, row0, same;
+l_int32  *grid, *gridh, *gridv;
+SELA     *sela, *selasep, *selafact;
 
-    PROCNAME("processMorphArgs1");
+    PROCNAME("selMakeMorphPlan");
 
-    if (!ppixt)
-        return (PIX *)ERROR_PTR("&pixt not defined", procName, pixd);
-    *ppixt = NULL;
-    if (!pixs)
-        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
     if (!sel)
-        return (PIX *)ERROR_PTR("sel not defined", procName, pixd);
-    if (pixGetDepth(pixs) != 1)
-        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, pixd);
+        return (SELA *)ERROR_PTR("sel not defined", procName, NULL);
+    if ((sela = selaCreate(1)) == NULL)
+        return (SELA *)ERROR_PTR("sela not made", procName, NULL);
 
-    selGetParameters(sel, &sx, &sy, NULL, NULL);
-    if (sx == 0 || sy == 0)
-        return (PIX *)ERROR_PTR("sel of size 0", procName, pixd);
+        /* Grid of hits at offsets from the origin, which is at the
+         * center, so that every factor fits in the same grid */
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    maxox = L_MAX(L_ABS(cx), L_ABS(sx - 1 - cx));
+    maxoy = L_MAX(L_ABS(cy), L_ABS(sy - 1 - cy));
+    gw = 2 * maxox + 1;
+    gh = 2 * maxoy + 1;
+    nhits = 0;
+    if ((grid = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32))) == NULL) {
+        selaDestroy(&sela);
+        return (SELA *)ERROR_PTR("grid not made", procName, NULL);
+    }
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT) {
+                grid[(i - cy + maxoy) * gw + j - cx + maxox] = 1;
+                nhits++;
+            }
+        }
+    }
+    if (nhits < MIN_PLAN_HITS) {
+        selaAddSel(sela, sel, "plan", L_COPY);
+        FREE(grid);
+        return sela;
+    }
+    cost = morphGridCost(grid, gw, gh);
+
+        /* Is it separable?  If so, the row and column are in the
+         * grid row and column through the origin. */
+    gridh = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    gridv = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    selasep = selafact = NULL;
+    if (cost < 0 || !gridh || !gridv) {
+        L_ERROR("cost or grids not made", procName);
+        goto fail;
+    }
+    same = TRUE;
+    row0 = -1;
+    for (i = 0; i < gh && same; i++) {
+        for (j = 0, k = 0; j < gw; j++)
+            k += grid[i * gw + j];
+        if (k == 0)
+            continue;
+        if (row0 < 0)
+            row0 = i;
+        for (j = 0; j < gw; j++) {
+            if (grid[i * gw + j] != grid[row0 * gw + j]) {
+                same = FALSE;
+                break;
+            }
+        }
+        gridv[i * gw + maxox] = 1;
+    }
+    costsep = cost + 1;
+    if (same && row0 >= 0) {
+        for (j = 0; j < gw; j++)
+            gridh[maxoy * gw + j] = grid[row0 * gw + j];
+        if ((selasep = selaCreate(2)) == NULL) {
+            L_ERROR("selasep not made", procName);
+            goto fail;
+        }
+        costh = morphPlanFactor(gridh, gw, gh, selasep);
+        costv = morphPlanFactor(gridv, gw, gh, selasep);
+        if (costh < 0 || costv < 0) {
+            L_ERROR("separable plan not made", procName);
+            goto fail;
+        }
+        costsep = 2 + costh + costv;
+    }
+
+        /* Take out two-point factors */
+    if ((selafact = selaCreate(2)) == NULL ||
+        (costfact = morphPlanFactor(grid, gw, gh, selafact)) < 0) {
+        L_ERROR("factored plan not made", procName);
+        goto fail;
+    }
+    costfact += 2;
 
-        /* We require pixd to exist and to be the same size as pixs.
-         * Further, pixt must be a copy (or clone) of pixs.  */
-    if (!pixd) {
-        if ((pixd = pixCreateTemplate(pixs)) == NULL)
-            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
-        *ppixt = pixClone(pixs);
+    if (costsep <= costfact && costsep < cost) {
+        selaDestroy(&sela);
+        sela = selasep;
+        selasep = NULL;
+    }
+    else if (costfact < cost && selaGetCount(selafact) > 1) {
+        selaDestroy(&sela);
+        sela = selafact;
+        selafact = NULL;
     }
     else {
-        pixResizeImageData(pixd, pixs);
-        if (pixd == pixs) {  /* in-place; must make a copy of pixs */
-            if ((*ppixt = pixCopy(NULL, pixs)) == NULL)
-                return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
+        selaAddSel(sela, sel, "plan", L_COPY);
+    }
+
+    selaDestroy(&selasep);
+    selaDestroy(&selafact);
+    FREE(grid);
+    FREE(gridh);
+    FREE(gridv);
+    return sela;
+
+fail:
+    selaDestroy(&sela);
+    selaDestroy(&selasep);
+    selaDestroy(&selafact);
+    FREE(grid);
+    if (gridh) FREE(gridh);
+    if (gridv) FREE(gridv);
+    return (SELA *)ERROR_PTR("plan not made", procName, NULL);
+}
+
+
+/*!
+ *  morphPlanFactor()
+ *
+ *      Input:  grid (of hits, at offsets from the center; modified)
+ *              gw, gh (grid size)
+ *              sela (the two-point factors and the residual Sel
+ *                    are added to this)
+ *      Return: estimated cost of the Sels that are added, or -1 on error
+ *
+ *  Notes:
+ *      (1) Along each of the four directions u, the candidate factor
+ *          is {0, k * u}, where k is half the shortest run of hits
+ *          along u.  With A0 the set of p in A for which p + k * u is
+ *          also in A, the factor is exact if A is the union of A0 and
+ *          A0 + k * u.  The cheapest exact factor is taken out if that
+ *          lowers the cost, and the residual A0 is factored again.
+ */
+static l_int32
+morphPlanFactor(l_int32  *grid,
+                l_int32   gw,
+                l_int32   gh,
+                SELA     *sela)
+{
+l_int32   i, j, d, k, x, y, len, minlen, dx, dy, ok, best;
+l_int32   cost, costd, costpair, costbest, costbestpair, costfactors, total;
+l_int32  *resid, *bestresid, *pair, *bestpair;
+l_int32   ux[4] = {1, 0, 1, -1};
+l_int32   uy[4] = {0, 1, 1, 1};
+SEL      *sel;
+
+    PROCNAME("morphPlanFactor");
+
+    resid = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    bestresid = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    pair = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    bestpair = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    total = -1;
+    if (!resid || !bestresid || !pair || !bestpair) {
+        L_ERROR("arrays not made", procName);
+        goto cleanup;
+    }
+    if ((cost = morphGridCost(grid, gw, gh)) < 0)
+        goto cleanup;
+    costfactors = 0;
+    while (1) {
+        best = -1;
+        costbest = cost;
+        costbestpair = 0;
+        for (d = 0; d < 4; d++) {
+                /* Shortest run along u, starting from each run start */
+            minlen = gw + gh;
+            for (y = 0; y < gh; y++) {
+                for (x = 0; x < gw; x++) {
+                    if (!grid[y * gw + x])
+                        continue;
+                    i = y - uy[d];
+                    j = x - ux[d];
+                    if (i >= 0 && j >= 0 && j < gw && grid[i * gw + j])
+                        continue;
+                    len = 0;
+                    for (i = y, j = x; i < gh && j >= 0 && j < gw;
+                         i += uy[d]) {
+                        if (!grid[i * gw + j])
+                            break;
+                        len++;
+                        j += ux[d];
+                    }
+                    minlen = L_MIN(minlen, len);
+                }
+            }
+            if ((k = minlen / 2) < 1)
+                continue;
+            dx = k * ux[d];
+            dy = k * uy[d];
+
+                /* The residual, A0 */
+            ok = FALSE;
+            for (y = 0; y < gh; y++) {
+                for (x = 0; x < gw; x++) {
+                    resid[y * gw + x] = 0;
+                    if (grid[y * gw + x] && y + dy < gh && x + dx >= 0 &&
+                        x + dx < gw && grid[(y + dy) * gw + x + dx]) {
+                        resid[y * gw + x] = 1;
+                        ok = TRUE;
+                    }
+                }
+            }
+
+                /* Is A0 + {0, v} equal to A? */
+            for (y = 0; y < gh && ok; y++) {
+                for (x = 0; x < gw; x++) {
+                    if (!grid[y * gw + x] || resid[y * gw + x])
+                        continue;
+                    if (y - dy < 0 || x - dx < 0 || x - dx >= gw ||
+                        !resid[(y - dy) * gw + x - dx]) {
+                        ok = FALSE;
+                        break;
+                    }
+                }
+            }
+            if (!ok)
+                continue;
+
+            memset(pair, 0, gw * gh * sizeof(l_int32));
+            pair[(gh / 2) * gw + gw / 2] = 1;
+            pair[(gh / 2 + dy) * gw + gw / 2 + dx] = 1;
+            costpair = morphGridCost(pair, gw, gh);
+            costd = morphGridCost(resid, gw, gh);
+            if (costpair < 0 || costd < 0)
+                goto cleanup;
+            costd += costpair;
+            if (costd < costbest) {
+                best = d;
+                costbest = costd;
+                costbestpair = costpair;
+                memcpy(bestresid, resid, gw * gh * sizeof(l_int32));
+                memcpy(bestpair, pair, gw * gh * sizeof(l_int32));
+            }
+        }
+        if (best < 0)
+            break;
+
+            /* Take out the factor, and continue with the residual */
+        if ((sel = selCreateFromGrid(bestpair, gw, gh)) == NULL)
+            goto cleanup;
+        selaAddSel(sela, sel, "plan_factor", L_INSERT);
+        costfactors += costbestpair;
+        memcpy(grid, bestresid, gw * gh * sizeof(l_int32));
+        cost = costbest - costbestpair;
+    }
+
+    if ((sel = selCreateFromGrid(grid, gw, gh)) == NULL)
+        goto cleanup;
+    selaAddSel(sela, sel, "plan_residual", L_INSERT);
+    total = costfactors + cost;
+
+cleanup:
+    if (resid) FREE(resid);
+    if (bestresid) FREE(bestresid);
+    if (pair) FREE(pair);
+    if (bestpair) FREE(bestpair);
+    return total;
+}
+
+
+/*!
+ *  morphGridCost()
+ *
+ *      Input:  grid (of hits, at offsets from the center)
+ *              gw, gh (grid size)
+ *      Return: estimated cost of dilation or erosion by morphWordAccum(),
+ *              in passes over the image, or -1 on error
+ *
+ *  Notes:
+ *      (1) This counts the copy of the source, the initialization of
+ *          the destination, one pass for each run of hits, and the
+ *          passes to make the transformed images.  See morphWordAccum().
+ */
+static l_int32
+morphGridCost(l_int32  *grid,
+              l_int32   gw,
+              l_int32   gh)
+{
+l_int32   n, costh, costv;
+l_int32  *tlen, *tox, *toy, *tmiss;
+
+    PROCNAME("morphGridCost");
+
+    tlen = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tox = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    toy = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tmiss = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    if (!tlen || !tox || !toy || !tmiss) {
+        if (tlen) FREE(tlen);
+        if (tox) FREE(tox);
+        if (toy) FREE(toy);
+        if (tmiss) FREE(tmiss);
+        return ERROR_INT("arrays not made", procName, -1);
+    }
+    n = morphFindRuns(grid, gw, gh, gw / 2, gh / 2, L_HORIZ, tlen, tox, toy,
+                      tmiss);
+    costh = n + morphRunTransformCost(tlen, tmiss, n, L_MORPH_ERODE);
+    n = morphFindRuns(grid, gw, gh, gw / 2, gh / 2, L_VERT, tlen, tox, toy,
+                      tmiss);
+    costv = n + morphRunTransformCost(tlen, tmiss, n, L_MORPH_ERODE);
+    FREE(tlen);
+    FREE(tox);
+    FREE(toy);
+    FREE(tmiss);
+    return 2 + L_MIN(costh, costv);
+}
+
+
+/*!
+ *  selCreateFromGrid()
+ *
+ *      Input:  grid (of hits, at offsets from the center)
+ *              gw, gh (grid size)
+ *      Return: sel, or null on error
+ *
+ *  Notes:
+ *      (1) The Sel is the bounding box of the hits and the origin.
+ */
+static SEL *
+selCreateFromGrid(l_int32  *grid,
+                  l_int32   gw,
+                  l_int32   gh)
+{
+l_int32  x, y, xmin, xmax, ymin, ymax;
+SEL     *sel;
+
+    PROCNAME("selCreateFromGrid");
+
+    xmin = xmax = gw / 2;
+    ymin = ymax = gh / 2;
+    for (y = 0; y < gh; y++) {
+        for (x = 0; x < gw; x++) {
+            if (!grid[y * gw + x])
+                continue;
+            xmin = L_MIN(xmin, x);
+            xmax = L_MAX(xmax, x);
+            ymin = L_MIN(ymin, y);
+            ymax = L_MAX(ymax, y);
+        }
+    }
+    if ((sel = selCreate(ymax - ymin + 1, xmax - xmin + 1, NULL)) == NULL)
+        return (SEL *)ERROR_PTR("sel not made", procName, NULL);
+    selSetOrigin(sel, gh / 2 - ymin, gw / 2 - xmin);
+    for (y = ymin; y <= ymax; y++) {
+        for (x = xmin; x <= xmax; x++) {
+            if (grid[y * gw + x])
+                sel->data[y - ymin][x - xmin] = SEL_HIT;
+        }
+    }
+    return sel;
+}
+
+
+/*!
+ *  morphApplySel()
+ *
+ *      Input:  pixd (1 bpp; can equal pixs)
+ *              pixs (1 bpp)
+ *              sel
+ *              plan (<optional> from selMakeMorphPlan(sel); can be null)
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE)
+ *              xoff, yoff (location of the UL corner of pixd in pixs)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This uses the decomposition of sel if there is one, and
+ *          otherwise does the operation directly.  See
+ *          morphWordAccum() for the window given by pixd.
+ *      (2) If plan is null, it is made here for a Sel with enough
+ *          hits, and destroyed after use.  If it cannot be made,
+ *          the operation is done directly.
+ */
+static l_int32
+morphApplySel(PIX     *pixd,
+              PIX     *pixs,
+              SEL     *sel,
+              SELA    *plan,
+              l_int32  type,
+              l_int32  xoff,
+              l_int32  yoff)
+{
+l_int32  i, j, nhits, ret;
+SELA    *sela;
+
+    sela = plan;
+    if (!plan) {
+        for (i = 0, nhits = 0; i < sel->sy; i++) {
+            for (j = 0; j < sel->sx; j++) {
+                if (sel->data[i][j] == SEL_HIT)
+                    nhits++;
+            }
+        }
+        if (nhits >= MIN_PLAN_HITS)
+            sela = selMakeMorphPlan(sel);
+    }
+    if (sela && selaGetCount(sela) > 1)
+        ret = morphApplyPlan(pixd, pixs, sel, sela, type, xoff, yoff);
+    else
+        ret = morphWordAccum(pixd, pixs, sel, type, xoff, yoff);
+    if (sela != plan)
+        selaDestroy(&sela);
+    return ret;
+}
+
+
+/*!
+ *  morphApplyPlan()
+ *
+ *      Input:  pixd (1 bpp; can equal pixs)
+ *              pixs (1 bpp)
+ *              sel (the Sel that was decomposed)
+ *              plan (from selMakeMorphPlan(), with at least 2 Sels)
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE)
+ *              xoff, yoff (location of the UL corner of pixd in pixs)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The Sels in the plan are applied in sequence to an
+ *          intermediate image that covers both pixs and the window
+ *          given by pixd, with a margin as large as the extent of
+ *          sel.  Outside pixs, it is OFF, except for erosion with
+ *          symmetric b.c., where it is ON.  Every intermediate pixel
+ *          needed for the result is then computed as if the image
+ *          were unbounded, so the result is identical to that from
+ *          sel itself.
+ *      (2) The first Sel reads from pixs and the last one writes to
+ *          pixd, so the margin is added and removed without copying.
+ */
+static l_int32
+morphApplyPlan(PIX     *pixd,
+               PIX     *pixs,
+               SEL     *sel,
+               SELA    *plan,
+               l_int32  type,
+               l_int32  xoff,
+               l_int32  yoff)
+{
+l_int32  i, j, n, w, h, wd, hd, sx, sy, cx, cy, bx, by, ret;
+l_int32  left, right, top, bot;
+PIX     *pixb;
+
+    PROCNAME("morphApplyPlan");
+
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    bx = by = 0;
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT) {
+                bx = L_MAX(bx, L_ABS(j - cx));
+                by = L_MAX(by, L_ABS(i - cy));
+            }
+        }
+    }
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixGetDimensions(pixd, &wd, &hd, NULL);
+    left = bx + L_MAX(0, -xoff);
+    right = bx + L_MAX(0, xoff + wd - w);
+    top = by + L_MAX(0, -yoff);
+    bot = by + L_MAX(0, yoff + hd - h);
+    if ((pixb = pixCreate(w + left + right, h + top + bot, 1)) == NULL)
+        return ERROR_INT("pixb not made", procName, 1);
+
+    n = selaGetCount(plan);
+    ret = morphWordAccum(pixb, pixs, selaGetSel(plan, 0), type, -left, -top);
+    for (i = 1; !ret && i < n - 1; i++)
+        ret = morphWordAccum(pixb, pixb, selaGetSel(plan, i), type, 0, 0);
+    if (!ret)
+        ret = morphWordAccum(pixd, pixb, selaGetSel(plan, n - 1), type,
+                             xoff + left, yoff + top);
+    pixDestroy(&pixb);
+    if (ret)
+        return ERROR_INT("plan not applied", procName, 1);
+    return 0;
+}
+
+
+/*-----------------------------------------------------------------*
+ *        Destination word accumulation for arbitrary Sels         *
+ *-----------------------------------------------------------------*/
+/*!
+ *  morphWordAccum()
+ *
+ *      Input:  pixd (1 bpp; can equal pixs)
+ *              pixs (1 bpp)
+ *              sel
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_HMT)
+ *              xoff, yoff (location of the UL corner of pixd in pixs)
+ *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      (1) This makes a single pass over pixd.  Each destination line
+ *          is built 32 pixels at a time, by combining shifted source
+ *          words for all the Sel elements.
+ *      (2) The Sel elements are grouped into runs of hits (or misses)
+ *          along rows or columns of the Sel, whichever gives the
+ *          lower cost.  For each run length that occurs, a copy of
+ *          the source is transformed so that each pixel holds the
+ *          OR (or AND) of the run of pixels starting there.  This is
+ *          done by doubling, in about log2(length) passes.  Each run
+ *          then costs a single shifted access, so a solid 15 x 15
+ *          brick needs 15 accesses and 4 transform passes instead of
+ *          225 full-image rasterops.
+ *      (3) The source is copied into a buffer with a border of words
+ *          and lines, so the inner loops need no boundary tests.  The
+ *          border value gives the b.c.:
+ *            - dilation: pixels outside are OFF
+ *            - erosion: OFF for asymmetric b.c., ON for symmetric b.c.
+ *            - hmt: OFF.  This fails hits that read outside the image,
+ *              which is equivalent to clearing the edges by the
+ *              maximum translations of the hits, and passes misses.
+ *          These give the same result as applying each Sel element
+ *          with a separate rasterop over the entire image.  The pad
+ *          bits of pixd are cleared.
+ *      (4) The inner loops are simple enough for the compiler to
+ *          vectorize.
+ *      (5) pixd can equal pixs, because pixs is copied before pixd
+ *          is written.
+ *      (6) pixd is a window on the result, which is defined everywhere
+ *          by the b.c.  With xoff = yoff = 0 and pixd the same size as
+ *          pixs, this is the usual operation.  With a larger pixd and
+ *          negative offsets, it is the same as first adding a border
+ *          of pixels at the b.c. value to pixs; with a smaller pixd
+ *          and positive offsets, it is the same as removing a border
+ *          from the result.  Either way the border costs nothing.
+ *          Only the lines of pixs that are read for the window are
+ *          copied, so a window that is a band of the image costs in
+ *          proportion to the height of the band.
+ */
+static l_int32
+morphWordAccum(PIX     *pixd,
+               PIX     *pixs,
+               SEL     *sel,
+               l_int32  type,
+               l_int32  xoff,
+               l_int32  yoff)
+{
+l_int32     i, j, k, w, h, wpl, wd, hd, wpld, wplb, hb, sx, sy, cx, cy;
+l_int32     ox, oy, q, r, qmin, qmax;
+l_int32     maxox, maxoy, bx, by, gw, gh, rem, nterms, nh, nv;
+l_int32     ntrans, dir, op, found, ret;
+l_int32    *grid, *tlen, *tox, *toy, *tmiss, *tindex, *translen, *transop;
+l_uint32    bordval, initval, padmask;
+l_uint32   *datab, *datas, *datad, *lines, *lineb, *lined;
+l_uint32  **trans;
+
+    PROCNAME("morphWordAccum");
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixGetDimensions(pixd, &wd, &hd, NULL);
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    wpl = pixGetWpl(pixs);
+    wpld = pixGetWpl(pixd);
+    datas = pixGetData(pixs);
+    datad = pixGetData(pixd);
+
+        /* Put the Sel elements in a grid of source offsets (ox, oy),
+         * with the origin at the center.  Dilation reads the source
+         * reflected through the Sel origin.  Grid values are
+         * 1 for hits and 2 for misses. */
+    maxox = L_MAX(L_ABS(cx), L_ABS(sx - 1 - cx));
+    maxoy = L_MAX(L_ABS(cy), L_ABS(sy - 1 - cy));
+    gw = 2 * maxox + 1;
+    gh = 2 * maxoy + 1;
+    if ((grid = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32))) == NULL)
+        return ERROR_INT("grid not made", procName, 1);
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT ||
+                (sel->data[i][j] == SEL_MISS && type == L_MORPH_HMT)) {
+                if (type == L_MORPH_DILATE) {
+                    ox = cx - j;
+                    oy = cy - i;
+                }
+                else {
+                    ox = j - cx;
+                    oy = i - cy;
+                }
+                grid[(oy + maxoy) * gw + ox + maxox] = sel->data[i][j];
+            }
+        }
+    }
+
+        /* Decompose into runs, both ways, and choose the cheaper */
+    tlen = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tox = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    toy = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tmiss = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    tindex = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    translen = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    transop = (l_int32 *)CALLOC(gw * gh, sizeof(l_int32));
+    trans = (l_uint32 **)CALLOC(gw * gh, sizeof(l_uint32 *));
+    if (!tlen || !tox || !toy || !tmiss || !tindex || !translen ||
+        !transop || !trans) {
+        datab = NULL;
+        ret = ERROR_INT("arrays not made", procName, 1);
+        goto cleanup;
+    }
+    nh = morphFindRuns(grid, gw, gh, maxox, maxoy, L_HORIZ, tlen, tox, toy,
+                       tmiss);
+    nh += morphRunTransformCost(tlen, tmiss, nh, type);
+    nv = morphFindRuns(grid, gw, gh, maxox, maxoy, L_VERT, tlen, tox, toy,
+                       tmiss);
+    nv += morphRunTransformCost(tlen, tmiss, nv, type);
+    dir = (nh <= nv) ? L_HORIZ : L_VERT;
+    nterms = morphFindRuns(grid, gw, gh, maxox, maxoy, dir, tlen, tox, toy,
+                           tmiss);
+
+    bordval = 0;
+    if (type == L_MORPH_ERODE && MORPH_BC == SYMMETRIC_MORPH_BC)
+        bordval = 0xffffffff;
+    initval = (type == L_MORPH_DILATE) ? 0 : 0xffffffff;
+
+        /* Copy the lines of pixs that are read for the window into
+         * the bordered buffer.  Buffer line i holds source line
+         * i + yoff - maxoy, and the border must hold every source
+         * word read for the window. */
+    q = xoff - maxox;
+    qmin = (q >= 0) ? q / 32 : -((31 - q) / 32);
+    q = xoff + maxox;
+    qmax = (q >= 0) ? q / 32 : -((31 - q) / 32);
+    bx = L_MAX(1, L_MAX(-qmin, qmax + wpld + 1 - wpl));
+    by = yoff - maxoy;
+    wplb = wpl + 2 * bx;
+    hb = hd + 2 * maxoy;
+    if ((datab = (l_uint32 *)CALLOC(wplb * hb, sizeof(l_uint32))) == NULL) {
+        ret = ERROR_INT("datab not made", procName, 1);
+        goto cleanup;
+    }
+    if (bordval) {
+        for (k = 0; k < wplb * hb; k++)
+            datab[k] = bordval;
+    }
+    rem = w & 31;
+    padmask = (rem) ? (0xffffffff << (32 - rem)) : 0xffffffff;
+    for (i = L_MAX(0, by); i < L_MIN(h, by + hb); i++) {
+        lines = datas + i * wpl;
+        lineb = datab + (i - by) * wplb + bx;
+        memcpy(lineb, lines, 4 * wpl);
+        lineb[wpl - 1] = (lineb[wpl - 1] & padmask) | (bordval & ~padmask);
+    }
+
+        /* Make a transformed copy for each run length and operation.
+         * Hits in erosion and hmt need the AND over the run; hits in
+         * dilation and misses in hmt need the OR. */
+    ntrans = 0;
+    for (j = 0; j < nterms; j++) {
+        op = (type != L_MORPH_DILATE && !tmiss[j]) ? L_ACCUM_AND : L_ACCUM_OR;
+        if (tlen[j] == 1) {
+            tindex[j] = -1;
+            continue;
+        }
+        for (k = 0, found = FALSE; k < ntrans; k++) {
+            if (translen[k] == tlen[j] && transop[k] == op) {
+                found = TRUE;
+                break;
+            }
+        }
+        if (!found) {
+            if ((trans[k] = (l_uint32 *)CALLOC(wplb * hb,
+                                               sizeof(l_uint32))) == NULL) {
+                ret = ERROR_INT("trans not made", procName, 1);
+                goto cleanup;
+            }
+            memcpy(trans[k], datab, 4 * wplb * hb);
+            runTransformLow(trans[k], wplb, hb, tlen[j], dir, op, bordval);
+            translen[k] = tlen[j];
+            transop[k] = op;
+            ntrans++;
+        }
+        tindex[j] = k;
+    }
+
+        /* Accumulate into each destination line */
+    for (i = 0; i < hd; i++) {
+        lined = datad + i * wpld;
+        for (k = 0; k < wpld; k++)
+            lined[k] = initval;
+        for (j = 0; j < nterms; j++) {
+            ox = tox[j] + xoff;
+            q = (ox >= 0) ? ox / 32 : -((31 - ox) / 32);
+            r = ox - 32 * q;
+            lineb = (tindex[j] < 0) ? datab : trans[tindex[j]];
+            lineb += (i + maxoy + toy[j]) * wplb + bx + q;
+            if (type == L_MORPH_DILATE)
+                accumulateLineLow(lined, lineb, wpld, r, L_ACCUM_OR);
+            else if (tmiss[j])
+                accumulateLineLow(lined, lineb, wpld, r, L_ACCUM_AND_NOT);
+            else
+                accumulateLineLow(lined, lineb, wpld, r, L_ACCUM_AND);
         }
+    }
+    pixSetPadBits(pixd, 0);
+    ret = 0;
+
+cleanup:
+    if (trans) {
+        for (k = 0; k < gw * gh; k++)
+            if (trans[k]) FREE(trans[k]);
+        FREE(trans);
+    }
+    if (datab) FREE(datab);
+    if (grid) FREE(grid);
+    if (tlen) FREE(tlen);
+    if (tox) FREE(tox);
+    if (toy) FREE(toy);
+    if (tmiss) FREE(tmiss);
+    if (tindex) FREE(tindex);
+    if (translen) FREE(translen);
+    if (transop) FREE(transop);
+    return ret;
+}
+
+
+/*!
+ *  morphFindRuns()
+ *
+ *      Input:  grid (of Sel elements at source offsets; 1 for hit,
+ *                    2 for miss)
+ *              gw, gh (grid size)
+ *              maxox, maxoy (offset of the grid center)
+ *              dir (L_HORIZ for runs along rows, L_VERT along columns)
+ *              tlen, tox, toy, tmiss (<return> run length, offset of
+ *                                     the first element, and type)
+ *      Return: number of runs
+ */
+static l_int32
+morphFindRuns(l_int32  *grid,
+              l_int32   gw,
+              l_int32   gh,
+              l_int32   maxox,
+              l_int32   maxoy,
+              l_int32   dir,
+              l_int32  *tlen,
+              l_int32  *tox,
+              l_int32  *toy,
+              l_int32  *tmiss)
+{
+l_int32  i, j, n, len, val, nouter, ninner, x, y;
+
+    nouter = (dir == L_HORIZ) ? gh : gw;
+    ninner = (dir == L_HORIZ) ? gw : gh;
+    n = 0;
+    for (i = 0; i < nouter; i++) {
+        for (j = 0; j < ninner; j += L_MAX(len, 1)) {
+            x = (dir == L_HORIZ) ? j : i;
+            y = (dir == L_HORIZ) ? i : j;
+            len = 0;
+            if ((val = grid[y * gw + x]) == 0)
+                continue;
+            for (len = 1; j + len < ninner; len++) {
+                if (dir == L_HORIZ && grid[y * gw + x + len] != val)
+                    break;
+                if (dir == L_VERT && grid[(y + len) * gw + x] != val)
+                    break;
+            }
+            tlen[n] = len;
+            tox[n] = x - maxox;
+            toy[n] = y - maxoy;
+            tmiss[n] = (val == SEL_MISS);
+            n++;
+        }
+    }
+    return n;
+}
+
+
+/*!
+ *  morphRunTransformCost()
+ *
+ *      Input:  tlen, tmiss (run lengths and types)
+ *              n (number of runs)
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_HMT)
+ *      Return: number of passes needed to make the transformed images
+ */
+static l_int32
+morphRunTransformCost(l_int32  *tlen,
+                      l_int32  *tmiss,
+                      l_int32   n,
+                      l_int32   type)
+{
+l_int32  i, j, cost, op, opj, pow2, dup;
+
+    cost = 0;
+    for (i = 0; i < n; i++) {
+        if (tlen[i] == 1)
+            continue;
+        op = (type != L_MORPH_DILATE && !tmiss[i]) ? 1 : 0;
+        for (j = 0, dup = FALSE; j < i; j++) {
+            opj = (type != L_MORPH_DILATE && !tmiss[j]) ? 1 : 0;
+            if (tlen[j] == tlen[i] && opj == op) {
+                dup = TRUE;
+                break;
+            }
+        }
+        if (dup)
+            continue;
+        cost++;  /* copy */
+        for (pow2 = 1; 2 * pow2 <= tlen[i]; pow2 *= 2)
+            cost++;
+        if (pow2 < tlen[i])
+            cost++;
+    }
+    return cost;
+}
+
+
+/*!
+ *  runTransformLow()
+ *
+ *      Input:  data (bordered 1 bpp image; transformed in place)
+ *              wpl, h (of data)
+ *              size (run length; > 1)
+ *              dir (L_HORIZ, L_VERT)
+ *              op (L_ACCUM_OR, L_ACCUM_AND)
+ *              bordval (value assumed beyond the end of data)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) On return, each pixel holds the OR (or AND) of the run of
+ *          size pixels starting at that pixel, to the right (L_HORIZ)
+ *          or below (L_VERT).
+ *      (2) With R(n) the result for run length n, this uses
+ *          R(2n)[x] = R(n)[x] op R(n)[x + n] for powers of 2 up to
+ *          the largest, p, that does not exceed size, and then
+ *          R(size)[x] = R(p)[x] op R(p)[x + size - p].  Each step
+ *          reads only pixels at or after x, so it can be done in
+ *          place in raster order.
+ *      (3) Pixels whose run extends beyond the end of the data are
+ *          computed with bordval; the caller's border is wide enough
+ *          that these are never used.
+ */
+static void
+runTransformLow(l_uint32  *data,
+                l_int32    wpl,
+                l_int32    h,
+                l_int32    size,
+                l_int32    dir,
+                l_int32    op,
+                l_uint32   bordval)
+{
+l_int32    i, k, m, pow2, shift, q, r, kmax;
+l_uint32   val;
+l_uint32  *line, *linen;
+
+    for (pow2 = 1; 2 * pow2 <= size; pow2 *= 2)
+        ;
+    for (m = 1; m <= pow2; m *= 2) {
+        if (m < pow2)
+            shift = m;
+        else if (pow2 < size)
+            shift = size - pow2;
         else
-            *ppixt = pixClone(pixs);
+            break;
+
+        if (dir == L_VERT) {
+            for (i = 0; i < h; i++) {
+                line = data + i * wpl;
+                if (i + shift < h) {
+                    linen = line + shift * wpl;
+                    if (op == L_ACCUM_OR) {
+                        for (k = 0; k < wpl; k++)
+                            line[k] |= linen[k];
+                    }
+                    else {
+                        for (k = 0; k < wpl; k++)
+                            line[k] &= linen[k];
+                    }
+                }
+                else {
+                    for (k = 0; k < wpl; k++) {
+                        if (op == L_ACCUM_OR)
+                            line[k] |= bordval;
+                        else
+                            line[k] &= bordval;
+                    }
+                }
+            }
+            continue;
+        }
+
+            /* Horizontal: word k takes the shifted bits from words
+             * k + q and k + q + 1 */
+        q = shift / 32;
+        r = shift & 31;
+        kmax = L_MAX(0, wpl - q - 1);
+        for (i = 0; i < h; i++) {
+            line = data + i * wpl;
+            accumulateLineLow(line, line + q, kmax, r, op);
+            for (k = kmax; k < wpl; k++) {
+                if (r == 0)
+                    val = (k + q < wpl) ? line[k + q] : bordval;
+                else
+                    val = (((k + q < wpl) ? line[k + q] : bordval) << r) |
+                          (((k + q + 1 < wpl) ? line[k + q + 1] : bordval)
+                           >> (32 - r));
+                if (op == L_ACCUM_OR)
+                    line[k] |= val;
+                else
+                    line[k] &= val;
+            }
+        }
     }
-    return pixd;
+    return;
+}
+
+
+/*!
+ *  accumulateLineLow()
+ *
+ *      Input:  lined (destination line)
+ *              lines (source line, at the word offset)
+ *              wpl (number of words to accumulate)
+ *              shift (bit shift to the left, in [0 ... 31])
+ *              op (L_ACCUM_OR, L_ACCUM_AND, L_ACCUM_AND_NOT)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Source word k, shifted left by shift bits, takes its low
+ *          bits from word k + 1.  If shift > 0, lines must be readable
+ *          at index wpl.
+ *      (2) lined and lines can overlap if lines >= lined, because
+ *          word k is written after words k and k + 1 are read.
+ */
+static void
+accumulateLineLow(l_uint32  *lined,
+                  l_uint32  *lines,
+                  l_int32    wpl,
+                  l_int32    shift,
+                  l_int32    op)
+{
+l_int32  k, rshift;
+
+    if (shift == 0) {
+        if (op == L_ACCUM_OR) {
+            for (k = 0; k < wpl; k++)
+                lined[k] |= lines[k];
+        }
+        else if (op == L_ACCUM_AND) {
+            for (k = 0; k < wpl; k++)
+                lined[k] &= lines[k];
+        }
+        else {
+            for (k = 0; k < wpl; k++)
+                lined[k] &= ~lines[k];
+        }
+        return;
+    }
+
+    rshift = 32 - shift;
+    if (op == L_ACCUM_OR) {
+        for (k = 0; k < wpl; k++)
+            lined[k] |= (lines[k] << shift) | (lines[k + 1] >> rshift);
+    }
+    else if (op == L_ACCUM_AND) {
+        for (k = 0; k < wpl; k++)
+            lined[k] &= (lines[k] << shift) | (lines[k + 1] >> rshift);
+    }
+    else {
+        for (k = 0; k < wpl; k++)
+            lined[k] &= ~((lines[k] << shift) | (lines[k + 1] >> rshift));
+    }
+    return;
 }
 
 
+/*-----------------------------------------------------------------*
+ *               Static helpers for arg processing                 *
+ *-----------------------------------------------------------------*/
 /*!
  *  processMorphArgs2()
  *
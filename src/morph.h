@@ -34,6 +34,8 @@
  *      struct Sel
  *      struct Sela
  *      struct Kernel
+ *      struct MorphStep
+ *      struct MorphSeq
  *
  *  Contains definitions for:
  *      morphological b.c. flags
@@ -41,6 +43,7 @@
  *      runlength flags for granulometry
  *      direction flags for grayscale morphology
  *      morphological operation flags
+ *      compiled morphological sequence flags
  *      standard border size
  *      grayscale intensity scaling flags
  *      morphological tophat flags
@@ -88,10 +91,52 @@ struct L_Kernel
     l_int32       cy;          /* y location of kernel origin              */
     l_int32       cx;          /* x location of kernel origin              */
     l_float32   **data;        /* data[i][j] in [row][col] order           */
+    l_int32       convtype;    /* cached result of kernelGetConvolveType() */
+    l_float32    *colfact;     /* if separable, data[i][j] is              */
+    l_float32    *rowfact;     /*   colfact[i] * rowfact[j]                */
 };
 typedef struct L_Kernel  L_KERNEL;
 
 
+/*-------------------------------------------------------------------------*
+ *                    Compiled morphological sequence                      *
+ *-------------------------------------------------------------------------*/
+struct L_MorphStep
+{
+    l_int32       op;          /* L_MORPH_* or L_MSEQ_* operation          */
+    l_int32       method;      /* L_MSEQ_RASTEROP, L_MSEQ_DWA, etc.        */
+    l_int32       hsize;       /* brick width, for morphological ops       */
+    l_int32       vsize;       /* brick height, for morphological ops      */
+    l_int32       level[4];    /* rank levels for reduction; level[0] is   */
+                               /* the factor for expansion                 */
+    struct Sel   *selh;        /* horizontal (or only) rasterop brick      */
+    struct Sel   *selv;        /* vertical rasterop brick; can be null     */
+    char         *nameh;       /* horizontal (or only) dwa Sel name        */
+    char         *namev;       /* vertical dwa Sel name; can be null       */
+};
+typedef struct L_MorphStep  L_MORPHSTEP;
+
+struct L_MorphSeq
+{
+    l_int32              depth;    /* 1 for binary, 8 for grayscale        */
+    l_int32              n;        /* number of steps                      */
+    l_int32              border;   /* added at start and removed at end    */
+    struct L_MorphStep  *step;     /* array of steps                       */
+};
+typedef struct L_MorphSeq  L_MORPHSEQ;
+
+
+/*-------------------------------------------------------------------------*
+ *               Kernel types for choosing a convolution method            *
+ *-------------------------------------------------------------------------*/
+enum {
+    L_KERNEL_UNKNOWN = 0,     /* kernel has not been analyzed             */
+    L_KERNEL_GENERAL = 1,     /* arbitrary real values                    */
+    L_KERNEL_INTEGER = 2,     /* small integer values; not separable      */
+    L_KERNEL_SEPARABLE = 3    /* outer product of a column and a row      */
+};
+
+
 /*-------------------------------------------------------------------------*
  *                 Morphological boundary condition flags                  *
  *
@@ -147,6 +192,25 @@ enum {
 };
 
 
+/*-------------------------------------------------------------------------*
+ *            Operations and methods in a compiled morph sequence          *
+ *-------------------------------------------------------------------------*/
+enum {
+    L_MSEQ_TOPHAT_WHITE = 11,     /* grayscale white tophat               */
+    L_MSEQ_TOPHAT_BLACK = 12,     /* grayscale black tophat               */
+    L_MSEQ_REDUCE = 13,           /* binary rank reduction cascade        */
+    L_MSEQ_EXPAND = 14            /* binary replicative expansion         */
+};
+
+enum {
+    L_MSEQ_RASTEROP = 1,          /* separable rasterop with brick Sels   */
+    L_MSEQ_COMPOSITE = 2,         /* rasterop with brick and comb Sels    */
+    L_MSEQ_DWA = 3,               /* dwa with linear brick Sels           */
+    L_MSEQ_GRAY = 4,              /* grayscale (van Herk/Gil-Werman)      */
+    L_MSEQ_SCALE = 5              /* binary reduction or expansion        */
+};
+
+
 /*-------------------------------------------------------------------------*
  *                    Grayscale intensity scaling flags                    *
  *-------------------------------------------------------------------------*/
@@ -174,8 +238,8 @@ enum {
     L_ARITH_SUBTRACT  = 2,
     L_ARITH_MULTIPLY  = 3,   /* on numas only */
     L_ARITH_DIVIDE    = 4,   /* on numas only */
-    L_UNION           = 5,   /* on numas only */
-    L_INTERSECTION    = 6,   /* on numas only */
+    L_UNION           = 5,   /* on numas and sela morph ops */
+    L_INTERSECTION    = 6,   /* on numas and sela morph ops */
     L_SUBTRACTION     = 7,   /* on numas only */
     L_EXCLUSIVE_OR    = 8    /* on numas only */
 };
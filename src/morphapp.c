@@ -72,15 +72,68 @@
  *            PIX       *pixFastTophat()
  *            PIX       *pixMorphGradient()
  *
+ *      Static helpers for fused grayscale brick min/max ops
+ *            static PIX        *pixGrayMinMaxDiff()
+ *            static GMMSTREAM  *grayMinMaxStreamCreate()
+ *            static void        grayMinMaxStreamDestroy()
+ *            static l_uint8    *grayMinMaxStreamGetRow()
+ *            static void        grayMinMaxBlocks()
+ *            static void        grayMinMaxRows()
+ *
  *      Centroid of component
  *            PTA       *pixaCentroids()
  *            l_int32    pixCentroid()
  */
 
+#include <string.h>
 #include "allheaders.h"
 
 #define   SWAP(x, y)   {temp = (x); (x) = (y); (y) = temp;}
 
+/*
+ *  A GrayMinMaxStage is one separable pass (horizontal or vertical)
+ *  of a grayscale brick erosion or dilation, and a GrayMinMaxStream
+ *  is a chain of up to 4 of them, evaluated one row at a time.
+ */
+struct GrayMinMaxStage
+{
+    l_int32     ishoriz;   /* 1 for a horizontal pass; 0 for vertical    */
+    l_int32     ismax;     /* 1 for dilation (max); 0 for erosion (min)  */
+    l_int32     size;      /* width or height of the brick               */
+    l_int32     neutral;   /* value used for pixels outside the image    */
+    l_int32     nextin;    /* vertical: next input row, from -size/2     */
+    l_int32     nextout;   /* vertical: next output row                  */
+    l_int32     nraw;      /* vertical: number of rows in next block     */
+    l_uint8    *row;       /* output row                                 */
+    l_uint8    *buf1;      /* horiz: padded row, suffix; vert: prefix    */
+    l_uint8    *buf2;      /* horiz: prefix; vert: storage for blocks    */
+    l_uint8   **suf;       /* vertical: suffix rows of current block     */
+    l_uint8   **raw;       /* vertical: input rows of next block         */
+};
+typedef struct GrayMinMaxStage    GMMSTAGE;
+
+struct GrayMinMaxStream
+{
+    PIX        *pixs;      /* input image (not owned)                    */
+    l_int32     w, h;      /* size of pixs                               */
+    l_int32     nextsrc;   /* next row of pixs to be read                */
+    l_uint8    *srcrow;    /* row of pixs, as bytes                      */
+    l_int32     nstages;   /* number of passes                           */
+    GMMSTAGE    stage[4];  /* the passes, in order                       */
+};
+typedef struct GrayMinMaxStream    GMMSTREAM;
+
+static PIX *pixGrayMinMaxDiff(PIX *pixs, l_int32 hsize, l_int32 vsize,
+                              l_int32 optype, l_int32 type);
+static GMMSTREAM *grayMinMaxStreamCreate(PIX *pixs, l_int32 hsize,
+                                         l_int32 vsize, l_int32 optype);
+static void grayMinMaxStreamDestroy(GMMSTREAM **pgs);
+static l_uint8 *grayMinMaxStreamGetRow(GMMSTREAM *gs, l_int32 index);
+static void grayMinMaxBlocks(l_uint8 *suf, l_uint8 *pre, l_int32 len,
+                             l_int32 n, l_int32 ismax);
+static void grayMinMaxRows(l_uint8 *out, l_uint8 *a, l_uint8 *b, l_int32 w,
+                           l_int32 ismax);
+
 
 /*-----------------------------------------------------------------*
  *                   Extraction of boundary pixels                 *
@@ -471,15 +524,19 @@ PIXA    *pixad;
  *              type (L_MORPH_DILATE, etc.)
  *      Return: pixd (union of the specified morphological operation
  *                    on pixs for each Sel in the Sela), or null on error
+ *
+ *  Notes:
+ *      (1) This is done in a single pass with pixMorphSelaBand(),
+ *          without making an image for each Sel.  The result is
+ *          identical to the union of the separate operations.
  */
 PIX *
 pixUnionOfMorphOps(PIX     *pixs,
                    SELA    *sela,
                    l_int32  type)
 {
-l_int32  n, i;
-PIX     *pixt, *pixd;
-SEL     *sel;
+l_int32  n;
+PIX     *pixd;
 
     PROCNAME("pixUnionOfMorphOps");
 
@@ -495,23 +552,13 @@ SEL     *sel;
         type != L_MORPH_HMT)
         return (PIX *)ERROR_PTR("invalid type", procName, NULL);
 
-    pixd = pixCreateTemplate(pixs);
-    for (i = 0; i < n; i++) {
-        sel = selaGetSel(sela, i);
-        if (type == L_MORPH_DILATE)
-            pixt = pixDilate(NULL, pixs, sel);
-        else if (type == L_MORPH_ERODE)
-            pixt = pixErode(NULL, pixs, sel);
-        else if (type == L_MORPH_OPEN)
-            pixt = pixOpen(NULL, pixs, sel);
-        else if (type == L_MORPH_CLOSE)
-            pixt = pixClose(NULL, pixs, sel);
-        else  /* type == L_MORPH_HMT */
-            pixt = pixHMT(NULL, pixs, sel);
-        pixOr(pixd, pixd, pixt);
-        pixDestroy(&pixt);
+    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    if (pixMorphSelaBand(pixd, pixs, sela, type, L_UNION, 0,
+                         pixGetHeight(pixs))) {
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("union not made", procName, NULL);
     }
-
     return pixd;
 }
 
@@ -524,15 +571,19 @@ SEL     *sel;
  *              type (L_MORPH_DILATE, etc.)
  *      Return: pixd (intersection of the specified morphological operation
  *                    on pixs for each Sel in the Sela), or null on error
+ *
+ *  Notes:
+ *      (1) This is done in a single pass with pixMorphSelaBand(),
+ *          without making an image for each Sel.  The result is
+ *          identical to the intersection of the separate operations.
  */
 PIX *
 pixIntersectionOfMorphOps(PIX     *pixs,
                           SELA    *sela,
                           l_int32  type)
 {
-l_int32  n, i;
-PIX     *pixt, *pixd;
-SEL     *sel;
+l_int32  n;
+PIX     *pixd;
 
     PROCNAME("pixIntersectionOfMorphOps");
 
@@ -548,24 +599,13 @@ SEL     *sel;
         type != L_MORPH_HMT)
         return (PIX *)ERROR_PTR("invalid type", procName, NULL);
 
-    pixd = pixCreateTemplate(pixs);
-    pixSetAll(pixd);
-    for (i = 0; i < n; i++) {
-        sel = selaGetSel(sela, i);
-        if (type == L_MORPH_DILATE)
-            pixt = pixDilate(NULL, pixs, sel);
-        else if (type == L_MORPH_ERODE)
-            pixt = pixErode(NULL, pixs, sel);
-        else if (type == L_MORPH_OPEN)
-            pixt = pixOpen(NULL, pixs, sel);
-        else if (type == L_MORPH_CLOSE)
-            pixt = pixClose(NULL, pixs, sel);
-        else  /* type == L_MORPH_HMT */
-            pixt = pixHMT(NULL, pixs, sel);
-        pixAnd(pixd, pixd, pixt);
-        pixDestroy(&pixt);
+    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    if (pixMorphSelaBand(pixd, pixs, sela, type, L_INTERSECTION, 0,
+                         pixGetHeight(pixs))) {
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("intersection not made", procName, NULL);
     }
-
     return pixd;
 }
 
@@ -652,6 +692,8 @@ PIXA    *pixa;
  *        It finds the centroid of each c.c., and subtracts
  *        (the appropriately dilated version of) pixp, with the center
  *        of the Sel used to align pixp with pixs.
+ *    (4) To look for many patterns, make pixe for all of them at
+ *        once with pixHMTMultiple().
  */
 l_int32
 pixRemoveMatchedPattern(PIX     *pixs,
@@ -756,6 +798,8 @@ SEL     *sel;
  *        pixels using pixp (appropriately aligned) as a stencil.
  *        Alignment is done using the origin of the Sel and the
  *        centroid of the eroded image to place the stencil pixp.
+ *    (5) To look for many patterns, make pixe for all of them at
+ *        once with pixHMTMultiple().
  */
 PIX *
 pixDisplayMatchedPattern(PIX       *pixs,
@@ -1038,6 +1082,10 @@ SEL       *sel_2a;
  *          whereas the L_TOPHAT_BLACK flag emphasizes small dark regions.
  *          The L_TOPHAT_WHITE tophat can be accomplished by doing a
  *          L_TOPHAT_BLACK tophat on the inverse, or v.v.
+ *      (4) The opening (or closing) and the subtraction are fused,
+ *          so the only full-size image made is pixd.  The result is
+ *          identical to pixSubtractGray() applied to the result of
+ *          pixOpenGray() (or pixCloseGray()).
  */
 PIX *
 pixTophat(PIX     *pixs,
@@ -1045,7 +1093,7 @@ pixTophat(PIX     *pixs,
           l_int32  vsize,
           l_int32  type)
 {
-PIX  *pixt, *pixd;
+PIX  *pixd;
 
     PROCNAME("pixTophat");
 
@@ -1070,23 +1118,12 @@ PIX  *pixt, *pixd;
     if (hsize == 1 && vsize == 1)
         return pixCreateTemplate(pixs);
 
-    switch (type)
-    {
-    case L_TOPHAT_WHITE:
-        if ((pixt = pixOpenGray(pixs, hsize, vsize)) == NULL)
-            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
-        pixd = pixSubtractGray(NULL, pixs, pixt);
-        pixDestroy(&pixt);
-        break;
-    case L_TOPHAT_BLACK:
-        if ((pixd = pixCloseGray(pixs, hsize, vsize)) == NULL)
-            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
-        pixSubtractGray(pixd, pixd, pixs);
-        break;
-    default:
-        return (PIX *)ERROR_PTR("invalid type", procName, NULL);
-    }
-
+    if (type == L_TOPHAT_WHITE)
+        pixd = pixGrayMinMaxDiff(pixs, hsize, vsize, L_MORPH_OPEN, type);
+    else
+        pixd = pixGrayMinMaxDiff(pixs, hsize, vsize, L_MORPH_CLOSE, type);
+    if (!pixd)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
     return pixd;
 }
 
@@ -1136,13 +1173,18 @@ PIX  *pixt, *pixd;
  *          with the filling mask, pixs.
  *      (6) For segmentation, the resulting image, pixd, can be thresholded
  *          and used as a seed for another filling operation.
+ *      (7) The seed is made in one pass over pixs, filled in place,
+ *          and then replaced in place by the difference, so pixd is
+ *          the only image that is made.
  */
 PIX *
 pixHDome(PIX     *pixs,
          l_int32  height,
          l_int32  connectivity)
 {
-PIX  *pixsd, *pixd;
+l_int32    i, j, w, h, wpls, wpld, sval, val;
+l_uint32  *datas, *datad, *lines, *lined;
+PIX       *pixd;
 
     PROCNAME("pixHDome");
 
@@ -1152,16 +1194,40 @@ PIX  *pixsd, *pixd;
         return (PIX *)ERROR_PTR("pixs not 8 bpp", procName, NULL);
     if (height < 0)
         return (PIX *)ERROR_PTR("height not >= 0", procName, NULL);
+    if (connectivity != 4 && connectivity != 8)
+        return (PIX *)ERROR_PTR("connectivity not in {4,8}", procName, NULL);
     if (height == 0)
         return pixCreateTemplate(pixs);
 
-    if ((pixsd = pixCopy(NULL, pixs)) == NULL)
-        return (PIX *)ERROR_PTR("pixsd not made", procName, NULL);
-    pixAddConstantGray(pixsd, -height);
-    pixSeedfillGray(pixsd, pixs, connectivity);
-    pixd = pixSubtractGray(NULL, pixs, pixsd);
+        /* Make the seed: pixs lowered by @height, clipped at 0 */
+    if ((pixd = pixCreateTemplateNoInit(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    datas = pixGetData(pixs);
+    datad = pixGetData(pixd);
+    wpls = pixGetWpl(pixs);
+    wpld = pixGetWpl(pixd);
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        lined = datad + i * wpld;
+        for (j = 0; j < w; j++) {
+            val = GET_DATA_BYTE(lines, j) - height;
+            SET_DATA_BYTE(lined, j, L_MAX(0, val));
+        }
+    }
+
+        /* Fill the seed under pixs, and take the part that is unfilled */
+    pixSeedfillGray(pixd, pixs, connectivity);
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        lined = datad + i * wpld;
+        for (j = 0; j < w; j++) {
+            sval = GET_DATA_BYTE(lines, j);
+            val = sval - GET_DATA_BYTE(lined, j);
+            SET_DATA_BYTE(lined, j, L_MAX(0, val));
+        }
+    }
 
-    pixDestroy(&pixsd);
     return pixd;
 }
 
@@ -1191,6 +1257,12 @@ PIX  *pixsd, *pixd;
  *          If you need the preciseness of the tophat, don't use this.
  *      (4) The L_TOPHAT_WHITE flag emphasizes small bright regions,
  *          whereas the L_TOPHAT_BLACK flag emphasizes small dark regions.
+ *      (5) The replicative expansion is done on the fly, within the
+ *          subtraction, so no full-size background image is made.
+ *          The source pixels are chosen exactly as in
+ *          pixScaleBySampling().  As before, for L_TOPHAT_WHITE pixd is
+ *          the size of pixs, and for L_TOPHAT_BLACK it is the size of
+ *          the expanded background.
  */
 PIX *
 pixFastTophat(PIX     *pixs,
@@ -1198,7 +1270,12 @@ pixFastTophat(PIX     *pixs,
               l_int32  ysize,
               l_int32  type)
 {
-PIX  *pixt1, *pixt2, *pixt3, *pixd;
+l_int32    i, j, ws, hs, wt, ht, wd, hd, wm, hm, wpls, wplt, wpld;
+l_int32    sval, bval, val;
+l_int32   *srow, *scol;
+l_uint32  *datas, *datat, *datad, *lines, *linet, *lined;
+l_float32  ratio;
+PIX       *pixt1, *pixt2, *pixd;
 
     PROCNAME("pixFastTophat");
 
@@ -1215,30 +1292,86 @@ PIX  *pixt1, *pixt2, *pixt3, *pixd;
     if (xsize == 1 && ysize == 1)
         return pixCreateTemplate(pixs);
 
-    switch (type)
-    {
-    case L_TOPHAT_WHITE:
-        if ((pixt1 = pixScaleGrayMinMax(pixs, xsize, ysize, L_CHOOSE_MIN))
-               == NULL)
-            return (PIX *)ERROR_PTR("pixt1 not made", procName, NULL);
-        pixt2 = pixBlockconv(pixt1, 1, 1);  /* small smoothing */
-        pixt3 = pixScaleBySampling(pixt2, xsize, ysize);
-        pixd = pixSubtractGray(NULL, pixs, pixt3);
-        pixDestroy(&pixt3);
-        break;
-    case L_TOPHAT_BLACK:
-        if ((pixt1 = pixScaleGrayMinMax(pixs, xsize, ysize, L_CHOOSE_MAX))
-               == NULL)
-            return (PIX *)ERROR_PTR("pixt1 not made", procName, NULL);
-        pixt2 = pixBlockconv(pixt1, 1, 1);  /* small smoothing */
-        pixd = pixScaleBySampling(pixt2, xsize, ysize);
-        pixSubtractGray(pixd, pixd, pixs);
-        break;
-    default:
-        return (PIX *)ERROR_PTR("invalid type", procName, NULL);
+        /* Background at low res, with a small smoothing */
+    pixt1 = pixScaleGrayMinMax(pixs, xsize, ysize,
+               (type == L_TOPHAT_WHITE) ? L_CHOOSE_MIN : L_CHOOSE_MAX);
+    if (!pixt1)
+        return (PIX *)ERROR_PTR("pixt1 not made", procName, NULL);
+    pixt2 = pixBlockconv(pixt1, 1, 1);
+    pixDestroy(&pixt1);
+    if (!pixt2)
+        return (PIX *)ERROR_PTR("pixt2 not made", procName, NULL);
+
+        /* Size of the expanded background, and its source pixels */
+    pixGetDimensions(pixs, &ws, &hs, NULL);
+    pixGetDimensions(pixt2, &wt, &ht, NULL);
+    wd = (l_int32)((l_float32)xsize * (l_float32)wt + 0.5);
+    hd = (l_int32)((l_float32)ysize * (l_float32)ht + 0.5);
+    srow = (l_int32 *)CALLOC(hd, sizeof(l_int32));
+    scol = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    if (!srow || !scol) {
+        FREE(srow);
+        FREE(scol);
+        pixDestroy(&pixt2);
+        return (PIX *)ERROR_PTR("srow or scol not made", procName, NULL);
+    }
+    ratio = (l_float32)ht / (l_float32)hd;
+    for (i = 0; i < hd; i++)
+        srow[i] = L_MIN((l_int32)(ratio * i + 0.5), ht - 1);
+    ratio = (l_float32)wt / (l_float32)wd;
+    for (j = 0; j < wd; j++)
+        scol[j] = L_MIN((l_int32)(ratio * j + 0.5), wt - 1);
+
+    if (type == L_TOPHAT_WHITE) {
+        pixd = pixCopy(NULL, pixs);  /* unchanged outside the background */
+    }
+    else {
+        if ((pixd = pixCreate(wd, hd, 8)) != NULL) {
+            pixCopyResolution(pixd, pixt2);
+            pixScaleResolution(pixd, (l_float32)xsize, (l_float32)ysize);
+        }
+    }
+    if (!pixd) {
+        FREE(srow);
+        FREE(scol);
+        pixDestroy(&pixt2);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
     }
 
-    pixDestroy(&pixt1);
+        /* Subtract over the overlap of pixs and the background;
+         * elsewhere pixd keeps pixs (white) or the background (black) */
+    wm = L_MIN(ws, wd);
+    hm = L_MIN(hs, hd);
+    datas = pixGetData(pixs);
+    datat = pixGetData(pixt2);
+    datad = pixGetData(pixd);
+    wpls = pixGetWpl(pixs);
+    wplt = pixGetWpl(pixt2);
+    wpld = pixGetWpl(pixd);
+    for (i = 0; i < hd; i++) {
+        linet = datat + srow[i] * wplt;
+        lined = datad + i * wpld;
+        if (type == L_TOPHAT_WHITE) {
+            if (i >= hm)
+                break;
+            lines = datas + i * wpls;
+            for (j = 0; j < wm; j++) {
+                val = GET_DATA_BYTE(lines, j) - GET_DATA_BYTE(linet, scol[j]);
+                SET_DATA_BYTE(lined, j, L_MAX(0, val));
+            }
+        }
+        else {
+            lines = datas + i * wpls;
+            for (j = 0; j < wd; j++) {
+                bval = GET_DATA_BYTE(linet, scol[j]);
+                sval = (i < hm && j < wm) ? GET_DATA_BYTE(lines, j) : 0;
+                SET_DATA_BYTE(lined, j, L_MAX(0, bval - sval));
+            }
+        }
+    }
+
+    FREE(srow);
+    FREE(scol);
     pixDestroy(&pixt2);
     return pixd;
 }
@@ -1253,6 +1386,10 @@ PIX  *pixt1, *pixt2, *pixt3, *pixd;
  *              smoothing  (half-width of convolution smoothing filter.
  *                          The width is (2 * smoothing + 1), so 0 is no-op.
  *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) The dilation and the subtraction are fused, so that without
+ *          smoothing the only full-size image made is pixd.
  */
 PIX *
 pixMorphGradient(PIX     *pixs,
@@ -1279,18 +1416,387 @@ PIX  *pixg, *pixd;
         vsize++;
     }
 
-        /* Optionally smooth first to remove noise.
-         * If smoothing is 0, just get a copy */
-    pixg = pixBlockconvGray(pixs, NULL, smoothing, smoothing);
+        /* Optionally smooth first to remove noise */
+    if (smoothing > 0)
+        pixg = pixBlockconvGray(pixs, NULL, smoothing, smoothing);
+    else
+        pixg = pixClone(pixs);
+    if (!pixg)
+        return (PIX *)ERROR_PTR("pixg not made", procName, NULL);
 
         /* This gives approximately the gradient of a transition */
-    pixd = pixDilateGray(pixg, hsize, vsize);
-    pixSubtractGray(pixd, pixd, pixg);
+    pixd = pixGrayMinMaxDiff(pixg, hsize, vsize, L_MORPH_DILATE,
+                             L_TOPHAT_BLACK);
     pixDestroy(&pixg);
     return pixd;
 }
 
 
+/*-----------------------------------------------------------------*
+ *       Static helpers for fused grayscale brick min/max ops      *
+ *-----------------------------------------------------------------*/
+/*!
+ *  pixGrayMinMaxDiff()
+ *
+ *      Input:  pixs (8 bpp)
+ *              hsize (of brick Sel; odd)
+ *              vsize (of brick Sel; odd)
+ *              optype (L_MORPH_DILATE, L_MORPH_OPEN or L_MORPH_CLOSE)
+ *              type (L_TOPHAT_WHITE: pixs - op(pixs);
+ *                    L_TOPHAT_BLACK: op(pixs) - pixs)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This gives the same result as pixDilateGray(), pixOpenGray()
+ *          or pixCloseGray() followed by pixSubtractGray(), but it
+ *          makes a single output image.  The separable passes are
+ *          chained row by row, so that no full-size intermediate is
+ *          made: each horizontal pass works on one row, and each
+ *          vertical pass holds 2 * vsize + 2 rows.
+ *      (2) Each pass uses the van Herk/Gil-Werman method, with pixels
+ *          outside the image taken to be neutral (255 for erosion,
+ *          0 for dilation), as in the functions in graymorph.c.
+ */
+static PIX *
+pixGrayMinMaxDiff(PIX     *pixs,
+                  l_int32  hsize,
+                  l_int32  vsize,
+                  l_int32  optype,
+                  l_int32  type)
+{
+l_int32     i, j, w, h, wpls, wpld, sval, val;
+l_uint8    *line;
+l_uint32   *datas, *datad, *lines, *lined;
+GMMSTREAM  *gs;
+PIX        *pixd;
+
+    PROCNAME("pixGrayMinMaxDiff");
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if ((gs = grayMinMaxStreamCreate(pixs, hsize, vsize, optype)) == NULL)
+        return (PIX *)ERROR_PTR("gs not made", procName, NULL);
+    if (gs->nstages == 0) {  /* identity op; the difference is 0 */
+        grayMinMaxStreamDestroy(&gs);
+        return pixCreateTemplate(pixs);
+    }
+    if ((pixd = pixCreateTemplateNoInit(pixs)) == NULL) {
+        grayMinMaxStreamDestroy(&gs);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
+
+    datas = pixGetData(pixs);
+    datad = pixGetData(pixd);
+    wpls = pixGetWpl(pixs);
+    wpld = pixGetWpl(pixd);
+    for (i = 0; i < h; i++) {
+        line = grayMinMaxStreamGetRow(gs, gs->nstages - 1);
+        lines = datas + i * wpls;
+        lined = datad + i * wpld;
+        if (type == L_TOPHAT_WHITE) {
+            for (j = 0; j < w; j++) {
+                sval = GET_DATA_BYTE(lines, j);
+                val = sval - line[j];
+                SET_DATA_BYTE(lined, j, L_MAX(0, val));
+            }
+        }
+        else {
+            for (j = 0; j < w; j++) {
+                sval = GET_DATA_BYTE(lines, j);
+                val = line[j] - sval;
+                SET_DATA_BYTE(lined, j, L_MAX(0, val));
+            }
+        }
+    }
+
+    grayMinMaxStreamDestroy(&gs);
+    return pixd;
+}
+
+
+/*!
+ *  grayMinMaxStreamCreate()
+ *
+ *      Input:  pixs (8 bpp)
+ *              hsize, vsize (of brick Sel; odd)
+ *              optype (L_MORPH_DILATE, L_MORPH_OPEN or L_MORPH_CLOSE)
+ *      Return: gs, or null on error
+ *
+ *  Notes:
+ *      (1) Sets up the chain of separable passes.  Passes with a
+ *          size of 1 are omitted, so there can be no passes at all.
+ */
+static GMMSTREAM *
+grayMinMaxStreamCreate(PIX     *pixs,
+                       l_int32  hsize,
+                       l_int32  vsize,
+                       l_int32  optype)
+{
+l_int32     i, j, n, nb, w, ismax, first;
+GMMSTAGE   *st;
+GMMSTREAM  *gs;
+
+    PROCNAME("grayMinMaxStreamCreate");
+
+    if ((gs = (GMMSTREAM *)CALLOC(1, sizeof(GMMSTREAM))) == NULL)
+        return (GMMSTREAM *)ERROR_PTR("gs not made", procName, NULL);
+    pixGetDimensions(pixs, &w, &gs->h, NULL);
+    gs->w = w;
+    gs->pixs = pixs;
+    if ((gs->srcrow = (l_uint8 *)CALLOC(w, sizeof(l_uint8))) == NULL) {
+        grayMinMaxStreamDestroy(&gs);
+        return (GMMSTREAM *)ERROR_PTR("srcrow not made", procName, NULL);
+    }
+
+        /* A dilation is one max op; an opening is a min op followed
+         * by a max op, and a closing is the reverse.  Each op is
+         * a horizontal pass followed by a vertical pass. */
+    first = (optype == L_MORPH_OPEN) ? 0 : 1;
+    for (i = 0; i < 2; i++) {
+        if (i == 1 && optype == L_MORPH_DILATE)
+            break;
+        ismax = (i == 0) ? first : 1 - first;
+        for (j = 0; j < 2; j++) {
+            n = (j == 0) ? hsize : vsize;
+            if (n == 1)
+                continue;
+            st = &gs->stage[gs->nstages++];
+            st->ishoriz = (j == 0);
+            st->ismax = ismax;
+            st->size = n;
+            st->neutral = (ismax) ? 0 : 255;
+            st->row = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
+            if (st->ishoriz) {
+                nb = (w + n - 1) / n + 1;  /* blocks covering w + n - 1 */
+                st->buf1 = (l_uint8 *)CALLOC(nb * n, sizeof(l_uint8));
+                st->buf2 = (l_uint8 *)CALLOC(nb * n, sizeof(l_uint8));
+            }
+            else {
+                st->buf1 = (l_uint8 *)CALLOC(w, sizeof(l_uint8));
+                st->buf2 = (l_uint8 *)CALLOC(2 * n * w, sizeof(l_uint8));
+                st->suf = (l_uint8 **)CALLOC(n, sizeof(l_uint8 *));
+                st->raw = (l_uint8 **)CALLOC(n, sizeof(l_uint8 *));
+                if (st->suf && st->raw && st->buf2) {
+                    for (nb = 0; nb < n; nb++) {
+                        st->suf[nb] = st->buf2 + nb * w;
+                        st->raw[nb] = st->buf2 + (n + nb) * w;
+                    }
+                }
+                st->nextin = -(n / 2);
+            }
+            if (!st->row || !st->buf1 || !st->buf2 ||
+                (!st->ishoriz && (!st->suf || !st->raw))) {
+                grayMinMaxStreamDestroy(&gs);
+                return (GMMSTREAM *)ERROR_PTR("buffers not made",
+                                              procName, NULL);
+            }
+        }
+    }
+
+    return gs;
+}
+
+
+/*!
+ *  grayMinMaxStreamDestroy()
+ *
+ *      Input:  &gs (<to be nulled>)
+ *      Return: void
+ */
+static void
+grayMinMaxStreamDestroy(GMMSTREAM  **pgs)
+{
+l_int32     i;
+GMMSTAGE   *st;
+GMMSTREAM  *gs;
+
+    if ((gs = *pgs) == NULL)
+        return;
+    for (i = 0; i < 4; i++) {
+        st = &gs->stage[i];
+        FREE(st->row);
+        FREE(st->buf1);
+        FREE(st->buf2);
+        FREE(st->suf);
+        FREE(st->raw);
+    }
+    FREE(gs->srcrow);
+    FREE(gs);
+    *pgs = NULL;
+    return;
+}
+
+
+/*!
+ *  grayMinMaxStreamGetRow()
+ *
+ *      Input:  gs
+ *              index (of pass; -1 for the source image)
+ *      Return: ptr to the next output row of the pass
+ *
+ *  Notes:
+ *      (1) Each call returns the next row; rows are pulled from the
+ *          previous pass as they are needed.  The returned row is
+ *          valid until the next call for the same pass.
+ *      (2) A horizontal pass pads the row with (size / 2) neutral
+ *          pixels on each side, and takes the max (or min) over
+ *          blocks of @size pixels using a prefix array and a suffix
+ *          array within each block.  The result at x is then
+ *          op(suffix[x], prefix[x + size - 1]).
+ *      (3) A vertical pass does the same on rows.  It holds the suffix
+ *          rows of the current block and, for the following block,
+ *          the rows read so far and their running prefix.
+ */
+static l_uint8 *
+grayMinMaxStreamGetRow(GMMSTREAM  *gs,
+                       l_int32     index)
+{
+l_int32    j, n, o, w, nb, src;
+l_uint8   *in, *pre, *suf, *out, *tmp;
+l_uint8  **ptmp;
+l_uint32  *lines;
+GMMSTAGE  *st;
+
+    w = gs->w;
+    if (index < 0) {
+        lines = pixGetData(gs->pixs) + gs->nextsrc * pixGetWpl(gs->pixs);
+        gs->nextsrc++;
+        for (j = 0; j < w; j++)
+            gs->srcrow[j] = GET_DATA_BYTE(lines, j);
+        return gs->srcrow;
+    }
+
+    st = &gs->stage[index];
+    n = st->size;
+    out = st->row;
+    if (st->ishoriz) {
+        in = grayMinMaxStreamGetRow(gs, index - 1);
+        nb = (w + n - 1) / n + 1;
+        suf = st->buf1;
+        pre = st->buf2;
+        memset(suf, st->neutral, n / 2);
+        memcpy(suf + n / 2, in, w);
+        memset(suf + n / 2 + w, st->neutral, nb * n - n / 2 - w);
+        grayMinMaxBlocks(suf, pre, nb * n, n, st->ismax);
+        if (st->ismax) {
+            for (j = 0; j < w; j++)
+                out[j] = L_MAX(suf[j], pre[j + n - 1]);
+        }
+        else {
+            for (j = 0; j < w; j++)
+                out[j] = L_MIN(suf[j], pre[j + n - 1]);
+        }
+        return out;
+    }
+
+        /* Vertical pass.  Output row r is at the offset o = r % n in
+         * the current block; it needs the suffix row at o and the
+         * prefix of the first o rows of the next block. */
+    o = st->nextout % n;
+    st->nextout++;
+    if (o == 0) {  /* complete the next block and make it current */
+        while (st->nraw < n) {
+            src = st->nextin++;
+            if (src >= 0 && src < gs->h)
+                memcpy(st->raw[st->nraw],
+                       grayMinMaxStreamGetRow(gs, index - 1), w);
+            else
+                memset(st->raw[st->nraw], st->neutral, w);
+            st->nraw++;
+        }
+        for (j = n - 2; j >= 0; j--)
+            grayMinMaxRows(st->raw[j], st->raw[j], st->raw[j + 1], w,
+                           st->ismax);
+        ptmp = st->suf;
+        st->suf = st->raw;
+        st->raw = ptmp;
+        st->nraw = 0;
+        return st->suf[0];
+    }
+
+    src = st->nextin++;
+    tmp = st->raw[st->nraw];
+    if (src >= 0 && src < gs->h)
+        memcpy(tmp, grayMinMaxStreamGetRow(gs, index - 1), w);
+    else
+        memset(tmp, st->neutral, w);
+    st->nraw++;
+    if (o == 1)
+        memcpy(st->buf1, tmp, w);
+    else
+        grayMinMaxRows(st->buf1, st->buf1, tmp, w, st->ismax);
+    grayMinMaxRows(out, st->suf[o], st->buf1, w, st->ismax);
+    return out;
+}
+
+
+/*!
+ *  grayMinMaxBlocks()
+ *
+ *      Input:  suf (array of size @len; input, replaced by suffix op)
+ *              pre (array of size @len; output prefix op)
+ *              len (a multiple of @n)
+ *              n (block size)
+ *              ismax (1 for max, 0 for min)
+ *      Return: void
+ */
+static void
+grayMinMaxBlocks(l_uint8  *suf,
+                 l_uint8  *pre,
+                 l_int32   len,
+                 l_int32   n,
+                 l_int32   ismax)
+{
+l_int32  i, j, start;
+
+    for (start = 0; start < len; start += n) {
+        pre[start] = suf[start];
+        if (ismax) {
+            for (i = start + 1; i < start + n; i++)
+                pre[i] = L_MAX(pre[i - 1], suf[i]);
+            for (j = start + n - 2; j >= start; j--)
+                suf[j] = L_MAX(suf[j], suf[j + 1]);
+        }
+        else {
+            for (i = start + 1; i < start + n; i++)
+                pre[i] = L_MIN(pre[i - 1], suf[i]);
+            for (j = start + n - 2; j >= start; j--)
+                suf[j] = L_MIN(suf[j], suf[j + 1]);
+        }
+    }
+    return;
+}
+
+
+/*!
+ *  grayMinMaxRows()
+ *
+ *      Input:  out (can be the same as @a)
+ *              a, b (input rows)
+ *              w (row length)
+ *              ismax (1 for max, 0 for min)
+ *      Return: void
+ */
+static void
+grayMinMaxRows(l_uint8  *out,
+               l_uint8  *a,
+               l_uint8  *b,
+               l_int32   w,
+               l_int32   ismax)
+{
+l_int32  j;
+
+    if (ismax) {
+        for (j = 0; j < w; j++)
+            out[j] = L_MAX(a[j], b[j]);
+    }
+    else {
+        for (j = 0; j < w; j++)
+            out[j] = L_MIN(a[j], b[j]);
+    }
+    return;
+}
+
+
 /*-----------------------------------------------------------------*
  *                       Centroid of component                     *
  *-----------------------------------------------------------------*/
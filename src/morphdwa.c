@@ -220,9 +220,9 @@ PIX     *pixt1, *pixt2, *pixt3;
     else {
         pixt1 = pixAddBorder(pixs, 32, 0);
         pixt3 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_DILATE, selnameh);
-        pixFMorphopGen_1(pixt1, pixt3, L_MORPH_DILATE, selnamev);
-        pixt2 = pixRemoveBorder(pixt1, 32);
         pixDestroy(&pixt1);
+        pixt2 = pixCreateTemplate(pixs);  /* last pass removes the border */
+        pixFMorphopGenInterior_1(pixt2, pixt3, L_MORPH_DILATE, selnamev);
         pixDestroy(&pixt3);
         FREE(selnameh);
         FREE(selnamev);
@@ -322,9 +322,9 @@ PIX     *pixt1, *pixt2, *pixt3;
     else {
         pixt1 = pixAddBorder(pixs, 32, 0);
         pixt3 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_ERODE, selnameh);
-        pixFMorphopGen_1(pixt1, pixt3, L_MORPH_ERODE, selnamev);
-        pixt2 = pixRemoveBorder(pixt1, 32);
         pixDestroy(&pixt1);
+        pixt2 = pixCreateTemplate(pixs);  /* last pass removes the border */
+        pixFMorphopGenInterior_1(pixt2, pixt3, L_MORPH_ERODE, selnamev);
         pixDestroy(&pixt3);
         FREE(selnameh);
         FREE(selnamev);
@@ -414,26 +414,26 @@ PIX     *pixt1, *pixt2, *pixt3;
     }
 
     pixt1 = pixAddBorder(pixs, 32, 0);
+        /* The last pass writes the interior directly to pixt3 */
+    pixt3 = pixCreateTemplate(pixs);
     if (vsize == 1) {   /* horizontal only */
-        pixt2 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_OPEN, selnameh);
+        pixFMorphopGenInterior_1(pixt3, pixt1, L_MORPH_OPEN, selnameh);
         FREE(selnameh);
     }
     else if (hsize == 1) {   /* vertical only */
-        pixt2 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_OPEN, selnamev);
+        pixFMorphopGenInterior_1(pixt3, pixt1, L_MORPH_OPEN, selnamev);
         FREE(selnamev);
     }
     else {  /* do separable */
-        pixt3 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_ERODE, selnameh);
-        pixt2 = pixFMorphopGen_1(NULL, pixt3, L_MORPH_ERODE, selnamev);
-        pixFMorphopGen_1(pixt3, pixt2, L_MORPH_DILATE, selnameh);
-        pixFMorphopGen_1(pixt2, pixt3, L_MORPH_DILATE, selnamev);
+        pixt2 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_ERODE, selnameh);
+        pixFMorphopGen_1(pixt1, pixt2, L_MORPH_ERODE, selnamev);
+        pixFMorphopGen_1(pixt2, pixt1, L_MORPH_DILATE, selnameh);
+        pixFMorphopGenInterior_1(pixt3, pixt2, L_MORPH_DILATE, selnamev);
         FREE(selnameh);
         FREE(selnamev);
-        pixDestroy(&pixt3);
+        pixDestroy(&pixt2);
     }
-    pixt3 = pixRemoveBorder(pixt2, 32);
     pixDestroy(&pixt1);
-    pixDestroy(&pixt2);
 
     if (!pixd)
         return pixt3;
@@ -531,26 +531,26 @@ PIX     *pixt1, *pixt2, *pixt3;
         bordersize = 32;
     pixt1 = pixAddBorder(pixs, bordersize, 0);
 
+        /* The last pass writes the interior directly to pixt3 */
+    pixt3 = pixCreateTemplate(pixs);
     if (vsize == 1) {   /* horizontal only */
-        pixt2 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_CLOSE, selnameh);
+        pixFMorphopGenInterior_1(pixt3, pixt1, L_MORPH_CLOSE, selnameh);
         FREE(selnameh);
     }
     else if (hsize == 1) {   /* vertical only */
-        pixt2 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_CLOSE, selnamev);
+        pixFMorphopGenInterior_1(pixt3, pixt1, L_MORPH_CLOSE, selnamev);
         FREE(selnamev);
     }
     else {  /* do separable */
-        pixt3 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_DILATE, selnameh);
-        pixt2 = pixFMorphopGen_1(NULL, pixt3, L_MORPH_DILATE, selnamev);
-        pixFMorphopGen_1(pixt3, pixt2, L_MORPH_ERODE, selnameh);
-        pixFMorphopGen_1(pixt2, pixt3, L_MORPH_ERODE, selnamev);
+        pixt2 = pixFMorphopGen_1(NULL, pixt1, L_MORPH_DILATE, selnameh);
+        pixFMorphopGen_1(pixt1, pixt2, L_MORPH_DILATE, selnamev);
+        pixFMorphopGen_1(pixt2, pixt1, L_MORPH_ERODE, selnameh);
+        pixFMorphopGenInterior_1(pixt3, pixt2, L_MORPH_ERODE, selnamev);
         FREE(selnameh);
         FREE(selnamev);
-        pixDestroy(&pixt3);
+        pixDestroy(&pixt2);
     }
-    pixt3 = pixRemoveBorder(pixt2, bordersize);
     pixDestroy(&pixt1);
-    pixDestroy(&pixt2);
 
     if (!pixd)
         return pixt3;
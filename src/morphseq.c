@@ -47,11 +47,49 @@
  *
  *      Run a sequence of color morphological operations
  *            PIX     *pixColorMorphSequence()
+ *
+ *      Compiled morphological sequences
+ *            L_MORPHSEQ  *morphSeqCreate()
+ *            void         morphSeqDestroy()
+ *            PIX         *pixMorphSeqApply()
+ *            l_int32      morphSeqGetHalo()
+ *            l_int32      pixMorphSeqApplyBand()
+ *            PIX         *pixMorphSeqApplyByBand()
+ *            static l_int32  morphSeqAddStep()
+ *            static char    *morphSeqGetDwaName()
+ *            static l_int32  morphSeqIsComposable()
+ *            static PIX     *pixMorphSeqApplyBinary()
+ *            static PIX     *morphSeqDwaStep()
+ *            static PIX     *morphSeqRasteropStep()
+ *            static PIX     *morphSeqCompositeStep()
+ *            static PIX     *pixMorphSeqApplyGray()
+ *            static l_int32  grayMorphSequenceVerify()
  */
 
 #include <string.h>
 #include "allheaders.h"
 
+    /* Border carried through consecutive dwa steps; large enough for
+     * the safe closing with asymmetric b.c. */
+static const l_int32  MSEQ_DWA_BORDER = 64;
+
+    /* Smallest brick dimension for which an exact composite is used */
+static const l_int32  MIN_COMPOSITE_SIZE = 16;
+
+static l_int32 morphSeqAddStep(L_MORPHSEQ *mseq, SELA *sela, l_int32 op,
+                               l_int32 hsize, l_int32 vsize, l_int32 *level);
+static char *morphSeqGetDwaName(SELA *sela, l_int32 hsize, l_int32 vsize);
+static l_int32 morphSeqIsComposable(l_int32 size);
+static PIX *pixMorphSeqApplyBinary(PIX *pixs, L_MORPHSEQ *mseq);
+static PIX *morphSeqDwaStep(PIX *pixd, PIX *pixs, PIX **ppixt,
+                            L_MORPHSTEP *step, l_int32 erodeop);
+static PIX *morphSeqRasteropStep(PIX *pixd, PIX *pixs, PIX **ppixt,
+                                 L_MORPHSTEP *step);
+static PIX *morphSeqCompositeStep(PIX *pixd, PIX *pixs, L_MORPHSTEP *step,
+                                  l_int32 erodeop);
+static PIX *pixMorphSeqApplyGray(PIX *pixs, L_MORPHSEQ *mseq);
+static l_int32 grayMorphSequenceVerify(SARRAY *sa);
+
 /*-------------------------------------------------------------------------*
  *         Run a sequence of binary rasterop morphological operations      *
  *-------------------------------------------------------------------------*/
@@ -926,59 +964,7 @@ SARRAY  *sa;
     pdfout = (dispsep < 0) ? 1 : 0;
 
         /* Verify that the operation sequence is valid */
-    valid = TRUE;
-    for (i = 0; i < nops; i++) {
-        rawop = sarrayGetString(sa, i, 0);
-        op = stringRemoveChars(rawop, " \n\t");
-        switch (op[0])
-        {
-        case 'd':
-        case 'D':
-        case 'e':
-        case 'E':
-        case 'o':
-        case 'O':
-        case 'c':
-        case 'C':
-            if (sscanf(&op[1], "%d.%d", &w, &h) != 2) {
-                fprintf(stderr, "*** op: %s invalid\n", op);
-                valid = FALSE;
-                break;
-            }
-            if (w < 1 || (w & 1) == 0 || h < 1 || (h & 1) == 0 ) {
-                fprintf(stderr,
-                        "*** op: %s; w = %d, h = %d; must both be odd\n",
-                        op, w, h);
-                valid = FALSE;
-                break;
-            }
-/*            fprintf(stderr, "op = %s; w = %d, h = %d\n", op, w, h); */
-            break;
-        case 't':
-        case 'T':
-            if (op[1] != 'w' && op[1] != 'W' &&
-                op[1] != 'b' && op[1] != 'B') {
-                fprintf(stderr,
-                        "*** op = %s; arg %c must be 'w' or 'b'\n", op, op[1]);
-                valid = FALSE;
-                break;
-            }
-            sscanf(&op[2], "%d.%d", &w, &h);
-            if (w < 1 || (w & 1) == 0 || h < 1 || (h & 1) == 0 ) {
-                fprintf(stderr,
-                        "*** op: %s; w = %d, h = %d; must both be odd\n",
-                        op, w, h);
-                valid = FALSE;
-                break;
-            }
-/*            fprintf(stderr, "op = %s", op); */
-            break;
-        default:
-            fprintf(stderr, "*** nonexistent op = %s\n", op);
-            valid = FALSE;
-        }
-        FREE(op);
-    }
+    valid = grayMorphSequenceVerify(sa);
     if (!valid) {
         sarrayDestroy(&sa);
         return (PIX *)ERROR_PTR("sequence invalid", procName, NULL);
@@ -1233,3 +1219,1035 @@ SARRAY  *sa;
     sarrayDestroy(&sa);
     return pixt1;
 }
+
+
+/*-----------------------------------------------------------------*
+ *                Compiled morphological sequences                 *
+ *-----------------------------------------------------------------*/
+/*!
+ *  morphSeqCreate()
+ *
+ *      Input:  sequence (string specifying sequence)
+ *              depth (1 for binary, 8 for grayscale)
+ *      Return: mseq, or null on error
+ *
+ *  Notes:
+ *      (1) This parses and verifies the sequence once, producing a plan
+ *          that can be run on any number of images with
+ *          pixMorphSeqApply().  Use it when the same sequence is
+ *          applied repeatedly.
+ *      (2) For depth = 1, the sequence format is given in the notes
+ *          for pixMorphSequence(), and the result of pixMorphSeqApply()
+ *          is identical to that of pixMorphSequence().  The brick
+ *          implementation is chosen for each step:
+ *            - dwa, if the linear Sels in each direction are among
+ *              those compiled from selaAddBasic();
+ *            - composite rasterop, for larger bricks whose sizes
+ *              factor exactly into a brick and a comb;
+ *            - otherwise, separable rasterop.
+ *          The composite is only used when the factors are exact, and
+ *          it is run with an added border, so the choice never changes
+ *          the result.
+ *      (3) For depth = 1, the following are fused at compile time:
+ *            - adjacent rank reductions, up to 4 levels in a cascade
+ *            - adjacent expansions, up to a total factor of 16
+ *            - trivial 1 x 1 operations are removed
+ *          At run time, consecutive dwa steps share a single added
+ *          border, which is also merged with any 'b' border at the
+ *          start and end of the sequence, and the intermediate images
+ *          are reused from step to step.
+ *      (4) For depth = 8, the sequence format is given in the notes
+ *          for pixGrayMorphSequence(), and the result is identical to
+ *          that of pixGrayMorphSequence().  An erosion followed by a
+ *          dilation with the same brick is fused into an opening, and
+ *          a dilation followed by an erosion into a closing.
+ */
+L_MORPHSEQ *
+morphSeqCreate(const char  *sequence,
+               l_int32      depth)
+{
+char        *rawop, *op;
+l_int32      nops, i, j, nred, fact, w, h, valid;
+l_int32      level[4];
+L_MORPHSEQ  *mseq;
+SARRAY      *sa;
+SELA        *sela;
+
+    PROCNAME("morphSeqCreate");
+
+    if (!sequence)
+        return (L_MORPHSEQ *)ERROR_PTR("sequence not defined", procName, NULL);
+    if (depth != 1 && depth != 8)
+        return (L_MORPHSEQ *)ERROR_PTR("depth not 1 or 8", procName, NULL);
+
+    sa = sarrayCreate(0);
+    sarraySplitString(sa, sequence, "+");
+    nops = sarrayGetCount(sa);
+    if (depth == 1)
+        valid = morphSequenceVerify(sa);
+    else
+        valid = grayMorphSequenceVerify(sa);
+    if (!valid) {
+        sarrayDestroy(&sa);
+        return (L_MORPHSEQ *)ERROR_PTR("sequence not valid", procName, NULL);
+    }
+
+    if ((mseq = (L_MORPHSEQ *)CALLOC(1, sizeof(L_MORPHSEQ))) == NULL) {
+        sarrayDestroy(&sa);
+        return (L_MORPHSEQ *)ERROR_PTR("mseq not made", procName, NULL);
+    }
+    if ((mseq->step = (L_MORPHSTEP *)CALLOC(L_MAX(1, nops),
+                                            sizeof(L_MORPHSTEP))) == NULL) {
+        sarrayDestroy(&sa);
+        FREE(mseq);
+        return (L_MORPHSEQ *)ERROR_PTR("step array not made", procName, NULL);
+    }
+    mseq->depth = depth;
+    sela = (depth == 1) ? selaAddBasic(NULL) : NULL;
+
+    for (i = 0; i < nops; i++) {
+        rawop = sarrayGetString(sa, i, 0);
+        op = stringRemoveChars(rawop, " \n\t");
+        switch (op[0])
+        {
+        case 'd':
+        case 'D':
+            sscanf(&op[1], "%d.%d", &w, &h);
+            morphSeqAddStep(mseq, sela, L_MORPH_DILATE, w, h, NULL);
+            break;
+        case 'e':
+        case 'E':
+            sscanf(&op[1], "%d.%d", &w, &h);
+            morphSeqAddStep(mseq, sela, L_MORPH_ERODE, w, h, NULL);
+            break;
+        case 'o':
+        case 'O':
+            sscanf(&op[1], "%d.%d", &w, &h);
+            morphSeqAddStep(mseq, sela, L_MORPH_OPEN, w, h, NULL);
+            break;
+        case 'c':
+        case 'C':
+            sscanf(&op[1], "%d.%d", &w, &h);
+            morphSeqAddStep(mseq, sela, L_MORPH_CLOSE, w, h, NULL);
+            break;
+        case 't':
+        case 'T':
+            sscanf(&op[2], "%d.%d", &w, &h);
+            if (op[1] == 'w' || op[1] == 'W')
+                morphSeqAddStep(mseq, sela, L_MSEQ_TOPHAT_WHITE, w, h, NULL);
+            else   /* 'b' or 'B' */
+                morphSeqAddStep(mseq, sela, L_MSEQ_TOPHAT_BLACK, w, h, NULL);
+            break;
+        case 'r':
+        case 'R':
+            nred = strlen(op) - 1;
+            for (j = 0; j < nred; j++)
+                level[j] = op[j + 1] - '0';
+            for (j = nred; j < 4; j++)
+                level[j] = 0;
+            morphSeqAddStep(mseq, sela, L_MSEQ_REDUCE, 0, 0, level);
+            break;
+        case 'x':
+        case 'X':
+            sscanf(&op[1], "%d", &fact);
+            level[0] = fact;
+            morphSeqAddStep(mseq, sela, L_MSEQ_EXPAND, 0, 0, level);
+            break;
+        case 'b':
+        case 'B':
+            sscanf(&op[1], "%d", &mseq->border);
+            break;
+        default:
+            /* All invalid ops are caught by the verifier */
+            break;
+        }
+        FREE(op);
+    }
+
+    if (sela) selaDestroy(&sela);
+    sarrayDestroy(&sa);
+    return mseq;
+}
+
+
+/*!
+ *  morphSeqDestroy()
+ *
+ *      Input:  &mseq (<to be nulled>)
+ *      Return: void
+ */
+void
+morphSeqDestroy(L_MORPHSEQ  **pmseq)
+{
+l_int32       i;
+L_MORPHSEQ   *mseq;
+L_MORPHSTEP  *step;
+
+    PROCNAME("morphSeqDestroy");
+
+    if (!pmseq) {
+        L_WARNING("ptr address is null!", procName);
+        return;
+    }
+    if ((mseq = *pmseq) == NULL)
+        return;
+
+    for (i = 0; i < mseq->n; i++) {
+        step = &mseq->step[i];
+        if (step->selh) selDestroy(&step->selh);
+        if (step->selv) selDestroy(&step->selv);
+        if (step->nameh) FREE(step->nameh);
+        if (step->namev) FREE(step->namev);
+    }
+    FREE(mseq->step);
+    FREE(mseq);
+    *pmseq = NULL;
+    return;
+}
+
+
+/*!
+ *  pixMorphSeqApply()
+ *
+ *      Input:  pixs (1 or 8 bpp, matching the depth of mseq)
+ *              mseq (compiled sequence)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) A new image is always produced; the input image is not changed.
+ *      (2) The morphological b.c. in effect when this is called is used;
+ *          it does not need to be the same as when mseq was made.
+ *      (3) See morphSeqCreate() for details.
+ *      (4) To compute the result in independent horizontal bands,
+ *          use pixMorphSeqApplyBand().
+ */
+PIX *
+pixMorphSeqApply(PIX         *pixs,
+                 L_MORPHSEQ  *mseq)
+{
+    PROCNAME("pixMorphSeqApply");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (!mseq)
+        return (PIX *)ERROR_PTR("mseq not defined", procName, NULL);
+    if (pixGetDepth(pixs) != mseq->depth)
+        return (PIX *)ERROR_PTR("pixs depth differs from mseq", procName,
+                                NULL);
+
+    if (mseq->depth == 1)
+        return pixMorphSeqApplyBinary(pixs, mseq);
+    else
+        return pixMorphSeqApplyGray(pixs, mseq);
+}
+
+
+/*!
+ *  morphSeqGetHalo()
+ *
+ *      Input:  mseq (compiled sequence)
+ *              &halo (<return> number of rows above and below a band
+ *                     that can affect the result in the band)
+ *      Return: 0 if OK, 1 on error or if mseq has scaling steps
+ *
+ *  Notes:
+ *      (1) Every implementation of a step gives the same result as
+ *          the brick with its origin at the center, which reads at
+ *          most vsize / 2 rows above or below each pixel.  The halo
+ *          is the sum of these over all passes, where openings,
+ *          closings and tophats have two passes.
+ *      (2) The halo is not defined for sequences with reductions or
+ *          expansions, because they change the image size.
+ */
+l_int32
+morphSeqGetHalo(L_MORPHSEQ  *mseq,
+                l_int32     *phalo)
+{
+l_int32       i, halo;
+L_MORPHSTEP  *step;
+
+    PROCNAME("morphSeqGetHalo");
+
+    if (!phalo)
+        return ERROR_INT("&halo not defined", procName, 1);
+    *phalo = 0;
+    if (!mseq)
+        return ERROR_INT("mseq not defined", procName, 1);
+
+    halo = 0;
+    for (i = 0; i < mseq->n; i++) {
+        step = &mseq->step[i];
+        if (step->method == L_MSEQ_SCALE)
+            return ERROR_INT("mseq has scaling steps", procName, 1);
+        if (step->op == L_MORPH_DILATE || step->op == L_MORPH_ERODE)
+            halo += step->vsize / 2;
+        else
+            halo += 2 * (step->vsize / 2);
+    }
+    *phalo = halo;
+    return 0;
+}
+
+
+/*!
+ *  pixMorphSeqApplyBand()
+ *
+ *      Input:  pixd (same size and depth as pixs; not pixs)
+ *              pixs (1 or 8 bpp, matching the depth of mseq)
+ *              mseq (compiled sequence, without scaling steps)
+ *              y (first row of the band)
+ *              h (number of rows in the band)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This computes rows y through y + h - 1 of the result of
+ *          pixMorphSeqApply(), and writes them into the same rows of
+ *          pixd.  The other rows of pixd are not touched.
+ *      (2) The sequence is run on the band extended by the halo above
+ *          and below (see morphSeqGetHalo()), clipped to the image.
+ *          Bands are the full width of the image, so the dwa and
+ *          composite steps see the same words and horizontal
+ *          boundary as for the whole image, and the result is
+ *          identical for every implementation.
+ *      (3) pixs and mseq are only read, so bands that do not overlap
+ *          can be done in any order, and concurrently.
+ */
+l_int32
+pixMorphSeqApplyBand(PIX         *pixd,
+                     PIX         *pixs,
+                     L_MORPHSEQ  *mseq,
+                     l_int32      y,
+                     l_int32      h)
+{
+l_int32  w, hs, d, halo, y0, y1;
+BOX     *box;
+PIX     *pixc, *pixt;
+
+    PROCNAME("pixMorphSeqApplyBand");
+
+    if (!pixs)
+        return ERROR_INT("pixs not defined", procName, 1);
+    if (!mseq)
+        return ERROR_INT("mseq not defined", procName, 1);
+    if (!pixd || pixd == pixs)
+        return ERROR_INT("pixd undefined or equal to pixs", procName, 1);
+    pixGetDimensions(pixs, &w, &hs, &d);
+    if (d != mseq->depth)
+        return ERROR_INT("pixs depth differs from mseq", procName, 1);
+    if (pixGetWidth(pixd) != w || pixGetHeight(pixd) != hs ||
+        pixGetDepth(pixd) != d)
+        return ERROR_INT("pixd and pixs sizes differ", procName, 1);
+    if (y < 0 || h <= 0 || y + h > hs)
+        return ERROR_INT("band not in image", procName, 1);
+    if (morphSeqGetHalo(mseq, &halo))
+        return ERROR_INT("halo not found", procName, 1);
+
+    y0 = L_MAX(0, y - halo);
+    y1 = L_MIN(hs, y + h + halo);
+    box = boxCreate(0, y0, w, y1 - y0);
+    pixc = pixClipRectangle(pixs, box, NULL);
+    boxDestroy(&box);
+    if (!pixc)
+        return ERROR_INT("pixc not made", procName, 1);
+    pixt = pixMorphSeqApply(pixc, mseq);
+    pixDestroy(&pixc);
+    if (!pixt)
+        return ERROR_INT("pixt not made", procName, 1);
+    pixRasterop(pixd, 0, y, w, h, PIX_SRC, pixt, 0, y - y0);
+    pixDestroy(&pixt);
+    return 0;
+}
+
+
+/*!
+ *  pixMorphSeqApplyByBand()
+ *
+ *      Input:  pixs (1 or 8 bpp, matching the depth of mseq)
+ *              mseq (compiled sequence)
+ *              nbands (number of horizontal bands; >= 1)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This splits the image into nbands bands of nearly equal
+ *          height and does each with pixMorphSeqApplyBand().  The
+ *          result is identical to that of pixMorphSeqApply().
+ *      (2) The bands are independent; this shows how a caller can
+ *          hand them to separate threads.  Each band costs the
+ *          extra work of its halo, so the bands should be several
+ *          times taller than the halo.
+ *      (3) If mseq has reductions or expansions, the sequence is
+ *          run on the whole image.
+ */
+PIX *
+pixMorphSeqApplyByBand(PIX         *pixs,
+                       L_MORPHSEQ  *mseq,
+                       l_int32      nbands)
+{
+l_int32  i, h, bh, y;
+PIX     *pixd;
+
+    PROCNAME("pixMorphSeqApplyByBand");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (!mseq)
+        return (PIX *)ERROR_PTR("mseq not defined", procName, NULL);
+    if (pixGetDepth(pixs) != mseq->depth)
+        return (PIX *)ERROR_PTR("pixs depth differs from mseq", procName,
+                                NULL);
+    if (nbands < 1)
+        return (PIX *)ERROR_PTR("nbands < 1", procName, NULL);
+
+    for (i = 0; i < mseq->n; i++) {
+        if (mseq->step[i].method == L_MSEQ_SCALE)
+            return pixMorphSeqApply(pixs, mseq);
+    }
+
+    h = pixGetHeight(pixs);
+    nbands = L_MIN(nbands, h);
+    bh = (h + nbands - 1) / nbands;
+    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    for (y = 0; y < h; y += bh) {
+        if (pixMorphSeqApplyBand(pixd, pixs, mseq, y, L_MIN(bh, h - y))) {
+            pixDestroy(&pixd);
+            return (PIX *)ERROR_PTR("band not made", procName, NULL);
+        }
+    }
+    return pixd;
+}
+
+
+/*!
+ *  morphSeqAddStep()
+ *
+ *      Input:  mseq
+ *              sela (basic sela for dwa lookup; null for grayscale)
+ *              op (L_MORPH_* or L_MSEQ_*)
+ *              hsize, vsize (of brick, for morphological ops)
+ *              level (array of 4 reduction levels, or expansion factor
+ *                     in level[0]; null for morphological ops)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This fuses the new operation into the last step where
+ *          possible; otherwise it appends a new step.
+ */
+static l_int32
+morphSeqAddStep(L_MORPHSEQ  *mseq,
+                SELA        *sela,
+                l_int32      op,
+                l_int32      hsize,
+                l_int32      vsize,
+                l_int32     *level)
+{
+l_int32       j, nlast, nred, found;
+L_MORPHSTEP  *last, *step;
+
+    PROCNAME("morphSeqAddStep");
+
+    if (!mseq)
+        return ERROR_INT("mseq not defined", procName, 1);
+
+    last = (mseq->n > 0) ? &mseq->step[mseq->n - 1] : NULL;
+
+        /* Merge reductions into one cascade, and expansions into
+         * one replication, where possible */
+    if (op == L_MSEQ_REDUCE) {
+        for (nred = 0; nred < 4 && level[nred] > 0; nred++)
+            ;
+        if (last && last->op == L_MSEQ_REDUCE) {
+            for (nlast = 0; nlast < 4 && last->level[nlast] > 0; nlast++)
+                ;
+            if (nlast + nred <= 4) {
+                for (j = 0; j < nred; j++)
+                    last->level[nlast + j] = level[j];
+                return 0;
+            }
+        }
+    }
+    if (op == L_MSEQ_EXPAND && last && last->op == L_MSEQ_EXPAND &&
+        last->level[0] * level[0] <= 16) {
+        last->level[0] *= level[0];
+        return 0;
+    }
+
+        /* Brick operations that do nothing */
+    if (op != L_MSEQ_REDUCE && op != L_MSEQ_EXPAND && hsize == 1 &&
+        vsize == 1 && op != L_MSEQ_TOPHAT_WHITE && op != L_MSEQ_TOPHAT_BLACK)
+        return 0;
+
+        /* Grayscale erosion followed by dilation (or v.v.) with the
+         * same brick is an opening (or closing) */
+    if (mseq->depth == 8 && last && last->hsize == hsize &&
+        last->vsize == vsize) {
+        if (last->op == L_MORPH_ERODE && op == L_MORPH_DILATE) {
+            last->op = L_MORPH_OPEN;
+            return 0;
+        }
+        if (last->op == L_MORPH_DILATE && op == L_MORPH_ERODE) {
+            last->op = L_MORPH_CLOSE;
+            return 0;
+        }
+    }
+
+    step = &mseq->step[mseq->n];
+    mseq->n++;
+    step->op = op;
+    step->hsize = hsize;
+    step->vsize = vsize;
+    if (op == L_MSEQ_REDUCE || op == L_MSEQ_EXPAND) {
+        step->method = L_MSEQ_SCALE;
+        for (j = 0; j < 4; j++)
+            step->level[j] = level[j];
+        return 0;
+    }
+    if (mseq->depth == 8) {
+        step->method = L_MSEQ_GRAY;
+        return 0;
+    }
+
+        /* Binary brick: use dwa if both linear Sels are available */
+    found = TRUE;
+    if (hsize > 1) {
+        step->nameh = morphSeqGetDwaName(sela, hsize, 1);
+        if (!step->nameh) found = FALSE;
+    }
+    if (vsize > 1) {
+        if (hsize > 1)
+            step->namev = morphSeqGetDwaName(sela, 1, vsize);
+        else
+            step->nameh = morphSeqGetDwaName(sela, 1, vsize);
+        if (hsize > 1 && !step->namev) found = FALSE;
+        if (hsize == 1 && !step->nameh) found = FALSE;
+    }
+    if (found) {
+        step->method = L_MSEQ_DWA;
+        return 0;
+    }
+    if (step->nameh) FREE(step->nameh);
+    if (step->namev) FREE(step->namev);
+    step->nameh = step->namev = NULL;
+
+        /* Otherwise, composite if it is exact; else separable rasterop */
+    if (L_MAX(hsize, vsize) >= MIN_COMPOSITE_SIZE &&
+        morphSeqIsComposable(hsize) && morphSeqIsComposable(vsize)) {
+        step->method = L_MSEQ_COMPOSITE;
+        return 0;
+    }
+    step->method = L_MSEQ_RASTEROP;
+    if (hsize == 1 || vsize == 1) {
+        step->selh = selCreateBrick(vsize, hsize, vsize / 2, hsize / 2,
+                                    SEL_HIT);
+    }
+    else {
+        step->selh = selCreateBrick(1, hsize, 0, hsize / 2, SEL_HIT);
+        step->selv = selCreateBrick(vsize, 1, vsize / 2, 0, SEL_HIT);
+    }
+    return 0;
+}
+
+
+/*!
+ *  morphSeqGetDwaName()
+ *
+ *      Input:  sela (from selaAddBasic())
+ *              hsize, vsize (of linear brick sel)
+ *      Return: sel name (new string), or null if not in sela
+ *
+ *  Notes:
+ *      (1) This is like selaGetBrickName(), but a missing sel is
+ *          not an error.
+ */
+static char *
+morphSeqGetDwaName(SELA    *sela,
+                   l_int32  hsize,
+                   l_int32  vsize)
+{
+l_int32  i, nsels, sx, sy;
+SEL     *sel;
+
+    nsels = selaGetCount(sela);
+    for (i = 0; i < nsels; i++) {
+        sel = selaGetSel(sela, i);
+        selGetParameters(sel, &sy, &sx, NULL, NULL);
+        if (hsize == sx && vsize == sy)
+            return stringNew(selGetName(sel));
+    }
+    return NULL;
+}
+
+
+/*!
+ *  morphSeqIsComposable()
+ *
+ *      Input:  size (of linear brick)
+ *      Return: 1 if the composite brick of this size is exact; 0 otherwise
+ */
+static l_int32
+morphSeqIsComposable(l_int32  size)
+{
+l_int32  factor1, factor2;
+
+    if (size == 1)
+        return 1;
+    if (selectComposableSizes(size, &factor1, &factor2))
+        return 0;
+    return (factor1 * factor2 == size && factor2 > 1);
+}
+
+
+/*!
+ *  pixMorphSeqApplyBinary()
+ *
+ *      Input:  pixs (1 bpp)
+ *              mseq
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) pixc holds the current result and pixb is a spare image that
+ *          receives the next one; they are swapped after each step.
+ *          pixt holds intermediate results within a step.  The input
+ *          pixs is only read, and is never used as a destination.
+ *      (2) While dwa steps are being run, pixc carries a border of
+ *          MSEQ_DWA_BORDER pixels, which is wide enough for the safe
+ *          closing with asymmetric b.c.  It is reset at the start of
+ *          each step, so each step sees the same boundary as in
+ *          pixMorphSequence().
+ */
+static PIX *
+pixMorphSeqApplyBinary(PIX         *pixs,
+                       L_MORPHSEQ  *mseq)
+{
+l_int32       i, border, dwabord, erodeop;
+L_MORPHSTEP  *step;
+PIX          *pixc, *pixb, *pixt, *pixd;
+
+    PROCNAME("pixMorphSeqApplyBinary");
+
+    erodeop = (getMorphBorderPixelColor(L_MORPH_ERODE, 1) == 1) ?
+              PIX_SET : PIX_CLR;
+    border = mseq->border;
+    dwabord = 0;
+    if (mseq->n > 0 && mseq->step[0].method == L_MSEQ_DWA)
+        dwabord = MSEQ_DWA_BORDER;
+    if (border + dwabord > 0)
+        pixc = pixAddBorder(pixs, border + dwabord, 0);
+    else
+        pixc = pixs;
+    pixb = pixt = NULL;
+
+    for (i = 0; i < mseq->n; i++) {
+        step = &mseq->step[i];
+
+            /* Add or remove the shared dwa border */
+        if (step->method == L_MSEQ_DWA && dwabord == 0) {
+            pixd = pixAddBorder(pixc, MSEQ_DWA_BORDER, 0);
+            if (pixc != pixs) pixDestroy(&pixc);
+            pixc = pixd;
+            dwabord = MSEQ_DWA_BORDER;
+        }
+        else if (step->method != L_MSEQ_DWA && dwabord > 0) {
+            pixd = pixRemoveBorder(pixc, dwabord);
+            pixDestroy(&pixc);
+            pixc = pixd;
+            dwabord = 0;
+        }
+
+        if (step->method == L_MSEQ_SCALE) {
+            if (step->op == L_MSEQ_REDUCE)
+                pixd = pixReduceRankBinaryCascade(pixc, step->level[0],
+                           step->level[1], step->level[2], step->level[3]);
+            else
+                pixd = pixExpandReplicate(pixc, step->level[0]);
+            if (pixc != pixs) pixDestroy(&pixc);
+            if ((pixc = pixd) == NULL)
+                break;
+            continue;
+        }
+
+        if (step->method == L_MSEQ_DWA)
+            pixb = morphSeqDwaStep(pixb, pixc, &pixt, step, erodeop);
+        else if (step->method == L_MSEQ_COMPOSITE)
+            pixb = morphSeqCompositeStep(pixb, pixc, step, erodeop);
+        else
+            pixb = morphSeqRasteropStep(pixb, pixc, &pixt, step);
+        if (!pixb)
+            break;
+        pixd = pixc;
+        pixc = pixb;
+        pixb = (pixd == pixs) ? NULL : pixd;
+    }
+
+    if (pixc && border + dwabord > 0) {
+        pixd = pixRemoveBorder(pixc, border + dwabord);
+        if (pixc != pixs) pixDestroy(&pixc);
+        pixc = pixd;
+    }
+    else if (pixc == pixs) {
+        pixc = pixCopy(NULL, pixs);
+    }
+    pixDestroy(&pixb);
+    pixDestroy(&pixt);
+    if (!pixc)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    return pixc;
+}
+
+
+/*!
+ *  morphSeqDwaStep()
+ *
+ *      Input:  pixd (<optional>; null or different from pixs)
+ *              pixs (1 bpp, with a border of MSEQ_DWA_BORDER pixels)
+ *              &pixt (<optional>; intermediate image, reused)
+ *              step
+ *              erodeop (PIX_SET or PIX_CLR, for border before erosion)
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) This runs the same sequence of linear dwa operations as
+ *          the brick dwa functions in morphdwa.c.  The border of
+ *          pixs may be altered.
+ *      (2) pixFMorphopGen_1() resets the outer 32 pixels before each
+ *          pass; here we reset the inner part of the shared border
+ *          where the b.c. requires it.
+ */
+static PIX *
+morphSeqDwaStep(PIX          *pixd,
+                PIX          *pixs,
+                PIX         **ppixt,
+                L_MORPHSTEP  *step,
+                l_int32       erodeop)
+{
+l_int32  bs;
+char    *nameh, *namev;
+
+    bs = MSEQ_DWA_BORDER;
+    nameh = step->nameh;
+    namev = step->namev;
+    switch (step->op)
+    {
+    case L_MORPH_DILATE:
+    case L_MORPH_ERODE:
+        if (step->op == L_MORPH_DILATE)
+            pixSetOrClearBorder(pixs, bs, bs, bs, bs, PIX_CLR);
+        else
+            pixSetOrClearBorder(pixs, bs, bs, bs, bs, erodeop);
+        if (!namev)
+            return pixFMorphopGen_1(pixd, pixs, step->op, nameh);
+        *ppixt = pixFMorphopGen_1(*ppixt, pixs, step->op, nameh);
+        return pixFMorphopGen_1(pixd, *ppixt, step->op, namev);
+    case L_MORPH_OPEN:
+        pixSetOrClearBorder(pixs, bs, bs, bs, bs, erodeop);
+        if (!namev) {
+            *ppixt = pixFMorphopGen_1(*ppixt, pixs, L_MORPH_ERODE, nameh);
+            pixSetOrClearBorder(*ppixt, bs, bs, bs, bs, PIX_CLR);
+            return pixFMorphopGen_1(pixd, *ppixt, L_MORPH_DILATE, nameh);
+        }
+        *ppixt = pixFMorphopGen_1(*ppixt, pixs, L_MORPH_ERODE, nameh);
+        pixd = pixFMorphopGen_1(pixd, *ppixt, L_MORPH_ERODE, namev);
+        pixSetOrClearBorder(pixd, bs, bs, bs, bs, PIX_CLR);
+        pixFMorphopGen_1(*ppixt, pixd, L_MORPH_DILATE, nameh);
+        return pixFMorphopGen_1(pixd, *ppixt, L_MORPH_DILATE, namev);
+    case L_MORPH_CLOSE:
+            /* With asymmetric b.c., the dilated pixels in the border
+             * are kept for the erosion; that makes the closing safe */
+        pixSetOrClearBorder(pixs, bs, bs, bs, bs, PIX_CLR);
+        if (!namev) {
+            *ppixt = pixFMorphopGen_1(*ppixt, pixs, L_MORPH_DILATE, nameh);
+            if (erodeop == PIX_SET)
+                pixSetOrClearBorder(*ppixt, bs, bs, bs, bs, PIX_SET);
+            return pixFMorphopGen_1(pixd, *ppixt, L_MORPH_ERODE, nameh);
+        }
+        *ppixt = pixFMorphopGen_1(*ppixt, pixs, L_MORPH_DILATE, nameh);
+        pixd = pixFMorphopGen_1(pixd, *ppixt, L_MORPH_DILATE, namev);
+        if (erodeop == PIX_SET)
+            pixSetOrClearBorder(pixd, bs, bs, bs, bs, PIX_SET);
+        pixFMorphopGen_1(*ppixt, pixd, L_MORPH_ERODE, nameh);
+        return pixFMorphopGen_1(pixd, *ppixt, L_MORPH_ERODE, namev);
+    default:
+        break;
+    }
+    return pixd;
+}
+
+
+/*!
+ *  morphSeqRasteropStep()
+ *
+ *      Input:  pixd (<optional>; null or different from pixs)
+ *              pixs (1 bpp)
+ *              &pixt (<optional>; intermediate image, reused)
+ *              step
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) This uses the Sels that were made when the sequence was
+ *          compiled, with the same operations as pixDilateBrick(), etc.
+ */
+static PIX *
+morphSeqRasteropStep(PIX          *pixd,
+                     PIX          *pixs,
+                     PIX         **ppixt,
+                     L_MORPHSTEP  *step)
+{
+SEL  *selh, *selv;
+
+    selh = step->selh;
+    selv = step->selv;
+    switch (step->op)
+    {
+    case L_MORPH_DILATE:
+        if (!selv)
+            return pixDilate(pixd, pixs, selh);
+        *ppixt = pixDilate(*ppixt, pixs, selh);
+        return pixDilate(pixd, *ppixt, selv);
+    case L_MORPH_ERODE:
+        if (!selv)
+            return pixErode(pixd, pixs, selh);
+        *ppixt = pixErode(*ppixt, pixs, selh);
+        return pixErode(pixd, *ppixt, selv);
+    case L_MORPH_OPEN:
+        if (!selv) {
+            *ppixt = pixErode(*ppixt, pixs, selh);
+            return pixDilate(pixd, *ppixt, selh);
+        }
+        *ppixt = pixErode(*ppixt, pixs, selh);
+        pixd = pixErode(pixd, *ppixt, selv);
+        pixDilate(*ppixt, pixd, selh);
+        return pixDilate(pixd, *ppixt, selv);
+    case L_MORPH_CLOSE:
+        return pixCloseSafeBrick(pixd, pixs, step->hsize, step->vsize);
+    default:
+        break;
+    }
+    return pixd;
+}
+
+
+/*!
+ *  morphSeqCompositeStep()
+ *
+ *      Input:  pixd (<optional>; null or different from pixs)
+ *              pixs (1 bpp)
+ *              step
+ *              erodeop (PIX_SET or PIX_CLR, for border before erosion)
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) The brick and comb are applied in succession, and the
+ *          intermediate result must be correct outside the image
+ *          for the comb to give the same result as the full brick.
+ *          So this is done with a border that is at least half the
+ *          size of the brick, which is set to the b.c. before each
+ *          erosion and dilation.
+ *      (2) The border is added by the first operation and removed
+ *          by the last one, so pixs is not copied.
+ */
+static PIX *
+morphSeqCompositeStep(PIX          *pixd,
+                      PIX          *pixs,
+                      L_MORPHSTEP  *step,
+                      l_int32       erodeop)
+{
+l_int32  i, n, nsels, bs, hsize, vsize, op1, op2;
+l_int32  ops[8];
+PIX     *pixb;
+SEL     *sels[8];
+
+    hsize = step->hsize;
+    vsize = step->vsize;
+    bs = 32 * ((L_MAX(hsize, vsize) / 2 + 31) / 32);
+    switch (step->op)
+    {
+    case L_MORPH_DILATE:
+    case L_MORPH_ERODE:
+        op1 = op2 = step->op;
+        break;
+    case L_MORPH_OPEN:
+        op1 = L_MORPH_ERODE;
+        op2 = L_MORPH_DILATE;
+        break;
+    case L_MORPH_CLOSE:
+        op1 = L_MORPH_DILATE;
+        op2 = L_MORPH_ERODE;
+        break;
+    default:
+        return pixd;
+    }
+
+        /* The linear brick and comb Sels, in the order of application */
+    nsels = 0;
+    if (hsize > 1) {
+        selectComposableSels(hsize, L_HORIZ, &sels[0], &sels[1]);
+        nsels = 2;
+    }
+    if (vsize > 1) {
+        selectComposableSels(vsize, L_VERT, &sels[nsels], &sels[nsels + 1]);
+        nsels += 2;
+    }
+    n = nsels;
+    for (i = 0; i < nsels; i++)
+        ops[i] = op1;
+    if (op1 != op2) {
+        for (i = 0; i < nsels; i++) {
+            sels[nsels + i] = sels[i];
+            ops[nsels + i] = op2;
+        }
+        n = 2 * nsels;
+    }
+
+    pixb = pixMorphAddBorder(pixs, sels[0], ops[0], bs, bs, bs, bs);
+    for (i = 1; i < n - 1; i++) {
+            /* Reset the border where the b.c. changes within the step */
+        if (i == nsels && op2 == L_MORPH_DILATE)
+            pixSetOrClearBorder(pixb, bs, bs, bs, bs, PIX_CLR);
+        else if (i == nsels && erodeop == PIX_SET)
+            pixSetOrClearBorder(pixb, bs, bs, bs, bs, PIX_SET);
+        if (ops[i] == L_MORPH_DILATE)
+            pixDilate(pixb, pixb, sels[i]);
+        else
+            pixErode(pixb, pixb, sels[i]);
+    }
+    pixd = pixMorphRemoveBorder(pixd, pixb, sels[n - 1], ops[n - 1],
+                                bs, bs, bs, bs);
+    pixDestroy(&pixb);
+    for (i = 0; i < nsels; i++)
+        selDestroy(&sels[i]);
+    return pixd;
+}
+
+
+/*!
+ *  pixMorphSeqApplyGray()
+ *
+ *      Input:  pixs (8 bpp)
+ *              mseq
+ *      Return: pixd, or null on error
+ */
+static PIX *
+pixMorphSeqApplyGray(PIX         *pixs,
+                     L_MORPHSEQ  *mseq)
+{
+l_int32       i, w, h;
+L_MORPHSTEP  *step;
+PIX          *pixc, *pixd;
+
+    PROCNAME("pixMorphSeqApplyGray");
+
+    pixc = pixs;
+    for (i = 0; i < mseq->n; i++) {
+        step = &mseq->step[i];
+        w = step->hsize;
+        h = step->vsize;
+        switch (step->op)
+        {
+        case L_MORPH_DILATE:
+            pixd = pixDilateGray(pixc, w, h);
+            break;
+        case L_MORPH_ERODE:
+            pixd = pixErodeGray(pixc, w, h);
+            break;
+        case L_MORPH_OPEN:
+            pixd = pixOpenGray(pixc, w, h);
+            break;
+        case L_MORPH_CLOSE:
+            pixd = pixCloseGray(pixc, w, h);
+            break;
+        case L_MSEQ_TOPHAT_WHITE:
+            pixd = pixTophat(pixc, w, h, L_TOPHAT_WHITE);
+            break;
+        case L_MSEQ_TOPHAT_BLACK:
+            pixd = pixTophat(pixc, w, h, L_TOPHAT_BLACK);
+            break;
+        default:
+            pixd = NULL;
+            break;
+        }
+        if (pixc != pixs) pixDestroy(&pixc);
+        if ((pixc = pixd) == NULL)
+            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
+
+    if (pixc == pixs)
+        return pixCopy(NULL, pixs);
+    return pixc;
+}
+
+
+/*!
+ *  grayMorphSequenceVerify()
+ *
+ *      Input:  sarray (of operation sequence)
+ *      Return: TRUE if valid; FALSE otherwise or on error
+ *
+ *  Notes:
+ *      (1) This verifies grayscale sequences; see pixGrayMorphSequence()
+ *          for the valid operations.
+ */
+static l_int32
+grayMorphSequenceVerify(SARRAY  *sa)
+{
+char    *rawop, *op;
+l_int32  nops, i, valid, w, h;
+
+    PROCNAME("grayMorphSequenceVerify");
+
+    if (!sa)
+        return ERROR_INT("sa not defined", procName, FALSE);
+
+    nops = sarrayGetCount(sa);
+    valid = TRUE;
+    for (i = 0; i < nops; i++) {
+        rawop = sarrayGetString(sa, i, 0);
+        op = stringRemoveChars(rawop, " \n\t");
+        switch (op[0])
+        {
+        case 'd':
+        case 'D':
+        case 'e':
+        case 'E':
+        case 'o':
+        case 'O':
+        case 'c':
+        case 'C':
+            if (sscanf(&op[1], "%d.%d", &w, &h) != 2) {
+                fprintf(stderr, "*** op: %s invalid\n", op);
+                valid = FALSE;
+                break;
+            }
+            if (w < 1 || (w & 1) == 0 || h < 1 || (h & 1) == 0 ) {
+                fprintf(stderr,
+                        "*** op: %s; w = %d, h = %d; must both be odd\n",
+                        op, w, h);
+                valid = FALSE;
+                break;
+            }
+            break;
+        case 't':
+        case 'T':
+            if (op[1] != 'w' && op[1] != 'W' &&
+                op[1] != 'b' && op[1] != 'B') {
+                fprintf(stderr,
+                        "*** op = %s; arg %c must be 'w' or 'b'\n", op, op[1]);
+                valid = FALSE;
+                break;
+            }
+            sscanf(&op[2], "%d.%d", &w, &h);
+            if (w < 1 || (w & 1) == 0 || h < 1 || (h & 1) == 0 ) {
+                fprintf(stderr,
+                        "*** op: %s; w = %d, h = %d; must both be odd\n",
+                        op, w, h);
+                valid = FALSE;
+                break;
+            }
+            break;
+        default:
+            fprintf(stderr, "*** nonexistent op = %s\n", op);
+            valid = FALSE;
+        }
+        FREE(op);
+    }
+    return valid;
+}
@@ -46,6 +46,8 @@
  *       struct FPix
  *       struct FPixa
  *       struct DPix
+ *       struct L_Integral
+ *       struct L_SauvolaStream
  *       struct PixComp
  *       struct PixaComp
  *
@@ -533,6 +535,51 @@ struct DPix
 typedef struct DPix DPIX;
 
 
+/*-------------------------------------------------------------------------*
+ *                 L_Integral: integral image (summed-area table)          *
+ *-------------------------------------------------------------------------*/
+    /* The sum arrays have (h + 1) lines of (w + 1) entries.  The entry
+     * at (x, y) is the sum over all src pixels with coordinates less
+     * than x and y, so the first line and first column are 0.  The sum
+     * over any rectangle is then found from 4 entries, without special
+     * cases at the image boundary. */
+struct L_Integral
+{
+    l_int32              w;           /* width of src image, in pixels     */
+    l_int32              h;           /* height of src image, in pixels    */
+    l_int32              d;           /* depth of src image                */
+    l_int32              wpl;         /* 64-bit entries/line in the arrays */
+    l_uint32             refcount;    /* reference count (1 if no clones)  */
+    l_uint64            *sum;         /* sum of pixel values               */
+    l_uint64            *sumsq;       /* sum of squared pixel values;      */
+                                      /* null if not computed              */
+};
+typedef struct L_Integral L_INTEGRAL;
+
+
+/*-------------------------------------------------------------------------*
+ *           L_SauvolaStream: state for streaming binarization             *
+ *-------------------------------------------------------------------------*/
+    /* The src is read in bands of lines, and only the last
+     * (2 * whsize + 2) lines are held, along with the sums of the
+     * pixel values and their squares over the current window in each
+     * column.  The memory is therefore independent of the image height.
+     * The column sums have a mirrored border of whsize on each side. */
+struct L_SauvolaStream
+{
+    l_int32              w;           /* width of src image, in pixels     */
+    l_int32              whsize;      /* window half-width                 */
+    l_float32            factor;      /* reduces threshold due to stdev    */
+    l_int32              nin;         /* number of src lines read          */
+    l_int32              nout;        /* number of dest lines written      */
+    l_int32              nlines;      /* size of ring buffer of src lines  */
+    l_uint8             *lines;       /* ring buffer of src lines          */
+    l_uint32            *colsum;      /* column sums over window           */
+    l_uint32            *colsumsq;    /* column sums of squares            */
+};
+typedef struct L_SauvolaStream L_SAUVOLA_STREAM;
+
+
 /*-------------------------------------------------------------------------*
  *                        PixComp: compressed pix                          *
  *-------------------------------------------------------------------------*/
@@ -70,12 +70,37 @@
  *    Foreground/background estimation
  *           l_int32     pixThresholdForFgBg()
  *           l_int32     pixSplitDistributionFgBg()
+ *
+ *    Histogram accumulation
+ *           l_int32     pixGrayHistoAccumulate()
+ *           l_int32     pixColorHistoAccumulate()
+ *           l_int32     pixRGBIndexHistoAccumulate()
+ *           static l_int32  histoGetSampleRange()
+ *           static l_int32  histoGetStats()
+ *           static NUMA    *histoMakeNuma()
+ *           static l_int32  histoAddCmapColors()
+ *
+ *    All the histograms of pixel values, and the averages computed
+ *    from them, are accumulated by the three functions in the last
+ *    section.  These clip the sampling region (full image, box or
+ *    mask) once for each raster line, and count into interleaved
+ *    integer sub-histograms that are summed at the end.
  */
 
 #include <string.h>
 #include <math.h>
 #include "allheaders.h"
 
+static l_int32 histoGetSampleRange(l_int32 start, l_int32 extent,
+                                   l_int32 limit, l_int32 factor,
+                                   l_int32 *pfirst, l_int32 *pend);
+static l_int32 histoGetStats(l_int32 *histo, l_int32 size, l_int32 type,
+                             l_float32 *pval);
+static NUMA *histoMakeNuma(l_int32 *histo, l_int32 size);
+static l_int32 histoAddCmapColors(l_int32 *histo, l_int32 size,
+                                  PIXCMAP *cmap, l_int32 *rhisto,
+                                  l_int32 *ghisto, l_int32 *bhisto);
+
 
 /*------------------------------------------------------------------*
  *                  Pixel histogram and averaging                   *
@@ -100,8 +125,8 @@ NUMA *
 pixGetGrayHistogram(PIX     *pixs,
                     l_int32  factor)
 {
-l_int32     i, j, w, h, d, wpl, val, size, count;
-l_uint32   *data, *line;
+l_int32     w, h, d, size, count;
+l_int32    *histo;
 l_float32  *array;
 NUMA       *na;
 PIX        *pixg;
@@ -123,12 +148,11 @@ PIX        *pixg;
 
     pixGetDimensions(pixg, &w, &h, &d);
     size = 1 << d;
-    if ((na = numaCreate(size)) == NULL)
-        return (NUMA *)ERROR_PTR("na not made", procName, NULL);
-    numaSetCount(na, size);  /* all initialized to 0.0 */
-    array = numaGetFArray(na, L_NOCOPY);
-
     if (d == 1) {  /* special case */
+        if ((na = numaCreate(size)) == NULL)
+            return (NUMA *)ERROR_PTR("na not made", procName, NULL);
+        numaSetCount(na, size);  /* all initialized to 0.0 */
+        array = numaGetFArray(na, L_NOCOPY);
         pixCountPixels(pixg, &count, NULL);
         array[0] = w * h - count;
         array[1] = count;
@@ -136,42 +160,13 @@ PIX        *pixg;
         return na;
     }
 
-    wpl = pixGetWpl(pixg);
-    data = pixGetData(pixg);
-    for (i = 0; i < h; i += factor) {
-        line = data + i * wpl;
-        switch (d)
-        {
-        case 2:
-            for (j = 0; j < w; j += factor) {
-                val = GET_DATA_DIBIT(line, j);
-                array[val] += 1.0;
-            }
-            break;
-        case 4:
-            for (j = 0; j < w; j += factor) {
-                val = GET_DATA_QBIT(line, j);
-                array[val] += 1.0;
-            }
-            break;
-        case 8:
-            for (j = 0; j < w; j += factor) {
-                val = GET_DATA_BYTE(line, j);
-                array[val] += 1.0;
-            }
-            break;
-        case 16:
-            for (j = 0; j < w; j += factor) {
-                val = GET_DATA_TWO_BYTES(line, j);
-                array[val] += 1.0;
-            }
-            break;
-        default:
-            numaDestroy(&na);
-            return (NUMA *)ERROR_PTR("illegal depth", procName, NULL);
-        }
+    if ((histo = (l_int32 *)CALLOC(size, sizeof(l_int32))) == NULL) {
+        pixDestroy(&pixg);
+        return (NUMA *)ERROR_PTR("histo not made", procName, NULL);
     }
-
+    pixGrayHistoAccumulate(pixg, NULL, 0, 0, NULL, factor, histo);
+    na = histoMakeNuma(histo, size);
+    FREE(histo);
     pixDestroy(&pixg);
     return na;
 }
@@ -194,7 +189,7 @@ PIX        *pixg;
  *          pixGetCmapHistogramMasked().
  *      (2) This always returns a 256-value histogram of pixel values.
  *      (3) Set the subsampling factor > 1 to reduce the amount of computation.
- *      (4) Clipping of pixm (if it exists) to pixs is done in the inner loop.
+ *      (4) Clipping of pixm (if it exists) to pixs is done per raster line.
  *      (5) Input x,y are ignored unless pixm exists.
  */
 NUMA *
@@ -204,11 +199,9 @@ pixGetGrayHistogramMasked(PIX        *pixs,
                           l_int32     y,
                           l_int32     factor)
 {
-l_int32     i, j, w, h, wm, hm, dm, wplg, wplm, val;
-l_uint32   *datag, *datam, *lineg, *linem;
-l_float32  *array;
-NUMA       *na;
-PIX        *pixg;
+l_int32   histo[256];
+NUMA     *na;
+PIX      *pixg;
 
     PROCNAME("pixGetGrayHistogramMasked");
 
@@ -220,41 +213,18 @@ PIX        *pixg;
     if (pixGetDepth(pixs) != 8 && !pixGetColormap(pixs))
         return (NUMA *)ERROR_PTR("pixs neither 8 bpp nor colormapped",
                                  procName, NULL);
-    pixGetDimensions(pixm, &wm, &hm, &dm);
-    if (dm != 1)
+    if (pixGetDepth(pixm) != 1)
         return (NUMA *)ERROR_PTR("pixm not 1 bpp", procName, NULL);
     if (factor < 1)
         return (NUMA *)ERROR_PTR("sampling factor < 1", procName, NULL);
 
-    if ((na = numaCreate(256)) == NULL)
-        return (NUMA *)ERROR_PTR("na not made", procName, NULL);
-    numaSetCount(na, 256);  /* all initialized to 0.0 */
-    array = numaGetFArray(na, L_NOCOPY);
-
     if (pixGetColormap(pixs))
         pixg = pixRemoveColormap(pixs, REMOVE_CMAP_TO_GRAYSCALE);
     else
         pixg = pixClone(pixs);
-    pixGetDimensions(pixg, &w, &h, NULL);
-    datag = pixGetData(pixg);
-    wplg = pixGetWpl(pixg);
-    datam = pixGetData(pixm);
-    wplm = pixGetWpl(pixm);
-
-        /* Generate the histogram */
-    for (i = 0; i < hm; i += factor) {
-        if (y + i < 0 || y + i >= h) continue;
-        lineg = datag + (y + i) * wplg;
-        linem = datam + i * wplm;
-        for (j = 0; j < wm; j += factor) {
-            if (x + j < 0 || x + j >= w) continue;
-            if (GET_DATA_BIT(linem, j)) {
-                val = GET_DATA_BYTE(lineg, x + j);
-                array[val] += 1.0;
-            }
-        }
-    }
-
+    memset(histo, 0, sizeof(histo));
+    pixGrayHistoAccumulate(pixg, pixm, x, y, NULL, factor, histo);
+    na = histoMakeNuma(histo, 256);
     pixDestroy(&pixg);
     return na;
 }
@@ -281,11 +251,9 @@ pixGetGrayHistogramInRect(PIX     *pixs,
                           BOX     *box,
                           l_int32  factor)
 {
-l_int32     i, j, bx, by, bw, bh, w, h, wplg, val;
-l_uint32   *datag, *lineg;
-l_float32  *array;
-NUMA       *na;
-PIX        *pixg;
+l_int32   histo[256];
+NUMA     *na;
+PIX      *pixg;
 
     PROCNAME("pixGetGrayHistogramInRect");
 
@@ -300,31 +268,13 @@ PIX        *pixg;
     if (factor < 1)
         return (NUMA *)ERROR_PTR("sampling factor < 1", procName, NULL);
 
-    if ((na = numaCreate(256)) == NULL)
-        return (NUMA *)ERROR_PTR("na not made", procName, NULL);
-    numaSetCount(na, 256);  /* all initialized to 0.0 */
-    array = numaGetFArray(na, L_NOCOPY);
-
     if (pixGetColormap(pixs))
         pixg = pixRemoveColormap(pixs, REMOVE_CMAP_TO_GRAYSCALE);
     else
         pixg = pixClone(pixs);
-    pixGetDimensions(pixg, &w, &h, NULL);
-    datag = pixGetData(pixg);
-    wplg = pixGetWpl(pixg);
-    boxGetGeometry(box, &bx, &by, &bw, &bh);
-
-        /* Generate the histogram */
-    for (i = 0; i < bh; i += factor) {
-        if (by + i < 0 || by + i >= h) continue;
-        lineg = datag + (by + i) * wplg;
-        for (j = 0; j < bw; j += factor) {
-            if (bx + j < 0 || bx + j >= w) continue;
-            val = GET_DATA_BYTE(lineg, bx + j);
-            array[val] += 1.0;
-        }
-    }
-
+    memset(histo, 0, sizeof(histo));
+    pixGrayHistoAccumulate(pixg, NULL, 0, 0, box, factor, histo);
+    na = histoMakeNuma(histo, 256);
     pixDestroy(&pixg);
     return na;
 }
@@ -352,11 +302,9 @@ pixGetColorHistogram(PIX     *pixs,
                      NUMA   **pnag,
                      NUMA   **pnab)
 {
-l_int32     i, j, w, h, d, wpl, index, rval, gval, bval;
-l_uint32   *data, *line;
-l_float32  *rarray, *garray, *barray;
-NUMA       *nar, *nag, *nab;
-PIXCMAP    *cmap;
+l_int32   w, h, d;
+l_int32   ihisto[256], rhisto[256], ghisto[256], bhisto[256];
+PIXCMAP  *cmap;
 
     PROCNAME("pixGetColorHistogram");
 
@@ -374,52 +322,23 @@ PIXCMAP    *cmap;
     if (factor < 1)
         return ERROR_INT("sampling factor < 1", procName, 1);
 
-        /* Set up the histogram arrays */
-    nar = numaCreate(256);
-    nag = numaCreate(256);
-    nab = numaCreate(256);
-    numaSetCount(nar, 256);
-    numaSetCount(nag, 256);
-    numaSetCount(nab, 256);
-    rarray = numaGetFArray(nar, L_NOCOPY);
-    garray = numaGetFArray(nag, L_NOCOPY);
-    barray = numaGetFArray(nab, L_NOCOPY);
-    *pnar = nar;
-    *pnag = nag;
-    *pnab = nab;
-
         /* Generate the color histograms */
-    data = pixGetData(pixs);
-    wpl = pixGetWpl(pixs);
+    memset(rhisto, 0, sizeof(rhisto));
+    memset(ghisto, 0, sizeof(ghisto));
+    memset(bhisto, 0, sizeof(bhisto));
     if (cmap) {
-        for (i = 0; i < h; i += factor) {
-            line = data + i * wpl;
-            for (j = 0; j < w; j += factor) {
-                if (d == 8)
-                    index = GET_DATA_BYTE(line, j);
-                else if (d == 4)
-                    index = GET_DATA_QBIT(line, j);
-                else   /* 2 bpp */
-                    index = GET_DATA_DIBIT(line, j);
-                pixcmapGetColor(cmap, index, &rval, &gval, &bval);
-                rarray[rval] += 1.0;
-                garray[gval] += 1.0;
-                barray[bval] += 1.0;
-            }
-        }
+        memset(ihisto, 0, sizeof(ihisto));
+        pixGrayHistoAccumulate(pixs, NULL, 0, 0, NULL, factor, ihisto);
+        histoAddCmapColors(ihisto, 1 << d, cmap, rhisto, ghisto, bhisto);
     }
     else {  /* 32 bpp rgb */
-        for (i = 0; i < h; i += factor) {
-            line = data + i * wpl;
-            for (j = 0; j < w; j += factor) {
-                extractRGBValues(line[j], &rval, &gval, &bval);
-                rarray[rval] += 1.0;
-                garray[gval] += 1.0;
-                barray[bval] += 1.0;
-            }
-        }
+        pixColorHistoAccumulate(pixs, NULL, 0, 0, factor,
+                                rhisto, ghisto, bhisto);
     }
 
+    *pnar = histoMakeNuma(rhisto, 256);
+    *pnag = histoMakeNuma(ghisto, 256);
+    *pnab = histoMakeNuma(bhisto, 256);
     return 0;
 }
 
@@ -441,7 +360,7 @@ PIXCMAP    *cmap;
  *  Notes:
  *      (1) This generates a set of three 256 entry histograms,
  *      (2) Set the subsampling @factor > 1 to reduce the amount of computation.
- *      (3) Clipping of pixm (if it exists) to pixs is done in the inner loop.
+ *      (3) Clipping of pixm (if it exists) to pixs is done per raster line.
  *      (4) Input x,y are ignored unless pixm exists.
  */
 l_int32
@@ -454,11 +373,9 @@ pixGetColorHistogramMasked(PIX        *pixs,
                            NUMA      **pnag,
                            NUMA      **pnab)
 {
-l_int32     i, j, w, h, d, wm, hm, dm, wpls, wplm, index, rval, gval, bval;
-l_uint32   *datas, *datam, *lines, *linem;
-l_float32  *rarray, *garray, *barray;
-NUMA       *nar, *nag, *nab;
-PIXCMAP    *cmap;
+l_int32   w, h, d;
+l_int32   ihisto[256], rhisto[256], ghisto[256], bhisto[256];
+PIXCMAP  *cmap;
 
     PROCNAME("pixGetColorHistogramMasked");
 
@@ -476,70 +393,28 @@ PIXCMAP    *cmap;
         return ERROR_INT("colormap and not 2, 4, or 8 bpp", procName, 1);
     if (!cmap && d != 32)
         return ERROR_INT("no colormap and not rgb", procName, 1);
-    pixGetDimensions(pixm, &wm, &hm, &dm);
-    if (dm != 1)
+    if (pixGetDepth(pixm) != 1)
         return ERROR_INT("pixm not 1 bpp", procName, 1);
     if (factor < 1)
         return ERROR_INT("sampling factor < 1", procName, 1);
 
-        /* Set up the histogram arrays */
-    nar = numaCreate(256);
-    nag = numaCreate(256);
-    nab = numaCreate(256);
-    numaSetCount(nar, 256);
-    numaSetCount(nag, 256);
-    numaSetCount(nab, 256);
-    rarray = numaGetFArray(nar, L_NOCOPY);
-    garray = numaGetFArray(nag, L_NOCOPY);
-    barray = numaGetFArray(nab, L_NOCOPY);
-    *pnar = nar;
-    *pnag = nag;
-    *pnab = nab;
-
         /* Generate the color histograms */
-    datas = pixGetData(pixs);
-    wpls = pixGetWpl(pixs);
-    datam = pixGetData(pixm);
-    wplm = pixGetWpl(pixm);
+    memset(rhisto, 0, sizeof(rhisto));
+    memset(ghisto, 0, sizeof(ghisto));
+    memset(bhisto, 0, sizeof(bhisto));
     if (cmap) {
-        for (i = 0; i < hm; i += factor) {
-            if (y + i < 0 || y + i >= h) continue;
-            lines = datas + (y + i) * wpls;
-            linem = datam + i * wplm;
-            for (j = 0; j < wm; j += factor) {
-                if (x + j < 0 || x + j >= w) continue;
-                if (GET_DATA_BIT(linem, j)) {
-                    if (d == 8)
-                        index = GET_DATA_BYTE(lines, x + j);
-                    else if (d == 4)
-                        index = GET_DATA_QBIT(lines, x + j);
-                    else   /* 2 bpp */
-                        index = GET_DATA_DIBIT(lines, x + j);
-                    pixcmapGetColor(cmap, index, &rval, &gval, &bval);
-                    rarray[rval] += 1.0;
-                    garray[gval] += 1.0;
-                    barray[bval] += 1.0;
-                }
-            }
-        }
+        memset(ihisto, 0, sizeof(ihisto));
+        pixGrayHistoAccumulate(pixs, pixm, x, y, NULL, factor, ihisto);
+        histoAddCmapColors(ihisto, 1 << d, cmap, rhisto, ghisto, bhisto);
     }
     else {  /* 32 bpp rgb */
-        for (i = 0; i < hm; i += factor) {
-            if (y + i < 0 || y + i >= h) continue;
-            lines = datas + (y + i) * wpls;
-            linem = datam + i * wplm;
-            for (j = 0; j < wm; j += factor) {
-                if (x + j < 0 || x + j >= w) continue;
-                if (GET_DATA_BIT(linem, j)) {
-                    extractRGBValues(lines[x + j], &rval, &gval, &bval);
-                    rarray[rval] += 1.0;
-                    garray[gval] += 1.0;
-                    barray[bval] += 1.0;
-                }
-            }
-        }
+        pixColorHistoAccumulate(pixs, pixm, x, y, factor,
+                                rhisto, ghisto, bhisto);
     }
 
+    *pnar = histoMakeNuma(rhisto, 256);
+    *pnag = histoMakeNuma(ghisto, 256);
+    *pnab = histoMakeNuma(bhisto, 256);
     return 0;
 }
 
@@ -560,10 +435,8 @@ NUMA *
 pixGetCmapHistogram(PIX     *pixs,
                     l_int32  factor)
 {
-l_int32     i, j, w, h, d, wpl, val, size;
-l_uint32   *data, *line;
-l_float32  *array;
-NUMA       *na;
+l_int32  d, size;
+l_int32  histo[256];
 
     PROCNAME("pixGetCmapHistogram");
 
@@ -573,32 +446,14 @@ NUMA       *na;
         return (NUMA *)ERROR_PTR("pixs not cmapped", procName, NULL);
     if (factor < 1)
         return (NUMA *)ERROR_PTR("sampling factor < 1", procName, NULL);
-    pixGetDimensions(pixs, &w, &h, &d);
+    d = pixGetDepth(pixs);
     if (d != 2 && d != 4 && d != 8)
         return (NUMA *)ERROR_PTR("d not 2, 4 or 8", procName, NULL);
 
     size = 1 << d;
-    if ((na = numaCreate(size)) == NULL)
-        return (NUMA *)ERROR_PTR("na not made", procName, NULL);
-    numaSetCount(na, size);  /* all initialized to 0.0 */
-    array = numaGetFArray(na, L_NOCOPY);
-
-    wpl = pixGetWpl(pixs);
-    data = pixGetData(pixs);
-    for (i = 0; i < h; i += factor) {
-        line = data + i * wpl;
-        for (j = 0; j < w; j += factor) {
-            if (d == 8)
-                val = GET_DATA_BYTE(line, j);
-            else if (d == 4)
-                val = GET_DATA_QBIT(line, j);
-            else  /* d == 2 */
-                val = GET_DATA_DIBIT(line, j);
-            array[val] += 1.0;
-        }
-    }
-
-    return na;
+    memset(histo, 0, sizeof(histo));
+    pixGrayHistoAccumulate(pixs, NULL, 0, 0, NULL, factor, histo);
+    return histoMakeNuma(histo, size);
 }
 
 
@@ -617,7 +472,7 @@ NUMA       *na;
  *      (1) This generates a histogram of colormap pixel indices,
  *          and is of size 2^d.
  *      (2) Set the subsampling @factor > 1 to reduce the amount of computation.
- *      (3) Clipping of pixm to pixs is done in the inner loop.
+ *      (3) Clipping of pixm to pixs is done per raster line.
  */
 NUMA *
 pixGetCmapHistogramMasked(PIX     *pixs,
@@ -626,10 +481,8 @@ pixGetCmapHistogramMasked(PIX     *pixs,
                           l_int32  y,
                           l_int32  factor)
 {
-l_int32     i, j, w, h, d, wm, hm, dm, wpls, wplm, val, size;
-l_uint32   *datas, *datam, *lines, *linem;
-l_float32  *array;
-NUMA       *na;
+l_int32  d, size;
+l_int32  histo[256];
 
     PROCNAME("pixGetCmapHistogramMasked");
 
@@ -640,45 +493,18 @@ NUMA       *na;
         return (NUMA *)ERROR_PTR("pixs not defined", procName, NULL);
     if (pixGetColormap(pixs) == NULL)
         return (NUMA *)ERROR_PTR("pixs not cmapped", procName, NULL);
-    pixGetDimensions(pixm, &wm, &hm, &dm);
-    if (dm != 1)
+    if (pixGetDepth(pixm) != 1)
         return (NUMA *)ERROR_PTR("pixm not 1 bpp", procName, NULL);
     if (factor < 1)
         return (NUMA *)ERROR_PTR("sampling factor < 1", procName, NULL);
-    pixGetDimensions(pixs, &w, &h, &d);
+    d = pixGetDepth(pixs);
     if (d != 2 && d != 4 && d != 8)
         return (NUMA *)ERROR_PTR("d not 2, 4 or 8", procName, NULL);
 
     size = 1 << d;
-    if ((na = numaCreate(size)) == NULL)
-        return (NUMA *)ERROR_PTR("na not made", procName, NULL);
-    numaSetCount(na, size);  /* all initialized to 0.0 */
-    array = numaGetFArray(na, L_NOCOPY);
-
-    datas = pixGetData(pixs);
-    wpls = pixGetWpl(pixs);
-    datam = pixGetData(pixm);
-    wplm = pixGetWpl(pixm);
-
-    for (i = 0; i < hm; i += factor) {
-        if (y + i < 0 || y + i >= h) continue;
-        lines = datas + (y + i) * wpls;
-        linem = datam + i * wplm;
-        for (j = 0; j < wm; j += factor) {
-            if (x + j < 0 || x + j >= w) continue;
-            if (GET_DATA_BIT(linem, j)) {
-                if (d == 8)
-                    val = GET_DATA_BYTE(lines, x + j);
-                else if (d == 4)
-                    val = GET_DATA_QBIT(lines, x + j);
-                else  /* d == 2 */
-                    val = GET_DATA_DIBIT(lines, x + j);
-                array[val] += 1.0;
-            }
-        }
-    }
-
-    return na;
+    memset(histo, 0, sizeof(histo));
+    pixGrayHistoAccumulate(pixs, pixm, x, y, NULL, factor, histo);
+    return histoMakeNuma(histo, size);
 }
 
 
@@ -695,17 +521,15 @@ NUMA       *na;
  *      (1) This generates a histogram of colormap pixel indices,
  *          and is of size 2^d.
  *      (2) Set the subsampling @factor > 1 to reduce the amount of computation.
- *      (3) Clipping to the box is done in the inner loop.
+ *      (3) Clipping to the box is done per raster line.
  */
 NUMA *
 pixGetCmapHistogramInRect(PIX     *pixs,
                           BOX     *box,
                           l_int32  factor)
 {
-l_int32     i, j, bx, by, bw, bh, w, h, d, wpls, val, size;
-l_uint32   *datas, *lines;
-l_float32  *array;
-NUMA       *na;
+l_int32  d, size;
+l_int32  histo[256];
 
     PROCNAME("pixGetCmapHistogramInRect");
 
@@ -718,36 +542,14 @@ NUMA       *na;
         return (NUMA *)ERROR_PTR("pixs not cmapped", procName, NULL);
     if (factor < 1)
         return (NUMA *)ERROR_PTR("sampling factor < 1", procName, NULL);
-    pixGetDimensions(pixs, &w, &h, &d);
+    d = pixGetDepth(pixs);
     if (d != 2 && d != 4 && d != 8)
         return (NUMA *)ERROR_PTR("d not 2, 4 or 8", procName, NULL);
 
     size = 1 << d;
-    if ((na = numaCreate(size)) == NULL)
-        return (NUMA *)ERROR_PTR("na not made", procName, NULL);
-    numaSetCount(na, size);  /* all initialized to 0.0 */
-    array = numaGetFArray(na, L_NOCOPY);
-
-    datas = pixGetData(pixs);
-    wpls = pixGetWpl(pixs);
-    boxGetGeometry(box, &bx, &by, &bw, &bh);
-
-    for (i = 0; i < bh; i += factor) {
-        if (by + i < 0 || by + i >= h) continue;
-        lines = datas + (by + i) * wpls;
-        for (j = 0; j < bw; j += factor) {
-            if (bx + j < 0 || bx + j >= w) continue;
-            if (d == 8)
-                val = GET_DATA_BYTE(lines, bx + j);
-            else if (d == 4)
-                val = GET_DATA_QBIT(lines, bx + j);
-            else  /* d == 2 */
-                val = GET_DATA_DIBIT(lines, bx + j);
-            array[val] += 1.0;
-        }
-    }
-
-    return na;
+    memset(histo, 0, sizeof(histo));
+    pixGrayHistoAccumulate(pixs, NULL, 0, 0, box, factor, histo);
+    return histoMakeNuma(histo, size);
 }
 
 
@@ -912,7 +714,7 @@ PIX       *pixmt, *pixt;
  *          computes the average of the pixels in pixs.
  *      (2) Set the subsampling @factor > 1 to reduce the amount of
  *          computation.
- *      (3) Clipping of pixm (if it exists) to pixs is done in the inner loop.
+ *      (3) Clipping of pixm (if it exists) to pixs is done per raster line.
  *      (4) Input x,y are ignored unless pixm exists.
  *      (5) The rank must be in [0.0 ... 1.0], where the brightest pixel
  *          has rank 1.0.  For the median pixel value, use 0.5.
@@ -1039,8 +841,9 @@ PIXCMAP   *cmap;
  *
  *  Notes:
  *      (1) For usage, see pixGetAverageMasked().
- *      (2) If there is a colormap, it is removed before the 8 bpp
- *          component images are extracted.
+ *      (2) The three component histograms are accumulated in one pass.
+ *          If there is a colormap, they are found from the histogram
+ *          of colormap indices.
  */
 l_int32
 pixGetAverageMaskedRGB(PIX        *pixs,
@@ -1053,15 +856,13 @@ pixGetAverageMaskedRGB(PIX        *pixs,
                        l_float32  *pgval,
                        l_float32  *pbval)
 {
-l_int32   color;
-PIX      *pixt;
+l_int32   ihisto[256], rhisto[256], ghisto[256], bhisto[256];
 PIXCMAP  *cmap;
 
     PROCNAME("pixGetAverageMaskedRGB");
 
     if (!pixs)
         return ERROR_INT("pixs not defined", procName, 1);
-    color = 0;
     cmap = pixGetColormap(pixs);
     if (pixGetDepth(pixs) != 32 && !cmap)
         return ERROR_INT("pixs neither 32 bpp nor colormapped", procName, 1);
@@ -1075,31 +876,28 @@ PIXCMAP  *cmap;
     if (!prval && !pgval && !pbval)
         return ERROR_INT("no values requested", procName, 1);
 
-    if (prval) {
-        if (cmap)
-            pixt = pixGetRGBComponentCmap(pixs, COLOR_RED);
-        else
-            pixt = pixGetRGBComponent(pixs, COLOR_RED);
-        pixGetAverageMasked(pixt, pixm, x, y, factor, type, prval);
-        pixDestroy(&pixt);
-    }
-    if (pgval) {
-        if (cmap)
-            pixt = pixGetRGBComponentCmap(pixs, COLOR_GREEN);
-        else
-            pixt = pixGetRGBComponent(pixs, COLOR_GREEN);
-        pixGetAverageMasked(pixt, pixm, x, y, factor, type, pgval);
-        pixDestroy(&pixt);
+        /* Accumulate the three component histograms together */
+    memset(rhisto, 0, sizeof(rhisto));
+    memset(ghisto, 0, sizeof(ghisto));
+    memset(bhisto, 0, sizeof(bhisto));
+    if (cmap) {
+        memset(ihisto, 0, sizeof(ihisto));
+        if (pixGrayHistoAccumulate(pixs, pixm, x, y, NULL, factor, ihisto))
+            return ERROR_INT("histo not made", procName, 1);
+        histoAddCmapColors(ihisto, 1 << pixGetDepth(pixs), cmap,
+                           rhisto, ghisto, bhisto);
     }
-    if (pbval) {
-        if (cmap)
-            pixt = pixGetRGBComponentCmap(pixs, COLOR_BLUE);
-        else
-            pixt = pixGetRGBComponent(pixs, COLOR_BLUE);
-        pixGetAverageMasked(pixt, pixm, x, y, factor, type, pbval);
-        pixDestroy(&pixt);
+    else {
+        if (pixColorHistoAccumulate(pixs, pixm, x, y, factor,
+                                    rhisto, ghisto, bhisto))
+            return ERROR_INT("histos not made", procName, 1);
     }
 
+    if ((prval && histoGetStats(rhisto, 256, type, prval)) ||
+        (pgval && histoGetStats(ghisto, 256, type, pgval)) ||
+        (pbval && histoGetStats(bhisto, 256, type, pbval)))
+        return ERROR_INT("no pixels sampled", procName, 1);
+
     return 0;
 }
 
@@ -1131,7 +929,7 @@ PIXCMAP  *cmap;
  *              sqrt(<(<x> - x)>^2) = sqrt(<x^2> - <x>^2)
  *      (3) Set the subsampling @factor > 1 to reduce the amount of
  *          computation.
- *      (4) Clipping of pixm (if it exists) to pixs is done in the inner loop.
+ *      (4) Clipping of pixm (if it exists) to pixs is done per raster line.
  *      (5) Input x,y are ignored unless pixm exists.
  */
 l_int32
@@ -1143,10 +941,9 @@ pixGetAverageMasked(PIX        *pixs,
                     l_int32     type,
                     l_float32  *pval)
 {
-l_int32    i, j, w, h, d, wm, hm, wplg, wplm, val, count;
-l_uint32  *datag, *datam, *lineg, *linem;
-l_float64  sumave, summs, ave, meansq, var;
-PIX       *pixg;
+l_int32   d, size, ret;
+l_int32  *histo;
+PIX      *pixg;
 
     PROCNAME("pixGetAverageMasked");
 
@@ -1170,67 +967,18 @@ PIX       *pixg;
         pixg = pixRemoveColormap(pixs, REMOVE_CMAP_TO_GRAYSCALE);
     else
         pixg = pixClone(pixs);
-    pixGetDimensions(pixg, &w, &h, &d);
-    datag = pixGetData(pixg);
-    wplg = pixGetWpl(pixg);
-
-    sumave = summs = 0.0;
-    count = 0;
-    if (!pixm) {
-        for (i = 0; i < h; i += factor) {
-            lineg = datag + i * wplg;
-            for (j = 0; j < w; j += factor) {
-                if (d == 8)
-                    val = GET_DATA_BYTE(lineg, j);
-                else  /* d == 16 */
-                    val = GET_DATA_TWO_BYTES(lineg, j);
-                if (type != L_ROOT_MEAN_SQUARE)
-                    sumave += val;
-                if (type != L_MEAN_ABSVAL)
-                    summs += val * val;
-                count++;
-            }
-        }
-    }
-    else {
-        pixGetDimensions(pixm, &wm, &hm, NULL);
-        datam = pixGetData(pixm);
-        wplm = pixGetWpl(pixm);
-        for (i = 0; i < hm; i += factor) {
-            if (y + i < 0 || y + i >= h) continue;
-            lineg = datag + (y + i) * wplg;
-            linem = datam + i * wplm;
-            for (j = 0; j < wm; j += factor) {
-                if (x + j < 0 || x + j >= w) continue;
-                if (GET_DATA_BIT(linem, j)) {
-                    if (d == 8)
-                        val = GET_DATA_BYTE(lineg, x + j);
-                    else  /* d == 16 */
-                        val = GET_DATA_TWO_BYTES(lineg, x + j);
-                    if (type != L_ROOT_MEAN_SQUARE)
-                        sumave += val;
-                    if (type != L_MEAN_ABSVAL)
-                        summs += val * val;
-                    count++;
-                }
-            }
-        }
+    d = pixGetDepth(pixg);
+    size = 1 << d;
+    if ((histo = (l_int32 *)CALLOC(size, sizeof(l_int32))) == NULL) {
+        pixDestroy(&pixg);
+        return ERROR_INT("histo not made", procName, 1);
     }
-
+    pixGrayHistoAccumulate(pixg, pixm, x, y, NULL, factor, histo);
     pixDestroy(&pixg);
-    if (count == 0)
+    ret = histoGetStats(histo, size, type, pval);
+    FREE(histo);
+    if (ret)
         return ERROR_INT("no pixels sampled", procName, 1);
-    ave = sumave / (l_float64)count;
-    meansq = summs / (l_float64)count;
-    var = meansq - ave * ave;
-    if (type == L_MEAN_ABSVAL)
-        *pval = (l_float32)ave;
-    else if (type == L_ROOT_MEAN_SQUARE)
-        *pval = (l_float32)sqrt(meansq);
-    else if (type == L_STANDARD_DEVIATION)
-        *pval = (l_float32)sqrt(var);
-    else  /* type == L_VARIANCE */
-        *pval = (l_float32)var;
 
     return 0;
 }
@@ -2920,3 +2668,472 @@ PIX       *pixg;
     numaDestroy(&na);
     return 0;
 }
+
+
+/*------------------------------------------------------------------*
+ *                     Histogram accumulation                       *
+ *------------------------------------------------------------------*/
+/*!
+ *  pixGrayHistoAccumulate()
+ *
+ *      Input:  pixs (2, 4, 8 or 16 bpp; a colormap is ignored)
+ *              pixm (<optional> 1 bpp mask over which the histogram is
+ *                    to be computed; use all pixels if null)
+ *              x, y (UL corner of pixm relative to the UL corner of pixs;
+ *                    can be < 0; these values are ignored if pixm is null)
+ *              box (<optional> region of pixs; ignored if pixm exists)
+ *              factor (subsampling factor; integer >= 1)
+ *              histo (array of size 2^d, to which the counts are added)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This is the core for the histograms of pixel values and of
+ *          colormap indices.  The raw pixel values are counted; if pixs
+ *          has a colormap, these are the colormap indices.
+ *      (2) The sampled pixels are at (j, i) in pixm (or in the box),
+ *          where j and i are multiples of @factor, and any sample that
+ *          falls outside pixs is ignored.  Clipping is done once for
+ *          each raster line, not in the inner loop.
+ *      (3) The counts are added to @histo, which must be initialized
+ *          by the caller.  Because a histogram is additive, a large
+ *          image can be split into bands (using @box), with each band
+ *          accumulated into its own array, and the arrays summed.
+ *      (4) For d <= 8, successive samples on each line are counted in
+ *          four separate sub-histograms that are summed at the end.
+ *          This breaks the chain of dependent increments on the same
+ *          bin when neighboring pixels have the same value.
+ */
+l_int32
+pixGrayHistoAccumulate(PIX      *pixs,
+                       PIX      *pixm,
+                       l_int32   x,
+                       l_int32   y,
+                       BOX      *box,
+                       l_int32   factor,
+                       l_int32  *histo)
+{
+l_int32    i, j, k, w, h, d, x0, y0, rw, rh, wpls, wplm;
+l_int32    ifirst, iend, jfirst, jend, step, val, size;
+l_int32   *subh, *h0, *h1, *h2, *h3;
+l_uint32  *datas, *datam, *lines, *linem;
+
+    PROCNAME("pixGrayHistoAccumulate");
+
+    if (!pixs)
+        return ERROR_INT("pixs not defined", procName, 1);
+    pixGetDimensions(pixs, &w, &h, &d);
+    if (d != 2 && d != 4 && d != 8 && d != 16)
+        return ERROR_INT("pixs not 2, 4, 8 or 16 bpp", procName, 1);
+    if (pixm && pixGetDepth(pixm) != 1)
+        return ERROR_INT("pixm not 1 bpp", procName, 1);
+    if (factor < 1)
+        return ERROR_INT("sampling factor < 1", procName, 1);
+    if (!histo)
+        return ERROR_INT("histo not defined", procName, 1);
+
+    datam = NULL;
+    wplm = 0;
+    if (pixm) {
+        x0 = x;
+        y0 = y;
+        pixGetDimensions(pixm, &rw, &rh, NULL);
+        datam = pixGetData(pixm);
+        wplm = pixGetWpl(pixm);
+    }
+    else if (box) {
+        boxGetGeometry(box, &x0, &y0, &rw, &rh);
+    }
+    else {
+        x0 = y0 = 0;
+        rw = w;
+        rh = h;
+    }
+    histoGetSampleRange(y0, rh, h, factor, &ifirst, &iend);
+    histoGetSampleRange(x0, rw, w, factor, &jfirst, &jend);
+    if (ifirst >= iend || jfirst >= jend)
+        return 0;
+
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
+    if (d == 16) {  /* too large for sub-histograms */
+        for (i = ifirst; i < iend; i += factor) {
+            lines = datas + (y0 + i) * wpls;
+            linem = (datam) ? datam + i * wplm : NULL;
+            for (j = jfirst; j < jend; j += factor) {
+                if (linem && !GET_DATA_BIT(linem, j))
+                    continue;
+                histo[GET_DATA_TWO_BYTES(lines, x0 + j)]++;
+            }
+        }
+        return 0;
+    }
+
+    size = 1 << d;
+    if ((subh = (l_int32 *)CALLOC(4 * size, sizeof(l_int32))) == NULL)
+        return ERROR_INT("subh not made", procName, 1);
+    h0 = subh;
+    h1 = h0 + size;
+    h2 = h1 + size;
+    h3 = h2 + size;
+    step = 4 * factor;
+    for (i = ifirst; i < iend; i += factor) {
+        lines = datas + (y0 + i) * wpls;
+        if (d == 8 && !datam) {
+            for (j = jfirst; j + 3 * factor < jend; j += step) {
+                h0[GET_DATA_BYTE(lines, x0 + j)]++;
+                h1[GET_DATA_BYTE(lines, x0 + j + factor)]++;
+                h2[GET_DATA_BYTE(lines, x0 + j + 2 * factor)]++;
+                h3[GET_DATA_BYTE(lines, x0 + j + 3 * factor)]++;
+            }
+            for (; j < jend; j += factor)
+                h0[GET_DATA_BYTE(lines, x0 + j)]++;
+        }
+        else if (d == 8) {  /* mask bits are added, to avoid branching */
+            linem = datam + i * wplm;
+            for (j = jfirst; j + 3 * factor < jend; j += step) {
+                h0[GET_DATA_BYTE(lines, x0 + j)] += GET_DATA_BIT(linem, j);
+                h1[GET_DATA_BYTE(lines, x0 + j + factor)] +=
+                    GET_DATA_BIT(linem, j + factor);
+                h2[GET_DATA_BYTE(lines, x0 + j + 2 * factor)] +=
+                    GET_DATA_BIT(linem, j + 2 * factor);
+                h3[GET_DATA_BYTE(lines, x0 + j + 3 * factor)] +=
+                    GET_DATA_BIT(linem, j + 3 * factor);
+            }
+            for (; j < jend; j += factor)
+                h0[GET_DATA_BYTE(lines, x0 + j)] += GET_DATA_BIT(linem, j);
+        }
+        else {  /* d == 2 or 4 */
+            linem = (datam) ? datam + i * wplm : NULL;
+            for (j = jfirst, k = 0; j < jend; j += factor, k++) {
+                if (linem && !GET_DATA_BIT(linem, j))
+                    continue;
+                if (d == 4)
+                    val = GET_DATA_QBIT(lines, x0 + j);
+                else
+                    val = GET_DATA_DIBIT(lines, x0 + j);
+                subh[(k & 3) * size + val]++;
+            }
+        }
+    }
+
+    for (k = 0; k < size; k++)
+        histo[k] += h0[k] + h1[k] + h2[k] + h3[k];
+    FREE(subh);
+    return 0;
+}
+
+
+/*!
+ *  pixColorHistoAccumulate()
+ *
+ *      Input:  pixs (32 bpp rgb)
+ *              pixm (<optional> 1 bpp mask over which the histograms are
+ *                    to be computed; use all pixels if null)
+ *              x, y (UL corner of pixm relative to the UL corner of pixs;
+ *                    can be < 0; these values are ignored if pixm is null)
+ *              factor (subsampling factor; integer >= 1)
+ *              rhisto, ghisto, bhisto (arrays of size 256, to which the
+ *                                      component counts are added)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The sampling and clipping are as in pixGrayHistoAccumulate().
+ *      (2) Each component is counted in two interleaved sub-histograms.
+ */
+l_int32
+pixColorHistoAccumulate(PIX      *pixs,
+                        PIX      *pixm,
+                        l_int32   x,
+                        l_int32   y,
+                        l_int32   factor,
+                        l_int32  *rhisto,
+                        l_int32  *ghisto,
+                        l_int32  *bhisto)
+{
+l_int32    i, j, k, w, h, x0, y0, rw, rh, wpls, wplm, bit;
+l_int32    ifirst, iend, jfirst, jend;
+l_int32   *subh;
+l_uint32   pixel;
+l_uint32  *datas, *datam, *lines, *linem;
+
+    PROCNAME("pixColorHistoAccumulate");
+
+    if (!pixs || pixGetDepth(pixs) != 32)
+        return ERROR_INT("pixs not defined or not 32 bpp", procName, 1);
+    if (pixm && pixGetDepth(pixm) != 1)
+        return ERROR_INT("pixm not 1 bpp", procName, 1);
+    if (factor < 1)
+        return ERROR_INT("sampling factor < 1", procName, 1);
+    if (!rhisto || !ghisto || !bhisto)
+        return ERROR_INT("histos not all defined", procName, 1);
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    datam = NULL;
+    wplm = 0;
+    if (pixm) {
+        x0 = x;
+        y0 = y;
+        pixGetDimensions(pixm, &rw, &rh, NULL);
+        datam = pixGetData(pixm);
+        wplm = pixGetWpl(pixm);
+    }
+    else {
+        x0 = y0 = 0;
+        rw = w;
+        rh = h;
+    }
+    histoGetSampleRange(y0, rh, h, factor, &ifirst, &iend);
+    histoGetSampleRange(x0, rw, w, factor, &jfirst, &jend);
+    if (ifirst >= iend || jfirst >= jend)
+        return 0;
+
+        /* Sub-histograms for r, g, b are at offsets 0, 512 and 1024;
+         * the second one of each pair is 256 beyond the first. */
+    if ((subh = (l_int32 *)CALLOC(6 * 256, sizeof(l_int32))) == NULL)
+        return ERROR_INT("subh not made", procName, 1);
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
+    for (i = ifirst; i < iend; i += factor) {
+        lines = datas + (y0 + i) * wpls + x0;
+        linem = (datam) ? datam + i * wplm : NULL;
+        for (j = jfirst, k = 0; j < jend; j += factor, k ^= 256) {
+            bit = (linem) ? GET_DATA_BIT(linem, j) : 1;
+            pixel = lines[j];
+            subh[k + (pixel >> 24)] += bit;
+            subh[k + 512 + ((pixel >> 16) & 0xff)] += bit;
+            subh[k + 1024 + ((pixel >> 8) & 0xff)] += bit;
+        }
+    }
+
+    for (k = 0; k < 256; k++) {
+        rhisto[k] += subh[k] + subh[k + 256];
+        ghisto[k] += subh[k + 512] + subh[k + 768];
+        bhisto[k] += subh[k + 1024] + subh[k + 1280];
+    }
+    FREE(subh);
+    return 0;
+}
+
+
+/*!
+ *  pixRGBIndexHistoAccumulate()
+ *
+ *      Input:  pixs (32 bpp rgb)
+ *              factor (subsampling factor; integer >= 1)
+ *              rtab, gtab, btab (tables mapping each component to its
+ *                                bits in the index)
+ *              size (of histo; all indices must be less than this)
+ *              histo (array to which the counts are added)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This counts the pixels by color cell, where the index of
+ *          the cell is rtab[r] | gtab[g] | btab[b].  It is the
+ *          histogram core for the octcube and median cut quantizers.
+ *      (2) For histograms up to 2^15 cells, successive samples are
+ *          counted in two interleaved sub-histograms.  Larger
+ *          histograms are accumulated directly.
+ */
+l_int32
+pixRGBIndexHistoAccumulate(PIX       *pixs,
+                           l_int32    factor,
+                           l_uint32  *rtab,
+                           l_uint32  *gtab,
+                           l_uint32  *btab,
+                           l_int32    size,
+                           l_int32   *histo)
+{
+l_int32    i, j, w, h, wpl;
+l_int32   *h1;
+l_uint32   pixel;
+l_uint32  *data, *line;
+
+    PROCNAME("pixRGBIndexHistoAccumulate");
+
+    if (!pixs || pixGetDepth(pixs) != 32)
+        return ERROR_INT("pixs not defined or not 32 bpp", procName, 1);
+    if (factor < 1)
+        return ERROR_INT("sampling factor < 1", procName, 1);
+    if (!rtab || !gtab || !btab)
+        return ERROR_INT("tables not all defined", procName, 1);
+    if (!histo || size < 1)
+        return ERROR_INT("histo not defined or size < 1", procName, 1);
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    data = pixGetData(pixs);
+    wpl = pixGetWpl(pixs);
+    h1 = NULL;
+    if (size <= 32768)
+        h1 = (l_int32 *)CALLOC(size, sizeof(l_int32));
+    if (!h1) {
+        for (i = 0; i < h; i += factor) {
+            line = data + i * wpl;
+            for (j = 0; j < w; j += factor) {
+                pixel = line[j];
+                histo[rtab[pixel >> 24] | gtab[(pixel >> 16) & 0xff] |
+                      btab[(pixel >> 8) & 0xff]]++;
+            }
+        }
+        return 0;
+    }
+
+    for (i = 0; i < h; i += factor) {
+        line = data + i * wpl;
+        for (j = 0; j + factor < w; j += 2 * factor) {
+            pixel = line[j];
+            histo[rtab[pixel >> 24] | gtab[(pixel >> 16) & 0xff] |
+                  btab[(pixel >> 8) & 0xff]]++;
+            pixel = line[j + factor];
+            h1[rtab[pixel >> 24] | gtab[(pixel >> 16) & 0xff] |
+               btab[(pixel >> 8) & 0xff]]++;
+        }
+        if (j < w) {
+            pixel = line[j];
+            histo[rtab[pixel >> 24] | gtab[(pixel >> 16) & 0xff] |
+                  btab[(pixel >> 8) & 0xff]]++;
+        }
+    }
+    for (i = 0; i < size; i++)
+        histo[i] += h1[i];
+    FREE(h1);
+    return 0;
+}
+
+
+/*!
+ *  histoGetSampleRange()
+ *
+ *      Input:  start (location in pixs of sample 0; can be < 0)
+ *              extent (number of positions, before sampling)
+ *              limit (size of pixs in this direction)
+ *              factor (subsampling factor)
+ *              &first (<return> first sample offset, a multiple of factor)
+ *              &end (<return> one beyond the last usable offset)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This returns the offsets k, with k = 0 mod @factor and
+ *          first <= k < end, for which 0 <= start + k < limit.
+ *          If there are none, first >= end.
+ */
+static l_int32
+histoGetSampleRange(l_int32   start,
+                    l_int32   extent,
+                    l_int32   limit,
+                    l_int32   factor,
+                    l_int32  *pfirst,
+                    l_int32  *pend)
+{
+    *pfirst = 0;
+    if (start < 0)
+        *pfirst = factor * ((-start + factor - 1) / factor);
+    *pend = L_MIN(extent, limit - start);
+    return 0;
+}
+
+
+/*!
+ *  histoGetStats()
+ *
+ *      Input:  histo (counts of values 0 ... size - 1)
+ *              size (of histo)
+ *              type (L_MEAN_ABSVAL, L_ROOT_MEAN_SQUARE,
+ *                    L_STANDARD_DEVIATION, L_VARIANCE)
+ *              &val (<return> measured value of given 'type')
+ *      Return: 0 if OK, 1 if the histogram is empty
+ */
+static l_int32
+histoGetStats(l_int32    *histo,
+              l_int32     size,
+              l_int32     type,
+              l_float32  *pval)
+{
+l_int32    i;
+l_float64  count, sumave, summs, ave, meansq, var;
+
+    *pval = 0.0;
+    count = sumave = summs = 0.0;
+    for (i = 0; i < size; i++) {
+        if (histo[i] == 0) continue;
+        count += histo[i];
+        sumave += (l_float64)i * histo[i];
+        summs += (l_float64)i * i * histo[i];
+    }
+    if (count == 0.0)
+        return 1;
+    ave = sumave / count;
+    meansq = summs / count;
+    var = meansq - ave * ave;
+    if (type == L_MEAN_ABSVAL)
+        *pval = (l_float32)ave;
+    else if (type == L_ROOT_MEAN_SQUARE)
+        *pval = (l_float32)sqrt(meansq);
+    else if (type == L_STANDARD_DEVIATION)
+        *pval = (l_float32)sqrt(var);
+    else  /* type == L_VARIANCE */
+        *pval = (l_float32)var;
+    return 0;
+}
+
+
+/*!
+ *  histoMakeNuma()
+ *
+ *      Input:  histo (integer counts)
+ *              size (of histo)
+ *      Return: na (histogram), or null on error
+ */
+static NUMA *
+histoMakeNuma(l_int32  *histo,
+              l_int32   size)
+{
+l_int32     i;
+l_float32  *array;
+NUMA       *na;
+
+    PROCNAME("histoMakeNuma");
+
+    if ((na = numaCreate(size)) == NULL)
+        return (NUMA *)ERROR_PTR("na not made", procName, NULL);
+    numaSetCount(na, size);
+    array = numaGetFArray(na, L_NOCOPY);
+    for (i = 0; i < size; i++)
+        array[i] = (l_float32)histo[i];
+    return na;
+}
+
+
+/*!
+ *  histoAddCmapColors()
+ *
+ *      Input:  histo (counts of colormap indices)
+ *              size (of histo)
+ *              cmap
+ *              rhisto, ghisto, bhisto (arrays of size 256, to which the
+ *                                      component counts are added)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The component histograms of a colormapped image are found
+ *          from the histogram of its indices, so that each colormap
+ *          color is looked up once, not once for each pixel.
+ */
+static l_int32
+histoAddCmapColors(l_int32   *histo,
+                   l_int32    size,
+                   PIXCMAP   *cmap,
+                   l_int32   *rhisto,
+                   l_int32   *ghisto,
+                   l_int32   *bhisto)
+{
+l_int32  i, rval, gval, bval;
+
+    for (i = 0; i < size; i++) {
+        if (histo[i] == 0) continue;
+        pixcmapGetColor(cmap, i, &rval, &gval, &bval);
+        rhisto[rval] += histo[i];
+        ghisto[gval] += histo[i];
+        bhisto[bval] += histo[i];
+    }
+    return 0;
+}
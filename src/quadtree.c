@@ -30,10 +30,14 @@
  *      Top level quadtree linear statistics
  *          l_int32   pixQuadtreeMean()
  *          l_int32   pixQuadtreeVariance()
+ *          l_int32   pixQuadtreeMeanIntegral()
+ *          l_int32   pixQuadtreeVarianceIntegral()
  *
  *      Statistics in an arbitrary rectangle
  *          l_int32   pixMeanInRectangle()
  *          l_int32   pixVarianceInRectangle()
+ *          l_int32   pixMeanInRectangleIntegral()
+ *          l_int32   pixVarianceInRectangleIntegral()
  *
  *      Quadtree regions
  *          BOXAA    *boxaaQuadtreeRegions()
@@ -75,14 +79,17 @@
  *
  *      Input:  pixs (8 bpp, no colormap)
  *              nlevels (in quadtree; max allowed depends on image size)
- *             *pix_ma (input mean accumulator; can be null)
+ *             *pix_ma (<optional> input mean accumulator; can be null)
  *             *pfpixa (<return> mean values in quadtree)
  *      Return: 0 if OK, 1 on error
  *
  *  Notes:
- *      (1) The returned fpixa has @nlevels of fpix, each containing
- *          the mean values at its level.  Level 0 has a
- *          single value; level 1 has 4 values; level 2 has 16; etc.
+ *      (1) If pix_ma is null, this calls pixQuadtreeMeanIntegral()
+ *          with an integral image made from pixs, which gives exact
+ *          sums for any image size.
+ *      (2) Otherwise, pix_ma, made by pixBlockconvAccum() from pixs,
+ *          is used for the sums.  Its 32 bit sums overflow for
+ *          images with more than 2^24 pixels.
  */
 l_int32
 pixQuadtreeMean(PIX     *pixs,
@@ -100,6 +107,9 @@ PIX       *pix_mac;
 
     PROCNAME("pixQuadtreeMean");
 
+    if (!pix_ma)
+        return pixQuadtreeMeanIntegral(pixs, nlevels, NULL, pfpixa);
+
     if (!pfpixa)
         return ERROR_INT("&fpixa not defined", procName, 1);
     *pfpixa = NULL;
@@ -109,11 +119,7 @@ PIX       *pix_mac;
     if (nlevels > quadtreeMaxLevels(w, h))
         return ERROR_INT("nlevels too large for image", procName, 1);
 
-    if (!pix_ma)
-        pix_mac = pixBlockconvAccum(pixs);
-    else
-        pix_mac = pixClone(pix_ma);
-    if (!pix_mac)
+    if ((pix_mac = pixClone(pix_ma)) == NULL)
         return ERROR_INT("pix_mac not made", procName, 1);
 
     if ((baa = boxaaQuadtreeRegions(w, h, nlevels)) == NULL) {
@@ -148,16 +154,20 @@ PIX       *pix_mac;
  *
  *      Input:  pixs (8 bpp, no colormap)
  *              nlevels (in quadtree)
- *             *pix_ma (input mean accumulator; can be null)
- *             *dpix_msa (input mean square accumulator; can be null)
+ *             *pix_ma (<optional> input mean accumulator; can be null)
+ *             *dpix_msa (<optional> input mean square accumulator;
+ *                        can be null)
  *             *pfpixa_v (<optional return> variance values in quadtree)
  *             *pfpixa_rv (<optional return> root variance values in quadtree)
  *      Return: 0 if OK, 1 on error
  *
  *  Notes:
- *      (1) The returned fpixav and fpixarv have @nlevels of fpix,
- *          each containing at the respective levels the variance
- *          and root variance values.
+ *      (1) If pix_ma and dpix_msa are both null, this calls
+ *          pixQuadtreeVarianceIntegral() with an integral image made
+ *          from pixs, which gives exact sums for any image size.
+ *      (2) Otherwise, the accumulators are used for the sums, and the
+ *          one that is null is made here with pixBlockconvAccum() or
+ *          pixMeanSquareAccum().
  */
 l_int32
 pixQuadtreeVariance(PIX     *pixs,
@@ -178,6 +188,10 @@ DPIX      *dpix_msac;  /* msa clone */
 
     PROCNAME("pixQuadtreeVariance");
 
+    if (!pix_ma && !dpix_msa)
+        return pixQuadtreeVarianceIntegral(pixs, nlevels, NULL,
+                                           pfpixa_v, pfpixa_rv);
+
     if (!pfpixa_v && !pfpixa_rv)
         return ERROR_INT("neither &fpixav nor &fpixarv defined", procName, 1);
     if (pfpixa_v) *pfpixa_v = NULL;
@@ -198,8 +212,10 @@ DPIX      *dpix_msac;  /* msa clone */
         dpix_msac = pixMeanSquareAccum(pixs);
     else
         dpix_msac = dpixClone(dpix_msa);
-    if (!dpix_msac)
+    if (!dpix_msac) {
+        pixDestroy(&pix_mac);
         return ERROR_INT("dpix_msac not made", procName, 1);
+    }
 
     if ((baa = boxaaQuadtreeRegions(w, h, nlevels)) == NULL) {
         pixDestroy(&pix_mac);
@@ -234,6 +250,164 @@ DPIX      *dpix_msac;  /* msa clone */
 }
 
 
+/*!
+ *  pixQuadtreeMeanIntegral()
+ *
+ *      Input:  pixs (8 bpp, no colormap)
+ *              nlevels (in quadtree; max allowed depends on image size)
+ *             *intg (<optional> integral image of pixs; can be null)
+ *             *pfpixa (<return> mean values in quadtree)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The returned fpixa has @nlevels of fpix, each containing
+ *          the mean values at its level.  Level 0 has a
+ *          single value; level 1 has 4 values; level 2 has 16; etc.
+ *      (2) If @intg is null, it is made here and destroyed.
+ */
+l_int32
+pixQuadtreeMeanIntegral(PIX         *pixs,
+                        l_int32      nlevels,
+                        L_INTEGRAL  *intg,
+                        FPIXA      **pfpixa)
+{
+l_int32      i, j, w, h, size, n;
+l_float32    val;
+BOX         *box;
+BOXA        *boxa;
+BOXAA       *baa;
+FPIX        *fpix;
+L_INTEGRAL  *intgc;
+
+    PROCNAME("pixQuadtreeMeanIntegral");
+
+    if (!pfpixa)
+        return ERROR_INT("&fpixa not defined", procName, 1);
+    *pfpixa = NULL;
+    if (!pixs || pixGetDepth(pixs) != 8)
+        return ERROR_INT("pixs not defined or not 8 bpp", procName, 1);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if (nlevels > quadtreeMaxLevels(w, h))
+        return ERROR_INT("nlevels too large for image", procName, 1);
+
+    if (!intg)
+        intgc = integralCreate(pixs, 0);
+    else
+        intgc = integralClone(intg);
+    if (!intgc)
+        return ERROR_INT("intgc not made", procName, 1);
+
+    if ((baa = boxaaQuadtreeRegions(w, h, nlevels)) == NULL) {
+        integralDestroy(&intgc);
+        return ERROR_INT("baa not made", procName, 1);
+    }
+
+    *pfpixa = fpixaCreate(nlevels);
+    for (i = 0; i < nlevels; i++) {
+        boxa = boxaaGetBoxa(baa, i, L_CLONE);
+        size = 1 << i;
+        n = boxaGetCount(boxa);  /* n == size * size */
+        fpix = fpixCreate(size, size);
+        for (j = 0; j < n; j++) {
+            box = boxaGetBox(boxa, j, L_CLONE);
+            pixMeanInRectangleIntegral(pixs, box, intgc, &val);
+            fpixSetPixel(fpix, j % size, j / size, val);
+            boxDestroy(&box);
+        }
+        fpixaAddFPix(*pfpixa, fpix, L_INSERT);
+        boxaDestroy(&boxa);
+    }
+
+    integralDestroy(&intgc);
+    boxaaDestroy(&baa);
+    return 0;
+}
+
+
+/*!
+ *  pixQuadtreeVarianceIntegral()
+ *
+ *      Input:  pixs (8 bpp, no colormap)
+ *              nlevels (in quadtree)
+ *             *intg (<optional> integral image of pixs, with sums of
+ *                    squares; can be null)
+ *             *pfpixa_v (<optional return> variance values in quadtree)
+ *             *pfpixa_rv (<optional return> root variance values in quadtree)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The returned fpixav and fpixarv have @nlevels of fpix,
+ *          each containing at the respective levels the variance
+ *          and root variance values.
+ *      (2) If @intg is null, it is made here and destroyed.
+ */
+l_int32
+pixQuadtreeVarianceIntegral(PIX         *pixs,
+                            l_int32      nlevels,
+                            L_INTEGRAL  *intg,
+                            FPIXA      **pfpixa_v,
+                            FPIXA      **pfpixa_rv)
+{
+l_int32      i, j, w, h, size, n;
+l_float32    var, rvar;
+BOX         *box;
+BOXA        *boxa;
+BOXAA       *baa;
+FPIX        *fpixv, *fpixrv;
+L_INTEGRAL  *intgc;
+
+    PROCNAME("pixQuadtreeVarianceIntegral");
+
+    if (!pfpixa_v && !pfpixa_rv)
+        return ERROR_INT("neither &fpixav nor &fpixarv defined", procName, 1);
+    if (pfpixa_v) *pfpixa_v = NULL;
+    if (pfpixa_rv) *pfpixa_rv = NULL;
+    if (!pixs || pixGetDepth(pixs) != 8)
+        return ERROR_INT("pixs not defined or not 8 bpp", procName, 1);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if (nlevels > quadtreeMaxLevels(w, h))
+        return ERROR_INT("nlevels too large for image", procName, 1);
+
+    if (intg && !integralGetSumSqData(intg))
+        return ERROR_INT("intg has no sums of squares", procName, 1);
+    if (!intg)
+        intgc = integralCreate(pixs, 1);
+    else
+        intgc = integralClone(intg);
+    if (!intgc)
+        return ERROR_INT("intgc not made", procName, 1);
+
+    if ((baa = boxaaQuadtreeRegions(w, h, nlevels)) == NULL) {
+        integralDestroy(&intgc);
+        return ERROR_INT("baa not made", procName, 1);
+    }
+
+    if (pfpixa_v) *pfpixa_v = fpixaCreate(nlevels);
+    if (pfpixa_rv) *pfpixa_rv = fpixaCreate(nlevels);
+    for (i = 0; i < nlevels; i++) {
+        boxa = boxaaGetBoxa(baa, i, L_CLONE);
+        size = 1 << i;
+        n = boxaGetCount(boxa);  /* n == size * size */
+        if (pfpixa_v) fpixv = fpixCreate(size, size);
+        if (pfpixa_rv) fpixrv = fpixCreate(size, size);
+        for (j = 0; j < n; j++) {
+            box = boxaGetBox(boxa, j, L_CLONE);
+            pixVarianceInRectangleIntegral(pixs, box, intgc, &var, &rvar);
+            if (pfpixa_v) fpixSetPixel(fpixv, j % size, j / size, var);
+            if (pfpixa_rv) fpixSetPixel(fpixrv, j % size, j / size, rvar);
+            boxDestroy(&box);
+        }
+        if (pfpixa_v) fpixaAddFPix(*pfpixa_v, fpixv, L_INSERT);
+        if (pfpixa_rv) fpixaAddFPix(*pfpixa_rv, fpixrv, L_INSERT);
+        boxaDestroy(&boxa);
+    }
+
+    integralDestroy(&intgc);
+    boxaaDestroy(&baa);
+    return 0;
+}
+
+
 /*----------------------------------------------------------------------*
  *                  Statistics in an arbitrary rectangle                *
  *----------------------------------------------------------------------*/
@@ -418,6 +592,124 @@ BOX       *boxc;
 }
 
 
+/*!
+ *  pixMeanInRectangleIntegral()
+ *
+ *      Input:  pix (8 bpp)
+ *              box (region to compute mean value)
+ *              intg (integral image of pixs)
+ *              &val (<return> mean value
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This function is intended to be used for many rectangles
+ *          on the same image.  It can find the mean within a
+ *          rectangle in O(1), independent of the size of the rectangle.
+ *      (2) The sums are exact for any image size; the 32 bpp mean
+ *          accumulator used by pixMeanInRectangle() overflows when
+ *          the sum of pixels in the rectangle exceeds 2^32.
+ */
+l_int32
+pixMeanInRectangleIntegral(PIX         *pixs,
+                           BOX         *box,
+                           L_INTEGRAL  *intg,
+                           l_float32   *pval)
+{
+l_int32    w, h, bx, by, bw, bh;
+l_float64  sum;
+BOX       *boxc;
+
+    PROCNAME("pixMeanInRectangleIntegral");
+
+    if (!pval)
+        return ERROR_INT("&val not defined", procName, 1);
+    *pval = 0.0;
+    if (!pixs || pixGetDepth(pixs) != 8)
+        return ERROR_INT("pixs not defined", procName, 1);
+    if (!box)
+        return ERROR_INT("box not defined", procName, 1);
+    if (!intg)
+        return ERROR_INT("intg not defined", procName, 1);
+
+        /* Clip rectangle to image */
+    pixGetDimensions(pixs, &w, &h, NULL);
+    boxc = boxClipToRectangle(box, w, h);
+    boxGetGeometry(boxc, &bx, &by, &bw, &bh);
+    boxDestroy(&boxc);
+
+    if (bw == 0 || bh == 0)
+        return ERROR_INT("no pixels in box", procName, 1);
+
+        /* Use 4 points in the integral image */
+    if (integralGetRectSum(intg, bx, by, bw, bh, &sum, NULL))
+        return ERROR_INT("sum not found", procName, 1);
+    *pval = (l_float32)(sum / ((l_float64)bw * bh));
+    return 0;
+}
+
+
+/*!
+ *  pixVarianceInRectangleIntegral()
+ *
+ *      Input:  pix (8 bpp)
+ *              box (region to compute variance and/or root variance)
+ *              intg (integral image of pixs, with sums of squares)
+ *              &var (<optional return> variance)
+ *              &rvar (<optional return> root variance)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This function is intended to be used for many rectangles
+ *          on the same image.  It can find the variance and/or the
+ *          square root of the variance within a rectangle in O(1),
+ *          independent of the size of the rectangle.
+ */
+l_int32
+pixVarianceInRectangleIntegral(PIX         *pixs,
+                               BOX         *box,
+                               L_INTEGRAL  *intg,
+                               l_float32   *pvar,
+                               l_float32   *prvar)
+{
+l_int32    w, h, bx, by, bw, bh;
+l_float64  sum, sumsq, norm, mval, msval, var;
+BOX       *boxc;
+
+    PROCNAME("pixVarianceInRectangleIntegral");
+
+    if (!pvar && !prvar)
+        return ERROR_INT("neither &var nor &rvar defined", procName, 1);
+    if (pvar) *pvar = 0.0;
+    if (prvar) *prvar = 0.0;
+    if (!pixs || pixGetDepth(pixs) != 8)
+        return ERROR_INT("pixs not defined", procName, 1);
+    if (!box)
+        return ERROR_INT("box not defined", procName, 1);
+    if (!intg)
+        return ERROR_INT("intg not defined", procName, 1);
+
+        /* Clip rectangle to image */
+    pixGetDimensions(pixs, &w, &h, NULL);
+    boxc = boxClipToRectangle(box, w, h);
+    boxGetGeometry(boxc, &bx, &by, &bw, &bh);
+    boxDestroy(&boxc);
+
+    if (bw == 0 || bh == 0)
+        return ERROR_INT("no pixels in box", procName, 1);
+
+        /* Use 4 points in each table of the integral image */
+    if (integralGetRectSum(intg, bx, by, bw, bh, &sum, &sumsq))
+        return ERROR_INT("sums not found", procName, 1);
+    norm = 1.0 / ((l_float64)bw * bh);
+    mval = norm * sum;
+    msval = norm * sumsq;
+    var = L_MAX(0.0, msval - mval * mval);  /* guard against roundoff */
+    if (pvar) *pvar = (l_float32)var;
+    if (prvar) *prvar = (l_float32)(sqrt(var));
+    return 0;
+}
+
+
 /*----------------------------------------------------------------------*
  *                            Quadtree regions                          *
  *----------------------------------------------------------------------*/